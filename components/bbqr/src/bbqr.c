@@ -99,50 +99,142 @@ bool bbqr_parse_part(const char *data, size_t data_len, BBQrPart *part) {
   return true;
 }
 
-// Helper: decode hex string to binary
-static uint8_t *decode_hex(const char *hex, size_t hex_len, size_t *out_len) {
-  if (hex_len % 2 != 0) {
-    return NULL;
-  }
+static int hex_value(unsigned char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
 
-  size_t bin_len = hex_len / 2;
-  uint8_t *output = (uint8_t *)malloc(bin_len);
-  if (!output) {
-    return NULL;
+static int base32_value(unsigned char c) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a';
+  if (c >= '2' && c <= '7')
+    return c - '2' + 26;
+  return -1;
+}
+
+size_t bbqr_decoded_len_bound(char encoding, size_t payload_len) {
+  encoding = toupper((unsigned char)encoding);
+  if (encoding == BBQR_ENCODING_HEX) {
+    return payload_len / 2;
   }
+  if (encoding == BBQR_ENCODING_BASE32 || encoding == BBQR_ENCODING_ZLIB) {
+    return base32_decoded_len(payload_len);
+  }
+  return 0;
+}
 
-  for (size_t i = 0; i < bin_len; i++) {
-    char h[3] = {hex[i * 2], hex[i * 2 + 1], '\0'};
+void bbqr_decoder_init(BBQrDecoder *dec, char encoding, uint8_t *out,
+                       size_t out_cap) {
+  memset(dec, 0, sizeof(*dec));
+  dec->encoding = toupper((unsigned char)encoding);
+  dec->out = out;
+  dec->out_cap = out_cap;
+}
 
-    // Convert hex pair to byte
-    char c1 = h[0];
-    char c2 = h[1];
-    int v1 = -1, v2 = -1;
+bool bbqr_decoder_update(BBQrDecoder *dec, const char *data, size_t data_len) {
+  uint32_t acc = dec->acc;
+  int acc_bits = dec->acc_bits;
+  size_t out_len = dec->out_len;
+  bool ok = true;
+
+  if (dec->encoding == BBQR_ENCODING_HEX) {
+    for (size_t i = 0; i < data_len; i++) {
+      int v = hex_value((unsigned char)data[i]);
+      if (v < 0) {
+        ok = false;
+        break;
+      }
+      acc = (acc << 4) | (uint32_t)v;
+      acc_bits += 4;
+      if (acc_bits == 8) {
+        if (out_len >= dec->out_cap) {
+          ok = false;
+          break;
+        }
+        dec->out[out_len++] = (uint8_t)acc;
+        acc = 0;
+        acc_bits = 0;
+      }
+    }
+  } else if (dec->encoding == BBQR_ENCODING_BASE32 ||
+             dec->encoding == BBQR_ENCODING_ZLIB) {
+    for (size_t i = 0; i < data_len; i++) {
+      unsigned char c = (unsigned char)data[i];
+      if (c == '=') {
+        dec->padded = true;
+        continue;
+      }
+      if (isspace(c)) {
+        continue;
+      }
+      int v = base32_value(c);
+      if (v < 0 || dec->padded) {
+        ok = false;
+        break;
+      }
+      acc = (acc << 5) | (uint32_t)v;
+      acc_bits += 5;
+      if (acc_bits >= 8) {
+        acc_bits -= 8;
+        if (out_len >= dec->out_cap) {
+          ok = false;
+          break;
+        }
+        dec->out[out_len++] = (uint8_t)(acc >> acc_bits);
+        acc &= (1u << acc_bits) - 1;
+      }
+    }
+  } else {
+    ok = false;
+  }
 
-    if (c1 >= '0' && c1 <= '9')
-      v1 = c1 - '0';
-    else if (c1 >= 'A' && c1 <= 'F')
-      v1 = c1 - 'A' + 10;
-    else if (c1 >= 'a' && c1 <= 'f')
-      v1 = c1 - 'a' + 10;
+  dec->acc = acc;
+  dec->acc_bits = acc_bits;
+  dec->out_len = out_len;
+  return ok;
+}
 
-    if (c2 >= '0' && c2 <= '9')
-      v2 = c2 - '0';
-    else if (c2 >= 'A' && c2 <= 'F')
-      v2 = c2 - 'A' + 10;
-    else if (c2 >= 'a' && c2 <= 'f')
-      v2 = c2 - 'a' + 10;
+bool bbqr_decoder_finish(BBQrDecoder *dec, size_t *out_len) {
+  // Base32 drops trailing partial bits; hex must end on a whole byte
+  if (dec->encoding == BBQR_ENCODING_HEX && dec->acc_bits != 0) {
+    return false;
+  }
+  *out_len = dec->out_len;
+  return true;
+}
 
-    if (v1 < 0 || v2 < 0) {
-      free(output);
-      return NULL;
-    }
+// zlib-wrapped streams start with CMF method 8 and a valid header checksum
+static bool is_zlib_stream(const uint8_t *data, size_t len) {
+  return len >= 2 && (data[0] & 0x0F) == 0x08 &&
+         (data[0] * 256 + data[1]) % 31 == 0;
+}
 
-    output[i] = (uint8_t)((v1 << 4) | v2);
+bool bbqr_inflate_size(const uint8_t *compressed, size_t compressed_len,
+                       size_t *out_len) {
+  if (is_zlib_stream(compressed, compressed_len) &&
+      mz_uncompress_size(compressed, compressed_len, out_len) == MZ_OK) {
+    return true;
   }
+  // BBQr spec says raw deflate
+  return mz_inflate_raw_size(compressed, compressed_len, out_len) == MZ_OK;
+}
 
-  *out_len = bin_len;
-  return output;
+bool bbqr_inflate_into(const uint8_t *compressed, size_t compressed_len,
+                       uint8_t *out, size_t *out_len) {
+  size_t cap = *out_len;
+  if (is_zlib_stream(compressed, compressed_len) &&
+      mz_uncompress(out, out_len, compressed, compressed_len) == MZ_OK) {
+    return true;
+  }
+  *out_len = cap;
+  return mz_inflate_raw(out, out_len, compressed, compressed_len) == MZ_OK;
 }
 
 uint8_t *bbqr_decode_payload(char encoding, const char *data, size_t data_len,
@@ -152,71 +244,49 @@ uint8_t *bbqr_decode_payload(char encoding, const char *data, size_t data_len,
   }
 
   encoding = toupper((unsigned char)encoding);
+  size_t bound = bbqr_decoded_len_bound(encoding, data_len);
+  if (bound == 0 && encoding != BBQR_ENCODING_HEX) {
+    return NULL;
+  }
 
-  if (encoding == BBQR_ENCODING_HEX) {
-    // Hex decode
-    return decode_hex(data, data_len, out_len);
-  } else if (encoding == BBQR_ENCODING_BASE32) {
-    // Base32 decode only
-    size_t max_decoded = base32_decoded_len(data_len);
-    uint8_t *decoded = (uint8_t *)malloc(max_decoded);
-    if (!decoded) {
-      return NULL;
-    }
+  uint8_t *decoded = (uint8_t *)malloc(bound ? bound : 1);
+  if (!decoded) {
+    return NULL;
+  }
 
-    if (!base32_decode(data, data_len, decoded, max_decoded, out_len)) {
-      free(decoded);
-      return NULL;
-    }
+  BBQrDecoder dec;
+  size_t decoded_len;
+  bbqr_decoder_init(&dec, encoding, decoded, bound);
+  if (!bbqr_decoder_update(&dec, data, data_len) ||
+      !bbqr_decoder_finish(&dec, &decoded_len)) {
+    free(decoded);
+    return NULL;
+  }
 
+  if (encoding != BBQR_ENCODING_ZLIB) {
+    *out_len = decoded_len;
     return decoded;
-  } else if (encoding == BBQR_ENCODING_ZLIB) {
-    // Base32 decode, then zlib decompress
-    size_t max_decoded = base32_decoded_len(data_len);
-    uint8_t *compressed = (uint8_t *)malloc(max_decoded);
-    if (!compressed) {
-      return NULL;
-    }
-
-    size_t compressed_len;
-    if (!base32_decode(data, data_len, compressed, max_decoded,
-                       &compressed_len)) {
-      free(compressed);
-      return NULL;
-    }
-
-    // Try to detect format: zlib-wrapped starts with 0x78 (CMF for deflate)
-    // Raw deflate typically starts with block header bits
-    size_t decompressed_len = 0;
-    uint8_t *decompressed = NULL;
-
-    if (compressed_len >= 2 && (compressed[0] & 0x0F) == 0x08) {
-      // Looks like zlib header (CMF method = 8 = deflate)
-      // Verify header checksum: (CMF*256 + FLG) % 31 == 0
-      if ((compressed[0] * 256 + compressed[1]) % 31 == 0) {
-        // Try zlib-wrapped decompression first
-        decompressed =
-            mz_uncompress_alloc(compressed, compressed_len, &decompressed_len);
-      }
-    }
-
-    if (!decompressed) {
-      // Fall back to raw deflate (BBQr spec says raw deflate)
-      decompressed =
-          mz_inflate_raw_alloc(compressed, compressed_len, &decompressed_len);
-    }
-
-    free(compressed);
+  }
 
-    if (!decompressed) {
-      return NULL;
+  // Size pass, then inflate once into an exact buffer
+  size_t inflated_len;
+  uint8_t *inflated = NULL;
+  if (bbqr_inflate_size(decoded, decoded_len, &inflated_len)) {
+    inflated = (uint8_t *)malloc(inflated_len ? inflated_len : 1);
+    if (inflated &&
+        !bbqr_inflate_into(decoded, decoded_len, inflated, &inflated_len)) {
+      free(inflated);
+      inflated = NULL;
     }
+  }
+  free(decoded);
 
-    *out_len = decompressed_len;
-    return decompressed;
+  if (!inflated) {
+    return NULL;
   }
 
-  return NULL;
+  *out_len = inflated_len;
+  return inflated;
 }
 
 BBQrParts *bbqr_encode(const uint8_t *data, size_t data_len, char file_type,
@@ -37,6 +37,24 @@ typedef struct {
   size_t payload_len;   // Length of payload data
 } BBQrPart;
 
+/**
+ * @brief Incremental payload decoder
+ *
+ * Decodes part payloads one at a time, in index order, straight into a
+ * caller-owned buffer. Bits left over at a part boundary carry into the next
+ * part. For 'Z' the output is the compressed stream; pass it to
+ * bbqr_inflate_into() once all parts are written.
+ */
+typedef struct {
+  char encoding;  // Encoding type ('H', '2', or 'Z')
+  bool padded;    // Base32 padding seen, only '=' may follow
+  uint32_t acc;   // Pending input bits
+  int acc_bits;   // Number of pending bits
+  uint8_t *out;   // Output buffer
+  size_t out_cap; // Output buffer size
+  size_t out_len; // Bytes written so far
+} BBQrDecoder;
+
 /**
  * @brief Structure to hold BBQr encoded parts for output
  */
@@ -93,6 +111,73 @@ bool bbqr_parse_part(const char *data, size_t data_len, BBQrPart *part);
 uint8_t *bbqr_decode_payload(char encoding, const char *data, size_t data_len,
                              size_t *out_len);
 
+/**
+ * @brief Upper bound on the bytes a decoder produces for a payload
+ *
+ * Exact for unpadded 'H' and '2' payloads. For 'Z' this bounds the
+ * compressed stream, not the inflated result.
+ *
+ * @param encoding Encoding type ('H', '2', or 'Z')
+ * @param payload_len Total payload characters across all parts
+ * @return Byte bound, or 0 for an unknown encoding
+ */
+size_t bbqr_decoded_len_bound(char encoding, size_t payload_len);
+
+/**
+ * @brief Start an incremental decode into a caller buffer
+ *
+ * @param dec Decoder state
+ * @param encoding Encoding type ('H', '2', or 'Z')
+ * @param out Output buffer
+ * @param out_cap Size of output buffer
+ */
+void bbqr_decoder_init(BBQrDecoder *dec, char encoding, uint8_t *out,
+                       size_t out_cap);
+
+/**
+ * @brief Decode the next part payload
+ *
+ * @param dec Decoder state
+ * @param data Payload characters of the next part
+ * @param data_len Number of payload characters
+ * @return true on success, false on invalid input or a full output buffer
+ */
+bool bbqr_decoder_update(BBQrDecoder *dec, const char *data, size_t data_len);
+
+/**
+ * @brief Finish decoding
+ *
+ * @param dec Decoder state
+ * @param out_len Pointer to store the number of bytes written
+ * @return true on success, false if hex input ended mid-byte
+ */
+bool bbqr_decoder_finish(BBQrDecoder *dec, size_t *out_len);
+
+/**
+ * @brief Get the inflated size of a 'Z' compressed stream
+ *
+ * Accepts raw deflate (the BBQr spec) and zlib-wrapped streams.
+ *
+ * @param compressed Compressed stream from the decoder
+ * @param compressed_len Length of compressed stream
+ * @param out_len Pointer to store the inflated length
+ * @return true on success, false on malformed input
+ */
+bool bbqr_inflate_size(const uint8_t *compressed, size_t compressed_len,
+                       size_t *out_len);
+
+/**
+ * @brief Inflate a 'Z' compressed stream into a caller buffer
+ *
+ * @param compressed Compressed stream from the decoder
+ * @param compressed_len Length of compressed stream
+ * @param out Output buffer
+ * @param out_len In: size of out. Out: inflated length
+ * @return true on success, false on malformed input or short buffer
+ */
+bool bbqr_inflate_into(const uint8_t *compressed, size_t compressed_len,
+                       uint8_t *out, size_t *out_len);
+
 /**
  * @brief Encode binary data as BBQr parts
  *
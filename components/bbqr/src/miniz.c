@@ -365,13 +365,14 @@ static void build_fixed_tables(HuffTable *lit_len, HuffTable *dist) {
   build_huffman(dist, lengths, 30);
 }
 
-/* Raw deflate decompression */
+/* Raw deflate decompression. With dest NULL nothing is written and only the
+ * output length is computed, so callers can size the buffer exactly. */
 static int inflate_raw_impl(uint8_t *dest, size_t *dest_len,
                             const uint8_t *source, size_t source_len) {
   const uint8_t *pSrc = source;
   const uint8_t *pSrc_end = source + source_len;
-  uint8_t *pDst = dest;
-  uint8_t *pDst_end = dest + *dest_len;
+  size_t dst_pos = 0;
+  size_t dst_cap = *dest_len;
   uint32_t bit_buf = 0;
   int num_bits = 0;
   int final_block = 0;
@@ -410,12 +411,13 @@ static int inflate_raw_impl(uint8_t *dest, size_t *dest_len,
         return MZ_DATA_ERROR;
       if (pSrc + len > pSrc_end)
         return MZ_DATA_ERROR;
-      if (pDst + len > pDst_end)
+      if (len > dst_cap - dst_pos)
         return MZ_BUF_ERROR;
 
-      memcpy(pDst, pSrc, len);
+      if (dest)
+        memcpy(dest + dst_pos, pSrc, len);
       pSrc += len;
-      pDst += len;
+      dst_pos += len;
 
     } else if (block_type == 1) {
       /* Fixed Huffman codes */
@@ -429,9 +431,11 @@ static int inflate_raw_impl(uint8_t *dest, size_t *dest_len,
 
         if (sym < 256) {
           /* Literal byte */
-          if (pDst >= pDst_end)
+          if (dst_pos >= dst_cap)
             return MZ_BUF_ERROR;
-          *pDst++ = (uint8_t)sym;
+          if (dest)
+            dest[dst_pos] = (uint8_t)sym;
+          dst_pos++;
         } else if (sym == 256) {
           /* End of block */
           break;
@@ -476,15 +480,18 @@ static int inflate_raw_impl(uint8_t *dest, size_t *dest_len,
           num_bits -= extra;
 
           /* Copy match */
-          if ((size_t)match_dist > (size_t)(pDst - dest))
+          if ((size_t)match_dist > dst_pos)
             return MZ_DATA_ERROR;
-          if (pDst + match_len > pDst_end)
+          if ((size_t)match_len > dst_cap - dst_pos)
             return MZ_BUF_ERROR;
 
-          const uint8_t *pMatch = pDst - match_dist;
-          while (match_len-- > 0) {
-            *pDst++ = *pMatch++;
+          if (dest) {
+            uint8_t *pDst = dest + dst_pos;
+            const uint8_t *pMatch = pDst - match_dist;
+            for (int k = 0; k < match_len; k++)
+              pDst[k] = pMatch[k];
           }
+          dst_pos += match_len;
         }
       }
 
@@ -609,9 +616,11 @@ static int inflate_raw_impl(uint8_t *dest, size_t *dest_len,
           return MZ_DATA_ERROR;
 
         if (sym < 256) {
-          if (pDst >= pDst_end)
+          if (dst_pos >= dst_cap)
             return MZ_BUF_ERROR;
-          *pDst++ = (uint8_t)sym;
+          if (dest)
+            dest[dst_pos] = (uint8_t)sym;
+          dst_pos++;
         } else if (sym == 256) {
           break;
         } else {
@@ -650,15 +659,18 @@ static int inflate_raw_impl(uint8_t *dest, size_t *dest_len,
           bit_buf >>= extra;
           num_bits -= extra;
 
-          if ((size_t)match_dist > (size_t)(pDst - dest))
+          if ((size_t)match_dist > dst_pos)
             return MZ_DATA_ERROR;
-          if (pDst + match_len > pDst_end)
+          if ((size_t)match_len > dst_cap - dst_pos)
             return MZ_BUF_ERROR;
 
-          const uint8_t *pMatch = pDst - match_dist;
-          while (match_len-- > 0) {
-            *pDst++ = *pMatch++;
+          if (dest) {
+            uint8_t *pDst = dest + dst_pos;
+            const uint8_t *pMatch = pDst - match_dist;
+            for (int k = 0; k < match_len; k++)
+              pDst[k] = pMatch[k];
           }
+          dst_pos += match_len;
         }
       }
 
@@ -668,56 +680,52 @@ static int inflate_raw_impl(uint8_t *dest, size_t *dest_len,
     }
   }
 
-  *dest_len = pDst - dest;
+  *dest_len = dst_pos;
   return MZ_OK;
 }
 
 /* Public API: Raw deflate inflate */
 int mz_inflate_raw(uint8_t *dest, size_t *dest_len, const uint8_t *source,
                    size_t source_len) {
+  if (!dest)
+    return MZ_PARAM_ERROR;
   return inflate_raw_impl(dest, dest_len, source, source_len);
 }
 
+int mz_inflate_raw_size(const uint8_t *source, size_t source_len,
+                        size_t *dest_len) {
+  size_t out_len = MZ_MAX_INFLATE_SIZE;
+  int status = inflate_raw_impl(NULL, &out_len, source, source_len);
+  if (status == MZ_OK)
+    *dest_len = out_len;
+  return status;
+}
+
 uint8_t *mz_inflate_raw_alloc(const uint8_t *source, size_t source_len,
                               size_t *dest_len) {
-  /* Estimate output size - start with 4x input */
-  size_t alloc_size = source_len * 4;
-  if (alloc_size < 1024)
-    alloc_size = 1024;
-
-  for (int attempt = 0; attempt < 10; attempt++) {
-    uint8_t *dest = (uint8_t *)malloc(alloc_size);
-    if (!dest)
-      return NULL;
-
-    size_t out_len = alloc_size;
-    int status = inflate_raw_impl(dest, &out_len, source, source_len);
-
-    if (status == MZ_OK) {
-      *dest_len = out_len;
-      return dest;
-    } else if (status == MZ_BUF_ERROR) {
-      free(dest);
-      alloc_size *= 2;
-      if (alloc_size > 16 * 1024 * 1024) /* Cap at 16MB */
-        return NULL;
-      continue;
-    } else {
-      free(dest);
-      return NULL;
-    }
+  /* Size pass first so the output is allocated once at its exact length */
+  size_t out_len;
+  if (mz_inflate_raw_size(source, source_len, &out_len) != MZ_OK)
+    return NULL;
+
+  uint8_t *dest = (uint8_t *)malloc(out_len ? out_len : 1);
+  if (!dest)
+    return NULL;
+
+  if (inflate_raw_impl(dest, &out_len, source, source_len) != MZ_OK) {
+    free(dest);
+    return NULL;
   }
 
-  return NULL;
+  *dest_len = out_len;
+  return dest;
 }
 
-/* Zlib-wrapped uncompress (with header/trailer) */
-int mz_uncompress(uint8_t *dest, size_t *dest_len, const uint8_t *source,
-                  size_t source_len) {
+/* Validate a zlib header; returns MZ_OK if the deflate stream can be read */
+static int zlib_check_header(const uint8_t *source, size_t source_len) {
   if (source_len < 6)
     return MZ_DATA_ERROR;
 
-  /* Parse zlib header */
   uint8_t cmf = source[0];
   uint8_t flg = source[1];
 
@@ -728,8 +736,21 @@ int mz_uncompress(uint8_t *dest, size_t *dest_len, const uint8_t *source,
   if (flg & 0x20)
     return MZ_DATA_ERROR; /* Preset dictionary not supported */
 
+  return MZ_OK;
+}
+
+/* Zlib-wrapped uncompress (with header/trailer) */
+int mz_uncompress(uint8_t *dest, size_t *dest_len, const uint8_t *source,
+                  size_t source_len) {
+  if (!dest)
+    return MZ_PARAM_ERROR;
+
+  int ret = zlib_check_header(source, source_len);
+  if (ret != MZ_OK)
+    return ret;
+
   /* Decompress */
-  int ret = inflate_raw_impl(dest, dest_len, source + 2, source_len - 6);
+  ret = inflate_raw_impl(dest, dest_len, source + 2, source_len - 6);
   if (ret != MZ_OK)
     return ret;
 
@@ -745,39 +766,31 @@ int mz_uncompress(uint8_t *dest, size_t *dest_len, const uint8_t *source,
   return MZ_OK;
 }
 
+int mz_uncompress_size(const uint8_t *source, size_t source_len,
+                       size_t *dest_len) {
+  int ret = zlib_check_header(source, source_len);
+  if (ret != MZ_OK)
+    return ret;
+  return mz_inflate_raw_size(source + 2, source_len - 6, dest_len);
+}
+
 uint8_t *mz_uncompress_alloc(const uint8_t *source, size_t source_len,
                              size_t *dest_len) {
-  if (source_len < 6)
+  size_t out_len;
+  if (mz_uncompress_size(source, source_len, &out_len) != MZ_OK)
     return NULL;
 
-  size_t alloc_size = (source_len - 6) * 4;
-  if (alloc_size < 1024)
-    alloc_size = 1024;
-
-  for (int attempt = 0; attempt < 10; attempt++) {
-    uint8_t *dest = (uint8_t *)malloc(alloc_size);
-    if (!dest)
-      return NULL;
-
-    size_t out_len = alloc_size;
-    int status = mz_uncompress(dest, &out_len, source, source_len);
-
-    if (status == MZ_OK) {
-      *dest_len = out_len;
-      return dest;
-    } else if (status == MZ_BUF_ERROR) {
-      free(dest);
-      alloc_size *= 2;
-      if (alloc_size > 16 * 1024 * 1024)
-        return NULL;
-      continue;
-    } else {
-      free(dest);
-      return NULL;
-    }
+  uint8_t *dest = (uint8_t *)malloc(out_len ? out_len : 1);
+  if (!dest)
+    return NULL;
+
+  if (mz_uncompress(dest, &out_len, source, source_len) != MZ_OK) {
+    free(dest);
+    return NULL;
   }
 
-  return NULL;
+  *dest_len = out_len;
+  return dest;
 }
 
 /* Raw deflate compression with LZ77 and static Huffman */
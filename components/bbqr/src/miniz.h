@@ -43,6 +43,10 @@
 #define MZ_MAX_WBITS 15 /* 32KB */
 #define MZ_DEFAULT_WBITS 10 /* 1024 bytes - optimal for BBQr */
 
+/* Largest output the inflate size pass will report (matches the old 16MB
+ * retry cap of the _alloc helpers) */
+#define MZ_MAX_INFLATE_SIZE (16 * 1024 * 1024)
+
 /* Flush types */
 #define MZ_NO_FLUSH 0
 #define MZ_PARTIAL_FLUSH 1
@@ -98,6 +102,22 @@ int mz_uncompress(uint8_t *dest, size_t *dest_len, const uint8_t *source,
 uint8_t *mz_uncompress_alloc(const uint8_t *source, size_t source_len,
                              size_t *dest_len);
 
+/**
+ * @brief Compute the decompressed size of zlib data without writing output
+ *
+ * Runs the decoder in a counting mode so a buffer of exactly the right size
+ * can be allocated before the real pass. The Adler32 trailer is only checked
+ * by mz_uncompress().
+ *
+ * @param source Compressed source data
+ * @param source_len Length of compressed data
+ * @param dest_len Pointer to store decompressed length
+ * @return MZ_OK on success, MZ_BUF_ERROR if larger than MZ_MAX_INFLATE_SIZE,
+ *         or MZ_DATA_ERROR on malformed input
+ */
+int mz_uncompress_size(const uint8_t *source, size_t source_len,
+                       size_t *dest_len);
+
 /**
  * @brief Compress with dynamic allocation
  *
@@ -123,6 +143,14 @@ uint8_t *mz_compress_alloc(const uint8_t *source, size_t source_len,
 int mz_inflate_raw(uint8_t *dest, size_t *dest_len, const uint8_t *source,
                    size_t source_len);
 
+/**
+ * @brief Compute the decompressed size of raw deflate data
+ *
+ * Counting-only variant of mz_inflate_raw(); see mz_uncompress_size().
+ */
+int mz_inflate_raw_size(const uint8_t *source, size_t source_len,
+                        size_t *dest_len);
+
 /**
  * @brief Decompress raw deflate with dynamic allocation
  */
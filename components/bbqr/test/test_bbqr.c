@@ -465,6 +465,106 @@ void verify_bbqr_decode(const char *test_name, const char **parts, int count,
     PASS();
 }
 
+/* Decode parts one at a time through BBQrDecoder, as the QR parser does */
+static void verify_bbqr_stream_decode(const char *name, const char **parts,
+                                      size_t count, const uint8_t *expected,
+                                      size_t expected_len) {
+    printf("Testing stream: %s... ", name);
+
+    BBQrPart part;
+    size_t payload_len = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!bbqr_parse_part(parts[i], strlen(parts[i]), &part)) {
+            FAIL("Parse failed for part");
+            return;
+        }
+        payload_len += part.payload_len;
+    }
+
+    char encoding = part.encoding;
+    size_t bound = bbqr_decoded_len_bound(encoding, payload_len);
+    uint8_t *buf = malloc(bound ? bound : 1);
+    BBQrDecoder dec;
+    bbqr_decoder_init(&dec, encoding, buf, bound);
+    for (size_t i = 0; i < count; i++) {
+        bbqr_parse_part(parts[i], strlen(parts[i]), &part);
+        if (!bbqr_decoder_update(&dec, part.payload, part.payload_len)) {
+            free(buf);
+            FAIL("Decoder update failed");
+            return;
+        }
+    }
+
+    size_t len = 0;
+    if (!bbqr_decoder_finish(&dec, &len)) {
+        free(buf);
+        FAIL("Decoder finish failed");
+        return;
+    }
+
+    uint8_t *result = buf;
+    if (encoding == BBQR_ENCODING_ZLIB) {
+        size_t inflated_len;
+        if (!bbqr_inflate_size(buf, len, &inflated_len) ||
+            inflated_len != expected_len) {
+            free(buf);
+            FAIL("Inflate size mismatch");
+            return;
+        }
+        result = malloc(inflated_len);
+        if (!bbqr_inflate_into(buf, len, result, &inflated_len)) {
+            free(result);
+            free(buf);
+            FAIL("Inflate failed");
+            return;
+        }
+        free(buf);
+        len = inflated_len;
+    }
+
+    if (len == expected_len && memcmp(result, expected, len) == 0) {
+        PASS();
+    } else {
+        FAIL("Data mismatch");
+    }
+    free(result);
+}
+
+/* Parts need not split on whole bytes: leftover bits carry across */
+void test_decoder_carry(void) {
+    TEST("decoder carries bits across part boundaries");
+
+    uint8_t out[8];
+    size_t len = 0;
+    BBQrDecoder dec;
+
+    bbqr_decoder_init(&dec, 'H', out, sizeof(out));
+    bool ok = bbqr_decoder_update(&dec, "486", 3) &&
+              bbqr_decoder_update(&dec, "56c6C", 5) &&
+              bbqr_decoder_update(&dec, "6F", 2) &&
+              bbqr_decoder_finish(&dec, &len) && len == 5 &&
+              memcmp(out, "Hello", 5) == 0;
+
+    bbqr_decoder_init(&dec, '2', out, sizeof(out));
+    ok = ok && bbqr_decoder_update(&dec, "JBS", 3) &&
+         bbqr_decoder_update(&dec, "WY3DP", 5) &&
+         bbqr_decoder_finish(&dec, &len) && len == 5 &&
+         memcmp(out, "Hello", 5) == 0;
+
+    /* Odd hex length and overflow are errors */
+    bbqr_decoder_init(&dec, 'H', out, sizeof(out));
+    ok = ok && bbqr_decoder_update(&dec, "486", 3) &&
+         !bbqr_decoder_finish(&dec, &len);
+    bbqr_decoder_init(&dec, 'H', out, 2);
+    ok = ok && !bbqr_decoder_update(&dec, "48656C", 6);
+
+    if (ok) {
+        PASS();
+    } else {
+        FAIL("Carry decode mismatch");
+    }
+}
+
 void test_vectors(void) {
     printf("Running Test Vectors...\n");
 
@@ -516,6 +616,26 @@ void test_vectors(void) {
     verify_bbqr_decode("Signed PSBT (Hex)", bbqr_signed_psbt_hex_parts,
                        BBQR_ARRAY_LEN(bbqr_signed_psbt_hex_parts),
                        bbqr_signed_psbt_bytes, bbqr_signed_psbt_bytes_len);
+
+    verify_bbqr_stream_decode("Coldcard JSON", bbqr_json_coldcard_parts,
+                              BBQR_ARRAY_LEN(bbqr_json_coldcard_parts),
+                              bbqr_json_coldcard_expected,
+                              bbqr_json_coldcard_expected_len);
+
+    verify_bbqr_stream_decode("Sparrow PSBT", bbqr_sparrow_psbt_parts,
+                              BBQR_ARRAY_LEN(bbqr_sparrow_psbt_parts),
+                              bbqr_sparrow_psbt_bytes,
+                              bbqr_sparrow_psbt_bytes_len);
+
+    verify_bbqr_stream_decode("Sparrow PSBT (NC)", bbqr_sparrow_psbt_nc_parts,
+                              BBQR_ARRAY_LEN(bbqr_sparrow_psbt_nc_parts),
+                              bbqr_sparrow_psbt_bytes,
+                              bbqr_sparrow_psbt_bytes_len);
+
+    verify_bbqr_stream_decode("Signed PSBT (Hex)", bbqr_signed_psbt_hex_parts,
+                              BBQR_ARRAY_LEN(bbqr_signed_psbt_hex_parts),
+                              bbqr_signed_psbt_bytes,
+                              bbqr_signed_psbt_bytes_len);
 }
 
 int main(void) {
@@ -530,6 +650,7 @@ int main(void) {
     test_miniz_roundtrip();
     test_bbqr_roundtrip();
     test_real_bbqr_decode();
+    test_decoder_carry();
     test_vectors();
 
     printf("\n================\n");
@@ -658,6 +658,48 @@ void test_buffer_too_small(void) {
   }
 }
 
+/*
+ * Test: Size pass reports the exact inflated length without writing
+ */
+void test_inflate_size(void) {
+  TEST("inflate size pass");
+
+  uint8_t original[3000];
+  for (size_t i = 0; i < sizeof(original); i++)
+    original[i] = (uint8_t)((i * 7) % 61);
+
+  size_t zlib_len = 0, raw_len = 0;
+  uint8_t *zlib = mz_compress_alloc(original, sizeof(original), &zlib_len,
+                                    MZ_DEFAULT_COMPRESSION);
+  uint8_t *raw = mz_deflate_raw_alloc(original, sizeof(original), &raw_len);
+  if (!zlib || !raw) {
+    free(zlib);
+    free(raw);
+    FAIL("compression returned NULL");
+    return;
+  }
+
+  size_t zlib_size = 0, raw_size = 0;
+  int zret = mz_uncompress_size(zlib, zlib_len, &zlib_size);
+  int rret = mz_inflate_raw_size(raw, raw_len, &raw_size);
+
+  /* Truncated input is a data error, not a size */
+  size_t trunc_size = 0;
+  int tret = mz_inflate_raw_size(raw, raw_len / 2, &trunc_size);
+
+  free(zlib);
+  free(raw);
+
+  if (zret == MZ_OK && rret == MZ_OK && zlib_size == sizeof(original) &&
+      raw_size == sizeof(original) && tret == MZ_DATA_ERROR) {
+    PASS();
+  } else {
+    printf("(zlib %d/%zu, raw %d/%zu, truncated %d) ", zret, zlib_size, rret,
+           raw_size, tret);
+    FAIL("wrong size");
+  }
+}
+
 /*
  * Test: Verify zlib header format
  */
@@ -799,6 +841,7 @@ int main(void) {
   printf("\n=== API Tests ===\n");
   test_fixed_buffer();
   test_buffer_too_small();
+  test_inflate_size();
   test_zlib_header();
 
   /* Benchmark */
@@ -0,0 +1,154 @@
+#ifndef BIP39_LANG_H
+#define BIP39_LANG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Per-language BIP39 wordlist index and normalization
+ *
+ * Each loaded language keeps a compact index over its 2048 words:
+ *
+ * - a key per word: the NFKD form with combining accents (U+0300-U+036F)
+ *   dropped and ASCII lowercased, so "ábaco", "abaco" and the decomposed
+ *   form all find the same word. For Latin-script lists the key is plain
+ *   a-z and is what the keyboard types and the UI displays.
+ * - the word indices ordered by key, so every prefix is one contiguous
+ *   range. Typing a letter narrows the range with a binary search inside
+ *   it, and the enabled-letter mask jumps once per distinct next letter,
+ *   so neither grows with the wordlist size.
+ *
+ * The words themselves are supplied by the caller (on device, libwally)
+ * through a lookup function, so no wordlist data lives here.
+ *
+ * bip39_lang_nfkd() implements the parts of NFKD the BIP39 lists need:
+ * Latin-1 and Czech precomposed letters, kana voicing marks, Hangul
+ * syllables, full-width ASCII and the ideographic space (U+3000), which
+ * becomes an ASCII space. Seed derivation must run over that form.
+ */
+
+typedef enum {
+  BIP39_LANG_EN = 0,
+  BIP39_LANG_ES,
+  BIP39_LANG_FR,
+  BIP39_LANG_IT,
+  BIP39_LANG_PT,
+  BIP39_LANG_CS,
+  BIP39_LANG_JA,
+  BIP39_LANG_KO,
+  BIP39_LANG_COUNT
+} bip39_lang_t;
+
+#define BIP39_LANG_WORDS 2048
+#define BIP39_LANG_MASK(lang) (1u << (lang))
+#define BIP39_LANG_MAX_WORD_BYTES 48 // Longest NFKD word, with NUL
+
+typedef struct {
+  const char *code;      // ISO 639-1
+  const char *name;      // English name, for menus
+  const char *separator; // Between words as written (U+3000 for ja)
+  bool latin;            // Keys are a-z, so typeable and displayable
+} bip39_lang_info_t;
+
+/** @brief Static description of a language, NULL if out of range */
+const bip39_lang_info_t *bip39_lang_info(bip39_lang_t lang);
+
+/** @brief Word at index (0-2047) of a language's list */
+typedef const char *(*bip39_lang_word_fn)(void *ctx, size_t index);
+
+/**
+ * @brief Build the index for a language
+ *
+ * Fails if a word is missing, too long, or two words share a key.
+ * Reloading replaces the previous index.
+ */
+bool bip39_lang_load(bip39_lang_t lang, bip39_lang_word_fn word_at,
+                     void *ctx);
+
+/** @brief Free a language's index */
+void bip39_lang_unload(bip39_lang_t lang);
+
+/** @brief Bit per loaded language (BIP39_LANG_MASK) */
+uint32_t bip39_lang_loaded(void);
+
+/* ---------- Normalization ---------- */
+
+/**
+ * @brief NFKD-normalize UTF-8 text
+ *
+ * Output grows by at most 3x plus the NUL.
+ *
+ * @return false if out_len is too small or the input isn't UTF-8
+ */
+bool bip39_lang_nfkd(const char *in, char *out, size_t out_len);
+
+/**
+ * @brief Lookup key of a word (see the file comment)
+ *
+ * @return false if it doesn't fit or the input isn't UTF-8
+ */
+bool bip39_lang_key(const char *word, char *out, size_t out_len);
+
+/**
+ * @brief Split a mnemonic in place on ASCII and ideographic spaces
+ *
+ * @return Number of words stored in words (at most max)
+ */
+size_t bip39_lang_split(char *mnemonic, char **words, size_t max);
+
+/* ---------- Lookup ---------- */
+
+/** @brief Index of a word in any normalization form, or -1 */
+int bip39_lang_find(bip39_lang_t lang, const char *word);
+
+/** @brief Key of a word, stable until the language is unloaded */
+const char *bip39_lang_key_of(bip39_lang_t lang, uint16_t index);
+
+/** @brief The word as supplied at load time */
+const char *bip39_lang_word(bip39_lang_t lang, uint16_t index);
+
+/**
+ * @brief Loaded languages among candidates containing every word
+ *
+ * Words may be in any normalization form. With no words every loaded
+ * candidate matches.
+ */
+uint32_t bip39_lang_detect(const char *const *words, size_t n,
+                           uint32_t candidates);
+
+/* ---------- Prefix filtering ---------- */
+
+/** Words whose keys start with the first depth bytes of a prefix */
+typedef struct {
+  uint16_t lo;    // First position in key order
+  uint16_t hi;    // One past the last
+  uint16_t depth; // Prefix length in bytes
+} bip39_lang_range_t;
+
+/** @brief Range of every word (the empty prefix) */
+bip39_lang_range_t bip39_lang_all(bip39_lang_t lang);
+
+/** @brief Narrow a range by one more key byte */
+bip39_lang_range_t bip39_lang_narrow(bip39_lang_t lang, bip39_lang_range_t r,
+                                     char c);
+
+/** @brief Range of a prefix given as key bytes */
+bip39_lang_range_t bip39_lang_prefix(bip39_lang_t lang, const char *prefix,
+                                     size_t len);
+
+/** @brief Bit N set if 'a' + N can follow the range's prefix */
+uint32_t bip39_lang_next_letters(bip39_lang_t lang, bip39_lang_range_t r);
+
+/** @brief Word index at position pos of key order */
+uint16_t bip39_lang_index_at(bip39_lang_t lang, uint16_t pos);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP39_LANG_H
@@ -0,0 +1,249 @@
+#include "bip39_lang.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  bip39_lang_word_fn word_at;
+  void *ctx;
+  char *pool;                          // Keys, NUL-terminated, by index
+  uint16_t key_off[BIP39_LANG_WORDS];  // Offset of each word's key in pool
+  uint16_t order[BIP39_LANG_WORDS];    // Word indices sorted by key
+} lang_index_t;
+
+static const bip39_lang_info_t infos[BIP39_LANG_COUNT] = {
+    [BIP39_LANG_EN] = {"en", "English", " ", true},
+    [BIP39_LANG_ES] = {"es", "Spanish", " ", true},
+    [BIP39_LANG_FR] = {"fr", "French", " ", true},
+    [BIP39_LANG_IT] = {"it", "Italian", " ", true},
+    [BIP39_LANG_PT] = {"pt", "Portuguese", " ", true},
+    [BIP39_LANG_CS] = {"cs", "Czech", " ", true},
+    [BIP39_LANG_JA] = {"ja", "Japanese", "\xe3\x80\x80", false},
+    [BIP39_LANG_KO] = {"ko", "Korean", " ", false},
+};
+
+static lang_index_t *langs[BIP39_LANG_COUNT];
+
+static const lang_index_t *get(bip39_lang_t lang) {
+  return (unsigned)lang < BIP39_LANG_COUNT ? langs[lang] : NULL;
+}
+
+static const char *key_at(const lang_index_t *ix, uint16_t pos) {
+  return ix->pool + ix->key_off[ix->order[pos]];
+}
+
+const bip39_lang_info_t *bip39_lang_info(bip39_lang_t lang) {
+  return (unsigned)lang < BIP39_LANG_COUNT ? &infos[lang] : NULL;
+}
+
+/* ---------- Loading ---------- */
+
+static const lang_index_t *sorting; // qsort has no context argument
+
+static int cmp_keys(const void *a, const void *b) {
+  const lang_index_t *ix = sorting;
+  return strcmp(ix->pool + ix->key_off[*(const uint16_t *)a],
+                ix->pool + ix->key_off[*(const uint16_t *)b]);
+}
+
+static bool latin_key(const char *key) {
+  for (; *key; key++) {
+    if (*key < 'a' || *key > 'z')
+      return false;
+  }
+  return true;
+}
+
+bool bip39_lang_load(bip39_lang_t lang, bip39_lang_word_fn word_at,
+                     void *ctx) {
+  if ((unsigned)lang >= BIP39_LANG_COUNT || !word_at)
+    return false;
+  bip39_lang_unload(lang);
+
+  lang_index_t *ix = calloc(1, sizeof(*ix));
+  if (!ix)
+    return false;
+  ix->word_at = word_at;
+  ix->ctx = ctx;
+
+  // First pass sizes the pool, second fills it
+  char key[BIP39_LANG_MAX_WORD_BYTES];
+  size_t total = 0;
+  for (size_t i = 0; i < BIP39_LANG_WORDS; i++) {
+    const char *word = word_at(ctx, i);
+    if (!word || !bip39_lang_key(word, key, sizeof(key)) || !key[0] ||
+        (infos[lang].latin && !latin_key(key)))
+      goto fail;
+    total += strlen(key) + 1;
+  }
+  if (total > UINT16_MAX)
+    goto fail;
+
+  ix->pool = malloc(total);
+  if (!ix->pool)
+    goto fail;
+  size_t off = 0;
+  for (size_t i = 0; i < BIP39_LANG_WORDS; i++) {
+    bip39_lang_key(word_at(ctx, i), key, sizeof(key));
+    size_t len = strlen(key) + 1;
+    memcpy(ix->pool + off, key, len);
+    ix->key_off[i] = (uint16_t)off;
+    ix->order[i] = (uint16_t)i;
+    off += len;
+  }
+
+  sorting = ix;
+  qsort(ix->order, BIP39_LANG_WORDS, sizeof(ix->order[0]), cmp_keys);
+  sorting = NULL;
+  for (uint16_t pos = 1; pos < BIP39_LANG_WORDS; pos++) {
+    if (strcmp(key_at(ix, pos - 1), key_at(ix, pos)) == 0)
+      goto fail;
+  }
+
+  langs[lang] = ix;
+  return true;
+
+fail:
+  free(ix->pool);
+  free(ix);
+  return false;
+}
+
+void bip39_lang_unload(bip39_lang_t lang) {
+  if ((unsigned)lang >= BIP39_LANG_COUNT || !langs[lang])
+    return;
+  free(langs[lang]->pool);
+  free(langs[lang]);
+  langs[lang] = NULL;
+}
+
+uint32_t bip39_lang_loaded(void) {
+  uint32_t mask = 0;
+  for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+    if (langs[i])
+      mask |= BIP39_LANG_MASK(i);
+  }
+  return mask;
+}
+
+/* ---------- Lookup ---------- */
+
+static int find_key(const lang_index_t *ix, const char *key) {
+  size_t lo = 0, hi = BIP39_LANG_WORDS;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    int c = strcmp(key_at(ix, (uint16_t)mid), key);
+    if (c == 0)
+      return ix->order[mid];
+    if (c < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return -1;
+}
+
+int bip39_lang_find(bip39_lang_t lang, const char *word) {
+  const lang_index_t *ix = get(lang);
+  char key[BIP39_LANG_MAX_WORD_BYTES];
+  if (!ix || !word || !bip39_lang_key(word, key, sizeof(key)))
+    return -1;
+  return find_key(ix, key);
+}
+
+const char *bip39_lang_key_of(bip39_lang_t lang, uint16_t index) {
+  const lang_index_t *ix = get(lang);
+  if (!ix || index >= BIP39_LANG_WORDS)
+    return NULL;
+  return ix->pool + ix->key_off[index];
+}
+
+const char *bip39_lang_word(bip39_lang_t lang, uint16_t index) {
+  const lang_index_t *ix = get(lang);
+  if (!ix || index >= BIP39_LANG_WORDS)
+    return NULL;
+  return ix->word_at(ix->ctx, index);
+}
+
+uint32_t bip39_lang_detect(const char *const *words, size_t n,
+                           uint32_t candidates) {
+  uint32_t mask = candidates & bip39_lang_loaded();
+  char key[BIP39_LANG_MAX_WORD_BYTES];
+  for (size_t w = 0; w < n && mask; w++) {
+    if (!words[w] || !bip39_lang_key(words[w], key, sizeof(key)))
+      return 0;
+    for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+      if ((mask & BIP39_LANG_MASK(i)) && find_key(langs[i], key) < 0)
+        mask &= ~BIP39_LANG_MASK(i);
+    }
+  }
+  return mask;
+}
+
+/* ---------- Prefix filtering ---------- */
+
+// Keys in a range share their first depth bytes, so the byte at depth
+// is non-decreasing across it (NUL first, for a key that ends there)
+static uint8_t byte_at(const lang_index_t *ix, uint16_t pos, uint16_t depth) {
+  return (uint8_t)key_at(ix, pos)[depth];
+}
+
+// First position in [lo, hi) whose byte at depth is greater than c
+static uint16_t upper_bound(const lang_index_t *ix, uint16_t lo, uint16_t hi,
+                            uint16_t depth, uint8_t c) {
+  while (lo < hi) {
+    uint16_t mid = (uint16_t)((lo + hi) / 2);
+    if (byte_at(ix, mid, depth) <= c)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+bip39_lang_range_t bip39_lang_all(bip39_lang_t lang) {
+  bip39_lang_range_t r = {0, get(lang) ? BIP39_LANG_WORDS : 0, 0};
+  return r;
+}
+
+bip39_lang_range_t bip39_lang_narrow(bip39_lang_t lang, bip39_lang_range_t r,
+                                     char c) {
+  const lang_index_t *ix = get(lang);
+  bip39_lang_range_t out = {r.lo, r.lo, (uint16_t)(r.depth + 1)};
+  if (!ix || r.lo >= r.hi || c == '\0')
+    return out;
+  out.lo = upper_bound(ix, r.lo, r.hi, r.depth, (uint8_t)c - 1);
+  out.hi = upper_bound(ix, out.lo, r.hi, r.depth, (uint8_t)c);
+  return out;
+}
+
+bip39_lang_range_t bip39_lang_prefix(bip39_lang_t lang, const char *prefix,
+                                     size_t len) {
+  bip39_lang_range_t r = bip39_lang_all(lang);
+  for (size_t i = 0; i < len && r.lo < r.hi; i++)
+    r = bip39_lang_narrow(lang, r, prefix[i]);
+  return r;
+}
+
+uint32_t bip39_lang_next_letters(bip39_lang_t lang, bip39_lang_range_t r) {
+  const lang_index_t *ix = get(lang);
+  uint32_t mask = 0;
+  if (!ix)
+    return 0;
+  // One jump per distinct next byte
+  uint16_t pos = r.lo;
+  while (pos < r.hi) {
+    uint8_t b = byte_at(ix, pos, r.depth);
+    if (b >= 'a' && b <= 'z')
+      mask |= 1u << (b - 'a');
+    pos = upper_bound(ix, pos, r.hi, r.depth, b);
+  }
+  return mask;
+}
+
+uint16_t bip39_lang_index_at(bip39_lang_t lang, uint16_t pos) {
+  const lang_index_t *ix = get(lang);
+  if (!ix || pos >= BIP39_LANG_WORDS)
+    return 0;
+  return ix->order[pos];
+}
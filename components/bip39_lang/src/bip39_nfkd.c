@@ -0,0 +1,265 @@
+/*
+ * NFKD for BIP39 wordlists and mnemonics
+ *
+ * Only the decompositions the BIP39 lists and their usual input methods
+ * produce are covered; everything else passes through unchanged, which is
+ * already its NFKD form for the scripts involved.
+ */
+
+#include "bip39_lang.h"
+
+#include <string.h>
+
+typedef struct {
+  uint16_t cp;
+  char base;
+  uint8_t mark; // Low byte of the U+03xx combining mark
+} latin_decomp_t;
+
+// Sorted by code point
+static const latin_decomp_t latin[] = {
+    {0x00C0, 'A', 0x00}, {0x00C1, 'A', 0x01}, {0x00C2, 'A', 0x02},
+    {0x00C3, 'A', 0x03}, {0x00C4, 'A', 0x08}, {0x00C5, 'A', 0x0A},
+    {0x00C7, 'C', 0x27}, {0x00C8, 'E', 0x00}, {0x00C9, 'E', 0x01},
+    {0x00CA, 'E', 0x02}, {0x00CB, 'E', 0x08}, {0x00CC, 'I', 0x00},
+    {0x00CD, 'I', 0x01}, {0x00CE, 'I', 0x02}, {0x00CF, 'I', 0x08},
+    {0x00D1, 'N', 0x03}, {0x00D2, 'O', 0x00}, {0x00D3, 'O', 0x01},
+    {0x00D4, 'O', 0x02}, {0x00D5, 'O', 0x03}, {0x00D6, 'O', 0x08},
+    {0x00D9, 'U', 0x00}, {0x00DA, 'U', 0x01}, {0x00DB, 'U', 0x02},
+    {0x00DC, 'U', 0x08}, {0x00DD, 'Y', 0x01}, {0x00E0, 'a', 0x00},
+    {0x00E1, 'a', 0x01}, {0x00E2, 'a', 0x02}, {0x00E3, 'a', 0x03},
+    {0x00E4, 'a', 0x08}, {0x00E5, 'a', 0x0A}, {0x00E7, 'c', 0x27},
+    {0x00E8, 'e', 0x00}, {0x00E9, 'e', 0x01}, {0x00EA, 'e', 0x02},
+    {0x00EB, 'e', 0x08}, {0x00EC, 'i', 0x00}, {0x00ED, 'i', 0x01},
+    {0x00EE, 'i', 0x02}, {0x00EF, 'i', 0x08}, {0x00F1, 'n', 0x03},
+    {0x00F2, 'o', 0x00}, {0x00F3, 'o', 0x01}, {0x00F4, 'o', 0x02},
+    {0x00F5, 'o', 0x03}, {0x00F6, 'o', 0x08}, {0x00F9, 'u', 0x00},
+    {0x00FA, 'u', 0x01}, {0x00FB, 'u', 0x02}, {0x00FC, 'u', 0x08},
+    {0x00FD, 'y', 0x01}, {0x00FF, 'y', 0x08}, {0x010C, 'C', 0x0C},
+    {0x010D, 'c', 0x0C}, {0x010E, 'D', 0x0C}, {0x010F, 'd', 0x0C},
+    {0x011A, 'E', 0x0C}, {0x011B, 'e', 0x0C}, {0x0147, 'N', 0x0C},
+    {0x0148, 'n', 0x0C}, {0x0158, 'R', 0x0C}, {0x0159, 'r', 0x0C},
+    {0x0160, 'S', 0x0C}, {0x0161, 's', 0x0C}, {0x0164, 'T', 0x0C},
+    {0x0165, 't', 0x0C}, {0x016E, 'U', 0x0A}, {0x016F, 'u', 0x0A},
+    {0x017D, 'Z', 0x0C}, {0x017E, 'z', 0x0C},
+};
+
+#define NUM_LATIN (sizeof(latin) / sizeof(latin[0]))
+
+// Hiragana with a voiced mark (U+3099); katakana are these plus 0x60
+static const uint16_t kana_voiced[] = {
+    0x304C, 0x304E, 0x3050, 0x3052, 0x3054, 0x3056, 0x3058,
+    0x305A, 0x305C, 0x305E, 0x3060, 0x3062, 0x3065, 0x3067,
+    0x3069, 0x3070, 0x3073, 0x3076, 0x3079, 0x307C};
+// Hiragana with a semi-voiced mark (U+309A)
+static const uint16_t kana_semi[] = {0x3071, 0x3074, 0x3077, 0x307A, 0x307D};
+
+#define NUM_VOICED (sizeof(kana_voiced) / sizeof(kana_voiced[0]))
+#define NUM_SEMI (sizeof(kana_semi) / sizeof(kana_semi[0]))
+
+#define HANGUL_BASE 0xAC00
+#define HANGUL_COUNT 11172
+#define HANGUL_L 0x1100
+#define HANGUL_V 0x1161
+#define HANGUL_T 0x11A7
+#define HANGUL_V_COUNT 21
+#define HANGUL_T_COUNT 28
+
+static bool in_list(const uint16_t *list, size_t n, uint32_t cp) {
+  for (size_t i = 0; i < n; i++) {
+    if (list[i] == cp)
+      return true;
+  }
+  return false;
+}
+
+// Up to three code points; returns how many
+static size_t decompose(uint32_t cp, uint32_t out[3]) {
+  if (cp == 0x3000 || cp == 0x00A0) {
+    out[0] = ' ';
+    return 1;
+  }
+  if (cp >= 0xFF01 && cp <= 0xFF5E) { // Full-width ASCII
+    out[0] = cp - 0xFEE0;
+    return 1;
+  }
+
+  if (cp >= 0x00C0 && cp <= 0x017E) {
+    size_t lo = 0, hi = NUM_LATIN;
+    while (lo < hi) {
+      size_t mid = (lo + hi) / 2;
+      if (latin[mid].cp < cp)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo < NUM_LATIN && latin[lo].cp == cp) {
+      out[0] = (uint8_t)latin[lo].base;
+      out[1] = 0x0300 | latin[lo].mark;
+      return 2;
+    }
+  }
+
+  if (cp >= 0x3040 && cp <= 0x30FF) {
+    uint32_t hira = cp >= 0x30A0 ? cp - 0x60 : cp;
+    uint32_t shift = cp - hira;
+    if (in_list(kana_voiced, NUM_VOICED, hira) ||
+        hira == 0x309E) {
+      out[0] = cp - 1;
+      out[1] = 0x3099;
+      return 2;
+    }
+    if (in_list(kana_semi, NUM_SEMI, hira)) {
+      out[0] = cp - 2;
+      out[1] = 0x309A;
+      return 2;
+    }
+    if (hira == 0x3094) { // ゔ / ヴ
+      out[0] = 0x3046 + shift;
+      out[1] = 0x3099;
+      return 2;
+    }
+    if (cp >= 0x30F7 && cp <= 0x30FA) { // ヷヸヹヺ
+      out[0] = cp - 8;
+      out[1] = 0x3099;
+      return 2;
+    }
+  }
+
+  if (cp >= HANGUL_BASE && cp < HANGUL_BASE + HANGUL_COUNT) {
+    uint32_t s = cp - HANGUL_BASE;
+    uint32_t per_l = HANGUL_V_COUNT * HANGUL_T_COUNT;
+    out[0] = HANGUL_L + s / per_l;
+    out[1] = HANGUL_V + (s % per_l) / HANGUL_T_COUNT;
+    if (s % HANGUL_T_COUNT == 0)
+      return 2;
+    out[2] = HANGUL_T + s % HANGUL_T_COUNT;
+    return 3;
+  }
+
+  out[0] = cp;
+  return 1;
+}
+
+// Next code point, or -1 on malformed UTF-8
+static int32_t next_cp(const char **p) {
+  const uint8_t *s = (const uint8_t *)*p;
+  uint32_t cp;
+  size_t n;
+  if (s[0] < 0x80) {
+    cp = s[0];
+    n = 1;
+  } else if ((s[0] & 0xE0) == 0xC0 && s[0] >= 0xC2) {
+    cp = s[0] & 0x1F;
+    n = 2;
+  } else if ((s[0] & 0xF0) == 0xE0) {
+    cp = s[0] & 0x0F;
+    n = 3;
+  } else if ((s[0] & 0xF8) == 0xF0 && s[0] <= 0xF4) {
+    cp = s[0] & 0x07;
+    n = 4;
+  } else {
+    return -1;
+  }
+  for (size_t i = 1; i < n; i++) {
+    if ((s[i] & 0xC0) != 0x80)
+      return -1;
+    cp = (cp << 6) | (s[i] & 0x3F);
+  }
+  if ((n == 3 && cp < 0x800) || (n == 4 && cp < 0x10000))
+    return -1;
+  *p += n;
+  return (int32_t)cp;
+}
+
+static size_t put_cp(uint32_t cp, char *out) {
+  if (cp < 0x80) {
+    out[0] = (char)cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = (char)(0xC0 | (cp >> 6));
+    out[1] = (char)(0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = (char)(0xE0 | (cp >> 12));
+    out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  out[0] = (char)(0xF0 | (cp >> 18));
+  out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+  out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+  out[3] = (char)(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+static bool normalize(const char *in, char *out, size_t out_len, bool key) {
+  if (!in || !out || out_len == 0)
+    return false;
+
+  size_t pos = 0;
+  while (*in) {
+    int32_t cp = next_cp(&in);
+    if (cp < 0)
+      return false;
+
+    uint32_t parts[3];
+    size_t n = decompose((uint32_t)cp, parts);
+    for (size_t i = 0; i < n; i++) {
+      uint32_t c = parts[i];
+      if (key) {
+        if (c >= 0x0300 && c <= 0x036F)
+          continue;
+        if (c >= 'A' && c <= 'Z')
+          c += 'a' - 'A';
+      }
+      char buf[4];
+      size_t len = put_cp(c, buf);
+      if (pos + len >= out_len)
+        return false;
+      memcpy(out + pos, buf, len);
+      pos += len;
+    }
+  }
+  out[pos] = '\0';
+  return true;
+}
+
+bool bip39_lang_nfkd(const char *in, char *out, size_t out_len) {
+  return normalize(in, out, out_len, false);
+}
+
+bool bip39_lang_key(const char *word, char *out, size_t out_len) {
+  return normalize(word, out, out_len, true);
+}
+
+size_t bip39_lang_split(char *mnemonic, char **words, size_t max) {
+  if (!mnemonic || !words)
+    return 0;
+
+  size_t n = 0;
+  char *p = mnemonic;
+  while (*p) {
+    // Skip separators: ASCII whitespace and U+3000 (E3 80 80)
+    if (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+      *p++ = '\0';
+      continue;
+    }
+    if ((uint8_t)p[0] == 0xE3 && (uint8_t)p[1] == 0x80 &&
+        (uint8_t)p[2] == 0x80) {
+      memset(p, 0, 3);
+      p += 3;
+      continue;
+    }
+    if (n == max)
+      break;
+    words[n++] = p;
+    while (*p && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r' &&
+           !((uint8_t)p[0] == 0xE3 && (uint8_t)p[1] == 0x80 &&
+             (uint8_t)p[2] == 0x80))
+      p++;
+  }
+  return n;
+}
@@ -0,0 +1,390 @@
+/*
+ * BIP39 Language Index Test Suite
+ * Compile with: make
+ * Run: ./test_bip39_lang
+ *
+ * The real wordlists come from libwally on device, so these tests use
+ * generated 2048-word lists served in scrambled order, one of them with
+ * accented letters written in precomposed (NFC) form.
+ */
+
+#include "bip39_lang.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ---------- Generated wordlists ---------- */
+
+// 11 bits -> consonant, vowel, consonant, consonant-or-vowel; unique
+static const char *CONS = "bcdfghjklmnprstv";
+static const char *VOWS = "aeio";
+static const char *ENDS = "au";
+
+typedef struct {
+  char words[BIP39_LANG_WORDS][12];
+} wordlist_t;
+
+static wordlist_t plain_list, accent_list, dup_list;
+
+static void gen_word(unsigned v, bool accent, char *out) {
+  size_t n = 0;
+  out[n++] = CONS[(v >> 7) & 15];
+  char vow = VOWS[(v >> 5) & 3];
+  if (accent && vow == 'a') {
+    out[n++] = (char)0xC3; // á
+    out[n++] = (char)0xA1;
+  } else {
+    out[n++] = vow;
+  }
+  out[n++] = CONS[(v >> 1) & 15];
+  out[n++] = ENDS[v & 1];
+  out[n] = '\0';
+}
+
+// Word index i holds value (i * 1021) mod 2048, so the list isn't sorted
+static unsigned value_of(size_t i) { return (unsigned)((i * 1021) & 2047); }
+
+static void build_lists(void) {
+  for (size_t i = 0; i < BIP39_LANG_WORDS; i++) {
+    gen_word(value_of(i), false, plain_list.words[i]);
+    gen_word(value_of(i), true, accent_list.words[i]);
+    gen_word(value_of(i), false, dup_list.words[i]);
+  }
+  // Overwrite a neighbour of some "Xa.." word with its accented twin
+  for (size_t i = 0; i < BIP39_LANG_WORDS; i++) {
+    if (plain_list.words[i][1] == 'a') {
+      strcpy(dup_list.words[(i + 1) % BIP39_LANG_WORDS],
+             accent_list.words[i]);
+      break;
+    }
+  }
+}
+
+static const char *word_at(void *ctx, size_t index) {
+  return ((wordlist_t *)ctx)->words[index];
+}
+
+/* ---------- Tests ---------- */
+
+static void test_nfkd(void) {
+  TEST("NFKD covers accents, kana voicing, Hangul and wide spaces");
+  struct {
+    const char *in, *out;
+  } cases[] = {
+      {"\xc3\xa1" "baco", "a\xcc\x81" "baco"},         // ábaco
+      {"\xc4\x8d" "e\xc5\x99", "c\xcc\x8c" "er\xcc\x8c"}, // čeř
+      {"\xe3\x81\x8c", "\xe3\x81\x8b\xe3\x82\x99"},      // が
+      {"\xe3\x81\xb1", "\xe3\x81\xaf\xe3\x82\x9a"},      // ぱ
+      {"\xe3\x83\xb4", "\xe3\x82\xa6\xe3\x82\x99"},      // ヴ
+      {"a\xe3\x80\x80" "b", "a b"},                      // Ideographic space
+      {"\xef\xbc\xa1", "A"},                             // Full-width A
+      {"\xea\xb0\x80", "\xe1\x84\x80\xe1\x85\xa1"},      // 가
+      {"\xea\xb0\x81", "\xe1\x84\x80\xe1\x85\xa1\xe1\x86\xa8"}, // 각
+      {"abandon", "abandon"},
+  };
+  char out[64];
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    if (!bip39_lang_nfkd(cases[i].in, out, sizeof(out)) ||
+        strcmp(out, cases[i].out) != 0) {
+      printf("(case %zu) ", i);
+      FAIL("wrong decomposition");
+      return;
+    }
+  }
+  if (bip39_lang_nfkd("\xc3", out, sizeof(out)) ||
+      bip39_lang_nfkd("\xe0\x80\x80", out, sizeof(out))) {
+    FAIL("malformed UTF-8 accepted");
+    return;
+  }
+  if (bip39_lang_nfkd("\xc3\xa1" "baco", out, 6)) {
+    FAIL("overflow accepted");
+    return;
+  }
+  PASS();
+}
+
+static void test_key_and_split(void) {
+  TEST("keys fold accents and case; split handles both spaces");
+  char key[BIP39_LANG_MAX_WORD_BYTES];
+  if (!bip39_lang_key("\xc3\x81" "baco", key, sizeof(key)) ||
+      strcmp(key, "abaco") != 0) {
+    FAIL("accent not folded");
+    return;
+  }
+  // Kana voicing marks are not accents and stay in the key
+  if (!bip39_lang_key("\xe3\x81\x8c", key, sizeof(key)) ||
+      strcmp(key, "\xe3\x81\x8b\xe3\x82\x99") != 0) {
+    FAIL("voicing mark dropped");
+    return;
+  }
+
+  char text[] = "  one two\xe3\x80\x80three\nfour ";
+  char *words[8];
+  size_t n = bip39_lang_split(text, words, 8);
+  if (n != 4 || strcmp(words[0], "one") || strcmp(words[2], "three") ||
+      strcmp(words[3], "four")) {
+    FAIL("split");
+    return;
+  }
+  char text2[] = "a b c";
+  if (bip39_lang_split(text2, words, 2) != 2) {
+    FAIL("max not honoured");
+    return;
+  }
+  PASS();
+}
+
+static void test_load_and_find(void) {
+  TEST("find accepts NFC, NFD and folded forms");
+  if (!bip39_lang_load(BIP39_LANG_ES, word_at, &accent_list)) {
+    FAIL("load");
+    return;
+  }
+  for (size_t i = 0; i < BIP39_LANG_WORDS; i++) {
+    const char *w = accent_list.words[i];
+    char nfd[32], key[32];
+    bip39_lang_nfkd(w, nfd, sizeof(nfd));
+    bip39_lang_key(w, key, sizeof(key));
+    if (bip39_lang_find(BIP39_LANG_ES, w) != (int)i ||
+        bip39_lang_find(BIP39_LANG_ES, nfd) != (int)i ||
+        bip39_lang_find(BIP39_LANG_ES, key) != (int)i) {
+      FAIL("lookup mismatch");
+      return;
+    }
+    if (strcmp(bip39_lang_key_of(BIP39_LANG_ES, (uint16_t)i), key) != 0 ||
+        bip39_lang_word(BIP39_LANG_ES, (uint16_t)i) != w) {
+      FAIL("key or word accessor");
+      return;
+    }
+  }
+  if (bip39_lang_find(BIP39_LANG_ES, "zzzz") != -1 ||
+      bip39_lang_find(BIP39_LANG_EN, "basa") != -1) {
+    FAIL("found a missing word");
+    return;
+  }
+  PASS();
+}
+
+static void test_load_rejects(void) {
+  TEST("loading rejects colliding keys and non-letters");
+  if (bip39_lang_load(BIP39_LANG_FR, word_at, &dup_list)) {
+    FAIL("accent-only duplicate accepted");
+    return;
+  }
+  static wordlist_t digits;
+  memcpy(&digits, &plain_list, sizeof(digits));
+  strcpy(digits.words[100], "b4sa");
+  if (bip39_lang_load(BIP39_LANG_IT, word_at, &digits)) {
+    FAIL("digit in a Latin list accepted");
+    return;
+  }
+  // Non-Latin lists may hold anything
+  if (!bip39_lang_load(BIP39_LANG_KO, word_at, &digits)) {
+    FAIL("non-Latin list rejected");
+    return;
+  }
+  bip39_lang_unload(BIP39_LANG_KO);
+  if (bip39_lang_loaded() & (BIP39_LANG_MASK(BIP39_LANG_FR) |
+                             BIP39_LANG_MASK(BIP39_LANG_IT) |
+                             BIP39_LANG_MASK(BIP39_LANG_KO))) {
+    FAIL("failed or unloaded language still loaded");
+    return;
+  }
+  PASS();
+}
+
+// Reference: scan every key
+static uint32_t brute_letters(bip39_lang_t lang, const char *prefix,
+                              size_t len, size_t *count) {
+  uint32_t mask = 0;
+  *count = 0;
+  for (uint16_t i = 0; i < BIP39_LANG_WORDS; i++) {
+    const char *k = bip39_lang_key_of(lang, i);
+    if (strncmp(k, prefix, len) != 0)
+      continue;
+    (*count)++;
+    if (k[len] >= 'a' && k[len] <= 'z')
+      mask |= 1u << (k[len] - 'a');
+  }
+  return mask;
+}
+
+static void test_prefix_ranges(void) {
+  TEST("prefix ranges and letter masks match a full scan");
+  bip39_lang_load(BIP39_LANG_EN, word_at, &plain_list);
+  const bip39_lang_t lang = BIP39_LANG_EN;
+
+  // Every prefix of every word, plus some dead ends
+  for (size_t i = 0; i < BIP39_LANG_WORDS; i += 3) {
+    const char *k = bip39_lang_key_of(lang, (uint16_t)i);
+    char prefix[8];
+    for (size_t len = 0; len <= strlen(k) + 1; len++) {
+      memcpy(prefix, k, len);
+      if (len > strlen(k))
+        prefix[len - 1] = 'z';
+      size_t count;
+      uint32_t want = brute_letters(lang, prefix, len, &count);
+      bip39_lang_range_t r = bip39_lang_prefix(lang, prefix, len);
+      if ((size_t)(r.hi - r.lo) != count ||
+          bip39_lang_next_letters(lang, r) != want) {
+        FAIL("range or mask differs");
+        return;
+      }
+      for (uint16_t p = r.lo; p < r.hi; p++) {
+        uint16_t idx = bip39_lang_index_at(lang, p);
+        if (strncmp(bip39_lang_key_of(lang, idx), prefix, len) != 0) {
+          FAIL("range holds a non-matching word");
+          return;
+        }
+      }
+    }
+  }
+
+  // Incremental narrowing equals the one-shot prefix
+  bip39_lang_range_t r = bip39_lang_all(lang);
+  r = bip39_lang_narrow(lang, r, 'd');
+  r = bip39_lang_narrow(lang, r, 'e');
+  bip39_lang_range_t r2 = bip39_lang_prefix(lang, "de", 2);
+  if (r.lo != r2.lo || r.hi != r2.hi || r.depth != 2) {
+    FAIL("narrow != prefix");
+    return;
+  }
+  PASS();
+}
+
+static void test_detect(void) {
+  TEST("detection keeps only languages holding every word");
+  // EN (plain) and ES (accented) share every word with no 'a' after the
+  // first consonant
+  uint32_t both =
+      BIP39_LANG_MASK(BIP39_LANG_EN) | BIP39_LANG_MASK(BIP39_LANG_ES);
+  const char *shared[] = {"beba", "didu"};
+  const char *plain_only[] = {"beba", "basa"};
+  const char *accented[] = {"beba", "b\xc3\xa1sa"};
+  const char *unknown[] = {"beba", "xyz"};
+
+  if (bip39_lang_detect(shared, 2, BIP39_LANG_MASK(BIP39_LANG_COUNT) - 1) !=
+      both) {
+    FAIL("shared words");
+    return;
+  }
+  // "basa" folds to the key of "bása", so both still match
+  if (bip39_lang_detect(plain_only, 2, both) != both ||
+      bip39_lang_detect(accented, 2, both) != both) {
+    FAIL("folded forms");
+    return;
+  }
+  if (bip39_lang_detect(unknown, 2, both) != 0) {
+    FAIL("unknown word matched");
+    return;
+  }
+  if (bip39_lang_detect(shared, 2, BIP39_LANG_MASK(BIP39_LANG_ES)) !=
+      BIP39_LANG_MASK(BIP39_LANG_ES)) {
+    FAIL("candidate mask ignored");
+    return;
+  }
+  if (bip39_lang_detect(NULL, 0, both) != both) {
+    FAIL("no words");
+    return;
+  }
+  PASS();
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench(void) {
+  const bip39_lang_t lang = BIP39_LANG_EN;
+  const int iters = 2000;
+  volatile uint32_t sink = 0;
+
+  // One keystroke: narrow by a letter and recompute the mask
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++) {
+    const char *k = bip39_lang_key_of(lang, (uint16_t)(i & 2047));
+    bip39_lang_range_t r = bip39_lang_all(lang);
+    for (size_t d = 0; d < 3; d++) {
+      r = bip39_lang_narrow(lang, r, k[d]);
+      sink += bip39_lang_next_letters(lang, r);
+    }
+  }
+  double t1 = now_ms();
+
+  // The scan the filter used to do: 26 letters x 2048 strncmp
+  double t2 = now_ms();
+  for (int i = 0; i < iters / 20; i++) {
+    const char *k = bip39_lang_key_of(lang, (uint16_t)(i & 2047));
+    for (size_t d = 1; d <= 3; d++) {
+      for (int letter = 0; letter < 26; letter++) {
+        char probe[8];
+        memcpy(probe, k, d);
+        probe[d] = (char)('a' + letter);
+        for (uint16_t w = 0; w < BIP39_LANG_WORDS; w++) {
+          if (strncmp(bip39_lang_key_of(lang, w), probe, d + 1) == 0) {
+            sink += 1;
+            break;
+          }
+        }
+      }
+    }
+  }
+  double t3 = now_ms();
+
+  const char *words[12];
+  for (int i = 0; i < 12; i++)
+    words[i] = plain_list.words[i * 97];
+  double t4 = now_ms();
+  for (int i = 0; i < iters; i++)
+    sink += bip39_lang_detect(words, 12, 0xFF);
+  double t5 = now_ms();
+  (void)sink;
+
+  printf("\nBenchmark:\n");
+  printf("  Index keystroke (narrow + mask): %.2f us\n",
+         (t1 - t0) * 1000.0 / (iters * 3));
+  printf("  Linear keystroke (26 x 2048 scan): %.2f us\n",
+         (t3 - t2) * 1000.0 / (iters / 20 * 3));
+  printf("  Detect 12 words over 2 languages: %.2f us\n",
+         (t5 - t4) * 1000.0 / iters);
+}
+
+int main(void) {
+  printf("=== BIP39 Language Index Tests ===\n\n");
+  build_lists();
+
+  test_nfkd();
+  test_key_and_split();
+  test_load_and_find();
+  test_load_rejects();
+  test_prefix_ranges();
+  test_detect();
+
+  bench();
+
+  for (int i = 0; i < BIP39_LANG_COUNT; i++)
+    bip39_lang_unload((bip39_lang_t)i);
+
+  printf("\nResults: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+#ifndef BIP85_H
+#define BIP85_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief BIP85 deterministic entropy from a BIP32 master key
+ *
+ * Each application has a fully hardened path under m/83696968'; the
+ * private key k derived there gives 64 bytes of entropy as
+ * HMAC-SHA512("bip-entropy-from-k", k), which the application then
+ * encodes. The BIP32 derivation itself is the caller's: this module
+ * builds the paths, hashes k and encodes the result.
+ *
+ * The last path element is always the index, so every index of one
+ * application and parameter shares the parent made of the other elements.
+ * Callers deriving consecutive indices keep that parent and derive one
+ * child per index.
+ */
+
+#define BIP85_PURPOSE 83696968
+#define BIP85_ENTROPY_LEN 64
+#define BIP85_MAX_PATH 5
+#define BIP85_MAX_INDEX 0x7fffffff
+
+// BIP39 language code in the path; the firmware derives English mnemonics
+#define BIP85_BIP39_ENGLISH 0
+
+typedef enum {
+  BIP85_OK = 0,
+  BIP85_ERR_INVALID_ARG = -1,
+  BIP85_ERR_BUFFER = -2, // Output buffer too small
+} bip85_error_t;
+
+typedef enum {
+  BIP85_APP_BIP39,      // param: words (12, 18 or 24)
+  BIP85_APP_HEX,        // param: bytes (16 to 64)
+  BIP85_APP_PWD_BASE64, // param: length (20 to 86)
+  BIP85_APP_PWD_BASE85, // param: length (10 to 80)
+} bip85_app_t;
+
+/** @brief True if param is allowed for the application */
+bool bip85_param_valid(bip85_app_t app, uint32_t param);
+
+/**
+ * @brief Derivation path, hardened indices from the master
+ * @return Depth, or 0 if param or index is out of range
+ */
+size_t bip85_path(bip85_app_t app, uint32_t param, uint32_t index,
+                  uint32_t path[BIP85_MAX_PATH]);
+
+/** @brief Entropy of the private key derived at an application path */
+void bip85_entropy_from_k(const uint8_t k[32],
+                          uint8_t out[BIP85_ENTROPY_LEN]);
+
+/**
+ * @brief Entropy bytes a BIP39 child mnemonic takes
+ * @return 16, 24 or 32; 0 for other word counts
+ */
+size_t bip85_bip39_entropy_len(uint32_t words);
+
+/**
+ * @brief Encode entropy for a text application (HEX or passwords)
+ * @param out Receives param characters (2 * param for HEX) and a NUL
+ */
+bip85_error_t bip85_format(bip85_app_t app, uint32_t param,
+                           const uint8_t entropy[BIP85_ENTROPY_LEN],
+                           char *out, size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIP85_H
@@ -0,0 +1,145 @@
+/*
+ * BIP85 application paths and encodings
+ */
+
+#include "bip85.h"
+
+#include <sha2.h>
+#include <string.h>
+
+#define HARDENED 0x80000000u
+
+// Application numbers
+#define APP_BIP39 39
+#define APP_HEX 128169
+#define APP_PWD_BASE64 707764
+#define APP_PWD_BASE85 707785
+
+static const char base64_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// RFC 1924 alphabet, as BIP85 specifies
+static const char base85_chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                   "abcdefghijklmnopqrstuvwxyz"
+                                   "!#$%&()*+-;<=>?@^_`{|}~";
+
+bool bip85_param_valid(bip85_app_t app, uint32_t param) {
+  switch (app) {
+  case BIP85_APP_BIP39:
+    return param == 12 || param == 18 || param == 24;
+  case BIP85_APP_HEX:
+    return param >= 16 && param <= 64;
+  case BIP85_APP_PWD_BASE64:
+    return param >= 20 && param <= 86;
+  case BIP85_APP_PWD_BASE85:
+    return param >= 10 && param <= 80;
+  }
+  return false;
+}
+
+size_t bip85_path(bip85_app_t app, uint32_t param, uint32_t index,
+                  uint32_t path[BIP85_MAX_PATH]) {
+  if (!path || !bip85_param_valid(app, param) || index > BIP85_MAX_INDEX)
+    return 0;
+
+  size_t depth = 0;
+  path[depth++] = BIP85_PURPOSE | HARDENED;
+  switch (app) {
+  case BIP85_APP_BIP39:
+    path[depth++] = APP_BIP39 | HARDENED;
+    path[depth++] = BIP85_BIP39_ENGLISH | HARDENED;
+    break;
+  case BIP85_APP_HEX:
+    path[depth++] = APP_HEX | HARDENED;
+    break;
+  case BIP85_APP_PWD_BASE64:
+    path[depth++] = APP_PWD_BASE64 | HARDENED;
+    break;
+  case BIP85_APP_PWD_BASE85:
+    path[depth++] = APP_PWD_BASE85 | HARDENED;
+    break;
+  }
+  path[depth++] = param | HARDENED;
+  path[depth++] = index | HARDENED;
+  return depth;
+}
+
+void bip85_entropy_from_k(const uint8_t k[32],
+                          uint8_t out[BIP85_ENTROPY_LEN]) {
+  static const char tag[] = "bip-entropy-from-k";
+  sha2_hmac_sha512((const uint8_t *)tag, sizeof(tag) - 1, k, 32, out);
+}
+
+size_t bip85_bip39_entropy_len(uint32_t words) {
+  if (!bip85_param_valid(BIP85_APP_BIP39, words))
+    return 0;
+  return words * 4 / 3;
+}
+
+// Leading len characters of the padded base64 of all the entropy
+static void encode_base64(const uint8_t *in, size_t in_len, char *out,
+                          size_t len) {
+  size_t n = 0;
+  for (size_t i = 0; i < in_len && n < len; i += 3) {
+    uint32_t v = (uint32_t)in[i] << 16;
+    if (i + 1 < in_len)
+      v |= (uint32_t)in[i + 1] << 8;
+    if (i + 2 < in_len)
+      v |= in[i + 2];
+    for (int j = 0; j < 4 && n < len; j++)
+      out[n++] = base64_chars[(v >> (18 - 6 * j)) & 0x3f];
+  }
+  out[n] = '\0';
+}
+
+// Leading len characters of the base85 of all the entropy (a multiple of
+// four bytes, so no partial group)
+static void encode_base85(const uint8_t *in, size_t in_len, char *out,
+                          size_t len) {
+  size_t n = 0;
+  for (size_t i = 0; i + 4 <= in_len && n < len; i += 4) {
+    uint32_t v = (uint32_t)in[i] << 24 | (uint32_t)in[i + 1] << 16 |
+                 (uint32_t)in[i + 2] << 8 | in[i + 3];
+    char group[5];
+    for (int j = 4; j >= 0; j--) {
+      group[j] = base85_chars[v % 85];
+      v /= 85;
+    }
+    for (int j = 0; j < 5 && n < len; j++)
+      out[n++] = group[j];
+  }
+  out[n] = '\0';
+}
+
+bip85_error_t bip85_format(bip85_app_t app, uint32_t param,
+                           const uint8_t entropy[BIP85_ENTROPY_LEN],
+                           char *out, size_t out_len) {
+  static const char hex[] = "0123456789abcdef";
+
+  if (!entropy || !out || app == BIP85_APP_BIP39 ||
+      !bip85_param_valid(app, param))
+    return BIP85_ERR_INVALID_ARG;
+
+  size_t chars = app == BIP85_APP_HEX ? param * 2 : param;
+  if (out_len < chars + 1)
+    return BIP85_ERR_BUFFER;
+
+  switch (app) {
+  case BIP85_APP_HEX:
+    for (uint32_t i = 0; i < param; i++) {
+      out[i * 2] = hex[entropy[i] >> 4];
+      out[i * 2 + 1] = hex[entropy[i] & 0x0f];
+    }
+    out[chars] = '\0';
+    break;
+  case BIP85_APP_PWD_BASE64:
+    encode_base64(entropy, BIP85_ENTROPY_LEN, out, chars);
+    break;
+  case BIP85_APP_PWD_BASE85:
+    encode_base85(entropy, BIP85_ENTROPY_LEN, out, chars);
+    break;
+  default:
+    return BIP85_ERR_INVALID_ARG;
+  }
+  return BIP85_OK;
+}
@@ -0,0 +1,337 @@
+/*
+ * BIP85 Test Suite
+ * Compile with: make
+ * Run: ./test_bip85
+ *
+ * Vectors are from BIP85, derived from its test master key. The test
+ * carries a minimal hardened-only BIP32 private derivation so the paths
+ * are checked end to end.
+ */
+
+#include "bip85.h"
+#include "sha2.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static size_t from_hex(const char *hex, uint8_t *out) {
+  size_t n = strlen(hex) / 2;
+  for (size_t i = 0; i < n; i++) {
+    unsigned v;
+    sscanf(hex + i * 2, "%2x", &v);
+    out[i] = (uint8_t)v;
+  }
+  return n;
+}
+
+static void to_hex(const uint8_t *in, size_t len, char *out) {
+  for (size_t i = 0; i < len; i++)
+    sprintf(out + i * 2, "%02x", in[i]);
+}
+
+/* ---------- Hardened BIP32 derivation (test only) ---------- */
+
+typedef struct {
+  uint8_t key[32];
+  uint8_t chain_code[32];
+} node_t;
+
+// secp256k1 group order, big-endian
+static const uint8_t curve_n[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xfe, 0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48,
+    0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41};
+
+// r = (a + b) mod n for a, b < n
+static void add_mod_n(const uint8_t a[32], const uint8_t b[32],
+                      uint8_t r[32]) {
+  unsigned carry = 0;
+  for (int i = 31; i >= 0; i--) {
+    unsigned v = a[i] + b[i] + carry;
+    r[i] = (uint8_t)v;
+    carry = v >> 8;
+  }
+  bool ge = carry;
+  if (!ge) {
+    ge = true;
+    for (int i = 0; i < 32; i++) {
+      if (r[i] != curve_n[i]) {
+        ge = r[i] > curve_n[i];
+        break;
+      }
+    }
+  }
+  if (ge) {
+    int borrow = 0;
+    for (int i = 31; i >= 0; i--) {
+      int v = r[i] - curve_n[i] - borrow;
+      r[i] = (uint8_t)v;
+      borrow = v < 0;
+    }
+  }
+}
+
+static void ckd_hardened(const node_t *parent, uint32_t index, node_t *out) {
+  uint8_t data[37];
+  uint8_t i[64];
+  data[0] = 0;
+  memcpy(data + 1, parent->key, 32);
+  data[33] = (uint8_t)(index >> 24);
+  data[34] = (uint8_t)(index >> 16);
+  data[35] = (uint8_t)(index >> 8);
+  data[36] = (uint8_t)index;
+  sha2_hmac_sha512(parent->chain_code, 32, data, sizeof(data), i);
+  add_mod_n(i, parent->key, out->key);
+  memcpy(out->chain_code, i + 32, 32);
+}
+
+static void derive(const node_t *root, const uint32_t *path, size_t depth,
+                   node_t *out) {
+  *out = *root;
+  for (size_t d = 0; d < depth; d++)
+    ckd_hardened(out, path[d], out);
+}
+
+// BIP85 test master key xprv9s21ZrQH143K2LBWUUQRFXhucrQqBpKdRRxNVq2zBqsx8HVq
+// Fk2uYo8kmbaLLHRdqtQpUm98uKfu3vca1LqdGhUtyoFnCNkfmXRyPXLjbKb
+static node_t root;
+
+static void load_root(void) {
+  from_hex("3f15e5d852dc2e9ba5e9fe189a8dd2e1547badef5b563bbe6579fc6807d80ed9",
+           root.key);
+  from_hex("1b67969d1ec69bdfeeae43213da8460ba34b92d0788c8f7bfcfa44906e8a589c",
+           root.chain_code);
+}
+
+static void entropy_at(const uint32_t *path, size_t depth,
+                       uint8_t entropy[BIP85_ENTROPY_LEN]) {
+  node_t node;
+  derive(&root, path, depth, &node);
+  bip85_entropy_from_k(node.key, entropy);
+}
+
+/* ---------- Tests ---------- */
+
+static void test_entropy_from_k(void) {
+  TEST("Test cases 1 and 2 (derived key and entropy)");
+  static const struct {
+    uint32_t index;
+    const char *key;
+    const char *entropy;
+  } cases[] = {
+      {0, "cca20ccb0e9a90feb0912870c3323b24874b0ca3d8018c4b96d0b97c0e82ded0",
+       "efecfbccffea313214232d29e71563d941229afb4338c21f9517c41aaa0d16f0"
+       "0b83d2a09ef747e7a64e8e2bd5a14869e693da66ce94ac2da570ab7ee48618f7"},
+      {1, "503776919131758bb7de7beb6c0ae24894f4ec042c26032890c29359216e21ba",
+       "70c6e3e8ebee8dc4c0dbba66076819bb8c09672527c4277ca8729532ad711872"
+       "218f826919f6b67218adde99018a6df9095ab2b58d803b5b93ec9802085a690e"},
+  };
+
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    uint32_t path[3] = {BIP85_PURPOSE | 0x80000000u, 0x80000000u,
+                        cases[c].index | 0x80000000u};
+    node_t node;
+    derive(&root, path, 3, &node);
+    char hex[BIP85_ENTROPY_LEN * 2 + 1];
+    to_hex(node.key, 32, hex);
+    if (strcmp(hex, cases[c].key) != 0) {
+      FAIL("derived key");
+      return;
+    }
+    uint8_t entropy[BIP85_ENTROPY_LEN];
+    bip85_entropy_from_k(node.key, entropy);
+    to_hex(entropy, sizeof(entropy), hex);
+    if (strcmp(hex, cases[c].entropy) != 0) {
+      FAIL("entropy");
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_bip39(void) {
+  TEST("BIP39 child entropy (12, 18, 24 words)");
+  static const struct {
+    uint32_t words;
+    const char *entropy;
+  } cases[] = {
+      {12, "6250b68daf746d12a24d58b4787a714b"},
+      {18, "938033ed8b12698449d4bbca3c853c66b293ea1b1ce9d9dc"},
+      {24, "ae131e2312cdc61331542efe0d1077bac5ea803adf24b313a4f0e48e9c51f37f"},
+  };
+
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    uint32_t path[BIP85_MAX_PATH];
+    size_t depth = bip85_path(BIP85_APP_BIP39, cases[c].words, 0, path);
+    if (depth != 5) {
+      FAIL("path depth");
+      return;
+    }
+    uint8_t entropy[BIP85_ENTROPY_LEN];
+    entropy_at(path, depth, entropy);
+    size_t len = bip85_bip39_entropy_len(cases[c].words);
+    char hex[BIP85_ENTROPY_LEN * 2 + 1];
+    to_hex(entropy, len, hex);
+    if (len * 2 != strlen(cases[c].entropy) ||
+        strcmp(hex, cases[c].entropy) != 0) {
+      FAIL(cases[c].entropy);
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_text_apps(void) {
+  TEST("HEX, base64 and base85 passwords");
+  static const struct {
+    bip85_app_t app;
+    uint32_t param;
+    const char *expected;
+  } cases[] = {
+      {BIP85_APP_HEX, 64,
+       "492db4698cf3b73a5a24998aa3e9d7fa96275d85724a91e71aa2d645442f8785"
+       "55d078fd1f1f67e368976f04137b1f7a0d19232136ca50c44614af72b5582a5c"},
+      {BIP85_APP_PWD_BASE64, 21, "dKLoepugzdVJvdL56ogNV"},
+      {BIP85_APP_PWD_BASE85, 12, "_s`{TW89)i4`"},
+  };
+
+  for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    uint32_t path[BIP85_MAX_PATH];
+    size_t depth = bip85_path(cases[c].app, cases[c].param, 0, path);
+    uint8_t entropy[BIP85_ENTROPY_LEN];
+    entropy_at(path, depth, entropy);
+    char out[BIP85_ENTROPY_LEN * 2 + 1];
+    if (bip85_format(cases[c].app, cases[c].param, entropy, out,
+                     sizeof(out)) != BIP85_OK ||
+        strcmp(out, cases[c].expected) != 0) {
+      FAIL(cases[c].expected);
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_params(void) {
+  TEST("Parameter and buffer checks");
+  uint32_t path[BIP85_MAX_PATH];
+  uint8_t entropy[BIP85_ENTROPY_LEN] = {0};
+  char out[200];
+
+  if (bip85_path(BIP85_APP_BIP39, 15, 0, path) != 0 ||
+      bip85_path(BIP85_APP_HEX, 15, 0, path) != 0 ||
+      bip85_path(BIP85_APP_HEX, 16, 0x80000000u, path) != 0 ||
+      bip85_path(BIP85_APP_PWD_BASE64, 87, 0, path) != 0 ||
+      bip85_path(BIP85_APP_PWD_BASE85, 9, 0, path) != 0) {
+    FAIL("out-of-range parameter accepted");
+    return;
+  }
+  if (bip85_path(BIP85_APP_HEX, 32, 7, path) != 4 ||
+      path[3] != (7 | 0x80000000u) || path[2] != (32 | 0x80000000u)) {
+    FAIL("hex path layout");
+    return;
+  }
+  if (bip85_format(BIP85_APP_BIP39, 12, entropy, out, sizeof(out)) !=
+          BIP85_ERR_INVALID_ARG ||
+      bip85_format(BIP85_APP_HEX, 64, entropy, out, 128) != BIP85_ERR_BUFFER ||
+      bip85_format(BIP85_APP_PWD_BASE64, 86, entropy, out, 87) != BIP85_OK ||
+      strlen(out) != 86 ||
+      bip85_format(BIP85_APP_PWD_BASE85, 80, entropy, out, 81) != BIP85_OK ||
+      strlen(out) != 80) {
+    FAIL("format lengths");
+    return;
+  }
+  PASS();
+}
+
+static void test_parent_reuse(void) {
+  TEST("Consecutive indices from a kept parent match full derivations");
+  uint32_t path[BIP85_MAX_PATH];
+  size_t depth = bip85_path(BIP85_APP_BIP39, 24, 0, path);
+  node_t parent;
+  derive(&root, path, depth - 1, &parent);
+
+  for (uint32_t index = 0; index < 8; index++) {
+    bip85_path(BIP85_APP_BIP39, 24, index, path);
+    node_t full, child;
+    derive(&root, path, depth, &full);
+    ckd_hardened(&parent, path[depth - 1], &child);
+    if (memcmp(full.key, child.key, 32) != 0) {
+      FAIL("child differs");
+      return;
+    }
+  }
+  PASS();
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench(void) {
+  uint32_t path[BIP85_MAX_PATH];
+  uint8_t entropy[BIP85_ENTROPY_LEN];
+  volatile uint8_t sink = 0;
+  const int iters = 2000;
+
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++) {
+    size_t depth = bip85_path(BIP85_APP_BIP39, 12, (uint32_t)i, path);
+    entropy_at(path, depth, entropy);
+    sink ^= entropy[0];
+  }
+  double t1 = now_ms();
+
+  size_t depth = bip85_path(BIP85_APP_BIP39, 12, 0, path);
+  node_t parent, child;
+  double t2 = now_ms();
+  derive(&root, path, depth - 1, &parent);
+  for (int i = 0; i < iters; i++) {
+    ckd_hardened(&parent, (uint32_t)i | 0x80000000u, &child);
+    bip85_entropy_from_k(child.key, entropy);
+    sink ^= entropy[0];
+  }
+  double t3 = now_ms();
+  (void)sink;
+
+  printf("\nBenchmark (%d consecutive indices, HMAC cost only):\n", iters);
+  printf("  From the master each time: %.2f us/index\n",
+         (t1 - t0) * 1000.0 / iters);
+  printf("  From the kept parent:      %.2f us/index\n",
+         (t3 - t2) * 1000.0 / iters);
+}
+
+int main(void) {
+  printf("=== BIP85 Tests ===\n\n");
+
+  load_root();
+  test_entropy_from_k();
+  test_bip39();
+  test_text_apps();
+  test_params();
+  test_parent_reuse();
+
+  bench();
+
+  printf("\nResults: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+#ifndef DESCRIPTOR_REGISTRY_H
+#define DESCRIPTOR_REGISTRY_H
+
+#include "descriptor_scan.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Registry of multisig descriptors, matched by their key origins
+ *
+ * Each stored descriptor is indexed by its script type and the set of
+ * (fingerprint, origin path) pairs of its keys. A key's origin fixes the
+ * xpub it was derived to, and it is what a PSBT's BIP32 keypaths carry, so
+ * the cosigner keypaths of one PSBT input (minus the trailing change/index)
+ * form the same set and find the descriptor with one hash lookup,
+ * independent of how many descriptors are stored.
+ *
+ * Descriptors differing only in threshold share a key set; a query with a
+ * threshold (from the witness script) tells them apart, one without reports
+ * them as ambiguous.
+ */
+
+typedef enum {
+  DESC_REG_SCRIPT_SH = 0,     // sh(multi)
+  DESC_REG_SCRIPT_SH_WSH = 1, // sh(wsh(multi))
+  DESC_REG_SCRIPT_WSH = 2,    // wsh(multi)
+} desc_reg_script_t;
+
+typedef struct {
+  uint8_t fingerprint[4];
+  uint32_t path[DESC_SCAN_MAX_PATH]; // Hardened elements have the top bit
+  size_t depth;
+} desc_reg_origin_t;
+
+typedef struct {
+  desc_reg_script_t script;
+  uint32_t threshold; // 0 if unknown
+  size_t num_keys;
+  desc_reg_origin_t keys[DESC_SCAN_MAX_KEYS];
+} desc_reg_query_t;
+
+typedef enum {
+  DESC_REG_MATCH_NONE = 0,
+  DESC_REG_MATCH_FOUND,
+  DESC_REG_MATCH_AMBIGUOUS, // Several descriptors fit the query
+} desc_reg_match_t;
+
+typedef struct desc_registry desc_registry_t;
+
+/**
+ * @brief Create an empty registry
+ * @return New registry, or NULL on allocation failure
+ */
+desc_registry_t *desc_registry_create(void);
+
+/**
+ * @brief Index a descriptor
+ *
+ * Only sh/sh-wsh/wsh multi() and sortedmulti() descriptors whose keys all
+ * carry an origin can be matched; anything else is rejected.
+ *
+ * @param str Descriptor text, with or without checksum
+ * @param len Length of str
+ * @param id Caller's name for the descriptor (copied), e.g. its filename
+ * @param tag Caller's value returned with matches, e.g. its storage location
+ * @return false if the descriptor can't be indexed or allocation failed
+ */
+bool desc_registry_add(desc_registry_t *reg, const char *str, size_t len,
+                       const char *id, uint32_t tag);
+
+/**
+ * @brief Number of indexed descriptors
+ */
+size_t desc_registry_count(const desc_registry_t *reg);
+
+/**
+ * @brief Find the descriptor for a set of key origins
+ *
+ * Key order in the query does not matter.
+ *
+ * @param id_out Receives the matching id (owned by the registry), if found
+ * @param tag_out Receives the matching tag, if found (may be NULL)
+ */
+desc_reg_match_t desc_registry_match(const desc_registry_t *reg,
+                                     const desc_reg_query_t *query,
+                                     const char **id_out, uint32_t *tag_out);
+
+/**
+ * @brief Free a registry and its ids
+ */
+void desc_registry_destroy(desc_registry_t *reg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DESCRIPTOR_REGISTRY_H
@@ -0,0 +1,259 @@
+/*
+ * Registry of multisig descriptors, matched by their key origins
+ *
+ * Chained hash table keyed on a 64-bit FNV-1a hash of the script type and
+ * the sorted origin set. Each entry keeps its sorted origins, so a lookup
+ * compares the full set and never trusts the hash alone.
+ */
+
+#include "descriptor_registry.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_BUCKETS 16
+
+typedef struct reg_entry {
+  struct reg_entry *next;
+  uint64_t hash;
+  desc_reg_script_t script;
+  uint32_t threshold;
+  size_t num_keys;
+  desc_reg_origin_t *keys; // Sorted
+  char *id;
+  uint32_t tag;
+} reg_entry_t;
+
+struct desc_registry {
+  reg_entry_t **buckets;
+  size_t num_buckets; // Power of two
+  size_t count;
+};
+
+static int origin_cmp(const void *a, const void *b) {
+  const desc_reg_origin_t *x = a;
+  const desc_reg_origin_t *y = b;
+  int c = memcmp(x->fingerprint, y->fingerprint, sizeof(x->fingerprint));
+  if (c != 0)
+    return c;
+  size_t depth = x->depth < y->depth ? x->depth : y->depth;
+  for (size_t i = 0; i < depth; i++) {
+    if (x->path[i] != y->path[i])
+      return x->path[i] < y->path[i] ? -1 : 1;
+  }
+  return (x->depth > y->depth) - (x->depth < y->depth);
+}
+
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len) {
+  const uint8_t *p = data;
+  for (size_t i = 0; i < len; i++) {
+    h ^= p[i];
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+static uint64_t hash_key_set(desc_reg_script_t script,
+                             const desc_reg_origin_t *sorted, size_t n) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  uint8_t s = (uint8_t)script;
+  h = fnv1a(h, &s, 1);
+  for (size_t i = 0; i < n; i++) {
+    uint8_t depth = (uint8_t)sorted[i].depth;
+    h = fnv1a(h, sorted[i].fingerprint, sizeof(sorted[i].fingerprint));
+    h = fnv1a(h, &depth, 1);
+    for (size_t j = 0; j < sorted[i].depth; j++) {
+      uint8_t b[4] = {(uint8_t)sorted[i].path[j],
+                      (uint8_t)(sorted[i].path[j] >> 8),
+                      (uint8_t)(sorted[i].path[j] >> 16),
+                      (uint8_t)(sorted[i].path[j] >> 24)};
+      h = fnv1a(h, b, sizeof(b));
+    }
+  }
+  return h;
+}
+
+static bool same_key_set(const reg_entry_t *e, desc_reg_script_t script,
+                         const desc_reg_origin_t *sorted, size_t n) {
+  if (e->script != script || e->num_keys != n)
+    return false;
+  for (size_t i = 0; i < n; i++) {
+    if (origin_cmp(&e->keys[i], &sorted[i]) != 0)
+      return false;
+  }
+  return true;
+}
+
+static bool script_from_scan(const char *script, desc_reg_script_t *out) {
+  if (strcmp(script, "wsh(multi") == 0 ||
+      strcmp(script, "wsh(sortedmulti") == 0) {
+    *out = DESC_REG_SCRIPT_WSH;
+  } else if (strcmp(script, "sh(wsh(multi") == 0 ||
+             strcmp(script, "sh(wsh(sortedmulti") == 0) {
+    *out = DESC_REG_SCRIPT_SH_WSH;
+  } else if (strcmp(script, "sh(multi") == 0 ||
+             strcmp(script, "sh(sortedmulti") == 0) {
+    *out = DESC_REG_SCRIPT_SH;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool grow(desc_registry_t *reg) {
+  size_t num_buckets = reg->num_buckets * 2;
+  reg_entry_t **buckets = calloc(num_buckets, sizeof(*buckets));
+  if (!buckets)
+    return false;
+
+  for (size_t i = 0; i < reg->num_buckets; i++) {
+    reg_entry_t *e = reg->buckets[i];
+    while (e) {
+      reg_entry_t *next = e->next;
+      size_t b = (size_t)e->hash & (num_buckets - 1);
+      e->next = buckets[b];
+      buckets[b] = e;
+      e = next;
+    }
+  }
+  free(reg->buckets);
+  reg->buckets = buckets;
+  reg->num_buckets = num_buckets;
+  return true;
+}
+
+desc_registry_t *desc_registry_create(void) {
+  desc_registry_t *reg = calloc(1, sizeof(*reg));
+  if (!reg)
+    return NULL;
+  reg->buckets = calloc(INITIAL_BUCKETS, sizeof(*reg->buckets));
+  if (!reg->buckets) {
+    free(reg);
+    return NULL;
+  }
+  reg->num_buckets = INITIAL_BUCKETS;
+  return reg;
+}
+
+bool desc_registry_add(desc_registry_t *reg, const char *str, size_t len,
+                       const char *id, uint32_t tag) {
+  if (!reg || !str || !id)
+    return false;
+
+  desc_scan_t *scan = malloc(sizeof(*scan));
+  if (!scan)
+    return false;
+
+  desc_reg_script_t script;
+  bool ok = desc_scan(str, len, scan) == DESC_SCAN_OK &&
+            scan->threshold > 0 && scan->num_keys > 0 &&
+            script_from_scan(scan->script, &script);
+  for (size_t i = 0; ok && i < scan->num_keys; i++) {
+    ok = scan->keys[i].has_origin &&
+         scan->keys[i].path_depth <= DESC_SCAN_MAX_PATH;
+  }
+
+  reg_entry_t *e = NULL;
+  if (ok) {
+    e = calloc(1, sizeof(*e));
+    ok = e != NULL;
+  }
+  if (ok) {
+    e->keys = malloc(scan->num_keys * sizeof(*e->keys));
+    e->id = strdup(id);
+    ok = e->keys && e->id;
+  }
+  if (!ok) {
+    if (e) {
+      free(e->keys);
+      free(e->id);
+      free(e);
+    }
+    free(scan);
+    return false;
+  }
+
+  for (size_t i = 0; i < scan->num_keys; i++) {
+    const desc_scan_key_t *k = &scan->keys[i];
+    memcpy(e->keys[i].fingerprint, k->fingerprint, sizeof(k->fingerprint));
+    memcpy(e->keys[i].path, k->path, k->path_depth * sizeof(uint32_t));
+    e->keys[i].depth = k->path_depth;
+  }
+  e->num_keys = scan->num_keys;
+  e->script = script;
+  e->threshold = scan->threshold;
+  e->tag = tag;
+  free(scan);
+
+  qsort(e->keys, e->num_keys, sizeof(*e->keys), origin_cmp);
+  e->hash = hash_key_set(e->script, e->keys, e->num_keys);
+
+  // Keep chains short: grow at a load factor of 3/4
+  if ((reg->count + 1) * 4 > reg->num_buckets * 3)
+    grow(reg);
+
+  size_t b = (size_t)e->hash & (reg->num_buckets - 1);
+  e->next = reg->buckets[b];
+  reg->buckets[b] = e;
+  reg->count++;
+  return true;
+}
+
+size_t desc_registry_count(const desc_registry_t *reg) {
+  return reg ? reg->count : 0;
+}
+
+desc_reg_match_t desc_registry_match(const desc_registry_t *reg,
+                                     const desc_reg_query_t *query,
+                                     const char **id_out, uint32_t *tag_out) {
+  if (!reg || !query || query->num_keys == 0 ||
+      query->num_keys > DESC_SCAN_MAX_KEYS)
+    return DESC_REG_MATCH_NONE;
+
+  desc_reg_origin_t sorted[DESC_SCAN_MAX_KEYS];
+  memcpy(sorted, query->keys, query->num_keys * sizeof(sorted[0]));
+  qsort(sorted, query->num_keys, sizeof(sorted[0]), origin_cmp);
+  uint64_t hash = hash_key_set(query->script, sorted, query->num_keys);
+
+  const reg_entry_t *found = NULL;
+  size_t matches = 0;
+  for (const reg_entry_t *e = reg->buckets[hash & (reg->num_buckets - 1)]; e;
+       e = e->next) {
+    if (e->hash != hash ||
+        !same_key_set(e, query->script, sorted, query->num_keys))
+      continue;
+    if (query->threshold != 0 && e->threshold != query->threshold)
+      continue;
+    // The same descriptor stored twice (flash and SD) is not ambiguous
+    if (found && found->threshold == e->threshold)
+      continue;
+    found = e;
+    matches++;
+  }
+
+  if (matches == 0)
+    return DESC_REG_MATCH_NONE;
+  if (matches > 1)
+    return DESC_REG_MATCH_AMBIGUOUS;
+  if (id_out)
+    *id_out = found->id;
+  if (tag_out)
+    *tag_out = found->tag;
+  return DESC_REG_MATCH_FOUND;
+}
+
+void desc_registry_destroy(desc_registry_t *reg) {
+  if (!reg)
+    return;
+  for (size_t i = 0; i < reg->num_buckets; i++) {
+    reg_entry_t *e = reg->buckets[i];
+    while (e) {
+      reg_entry_t *next = e->next;
+      free(e->keys);
+      free(e->id);
+      free(e);
+      e = next;
+    }
+  }
+  free(reg->buckets);
+  free(reg);
+}
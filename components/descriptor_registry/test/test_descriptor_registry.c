@@ -0,0 +1,320 @@
+/*
+ * Descriptor Registry Test Suite
+ * Compile with: make
+ * Run: ./test_descriptor_registry
+ *
+ * Quorums are synthetic: wsh/sh-wsh/sh sortedmulti descriptors whose keys
+ * are fake xpubs with distinct [fingerprint/48h/coinh/accounth/scripth]
+ * origins. Queries are built the way the PSBT side builds them, from those
+ * origins in arbitrary order.
+ */
+
+#include "descriptor_registry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+#define H DESC_SCAN_HARDENED
+
+/* ---------- Fixtures ---------- */
+
+static const char *script_prefix(desc_reg_script_t script) {
+  switch (script) {
+  case DESC_REG_SCRIPT_SH:
+    return "sh(sortedmulti(";
+  case DESC_REG_SCRIPT_SH_WSH:
+    return "sh(wsh(sortedmulti(";
+  default:
+    return "wsh(sortedmulti(";
+  }
+}
+
+static uint32_t script_path_element(desc_reg_script_t script) {
+  return script == DESC_REG_SCRIPT_SH_WSH ? 1 : 2;
+}
+
+/* Quorum q: n keys, key i has fingerprint (q * 32 + i + 1) and origin
+ * 48h/0h/<q % 7>h/<script>h */
+static char *make_quorum(uint32_t q, desc_reg_script_t script, int k, int n) {
+  size_t cap = 64 + (size_t)n * 160;
+  char *s = malloc(cap);
+  if (!s)
+    return NULL;
+  int off = snprintf(s, cap, "%s%d", script_prefix(script), k);
+  for (int i = 0; i < n; i++) {
+    off += snprintf(s + off, cap - off,
+                    ",[%08x/48h/0h/%uh/%uh]xpub6Fake%02dKeyMaterialAAAAAAAAAA"
+                    "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA/<0;1>/*",
+                    q * 32 + (uint32_t)i + 1, q % 7,
+                    script_path_element(script), i);
+  }
+  snprintf(s + off, cap - off, "%s",
+           script == DESC_REG_SCRIPT_SH_WSH ? ")))" : "))");
+  return s;
+}
+
+static void make_query(desc_reg_query_t *query, uint32_t q,
+                       desc_reg_script_t script, uint32_t threshold, int n,
+                       uint32_t rotate) {
+  memset(query, 0, sizeof(*query));
+  query->script = script;
+  query->threshold = threshold;
+  query->num_keys = (size_t)n;
+  for (int j = 0; j < n; j++) {
+    int i = (int)((j + rotate) % (uint32_t)n);
+    uint32_t fp = q * 32 + (uint32_t)i + 1;
+    desc_reg_origin_t *o = &query->keys[j];
+    o->fingerprint[0] = (uint8_t)(fp >> 24);
+    o->fingerprint[1] = (uint8_t)(fp >> 16);
+    o->fingerprint[2] = (uint8_t)(fp >> 8);
+    o->fingerprint[3] = (uint8_t)fp;
+    o->path[0] = 48 | H;
+    o->path[1] = 0 | H;
+    o->path[2] = (q % 7) | H;
+    o->path[3] = script_path_element(script) | H;
+    o->depth = 4;
+  }
+}
+
+static bool add_quorum(desc_registry_t *reg, uint32_t q,
+                       desc_reg_script_t script, int k, int n, uint32_t tag) {
+  char *desc = make_quorum(q, script, k, n);
+  char id[32];
+  snprintf(id, sizeof(id), "q%u_%d", q, k);
+  bool ok = desc && desc_registry_add(reg, desc, strlen(desc), id, tag);
+  free(desc);
+  return ok;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_match_many_quorums(void) {
+  TEST("1000 quorums each found by their own origins");
+  desc_registry_t *reg = desc_registry_create();
+  for (uint32_t q = 0; q < 1000; q++) {
+    int n = 2 + (int)(q % 14);
+    if (!add_quorum(reg, q, (desc_reg_script_t)(q % 3), 1 + (int)(q % n), n,
+                    q)) {
+      FAIL("add failed");
+      desc_registry_destroy(reg);
+      return;
+    }
+  }
+  if (desc_registry_count(reg) != 1000) {
+    FAIL("wrong count");
+    desc_registry_destroy(reg);
+    return;
+  }
+
+  for (uint32_t q = 0; q < 1000; q++) {
+    int n = 2 + (int)(q % 14);
+    desc_reg_query_t query;
+    make_query(&query, q, (desc_reg_script_t)(q % 3), 0, n, q);
+    const char *id = NULL;
+    uint32_t tag = 0;
+    char expected[32];
+    snprintf(expected, sizeof(expected), "q%u_%d", q, 1 + (int)(q % n));
+    if (desc_registry_match(reg, &query, &id, &tag) != DESC_REG_MATCH_FOUND ||
+        tag != q || strcmp(id, expected) != 0) {
+      FAIL("quorum not matched");
+      desc_registry_destroy(reg);
+      return;
+    }
+  }
+  desc_registry_destroy(reg);
+  PASS();
+}
+
+static void test_key_order(void) {
+  TEST("Key order does not matter");
+  desc_registry_t *reg = desc_registry_create();
+  add_quorum(reg, 5, DESC_REG_SCRIPT_WSH, 2, 3, 7);
+  for (uint32_t r = 0; r < 3; r++) {
+    desc_reg_query_t query;
+    make_query(&query, 5, DESC_REG_SCRIPT_WSH, 2, 3, r);
+    if (desc_registry_match(reg, &query, NULL, NULL) !=
+        DESC_REG_MATCH_FOUND) {
+      FAIL("rotated query not matched");
+      desc_registry_destroy(reg);
+      return;
+    }
+  }
+  // Swap two keys inside the query as well
+  desc_reg_query_t query;
+  make_query(&query, 5, DESC_REG_SCRIPT_WSH, 2, 3, 0);
+  desc_reg_origin_t tmp = query.keys[0];
+  query.keys[0] = query.keys[2];
+  query.keys[2] = tmp;
+  if (desc_registry_match(reg, &query, NULL, NULL) != DESC_REG_MATCH_FOUND)
+    FAIL("permuted query not matched");
+  else
+    PASS();
+  desc_registry_destroy(reg);
+}
+
+static void test_mismatch(void) {
+  TEST("Unknown cosigners, script or subset are not matched");
+  desc_registry_t *reg = desc_registry_create();
+  add_quorum(reg, 3, DESC_REG_SCRIPT_WSH, 2, 3, 0);
+
+  desc_reg_query_t query;
+  make_query(&query, 4, DESC_REG_SCRIPT_WSH, 2, 3, 0);
+  if (desc_registry_match(reg, &query, NULL, NULL) != DESC_REG_MATCH_NONE) {
+    FAIL("other quorum matched");
+    goto out;
+  }
+
+  make_query(&query, 3, DESC_REG_SCRIPT_WSH, 2, 3, 0);
+  query.script = DESC_REG_SCRIPT_SH_WSH;
+  if (desc_registry_match(reg, &query, NULL, NULL) != DESC_REG_MATCH_NONE) {
+    FAIL("other script type matched");
+    goto out;
+  }
+
+  make_query(&query, 3, DESC_REG_SCRIPT_WSH, 2, 3, 0);
+  query.num_keys = 2;
+  if (desc_registry_match(reg, &query, NULL, NULL) != DESC_REG_MATCH_NONE) {
+    FAIL("key subset matched");
+    goto out;
+  }
+
+  make_query(&query, 3, DESC_REG_SCRIPT_WSH, 2, 3, 0);
+  query.keys[1].path[2] = 6 | H;
+  if (desc_registry_match(reg, &query, NULL, NULL) != DESC_REG_MATCH_NONE) {
+    FAIL("other account matched");
+    goto out;
+  }
+
+  make_query(&query, 3, DESC_REG_SCRIPT_WSH, 3, 3, 0);
+  if (desc_registry_match(reg, &query, NULL, NULL) != DESC_REG_MATCH_NONE) {
+    FAIL("other threshold matched");
+    goto out;
+  }
+  PASS();
+out:
+  desc_registry_destroy(reg);
+}
+
+static void test_ambiguous(void) {
+  TEST("Same keys with different thresholds");
+  desc_registry_t *reg = desc_registry_create();
+  add_quorum(reg, 9, DESC_REG_SCRIPT_WSH, 2, 3, 1);
+  add_quorum(reg, 9, DESC_REG_SCRIPT_WSH, 3, 3, 2);
+  // A copy of the 2-of-3 (e.g. flash and SD) does not add ambiguity
+  add_quorum(reg, 9, DESC_REG_SCRIPT_WSH, 2, 3, 3);
+
+  desc_reg_query_t query;
+  make_query(&query, 9, DESC_REG_SCRIPT_WSH, 0, 3, 0);
+  if (desc_registry_match(reg, &query, NULL, NULL) !=
+      DESC_REG_MATCH_AMBIGUOUS) {
+    FAIL("unknown threshold not ambiguous");
+    goto out;
+  }
+
+  uint32_t tag = 0;
+  make_query(&query, 9, DESC_REG_SCRIPT_WSH, 3, 3, 1);
+  if (desc_registry_match(reg, &query, NULL, &tag) != DESC_REG_MATCH_FOUND ||
+      tag != 2) {
+    FAIL("threshold did not disambiguate");
+    goto out;
+  }
+
+  make_query(&query, 9, DESC_REG_SCRIPT_WSH, 2, 3, 2);
+  if (desc_registry_match(reg, &query, NULL, &tag) != DESC_REG_MATCH_FOUND) {
+    FAIL("duplicate descriptor reported as ambiguous");
+    goto out;
+  }
+  PASS();
+out:
+  desc_registry_destroy(reg);
+}
+
+static void test_rejects(void) {
+  TEST("Non-multisig and origin-less descriptors rejected");
+  desc_registry_t *reg = desc_registry_create();
+  static const char *bad[] = {
+      "pkh([d34db33f/44h/0h/0h]xpub6Fake/0/*)",
+      "tr([d34db33f/86h/0h/0h]xpub6Fake/0/*)",
+      "wsh(sortedmulti(1,xpub6FakeA/0/*,"
+      "[d34db33f/48h/0h/0h/2h]xpub6FakeB/0/*))",
+      "wsh(sortedmulti(1,[d34db33f/48h/0h/0h/2h]xpub6FakeB/0/*))#00000000",
+      "not a descriptor",
+  };
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    if (desc_registry_add(reg, bad[i], strlen(bad[i]), "bad", 0)) {
+      FAIL(bad[i]);
+      desc_registry_destroy(reg);
+      return;
+    }
+  }
+  if (desc_registry_count(reg) != 0)
+    FAIL("rejected descriptor counted");
+  else
+    PASS();
+  desc_registry_destroy(reg);
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench_match(void) {
+  printf("\nMatch 3-of-5 wsh quorum, per lookup:\n");
+  static const uint32_t sizes[] = {10, 100, 1000, 10000};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    desc_registry_t *reg = desc_registry_create();
+    for (uint32_t q = 0; q < sizes[s]; q++)
+      add_quorum(reg, q, DESC_REG_SCRIPT_WSH, 3, 5, q);
+
+    const int iters = 100000;
+    desc_reg_query_t query;
+    volatile size_t sink = 0;
+    double t0 = now_ms();
+    for (int i = 0; i < iters; i++) {
+      uint32_t q = (uint32_t)i % sizes[s];
+      make_query(&query, q, DESC_REG_SCRIPT_WSH, 3, 5, (uint32_t)i);
+      sink += desc_registry_match(reg, &query, NULL, NULL);
+    }
+    double t1 = now_ms();
+    (void)sink;
+    printf("  %5u descriptors: %.3f us\n", sizes[s],
+           (t1 - t0) * 1000.0 / iters);
+    desc_registry_destroy(reg);
+  }
+  printf("\n");
+}
+
+int main(void) {
+  printf("=== Descriptor Registry Tests ===\n\n");
+
+  test_match_many_quorums();
+  test_key_order();
+  test_mismatch();
+  test_ambiguous();
+  test_rejects();
+
+  bench_match();
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
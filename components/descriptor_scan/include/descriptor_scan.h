@@ -0,0 +1,100 @@
+#ifndef DESCRIPTOR_SCAN_H
+#define DESCRIPTOR_SCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Single-pass output descriptor scanner
+ *
+ * Walks a descriptor string once, computing the BIP-380 checksum while
+ * tokenizing, and records the script nesting, multisig threshold and every
+ * key expression (origin fingerprint and path, extended key, multipath).
+ *
+ * This is a lexical scan, not a validator: keys are not decoded and
+ * miniscript semantics are not checked. Full parsing (libwally) is still
+ * required before a descriptor is used; the scan saves the callers from
+ * re-parsing the string for the fields they display or compare.
+ *
+ * All offsets refer to the scanned string.
+ */
+
+#define DESC_SCAN_MAX_KEYS 20 // multi() limit
+#define DESC_SCAN_MAX_PATH 8  // Origin path elements kept per key
+#define DESC_SCAN_CHECKSUM_LEN 8
+
+#define DESC_SCAN_HARDENED 0x80000000u
+
+typedef enum {
+  DESC_SCAN_OK = 0,
+  DESC_SCAN_ERR_ARG,           // NULL input
+  DESC_SCAN_ERR_CHAR,          // Character outside the descriptor charset
+  DESC_SCAN_ERR_SYNTAX,        // Unbalanced brackets, empty names, ...
+  DESC_SCAN_ERR_CHECKSUM,      // '#' suffix present but wrong
+  DESC_SCAN_ERR_KEY,           // Malformed key expression
+  DESC_SCAN_ERR_TOO_MANY_KEYS, // More than DESC_SCAN_MAX_KEYS
+} desc_scan_error_t;
+
+typedef struct {
+  size_t offset; // Whole key expression
+  size_t len;
+
+  bool has_origin;
+  uint8_t fingerprint[4];
+  size_t path_offset; // Origin path text after the fingerprint, e.g. 48h/0h
+  size_t path_len;
+  uint32_t path[DESC_SCAN_MAX_PATH]; // Hardened elements have the top bit
+  size_t path_depth;                 // May exceed DESC_SCAN_MAX_PATH
+
+  size_t xpub_offset; // Key itself, without origin or child path
+  size_t xpub_len;
+
+  uint32_t num_paths; // 2 for /<0;1>/*, otherwise 1
+  bool wildcard;      // Ends in /* or /*h
+} desc_scan_key_t;
+
+typedef struct {
+  size_t body_len;   // Length before '#'
+  bool has_checksum; // A '#' suffix was present (and matched)
+  char checksum[DESC_SCAN_CHECKSUM_LEN + 1]; // Computed over the body
+
+  char script[24];    // Outer functions, e.g. "wsh(sortedmulti"
+  uint32_t threshold; // k of the first multi()/sortedmulti(), else 0
+  bool sorted;        // sortedmulti / sortedmulti_a
+  uint32_t num_paths; // Largest multipath count over all keys
+
+  size_t num_keys;
+  desc_scan_key_t keys[DESC_SCAN_MAX_KEYS];
+} desc_scan_t;
+
+/**
+ * @brief Scan a descriptor, with or without its '#checksum' suffix
+ *
+ * @param str Descriptor text (need not be NUL-terminated)
+ * @param len Length of str
+ * @param out Receives the scan result
+ */
+desc_scan_error_t desc_scan(const char *str, size_t len, desc_scan_t *out);
+
+/**
+ * @brief BIP-380 checksum of a descriptor body (no '#')
+ *
+ * @param out Receives 8 characters plus NUL
+ * @return false if str contains characters outside the descriptor charset
+ */
+bool desc_scan_checksum(const char *str, size_t len,
+                        char out[DESC_SCAN_CHECKSUM_LEN + 1]);
+
+/** @brief Short description of a scan error */
+const char *desc_scan_error_str(desc_scan_error_t err);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DESCRIPTOR_SCAN_H
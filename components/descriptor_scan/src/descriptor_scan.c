@@ -0,0 +1,439 @@
+#include "descriptor_scan.h"
+#include <string.h>
+
+/*
+ * BIP-380 checksum.
+ *
+ * desc_pos maps each printable character (offset by ' ') to its position in
+ * the input charset plus one; 0 marks characters not allowed in descriptors.
+ * The low 5 bits of the position feed the polymod directly, and every three
+ * characters the high bits (group 0..2) are packed into one extra symbol.
+ *
+ * Algorithm adapted from bitcoin-core / libwally descriptor.c.
+ */
+
+// clang-format off
+static const unsigned char desc_pos[] = {
+  0x5f,0x3c,0x5d,0x5c,0x1d,0x1e,0x33,0x10,0x0b,0x0c,0x12,0x34,0x0f,0x35,0x36,0x11,
+  0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x1c,0x37,0x38,0x39,0x3a,0x3b,
+  0x1b,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x21,0x22,0x23,0x24,0x25,0x26,0x27,
+  0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,0x30,0x31,0x32,0x0d,0x5e,0x0e,0x3d,0x3e,
+  0x5b,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x41,0x42,0x43,0x44,0x45,0x46,0x47,
+  0x48,0x49,0x4a,0x4b,0x4c,0x4d,0x4e,0x4f,0x50,0x51,0x52,0x1f,0x3f,0x20,0x40
+};
+
+/* XOR of the generator constants selected by each 5-bit overflow value,
+ * i.e. gen[i] = sum over set bits b of i of G[b]. Replaces five
+ * data-dependent branches per symbol with one load. */
+static const uint64_t polymod_gen[32] = {
+  0x0000000000ULL, 0xf5dee51989ULL, 0xa9fdca3312ULL, 0x5c232f2a9bULL,
+  0x1bab10e32dULL, 0xee75f5faa4ULL, 0xb256dad03fULL, 0x47883fc9b6ULL,
+  0x3706b1677aULL, 0xc2d8547ef3ULL, 0x9efb7b5468ULL, 0x6b259e4de1ULL,
+  0x2cada18457ULL, 0xd973449ddeULL, 0x85506bb745ULL, 0x708e8eaeccULL,
+  0x644d626ffdULL, 0x9193877674ULL, 0xcdb0a85cefULL, 0x386e4d4566ULL,
+  0x7fe6728cd0ULL, 0x8a38979559ULL, 0xd61bb8bfc2ULL, 0x23c55da64bULL,
+  0x534bd30887ULL, 0xa69536110eULL, 0xfab6193b95ULL, 0x0f68fc221cULL,
+  0x48e0c3ebaaULL, 0xbd3e26f223ULL, 0xe11d09d8b8ULL, 0x14c3ecc131ULL,
+};
+// clang-format on
+
+static const char checksum_charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+typedef struct {
+  uint64_t c;
+  int cls;
+  int clscount;
+} checksum_state_t;
+
+static inline uint64_t polymod(uint64_t c, unsigned val) {
+  return ((c & 0x7ffffffffULL) << 5) ^ val ^ polymod_gen[c >> 35];
+}
+
+static inline unsigned char_pos(char ch) {
+  unsigned char u = (unsigned char)ch;
+  if (u < ' ' || u > '~')
+    return 0;
+  return desc_pos[u - ' '];
+}
+
+static inline void checksum_feed(checksum_state_t *s, unsigned pos) {
+  --pos;
+  s->c = polymod(s->c, pos & 31);
+  s->cls = s->cls * 3 + (int)(pos >> 5);
+  if (++s->clscount == 3) {
+    s->c = polymod(s->c, (unsigned)s->cls);
+    s->cls = 0;
+    s->clscount = 0;
+  }
+}
+
+static void checksum_finish(checksum_state_t *s, char out[9]) {
+  uint64_t c = s->c;
+  if (s->clscount > 0)
+    c = polymod(c, (unsigned)s->cls);
+  for (int i = 0; i < 8; i++)
+    c = polymod(c, 0);
+  c ^= 1;
+  for (int i = 0; i < 8; i++)
+    out[i] = checksum_charset[(c >> (5 * (7 - i))) & 31];
+  out[8] = '\0';
+}
+
+bool desc_scan_checksum(const char *str, size_t len,
+                        char out[DESC_SCAN_CHECKSUM_LEN + 1]) {
+  if (!str || !out)
+    return false;
+  checksum_state_t s = {.c = 1};
+  for (size_t i = 0; i < len; i++) {
+    unsigned pos = char_pos(str[i]);
+    if (pos == 0)
+      return false;
+    checksum_feed(&s, pos);
+  }
+  checksum_finish(&s, out);
+  return true;
+}
+
+/* ---------- Key expressions ---------- */
+
+static bool is_hardened_marker(char ch) {
+  return ch == '\'' || ch == 'h' || ch == 'H';
+}
+
+static int hex_value(char ch) {
+  if (ch >= '0' && ch <= '9')
+    return ch - '0';
+  if (ch >= 'a' && ch <= 'f')
+    return ch - 'a' + 10;
+  if (ch >= 'A' && ch <= 'F')
+    return ch - 'A' + 10;
+  return -1;
+}
+
+/* Parses a decimal path element (< 2^31) starting at *i, advancing *i */
+static bool parse_index(const char *s, size_t *i, size_t end, uint32_t *out) {
+  uint32_t v = 0;
+  size_t start = *i;
+  while (*i < end && s[*i] >= '0' && s[*i] <= '9') {
+    v = v * 10 + (uint32_t)(s[*i] - '0');
+    if (v >= DESC_SCAN_HARDENED)
+      return false;
+    (*i)++;
+  }
+  if (*i == start)
+    return false;
+  *out = v;
+  return true;
+}
+
+static bool parse_key(const char *s, size_t start, size_t end,
+                      desc_scan_key_t *key) {
+  memset(key, 0, sizeof(*key));
+  key->offset = start;
+  key->len = end - start;
+  key->num_paths = 1;
+
+  size_t i = start;
+  if (i < end && s[i] == '[') {
+    i++;
+    for (int b = 0; b < 4; b++) {
+      if (i + 2 > end)
+        return false;
+      int hi = hex_value(s[i]), lo = hex_value(s[i + 1]);
+      if (hi < 0 || lo < 0)
+        return false;
+      key->fingerprint[b] = (uint8_t)((hi << 4) | lo);
+      i += 2;
+    }
+    key->has_origin = true;
+    key->path_offset = i < end && s[i] == '/' ? i + 1 : i;
+    while (i < end && s[i] == '/') {
+      i++;
+      uint32_t v;
+      if (!parse_index(s, &i, end, &v))
+        return false;
+      if (i < end && is_hardened_marker(s[i])) {
+        v |= DESC_SCAN_HARDENED;
+        i++;
+      }
+      if (key->path_depth < DESC_SCAN_MAX_PATH)
+        key->path[key->path_depth] = v;
+      key->path_depth++;
+    }
+    if (i >= end || s[i] != ']')
+      return false;
+    key->path_len = i - key->path_offset;
+    i++;
+  }
+
+  key->xpub_offset = i;
+  while (i < end && s[i] != '/')
+    i++;
+  key->xpub_len = i - key->xpub_offset;
+  if (key->xpub_len == 0)
+    return false;
+
+  /* Child path: indices, at most one <a;b;...> step, optional final wildcard */
+  bool seen_multi = false;
+  while (i < end) {
+    if (s[i] != '/' || key->wildcard)
+      return false;
+    i++;
+    uint32_t v;
+    if (i < end && s[i] == '*') {
+      i++;
+      key->wildcard = true;
+    } else if (i < end && s[i] == '<') {
+      if (seen_multi)
+        return false;
+      seen_multi = true;
+      i++;
+      uint32_t count = 0;
+      for (;;) {
+        if (!parse_index(s, &i, end, &v))
+          return false;
+        if (i < end && is_hardened_marker(s[i]))
+          i++;
+        count++;
+        if (i < end && s[i] == ';') {
+          i++;
+          continue;
+        }
+        break;
+      }
+      if (i >= end || s[i] != '>' || count < 2)
+        return false;
+      i++;
+      key->num_paths = count;
+      continue;
+    } else if (!parse_index(s, &i, end, &v)) {
+      return false;
+    }
+    if (i < end && is_hardened_marker(s[i]))
+      i++;
+  }
+  return true;
+}
+
+/* ---------- Script structure ---------- */
+
+#define MAX_DEPTH 32
+
+typedef enum {
+  FRAME_OTHER = 0, // Arguments are scripts or opaque values
+  FRAME_KEY,       // pk(KEY), pkh(KEY), tr(KEY,...), ...
+  FRAME_MULTI,     // multi(k,KEY,...) family
+  FRAME_GROUP,     // '{' ... '}' inside tr()
+} frame_kind_t;
+
+typedef struct {
+  uint8_t kind;
+  uint8_t child_closed; // Current argument was a nested function
+  uint16_t arg;         // Argument index
+} frame_t;
+
+static bool name_is(const char *name, size_t len, const char *lit) {
+  return strlen(lit) == len && memcmp(name, lit, len) == 0;
+}
+
+static frame_kind_t classify(const char *name, size_t len, bool *sorted) {
+  /* Miniscript wrappers: "v:pk" -> "pk" */
+  for (size_t i = len; i > 0; i--) {
+    if (name[i - 1] == ':') {
+      name += i;
+      len -= i;
+      break;
+    }
+  }
+  *sorted = false;
+  if (name_is(name, len, "multi") || name_is(name, len, "multi_a"))
+    return FRAME_MULTI;
+  if (name_is(name, len, "sortedmulti") ||
+      name_is(name, len, "sortedmulti_a")) {
+    *sorted = true;
+    return FRAME_MULTI;
+  }
+  if (name_is(name, len, "pk") || name_is(name, len, "pkh") ||
+      name_is(name, len, "wpkh") || name_is(name, len, "combo") ||
+      name_is(name, len, "pk_k") || name_is(name, len, "pk_h") ||
+      name_is(name, len, "tr"))
+    return FRAME_KEY;
+  return FRAME_OTHER;
+}
+
+static bool is_name_char(char ch) {
+  return (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch == '_' ||
+         ch == ':';
+}
+
+static desc_scan_error_t add_key(const char *s, size_t start, size_t end,
+                                 desc_scan_t *out) {
+  if (out->num_keys >= DESC_SCAN_MAX_KEYS)
+    return DESC_SCAN_ERR_TOO_MANY_KEYS;
+  desc_scan_key_t *key = &out->keys[out->num_keys];
+  if (!parse_key(s, start, end, key))
+    return DESC_SCAN_ERR_KEY;
+  if (key->num_paths > out->num_paths)
+    out->num_paths = key->num_paths;
+  out->num_keys++;
+  return DESC_SCAN_OK;
+}
+
+/* Handles a finished leaf argument s[start, end) of the top frame */
+static desc_scan_error_t leaf_arg(const char *s, size_t start, size_t end,
+                                  const frame_t *f, desc_scan_t *out) {
+  switch (f->kind) {
+  case FRAME_KEY:
+    if (f->arg == 0)
+      return add_key(s, start, end, out);
+    return DESC_SCAN_OK;
+  case FRAME_MULTI:
+    if (f->arg == 0) {
+      size_t i = start;
+      uint32_t k;
+      if (!parse_index(s, &i, end, &k) || i != end || k == 0)
+        return DESC_SCAN_ERR_SYNTAX;
+      if (out->threshold == 0)
+        out->threshold = k;
+      return DESC_SCAN_OK;
+    }
+    return add_key(s, start, end, out);
+  default:
+    return DESC_SCAN_OK;
+  }
+}
+
+static void label_append(desc_scan_t *out, const char *name, size_t len) {
+  size_t used = strlen(out->script);
+  size_t room = sizeof(out->script) - 1 - used;
+  size_t need = len + (used ? 1 : 0);
+  if (need > room)
+    return;
+  if (used)
+    out->script[used++] = '(';
+  memcpy(out->script + used, name, len);
+  out->script[used + len] = '\0';
+}
+
+desc_scan_error_t desc_scan(const char *str, size_t len, desc_scan_t *out) {
+  if (!str || !out)
+    return DESC_SCAN_ERR_ARG;
+  memset(out, 0, sizeof(*out));
+
+  frame_t stack[MAX_DEPTH];
+  int depth = 0;
+  size_t tok_start = 0; // Start of the current argument / name
+  bool top_closed = false;
+  bool label_open = true;
+  checksum_state_t cs = {.c = 1};
+  desc_scan_error_t err;
+
+  size_t i = 0;
+  for (; i < len; i++) {
+    char ch = str[i];
+    if (ch == '#')
+      break;
+    unsigned pos = char_pos(ch);
+    if (pos == 0)
+      return DESC_SCAN_ERR_CHAR;
+    checksum_feed(&cs, pos);
+
+    if (top_closed)
+      return DESC_SCAN_ERR_SYNTAX;
+
+    switch (ch) {
+    case '(': {
+      size_t name_len = i - tok_start;
+      if (name_len == 0 || depth == MAX_DEPTH)
+        return DESC_SCAN_ERR_SYNTAX;
+      for (size_t j = tok_start; j < i; j++) {
+        if (!is_name_char(str[j]))
+          return DESC_SCAN_ERR_SYNTAX;
+      }
+      bool sorted;
+      frame_kind_t kind = classify(str + tok_start, name_len, &sorted);
+      if (kind == FRAME_MULTI && out->threshold == 0)
+        out->sorted = sorted;
+      if (label_open)
+        label_append(out, str + tok_start, name_len);
+      stack[depth++] = (frame_t){.kind = kind};
+      tok_start = i + 1;
+      break;
+    }
+    case '{':
+      if (depth == 0 || depth == MAX_DEPTH || i != tok_start)
+        return DESC_SCAN_ERR_SYNTAX;
+      stack[depth++] = (frame_t){.kind = FRAME_GROUP};
+      tok_start = i + 1;
+      break;
+    case ',':
+    case ')':
+    case '}': {
+      label_open = false;
+      if (depth == 0)
+        return DESC_SCAN_ERR_SYNTAX;
+      frame_t *f = &stack[depth - 1];
+      if (ch != ',' && (ch == '}') != (f->kind == FRAME_GROUP))
+        return DESC_SCAN_ERR_SYNTAX;
+      if (f->child_closed) {
+        if (i != tok_start)
+          return DESC_SCAN_ERR_SYNTAX;
+      } else if (i > tok_start) {
+        err = leaf_arg(str, tok_start, i, f, out);
+        if (err != DESC_SCAN_OK)
+          return err;
+      } else if (ch == ',' || f->arg > 0) {
+        return DESC_SCAN_ERR_SYNTAX; // Empty argument
+      }
+      tok_start = i + 1;
+      if (ch == ',') {
+        f->arg++;
+        f->child_closed = 0;
+        break;
+      }
+      depth--;
+      if (depth == 0)
+        top_closed = true;
+      else
+        stack[depth - 1].child_closed = 1;
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  if (!top_closed)
+    return DESC_SCAN_ERR_SYNTAX;
+
+  out->body_len = i;
+  checksum_finish(&cs, out->checksum);
+
+  if (i < len) {
+    if (len - i - 1 != DESC_SCAN_CHECKSUM_LEN ||
+        memcmp(str + i + 1, out->checksum, DESC_SCAN_CHECKSUM_LEN) != 0)
+      return DESC_SCAN_ERR_CHECKSUM;
+    out->has_checksum = true;
+  }
+  return DESC_SCAN_OK;
+}
+
+const char *desc_scan_error_str(desc_scan_error_t err) {
+  switch (err) {
+  case DESC_SCAN_OK:
+    return "OK";
+  case DESC_SCAN_ERR_ARG:
+    return "Invalid argument";
+  case DESC_SCAN_ERR_CHAR:
+    return "Invalid character";
+  case DESC_SCAN_ERR_SYNTAX:
+    return "Syntax error";
+  case DESC_SCAN_ERR_CHECKSUM:
+    return "Checksum mismatch";
+  case DESC_SCAN_ERR_KEY:
+    return "Invalid key expression";
+  case DESC_SCAN_ERR_TOO_MANY_KEYS:
+    return "Too many keys";
+  }
+  return "Unknown error";
+}
@@ -0,0 +1,383 @@
+/*
+ * Descriptor Scan Test Suite
+ * Compile with: make
+ * Run: ./test_descriptor_scan
+ *
+ * The checksum reference is the branchy polymod main/core/wallet.c used
+ * before the table-driven version.
+ */
+
+#include "descriptor_scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+/* ---------- Reference checksum ---------- */
+
+static const char ref_input_charset[] =
+    "0123456789()[],'/*abcdefgh@:$%{}"
+    "IJKLMNOPQRSTUVWXYZ&+-.;<=>?!^_|~"
+    "ijklmnopqrstuvwxyzABCDEFGH`#\"\\ ";
+static const char ref_charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+static uint64_t ref_polymod(uint64_t c, int val) {
+  uint8_t c0 = c >> 35;
+  c = ((c & 0x7ffffffff) << 5) ^ val;
+  if (c0 & 1)
+    c ^= 0xf5dee51989;
+  if (c0 & 2)
+    c ^= 0xa9fdca3312;
+  if (c0 & 4)
+    c ^= 0x1bab10e32d;
+  if (c0 & 8)
+    c ^= 0x3706b1677a;
+  if (c0 & 16)
+    c ^= 0x644d626ffd;
+  return c;
+}
+
+static int ref_checksum(const char *str, size_t len, char out[9]) {
+  uint64_t c = 1;
+  int cls = 0, clscount = 0;
+  for (size_t i = 0; i < len; i++) {
+    const char *p = strchr(ref_input_charset, str[i]);
+    if (!p || str[i] == '\0')
+      return 0;
+    int pos = (int)(p - ref_input_charset);
+    c = ref_polymod(c, pos & 31);
+    cls = cls * 3 + (pos >> 5);
+    if (++clscount == 3) {
+      c = ref_polymod(c, cls);
+      cls = 0;
+      clscount = 0;
+    }
+  }
+  if (clscount > 0)
+    c = ref_polymod(c, cls);
+  for (int i = 0; i < 8; i++)
+    c = ref_polymod(c, 0);
+  c ^= 1;
+  for (int i = 0; i < 8; i++)
+    out[i] = ref_charset[(c >> (5 * (7 - i))) & 31];
+  out[8] = '\0';
+  return 1;
+}
+
+/* ---------- Fixtures ---------- */
+
+#define PKH_XPUB                                                               \
+  "xpub6ERApfZwUNrhLCkDtcHTcxd75RbzS1ed54G1LkBUHQVHQKqhMkhgbmJbZRkrgZw4koxb5"  \
+  "JaHWkY4ALHY2grBGRjaDMzQLcgJvLJuZZvRcEL"
+
+static const char pkh_vector[] =
+    "pkh([d34db33f/44'/0'/0']" PKH_XPUB "/1/*)#ml40v0wf";
+
+/* wsh(sortedmulti(k, ...)) with n keys, fingerprints 00000001.. and
+ * distinct fake xpubs; the scanner does not decode keys. */
+static char *make_sortedmulti(int k, int n, char cksum_out[9]) {
+  size_t cap = 64 + (size_t)n * 160;
+  char *s = malloc(cap);
+  if (!s)
+    return NULL;
+  int off = snprintf(s, cap, "wsh(sortedmulti(%d", k);
+  for (int i = 0; i < n; i++) {
+    off += snprintf(s + off, cap - off,
+                    ",[%08x/48h/0h/%dh/2h]xpub6Fake%02dKeyMaterialAAAAAAAAAAAA"
+                    "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA/"
+                    "<0;1>/*",
+                    i + 1, i, i);
+  }
+  off += snprintf(s + off, cap - off, "))");
+  ref_checksum(s, (size_t)off, cksum_out);
+  snprintf(s + off, cap - off, "#%s", cksum_out);
+  return s;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_checksum_vectors(void) {
+  TEST("BIP-380 checksum vectors");
+
+  static const struct {
+    const char *body;
+    const char *checksum;
+  } vectors[] = {
+      {"raw(deadbeef)", "89f8spxm"},
+      {"pkh([d34db33f/44'/0'/0']" PKH_XPUB "/1/*)", "ml40v0wf"},
+  };
+
+  for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+    char out[9];
+    if (!desc_scan_checksum(vectors[i].body, strlen(vectors[i].body), out) ||
+        strcmp(out, vectors[i].checksum) != 0) {
+      FAIL(vectors[i].body);
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_checksum_matches_reference(void) {
+  TEST("table polymod matches branchy reference");
+
+  /* Pseudo-random strings over the whole input charset, all lengths 0..199 */
+  uint32_t seed = 12345;
+  char buf[200];
+  size_t charset_len = strlen(ref_input_charset);
+  for (size_t len = 0; len < sizeof(buf); len++) {
+    for (int round = 0; round < 20; round++) {
+      for (size_t i = 0; i < len; i++) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = ref_input_charset[(seed >> 16) % charset_len];
+      }
+      char a[9], b[9];
+      if (!desc_scan_checksum(buf, len, a) || !ref_checksum(buf, len, b) ||
+          strcmp(a, b) != 0) {
+        FAIL("checksum differs");
+        return;
+      }
+    }
+  }
+
+  char out[9];
+  if (desc_scan_checksum("pk(\x01)", 5, out) ||
+      desc_scan_checksum("pk(\xc3\xa9)", 6, out)) {
+    FAIL("accepted character outside charset");
+    return;
+  }
+  PASS();
+}
+
+static void test_scan_pkh(void) {
+  TEST("scan single-key descriptor");
+
+  desc_scan_t scan;
+  desc_scan_error_t err = desc_scan(pkh_vector, strlen(pkh_vector), &scan);
+  if (err != DESC_SCAN_OK) {
+    FAIL(desc_scan_error_str(err));
+    return;
+  }
+
+  const desc_scan_key_t *k = &scan.keys[0];
+  static const uint8_t fp[4] = {0xd3, 0x4d, 0xb3, 0x3f};
+  if (!scan.has_checksum || strcmp(scan.checksum, "ml40v0wf") != 0 ||
+      scan.body_len != strlen(pkh_vector) - 9) {
+    FAIL("checksum fields");
+  } else if (strcmp(scan.script, "pkh") != 0 || scan.num_keys != 1 ||
+             scan.threshold != 0 || scan.num_paths != 1) {
+    FAIL("structure fields");
+  } else if (!k->has_origin || memcmp(k->fingerprint, fp, 4) != 0 ||
+             k->path_depth != 3 || k->path[0] != (0x80000000u | 44) ||
+             k->path[1] != 0x80000000u || k->path[2] != 0x80000000u) {
+    FAIL("origin fields");
+  } else if (k->path_len != 9 ||
+             strncmp(pkh_vector + k->path_offset, "44'/0'/0'", 9) != 0) {
+    FAIL("origin path text");
+  } else if (k->xpub_len != strlen(PKH_XPUB) ||
+             strncmp(pkh_vector + k->xpub_offset, PKH_XPUB, k->xpub_len) !=
+                 0 ||
+             !k->wildcard) {
+    FAIL("key fields");
+  } else {
+    PASS();
+  }
+}
+
+static void test_scan_sortedmulti_15(void) {
+  TEST("scan 15-key sortedmulti descriptor");
+
+  char cksum[9];
+  char *desc = make_sortedmulti(11, 15, cksum);
+  desc_scan_t scan;
+  desc_scan_error_t err = desc_scan(desc, strlen(desc), &scan);
+  if (err != DESC_SCAN_OK) {
+    FAIL(desc_scan_error_str(err));
+    free(desc);
+    return;
+  }
+
+  if (strcmp(scan.script, "wsh(sortedmulti") != 0 || !scan.sorted ||
+      scan.threshold != 11 || scan.num_keys != 15 || scan.num_paths != 2 ||
+      strcmp(scan.checksum, cksum) != 0) {
+    FAIL("structure fields");
+    free(desc);
+    return;
+  }
+
+  for (int i = 0; i < 15; i++) {
+    const desc_scan_key_t *k = &scan.keys[i];
+    char path[32], xpub_prefix[16];
+    snprintf(path, sizeof(path), "48h/0h/%dh/2h", i);
+    snprintf(xpub_prefix, sizeof(xpub_prefix), "xpub6Fake%02dKey", i);
+    uint32_t fp = (uint32_t)k->fingerprint[0] << 24 |
+                  (uint32_t)k->fingerprint[1] << 16 |
+                  (uint32_t)k->fingerprint[2] << 8 | k->fingerprint[3];
+    if (fp != (uint32_t)i + 1 || k->path_len != strlen(path) ||
+        strncmp(desc + k->path_offset, path, k->path_len) != 0 ||
+        k->path[2] != (0x80000000u | (uint32_t)i) ||
+        strncmp(desc + k->xpub_offset, xpub_prefix, strlen(xpub_prefix)) !=
+            0 ||
+        desc[k->xpub_offset + k->xpub_len] != '/' || k->num_paths != 2 ||
+        !k->wildcard) {
+      FAIL("key fields");
+      free(desc);
+      return;
+    }
+  }
+
+  /* Without the checksum suffix */
+  desc[scan.body_len] = '\0';
+  if (desc_scan(desc, strlen(desc), &scan) != DESC_SCAN_OK ||
+      scan.has_checksum || strcmp(scan.checksum, cksum) != 0) {
+    FAIL("scan without checksum");
+    free(desc);
+    return;
+  }
+  free(desc);
+  PASS();
+}
+
+static void test_scan_taproot(void) {
+  TEST("scan taproot tree and miniscript wrappers");
+
+  static const char desc[] =
+      "tr([0badf00d/86h/1h/0h]tpubInternal/<0;1>/*,{pk(tpubLeafA/0/*),"
+      "and_v(v:pk([00000002/1h]tpubLeafB/1/*),multi_a(2,tpubC/*,tpubD/*))})";
+  desc_scan_t scan;
+  desc_scan_error_t err = desc_scan(desc, strlen(desc), &scan);
+  if (err != DESC_SCAN_OK) {
+    FAIL(desc_scan_error_str(err));
+    return;
+  }
+  if (strcmp(scan.script, "tr") != 0 || scan.num_keys != 5 ||
+      scan.threshold != 2 || scan.sorted || scan.num_paths != 2 ||
+      scan.has_checksum) {
+    FAIL("structure fields");
+    return;
+  }
+  if (strncmp(desc + scan.keys[2].xpub_offset, "tpubLeafB",
+              scan.keys[2].xpub_len) != 0 ||
+      !scan.keys[2].has_origin || scan.keys[1].has_origin ||
+      strncmp(desc + scan.keys[4].xpub_offset, "tpubD",
+              scan.keys[4].xpub_len) != 0) {
+    FAIL("key order");
+    return;
+  }
+  PASS();
+}
+
+static void test_scan_errors(void) {
+  TEST("scan rejects malformed descriptors");
+
+  static const struct {
+    const char *desc;
+    desc_scan_error_t err;
+  } cases[] = {
+      {"pkh([d34db33f/44'/0'/0']" PKH_XPUB "/1/*)#ml40v0wg",
+       DESC_SCAN_ERR_CHECKSUM},
+      {"pkh([d34db33f/44'/0'/0']" PKH_XPUB "/1/*)#ml40v0w",
+       DESC_SCAN_ERR_CHECKSUM},
+      {"pkh(xpubA", DESC_SCAN_ERR_SYNTAX},
+      {"pkh(xpubA))", DESC_SCAN_ERR_SYNTAX},
+      {"pkh(xpubA)x", DESC_SCAN_ERR_SYNTAX},
+      {"(xpubA)", DESC_SCAN_ERR_SYNTAX},
+      {"wsh(multi(2,,xpubB))", DESC_SCAN_ERR_SYNTAX},
+      {"wsh(multi(x,xpubA,xpubB))", DESC_SCAN_ERR_SYNTAX},
+      {"tr(xpubA,{pk(xpubB),pk(xpubC)))", DESC_SCAN_ERR_SYNTAX},
+      {"pkh([d34db3/0]xpubA)", DESC_SCAN_ERR_KEY},
+      {"pkh([d34db33f/0x]xpubA)", DESC_SCAN_ERR_KEY},
+      {"pkh([d34db33f]xpubA/*/0)", DESC_SCAN_ERR_KEY},
+      {"wpkh(xpubA/<0>/*)", DESC_SCAN_ERR_KEY},
+      {"wpkh(xpubA/<0;1>/<2;3>)", DESC_SCAN_ERR_KEY},
+      {"wpkh(/0/*)", DESC_SCAN_ERR_KEY},
+      {"pkh(xpub\tA)", DESC_SCAN_ERR_CHAR},
+  };
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    desc_scan_t scan;
+    desc_scan_error_t err = desc_scan(cases[i].desc, strlen(cases[i].desc),
+                                      &scan);
+    if (err != cases[i].err) {
+      printf("[%s -> %s] ", cases[i].desc, desc_scan_error_str(err));
+      FAIL("unexpected result");
+      return;
+    }
+  }
+
+  char cksum[9];
+  char *big = make_sortedmulti(1, 21, cksum);
+  desc_scan_t scan;
+  desc_scan_error_t err = desc_scan(big, strlen(big), &scan);
+  free(big);
+  if (err != DESC_SCAN_ERR_TOO_MANY_KEYS) {
+    FAIL("accepted 21 keys");
+    return;
+  }
+  PASS();
+}
+
+static void bench_scan(void) {
+  char cksum[9];
+  char *desc = make_sortedmulti(11, 15, cksum);
+  size_t len = strlen(desc);
+  const int iters = 20000;
+  desc_scan_t scan;
+  char out[9];
+  volatile size_t sink = 0;
+
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++)
+    sink += ref_checksum(desc, len - 9, out);
+  double t1 = now_ms();
+  for (int i = 0; i < iters; i++)
+    sink += desc_scan_checksum(desc, len - 9, out);
+  double t2 = now_ms();
+  for (int i = 0; i < iters; i++)
+    sink += desc_scan(desc, len, &scan);
+  double t3 = now_ms();
+  (void)sink;
+
+  printf("\n15-key sortedmulti (%zu chars), per call:\n", len);
+  printf("  branchy checksum: %.2f us\n", (t1 - t0) * 1000.0 / iters);
+  printf("  table checksum:   %.2f us\n", (t2 - t1) * 1000.0 / iters);
+  printf("  full scan:        %.2f us\n\n", (t3 - t2) * 1000.0 / iters);
+  free(desc);
+}
+
+int main(void) {
+  printf("=== Descriptor Scan Tests ===\n\n");
+
+  test_checksum_vectors();
+  test_checksum_matches_reference();
+  test_scan_pkh();
+  test_scan_sortedmulti_15();
+  test_scan_taproot();
+  test_scan_errors();
+
+  bench_scan();
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+#ifndef DICE_ENTROPY_H
+#define DICE_ENTROPY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Streaming quality estimate for dice-roll entropy
+ *
+ * Updated in O(1) per roll without keeping the rolls: per-face counts, the
+ * last few faces, and the current and longest length of each pattern
+ * detector. A report (O(sides)) gives:
+ *
+ * - Shannon entropy per roll, Miller-Madow corrected and capped at
+ *   log2(sides), and the total it implies for the rolls so far
+ * - min-entropy per roll from the most frequent face
+ * - chi-square against a fair die, flagged past the 0.1% critical value
+ *   once every face is expected at least 5 times
+ * - the longest run of one face, and the longest repeating (period 2-4)
+ *   or straight (+1/-1 modulo sides) sequence
+ *
+ * Run and pattern flags use a length that a fair die would reach with
+ * under 5% probability anywhere in the expected number of rolls, so a
+ * flag raised early does not clear as more rolls come in.
+ *
+ * The state is a plain value: copying it is a snapshot, which is how a
+ * caller supports undo.
+ */
+
+#define DICE_ENTROPY_MAX_SIDES 20
+#define DICE_ENTROPY_MAX_PERIOD 4
+
+typedef struct {
+  uint8_t sides;
+  uint8_t pattern_limit; // Matches that raise a run or pattern flag
+  uint16_t rolls;
+  uint16_t counts[DICE_ENTROPY_MAX_SIDES];
+  uint8_t recent[DICE_ENTROPY_MAX_PERIOD]; // recent[0] is the last face
+  uint16_t match_run[DICE_ENTROPY_MAX_PERIOD]; // Index p-1: face == p back
+  uint16_t match_longest[DICE_ENTROPY_MAX_PERIOD];
+  int8_t step_dir; // Direction of the current straight run, 0 if none
+  uint16_t step_run;
+  uint16_t step_longest;
+} dice_entropy_t;
+
+typedef struct {
+  uint16_t rolls;
+  float shannon_bits;     // Per roll
+  float min_entropy_bits; // Per roll
+  float total_bits;       // rolls * shannon_bits
+  float chi_square;
+  bool chi_square_valid; // Enough rolls for the test to mean anything
+  bool skewed;
+  uint16_t longest_run;     // Same face in a row
+  uint16_t longest_pattern; // Rolls in the longest repeating/straight run
+  bool long_run;
+  bool patterned;
+} dice_entropy_report_t;
+
+/**
+ * @brief Start an estimate
+ *
+ * @param sides 2..DICE_ENTROPY_MAX_SIDES
+ * @param expected_rolls Roll count the pattern flags are calibrated for
+ * @return false on bad arguments
+ */
+bool dice_entropy_init(dice_entropy_t *e, uint8_t sides,
+                       uint16_t expected_rolls);
+
+/**
+ * @brief Add one roll (face 1..sides)
+ * @return false if the face is out of range or the count would overflow
+ */
+bool dice_entropy_add(dice_entropy_t *e, uint8_t face);
+
+void dice_entropy_report(const dice_entropy_t *e,
+                         dice_entropy_report_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DICE_ENTROPY_H
@@ -0,0 +1,138 @@
+/*
+ * Dice Entropy - streaming quality estimate for dice rolls
+ */
+
+#include "dice_entropy.h"
+#include <math.h>
+#include <string.h>
+
+// Chance a fair die raises any run or pattern flag over the expected rolls
+#define PATTERN_FALSE_ALARM 0.05f
+// One detector per period plus straight runs in both directions
+#define PATTERN_DETECTORS (DICE_ENTROPY_MAX_PERIOD + 2)
+// Upper-tail z for the chi-square flag (0.1%)
+#define CHI_SQUARE_Z 3.0902f
+#define CHI_SQUARE_MIN_EXPECTED 5
+
+bool dice_entropy_init(dice_entropy_t *e, uint8_t sides,
+                       uint16_t expected_rolls) {
+  if (!e || sides < 2 || sides > DICE_ENTROPY_MAX_SIDES)
+    return false;
+  memset(e, 0, sizeof(*e));
+  e->sides = sides;
+
+  // Smallest L with detectors * n * sides^-L below the false-alarm rate
+  float n = expected_rolls > 0 ? (float)expected_rolls : 1.0f;
+  float limit =
+      ceilf(logf(PATTERN_DETECTORS * n / PATTERN_FALSE_ALARM) / logf(sides));
+  if (limit < 3.0f)
+    limit = 3.0f;
+  if (limit > 255.0f)
+    limit = 255.0f;
+  e->pattern_limit = (uint8_t)limit;
+  return true;
+}
+
+static uint16_t max_u16(uint16_t a, uint16_t b) { return a > b ? a : b; }
+
+bool dice_entropy_add(dice_entropy_t *e, uint8_t face) {
+  if (!e || face < 1 || face > e->sides || e->rolls == UINT16_MAX)
+    return false;
+  uint8_t f = face - 1;
+
+  // Runs of one face count as period 1; longer periods skip over them so
+  // "1111" is a run, not also a 2-periodic pattern
+  bool repeat = e->rolls >= 1 && e->recent[0] == f;
+  for (int p = 1; p <= DICE_ENTROPY_MAX_PERIOD; p++) {
+    bool match = e->rolls >= (uint16_t)p && e->recent[p - 1] == f &&
+                 (p == 1 || !repeat);
+    e->match_run[p - 1] = match ? e->match_run[p - 1] + 1 : 0;
+    e->match_longest[p - 1] =
+        max_u16(e->match_longest[p - 1], e->match_run[p - 1]);
+  }
+
+  if (e->rolls >= 1) {
+    uint8_t delta = (uint8_t)((f + e->sides - e->recent[0]) % e->sides);
+    int8_t dir = delta == 1 ? 1 : (delta == e->sides - 1 ? -1 : 0);
+    if (dir == 0)
+      e->step_run = 0;
+    else if (dir == e->step_dir)
+      e->step_run++;
+    else
+      e->step_run = 1;
+    e->step_dir = dir;
+    e->step_longest = max_u16(e->step_longest, e->step_run);
+  }
+
+  memmove(&e->recent[1], &e->recent[0], DICE_ENTROPY_MAX_PERIOD - 1);
+  e->recent[0] = f;
+  e->counts[f]++;
+  e->rolls++;
+  return true;
+}
+
+// Wilson-Hilferty approximation of the chi-square upper-tail quantile
+static float chi_square_critical(int df) {
+  float k = 2.0f / (9.0f * (float)df);
+  float c = 1.0f - k + CHI_SQUARE_Z * sqrtf(k);
+  return (float)df * c * c * c;
+}
+
+void dice_entropy_report(const dice_entropy_t *e,
+                         dice_entropy_report_t *out) {
+  if (!out)
+    return;
+  memset(out, 0, sizeof(*out));
+  if (!e || e->rolls == 0)
+    return;
+
+  float n = (float)e->rolls;
+  float expected = n / (float)e->sides;
+  float shannon = 0.0f;
+  float chi = 0.0f;
+  uint16_t max_count = 0;
+  int observed = 0;
+  for (int i = 0; i < e->sides; i++) {
+    uint16_t c = e->counts[i];
+    float d = (float)c - expected;
+    chi += d * d / expected;
+    if (c == 0)
+      continue;
+    observed++;
+    float p = (float)c / n;
+    shannon -= p * log2f(p);
+    max_count = max_u16(max_count, c);
+  }
+
+  // Miller-Madow: the plug-in estimate is biased low on small samples
+  shannon += (float)(observed - 1) / (2.0f * n * logf(2.0f));
+  float ideal = log2f((float)e->sides);
+  if (shannon > ideal)
+    shannon = ideal;
+
+  out->rolls = e->rolls;
+  out->shannon_bits = shannon;
+  out->min_entropy_bits = -log2f((float)max_count / n);
+  out->total_bits = shannon * n;
+  out->chi_square = chi;
+  out->chi_square_valid = expected >= CHI_SQUARE_MIN_EXPECTED;
+  out->skewed =
+      out->chi_square_valid && chi > chi_square_critical(e->sides - 1);
+
+  out->longest_run = e->match_longest[0] + 1;
+  out->long_run = e->match_longest[0] >= e->pattern_limit;
+
+  uint16_t pattern = 0;
+  bool patterned = false;
+  for (int p = 2; p <= DICE_ENTROPY_MAX_PERIOD; p++) {
+    uint16_t m = e->match_longest[p - 1];
+    if (m > 0)
+      pattern = max_u16(pattern, (uint16_t)(m + p));
+    patterned |= m >= e->pattern_limit;
+  }
+  if (e->step_longest > 0)
+    pattern = max_u16(pattern, e->step_longest + 1);
+  patterned |= e->step_longest >= e->pattern_limit;
+  out->longest_pattern = pattern;
+  out->patterned = patterned;
+}
@@ -0,0 +1,275 @@
+/*
+ * Dice Entropy Test Suite
+ * Compile with: make
+ * Run: ./test_dice_entropy
+ *
+ * Feeds fair pseudo-random rolls, loaded dice and the inputs people type
+ * when they don't roll (one face, counting up, alternating) and checks
+ * which flags each one raises.
+ */
+
+#include "dice_entropy.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// xorshift32 so results don't depend on the libc rand()
+static uint32_t rng_state = 1;
+static uint32_t rng(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static uint8_t fair_roll(uint8_t sides) {
+  return (uint8_t)(rng() % sides + 1);
+}
+
+static void feed_string(dice_entropy_t *e, const char *rolls) {
+  for (; *rolls; rolls++)
+    dice_entropy_add(e, (uint8_t)(*rolls - '0'));
+}
+
+static bool any_flag(const dice_entropy_report_t *r) {
+  return r->skewed || r->long_run || r->patterned;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_fair_d6(void) {
+  TEST("fair d6 rolls raise no flags and reach ~2.58 bits/roll");
+  int flagged = 0;
+  float worst_bits = 99.0f;
+  rng_state = 12345;
+  for (int trial = 0; trial < 200; trial++) {
+    dice_entropy_t e;
+    dice_entropy_init(&e, 6, 99);
+    for (int i = 0; i < 99; i++)
+      dice_entropy_add(&e, fair_roll(6));
+    dice_entropy_report_t r;
+    dice_entropy_report(&e, &r);
+    flagged += any_flag(&r);
+    if (r.shannon_bits < worst_bits)
+      worst_bits = r.shannon_bits;
+  }
+  // 5% run/pattern false alarms plus 0.1% chi-square, with margin
+  if (flagged > 20 || worst_bits < 2.4f) {
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%d/200 flagged, worst %.2f bits", flagged,
+             worst_bits);
+    FAIL(msg);
+    return;
+  }
+  PASS();
+}
+
+static void test_one_face(void) {
+  TEST("same face over and over");
+  dice_entropy_t e;
+  dice_entropy_init(&e, 6, 50);
+  feed_string(&e, "11111111111111111111111111111111111111111111111111");
+  dice_entropy_report_t r;
+  dice_entropy_report(&e, &r);
+  if (!r.long_run || r.patterned || r.longest_run != 50 ||
+      r.min_entropy_bits != 0.0f || r.total_bits > 0.01f || !r.skewed) {
+    FAIL("expected a long run, zero entropy and skew");
+    return;
+  }
+  PASS();
+}
+
+static void test_short_run_flags(void) {
+  TEST("six of a kind inside otherwise fair rolls");
+  dice_entropy_t e;
+  dice_entropy_init(&e, 6, 50);
+  feed_string(&e, "3526142536");
+  dice_entropy_report_t r;
+  dice_entropy_report(&e, &r);
+  if (any_flag(&r)) {
+    FAIL("flagged before the run");
+    return;
+  }
+  feed_string(&e, "444444");
+  dice_entropy_report(&e, &r);
+  if (!r.long_run || r.longest_run != 6) {
+    FAIL("run not flagged");
+    return;
+  }
+  PASS();
+}
+
+static void test_patterns(void) {
+  TEST("counting, alternating and period-3 input");
+  static const char *inputs[] = {
+      "123456123456",   // Straight up, wrapping 6 -> 1
+      "654321654",      // Straight down
+      "2525252525",     // Period 2
+      "1461461461461",  // Period 3
+      "135213521352",   // Period 4
+  };
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+    dice_entropy_t e;
+    dice_entropy_init(&e, 6, 50);
+    feed_string(&e, inputs[i]);
+    dice_entropy_report_t r;
+    dice_entropy_report(&e, &r);
+    if (!r.patterned || r.long_run ||
+        r.longest_pattern != (uint16_t)strlen(inputs[i])) {
+      char msg[64];
+      snprintf(msg, sizeof(msg), "missed \"%s\" (pattern %u)", inputs[i],
+               r.longest_pattern);
+      FAIL(msg);
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_loaded_die(void) {
+  TEST("loaded d6 fails chi-square, fair d20 passes");
+  rng_state = 99;
+  dice_entropy_t e;
+  dice_entropy_init(&e, 6, 300);
+  for (int i = 0; i < 300; i++) {
+    // Six comes up 30% of the time instead of 16.7%
+    uint8_t face = (rng() % 10 < 3) ? 6 : fair_roll(5);
+    dice_entropy_add(&e, face);
+  }
+  dice_entropy_report_t r;
+  dice_entropy_report(&e, &r);
+  if (!r.chi_square_valid || !r.skewed) {
+    FAIL("loaded die not flagged");
+    return;
+  }
+  if (r.min_entropy_bits > 1.9f) {
+    FAIL("min-entropy should reflect the heavy face");
+    return;
+  }
+
+  dice_entropy_init(&e, 20, 200);
+  for (int i = 0; i < 200; i++)
+    dice_entropy_add(&e, fair_roll(20));
+  dice_entropy_report(&e, &r);
+  if (!r.chi_square_valid || r.skewed ||
+      fabsf(r.shannon_bits - log2f(20.0f)) > 0.15f) {
+    FAIL("fair d20 misjudged");
+    return;
+  }
+  PASS();
+}
+
+static void test_chi_square_needs_rolls(void) {
+  TEST("chi-square waits for 5 expected per face");
+  dice_entropy_t e;
+  dice_entropy_init(&e, 6, 50);
+  feed_string(&e, "6666666666");
+  dice_entropy_report_t r;
+  dice_entropy_report(&e, &r);
+  if (r.chi_square_valid || r.skewed) {
+    FAIL("chi-square judged 10 rolls");
+    return;
+  }
+  PASS();
+}
+
+static void test_snapshot_undo(void) {
+  TEST("copying the state undoes a roll exactly");
+  dice_entropy_t e, before;
+  dice_entropy_init(&e, 6, 50);
+  feed_string(&e, "41536");
+  before = e;
+  dice_entropy_add(&e, 6);
+  dice_entropy_add(&e, 6);
+  e = before;
+  dice_entropy_t direct;
+  dice_entropy_init(&direct, 6, 50);
+  feed_string(&direct, "41536");
+  if (memcmp(&e, &direct, sizeof(e)) != 0) {
+    FAIL("state differs");
+    return;
+  }
+  PASS();
+}
+
+static void test_rejects(void) {
+  TEST("rejects bad sides and faces");
+  dice_entropy_t e;
+  if (dice_entropy_init(&e, 1, 50) || dice_entropy_init(&e, 21, 50) ||
+      !dice_entropy_init(&e, 6, 0) || dice_entropy_add(&e, 0) ||
+      dice_entropy_add(&e, 7) || e.rolls != 0) {
+    FAIL("accepted bad input");
+    return;
+  }
+  dice_entropy_report_t r;
+  dice_entropy_report(&e, &r);
+  if (r.rolls != 0 || r.total_bits != 0.0f) {
+    FAIL("empty report not zero");
+    return;
+  }
+  PASS();
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench_add(void) {
+  printf("\nPer roll (add + report), d6:\n");
+  const int iters = 1000000;
+  dice_entropy_t e;
+  dice_entropy_report_t r;
+  volatile float sink = 0;
+  rng_state = 7;
+  dice_entropy_init(&e, 6, 99);
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++) {
+    if (e.rolls == 256)
+      dice_entropy_init(&e, 6, 99);
+    dice_entropy_add(&e, fair_roll(6));
+    dice_entropy_report(&e, &r);
+    sink += r.total_bits;
+  }
+  double t1 = now_ms();
+  (void)sink;
+  printf("  %.3f us\n\n", (t1 - t0) * 1000.0 / iters);
+}
+
+int main(void) {
+  printf("=== Dice Entropy Tests ===\n\n");
+
+  test_fair_d6();
+  test_one_face();
+  test_short_run_flags();
+  test_patterns();
+  test_loaded_die();
+  test_chi_square_needs_rolls();
+  test_snapshot_undo();
+  test_rejects();
+
+  bench_add();
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
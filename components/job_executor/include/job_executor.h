@@ -0,0 +1,132 @@
+#ifndef JOB_EXECUTOR_H
+#define JOB_EXECUTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Background job executor
+ *
+ * Fixed pool of worker threads (one per core by default) for long-running
+ * operations such as PBKDF2, seed derivation or descriptor parsing. Jobs run
+ * on a worker; progress and completion callbacks are delivered on the thread
+ * that calls job_executor_dispatch() (the LVGL task on device).
+ *
+ * Each job owns a zero-initialised scratch block which is wiped and freed
+ * after the completion callback returns, so results and copies of secrets
+ * should live there rather than in page-level statics.
+ */
+
+/** Maximum number of jobs queued or running at once */
+#define JOB_MAX_PENDING 16
+
+typedef struct job job_t;
+
+/**
+ * @brief Work function, runs on a worker thread
+ *
+ * Must not touch LVGL. Long loops should poll job_is_cancelled().
+ *
+ * @return Job-defined result code, passed to the done callback
+ */
+typedef int (*job_run_fn)(job_t *job, void *scratch, void *ctx);
+
+/** @brief Completion callback, runs on the dispatch thread */
+typedef void (*job_done_fn)(int result, void *scratch, void *ctx);
+
+/** @brief Progress callback (0-100), runs on the dispatch thread */
+typedef void (*job_progress_fn)(uint8_t percent, void *ctx);
+
+/**
+ * @brief Releases resources referenced from scratch (e.g. heap buffers)
+ *
+ * Called exactly once per submitted job, whether it completed or was
+ * cancelled, just before the scratch block is wiped.
+ */
+typedef void (*job_cleanup_fn)(void *scratch);
+
+typedef struct {
+  job_run_fn run;            // Required
+  job_done_fn done;          // Optional, skipped if the job was cancelled
+  job_progress_fn progress;  // Optional
+  job_cleanup_fn cleanup;    // Optional
+  void *ctx;                 // Passed through to all callbacks
+  const void *scratch_init;  // Optional initial contents of scratch
+  size_t scratch_len;        // Size of the per-job scratch block
+} job_desc_t;
+
+typedef struct {
+  unsigned num_workers;  // 0 = one per core
+  /**
+   * Called from a worker when callbacks are waiting to be dispatched.
+   * Implementations should schedule job_executor_dispatch() on the UI
+   * thread and return false if they could not; the next progress update
+   * or completion then calls it again. Never called with executor locks
+   * held.
+   */
+  bool (*notify)(void);
+} job_executor_config_t;
+
+/**
+ * @brief Start the worker pool
+ *
+ * @param config Pool configuration (NULL for defaults, no notify hook)
+ * @return true on success or if already running
+ */
+bool job_executor_init(const job_executor_config_t *config);
+
+/**
+ * @brief Stop the worker pool
+ *
+ * Cancels queued jobs, waits for running jobs to return and releases all
+ * pending results without invoking their done callbacks.
+ */
+void job_executor_deinit(void);
+
+/**
+ * @brief Queue a job
+ *
+ * The scratch block is allocated and initialised from desc->scratch_init
+ * before this returns, so the caller may wipe its own copy immediately.
+ *
+ * @return Job handle, or NULL if the queue is full or allocation failed.
+ *         The handle becomes invalid once its done callback has returned or
+ *         after job_cancel().
+ */
+job_t *job_submit(const job_desc_t *desc);
+
+/**
+ * @brief Cancel a job from the dispatch thread
+ *
+ * Queued jobs are dropped immediately; running jobs are flagged and their
+ * done callback is suppressed. Cleanup and wiping still happen.
+ */
+void job_cancel(job_t *job);
+
+/**
+ * @brief Deliver pending progress and completion callbacks
+ *
+ * Must be called from a single thread (the UI thread).
+ *
+ * @return Number of events delivered
+ */
+size_t job_executor_dispatch(void);
+
+/* ---------- Worker-side helpers ---------- */
+
+/** @brief True once job_cancel() has been called for this job */
+bool job_is_cancelled(const job_t *job);
+
+/** @brief Publish progress; intermediate values may be coalesced */
+void job_report_progress(job_t *job, uint8_t percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JOB_EXECUTOR_H
@@ -0,0 +1,37 @@
+/*
+ * Job executor threading backend
+ *
+ * Minimal set of primitives the executor needs from the platform. One
+ * implementation per target: FreeRTOS on device, pthreads on host.
+ */
+
+#ifndef JOB_BACKEND_H
+#define JOB_BACKEND_H
+
+#include <stdbool.h>
+
+typedef void (*job_worker_main_fn)(unsigned index);
+
+/* Number of workers used when the caller doesn't specify one */
+unsigned job_backend_default_workers(void);
+
+/* Spawn num_workers threads, each calling worker_main(index). On failure,
+ * workers that did start are still reaped by job_backend_join(). */
+bool job_backend_start(unsigned num_workers, job_worker_main_fn worker_main);
+
+/* Block until every worker started by job_backend_start() has returned */
+void job_backend_join(void);
+
+/* Executor state lock (non-recursive) */
+void job_backend_lock(void);
+void job_backend_unlock(void);
+
+/* Counting wake-up signal: post() increments, wait() blocks until > 0 */
+void job_backend_post_work(void);
+void job_backend_wait_work(void);
+
+/* Bracket a job's run function (e.g. to relax the task watchdog) */
+void job_backend_run_begin(unsigned index);
+void job_backend_run_end(unsigned index);
+
+#endif // JOB_BACKEND_H
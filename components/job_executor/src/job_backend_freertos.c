@@ -0,0 +1,99 @@
+/*
+ * Job executor backend: FreeRTOS
+ *
+ * One task per worker, pinned round-robin across cores. While a job runs,
+ * that core's IDLE task is unsubscribed from the task watchdog so long
+ * PBKDF2/BIP39 loops don't trip it (same approach the KEF pages used).
+ */
+
+#include "job_backend.h"
+
+#include <esp_task_wdt.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/idf_additions.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+/* libwally descriptor parsing needs the same headroom as the LVGL task */
+#define JOB_WORKER_STACK_SIZE 16384
+/* Below the LVGL port task (4) so the UI keeps preempting workers */
+#define JOB_WORKER_PRIORITY 3
+#define JOB_WORK_SEM_MAX 64
+
+typedef struct {
+  unsigned index;
+  job_worker_main_fn worker_main;
+} worker_arg_t;
+
+static SemaphoreHandle_t state_mutex = NULL;
+static SemaphoreHandle_t work_sem = NULL;
+static SemaphoreHandle_t exit_sem = NULL;
+static worker_arg_t worker_args[portNUM_PROCESSORS * 2];
+static unsigned worker_count = 0;
+
+static BaseType_t worker_core(unsigned index) {
+  return (BaseType_t)(index % portNUM_PROCESSORS);
+}
+
+static void worker_task(void *arg) {
+  worker_arg_t *worker = (worker_arg_t *)arg;
+  worker->worker_main(worker->index);
+  xSemaphoreGive(exit_sem);
+  vTaskDelete(NULL);
+}
+
+unsigned job_backend_default_workers(void) { return portNUM_PROCESSORS; }
+
+bool job_backend_start(unsigned num_workers, job_worker_main_fn worker_main) {
+  if (num_workers > sizeof(worker_args) / sizeof(worker_args[0]))
+    num_workers = sizeof(worker_args) / sizeof(worker_args[0]);
+
+  if (!state_mutex)
+    state_mutex = xSemaphoreCreateMutex();
+  if (!work_sem)
+    work_sem = xSemaphoreCreateCounting(JOB_WORK_SEM_MAX, 0);
+  if (!exit_sem)
+    exit_sem = xSemaphoreCreateCounting(sizeof(worker_args) /
+                                            sizeof(worker_args[0]),
+                                        0);
+  if (!state_mutex || !work_sem || !exit_sem)
+    return false;
+
+  worker_count = 0;
+  for (unsigned i = 0; i < num_workers; i++) {
+    worker_args[i].index = i;
+    worker_args[i].worker_main = worker_main;
+    if (xTaskCreatePinnedToCore(worker_task, "job_worker",
+                                JOB_WORKER_STACK_SIZE, &worker_args[i],
+                                JOB_WORKER_PRIORITY, NULL,
+                                worker_core(i)) != pdPASS)
+      return false;
+    worker_count++;
+  }
+  return true;
+}
+
+void job_backend_join(void) {
+  for (unsigned i = 0; i < worker_count; i++)
+    xSemaphoreTake(exit_sem, portMAX_DELAY);
+  worker_count = 0;
+  /* Drop surplus wake-ups so the next start begins from zero */
+  while (xSemaphoreTake(work_sem, 0) == pdTRUE) {
+  }
+}
+
+void job_backend_lock(void) { xSemaphoreTake(state_mutex, portMAX_DELAY); }
+
+void job_backend_unlock(void) { xSemaphoreGive(state_mutex); }
+
+void job_backend_post_work(void) { xSemaphoreGive(work_sem); }
+
+void job_backend_wait_work(void) { xSemaphoreTake(work_sem, portMAX_DELAY); }
+
+void job_backend_run_begin(unsigned index) {
+  esp_task_wdt_delete(xTaskGetIdleTaskHandleForCore(worker_core(index)));
+}
+
+void job_backend_run_end(unsigned index) {
+  esp_task_wdt_add(xTaskGetIdleTaskHandleForCore(worker_core(index)));
+}
@@ -0,0 +1,87 @@
+/*
+ * Job executor backend: POSIX threads
+ * Used for host builds and tests.
+ */
+
+#include "job_backend.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+  unsigned index;
+  job_worker_main_fn worker_main;
+} worker_arg_t;
+
+static pthread_mutex_t state_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t work_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static unsigned work_count = 0;
+
+static pthread_t *threads = NULL;
+static worker_arg_t *thread_args = NULL;
+static unsigned thread_count = 0;
+
+static void *thread_entry(void *arg) {
+  worker_arg_t *worker = (worker_arg_t *)arg;
+  worker->worker_main(worker->index);
+  return NULL;
+}
+
+unsigned job_backend_default_workers(void) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return (cores > 0) ? (unsigned)cores : 1;
+}
+
+bool job_backend_start(unsigned num_workers, job_worker_main_fn worker_main) {
+  threads = calloc(num_workers, sizeof(pthread_t));
+  thread_args = calloc(num_workers, sizeof(worker_arg_t));
+  if (!threads || !thread_args)
+    return false;
+
+  work_count = 0;
+  thread_count = 0;
+  for (unsigned i = 0; i < num_workers; i++) {
+    thread_args[i].index = i;
+    thread_args[i].worker_main = worker_main;
+    if (pthread_create(&threads[i], NULL, thread_entry, &thread_args[i]) != 0)
+      return false;
+    thread_count++;
+  }
+  return true;
+}
+
+void job_backend_join(void) {
+  for (unsigned i = 0; i < thread_count; i++)
+    pthread_join(threads[i], NULL);
+  free(threads);
+  free(thread_args);
+  threads = NULL;
+  thread_args = NULL;
+  thread_count = 0;
+  work_count = 0;
+}
+
+void job_backend_lock(void) { pthread_mutex_lock(&state_lock); }
+
+void job_backend_unlock(void) { pthread_mutex_unlock(&state_lock); }
+
+void job_backend_post_work(void) {
+  pthread_mutex_lock(&work_lock);
+  work_count++;
+  pthread_cond_signal(&work_cond);
+  pthread_mutex_unlock(&work_lock);
+}
+
+void job_backend_wait_work(void) {
+  pthread_mutex_lock(&work_lock);
+  while (work_count == 0)
+    pthread_cond_wait(&work_cond, &work_lock);
+  work_count--;
+  pthread_mutex_unlock(&work_lock);
+}
+
+void job_backend_run_begin(unsigned index) { (void)index; }
+
+void job_backend_run_end(unsigned index) { (void)index; }
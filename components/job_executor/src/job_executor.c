@@ -0,0 +1,317 @@
+#include "job_executor.h"
+#include "job_backend.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+  JOB_STATE_QUEUED,
+  JOB_STATE_RUNNING,
+  JOB_STATE_FINISHED,
+} job_state_t;
+
+struct job {
+  job_desc_t desc;
+  void *scratch;
+  job_state_t state;
+  bool cancelled; // Read by the worker without the lock; use atomics
+  int result;
+
+  uint8_t progress;
+  bool progress_pending;
+
+  bool in_events;
+  struct job *queue_next;
+  struct job *event_next;
+};
+
+static struct {
+  bool running;
+  bool stopping;
+  unsigned num_workers;
+  bool (*notify)(void);
+
+  /* Submitted, not yet picked up by a worker (FIFO) */
+  job_t *queue_head;
+  job_t *queue_tail;
+  /* Jobs with a progress update or result waiting for dispatch (FIFO) */
+  job_t *events_head;
+  job_t *events_tail;
+  /* Queued + running + awaiting dispatch */
+  unsigned pending;
+  /* Set when notify() has been called and dispatch hasn't drained yet */
+  bool notified;
+} exec;
+
+/* Volatile function pointer so the final wipe can't be elided */
+static void *(*const volatile wipe_memset)(void *, int, size_t) = memset;
+
+static void job_release(job_t *job) {
+  if (job->desc.cleanup)
+    job->desc.cleanup(job->scratch);
+  if (job->scratch) {
+    wipe_memset(job->scratch, 0, job->desc.scratch_len);
+    free(job->scratch);
+  }
+  wipe_memset(job, 0, sizeof(*job));
+  free(job);
+}
+
+/* Caller holds the lock. Returns true if the notify hook should fire. */
+static bool push_event_locked(job_t *job) {
+  if (!job->in_events) {
+    job->in_events = true;
+    job->event_next = NULL;
+    if (exec.events_tail)
+      exec.events_tail->event_next = job;
+    else
+      exec.events_head = job;
+    exec.events_tail = job;
+  }
+  if (exec.notified)
+    return false;
+  exec.notified = true;
+  return true;
+}
+
+/* Caller does not hold the lock. A hook that couldn't schedule a dispatch
+ * leaves the events queued; clearing notified lets the next event call it
+ * again instead of waiting on a dispatch that will never run. */
+static void call_notify(bool (*notify)(void)) {
+  if (notify && !notify()) {
+    job_backend_lock();
+    exec.notified = false;
+    job_backend_unlock();
+  }
+}
+
+static job_t *pop_queue_locked(void) {
+  job_t *job = exec.queue_head;
+  if (job) {
+    exec.queue_head = job->queue_next;
+    if (!exec.queue_head)
+      exec.queue_tail = NULL;
+    job->queue_next = NULL;
+  }
+  return job;
+}
+
+static void worker_main(unsigned index) {
+  for (;;) {
+    job_backend_wait_work();
+
+    job_backend_lock();
+    if (exec.stopping) {
+      job_backend_unlock();
+      return;
+    }
+    job_t *job = pop_queue_locked();
+    if (job)
+      job->state = JOB_STATE_RUNNING;
+    job_backend_unlock();
+
+    /* A wake-up may belong to a job that was cancelled while queued */
+    if (!job)
+      continue;
+
+    int result = -1;
+    if (!__atomic_load_n(&job->cancelled, __ATOMIC_ACQUIRE)) {
+      job_backend_run_begin(index);
+      result = job->desc.run(job, job->scratch, job->desc.ctx);
+      job_backend_run_end(index);
+    }
+
+    job_backend_lock();
+    job->result = result;
+    job->state = JOB_STATE_FINISHED;
+    bool fire = push_event_locked(job);
+    bool (*notify)(void) = exec.notify;
+    job_backend_unlock();
+
+    if (fire)
+      call_notify(notify);
+  }
+}
+
+bool job_executor_init(const job_executor_config_t *config) {
+  if (exec.running)
+    return true;
+
+  memset(&exec, 0, sizeof(exec));
+  exec.num_workers = (config && config->num_workers)
+                         ? config->num_workers
+                         : job_backend_default_workers();
+  exec.notify = config ? config->notify : NULL;
+
+  if (!job_backend_start(exec.num_workers, worker_main)) {
+    exec.stopping = true;
+    for (unsigned i = 0; i < exec.num_workers; i++)
+      job_backend_post_work();
+    job_backend_join();
+    memset(&exec, 0, sizeof(exec));
+    return false;
+  }
+
+  exec.running = true;
+  return true;
+}
+
+void job_executor_deinit(void) {
+  if (!exec.running)
+    return;
+
+  job_backend_lock();
+  exec.stopping = true;
+  job_t *job;
+  while ((job = pop_queue_locked()) != NULL) {
+    job->cancelled = true;
+    exec.pending--;
+    job_release(job);
+  }
+  job_backend_unlock();
+
+  for (unsigned i = 0; i < exec.num_workers; i++)
+    job_backend_post_work();
+  job_backend_join();
+
+  /* Workers are gone; drop undelivered results without callbacks */
+  while ((job = exec.events_head) != NULL) {
+    exec.events_head = job->event_next;
+    if (job->state == JOB_STATE_FINISHED)
+      job_release(job);
+  }
+
+  memset(&exec, 0, sizeof(exec));
+}
+
+job_t *job_submit(const job_desc_t *desc) {
+  if (!exec.running || !desc || !desc->run)
+    return NULL;
+
+  job_t *job = calloc(1, sizeof(job_t));
+  if (!job)
+    return NULL;
+  job->desc = *desc;
+  job->desc.scratch_init = NULL;
+  job->state = JOB_STATE_QUEUED;
+
+  if (desc->scratch_len > 0) {
+    job->scratch = calloc(1, desc->scratch_len);
+    if (!job->scratch) {
+      free(job);
+      return NULL;
+    }
+    if (desc->scratch_init)
+      memcpy(job->scratch, desc->scratch_init, desc->scratch_len);
+  }
+
+  job_backend_lock();
+  if (exec.stopping || exec.pending >= JOB_MAX_PENDING) {
+    job_backend_unlock();
+    /* Scratch was initialised by the caller; don't run their cleanup */
+    job->desc.cleanup = NULL;
+    job_release(job);
+    return NULL;
+  }
+  exec.pending++;
+  if (exec.queue_tail)
+    exec.queue_tail->queue_next = job;
+  else
+    exec.queue_head = job;
+  exec.queue_tail = job;
+  job_backend_unlock();
+
+  job_backend_post_work();
+  return job;
+}
+
+void job_cancel(job_t *job) {
+  if (!job)
+    return;
+
+  job_backend_lock();
+  __atomic_store_n(&job->cancelled, true, __ATOMIC_RELEASE);
+  if (job->state != JOB_STATE_QUEUED) {
+    /* Released by dispatch once the worker hands it back */
+    job_backend_unlock();
+    return;
+  }
+
+  /* Still queued: unlink and release now */
+  job_t **link = &exec.queue_head;
+  job_t *prev = NULL;
+  while (*link && *link != job) {
+    prev = *link;
+    link = &(*link)->queue_next;
+  }
+  if (*link) {
+    *link = job->queue_next;
+    if (exec.queue_tail == job)
+      exec.queue_tail = prev;
+  }
+  exec.pending--;
+  job_backend_unlock();
+
+  job_release(job);
+}
+
+size_t job_executor_dispatch(void) {
+  size_t delivered = 0;
+
+  for (;;) {
+    job_backend_lock();
+    job_t *job = exec.events_head;
+    if (!job) {
+      exec.notified = false;
+      job_backend_unlock();
+      break;
+    }
+    exec.events_head = job->event_next;
+    if (!exec.events_head)
+      exec.events_tail = NULL;
+    job->in_events = false;
+    job->event_next = NULL;
+
+    bool finished = (job->state == JOB_STATE_FINISHED);
+    bool cancelled = job->cancelled;
+    bool progress = job->progress_pending;
+    uint8_t percent = job->progress;
+    job->progress_pending = false;
+    if (finished)
+      exec.pending--;
+    job_backend_unlock();
+
+    if (progress && !cancelled && job->desc.progress)
+      job->desc.progress(percent, job->desc.ctx);
+
+    if (finished) {
+      if (!cancelled && job->desc.done)
+        job->desc.done(job->result, job->scratch, job->desc.ctx);
+      job_release(job);
+    }
+    delivered++;
+  }
+
+  return delivered;
+}
+
+bool job_is_cancelled(const job_t *job) {
+  return !job || __atomic_load_n(&job->cancelled, __ATOMIC_ACQUIRE);
+}
+
+void job_report_progress(job_t *job, uint8_t percent) {
+  if (!job || !job->desc.progress)
+    return;
+  if (percent > 100)
+    percent = 100;
+
+  job_backend_lock();
+  job->progress = percent;
+  job->progress_pending = true;
+  bool fire = push_event_locked(job);
+  bool (*notify)(void) = exec.notify;
+  job_backend_unlock();
+
+  if (fire)
+    call_notify(notify);
+}
@@ -0,0 +1,475 @@
+/*
+ * Job Executor Test Suite (pthread backend)
+ * Compile with: make
+ * Run: ./test_job_executor
+ */
+
+#include "job_executor.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+/* ---------- Helpers ---------- */
+
+static volatile int notify_count = 0;
+static volatile int notify_failures = 0; // Next calls to report failure
+
+static bool test_notify(void) {
+  __atomic_add_fetch(&notify_count, 1, __ATOMIC_SEQ_CST);
+  if (notify_failures > 0) {
+    __atomic_sub_fetch(&notify_failures, 1, __ATOMIC_SEQ_CST);
+    return false;
+  }
+  return true;
+}
+
+static void sleep_ms(int ms) {
+  struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+/* Dispatch until *flag is set or timeout; returns false on timeout */
+static bool dispatch_until(volatile int *flag, int timeout_ms) {
+  for (int waited = 0; waited < timeout_ms; waited++) {
+    job_executor_dispatch();
+    if (*flag)
+      return true;
+    sleep_ms(1);
+  }
+  job_executor_dispatch();
+  return *flag != 0;
+}
+
+typedef struct {
+  int a;
+  int b;
+  int sum;
+  uint8_t secret[32];
+} add_scratch_t;
+
+static int add_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)ctx;
+  add_scratch_t *s = scratch;
+  s->sum = s->a + s->b;
+  return 0;
+}
+
+static volatile int add_done_flag = 0;
+static int add_done_sum = 0;
+static pthread_t add_done_thread;
+
+static void add_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  add_scratch_t *s = scratch;
+  add_done_sum = (result == 0) ? s->sum : -1;
+  add_done_thread = pthread_self();
+  add_done_flag = 1;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_basic_completion(void) {
+  TEST("job completes and done runs on dispatch thread");
+
+  add_scratch_t init = {.a = 40, .b = 2};
+  job_desc_t desc = {.run = add_run,
+                     .done = add_done,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  add_done_flag = 0;
+  if (!job_submit(&desc)) {
+    FAIL("submit failed");
+    return;
+  }
+  if (!dispatch_until(&add_done_flag, 2000)) {
+    FAIL("timeout");
+    return;
+  }
+  if (add_done_sum != 42 || !pthread_equal(add_done_thread, pthread_self())) {
+    FAIL("wrong result or thread");
+    return;
+  }
+  PASS();
+}
+
+static void test_notify_hook(void) {
+  TEST("notify hook fires once per drain");
+
+  add_scratch_t init = {.a = 1, .b = 1};
+  job_desc_t desc = {.run = add_run,
+                     .done = add_done,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  notify_count = 0;
+  add_done_flag = 0;
+  job_submit(&desc);
+  for (int i = 0; i < 2000 && notify_count == 0; i++)
+    sleep_ms(1);
+  job_executor_dispatch();
+  if (notify_count != 1 || !add_done_flag) {
+    FAIL("notify not delivered");
+    return;
+  }
+  PASS();
+}
+
+static volatile int count_done_calls = 0;
+
+static void count_done(int result, void *scratch, void *ctx) {
+  (void)result;
+  (void)scratch;
+  (void)ctx;
+  count_done_calls++;
+}
+
+static void test_notify_failure(void) {
+  TEST("failed notify is retried by the next event");
+
+  job_desc_t desc = {.run = add_run,
+                     .done = count_done,
+                     .scratch_len = sizeof(add_scratch_t)};
+  notify_count = 0;
+  notify_failures = 1;
+  count_done_calls = 0;
+  job_submit(&desc);
+  for (int i = 0; i < 2000 && notify_count == 0; i++)
+    sleep_ms(1);
+  sleep_ms(20); // Let the worker return from the hook and clear the flag
+
+  // Nothing was scheduled, so only a second notify can get the first
+  // result delivered
+  job_submit(&desc);
+  for (int i = 0; i < 2000 && notify_count < 2; i++)
+    sleep_ms(1);
+  job_executor_dispatch();
+  if (notify_count != 2 || count_done_calls != 2) {
+    FAIL("results stranded after a failed notify");
+    return;
+  }
+  PASS();
+}
+
+/* Wipe check: cleanup sees the scratch, and the pointer it saw is gone */
+static uint8_t *wiped_scratch_copy = NULL;
+
+static void secret_cleanup(void *scratch) {
+  add_scratch_t *s = scratch;
+  wiped_scratch_copy = malloc(sizeof(s->secret));
+  memcpy(wiped_scratch_copy, s->secret, sizeof(s->secret));
+}
+
+static void test_scratch_copied_and_cleaned(void) {
+  TEST("scratch is copied on submit and cleanup runs");
+
+  add_scratch_t init = {.a = 3, .b = 4};
+  memset(init.secret, 0xA5, sizeof(init.secret));
+  job_desc_t desc = {.run = add_run,
+                     .done = add_done,
+                     .cleanup = secret_cleanup,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  add_done_flag = 0;
+  job_submit(&desc);
+  /* Caller may wipe its copy right away */
+  memset(&init, 0, sizeof(init));
+
+  if (!dispatch_until(&add_done_flag, 2000) || add_done_sum != 7) {
+    FAIL("job did not see submitted scratch");
+    return;
+  }
+  if (!wiped_scratch_copy || wiped_scratch_copy[0] != 0xA5) {
+    FAIL("cleanup not called with scratch");
+    free(wiped_scratch_copy);
+    wiped_scratch_copy = NULL;
+    return;
+  }
+  free(wiped_scratch_copy);
+  wiped_scratch_copy = NULL;
+  PASS();
+}
+
+/* Cooperative cancellation */
+static volatile int spin_started = 0;
+static volatile int spin_exited = 0;
+static volatile int cancel_done_called = 0;
+static volatile int cancel_cleanup_called = 0;
+
+static int spin_run(job_t *job, void *scratch, void *ctx) {
+  (void)scratch;
+  (void)ctx;
+  spin_started = 1;
+  while (!job_is_cancelled(job))
+    sleep_ms(1);
+  spin_exited = 1;
+  return 1;
+}
+
+static void spin_done(int result, void *scratch, void *ctx) {
+  (void)result;
+  (void)scratch;
+  (void)ctx;
+  cancel_done_called = 1;
+}
+
+static void spin_cleanup(void *scratch) {
+  (void)scratch;
+  cancel_cleanup_called = 1;
+}
+
+static void test_cancel_running(void) {
+  TEST("cancel running job suppresses done, runs cleanup");
+
+  job_desc_t desc = {.run = spin_run,
+                     .done = spin_done,
+                     .cleanup = spin_cleanup,
+                     .scratch_len = 16};
+  spin_started = spin_exited = 0;
+  cancel_done_called = cancel_cleanup_called = 0;
+  job_t *job = job_submit(&desc);
+  for (int i = 0; i < 2000 && !spin_started; i++)
+    sleep_ms(1);
+  if (!spin_started) {
+    FAIL("job never started");
+    return;
+  }
+  job_cancel(job);
+  dispatch_until(&cancel_cleanup_called, 2000);
+  if (!spin_exited || cancel_done_called || !cancel_cleanup_called) {
+    FAIL("cancellation not honoured");
+    return;
+  }
+  PASS();
+}
+
+/* Blocks a worker until released, to keep later jobs queued */
+static volatile int gate_open = 0;
+static volatile int gate_entered = 0;
+
+static int gate_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)scratch;
+  (void)ctx;
+  __atomic_add_fetch(&gate_entered, 1, __ATOMIC_SEQ_CST);
+  while (!gate_open)
+    sleep_ms(1);
+  return 0;
+}
+
+static volatile int gate_done_count = 0;
+
+static void gate_done(int result, void *scratch, void *ctx) {
+  (void)result;
+  (void)scratch;
+  (void)ctx;
+  gate_done_count++;
+}
+
+static void test_cancel_queued(void) {
+  TEST("cancel queued job releases it without running");
+
+  /* Occupy both workers */
+  job_desc_t gate = {.run = gate_run, .done = gate_done};
+  gate_open = 0;
+  gate_entered = 0;
+  gate_done_count = 0;
+  job_submit(&gate);
+  job_submit(&gate);
+  for (int i = 0; i < 2000 && gate_entered < 2; i++)
+    sleep_ms(1);
+
+  job_desc_t desc = {.run = spin_run,
+                     .done = spin_done,
+                     .cleanup = spin_cleanup,
+                     .scratch_len = 16};
+  spin_started = 0;
+  cancel_done_called = cancel_cleanup_called = 0;
+  job_t *job = job_submit(&desc);
+  job_cancel(job);
+  bool cleaned_immediately = cancel_cleanup_called;
+
+  gate_open = 1;
+  for (int i = 0; i < 2000 && gate_done_count < 2; i++) {
+    job_executor_dispatch();
+    sleep_ms(1);
+  }
+  if (!cleaned_immediately || spin_started || cancel_done_called ||
+      gate_done_count != 2) {
+    FAIL("queued job ran or leaked");
+    return;
+  }
+  PASS();
+}
+
+/* Progress channel */
+static volatile int progress_max = -1;
+static volatile int progress_calls = 0;
+static volatile int progress_done = 0;
+
+static int progress_run(job_t *job, void *scratch, void *ctx) {
+  (void)scratch;
+  (void)ctx;
+  for (int p = 0; p <= 100; p += 10) {
+    job_report_progress(job, (uint8_t)p);
+    sleep_ms(1);
+  }
+  return 0;
+}
+
+static void progress_cb(uint8_t percent, void *ctx) {
+  (void)ctx;
+  progress_calls++;
+  if ((int)percent > progress_max)
+    progress_max = percent;
+}
+
+static void progress_done_cb(int result, void *scratch, void *ctx) {
+  (void)result;
+  (void)scratch;
+  (void)ctx;
+  progress_done = 1;
+}
+
+static void test_progress(void) {
+  TEST("progress is delivered and coalesced");
+
+  job_desc_t desc = {
+      .run = progress_run, .done = progress_done_cb, .progress = progress_cb};
+  progress_max = -1;
+  progress_calls = 0;
+  progress_done = 0;
+  job_submit(&desc);
+  if (!dispatch_until(&progress_done, 2000)) {
+    FAIL("timeout");
+    return;
+  }
+  if (progress_max != 100 || progress_calls < 1 || progress_calls > 11) {
+    FAIL("unexpected progress events");
+    return;
+  }
+  PASS();
+}
+
+static void test_queue_limit(void) {
+  TEST("submit fails when queue is full");
+
+  job_desc_t gate = {.run = gate_run, .done = gate_done};
+  gate_open = 0;
+  gate_done_count = 0;
+  int accepted = 0;
+  for (int i = 0; i < JOB_MAX_PENDING + 4; i++) {
+    if (job_submit(&gate))
+      accepted++;
+  }
+  gate_open = 1;
+  for (int i = 0; i < 4000 && gate_done_count < accepted; i++) {
+    job_executor_dispatch();
+    sleep_ms(1);
+  }
+  if (accepted != JOB_MAX_PENDING || gate_done_count != accepted) {
+    FAIL("queue bound not enforced");
+    return;
+  }
+  PASS();
+}
+
+static void test_parallel_workers(void) {
+  TEST("jobs run concurrently on the pool");
+
+  job_desc_t gate = {.run = gate_run, .done = gate_done};
+  gate_open = 0;
+  gate_entered = 0;
+  gate_done_count = 0;
+  job_submit(&gate);
+  job_submit(&gate);
+  for (int i = 0; i < 2000 && gate_entered < 2; i++)
+    sleep_ms(1);
+  bool both = (gate_entered == 2);
+  gate_open = 1;
+  for (int i = 0; i < 2000 && gate_done_count < 2; i++) {
+    job_executor_dispatch();
+    sleep_ms(1);
+  }
+  if (!both) {
+    FAIL("workers did not overlap");
+    return;
+  }
+  PASS();
+}
+
+static void test_deinit_drops_pending(void) {
+  TEST("deinit cancels queued jobs and reinit works");
+
+  job_desc_t gate = {.run = gate_run, .done = gate_done};
+  gate_open = 0;
+  gate_entered = 0;
+  gate_done_count = 0;
+  job_submit(&gate);
+  job_submit(&gate);
+  for (int i = 0; i < 2000 && gate_entered < 2; i++)
+    sleep_ms(1);
+
+  job_desc_t desc = {.run = spin_run, .cleanup = spin_cleanup};
+  cancel_cleanup_called = 0;
+  job_submit(&desc);
+
+  gate_open = 1;
+  job_executor_deinit();
+  if (!cancel_cleanup_called || gate_done_count != 0) {
+    FAIL("pending work not released");
+    return;
+  }
+
+  job_executor_config_t cfg = {.num_workers = 2, .notify = test_notify};
+  if (!job_executor_init(&cfg)) {
+    FAIL("reinit failed");
+    return;
+  }
+  PASS();
+}
+
+int main(void) {
+  printf("Job Executor Test Suite\n");
+  printf("=======================\n\n");
+
+  job_executor_config_t cfg = {.num_workers = 2, .notify = test_notify};
+  if (!job_executor_init(&cfg)) {
+    printf("init failed\n");
+    return 1;
+  }
+
+  test_basic_completion();
+  test_notify_hook();
+  test_notify_failure();
+  test_scratch_copied_and_cleaned();
+  test_cancel_running();
+  test_cancel_queued();
+  test_progress();
+  test_queue_limit();
+  test_parallel_workers();
+  test_deinit_drops_pending();
+
+  job_executor_deinit();
+
+  printf("\n=======================\n");
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -18,9 +18,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
-/* Limits on the maximum size of QR-codes and their content (Max Version 24). */
-#define K_QUIRC_MAX_BITMAP 1597  /* ceil(113*113/8) for version 24 */
-#define K_QUIRC_MAX_PAYLOAD 2048 /* v24 ECC-L numeric max: 1852 chars */
+/* Limits on the image and QR-code size. Decode buffers are sized for the
+ * largest version actually seen, not for these maximums. */
+#define K_QUIRC_MAX_IMAGE_SIZE 2048
+#define K_QUIRC_MAX_VERSION 40
 
 /* QR-code ECC types. */
 #define K_QUIRC_ECC_LEVEL_M 0
@@ -59,8 +60,9 @@ typedef struct {
   int ecc_level;
   int mask;
   int data_type;
-  uint8_t payload[K_QUIRC_MAX_PAYLOAD];
+  uint8_t *payload; /* NUL-terminated, owned by the result */
   int payload_len;
+  size_t payload_cap;
   uint32_t eci;
 } k_quirc_data_t;
 
@@ -109,8 +111,8 @@ uint8_t *k_quirc_begin(k_quirc_t *q, int *w, int *h);
 /**
  * End decoding - process the image and detect QR codes.
  * @param q Decoder instance
- * @param find_inverted If true, also try to find inverted (white on black) QR
- * codes
+ * @param find_inverted If true, also find inverted (white on black) QR codes.
+ * Both polarities are detected in the same row scan, so this is cheap.
  */
 void k_quirc_end(k_quirc_t *q, bool find_inverted);
 
@@ -123,6 +125,9 @@ int k_quirc_count(const k_quirc_t *q);
 
 /**
  * Decode a specific QR code and get its data.
+ * The result must be zero-initialised before its first use. Its payload
+ * buffer is grown as needed and reused by later calls; release it with
+ * k_quirc_result_free().
  * @param q Decoder instance
  * @param index QR code index (0 to k_quirc_count()-1)
  * @param result Pointer to result structure to fill
@@ -131,6 +136,12 @@ int k_quirc_count(const k_quirc_t *q);
 k_quirc_error_t k_quirc_decode(k_quirc_t *q, int index,
                                k_quirc_result_t *result);
 
+/**
+ * Free the payload buffer of a result and zero it for reuse.
+ * @param result Result (can be NULL)
+ */
+void k_quirc_result_free(k_quirc_result_t *result);
+
 /**
  * Get a human-readable error message.
  * @param err Error code
@@ -145,7 +156,8 @@ const char *k_quirc_strerror(k_quirc_error_t err);
  * @param grayscale_data Grayscale image data (8-bit per pixel)
  * @param width Image width
  * @param height Image height
- * @param results Array to store results (caller allocated)
+ * @param results Array to store results (caller allocated, zero-initialised,
+ * each freed with k_quirc_result_free())
  * @param max_results Maximum number of results to return
  * @param find_inverted If true, also try inverted QR codes
  * @return Number of QR codes successfully decoded
@@ -0,0 +1,58 @@
+/*
+ * K-Quirc Reed-Solomon
+ * Codes over GF(256) with the QR field polynomial x^8+x^4+x^3+x^2+1 and
+ * generator roots alpha^0 .. alpha^(ecc_len-1), as used by QR data blocks.
+ *
+ * Blocks are laid out as in the symbol: data codewords first, then ECC,
+ * with block[0] the highest-degree coefficient.
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for
+ * details.
+ */
+
+#ifndef K_QUIRC_RS_H
+#define K_QUIRC_RS_H
+
+#include "k_quirc.h"
+#include <stdint.h>
+
+/* Largest ECC codeword count of any QR block (versions 1-40, all levels) */
+#define K_QUIRC_RS_MAX_ECC 30
+
+/* Longest QR block: data plus ECC codewords */
+#define K_QUIRC_RS_MAX_BLOCK 153
+
+/**
+ * Compute ECC codewords for a block.
+ * @param data Data codewords
+ * @param data_len Number of data codewords
+ * @param ecc_len Number of ECC codewords (1 to K_QUIRC_RS_MAX_ECC)
+ * @param ecc Output, ecc_len bytes
+ */
+void k_quirc_rs_encode(const uint8_t *data, int data_len, int ecc_len,
+                       uint8_t *ecc);
+
+/**
+ * Evaluate the block at each generator root in one pass over the block.
+ * @param block Data followed by ECC codewords
+ * @param len Block length
+ * @param ecc_len Number of ECC codewords (1 to K_QUIRC_RS_MAX_ECC)
+ * @param s Output, ecc_len syndromes
+ * @return Nonzero if any syndrome is nonzero (the block has errors)
+ */
+int k_quirc_rs_syndromes(const uint8_t *block, int len, int ecc_len,
+                         uint8_t *s);
+
+/**
+ * Correct up to ecc_len / 2 codeword errors in place. A clean block costs
+ * one syndrome pass.
+ * @param block Data followed by ECC codewords
+ * @param len Block length (at most K_QUIRC_RS_MAX_BLOCK)
+ * @param ecc_len Number of ECC codewords (1 to K_QUIRC_RS_MAX_ECC)
+ * @param corrected Optional, receives the number of codewords fixed
+ * @return K_QUIRC_SUCCESS, or K_QUIRC_ERROR_DATA_ECC if uncorrectable
+ */
+k_quirc_error_t k_quirc_rs_correct(uint8_t *block, int len, int ecc_len,
+                                   int *corrected);
+
+#endif /* K_QUIRC_RS_H */
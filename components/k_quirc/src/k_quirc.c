@@ -28,12 +28,14 @@ void k_quirc_destroy(k_quirc_t *q) {
       K_FREE(q->pixels);
     if (q->flood_fill_stack)
       K_FREE(q->flood_fill_stack);
+    quirc_decode_buf_free(&q->decode_buf);
     K_FREE(q);
   }
 }
 
 int k_quirc_resize(k_quirc_t *q, int w, int h) {
-  if (w <= 0 || h <= 0 || w > 1280 || h > 1280)
+  if (w <= 0 || h <= 0 || w > K_QUIRC_MAX_IMAGE_SIZE ||
+      h > K_QUIRC_MAX_IMAGE_SIZE)
     return -1;
 
   if (q->image)
@@ -93,55 +95,69 @@ int k_quirc_count(const k_quirc_t *q) { return q->num_grids; }
 
 k_quirc_error_t k_quirc_decode(k_quirc_t *q, int index,
                                k_quirc_result_t *result) {
-  struct quirc_code *code = K_MALLOC_FAST(sizeof(struct quirc_code));
-  if (!code)
-    code = K_MALLOC(sizeof(struct quirc_code));
-  struct quirc_data *data = K_MALLOC_FAST(sizeof(struct quirc_data));
-  if (!data)
-    data = K_MALLOC(sizeof(struct quirc_data));
-
-  if (!code || !data) {
-    if (code)
-      K_FREE(code);
-    if (data)
-      K_FREE(data);
-    return K_QUIRC_ERROR_ALLOC_FAILED;
-  }
+  struct quirc_code code;
+  struct quirc_data data;
+  int version;
+  uint8_t *payload = result->data.payload;
+  size_t payload_cap = result->data.payload_cap;
 
   memset(result, 0, sizeof(*result));
+  result->data.payload = payload;
+  result->data.payload_cap = payload_cap;
   result->valid = false;
 
-  if (index < 0 || index >= q->num_grids) {
-    K_FREE(code);
-    K_FREE(data);
+  if (index < 0 || index >= q->num_grids)
     return K_QUIRC_ERROR_INVALID_GRID_SIZE;
-  }
 
-  quirc_extract_internal(q, index, code);
+  version = (q->grids[index].grid_size - 17) / 4;
+  if (version < 1 || version > QUIRC_MAX_VERSION)
+    return K_QUIRC_ERROR_INVALID_VERSION;
 
-  k_quirc_error_t err = quirc_decode_internal(code, data);
-  if (err == K_QUIRC_SUCCESS) {
-    result->valid = true;
-    for (int i = 0; i < 4; i++) {
-      result->corners[i].x = code->corners[i].x;
-      result->corners[i].y = code->corners[i].y;
-    }
-    result->data.version = data->version;
-    result->data.ecc_level = data->ecc_level;
-    result->data.mask = data->mask;
-    result->data.data_type = data->data_type;
-    result->data.payload_len = data->payload_len;
-    if (result->data.payload_len >= K_QUIRC_MAX_PAYLOAD)
-      result->data.payload_len = K_QUIRC_MAX_PAYLOAD - 1;
-    result->data.eci = data->eci;
-    memcpy(result->data.payload, data->payload, result->data.payload_len);
-    result->data.payload[result->data.payload_len] = 0;
+  /* Scratch grows to the largest version seen, then stays */
+  if (quirc_decode_buf_reserve(&q->decode_buf, version) < 0)
+    return K_QUIRC_ERROR_ALLOC_FAILED;
+
+  memset(&code, 0, sizeof(code));
+  code.cell_bitmap = q->decode_buf.cell_bitmap;
+  quirc_extract_internal(q, index, &code);
+
+  k_quirc_error_t err = quirc_decode_internal(&code, &data, &q->decode_buf);
+  if (err != K_QUIRC_SUCCESS)
+    return err;
+
+  if (result->data.payload_cap < (size_t)data.payload_len + 1) {
+    uint8_t *grown = K_MALLOC((size_t)data.payload_len + 1);
+    if (!grown)
+      return K_QUIRC_ERROR_ALLOC_FAILED;
+    if (result->data.payload)
+      K_FREE(result->data.payload);
+    result->data.payload = grown;
+    result->data.payload_cap = (size_t)data.payload_len + 1;
   }
 
-  K_FREE(code);
-  K_FREE(data);
+  result->valid = true;
+  for (int i = 0; i < 4; i++) {
+    result->corners[i].x = code.corners[i].x;
+    result->corners[i].y = code.corners[i].y;
+  }
+  result->data.version = data.version;
+  result->data.ecc_level = data.ecc_level;
+  result->data.mask = data.mask;
+  result->data.data_type = data.data_type;
+  result->data.payload_len = data.payload_len;
+  result->data.eci = data.eci;
+  memcpy(result->data.payload, data.payload, data.payload_len);
+  result->data.payload[data.payload_len] = 0;
+
+  return K_QUIRC_SUCCESS;
+}
 
-  return err;
+void k_quirc_result_free(k_quirc_result_t *result) {
+  if (!result)
+    return;
+  if (result->data.payload)
+    K_FREE(result->data.payload);
+  memset(result, 0, sizeof(*result));
 }
 
 const char *k_quirc_strerror(k_quirc_error_t err) {
@@ -4,6 +4,7 @@
  */
 
 #include "k_quirc_internal.h"
+#include "k_quirc_rs.h"
 #include "esp_log.h"
 
 static const char *TAG = "k_quirc";
@@ -30,59 +31,9 @@ static const uint8_t gf16_log[16] = {0x00, 0x0f, 0x01, 0x04, 0x02, 0x08,
 static const struct galois_field gf16 = {
     .p = 15, .log = gf16_log, .exp = gf16_exp};
 
-static const uint8_t gf256_exp[256] = {
-    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d, 0x3a, 0x74, 0xe8,
-    0xcd, 0x87, 0x13, 0x26, 0x4c, 0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9,
-    0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x9d, 0x27, 0x4e, 0x9c,
-    0x25, 0x4a, 0x94, 0x35, 0x6a, 0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23,
-    0x46, 0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d, 0xba, 0x69, 0xd2,
-    0xb9, 0x6f, 0xde, 0xa1, 0x5f, 0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc,
-    0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xfd, 0xe7, 0xd3, 0xbb,
-    0x6b, 0xd6, 0xb1, 0x7f, 0xfe, 0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2,
-    0xd9, 0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d, 0x1a, 0x34, 0x68,
-    0xd0, 0xbd, 0x67, 0xce, 0x81, 0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93,
-    0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc, 0x85, 0x17, 0x2e, 0x5c,
-    0xb8, 0x6d, 0xda, 0xa9, 0x4f, 0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54,
-    0xa8, 0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49, 0x92, 0x39, 0x72,
-    0xe4, 0xd5, 0xb7, 0x73, 0xe6, 0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e,
-    0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff, 0xe3, 0xdb, 0xab, 0x4b,
-    0x96, 0x31, 0x62, 0xc4, 0x95, 0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41,
-    0x82, 0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0,
-    0xdd, 0xa7, 0x53, 0xa6, 0x51, 0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef,
-    0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09, 0x12, 0x24, 0x48, 0x90,
-    0x3d, 0x7a, 0xf4, 0xf5, 0xf7, 0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16,
-    0x2c, 0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b, 0x36, 0x6c, 0xd8,
-    0xad, 0x47, 0x8e, 0x01};
-
-static const uint8_t gf256_log[256] = {
-    0x00, 0xff, 0x01, 0x19, 0x02, 0x32, 0x1a, 0xc6, 0x03, 0xdf, 0x33, 0xee,
-    0x1b, 0x68, 0xc7, 0x4b, 0x04, 0x64, 0xe0, 0x0e, 0x34, 0x8d, 0xef, 0x81,
-    0x1c, 0xc1, 0x69, 0xf8, 0xc8, 0x08, 0x4c, 0x71, 0x05, 0x8a, 0x65, 0x2f,
-    0xe1, 0x24, 0x0f, 0x21, 0x35, 0x93, 0x8e, 0xda, 0xf0, 0x12, 0x82, 0x45,
-    0x1d, 0xb5, 0xc2, 0x7d, 0x6a, 0x27, 0xf9, 0xb9, 0xc9, 0x9a, 0x09, 0x78,
-    0x4d, 0xe4, 0x72, 0xa6, 0x06, 0xbf, 0x8b, 0x62, 0x66, 0xdd, 0x30, 0xfd,
-    0xe2, 0x98, 0x25, 0xb3, 0x10, 0x91, 0x22, 0x88, 0x36, 0xd0, 0x94, 0xce,
-    0x8f, 0x96, 0xdb, 0xbd, 0xf1, 0xd2, 0x13, 0x5c, 0x83, 0x38, 0x46, 0x40,
-    0x1e, 0x42, 0xb6, 0xa3, 0xc3, 0x48, 0x7e, 0x6e, 0x6b, 0x3a, 0x28, 0x54,
-    0xfa, 0x85, 0xba, 0x3d, 0xca, 0x5e, 0x9b, 0x9f, 0x0a, 0x15, 0x79, 0x2b,
-    0x4e, 0xd4, 0xe5, 0xac, 0x73, 0xf3, 0xa7, 0x57, 0x07, 0x70, 0xc0, 0xf7,
-    0x8c, 0x80, 0x63, 0x0d, 0x67, 0x4a, 0xde, 0xed, 0x31, 0xc5, 0xfe, 0x18,
-    0xe3, 0xa5, 0x99, 0x77, 0x26, 0xb8, 0xb4, 0x7c, 0x11, 0x44, 0x92, 0xd9,
-    0x23, 0x20, 0x89, 0x2e, 0x37, 0x3f, 0xd1, 0x5b, 0x95, 0xbc, 0xcf, 0xcd,
-    0x90, 0x87, 0x97, 0xb2, 0xdc, 0xfc, 0xbe, 0x61, 0xf2, 0x56, 0xd3, 0xab,
-    0x14, 0x2a, 0x5d, 0x9e, 0x84, 0x3c, 0x39, 0x53, 0x47, 0x6d, 0x41, 0xa2,
-    0x1f, 0x2d, 0x43, 0xd8, 0xb7, 0x7b, 0xa4, 0x76, 0xc4, 0x17, 0x49, 0xec,
-    0x7f, 0x0c, 0x6f, 0xf6, 0x6c, 0xa1, 0x3b, 0x52, 0x29, 0x9d, 0x55, 0xaa,
-    0xfb, 0x60, 0x86, 0xb1, 0xbb, 0xcc, 0x3e, 0x5a, 0xcb, 0x59, 0x5f, 0xb0,
-    0x9c, 0xa9, 0xa0, 0x51, 0x0b, 0xf5, 0x16, 0xeb, 0x7a, 0x75, 0x2c, 0xd7,
-    0x4f, 0xae, 0xd5, 0xe9, 0xe6, 0xe7, 0xad, 0xe8, 0x74, 0xd6, 0xf4, 0xea,
-    0xa8, 0x50, 0x58, 0xaf};
-
-static const struct galois_field gf256 = {
-    .p = 255, .log = gf256_log, .exp = gf256_exp};
-
 /*
- * Polynomial operations for Reed-Solomon
+ * Polynomial operations for the GF(16) format code. Data blocks use the
+ * GF(256) kernels in k_quirc_rs.c.
  */
 static void poly_add(uint8_t *dst, const uint8_t *src, uint8_t c, int shift,
                      const struct galois_field *gf, int len) {
@@ -170,91 +121,6 @@ static void berlekamp_massey(const uint8_t *s, int N,
   memcpy(sigma, C, MAX_POLY);
 }
 
-static int block_syndromes(const uint8_t *data, int bs, int npar, uint8_t *s) {
-  int nonzero = 0;
-
-  memset(s, 0, MAX_POLY);
-
-  for (int i = 0; i < npar; i++) {
-    for (int j = 0; j < bs; j++) {
-      uint8_t c = data[bs - j - 1];
-
-      if (!c)
-        continue;
-
-      s[i] ^= gf256_exp[((int)gf256_log[c] + i * j) % 255];
-    }
-
-    if (s[i])
-      nonzero = 1;
-  }
-
-  return nonzero;
-}
-
-static void eloc_poly(uint8_t *omega, const uint8_t *s, const uint8_t *sigma,
-                      int npar) {
-  memset(omega, 0, MAX_POLY);
-
-  for (int i = 0; i < npar; i++) {
-    const uint8_t a = sigma[i];
-    const uint8_t log_a = gf256_log[a];
-
-    if (!a)
-      continue;
-
-    for (int j = 0; j + 1 < MAX_POLY; j++) {
-      const uint8_t b = s[j + 1];
-
-      if (i + j >= npar)
-        break;
-
-      if (!b)
-        continue;
-
-      omega[i + j] ^= gf256_exp[(log_a + gf256_log[b]) % 255];
-    }
-  }
-}
-
-static k_quirc_error_t correct_block(uint8_t *data,
-                                     const struct quirc_rs_params *ecc) {
-  int npar = ecc->bs - ecc->dw;
-  uint8_t s[MAX_POLY];
-  uint8_t sigma[MAX_POLY];
-  uint8_t sigma_deriv[MAX_POLY];
-  uint8_t omega[MAX_POLY];
-
-  if (!block_syndromes(data, ecc->bs, npar, s))
-    return K_QUIRC_SUCCESS;
-
-  berlekamp_massey(s, npar, &gf256, sigma);
-
-  memset(sigma_deriv, 0, MAX_POLY);
-  for (int i = 0; i + 1 < npar; i += 2)
-    sigma_deriv[i] = sigma[i + 1];
-
-  eloc_poly(omega, s, sigma, npar - 1);
-
-  for (int i = 0; i < ecc->bs; i++) {
-    uint8_t xinv = gf256_exp[255 - i];
-
-    if (!poly_eval(sigma, xinv, &gf256, npar)) {
-      uint8_t sd_x = poly_eval(sigma_deriv, xinv, &gf256, npar);
-      uint8_t omega_x = poly_eval(omega, xinv, &gf256, npar);
-      uint8_t error =
-          gf256_exp[(255 - gf256_log[sd_x] + gf256_log[omega_x]) % 255];
-
-      data[ecc->bs - i - 1] ^= error;
-    }
-  }
-
-  if (block_syndromes(data, ecc->bs, npar, s))
-    return K_QUIRC_ERROR_DATA_ECC;
-
-  return K_QUIRC_SUCCESS;
-}
-
 /*
  * Format correction
  */
@@ -305,10 +171,10 @@ static k_quirc_error_t correct_format(uint16_t *f_ret) {
  * Datastream handling
  */
 struct datastream {
-  uint8_t raw[K_QUIRC_MAX_PAYLOAD];
+  uint8_t *raw;
   int data_bits;
   int ptr;
-  uint8_t data[K_QUIRC_MAX_PAYLOAD];
+  uint8_t *data;
 };
 
 static inline int grid_bit(const struct quirc_code *code, int x, int y) {
@@ -441,16 +307,10 @@ static void build_reserved_bitmap(int version, int size, uint8_t *bitmap) {
 }
 
 static void read_data(const struct quirc_code *code, struct quirc_data *data,
-                      struct datastream *ds) {
+                      struct datastream *ds, uint8_t *reserved) {
   int y = code->size - 1;
   int x = code->size - 1;
   int dir = -1;
-  uint8_t reserved[K_QUIRC_MAX_BITMAP];
-
-  /* Verify bitmap fits: (size*size+7)/8 must fit in K_QUIRC_MAX_BITMAP */
-  if (code->size <= 0 ||
-      (size_t)((code->size * code->size + 7) >> 3) > K_QUIRC_MAX_BITMAP)
-    return;
 
   build_reserved_bitmap(data->version, code->size, reserved);
 
@@ -500,7 +360,7 @@ static k_quirc_error_t codestream_ecc(struct quirc_data *data,
     for (int j = 0; j < num_ec; j++)
       dst[ecc->dw + j] = ds->raw[ecc_offset + j * bc + i];
 
-    err = correct_block(dst, ecc);
+    err = k_quirc_rs_correct(dst, ecc->bs, num_ec, NULL);
     if (err)
       return err;
 
@@ -567,7 +427,7 @@ static k_quirc_error_t decode_numeric(struct quirc_data *data,
     bits = 12;
 
   count = take_bits(ds, bits);
-  if (data->payload_len + count + 1 > K_QUIRC_MAX_PAYLOAD)
+  if (data->payload_len + count + 1 > data->payload_cap)
     return K_QUIRC_ERROR_DATA_OVERFLOW;
 
   while (count >= 3) {
@@ -603,7 +463,7 @@ static k_quirc_error_t decode_alpha(struct quirc_data *data,
     bits = 11;
 
   count = take_bits(ds, bits);
-  if (data->payload_len + count + 1 > K_QUIRC_MAX_PAYLOAD)
+  if (data->payload_len + count + 1 > data->payload_cap)
     return K_QUIRC_ERROR_DATA_OVERFLOW;
 
   while (count >= 2) {
@@ -640,7 +500,7 @@ static k_quirc_error_t decode_byte(struct quirc_data *data,
     bits = 8;
 
   count = take_bits(ds, bits);
-  if (data->payload_len + count + 1 > K_QUIRC_MAX_PAYLOAD)
+  if (data->payload_len + count + 1 > data->payload_cap)
     return K_QUIRC_ERROR_DATA_OVERFLOW;
 
   while (count) {
@@ -665,7 +525,7 @@ static k_quirc_error_t decode_kanji(struct quirc_data *data,
     bits = 10;
 
   count = take_bits(ds, bits);
-  if (data->payload_len + count * 2 + 1 > K_QUIRC_MAX_PAYLOAD)
+  if (data->payload_len + count * 2 + 1 > data->payload_cap)
     return K_QUIRC_ERROR_DATA_OVERFLOW;
 
   while (count) {
@@ -758,53 +618,96 @@ done:
   return K_QUIRC_SUCCESS;
 }
 
+/*
+ * Decode buffers
+ */
+static int bitmap_bytes(int version) {
+  int size = version * 4 + 17;
+  return (size * size + 7) >> 3;
+}
+
+/* Numeric mode packs the most characters: 3 digits per 10 bits */
+static int payload_bound(int version) {
+  return quirc_version_db[version].data_bytes * 8 * 3 / 10 + 4;
+}
+
+int quirc_decode_buf_reserve(struct quirc_decode_buf *buf, int version) {
+  if (version < 1 || version > QUIRC_MAX_VERSION)
+    return -1;
+  if (buf->mem && version <= buf->version)
+    return 0;
+
+  const int bitmap = bitmap_bytes(version);
+  /* Remainder bits after the last codeword land in one extra raw byte */
+  const int codewords = quirc_version_db[version].data_bytes + 1;
+  const int payload = payload_bound(version);
+  const size_t total = (size_t)bitmap * 2 + (size_t)codewords * 2 + payload;
+
+  quirc_decode_buf_free(buf);
+
+  uint8_t *mem = K_MALLOC_FAST(total);
+  if (!mem)
+    mem = K_MALLOC(total);
+  if (!mem)
+    return -1;
+
+  buf->mem = mem;
+  buf->version = version;
+  buf->cell_bitmap = mem;
+  buf->reserved = buf->cell_bitmap + bitmap;
+  buf->raw = buf->reserved + bitmap;
+  buf->data = buf->raw + codewords;
+  buf->payload = buf->data + codewords;
+  buf->payload_cap = payload;
+  return 0;
+}
+
+void quirc_decode_buf_free(struct quirc_decode_buf *buf) {
+  if (buf->mem)
+    K_FREE(buf->mem);
+  memset(buf, 0, sizeof(*buf));
+}
+
 /*
  * Public decode functions
  */
 k_quirc_error_t quirc_decode_internal(const struct quirc_code *code,
-                                      struct quirc_data *data) {
+                                      struct quirc_data *data,
+                                      const struct quirc_decode_buf *buf) {
   k_quirc_error_t err;
-  struct datastream *ds;
+  struct datastream ds;
+  int version;
 
   if ((code->size - 17) % 4)
     return K_QUIRC_ERROR_INVALID_GRID_SIZE;
 
-  ds = K_MALLOC_FAST(sizeof(*ds));
-  if (!ds) {
-    ds = K_MALLOC(sizeof(*ds));
-  }
-  if (!ds)
-    return K_QUIRC_ERROR_ALLOC_FAILED;
+  version = (code->size - 17) / 4;
+  if (version < 1 || version > buf->version)
+    return K_QUIRC_ERROR_INVALID_VERSION;
 
-  memset(ds, 0, sizeof(*ds));
   memset(data, 0, sizeof(*data));
+  data->version = version;
+  data->payload = buf->payload;
+  data->payload_cap = buf->payload_cap;
 
-  data->version = (code->size - 17) / 4;
-
-  if (data->version < 1 || data->version > QUIRC_MAX_VERSION) {
-    K_FREE(ds);
-    return K_QUIRC_ERROR_INVALID_VERSION;
-  }
+  memset(&ds, 0, sizeof(ds));
+  ds.raw = buf->raw;
+  ds.data = buf->data;
+  memset(ds.raw, 0, quirc_version_db[version].data_bytes + 1);
 
   err = read_format(code, data, 0);
   if (err) {
     err = read_format(code, data, 1);
-    if (err) {
-      K_FREE(ds);
+    if (err)
       return err;
-    }
   }
 
-  read_data(code, data, ds);
-  err = codestream_ecc(data, ds);
-  if (err) {
-    K_FREE(ds);
+  read_data(code, data, &ds, buf->reserved);
+  err = codestream_ecc(data, &ds);
+  if (err)
     return err;
-  }
 
-  err = decode_payload(data, ds);
-  K_FREE(ds);
-  return err;
+  return decode_payload(data, &ds);
 }
 
 void quirc_extract_internal(const struct k_quirc *q, int index,
@@ -815,9 +718,9 @@ void quirc_extract_internal(const struct k_quirc *q, int index,
   if (index < 0 || index >= q->num_grids)
     return;
 
-  memset(code, 0, sizeof(*code));
+  code->size = 0;
 
-  /* Bounds check to prevent buffer overflow in cell_bitmap */
+  /* The cell bitmap is sized by the caller for this grid */
   if (qr->grid_size > max_grid_size) {
     ESP_LOGW(TAG, "Grid size %d exceeds max %d, skipping extraction",
              qr->grid_size, max_grid_size);
@@ -831,6 +734,7 @@ void quirc_extract_internal(const struct k_quirc *q, int index,
   perspective_map(qr->c, 0.0f, qr->grid_size, &code->corners[3]);
 
   code->size = qr->grid_size;
+  memset(code->cell_bitmap, 0, (code->size * code->size + 7) >> 3);
 
   int i = 0;
   for (int y = 0; y < qr->grid_size; y++) {
@@ -840,7 +744,8 @@ void quirc_extract_internal(const struct k_quirc *q, int index,
       perspective_map(qr->c, x + 0.5f, y + 0.5f, &p);
 
       if (p.y >= 0 && p.y < q->h && p.x >= 0 && p.x < q->w) {
-        if (q->pixels[p.y * q->w + p.x])
+        quirc_pixel_t pixel = q->pixels[p.y * q->w + p.x];
+        if (quirc_pixel_is_ink(q, pixel, qr->polarity))
           code->cell_bitmap[i >> 3] |= (1 << (i & 7));
       }
 
@@ -4,8 +4,6 @@
  */
 
 #include "k_quirc_internal.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 
 /*
  * LIFO (stack) for flood-fill — uses persistent buffer from struct k_quirc
@@ -134,43 +132,78 @@ static void solve_8x8_system(float A[8][8], float b[8], float x[8]) {
   }
 }
 
-static void perspective_setup_direct(float *c, const float img[4][2],
-                                     const float mod[4][2]) {
-  float A[8][8];
-  float b[8];
-
-  for (int i = 0; i < 4; i++) {
-    float u = mod[i][0], v = mod[i][1];
-    float x = img[i][0], y = img[i][1];
-    int row1 = i * 2, row2 = i * 2 + 1;
-
-    A[row1][0] = u;    A[row1][1] = v;    A[row1][2] = 1.0f;
-    A[row1][3] = 0.0f; A[row1][4] = 0.0f; A[row1][5] = 0.0f;
-    A[row1][6] = -u * x; A[row1][7] = -v * x;
-    b[row1] = x;
-
-    A[row2][0] = 0.0f; A[row2][1] = 0.0f; A[row2][2] = 0.0f;
-    A[row2][3] = u;    A[row2][4] = v;    A[row2][5] = 1.0f;
-    A[row2][6] = -u * y; A[row2][7] = -v * y;
-    b[row2] = y;
+/*
+ * Closed-form homography taking the unit square corners (0,0), (1,0), (1,1),
+ * (0,1) to the quad q[0..3] (Heckbert). Row-major 3x3 with h[8] = 1.
+ */
+static int square_to_quad(const float q[4][2], float h[9]) {
+  float dx1 = q[1][0] - q[2][0];
+  float dx2 = q[3][0] - q[2][0];
+  float dy1 = q[1][1] - q[2][1];
+  float dy2 = q[3][1] - q[2][1];
+  float sx = q[0][0] - q[1][0] + q[2][0] - q[3][0];
+  float sy = q[0][1] - q[1][1] + q[2][1] - q[3][1];
+  float g = 0.0f;
+  float k = 0.0f;
+
+  /* Non-zero sx/sy: not a parallelogram, so there is a projective part */
+  if (sx != 0.0f || sy != 0.0f) {
+    float det = dx1 * dy2 - dx2 * dy1;
+    if (fabsf(det) < 1e-10f)
+      return 0;
+    g = (sx * dy2 - dx2 * sy) / det;
+    k = (dx1 * sy - sx * dy1) / det;
   }
 
-  solve_8x8_system(A, b, c);
+  h[0] = q[1][0] - q[0][0] + g * q[1][0];
+  h[1] = q[3][0] - q[0][0] + k * q[3][0];
+  h[2] = q[0][0];
+  h[3] = q[1][1] - q[0][1] + g * q[1][1];
+  h[4] = q[3][1] - q[0][1] + k * q[3][1];
+  h[5] = q[0][1];
+  h[6] = g;
+  h[7] = k;
+  h[8] = 1.0f;
+  return 1;
 }
 
-static void perspective_unmap(const float *c, const struct quirc_point *in,
-                              float *u, float *v) {
-  float x = in->x;
-  float y = in->y;
-  float den = -c[0] * c[7] * y + c[1] * c[6] * y +
-              (c[3] * c[7] - c[4] * c[6]) * x + c[0] * c[4] - c[1] * c[3];
-
-  *u = -(c[1] * (y - c[5]) - c[2] * c[7] * y + (c[5] * c[7] - c[4]) * x +
-         c[2] * c[4]) /
-       den;
-  *v = (c[0] * (y - c[5]) - c[2] * c[6] * y + (c[5] * c[6] - c[3]) * x +
-        c[2] * c[3]) /
-       den;
+/*
+ * Perspective taking the module quad mod[] to the image quad img[]: square to
+ * img composed with the inverse of square to mod. The adjugate stands in for
+ * the inverse since the scale is normalised away.
+ */
+static void perspective_setup_direct(float *c, const float img[4][2],
+                                     const float mod[4][2]) {
+  float a[9], b[9], adj[9], m[9];
+
+  if (!square_to_quad(img, a) || !square_to_quad(mod, b))
+    goto degenerate;
+
+  adj[0] = b[4] * b[8] - b[5] * b[7];
+  adj[1] = b[2] * b[7] - b[1] * b[8];
+  adj[2] = b[1] * b[5] - b[2] * b[4];
+  adj[3] = b[5] * b[6] - b[3] * b[8];
+  adj[4] = b[0] * b[8] - b[2] * b[6];
+  adj[5] = b[2] * b[3] - b[0] * b[5];
+  adj[6] = b[3] * b[7] - b[4] * b[6];
+  adj[7] = b[1] * b[6] - b[0] * b[7];
+  adj[8] = b[0] * b[4] - b[1] * b[3];
+
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      m[i * 3 + j] = a[i * 3] * adj[j] + a[i * 3 + 1] * adj[3 + j] +
+                     a[i * 3 + 2] * adj[6 + j];
+
+  if (fabsf(m[8]) < 1e-10f)
+    goto degenerate;
+
+  for (int i = 0; i < QUIRC_PERSPECTIVE_PARAMS; i++)
+    c[i] = m[i] / m[8];
+  return;
+
+degenerate:
+  for (int i = 0; i < QUIRC_PERSPECTIVE_PARAMS; i++)
+    c[i] = 0.0f;
 }
 
 /*
@@ -303,7 +336,6 @@ static uint8_t otsu_threshold(uint32_t *histogram, uint32_t total) {
 #ifdef K_QUIRC_ADAPTIVE_THRESHOLD
 #define THRESHOLD_OFFSET_MAX 20
 static int threshold_offset = 10;
-static bool processing_inverted = false;
 #endif
 
 static inline int clamp_threshold(int t) {
@@ -429,12 +461,27 @@ static void threshold(struct k_quirc *q, bool inverted) {
 }
 
 ALWAYS_INLINE void area_count(void *user_data, int y, int left, int right) {
-  (void)y;
-  ((struct quirc_region *)user_data)->count += right - left + 1;
+  struct quirc_region *box = (struct quirc_region *)user_data;
+  int n = right - left + 1;
+
+  box->count += n;
+  box->sum_x += (uint32_t)((left + right) * n / 2);
+  box->sum_y += (uint32_t)(y * n);
+}
+
+static void region_centroid(const struct quirc_region *box, float *x,
+                            float *y) {
+  *x = (float)box->sum_x / (float)box->count;
+  *y = (float)box->sum_y / (float)box->count;
 }
 
+/*
+ * Regions are connected areas of module-coloured pixels: black for normal
+ * codes, white for inverted ones. Both kinds share the label space, so the
+ * region remembers its polarity and q->ink tells the two apart.
+ */
 HOT_FUNC
-static int region_code(struct k_quirc *q, int x, int y) {
+static int region_code(struct k_quirc *q, int x, int y, int polarity) {
   int pixel;
   struct quirc_region *box;
   int region;
@@ -444,12 +491,12 @@ static int region_code(struct k_quirc *q, int x, int y) {
 
   pixel = q->pixels[y * q->w + x];
 
+  if (!quirc_pixel_is_ink(q, pixel, polarity))
+    return -1;
+
   if (pixel >= QUIRC_PIXEL_REGION)
     return pixel;
 
-  if (pixel == QUIRC_PIXEL_WHITE)
-    return -1;
-
   if (q->num_regions >= QUIRC_MAX_REGIONS)
     return -1;
 
@@ -461,6 +508,8 @@ static int region_code(struct k_quirc *q, int x, int y) {
   box->seed.x = x;
   box->seed.y = y;
   box->capstone = -1;
+  box->polarity = polarity;
+  q->ink[region] = 1 << polarity;
 
   flood_fill_seed(q, x, y, pixel, region, area_count, box, 0);
 
@@ -514,13 +563,17 @@ static void find_region_corners(struct k_quirc *q, int rcode,
                                 struct quirc_point *corners) {
   struct quirc_region *region = &q->regions[rcode];
   struct polygon_score_data psd;
+  /* Temporarily restore the region's original colour */
+  quirc_pixel_t base = (region->polarity == QUIRC_POLARITY_INVERTED)
+                           ? QUIRC_PIXEL_WHITE
+                           : QUIRC_PIXEL_BLACK;
 
   memset(&psd, 0, sizeof(psd));
   psd.corners = corners;
 
   memcpy(&psd.ref, ref, sizeof(psd.ref));
   psd.scores[0] = -1;
-  flood_fill_seed(q, region->seed.x, region->seed.y, rcode, QUIRC_PIXEL_BLACK,
+  flood_fill_seed(q, region->seed.x, region->seed.y, rcode, base,
                   find_one_corner, &psd, 0);
 
   psd.ref.x = psd.corners[0].x - psd.ref.x;
@@ -536,7 +589,7 @@ static void find_region_corners(struct k_quirc *q, int rcode,
   psd.scores[1] = i;
   psd.scores[3] = -i;
 
-  flood_fill_seed(q, region->seed.x, region->seed.y, QUIRC_PIXEL_BLACK, rcode,
+  flood_fill_seed(q, region->seed.x, region->seed.y, base, rcode,
                   find_other_corners, &psd, 0);
 }
 
@@ -555,6 +608,7 @@ static void record_capstone(struct k_quirc *q, int ring, int stone) {
   memset(capstone, 0, sizeof(*capstone));
 
   capstone->qr_grid = -1;
+  capstone->polarity = ring_reg->polarity;
   capstone->ring = ring;
   capstone->stone = stone;
   stone_reg->capstone = cs_index;
@@ -565,12 +619,59 @@ static void record_capstone(struct k_quirc *q, int ring, int stone) {
   perspective_map(capstone->c, 3.5f, 3.5f, &capstone->center);
 }
 
-static void test_capstone(struct k_quirc *q, int x, int y, int *pb) {
+/* Length of the run of ink (or non-ink) from (x, y) stepping by (dx, dy) */
+static int pixel_run(const struct k_quirc *q, int x, int y, int dx, int dy,
+                     int ink, int polarity, int limit) {
+  int n = 0;
+
+  for (x += dx, y += dy;
+       x >= 0 && x < q->w && y >= 0 && y < q->h && n <= limit;
+       x += dx, y += dy, n++)
+    if (quirc_pixel_is_ink(q, q->pixels[y * q->w + x], polarity) != ink)
+      break;
+  return n;
+}
+
+/*
+ * The same 1:1:3:1:1 ratio down the stone's column. Most horizontal matches
+ * inside the data area fail it, so they never use up flood-filled regions,
+ * which run out on the many candidates of a large code.
+ */
+static int cross_check_vertical(const struct k_quirc *q, int x, int y,
+                                int module, int polarity) {
+  int limit = module * 4;
+  int up = pixel_run(q, x, y, 0, -1, 1, polarity, limit);
+  int down = pixel_run(q, x, y, 0, 1, 1, polarity, limit);
+  int gap_up = pixel_run(q, x, y - up, 0, -1, 0, polarity, limit);
+  int gap_down = pixel_run(q, x, y + down, 0, 1, 0, polarity, limit);
+  int ring_up = pixel_run(q, x, y - up - gap_up, 0, -1, 1, polarity, limit);
+  int ring_down =
+      pixel_run(q, x, y + down + gap_down, 0, 1, 1, polarity, limit);
+  int stone = up + down + 1;
+  int total = ring_up + gap_up + stone + gap_down + ring_down;
+  /* Pitch from the whole 7-module span, so rounding cannot sink short runs */
+  int err = total * 3 / 4;
+
+  return abs(ring_up * 7 - total) <= err && abs(gap_up * 7 - total) <= err &&
+         abs(gap_down * 7 - total) <= err &&
+         abs(ring_down * 7 - total) <= err &&
+         abs(stone * 7 - total * 3) <= err && total * 3 >= module * 7 &&
+         total <= module * 21;
+}
+
+static void test_capstone(struct k_quirc *q, int x, int y, const int *pb,
+                          int polarity) {
   int ring_right_x = x - pb[4];
   int ring_left_x = x - pb[4] - pb[3] - pb[2] - pb[1] - pb[0];
   int stone_x = x - pb[4] - pb[3] - pb[2];
-  int ring_right = region_code(q, ring_right_x, y);
-  int ring_left = region_code(q, ring_left_x, y);
+  int module = (pb[0] + pb[1] + pb[3] + pb[4]) >> 2;
+
+  if (!cross_check_vertical(q, stone_x + pb[2] / 2, y, module ? module : 1,
+                            polarity))
+    return;
+
+  int ring_right = region_code(q, ring_right_x, y, polarity);
+  int ring_left = region_code(q, ring_left_x, y, polarity);
 
   if (ring_left < 0 || ring_right < 0)
     return;
@@ -578,7 +679,7 @@ static void test_capstone(struct k_quirc *q, int x, int y, int *pb) {
   if (ring_left != ring_right)
     return;
 
-  int stone = region_code(q, stone_x, y);
+  int stone = region_code(q, stone_x, y, polarity);
   if (stone < 0)
     return;
 
@@ -598,19 +699,29 @@ static void test_capstone(struct k_quirc *q, int x, int y, int *pb) {
   record_capstone(q, ring_left, stone);
 }
 
-static void finder_scan(struct k_quirc *q, int y) {
+/*
+ * Run-length scan for the 1:1:3:1:1 finder ratio. Runs are split on module
+ * colour (dark/light), so one pass finds both polarities: a candidate ending
+ * on a dark run is a normal capstone, one ending on a light run an inverted
+ * capstone (checked only when scan_inverted is set).
+ */
+static void finder_scan(struct k_quirc *q, int y, bool scan_inverted) {
   quirc_pixel_t *row = q->pixels + y * q->w;
-  uint8_t last_color;
+  quirc_pixel_t last_color;
+  int last_dark;
   int run_length = 1;
   int run_count = 0;
   int pb[5];
 
   memset(pb, 0, sizeof(pb));
   last_color = row[0];
+  last_dark = quirc_pixel_is_ink(q, last_color, QUIRC_POLARITY_NORMAL);
   for (int x = 1; x < q->w; x++) {
-    uint8_t color = row[x];
+    quirc_pixel_t color = row[x];
 
-    if (color != last_color) {
+    /* Labels only change at a colour edge, so look up on change only */
+    if (color != last_color &&
+        quirc_pixel_is_ink(q, color, QUIRC_POLARITY_NORMAL) != last_dark) {
       pb[0] = pb[1];
       pb[1] = pb[2];
       pb[2] = pb[3];
@@ -619,7 +730,7 @@ static void finder_scan(struct k_quirc *q, int y) {
       run_length = 0;
       run_count++;
 
-      if (!color && run_count >= 5) {
+      if (run_count >= 5 && (last_dark || scan_inverted)) {
         int avg = (pb[0] + pb[1] + pb[3] + pb[4]) >> 2;
         if (avg == 0)
           avg = 1;
@@ -636,9 +747,12 @@ static void finder_scan(struct k_quirc *q, int y) {
             pb[2] >= lo3 && pb[2] <= hi3 &&
             pb[3] >= lo && pb[3] <= hi &&
             pb[4] >= lo && pb[4] <= hi) {
-          test_capstone(q, x, y, pb);
+          test_capstone(q, x, y, pb,
+                        last_dark ? QUIRC_POLARITY_NORMAL
+                                  : QUIRC_POLARITY_INVERTED);
         }
       }
+      last_dark = !last_dark;
     }
 
     run_length++;
@@ -646,42 +760,118 @@ static void finder_scan(struct k_quirc *q, int y) {
   }
 }
 
+/*
+ * Ink vote over a 3x3 sample of a module, placed by an affine frame: the
+ * origin is a stone centroid and u, v step one module along the grid.
+ */
+static int affine_cell(const struct k_quirc *q, int polarity, const float *o,
+                       const float *u, const float *v, float du, float dv) {
+  static const float offsets[] = {-0.2f, 0.0f, 0.2f};
+  int score = 0;
+
+  for (int j = 0; j < 3; j++) {
+    for (int i = 0; i < 3; i++) {
+      float a = du + offsets[i];
+      float b = dv + offsets[j];
+      int x = (int)(o[0] + a * u[0] + b * v[0]);
+      int y = (int)(o[1] + a * u[1] + b * v[1]);
+
+      if (y >= 0 && y < q->h && x >= 0 && x < q->w)
+        score += quirc_pixel_is_ink(q, q->pixels[y * q->w + x], polarity)
+                     ? 1
+                     : -1;
+    }
+  }
+
+  return score;
+}
+
+/*
+ * Module steps along the grid's rows and columns, from the spacing of the
+ * stone centroids over a grid of this size.
+ */
+static void grid_axes(const struct k_quirc *q, int index, int grid_size,
+                      float stone[3][2], float *u, float *v) {
+  const struct quirc_grid *qr = &q->grids[index];
+  const float span = (float)(grid_size - 7);
+
+  for (int i = 0; i < 3; i++)
+    region_centroid(&q->regions[q->capstones[qr->caps[i]].stone],
+                    &stone[i][0], &stone[i][1]);
+
+  u[0] = (stone[2][0] - stone[1][0]) / span;
+  u[1] = (stone[2][1] - stone[1][1]) / span;
+  v[0] = (stone[0][0] - stone[1][0]) / span;
+  v[1] = (stone[0][1] - stone[1][1]) / span;
+}
+
+/*
+ * Match the 5x5 alignment pattern around a candidate stone. Single data
+ * modules of the right size are common on large codes; the light ring and
+ * dark ring around one are not. A few misses are allowed for blur and for
+ * keystone, which the stone-spaced axes do not follow.
+ */
+static int alignment_template_check(const struct k_quirc *q,
+                                    const struct quirc_region *reg,
+                                    int polarity, const float *u,
+                                    const float *v) {
+  float o[2];
+  int misses = 0;
+
+  region_centroid(reg, &o[0], &o[1]);
+
+  for (int j = -2; j <= 2; j++) {
+    for (int i = -2; i <= 2; i++) {
+      int ring = abs(i) > abs(j) ? abs(i) : abs(j);
+      int ink = affine_cell(q, polarity, o, u, v, (float)i, (float)j) > 0;
+
+      if (ink != (ring != 1) && ++misses > 4)
+        return 0;
+    }
+  }
+
+  return 1;
+}
+
 static void find_alignment_pattern(struct k_quirc *q, int index) {
   struct quirc_grid *qr = &q->grids[index];
   struct quirc_capstone *c0 = &q->capstones[qr->caps[0]];
   struct quirc_capstone *c2 = &q->capstones[qr->caps[2]];
-  struct quirc_point a;
   struct quirc_point b;
-  struct quirc_point c;
+  float stone[3][2], u[2], v[2];
   int size_estimate;
   int step_size = 1;
   int dir = 0;
-  float u, v;
+  int rejected = -1;
 
   memcpy(&b, &qr->align, sizeof(b));
+  grid_axes(q, index, qr->grid_size, stone, u, v);
 
-  perspective_unmap(c0->c, &b, &u, &v);
-  perspective_map(c0->c, u, v + 1.0f, &a);
-  perspective_unmap(c2->c, &b, &u, &v);
-  perspective_map(c2->c, u + 1.0f, v, &c);
-
-  size_estimate = abs((a.x - b.x) * -(c.y - b.y) + (a.y - b.y) * (c.x - b.x));
+  /*
+   * Module area from the 3x3 finder stones. Extrapolating a capstone's own
+   * perspective out to the alignment pattern misjudges it on large grids.
+   */
+  size_estimate =
+      (q->regions[c0->stone].count + q->regions[c2->stone].count) / 18;
 
   while (step_size * step_size < size_estimate * 100) {
     static const int dx_map[] = {1, 0, -1, 0};
     static const int dy_map[] = {0, -1, 0, 1};
 
     for (int i = 0; i < step_size; i++) {
-      int code = region_code(q, b.x, b.y);
+      int code = region_code(q, b.x, b.y, qr->polarity);
 
-      if (code >= 0) {
+      /* The spiral crosses each region many times; judge it once */
+      if (code >= 0 && code != rejected) {
         struct quirc_region *reg = &q->regions[code];
 
         if (reg->count >= size_estimate / 2 &&
-            reg->count <= size_estimate * 2) {
+            reg->count <= size_estimate * 2 &&
+            alignment_template_check(q, reg, qr->polarity, u, v)) {
           qr->align_region = code;
           return;
         }
+        rejected = code;
       }
 
       b.x += dx_map[dir];
@@ -703,6 +893,7 @@ static int fitness_cell(const struct k_quirc *q, int index, int x, int y) {
   int w = q->w;
   int h = q->h;
   const quirc_pixel_t *pixels = q->pixels;
+  int polarity = qr->polarity;
 
   for (int v = 0; v < 3; v++) {
     float yoff = y + offsets[v];
@@ -710,7 +901,8 @@ static int fitness_cell(const struct k_quirc *q, int index, int x, int y) {
       perspective_map(qr->c, x + offsets[u], yoff, &p);
 
       if (LIKELY(p.y >= 0 && p.y < h && p.x >= 0 && p.x < w)) {
-        score += pixels[p.y * w + p.x] ? 1 : -1;
+        score += quirc_pixel_is_ink(q, pixels[p.y * w + p.x], polarity) ? 1
+                                                                        : -1;
       }
     }
   }
@@ -818,59 +1010,261 @@ int k_quirc_get_threshold_offset(void) { return threshold_offset; }
 int k_quirc_get_threshold_offset(void) { return 0; }
 #endif
 
-#define JIGGLE_PASSES 2
+/*
+ * Perspective refinement. Features are measured near where the current fit
+ * puts them: the finder stones, the alignment pattern stones and the dark
+ * timing modules. Each gives a residual along a direction (both axes for
+ * centroids, along the row or column for timing modules), and a
+ * Gauss-Newton step on the 8 coefficients reduces them.
+ */
+#define FIT_PASSES 3
+#define FIT_CONSISTENT 0.15f /* RMS residual, in modules */
+#define FIT_DAMPING 1e-3f
+
+static inline void perspective_map_f(const float *c, float u, float v,
+                                     float *x, float *y) {
+  float inv_den = 1.0f / (c[6] * u + c[7] * v + 1.0f);
+  *x = (c[0] * u + c[1] * v + c[2]) * inv_den;
+  *y = (c[3] * u + c[4] * v + c[5]) * inv_den;
+}
 
-static void jiggle_perspective(struct k_quirc *q, int index) {
-  struct quirc_grid *qr = &q->grids[index];
-  int best = fitness_all(q, index);
-  int pass;
-  float adjustments[8];
-
-  float step_factor = 0.42f / (float)qr->grid_size;
-  for (int i = 0; i < 8; i++)
-    adjustments[i] = qr->c[i] * step_factor;
-
-  for (pass = 0; pass < JIGGLE_PASSES; pass++) {
-    for (int i = 0; i < 16; i++) {
-      int j = i >> 1;
-      int test;
-      float old = qr->c[j];
-      float step = adjustments[j];
-      float new_val;
-
-      if (i & 1)
-        new_val = old + step;
-      else
-        new_val = old - step;
-
-      qr->c[j] = new_val;
-      test = fitness_all(q, index);
-
-      if (test > best)
-        best = test;
-      else
-        qr->c[j] = old;
+static int fit_add(struct k_quirc *q, int n, float u, float v, float x,
+                   float y, float dx, float dy) {
+  if (n >= QUIRC_MAX_FIT_OBS)
+    return n;
+
+  struct quirc_fit_obs *o = &q->fit_obs[n];
+  o->u = u;
+  o->v = v;
+  o->x = x;
+  o->y = y;
+  o->dx = dx;
+  o->dy = dy;
+  return n + 1;
+}
+
+static int fit_add_centroid(struct k_quirc *q, int n, int region, float u,
+                            float v) {
+  float x, y;
+
+  region_centroid(&q->regions[region], &x, &y);
+  n = fit_add(q, n, u, v, x, y, 1.0f, 0.0f);
+  return fit_add(q, n, u, v, x, y, 0.0f, 1.0f);
+}
+
+/* Alignment stone centred on module (u, v), if it is where the fit says */
+static int fit_add_apat(struct k_quirc *q, int index, int n, float u, float v,
+                        float module_area) {
+  const struct quirc_grid *qr = &q->grids[index];
+  struct quirc_point p;
+  int code;
+
+  perspective_map(qr->c, u, v, &p);
+  if (p.x < 0 || p.y < 0 || p.x >= q->w || p.y >= q->h)
+    return n;
+
+  code = region_code(q, p.x, p.y, qr->polarity);
+  if (code < 0 || q->regions[code].count < module_area * 0.5f ||
+      q->regions[code].count > module_area * 2.0f)
+    return n;
+
+  return fit_add_centroid(q, n, code, u, v);
+}
+
+static inline int fit_is_ink(const struct k_quirc *q, float x, float y,
+                             int polarity) {
+  int px = fast_roundf(x);
+  int py = fast_roundf(y);
+
+  if (px < 0 || py < 0 || px >= q->w || py >= q->h)
+    return -1;
+  return quirc_pixel_is_ink(q, q->pixels[py * q->w + px], polarity);
+}
+
+/*
+ * Dark timing module centred on (u, v). Walk in pixel steps along the row
+ * (horizontal) or column to both of its edges and take the midpoint.
+ */
+static int fit_add_timing(struct k_quirc *q, int index, int n, float u,
+                          float v, int horizontal) {
+  const struct quirc_grid *qr = &q->grids[index];
+  float du = horizontal ? 1.0f : 0.0f;
+  float dv = horizontal ? 0.0f : 1.0f;
+  float x0, y0, x1, y1, cx, cy;
+  float ex, ey, module;
+  float edge[2];
+
+  perspective_map_f(qr->c, u - du, v - dv, &x0, &y0);
+  perspective_map_f(qr->c, u + du, v + dv, &x1, &y1);
+  perspective_map_f(qr->c, u, v, &cx, &cy);
+
+  module = sqrtf((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0)) * 0.5f;
+  if (module < 1.0f || fit_is_ink(q, cx, cy, qr->polarity) != 1)
+    return n;
+  ex = (x1 - x0) / (2.0f * module);
+  ey = (y1 - y0) / (2.0f * module);
+
+  for (int side = 0; side < 2; side++) {
+    float step = side ? 1.0f : -1.0f;
+    float t = 0.0f;
+    int ink;
+
+    while ((ink = fit_is_ink(q, cx + (t + step) * ex, cy + (t + step) * ey,
+                             qr->polarity)) == 1) {
+      t += step;
+      /* Ran into a neighbour: not an isolated timing module */
+      if (fabsf(t) > module * 1.5f)
+        return n;
     }
+    if (ink < 0)
+      return n;
+    edge[side] = t;
+  }
 
+  cx += (edge[0] + edge[1]) * 0.5f * ex;
+  cy += (edge[0] + edge[1]) * 0.5f * ey;
+  return fit_add(q, n, u, v, cx, cy, ex, ey);
+}
+
+static int fit_collect(struct k_quirc *q, int index, float module_area) {
+  const struct quirc_grid *qr = &q->grids[index];
+  float gs = (float)qr->grid_size;
+  int version = (qr->grid_size - 17) / 4;
+  const struct quirc_version_info *info = &quirc_version_db[version];
+  int ap_count = 0;
+  int n = 0;
+
+  n = fit_add_centroid(q, n, q->capstones[qr->caps[1]].stone, 3.5f, 3.5f);
+  n = fit_add_centroid(q, n, q->capstones[qr->caps[2]].stone, gs - 3.5f,
+                       3.5f);
+  n = fit_add_centroid(q, n, q->capstones[qr->caps[0]].stone, 3.5f,
+                       gs - 3.5f);
+
+  while (ap_count < QUIRC_MAX_ALIGNMENT && info->apat[ap_count])
+    ap_count++;
+
+  for (int i = 0; i < ap_count; i++)
+    for (int j = 0; j < ap_count; j++) {
+      /* Three corners are taken by the finder patterns */
+      if ((!i && !j) || (!i && j == ap_count - 1) ||
+          (i == ap_count - 1 && !j))
+        continue;
+      n = fit_add_apat(q, index, n, info->apat[i] + 0.5f,
+                       info->apat[j] + 0.5f, module_area);
+    }
+
+  for (int k = 8; k < qr->grid_size - 8; k += 2) {
+    n = fit_add_timing(q, index, n, k + 0.5f, 6.5f, 1);
+    n = fit_add_timing(q, index, n, 6.5f, k + 0.5f, 0);
+  }
+
+  return n;
+}
+
+/* Normal equations of the direction-projected residuals; returns the SSE */
+static float fit_normal_equations(const struct k_quirc *q, const float *c,
+                                  int n, float jtj[8][8], float jtr[8]) {
+  float sse = 0.0f;
+
+  memset(jtj, 0, sizeof(float) * 64);
+  memset(jtr, 0, sizeof(float) * 8);
+
+  for (int i = 0; i < n; i++) {
+    const struct quirc_fit_obs *o = &q->fit_obs[i];
+    float inv_den = 1.0f / (c[6] * o->u + c[7] * o->v + 1.0f);
+    float x = (c[0] * o->u + c[1] * o->v + c[2]) * inv_den;
+    float y = (c[3] * o->u + c[4] * o->v + c[5]) * inv_den;
+    float r = o->dx * (x - o->x) + o->dy * (y - o->y);
+    float w = -(o->dx * x + o->dy * y) * inv_den;
+    float j[8] = {o->dx * o->u * inv_den, o->dx * o->v * inv_den,
+                  o->dx * inv_den,        o->dy * o->u * inv_den,
+                  o->dy * o->v * inv_den, o->dy * inv_den,
+                  w * o->u,               w * o->v};
+
+    sse += r * r;
+    for (int a = 0; a < 8; a++) {
+      jtr[a] += j[a] * r;
+      for (int b = a; b < 8; b++)
+        jtj[a][b] += j[a] * j[b];
+    }
+  }
+
+  for (int a = 0; a < 8; a++)
+    for (int b = 0; b < a; b++)
+      jtj[a][b] = jtj[b][a];
+
+  return sse;
+}
+
+static void refine_perspective(struct k_quirc *q, int index) {
+  struct quirc_grid *qr = &q->grids[index];
+  float initial[QUIRC_PERSPECTIVE_PARAMS];
+  float jtj[8][8], jtr[8], delta[8];
+  float x0, y0, x1, y1, x2, y2;
+  float module_area, tolerance;
+  int changed = 0;
+
+  perspective_map_f(qr->c, 0.0f, 0.0f, &x0, &y0);
+  perspective_map_f(qr->c, 1.0f, 0.0f, &x1, &y1);
+  perspective_map_f(qr->c, 0.0f, 1.0f, &x2, &y2);
+  module_area = fabsf((x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0));
+  if (module_area < 1.0f)
+    return;
+  tolerance = FIT_CONSISTENT * FIT_CONSISTENT * module_area;
+
+  memcpy(initial, qr->c, sizeof(initial));
+
+  for (int pass = 0; pass < FIT_PASSES; pass++) {
+    int n = fit_collect(q, index, module_area);
+    float sse;
+
+    if (n < QUIRC_PERSPECTIVE_PARAMS + 4)
+      break;
+
+    sse = fit_normal_equations(q, qr->c, n, jtj, jtr);
+    if (sse < tolerance * n)
+      break;
+
+    for (int i = 0; i < 8; i++) {
+      jtj[i][i] *= 1.0f + FIT_DAMPING;
+      jtr[i] = -jtr[i];
+    }
+    solve_8x8_system(jtj, jtr, delta);
     for (int i = 0; i < 8; i++)
-      adjustments[i] *= 0.5f;
+      qr->c[i] += delta[i];
+    changed = 1;
+  }
+
+  /* Keep the refinement only if the grid scores at least as well */
+  if (changed) {
+    float refined[QUIRC_PERSPECTIVE_PARAMS];
+    int score = fitness_all(q, index);
+
+    memcpy(refined, qr->c, sizeof(refined));
+    memcpy(qr->c, initial, sizeof(initial));
+    if (score >= fitness_all(q, index))
+      memcpy(qr->c, refined, sizeof(refined));
   }
 }
 
 static void setup_qr_perspective(struct k_quirc *q, int index) {
   struct quirc_grid *qr = &q->grids[index];
   float gs = (float)qr->grid_size;
-
-  struct quirc_point *c0 = &q->capstones[qr->caps[0]].center;
-  struct quirc_point *c1 = &q->capstones[qr->caps[1]].center;
-  struct quirc_point *c2 = &q->capstones[qr->caps[2]].center;
-
-  float img[4][2] = {
-      {(float)c1->x, (float)c1->y},
-      {(float)c2->x, (float)c2->y},
-      {(float)qr->align.x, (float)qr->align.y},
-      {(float)c0->x, (float)c0->y}
-  };
+  float img[4][2];
+
+  /* Finder stone centroids rather than corner-derived centres */
+  region_centroid(&q->regions[q->capstones[qr->caps[1]].stone], &img[0][0],
+                  &img[0][1]);
+  region_centroid(&q->regions[q->capstones[qr->caps[2]].stone], &img[1][0],
+                  &img[1][1]);
+  region_centroid(&q->regions[q->capstones[qr->caps[0]].stone], &img[3][0],
+                  &img[3][1]);
+  if (qr->align_region >= 0) {
+    region_centroid(&q->regions[qr->align_region], &img[2][0], &img[2][1]);
+  } else {
+    img[2][0] = (float)qr->align.x;
+    img[2][1] = (float)qr->align.y;
+  }
 
   float mod[4][2] = {
       {3.5f, 3.5f},
@@ -885,14 +1279,73 @@ static void setup_qr_perspective(struct k_quirc *q, int index) {
   }
 
   perspective_setup_direct(qr->c, img, mod);
-  jiggle_perspective(q, index);
+  refine_perspective(q, index);
 #ifdef K_QUIRC_ADAPTIVE_THRESHOLD
   qr->timing_bias = timing_bias(q, index);
-  if (!processing_inverted)
+  /* The offset biases towards black, so only normal codes steer it */
+  if (qr->polarity == QUIRC_POLARITY_NORMAL)
     update_threshold_offset(qr->timing_bias);
 #endif
 }
 
+/* 18-bit version information: 6 version bits and a (18,6) BCH remainder */
+static uint32_t version_codeword(int version) {
+  uint32_t rem = (uint32_t)version;
+
+  for (int i = 0; i < 12; i++)
+    rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+  return ((uint32_t)version << 12) | rem;
+}
+
+/*
+ * Versions 7 and up carry their version beside the top-right and bottom-left
+ * finders. Finder spacing only pins the grid size to within a version or
+ * two on large codes, so each nearby version is tried with the module pitch
+ * it implies, and the copies are read in a frame centred on their own stone.
+ * Returns the best version within 3 bit errors, or 0.
+ */
+static int read_version_info(const struct k_quirc *q, int index) {
+  const struct quirc_grid *qr = &q->grids[index];
+  float stone[3][2];
+  int estimate = (qr->grid_size - 17) / 4;
+  int best = 0;
+  int best_dist = 4;
+
+  for (int version = estimate - 2; version <= estimate + 2; version++) {
+    if (version < 7 || version > QUIRC_MAX_VERSION)
+      continue;
+
+    const uint32_t code = version_codeword(version);
+    float u[2], v[2];
+    uint32_t tr = 0;
+    uint32_t bl = 0;
+
+    grid_axes(q, index, version * 4 + 17, stone, u, v);
+
+    /* Bit i sits at column i % 3, row i / 3 of the block left of the stone */
+    for (int i = 17; i >= 0; i--) {
+      float a = (float)(i % 3 - 7);
+      float b = (float)(i / 3 - 3);
+
+      tr = (tr << 1) |
+           (affine_cell(q, qr->polarity, stone[2], u, v, a, b) > 0);
+      bl = (bl << 1) |
+           (affine_cell(q, qr->polarity, stone[0], u, v, b, a) > 0);
+    }
+
+    int d_tr = __builtin_popcount(code ^ tr);
+    int d_bl = __builtin_popcount(code ^ bl);
+    int d = d_tr < d_bl ? d_tr : d_bl;
+
+    if (d < best_dist) {
+      best = version;
+      best_dist = d;
+    }
+  }
+
+  return best;
+}
+
 static float length(struct quirc_point a, struct quirc_point b) {
   float dx = (float)(abs(a.x - b.x) + 1);
   float dy = (float)(abs(a.y - b.y) + 1);
@@ -946,6 +1399,26 @@ static void rotate_capstone(struct quirc_capstone *cap,
   perspective_setup(cap->c, cap->corners, 7.0f, 7.0f);
 }
 
+/*
+ * Alignment pattern estimate that ignores perspective: complete the
+ * parallelogram of the stone centroids, then step back three modules
+ * towards the top-left stone. Intersecting capstone edges handles tilt, but
+ * on large grids turns a pixel of corner noise into modules of error.
+ */
+static void align_estimate(const struct k_quirc *q, int index,
+                           struct quirc_point *out) {
+  const struct quirc_grid *qr = &q->grids[index];
+  float x[3], y[3];
+
+  for (int i = 0; i < 3; i++)
+    region_centroid(&q->regions[q->capstones[qr->caps[i]].stone], &x[i],
+                    &y[i]);
+
+  const float scale = (qr->grid_size - 10.0f) / (qr->grid_size - 7.0f);
+  out->x = (int)(x[1] + (x[0] + x[2] - 2.0f * x[1]) * scale + 0.5f);
+  out->y = (int)(y[1] + (y[0] + y[2] - 2.0f * y[1]) * scale + 0.5f);
+}
+
 static void record_qr_grid(struct k_quirc *q, int a, int b, int c) {
   struct quirc_point h0, hd;
   struct quirc_grid *qr;
@@ -973,6 +1446,7 @@ static void record_qr_grid(struct k_quirc *q, int a, int b, int c) {
   qr->caps[1] = b;
   qr->caps[2] = c;
   qr->align_region = -1;
+  qr->polarity = q->capstones[a].polarity;
 
   for (int i = 0; i < 3; i++) {
     struct quirc_capstone *cap = &q->capstones[qr->caps[i]];
@@ -982,6 +1456,14 @@ static void record_qr_grid(struct k_quirc *q, int a, int b, int c) {
 
   measure_grid_size(q, q->num_grids);
 
+  /* Finder spacing drifts by a version or more on large grids */
+  if (qr->grid_size >= 45) {
+    int version = read_version_info(q, q->num_grids);
+
+    if (version)
+      qr->grid_size = version * 4 + 17;
+  }
+
   if (qr->grid_size < 21)
     return;
 
@@ -994,6 +1476,14 @@ static void record_qr_grid(struct k_quirc *q, int a, int b, int c) {
 
   if (qr->grid_size > 21) {
     find_alignment_pattern(q, q->num_grids);
+    if (qr->align_region < 0 && qr->grid_size >= 45) {
+      struct quirc_point edges = qr->align;
+
+      align_estimate(q, q->num_grids, &qr->align);
+      find_alignment_pattern(q, q->num_grids);
+      if (qr->align_region < 0)
+        qr->align = edges;
+    }
     if (qr->align_region >= 0)
       memcpy(&qr->align, &q->regions[qr->align_region].seed, sizeof(qr->align));
   }
@@ -1003,6 +1493,7 @@ static void record_qr_grid(struct k_quirc *q, int a, int b, int c) {
       q->capstones[a].center.y + (q->capstones[a].center.y - qr->align.y);
 
   setup_qr_perspective(q, q->num_grids);
+
   q->num_grids++;
 }
 
@@ -1030,6 +1521,33 @@ static void test_neighbours(struct k_quirc *q, int i,
   }
 }
 
+/*
+ * Where a point lies in a capstone's module grid, from the affine part of
+ * its corners only. A full perspective from a 7-module square magnifies a
+ * pixel of corner error into modules of error at the far end of a large code.
+ */
+static void capstone_unmap_affine(const struct quirc_capstone *cap,
+                                  const struct quirc_point *p, float *u,
+                                  float *v) {
+  const struct quirc_point *k = cap->corners;
+  float ux = ((k[1].x - k[0].x) + (k[2].x - k[3].x)) / 14.0f;
+  float uy = ((k[1].y - k[0].y) + (k[2].y - k[3].y)) / 14.0f;
+  float vx = ((k[3].x - k[0].x) + (k[2].x - k[1].x)) / 14.0f;
+  float vy = ((k[3].y - k[0].y) + (k[2].y - k[1].y)) / 14.0f;
+  float dx = p->x - (k[0].x + k[1].x + k[2].x + k[3].x) * 0.25f;
+  float dy = p->y - (k[0].y + k[1].y + k[2].y + k[3].y) * 0.25f;
+  float det = ux * vy - uy * vx;
+
+  if (fabsf(det) < 1e-6f) {
+    *u = 0.0f;
+    *v = 0.0f;
+    return;
+  }
+
+  *u = 3.5f + (dx * vy - dy * vx) / det;
+  *v = 3.5f + (ux * dy - uy * dx) / det;
+}
+
 static void test_grouping(struct k_quirc *q, int i) {
   struct quirc_capstone *c1 = &q->capstones[i];
   struct neighbour_list hlist, vlist;
@@ -1050,10 +1568,10 @@ static void test_grouping(struct k_quirc *q, int i) {
     if (i == j)
       continue;
 
-    if (c2->qr_grid >= 0)
+    if (c2->qr_grid >= 0 || c2->polarity != c1->polarity)
       continue;
 
-    perspective_unmap(c1->c, &c2->center, &u, &v);
+    capstone_unmap_affine(c1, &c2->center, &u, &v);
 
     u = fabsf(u - 3.5f);
     v = fabsf(v - 3.5f);
@@ -1089,40 +1607,21 @@ static void pixels_setup(struct k_quirc *q) {
 
 /*
  * Public identification function
+ *
+ * Thresholds once, then a single finder scan collects capstones of both
+ * polarities when find_inverted is set; grouping only pairs capstones of the
+ * same polarity.
  */
 void k_quirc_identify(struct k_quirc *q, bool find_inverted) {
-#ifdef K_QUIRC_ADAPTIVE_THRESHOLD
-  processing_inverted = false;
-#endif
   pixels_setup(q);
   threshold(q, false);
 
+  q->ink[QUIRC_PIXEL_WHITE] = 1 << QUIRC_POLARITY_INVERTED;
+  q->ink[QUIRC_PIXEL_BLACK] = 1 << QUIRC_POLARITY_NORMAL;
+
   for (int i = 0; i < q->h; i++)
-    finder_scan(q, i);
+    finder_scan(q, i, find_inverted);
 
   for (int i = 0; i < q->num_capstones; i++)
     test_grouping(q, i);
-
-  if (q->num_grids == 0 && find_inverted) {
-    vTaskDelay(1);
-#ifdef K_QUIRC_ADAPTIVE_THRESHOLD
-    processing_inverted = true;
-#endif
-    q->num_regions = QUIRC_PIXEL_REGION;
-    q->num_capstones = 0;
-    q->num_grids = 0;
-
-    /* Invert thresholded buffer (region codes were BLACK, so invert to WHITE) */
-    int total_pixels = q->w * q->h;
-    for (int i = 0; i < total_pixels; i++) {
-      q->pixels[i] = (q->pixels[i] == QUIRC_PIXEL_WHITE)
-                         ? QUIRC_PIXEL_BLACK
-                         : QUIRC_PIXEL_WHITE;
-    }
-    for (int i = 0; i < q->h; i++)
-      finder_scan(q, i);
-
-    for (int i = 0; i < q->num_capstones; i++)
-      test_grouping(q, i);
-  }
 }
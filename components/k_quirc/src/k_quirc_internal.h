@@ -42,6 +42,10 @@
 #define QUIRC_PIXEL_BLACK 1
 #define QUIRC_PIXEL_REGION 2
 
+/* Finder polarity: dark modules on light (normal) or light on dark */
+#define QUIRC_POLARITY_NORMAL 0
+#define QUIRC_POLARITY_INVERTED 1
+
 #ifndef QUIRC_MAX_REGIONS
 #define QUIRC_MAX_REGIONS 254
 #endif
@@ -49,9 +53,10 @@
 #define QUIRC_MAX_CAPSTONES 32
 #define QUIRC_MAX_GRIDS 8
 #define QUIRC_PERSPECTIVE_PARAMS 8
-#define QUIRC_MAX_VERSION 24
+#define QUIRC_MAX_VERSION K_QUIRC_MAX_VERSION
 #define QUIRC_MAX_ALIGNMENT 7
 #define QUIRC_FLOOD_FILL_STACK 8192
+#define QUIRC_MAX_FIT_OBS 260 /* Version 40: finders, alignment, timing */
 
 #if QUIRC_MAX_REGIONS < UINT8_MAX
 typedef uint8_t quirc_pixel_t;
@@ -72,7 +77,11 @@ struct quirc_point {
 struct quirc_region {
   struct quirc_point seed;
   int count;
+  /* Pixel coordinate sums, for the centroid */
+  uint32_t sum_x;
+  uint32_t sum_y;
   int capstone;
+  int polarity;
 };
 
 struct quirc_capstone {
@@ -82,6 +91,7 @@ struct quirc_capstone {
   struct quirc_point center;
   float c[QUIRC_PERSPECTIVE_PARAMS];
   int qr_grid;
+  int polarity;
 };
 
 struct quirc_grid {
@@ -94,12 +104,21 @@ struct quirc_grid {
   int grid_size;
   float c[QUIRC_PERSPECTIVE_PARAMS];
   int timing_bias;
+  int polarity;
+};
+
+/* Measured feature for perspective refinement: module (u, v) was seen at
+ * image (x, y), along direction (dx, dy) */
+struct quirc_fit_obs {
+  float u, v;
+  float x, y;
+  float dx, dy;
 };
 
 struct quirc_code {
   struct quirc_point corners[4];
   int size;
-  uint8_t cell_bitmap[K_QUIRC_MAX_BITMAP];
+  uint8_t *cell_bitmap;
 };
 
 struct quirc_data {
@@ -107,11 +126,28 @@ struct quirc_data {
   int ecc_level;
   int mask;
   int data_type;
-  uint8_t payload[K_QUIRC_MAX_PAYLOAD];
+  uint8_t *payload;
+  int payload_cap;
   int payload_len;
   uint32_t eci;
 };
 
+/*
+ * Decode scratch: cell and reserved-module bitmaps, raw and corrected
+ * codewords, and the payload. One allocation, regrown only when a grid of a
+ * larger version than any before is decoded.
+ */
+struct quirc_decode_buf {
+  uint8_t *mem;
+  int version;
+  uint8_t *cell_bitmap;
+  uint8_t *reserved;
+  uint8_t *raw;
+  uint8_t *data;
+  uint8_t *payload;
+  int payload_cap;
+};
+
 struct k_quirc {
   uint8_t *image;
   quirc_pixel_t *pixels;
@@ -120,10 +156,15 @@ struct k_quirc {
   int h;
   int num_regions;
   struct quirc_region regions[QUIRC_MAX_REGIONS];
+  /* Per pixel value: bit 0 set if it is a module of a normal code, bit 1 if
+   * of an inverted one. Region labels inherit their region's polarity. */
+  uint8_t ink[QUIRC_MAX_REGIONS];
   int num_capstones;
   struct quirc_capstone capstones[QUIRC_MAX_CAPSTONES];
   int num_grids;
   struct quirc_grid grids[QUIRC_MAX_GRIDS];
+  struct quirc_fit_obs fit_obs[QUIRC_MAX_FIT_OBS];
+  struct quirc_decode_buf decode_buf;
 };
 
 /*
@@ -160,6 +201,12 @@ ALWAYS_INLINE void perspective_map(const float *c, float u, float v,
   ret->y = fast_roundf(y);
 }
 
+/* True if a thresholded/labelled pixel is a dark module for this polarity */
+ALWAYS_INLINE int quirc_pixel_is_ink(const struct k_quirc *q,
+                                     quirc_pixel_t pixel, int polarity) {
+  return (q->ink[pixel] >> polarity) & 1;
+}
+
 /*
  * Identification module functions (k_quirc_identify.c)
  */
@@ -169,9 +216,12 @@ int k_quirc_get_threshold_offset(void);
 /*
  * Decode module functions (k_quirc_decode.c)
  */
+int quirc_decode_buf_reserve(struct quirc_decode_buf *buf, int version);
+void quirc_decode_buf_free(struct quirc_decode_buf *buf);
 void quirc_extract_internal(const struct k_quirc *q, int index,
                             struct quirc_code *code);
 k_quirc_error_t quirc_decode_internal(const struct quirc_code *code,
-                                      struct quirc_data *data);
+                                      struct quirc_data *data,
+                                      const struct quirc_decode_buf *buf);
 
 #endif /* K_QUIRC_INTERNAL_H */
@@ -0,0 +1,306 @@
+/*
+ * K-Quirc Reed-Solomon
+ * Table-driven GF(256) kernels for QR data blocks
+ *
+ * Original Copyright (C) 2010-2012 Daniel Beer <dlbeer@gmail.com>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for
+ * details.
+ */
+
+#include "k_quirc_rs.h"
+#include "k_quirc_internal.h"
+
+/*
+ * alpha^i for i in 0..511. The table repeats with period 255, so the sum of
+ * two logs indexes it directly, without a modulo.
+ */
+static const uint8_t gf256_exp[512] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d, 0x3a, 0x74, 0xe8,
+    0xcd, 0x87, 0x13, 0x26, 0x4c, 0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9,
+    0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x9d, 0x27, 0x4e, 0x9c,
+    0x25, 0x4a, 0x94, 0x35, 0x6a, 0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23,
+    0x46, 0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d, 0xba, 0x69, 0xd2,
+    0xb9, 0x6f, 0xde, 0xa1, 0x5f, 0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc,
+    0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xfd, 0xe7, 0xd3, 0xbb,
+    0x6b, 0xd6, 0xb1, 0x7f, 0xfe, 0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2,
+    0xd9, 0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d, 0x1a, 0x34, 0x68,
+    0xd0, 0xbd, 0x67, 0xce, 0x81, 0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93,
+    0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc, 0x85, 0x17, 0x2e, 0x5c,
+    0xb8, 0x6d, 0xda, 0xa9, 0x4f, 0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54,
+    0xa8, 0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49, 0x92, 0x39, 0x72,
+    0xe4, 0xd5, 0xb7, 0x73, 0xe6, 0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e,
+    0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff, 0xe3, 0xdb, 0xab, 0x4b,
+    0x96, 0x31, 0x62, 0xc4, 0x95, 0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41,
+    0x82, 0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0,
+    0xdd, 0xa7, 0x53, 0xa6, 0x51, 0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef,
+    0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09, 0x12, 0x24, 0x48, 0x90,
+    0x3d, 0x7a, 0xf4, 0xf5, 0xf7, 0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16,
+    0x2c, 0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b, 0x36, 0x6c, 0xd8,
+    0xad, 0x47, 0x8e, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d,
+    0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13, 0x26, 0x4c, 0x98, 0x2d, 0x5a, 0xb4,
+    0x75, 0xea, 0xc9, 0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x9d,
+    0x27, 0x4e, 0x9c, 0x25, 0x4a, 0x94, 0x35, 0x6a, 0xd4, 0xb5, 0x77, 0xee,
+    0xc1, 0x9f, 0x23, 0x46, 0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d,
+    0xba, 0x69, 0xd2, 0xb9, 0x6f, 0xde, 0xa1, 0x5f, 0xbe, 0x61, 0xc2, 0x99,
+    0x2f, 0x5e, 0xbc, 0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xfd,
+    0xe7, 0xd3, 0xbb, 0x6b, 0xd6, 0xb1, 0x7f, 0xfe, 0xe1, 0xdf, 0xa3, 0x5b,
+    0xb6, 0x71, 0xe2, 0xd9, 0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d,
+    0x1a, 0x34, 0x68, 0xd0, 0xbd, 0x67, 0xce, 0x81, 0x1f, 0x3e, 0x7c, 0xf8,
+    0xed, 0xc7, 0x93, 0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc, 0x85,
+    0x17, 0x2e, 0x5c, 0xb8, 0x6d, 0xda, 0xa9, 0x4f, 0x9e, 0x21, 0x42, 0x84,
+    0x15, 0x2a, 0x54, 0xa8, 0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49,
+    0x92, 0x39, 0x72, 0xe4, 0xd5, 0xb7, 0x73, 0xe6, 0xd1, 0xbf, 0x63, 0xc6,
+    0x91, 0x3f, 0x7e, 0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff, 0xe3,
+    0xdb, 0xab, 0x4b, 0x96, 0x31, 0x62, 0xc4, 0x95, 0x37, 0x6e, 0xdc, 0xa5,
+    0x57, 0xae, 0x41, 0x82, 0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c,
+    0x38, 0x70, 0xe0, 0xdd, 0xa7, 0x53, 0xa6, 0x51, 0xa2, 0x59, 0xb2, 0x79,
+    0xf2, 0xf9, 0xef, 0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09, 0x12,
+    0x24, 0x48, 0x90, 0x3d, 0x7a, 0xf4, 0xf5, 0xf7, 0xf3, 0xfb, 0xeb, 0xcb,
+    0x8b, 0x0b, 0x16, 0x2c, 0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b,
+    0x36, 0x6c, 0xd8, 0xad, 0x47, 0x8e, 0x01, 0x02};
+
+static const uint8_t gf256_log[256] = {
+    0x00, 0xff, 0x01, 0x19, 0x02, 0x32, 0x1a, 0xc6, 0x03, 0xdf, 0x33, 0xee,
+    0x1b, 0x68, 0xc7, 0x4b, 0x04, 0x64, 0xe0, 0x0e, 0x34, 0x8d, 0xef, 0x81,
+    0x1c, 0xc1, 0x69, 0xf8, 0xc8, 0x08, 0x4c, 0x71, 0x05, 0x8a, 0x65, 0x2f,
+    0xe1, 0x24, 0x0f, 0x21, 0x35, 0x93, 0x8e, 0xda, 0xf0, 0x12, 0x82, 0x45,
+    0x1d, 0xb5, 0xc2, 0x7d, 0x6a, 0x27, 0xf9, 0xb9, 0xc9, 0x9a, 0x09, 0x78,
+    0x4d, 0xe4, 0x72, 0xa6, 0x06, 0xbf, 0x8b, 0x62, 0x66, 0xdd, 0x30, 0xfd,
+    0xe2, 0x98, 0x25, 0xb3, 0x10, 0x91, 0x22, 0x88, 0x36, 0xd0, 0x94, 0xce,
+    0x8f, 0x96, 0xdb, 0xbd, 0xf1, 0xd2, 0x13, 0x5c, 0x83, 0x38, 0x46, 0x40,
+    0x1e, 0x42, 0xb6, 0xa3, 0xc3, 0x48, 0x7e, 0x6e, 0x6b, 0x3a, 0x28, 0x54,
+    0xfa, 0x85, 0xba, 0x3d, 0xca, 0x5e, 0x9b, 0x9f, 0x0a, 0x15, 0x79, 0x2b,
+    0x4e, 0xd4, 0xe5, 0xac, 0x73, 0xf3, 0xa7, 0x57, 0x07, 0x70, 0xc0, 0xf7,
+    0x8c, 0x80, 0x63, 0x0d, 0x67, 0x4a, 0xde, 0xed, 0x31, 0xc5, 0xfe, 0x18,
+    0xe3, 0xa5, 0x99, 0x77, 0x26, 0xb8, 0xb4, 0x7c, 0x11, 0x44, 0x92, 0xd9,
+    0x23, 0x20, 0x89, 0x2e, 0x37, 0x3f, 0xd1, 0x5b, 0x95, 0xbc, 0xcf, 0xcd,
+    0x90, 0x87, 0x97, 0xb2, 0xdc, 0xfc, 0xbe, 0x61, 0xf2, 0x56, 0xd3, 0xab,
+    0x14, 0x2a, 0x5d, 0x9e, 0x84, 0x3c, 0x39, 0x53, 0x47, 0x6d, 0x41, 0xa2,
+    0x1f, 0x2d, 0x43, 0xd8, 0xb7, 0x7b, 0xa4, 0x76, 0xc4, 0x17, 0x49, 0xec,
+    0x7f, 0x0c, 0x6f, 0xf6, 0x6c, 0xa1, 0x3b, 0x52, 0x29, 0x9d, 0x55, 0xaa,
+    0xfb, 0x60, 0x86, 0xb1, 0xbb, 0xcc, 0x3e, 0x5a, 0xcb, 0x59, 0x5f, 0xb0,
+    0x9c, 0xa9, 0xa0, 0x51, 0x0b, 0xf5, 0x16, 0xeb, 0x7a, 0x75, 0x2c, 0xd7,
+    0x4f, 0xae, 0xd5, 0xe9, 0xe6, 0xe7, 0xad, 0xe8, 0x74, 0xd6, 0xf4, 0xea,
+    0xa8, 0x50, 0x58, 0xaf};
+
+/*
+ * mul_alpha[i][x] = x * alpha^i for each generator power. A syndrome is
+ * evaluated by Horner's rule, one lookup per codeword. Built on first use.
+ */
+static uint8_t mul_alpha[K_QUIRC_RS_MAX_ECC][256];
+static volatile bool mul_alpha_ready;
+
+static void mul_alpha_init(void) {
+  if (mul_alpha_ready)
+    return;
+
+  for (int i = 0; i < K_QUIRC_RS_MAX_ECC; i++) {
+    mul_alpha[i][0] = 0;
+    for (int x = 1; x < 256; x++)
+      mul_alpha[i][x] = gf256_exp[gf256_log[x] + i];
+  }
+  mul_alpha_ready = true;
+}
+
+static inline uint8_t gf_mul(uint8_t a, uint8_t b) {
+  if (!a || !b)
+    return 0;
+  return gf256_exp[gf256_log[a] + gf256_log[b]];
+}
+
+static inline uint8_t gf_div(uint8_t a, uint8_t b) {
+  if (!a)
+    return 0;
+  return gf256_exp[gf256_log[a] + 255 - gf256_log[b]];
+}
+
+void k_quirc_rs_encode(const uint8_t *data, int data_len, int ecc_len,
+                       uint8_t *ecc) {
+  uint8_t gen[K_QUIRC_RS_MAX_ECC + 1];
+
+  if (ecc_len < 1 || ecc_len > K_QUIRC_RS_MAX_ECC)
+    return;
+
+  /* Generator (x - alpha^0)...(x - alpha^(n-1)), monic, highest first */
+  memset(gen, 0, sizeof(gen));
+  gen[0] = 1;
+  for (int i = 0; i < ecc_len; i++)
+    for (int j = i + 1; j > 0; j--)
+      gen[j] ^= gf_mul(gen[j - 1], gf256_exp[i]);
+
+  memset(ecc, 0, ecc_len);
+  for (int i = 0; i < data_len; i++) {
+    uint8_t factor = data[i] ^ ecc[0];
+
+    memmove(ecc, ecc + 1, ecc_len - 1);
+    ecc[ecc_len - 1] = 0;
+    if (!factor)
+      continue;
+
+    const int log_f = gf256_log[factor];
+    for (int j = 0; j < ecc_len; j++)
+      if (gen[j + 1])
+        ecc[j] ^= gf256_exp[gf256_log[gen[j + 1]] + log_f];
+  }
+}
+
+HOT_FUNC
+int k_quirc_rs_syndromes(const uint8_t *block, int len, int ecc_len,
+                         uint8_t *s) {
+  uint8_t acc[K_QUIRC_RS_MAX_ECC];
+  uint8_t nonzero = 0;
+
+  if (ecc_len < 1 || ecc_len > K_QUIRC_RS_MAX_ECC)
+    return 0;
+
+  mul_alpha_init();
+  memset(acc, 0, sizeof(acc));
+
+  /* Codeword-major, so each byte is loaded once for every syndrome */
+  for (int j = 0; j < len; j++) {
+    const uint8_t c = block[j];
+
+    for (int i = 0; i < ecc_len; i++)
+      acc[i] = mul_alpha[i][acc[i]] ^ c;
+  }
+
+  for (int i = 0; i < ecc_len; i++) {
+    s[i] = acc[i];
+    nonzero |= acc[i];
+  }
+
+  return nonzero != 0;
+}
+
+/* Error locator of the syndromes; returns its degree */
+static int berlekamp_massey(const uint8_t *s, int n, uint8_t *sigma) {
+  uint8_t b_poly[K_QUIRC_RS_MAX_ECC + 1];
+  uint8_t t_poly[K_QUIRC_RS_MAX_ECC + 1];
+  int l = 0;
+  int m = 1;
+  uint8_t b = 1;
+
+  memset(sigma, 0, K_QUIRC_RS_MAX_ECC + 1);
+  memset(b_poly, 0, sizeof(b_poly));
+  sigma[0] = 1;
+  b_poly[0] = 1;
+
+  for (int k = 0; k < n; k++) {
+    uint8_t d = s[k];
+
+    for (int i = 1; i <= l; i++)
+      d ^= gf_mul(sigma[i], s[k - i]);
+
+    if (!d) {
+      m++;
+      continue;
+    }
+
+    const int log_mult = gf256_log[d] + 255 - gf256_log[b];
+    const bool grow = l * 2 <= k;
+
+    if (grow)
+      memcpy(t_poly, sigma, sizeof(t_poly));
+
+    for (int i = 0; i + m <= n && i + m <= K_QUIRC_RS_MAX_ECC; i++)
+      if (b_poly[i])
+        sigma[i + m] ^= gf256_exp[gf256_log[b_poly[i]] + log_mult % 255];
+
+    if (grow) {
+      memcpy(b_poly, t_poly, sizeof(b_poly));
+      l = k + 1 - l;
+      b = d;
+      m = 1;
+    } else {
+      m++;
+    }
+  }
+
+  return l;
+}
+
+HOT_FUNC
+k_quirc_error_t k_quirc_rs_correct(uint8_t *block, int len, int ecc_len,
+                                   int *corrected) {
+  uint8_t s[K_QUIRC_RS_MAX_ECC];
+  uint8_t sigma[K_QUIRC_RS_MAX_ECC + 1];
+  uint8_t omega[K_QUIRC_RS_MAX_ECC];
+  int root_log[K_QUIRC_RS_MAX_ECC];
+  int term_log[K_QUIRC_RS_MAX_ECC + 1];
+  int roots = 0;
+
+  if (corrected)
+    *corrected = 0;
+
+  if (len > K_QUIRC_RS_MAX_BLOCK || ecc_len >= len)
+    return K_QUIRC_ERROR_DATA_ECC;
+
+  if (!k_quirc_rs_syndromes(block, len, ecc_len, s))
+    return K_QUIRC_SUCCESS;
+
+  const int l = berlekamp_massey(s, ecc_len, sigma);
+  if (l * 2 > ecc_len)
+    return K_QUIRC_ERROR_DATA_ECC;
+
+  /*
+   * Chien search over the block's own positions only: position p (from the
+   * end) is an error where sigma(alpha^-p) = 0. Each term's log steps down
+   * by its degree per position instead of being recomputed.
+   */
+  for (int k = 0; k <= l; k++)
+    term_log[k] = sigma[k] ? gf256_log[sigma[k]] : -1;
+
+  for (int p = 0; p < len && roots < l; p++) {
+    uint8_t sum = 0;
+
+    for (int k = 0; k <= l; k++) {
+      if (term_log[k] < 0)
+        continue;
+      sum ^= gf256_exp[term_log[k]];
+      term_log[k] -= k;
+      if (term_log[k] < 0)
+        term_log[k] += 255;
+    }
+
+    if (!sum)
+      root_log[roots++] = p;
+  }
+
+  /* Fewer roots than the degree: the errors are not inside the block */
+  if (roots != l)
+    return K_QUIRC_ERROR_DATA_ECC;
+
+  /* Error evaluator omega = s * sigma mod x^ecc_len */
+  memset(omega, 0, sizeof(omega));
+  for (int i = 0; i < ecc_len; i++)
+    for (int k = 0; k <= l && k <= i; k++)
+      omega[i] ^= gf_mul(sigma[k], s[i - k]);
+
+  /* Forney, with generator roots starting at alpha^0: e = X omega / sigma' */
+  for (int r = 0; r < roots; r++) {
+    const int p = root_log[r];
+    const int inv = (255 - p) % 255;
+    uint8_t num = 0;
+    uint8_t den = 0;
+
+    for (int i = 0; i < ecc_len; i++)
+      if (omega[i])
+        num ^= gf256_exp[gf256_log[omega[i]] + (inv * i) % 255];
+    for (int k = 1; k <= l; k += 2)
+      if (sigma[k])
+        den ^= gf256_exp[gf256_log[sigma[k]] + (inv * (k - 1)) % 255];
+
+    if (!den)
+      return K_QUIRC_ERROR_DATA_ECC;
+
+    block[len - 1 - p] ^= gf_mul(gf_div(num, den), gf256_exp[p]);
+  }
+
+  if (k_quirc_rs_syndromes(block, len, ecc_len, s))
+    return K_QUIRC_ERROR_DATA_ECC;
+
+  if (corrected)
+    *corrected = roots;
+  return K_QUIRC_SUCCESS;
+}
@@ -1,6 +1,6 @@
 /*
  * K-Quirc Version Database
- * QR-code version information for versions 1-24
+ * QR-code version information for versions 1-40
  */
 
 #include "k_quirc_internal.h"
@@ -175,4 +175,116 @@ const struct quirc_version_info quirc_version_db[QUIRC_MAX_VERSION + 1] = {
              {.bs = 147, .dw = 117, .ns = 6},
              {.bs = 46, .dw = 16, .ns = 30},
              {.bs = 54, .dw = 24, .ns = 11}}},
+    {/* Version 25 */
+     .data_bytes = 1588,
+     .apat = {6, 32, 58, 84, 110, 0},
+     .ecc = {{.bs = 75, .dw = 47, .ns = 8},
+             {.bs = 132, .dw = 106, .ns = 8},
+             {.bs = 45, .dw = 15, .ns = 22},
+             {.bs = 54, .dw = 24, .ns = 7}}},
+    {/* Version 26 */
+     .data_bytes = 1706,
+     .apat = {6, 30, 58, 86, 114, 0},
+     .ecc = {{.bs = 74, .dw = 46, .ns = 19},
+             {.bs = 142, .dw = 114, .ns = 10},
+             {.bs = 46, .dw = 16, .ns = 33},
+             {.bs = 50, .dw = 22, .ns = 28}}},
+    {/* Version 27 */
+     .data_bytes = 1828,
+     .apat = {6, 34, 62, 90, 118, 0},
+     .ecc = {{.bs = 73, .dw = 45, .ns = 22},
+             {.bs = 152, .dw = 122, .ns = 8},
+             {.bs = 45, .dw = 15, .ns = 12},
+             {.bs = 53, .dw = 23, .ns = 8}}},
+    {/* Version 28 */
+     .data_bytes = 1921,
+     .apat = {6, 26, 50, 74, 98, 122, 0},
+     .ecc = {{.bs = 73, .dw = 45, .ns = 3},
+             {.bs = 147, .dw = 117, .ns = 3},
+             {.bs = 45, .dw = 15, .ns = 11},
+             {.bs = 54, .dw = 24, .ns = 4}}},
+    {/* Version 29 */
+     .data_bytes = 2051,
+     .apat = {6, 30, 54, 78, 102, 126, 0},
+     .ecc = {{.bs = 73, .dw = 45, .ns = 21},
+             {.bs = 146, .dw = 116, .ns = 7},
+             {.bs = 45, .dw = 15, .ns = 19},
+             {.bs = 53, .dw = 23, .ns = 1}}},
+    {/* Version 30 */
+     .data_bytes = 2185,
+     .apat = {6, 26, 52, 78, 104, 130, 0},
+     .ecc = {{.bs = 75, .dw = 47, .ns = 19},
+             {.bs = 145, .dw = 115, .ns = 5},
+             {.bs = 45, .dw = 15, .ns = 23},
+             {.bs = 54, .dw = 24, .ns = 15}}},
+    {/* Version 31 */
+     .data_bytes = 2323,
+     .apat = {6, 30, 56, 82, 108, 134, 0},
+     .ecc = {{.bs = 74, .dw = 46, .ns = 2},
+             {.bs = 145, .dw = 115, .ns = 13},
+             {.bs = 45, .dw = 15, .ns = 23},
+             {.bs = 54, .dw = 24, .ns = 42}}},
+    {/* Version 32 */
+     .data_bytes = 2465,
+     .apat = {6, 34, 60, 86, 112, 138, 0},
+     .ecc = {{.bs = 74, .dw = 46, .ns = 10},
+             {.bs = 145, .dw = 115, .ns = 17},
+             {.bs = 45, .dw = 15, .ns = 19},
+             {.bs = 54, .dw = 24, .ns = 10}}},
+    {/* Version 33 */
+     .data_bytes = 2611,
+     .apat = {6, 30, 58, 86, 114, 142, 0},
+     .ecc = {{.bs = 74, .dw = 46, .ns = 14},
+             {.bs = 145, .dw = 115, .ns = 17},
+             {.bs = 45, .dw = 15, .ns = 11},
+             {.bs = 54, .dw = 24, .ns = 29}}},
+    {/* Version 34 */
+     .data_bytes = 2761,
+     .apat = {6, 34, 62, 90, 118, 146, 0},
+     .ecc = {{.bs = 74, .dw = 46, .ns = 14},
+             {.bs = 145, .dw = 115, .ns = 13},
+             {.bs = 46, .dw = 16, .ns = 59},
+             {.bs = 54, .dw = 24, .ns = 44}}},
+    {/* Version 35 */
+     .data_bytes = 2876,
+     .apat = {6, 30, 54, 78, 102, 126, 150},
+     .ecc = {{.bs = 75, .dw = 47, .ns = 12},
+             {.bs = 151, .dw = 121, .ns = 12},
+             {.bs = 45, .dw = 15, .ns = 22},
+             {.bs = 54, .dw = 24, .ns = 39}}},
+    {/* Version 36 */
+     .data_bytes = 3034,
+     .apat = {6, 24, 50, 76, 102, 128, 154},
+     .ecc = {{.bs = 75, .dw = 47, .ns = 6},
+             {.bs = 151, .dw = 121, .ns = 6},
+             {.bs = 45, .dw = 15, .ns = 2},
+             {.bs = 54, .dw = 24, .ns = 46}}},
+    {/* Version 37 */
+     .data_bytes = 3196,
+     .apat = {6, 28, 54, 80, 106, 132, 158},
+     .ecc = {{.bs = 74, .dw = 46, .ns = 29},
+             {.bs = 152, .dw = 122, .ns = 17},
+             {.bs = 45, .dw = 15, .ns = 24},
+             {.bs = 54, .dw = 24, .ns = 49}}},
+    {/* Version 38 */
+     .data_bytes = 3362,
+     .apat = {6, 32, 58, 84, 110, 136, 162},
+     .ecc = {{.bs = 74, .dw = 46, .ns = 13},
+             {.bs = 152, .dw = 122, .ns = 4},
+             {.bs = 45, .dw = 15, .ns = 42},
+             {.bs = 54, .dw = 24, .ns = 48}}},
+    {/* Version 39 */
+     .data_bytes = 3532,
+     .apat = {6, 26, 54, 82, 110, 138, 166},
+     .ecc = {{.bs = 75, .dw = 47, .ns = 40},
+             {.bs = 147, .dw = 117, .ns = 20},
+             {.bs = 45, .dw = 15, .ns = 10},
+             {.bs = 54, .dw = 24, .ns = 43}}},
+    {/* Version 40 */
+     .data_bytes = 3706,
+     .apat = {6, 30, 58, 86, 114, 142, 170},
+     .ecc = {{.bs = 75, .dw = 47, .ns = 18},
+             {.bs = 148, .dw = 118, .ns = 19},
+             {.bs = 45, .dw = 15, .ns = 20},
+             {.bs = 54, .dw = 24, .ns = 34}}},
 };
@@ -0,0 +1,310 @@
+/*
+ * Minimal QR encoder for host tests (ISO/IEC 18004 structure; block layout
+ * and placement follow the well-known reference encoders).
+ */
+
+#include "qr_test_encoder.h"
+#include <stdlib.h>
+#include <string.h>
+
+// clang-format off
+static const int8_t ecc_per_block[2][41] = {
+  {-1,  7, 10, 15, 20, 26, 18, 20, 24, 30, 18, 20, 24, 26, 30, 22, 24, 28, 30, 28, 28,
+       28, 28, 30, 30, 26, 28, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+  {-1, 10, 16, 26, 18, 24, 16, 18, 22, 22, 26, 30, 22, 22, 24, 24, 28, 28, 26, 26, 26,
+       26, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28},
+};
+
+static const int8_t ecc_blocks[2][41] = {
+  {-1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 4, 4, 4, 4, 4, 6, 6, 6, 6, 7, 8,
+       8, 9, 9, 10, 12, 12, 12, 13, 14, 15, 16, 17, 18, 19, 19, 20, 21, 22, 24, 25},
+  {-1, 1, 1, 1, 2, 2, 4, 4, 4, 5, 5, 5, 8, 9, 9, 10, 10, 11, 13, 14, 16,
+       17, 17, 18, 20, 21, 23, 25, 26, 28, 29, 31, 33, 35, 37, 38, 40, 43, 45, 47, 49},
+};
+// clang-format on
+
+/* Format-info ECC indicator bits for L and M */
+static const int ecc_format_bits[2] = {1, 0};
+
+static uint8_t gf_mul(uint8_t x, uint8_t y) {
+  int z = 0;
+  for (int i = 7; i >= 0; i--) {
+    z = (z << 1) ^ ((z >> 7) * 0x11D);
+    z ^= ((y >> i) & 1) * x;
+  }
+  return (uint8_t)z;
+}
+
+void qrt_rs_encode(const uint8_t *data, size_t len, int ecc_len, uint8_t *ecc) {
+  uint8_t divisor[32];
+  memset(divisor, 0, sizeof(divisor));
+  divisor[ecc_len - 1] = 1;
+  uint8_t root = 1;
+  for (int i = 0; i < ecc_len; i++) {
+    for (int j = 0; j < ecc_len; j++) {
+      divisor[j] = gf_mul(divisor[j], root);
+      if (j + 1 < ecc_len)
+        divisor[j] ^= divisor[j + 1];
+    }
+    root = gf_mul(root, 0x02);
+  }
+
+  memset(ecc, 0, (size_t)ecc_len);
+  for (size_t n = 0; n < len; n++) {
+    uint8_t factor = data[n] ^ ecc[0];
+    memmove(ecc, ecc + 1, (size_t)ecc_len - 1);
+    ecc[ecc_len - 1] = 0;
+    for (int i = 0; i < ecc_len; i++)
+      ecc[i] ^= gf_mul(divisor[i], factor);
+  }
+}
+
+static int raw_data_modules(int ver) {
+  int result = (16 * ver + 128) * ver + 64;
+  if (ver >= 2) {
+    int num_align = ver / 7 + 2;
+    result -= (25 * num_align - 10) * num_align - 55;
+    if (ver >= 7)
+      result -= 36;
+  }
+  return result;
+}
+
+static int data_codewords(int ver, qrt_ecc_t ecc) {
+  return raw_data_modules(ver) / 8 - ecc_per_block[ecc][ver] * ecc_blocks[ecc][ver];
+}
+
+int qrt_capacity(int version, qrt_ecc_t ecc) {
+  int count_bits = version <= 9 ? 8 : 16;
+  return (data_codewords(version, ecc) * 8 - 4 - count_bits) / 8;
+}
+
+typedef struct {
+  qrt_code_t *code;
+  uint8_t is_function[QRT_MAX_SIZE][QRT_MAX_SIZE];
+} builder_t;
+
+static void set_function(builder_t *b, int x, int y, bool dark) {
+  b->code->modules[y][x] = dark;
+  b->is_function[y][x] = 1;
+}
+
+static void draw_finder(builder_t *b, int cx, int cy) {
+  int size = b->code->size;
+  for (int dy = -4; dy <= 4; dy++) {
+    for (int dx = -4; dx <= 4; dx++) {
+      int dist = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+      int x = cx + dx, y = cy + dy;
+      if (x >= 0 && x < size && y >= 0 && y < size)
+        set_function(b, x, y, dist != 2 && dist != 4);
+    }
+  }
+}
+
+static void draw_alignment(builder_t *b, int cx, int cy) {
+  for (int dy = -2; dy <= 2; dy++)
+    for (int dx = -2; dx <= 2; dx++) {
+      int dist = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+      set_function(b, cx + dx, cy + dy, dist != 1);
+    }
+}
+
+static int alignment_positions(int ver, int size, int *pos) {
+  if (ver == 1)
+    return 0;
+  int num = ver / 7 + 2;
+  int step = (ver == 32) ? 26 : (ver * 4 + num * 2 + 1) / (num * 2 - 2) * 2;
+  pos[0] = 6;
+  for (int i = num - 1, p = size - 7; i >= 1; i--, p -= step)
+    pos[i] = p;
+  return num;
+}
+
+static void draw_format(builder_t *b, qrt_ecc_t ecc, int mask) {
+  int size = b->code->size;
+  int data = ecc_format_bits[ecc] << 3 | mask;
+  int rem = data;
+  for (int i = 0; i < 10; i++)
+    rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+  int bits = (data << 10 | rem) ^ 0x5412;
+
+  for (int i = 0; i <= 5; i++)
+    set_function(b, 8, i, (bits >> i) & 1);
+  set_function(b, 8, 7, (bits >> 6) & 1);
+  set_function(b, 8, 8, (bits >> 7) & 1);
+  set_function(b, 7, 8, (bits >> 8) & 1);
+  for (int i = 9; i < 15; i++)
+    set_function(b, 14 - i, 8, (bits >> i) & 1);
+
+  for (int i = 0; i < 8; i++)
+    set_function(b, size - 1 - i, 8, (bits >> i) & 1);
+  for (int i = 8; i < 15; i++)
+    set_function(b, 8, size - 15 + i, (bits >> i) & 1);
+  set_function(b, 8, size - 8, true);
+}
+
+static void draw_version(builder_t *b, int ver) {
+  if (ver < 7)
+    return;
+  int size = b->code->size;
+  int rem = ver;
+  for (int i = 0; i < 12; i++)
+    rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+  long bits = (long)ver << 12 | rem;
+  for (int i = 0; i < 18; i++) {
+    bool bit = (bits >> i) & 1;
+    int a = size - 11 + i % 3, c = i / 3;
+    set_function(b, a, c, bit);
+    set_function(b, c, a, bit);
+  }
+}
+
+static void draw_function_patterns(builder_t *b, int ver, qrt_ecc_t ecc) {
+  int size = b->code->size;
+  for (int i = 0; i < size; i++) {
+    set_function(b, 6, i, i % 2 == 0);
+    set_function(b, i, 6, i % 2 == 0);
+  }
+  draw_finder(b, 3, 3);
+  draw_finder(b, size - 4, 3);
+  draw_finder(b, 3, size - 4);
+
+  int pos[7];
+  int num = alignment_positions(ver, size, pos);
+  for (int i = 0; i < num; i++)
+    for (int j = 0; j < num; j++) {
+      if ((i == 0 && j == 0) || (i == 0 && j == num - 1) ||
+          (i == num - 1 && j == 0))
+        continue;
+      draw_alignment(b, pos[i], pos[j]);
+    }
+
+  draw_format(b, ecc, 0);
+  draw_version(b, ver);
+}
+
+static void draw_codewords(builder_t *b, const uint8_t *data, int len) {
+  int size = b->code->size;
+  int i = 0;
+  for (int right = size - 1; right >= 1; right -= 2) {
+    if (right == 6)
+      right = 5;
+    for (int vert = 0; vert < size; vert++) {
+      for (int j = 0; j < 2; j++) {
+        int x = right - j;
+        bool upward = ((right + 1) & 2) == 0;
+        int y = upward ? size - 1 - vert : vert;
+        if (!b->is_function[y][x] && i < len * 8) {
+          b->code->modules[y][x] = (data[i >> 3] >> (7 - (i & 7))) & 1;
+          i++;
+        }
+      }
+    }
+  }
+}
+
+bool qrt_encode(const uint8_t *data, size_t len, int version, qrt_ecc_t ecc,
+                qrt_code_t *out) {
+  if (version < 1 || version > 40 || (int)len > qrt_capacity(version, ecc))
+    return false;
+
+  /* Bit stream: mode, count, bytes, terminator, padding */
+  int capacity = data_codewords(version, ecc);
+  uint8_t *stream = calloc((size_t)capacity, 1);
+  if (!stream)
+    return false;
+  int bit = 0;
+#define PUT(val, nbits)                                                        \
+  for (int k = (nbits)-1; k >= 0; k--, bit++)                                  \
+    stream[bit >> 3] |= (uint8_t)((((val) >> k) & 1) << (7 - (bit & 7)))
+  PUT(4, 4);
+  PUT((int)len, version <= 9 ? 8 : 16);
+  for (size_t n = 0; n < len; n++)
+    PUT(data[n], 8);
+  int term = capacity * 8 - bit;
+  PUT(0, term < 4 ? term : 4);
+  bit = (bit + 7) & ~7;
+  for (uint8_t pad = 0xEC; bit < capacity * 8; pad ^= 0xEC ^ 0x11)
+    PUT(pad, 8);
+#undef PUT
+
+  /* Split into blocks, add ECC, interleave */
+  int num_blocks = ecc_blocks[ecc][version];
+  int block_ecc = ecc_per_block[ecc][version];
+  int raw = raw_data_modules(version) / 8;
+  int num_short = num_blocks - raw % num_blocks;
+  int short_len = raw / num_blocks;
+
+  uint8_t *blocks = calloc((size_t)num_blocks * (short_len + 1), 1);
+  uint8_t *final = calloc((size_t)raw, 1);
+  if (!blocks || !final) {
+    free(stream);
+    free(blocks);
+    free(final);
+    return false;
+  }
+  for (int i = 0, k = 0; i < num_blocks; i++) {
+    int dat_len = short_len - block_ecc + (i < num_short ? 0 : 1);
+    uint8_t *blk = blocks + (size_t)i * (short_len + 1);
+    memcpy(blk, stream + k, (size_t)dat_len);
+    qrt_rs_encode(blk, (size_t)dat_len, block_ecc,
+                  blk + short_len + 1 - block_ecc);
+    k += dat_len;
+  }
+  int n = 0;
+  for (int i = 0; i < short_len + 1; i++)
+    for (int j = 0; j < num_blocks; j++)
+      if (i != short_len - block_ecc || j >= num_short)
+        final[n++] = blocks[(size_t)j * (short_len + 1) + i];
+
+  builder_t *b = calloc(1, sizeof(*b));
+  if (!b) {
+    free(stream);
+    free(blocks);
+    free(final);
+    return false;
+  }
+  memset(out, 0, sizeof(*out));
+  out->version = version;
+  out->size = version * 4 + 17;
+  b->code = out;
+  draw_function_patterns(b, version, ecc);
+  draw_codewords(b, final, raw);
+
+  /* Mask 0: (x + y) % 2 == 0 */
+  for (int y = 0; y < out->size; y++)
+    for (int x = 0; x < out->size; x++)
+      if (!b->is_function[y][x] && (x + y) % 2 == 0)
+        out->modules[y][x] ^= 1;
+
+  free(b);
+  free(stream);
+  free(blocks);
+  free(final);
+  return true;
+}
+
+void qrt_render(const qrt_code_t *code, uint8_t *image, int width, int height,
+                int x0, int y0, int scale, bool inverted) {
+  /* Sensor-like noise keeps Otsu away from the ties of a two-level image */
+  const int dark = 40, light = 210;
+  uint32_t seed = 0x1234567u;
+  int span = (code->size + 8) * scale;
+  for (int y = 0; y < span; y++) {
+    int py = y0 + y;
+    if (py < 0 || py >= height)
+      continue;
+    int my = y / scale - 4;
+    for (int x = 0; x < span; x++) {
+      int px = x0 + x;
+      if (px < 0 || px >= width)
+        continue;
+      int mx = x / scale - 4;
+      bool on = mx >= 0 && my >= 0 && mx < code->size && my < code->size &&
+                code->modules[my][mx];
+      seed = seed * 1103515245u + 12345u;
+      int noise = (int)((seed >> 16) % 41) - 20;
+      image[py * width + px] = (uint8_t)(((on != inverted) ? dark : light) + noise);
+    }
+  }
+}
@@ -0,0 +1,41 @@
+/*
+ * Minimal QR encoder for host tests: byte mode, ECC level L or M, fixed
+ * mask 0, versions 1-40. Independent of the decoder tables so it can be used
+ * to check them.
+ */
+
+#ifndef QR_TEST_ENCODER_H
+#define QR_TEST_ENCODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define QRT_MAX_SIZE 177
+
+typedef enum { QRT_ECC_L = 0, QRT_ECC_M = 1 } qrt_ecc_t;
+
+typedef struct {
+  int version;
+  int size;
+  uint8_t modules[QRT_MAX_SIZE][QRT_MAX_SIZE]; // 1 = dark
+} qrt_code_t;
+
+/* Byte capacity of a version at an ECC level */
+int qrt_capacity(int version, qrt_ecc_t ecc);
+
+/* Encode data at exactly this version; false if it does not fit */
+bool qrt_encode(const uint8_t *data, size_t len, int version, qrt_ecc_t ecc,
+                qrt_code_t *out);
+
+/*
+ * Render into a grayscale image at (x0, y0) with `scale` pixels per module
+ * and a 4-module quiet zone. Inverted draws light modules on dark.
+ */
+void qrt_render(const qrt_code_t *code, uint8_t *image, int width, int height,
+                int x0, int y0, int scale, bool inverted);
+
+/* Reed-Solomon ECC of data over the QR generator of degree ecc_len */
+void qrt_rs_encode(const uint8_t *data, size_t len, int ecc_len, uint8_t *ecc);
+
+#endif
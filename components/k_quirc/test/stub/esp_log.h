@@ -0,0 +1,10 @@
+/* Host stand-in for ESP-IDF logging */
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#define ESP_LOGE(tag, ...) ((void)(tag))
+#define ESP_LOGW(tag, ...) ((void)(tag))
+#define ESP_LOGI(tag, ...) ((void)(tag))
+#define ESP_LOGD(tag, ...) ((void)(tag))
+
+#endif
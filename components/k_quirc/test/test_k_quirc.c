@@ -0,0 +1,588 @@
+/*
+ * K-Quirc Test Suite
+ * Compile with: make
+ * Run: ./test_k_quirc
+ *
+ * Codes are generated by qr_test_encoder.c and rendered to grayscale, so
+ * detection and decoding run end to end on synthetic frames.
+ */
+
+#include "k_quirc.h"
+#include "k_quirc_internal.h"
+#include "k_quirc_rs.h"
+#include "qr_test_encoder.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+#define MAX_RESULTS 4
+
+typedef struct {
+  uint8_t *pixels;
+  int w, h;
+} frame_t;
+
+/* Light, slightly noisy background like the area around a code */
+static frame_t frame_new(int w, int h) {
+  frame_t f = {malloc((size_t)w * h), w, h};
+  uint32_t seed = 42;
+  for (int i = 0; i < w * h; i++) {
+    seed = seed * 1103515245u + 12345u;
+    f.pixels[i] = (uint8_t)(190 + (seed >> 16) % 41);
+  }
+  return f;
+}
+
+static void frame_free(frame_t *f) { free(f->pixels); }
+
+/* 3x3 box blur: soft module edges, as from a camera */
+static void frame_blur(frame_t *f) {
+  uint8_t *src = malloc((size_t)f->w * f->h);
+  memcpy(src, f->pixels, (size_t)f->w * f->h);
+  for (int y = 1; y < f->h - 1; y++)
+    for (int x = 1; x < f->w - 1; x++) {
+      int sum = 0;
+      for (int dy = -1; dy <= 1; dy++)
+        for (int dx = -1; dx <= 1; dx++)
+          sum += src[(y + dy) * f->w + x + dx];
+      f->pixels[y * f->w + x] = (uint8_t)(sum / 9);
+    }
+  free(src);
+}
+
+/*
+ * Resample through a homography about the frame centre: rotate by `angle`,
+ * then divide by 1 + gx * x + gy * y for a keystone tilt.
+ */
+static void frame_warp(frame_t *f, float angle, float gx, float gy) {
+  uint8_t *src = malloc((size_t)f->w * f->h);
+  float ca = cosf(angle), sa = sinf(angle);
+  float cx = f->w / 2.0f, cy = f->h / 2.0f;
+
+  memcpy(src, f->pixels, (size_t)f->w * f->h);
+  for (int y = 0; y < f->h; y++)
+    for (int x = 0; x < f->w; x++) {
+      float dx = x - cx, dy = y - cy;
+      float den = 1.0f + gx * dx + gy * dy;
+      float sx = (ca * dx - sa * dy) / den + cx;
+      float sy = (sa * dx + ca * dy) / den + cy;
+      int ix = (int)floorf(sx), iy = (int)floorf(sy);
+      float fx = sx - ix, fy = sy - iy;
+      const uint8_t *p;
+
+      if (ix < 0 || iy < 0 || ix >= f->w - 1 || iy >= f->h - 1) {
+        f->pixels[y * f->w + x] = 210;
+        continue;
+      }
+      p = &src[iy * f->w + ix];
+      f->pixels[y * f->w + x] =
+          (uint8_t)(p[0] * (1 - fx) * (1 - fy) + p[1] * fx * (1 - fy) +
+                    p[f->w] * (1 - fx) * fy + p[f->w + 1] * fx * fy);
+    }
+  free(src);
+}
+
+/* Encode text at a version and draw it into the frame */
+static int draw_code(frame_t *f, const char *text, int version, int x0, int y0,
+                     int scale, bool inverted) {
+  static qrt_code_t code;
+  if (!qrt_encode((const uint8_t *)text, strlen(text), version, QRT_ECC_M,
+                  &code))
+    return 0;
+  qrt_render(&code, f->pixels, f->w, f->h, x0, y0, scale, inverted);
+  frame_blur(f);
+  return 1;
+}
+
+static int decode(const frame_t *f, bool find_inverted,
+                  k_quirc_result_t *results) {
+  return k_quirc_decode_grayscale(f->pixels, f->w, f->h, results, MAX_RESULTS,
+                                  find_inverted);
+}
+
+static void results_free(k_quirc_result_t *results) {
+  for (int i = 0; i < MAX_RESULTS; i++)
+    k_quirc_result_free(&results[i]);
+}
+
+static int has_payload(const k_quirc_result_t *results, int n,
+                       const char *text) {
+  for (int i = 0; i < n; i++)
+    if (results[i].data.payload_len == (int)strlen(text) &&
+        memcmp(results[i].data.payload, text, strlen(text)) == 0)
+      return 1;
+  return 0;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static const char text_a[] = "UR:CRYPTO-PSBT/1-3/LPADAXCFAXHLCYYNSFLTDW";
+static const char text_b[] = "B$2C0200NJ4FJFMBSKQ3TONS7L3F5BWZ5WP5ZGCJ";
+
+/* ---------- Tests ---------- */
+
+static void test_normal(void) {
+  TEST("decode normal code");
+
+  frame_t f = frame_new(320, 320);
+  k_quirc_result_t results[MAX_RESULTS] = {0};
+  draw_code(&f, text_a, 3, 40, 40, 6, false);
+  int n = decode(&f, false, results);
+  if (n != 1 || !has_payload(results, n, text_a))
+    FAIL("payload not decoded");
+  else
+    PASS();
+  results_free(results);
+  frame_free(&f);
+}
+
+static void test_inverted(void) {
+  TEST("decode inverted code only when requested");
+
+  frame_t f = frame_new(320, 320);
+  k_quirc_result_t results[MAX_RESULTS] = {0};
+  draw_code(&f, text_a, 3, 40, 40, 6, true);
+  if (decode(&f, false, results) != 0) {
+    FAIL("inverted code found with find_inverted off");
+  } else {
+    int n = decode(&f, true, results);
+    if (n != 1 || !has_payload(results, n, text_a))
+      FAIL("inverted payload not decoded");
+    else
+      PASS();
+  }
+  results_free(results);
+  frame_free(&f);
+}
+
+static void test_normal_with_inverted_scan(void) {
+  TEST("normal code unaffected by inverted scan");
+
+  frame_t f = frame_new(320, 320);
+  k_quirc_result_t results[MAX_RESULTS] = {0};
+  draw_code(&f, text_b, 5, 20, 20, 5, false);
+  int n = decode(&f, true, results);
+  if (n != 1 || !has_payload(results, n, text_b))
+    FAIL("expected exactly the normal code");
+  else
+    PASS();
+  results_free(results);
+  frame_free(&f);
+}
+
+static void test_mixed_polarity(void) {
+  TEST("normal and inverted codes in one frame");
+
+  frame_t f = frame_new(640, 320);
+  k_quirc_result_t results[MAX_RESULTS] = {0};
+  draw_code(&f, text_a, 3, 20, 40, 6, false);
+  draw_code(&f, text_b, 3, 340, 40, 6, true);
+  int n = decode(&f, true, results);
+  if (n != 2 || !has_payload(results, n, text_a) ||
+      !has_payload(results, n, text_b))
+    FAIL("expected both codes");
+  else
+    PASS();
+  results_free(results);
+  frame_free(&f);
+}
+
+/* Fill text with a version's full byte capacity */
+static size_t fill_text(char *text, size_t size, int version, int seed) {
+  size_t len = qrt_capacity(version, QRT_ECC_M);
+
+  if (len > size - 1)
+    len = size - 1;
+  for (size_t j = 0; j < len; j++)
+    text[j] = 'A' + (j * 7 + seed) % 26;
+  text[len] = 0;
+  return len;
+}
+
+static void test_perspective(void) {
+  TEST("decode tilted and rotated codes");
+
+  static const struct {
+    int version;
+    float angle, gx, gy;
+  } cases[] = {
+      {7, 0.1f, 0.0005f, 0.0006f},
+      {10, 0.1f, -0.0006f, -0.0005f},
+      {13, -0.2f, 0.0005f, 0.0006f},
+  };
+  char text[128];
+  int failed = 0;
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    frame_t f = frame_new(480, 480);
+    k_quirc_result_t results[MAX_RESULTS] = {0};
+    int size = 17 + 4 * cases[i].version;
+    int scale = (480 - 40) / (size + 8) < 4 ? (480 - 40) / (size + 8) : 4;
+    int offset = (480 - (size + 8) * scale) / 2;
+
+    fill_text(text, sizeof(text), cases[i].version, (int)i);
+    draw_code(&f, text, cases[i].version, offset, offset, scale, false);
+    frame_warp(&f, cases[i].angle, cases[i].gx, cases[i].gy);
+    int n = decode(&f, false, results);
+    if (n != 1 || !has_payload(results, n, text)) {
+      printf("\n  version %d not decoded", cases[i].version);
+      failed = 1;
+    }
+    results_free(results);
+    frame_free(&f);
+  }
+
+  if (failed)
+    FAIL("\n");
+  else
+    PASS();
+}
+
+static void test_large_versions(void) {
+  TEST("decode versions 25-40");
+
+  static const int versions[] = {25, 32, 40};
+  static char text[2400];
+  int failed = 0;
+
+  for (size_t i = 0; i < sizeof(versions) / sizeof(versions[0]); i++) {
+    int size = 17 + 4 * versions[i];
+    int frame_size = (size + 8) * 4 + 20;
+    frame_t f = frame_new(frame_size, frame_size);
+    k_quirc_result_t results[MAX_RESULTS] = {0};
+
+    fill_text(text, sizeof(text), versions[i], (int)i);
+    draw_code(&f, text, versions[i], 10, 10, 4, false);
+    int n = decode(&f, false, results);
+    if (n != 1 || !has_payload(results, n, text) ||
+        results[0].data.version != versions[i]) {
+      printf("\n  version %d not decoded", versions[i]);
+      failed = 1;
+    }
+    results_free(results);
+    frame_free(&f);
+  }
+
+  if (failed)
+    FAIL("\n");
+  else
+    PASS();
+}
+
+/* Decode into one result with one decoder: small, large, then small again */
+static int decode_with(k_quirc_t *q, const frame_t *f,
+                       k_quirc_result_t *result) {
+  uint8_t *buf = k_quirc_begin(q, NULL, NULL);
+  memcpy(buf, f->pixels, (size_t)f->w * f->h);
+  k_quirc_end(q, false);
+  return k_quirc_count(q) == 1 && k_quirc_decode(q, 0, result) == 0;
+}
+
+static void test_buffer_reuse(void) {
+  TEST("payload buffer grows once and is reused");
+
+  static char large_text[2400];
+  const int frame_size = (17 + 4 * 30 + 8) * 4 + 20;
+  frame_t small = frame_new(frame_size, frame_size);
+  frame_t large = frame_new(frame_size, frame_size);
+  k_quirc_result_t result = {0};
+  k_quirc_t *q = k_quirc_new();
+
+  size_t large_len = fill_text(large_text, sizeof(large_text), 30, 3);
+  draw_code(&small, text_a, 3, 40, 40, 6, false);
+  draw_code(&large, large_text, 30, 10, 10, 4, false);
+  k_quirc_resize(q, frame_size, frame_size);
+
+  if (!decode_with(q, &small, &result) ||
+      result.data.payload_len != (int)strlen(text_a)) {
+    FAIL("small code not decoded");
+  } else if (!decode_with(q, &large, &result) ||
+             result.data.payload_len != (int)large_len ||
+             memcmp(result.data.payload, large_text, large_len) != 0) {
+    FAIL("large code not decoded");
+  } else {
+    const uint8_t *grown = result.data.payload;
+    size_t cap = result.data.payload_cap;
+
+    if (!decode_with(q, &small, &result) ||
+        memcmp(result.data.payload, text_a, strlen(text_a)) != 0 ||
+        result.data.payload[result.data.payload_len] != 0)
+      FAIL("small code not decoded after large");
+    else if (result.data.payload != grown || result.data.payload_cap != cap)
+      FAIL("payload buffer reallocated");
+    else
+      PASS();
+  }
+
+  k_quirc_result_free(&result);
+  k_quirc_destroy(q);
+  frame_free(&small);
+  frame_free(&large);
+}
+
+static uint32_t rs_seed = 7;
+
+static uint8_t rs_random(void) {
+  rs_seed = rs_seed * 1103515245u + 12345u;
+  return (uint8_t)(rs_seed >> 16);
+}
+
+/* ECC codeword counts that occur in QR blocks */
+static const int rs_ecc_lens[] = {7,  10, 13, 15, 16, 17, 18, 20,
+                                  22, 24, 26, 28, 30};
+
+static void test_rs_encode(void) {
+  TEST("RS encoder matches the reference encoder");
+
+  uint8_t data[K_QUIRC_RS_MAX_BLOCK];
+  uint8_t ecc[K_QUIRC_RS_MAX_ECC];
+  uint8_t expect[K_QUIRC_RS_MAX_ECC];
+
+  for (size_t i = 0; i < sizeof(rs_ecc_lens) / sizeof(rs_ecc_lens[0]); i++) {
+    int ecc_len = rs_ecc_lens[i];
+    int data_len = K_QUIRC_RS_MAX_BLOCK - ecc_len - (int)i * 7;
+
+    for (int j = 0; j < data_len; j++)
+      data[j] = rs_random();
+    k_quirc_rs_encode(data, data_len, ecc_len, ecc);
+    qrt_rs_encode(data, (size_t)data_len, ecc_len, expect);
+    if (memcmp(ecc, expect, (size_t)ecc_len) != 0) {
+      FAIL("ECC codewords differ");
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_rs_correct(void) {
+  TEST("RS corrects up to half the ECC codewords");
+
+  uint8_t block[K_QUIRC_RS_MAX_BLOCK];
+  uint8_t clean[K_QUIRC_RS_MAX_BLOCK];
+  uint8_t s[K_QUIRC_RS_MAX_ECC];
+
+  for (size_t i = 0; i < sizeof(rs_ecc_lens) / sizeof(rs_ecc_lens[0]); i++) {
+    int ecc_len = rs_ecc_lens[i];
+    int len = ecc_len * 4 + 5;
+    int data_len = len - ecc_len;
+    int corrected = -1;
+
+    for (int j = 0; j < data_len; j++)
+      clean[j] = rs_random();
+    k_quirc_rs_encode(clean, data_len, ecc_len, clean + data_len);
+
+    if (k_quirc_rs_syndromes(clean, len, ecc_len, s) ||
+        k_quirc_rs_correct(clean, len, ecc_len, &corrected) !=
+            K_QUIRC_SUCCESS ||
+        corrected != 0) {
+      FAIL("clean block not accepted as is");
+      return;
+    }
+
+    for (int errors = 1; errors <= ecc_len / 2; errors++) {
+      memcpy(block, clean, (size_t)len);
+      /* Distinct positions, spread over data and ECC codewords */
+      for (int e = 0; e < errors; e++)
+        block[(e * len) / errors] ^= (uint8_t)(rs_random() | 1);
+
+      if (k_quirc_rs_correct(block, len, ecc_len, &corrected) !=
+              K_QUIRC_SUCCESS ||
+          corrected != errors || memcmp(block, clean, (size_t)len) != 0) {
+        printf("\n  ecc %d, %d errors", ecc_len, errors);
+        FAIL("block not restored");
+        return;
+      }
+    }
+  }
+  PASS();
+}
+
+/* Per-term log/exp with a modulo, as the decoder did before */
+static int rs_reference_syndromes(const uint8_t *block, int len, int ecc_len,
+                                  uint8_t *s) {
+  static uint8_t exp_t[255], log_t[256];
+  int nonzero = 0;
+
+  if (!exp_t[0])
+    for (int i = 0, x = 1; i < 255; i++) {
+      exp_t[i] = (uint8_t)x;
+      log_t[x] = (uint8_t)i;
+      x = (x << 1) ^ ((x >> 7) * 0x11D);
+    }
+
+  for (int i = 0; i < ecc_len; i++) {
+    s[i] = 0;
+    for (int j = 0; j < len; j++) {
+      uint8_t c = block[len - j - 1];
+      if (c)
+        s[i] ^= exp_t[(log_t[c] + i * j) % 255];
+    }
+    nonzero |= s[i] != 0;
+  }
+  return nonzero;
+}
+
+/* RS work for every block of one symbol: clean, and at half capacity */
+static void bench_rs(void) {
+  static const int versions[] = {2, 10, 25, 40};
+  static const struct {
+    int level;
+    char name;
+  } levels[] = {{K_QUIRC_ECC_LEVEL_L, 'L'},
+                {K_QUIRC_ECC_LEVEL_M, 'M'},
+                {K_QUIRC_ECC_LEVEL_Q, 'Q'},
+                {K_QUIRC_ECC_LEVEL_H, 'H'}};
+  static uint8_t clean[256][K_QUIRC_RS_MAX_BLOCK];
+  static uint8_t work[256][K_QUIRC_RS_MAX_BLOCK];
+  const int iters = 200;
+  uint8_t s[K_QUIRC_RS_MAX_ECC];
+  volatile int sink = 0;
+
+  printf("\nRS per symbol (all blocks), us: reference syndromes / "
+         "syndromes / correct clean / correct damaged\n");
+
+  for (size_t v = 0; v < sizeof(versions) / sizeof(versions[0]); v++) {
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+      const struct quirc_version_info *ver = &quirc_version_db[versions[v]];
+      const struct quirc_rs_params *sb = &ver->ecc[levels[l].level];
+      const int ecc_len = sb->bs - sb->dw;
+      const int lb_count = (ver->data_bytes - sb->bs * sb->ns) / (sb->bs + 1);
+      const int blocks = sb->ns + lb_count;
+      double t_ref = 0, t_syn = 0, t_clean = 0, t_bad = 0, t0;
+
+      for (int b = 0; b < blocks; b++) {
+        int len = sb->bs + (b >= sb->ns);
+        for (int j = 0; j < len - ecc_len; j++)
+          clean[b][j] = rs_random();
+        k_quirc_rs_encode(clean[b], len - ecc_len, ecc_len,
+                          clean[b] + len - ecc_len);
+      }
+
+      for (int it = 0; it < iters; it++) {
+        t0 = now_ms();
+        for (int b = 0; b < blocks; b++)
+          sink += rs_reference_syndromes(clean[b], sb->bs + (b >= sb->ns),
+                                         ecc_len, s);
+        t_ref += now_ms() - t0;
+
+        t0 = now_ms();
+        for (int b = 0; b < blocks; b++)
+          sink += k_quirc_rs_syndromes(clean[b], sb->bs + (b >= sb->ns),
+                                       ecc_len, s);
+        t_syn += now_ms() - t0;
+
+        t0 = now_ms();
+        for (int b = 0; b < blocks; b++)
+          sink += k_quirc_rs_correct(clean[b], sb->bs + (b >= sb->ns),
+                                     ecc_len, NULL);
+        t_clean += now_ms() - t0;
+
+        for (int b = 0; b < blocks; b++) {
+          int len = sb->bs + (b >= sb->ns);
+          memcpy(work[b], clean[b], (size_t)len);
+          for (int e = 0; e < ecc_len / 4; e++)
+            work[b][(e * len) / (ecc_len / 4)] ^= 0x5A;
+        }
+        t0 = now_ms();
+        for (int b = 0; b < blocks; b++)
+          sink += k_quirc_rs_correct(work[b], sb->bs + (b >= sb->ns),
+                                     ecc_len, NULL);
+        t_bad += now_ms() - t0;
+      }
+
+      printf("  v%-2d %c, %2d blocks x %2d ecc: %8.2f %8.2f %8.2f %8.2f\n",
+             versions[v], levels[l].name, blocks, ecc_len,
+             t_ref * 1000 / iters, t_syn * 1000 / iters,
+             t_clean * 1000 / iters, t_bad * 1000 / iters);
+    }
+  }
+  (void)sink;
+}
+
+/* Time k_quirc_end on one frame, averaged */
+static double time_identify(k_quirc_t *q, const frame_t *f, bool inverted,
+                            int iters) {
+  double total = 0;
+  for (int i = 0; i < iters; i++) {
+    uint8_t *buf = k_quirc_begin(q, NULL, NULL);
+    memcpy(buf, f->pixels, (size_t)f->w * f->h);
+    double t0 = now_ms();
+    k_quirc_end(q, inverted);
+    total += now_ms() - t0;
+  }
+  return total / iters;
+}
+
+static void bench_identify(void) {
+  const int iters = 200;
+  frame_t normal = frame_new(320, 240);
+  frame_t inverted = frame_new(320, 240);
+  frame_t flipped = frame_new(320, 240);
+  draw_code(&normal, text_b, 4, 60, 10, 5, false);
+  draw_code(&inverted, text_b, 4, 60, 10, 5, true);
+  for (int i = 0; i < 320 * 240; i++)
+    flipped.pixels[i] = 255 - inverted.pixels[i];
+
+  k_quirc_t *q = k_quirc_new();
+  k_quirc_resize(q, 320, 240);
+
+  double plain = time_identify(q, &normal, false, iters);
+  double both_normal = time_identify(q, &normal, true, iters);
+  double both_inverted = time_identify(q, &inverted, true, iters);
+  /* Former behaviour on an inverted frame: a full pass that finds nothing,
+   * then a second pass over the inverted image */
+  double two_pass = time_identify(q, &inverted, false, iters) +
+                    time_identify(q, &flipped, false, iters);
+
+  printf("\nk_quirc_end, 320x240 frame, per call:\n");
+  printf("  normal, normal-only scan:    %.3f ms\n", plain);
+  printf("  normal, dual-polarity scan:  %.3f ms\n", both_normal);
+  printf("  inverted, dual-polarity:     %.3f ms\n", both_inverted);
+  printf("  inverted, two-pass estimate: %.3f ms\n\n", two_pass);
+
+  k_quirc_destroy(q);
+  frame_free(&normal);
+  frame_free(&inverted);
+  frame_free(&flipped);
+}
+
+int main(void) {
+  printf("=== K-Quirc Tests ===\n\n");
+
+  test_normal();
+  test_inverted();
+  test_normal_with_inverted_scan();
+  test_mixed_polarity();
+  test_perspective();
+  test_large_versions();
+  test_buffer_reuse();
+  test_rs_encode();
+  test_rs_correct();
+
+  bench_identify();
+  bench_rs();
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+#ifndef KEY_CACHE_H
+#define KEY_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Small LRU of password-derived keys for one session
+ *
+ * Entries are matched on (tag, SHA256(id), iterations), where tag is
+ * SHA256(session_nonce || password). The caller supplies a fresh random
+ * nonce on every enable and clear, so tags are meaningless outside the
+ * session that produced them. Disabling wipes every entry and the nonce.
+ *
+ * The cache is a plain struct with no locking; callers that share one
+ * across tasks serialise access themselves. key_cache_make_tag() only
+ * reads the nonce it is given, so the hashing can run unlocked on a copy.
+ */
+
+#define KEY_CACHE_SLOTS 8
+#define KEY_CACHE_NONCE_SIZE 16
+#define KEY_CACHE_KEY_SIZE 32
+#define KEY_CACHE_HASH_SIZE 32
+
+typedef struct {
+  uint8_t pw_tag[KEY_CACHE_HASH_SIZE];
+  uint8_t id_hash[KEY_CACHE_HASH_SIZE];
+} key_cache_tag_t;
+
+typedef struct {
+  bool used;
+  uint32_t iterations;
+  uint32_t last_use;
+  key_cache_tag_t tag;
+  uint8_t key[KEY_CACHE_KEY_SIZE];
+} key_cache_entry_t;
+
+typedef struct {
+  key_cache_entry_t entries[KEY_CACHE_SLOTS];
+  uint8_t nonce[KEY_CACHE_NONCE_SIZE];
+  bool enabled;
+  uint32_t clock;
+} key_cache_t;
+
+/* Start a new session: wipes any entries and takes the nonce */
+void key_cache_enable(key_cache_t *cache,
+                      const uint8_t nonce[KEY_CACHE_NONCE_SIZE]);
+/* Wipe every entry and the nonce; lookups miss and stores are dropped */
+void key_cache_disable(key_cache_t *cache);
+/* Wipe every entry and rotate the nonce, staying enabled if it was */
+void key_cache_clear(key_cache_t *cache,
+                     const uint8_t nonce[KEY_CACHE_NONCE_SIZE]);
+
+void key_cache_make_tag(const uint8_t nonce[KEY_CACHE_NONCE_SIZE],
+                        const uint8_t *password, size_t pw_len,
+                        const uint8_t *id, size_t id_len,
+                        key_cache_tag_t *tag_out);
+
+/**
+ * @brief Copy out the key stored for tag and iterations
+ * @return false on a miss or while disabled
+ */
+bool key_cache_lookup(key_cache_t *cache, const key_cache_tag_t *tag,
+                      uint32_t iterations,
+                      uint8_t key_out[KEY_CACHE_KEY_SIZE]);
+
+/**
+ * @brief Remember a key, replacing the same entry or the least recently
+ * used one. Dropped while disabled.
+ */
+void key_cache_store(key_cache_t *cache, const key_cache_tag_t *tag,
+                     uint32_t iterations,
+                     const uint8_t key[KEY_CACHE_KEY_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KEY_CACHE_H
@@ -0,0 +1,93 @@
+/*
+ * Session-scoped LRU of password-derived keys
+ */
+
+#include "key_cache.h"
+#include <sha2.h>
+#include <string.h>
+
+/* Volatile function pointer so the wipes can't be elided */
+static void *(*const volatile wipe_memset)(void *, int, size_t) = memset;
+
+/* Password tags are secret-derived, so compare them in constant time */
+static bool tag_equal(const key_cache_tag_t *a, const key_cache_tag_t *b) {
+  uint8_t diff = 0;
+  for (size_t i = 0; i < KEY_CACHE_HASH_SIZE; i++)
+    diff |= a->pw_tag[i] ^ b->pw_tag[i];
+  return diff == 0 &&
+         memcmp(a->id_hash, b->id_hash, KEY_CACHE_HASH_SIZE) == 0;
+}
+
+void key_cache_enable(key_cache_t *cache,
+                      const uint8_t nonce[KEY_CACHE_NONCE_SIZE]) {
+  wipe_memset(cache->entries, 0, sizeof(cache->entries));
+  memcpy(cache->nonce, nonce, KEY_CACHE_NONCE_SIZE);
+  cache->clock = 0;
+  cache->enabled = true;
+}
+
+void key_cache_disable(key_cache_t *cache) {
+  cache->enabled = false;
+  wipe_memset(cache->entries, 0, sizeof(cache->entries));
+  wipe_memset(cache->nonce, 0, sizeof(cache->nonce));
+  cache->clock = 0;
+}
+
+void key_cache_clear(key_cache_t *cache,
+                     const uint8_t nonce[KEY_CACHE_NONCE_SIZE]) {
+  wipe_memset(cache->entries, 0, sizeof(cache->entries));
+  cache->clock = 0;
+  if (cache->enabled)
+    memcpy(cache->nonce, nonce, KEY_CACHE_NONCE_SIZE);
+}
+
+void key_cache_make_tag(const uint8_t nonce[KEY_CACHE_NONCE_SIZE],
+                        const uint8_t *password, size_t pw_len,
+                        const uint8_t *id, size_t id_len,
+                        key_cache_tag_t *tag_out) {
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, nonce, KEY_CACHE_NONCE_SIZE);
+  sha2_256_update(&ctx, password, pw_len);
+  sha2_256_final(&ctx, tag_out->pw_tag);
+  wipe_memset(&ctx, 0, sizeof(ctx));
+  sha2_256(id, id_len, tag_out->id_hash);
+}
+
+bool key_cache_lookup(key_cache_t *cache, const key_cache_tag_t *tag,
+                      uint32_t iterations,
+                      uint8_t key_out[KEY_CACHE_KEY_SIZE]) {
+  for (size_t i = 0; cache->enabled && i < KEY_CACHE_SLOTS; i++) {
+    key_cache_entry_t *e = &cache->entries[i];
+    if (e->used && e->iterations == iterations && tag_equal(&e->tag, tag)) {
+      memcpy(key_out, e->key, KEY_CACHE_KEY_SIZE);
+      e->last_use = ++cache->clock;
+      return true;
+    }
+  }
+  return false;
+}
+
+void key_cache_store(key_cache_t *cache, const key_cache_tag_t *tag,
+                     uint32_t iterations,
+                     const uint8_t key[KEY_CACHE_KEY_SIZE]) {
+  if (!cache->enabled)
+    return;
+
+  // Reuse a matching slot, else a free one, else the least recently used
+  key_cache_entry_t *slot = &cache->entries[0];
+  for (size_t i = 0; i < KEY_CACHE_SLOTS; i++) {
+    key_cache_entry_t *e = &cache->entries[i];
+    if (e->used && e->iterations == iterations && tag_equal(&e->tag, tag)) {
+      slot = e;
+      break;
+    }
+    if (!e->used || (slot->used && e->last_use < slot->last_use))
+      slot = e;
+  }
+  slot->used = true;
+  slot->iterations = iterations;
+  slot->last_use = ++cache->clock;
+  slot->tag = *tag;
+  memcpy(slot->key, key, KEY_CACHE_KEY_SIZE);
+}
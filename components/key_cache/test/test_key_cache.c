@@ -0,0 +1,269 @@
+/*
+ * Key Cache Test Suite
+ * Compile with: make
+ * Run: ./test_key_cache
+ */
+
+#include "key_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+#define ITERATIONS 100000
+
+static key_cache_t cache;
+
+static void make_nonce(uint8_t nonce[KEY_CACHE_NONCE_SIZE], uint8_t seed) {
+  for (size_t i = 0; i < KEY_CACHE_NONCE_SIZE; i++)
+    nonce[i] = (uint8_t)(seed + i);
+}
+
+static void make_key(uint8_t key[KEY_CACHE_KEY_SIZE], uint8_t seed) {
+  memset(key, seed, KEY_CACHE_KEY_SIZE);
+}
+
+static void tag_for(const char *pw, const char *id, key_cache_tag_t *tag) {
+  key_cache_make_tag(cache.nonce, (const uint8_t *)pw, strlen(pw),
+                     (const uint8_t *)id, strlen(id), tag);
+}
+
+static void start_session(uint8_t seed) {
+  uint8_t nonce[KEY_CACHE_NONCE_SIZE];
+  make_nonce(nonce, seed);
+  key_cache_enable(&cache, nonce);
+}
+
+static bool holds(const char *pw, const char *id, uint8_t seed) {
+  key_cache_tag_t tag;
+  uint8_t key[KEY_CACHE_KEY_SIZE], want[KEY_CACHE_KEY_SIZE];
+  tag_for(pw, id, &tag);
+  make_key(want, seed);
+  return key_cache_lookup(&cache, &tag, ITERATIONS, key) &&
+         memcmp(key, want, sizeof(key)) == 0;
+}
+
+static void put(const char *pw, const char *id, uint8_t seed) {
+  key_cache_tag_t tag;
+  uint8_t key[KEY_CACHE_KEY_SIZE];
+  tag_for(pw, id, &tag);
+  make_key(key, seed);
+  key_cache_store(&cache, &tag, ITERATIONS, key);
+}
+
+/* ---------- Tests ---------- */
+
+static void test_hit_and_miss(void) {
+  TEST("Hit only on same password, id and iterations");
+
+  start_session(1);
+  put("hunter2", "wallet", 0xaa);
+
+  key_cache_tag_t tag;
+  uint8_t key[KEY_CACHE_KEY_SIZE];
+  tag_for("hunter2", "wallet", &tag);
+
+  if (!holds("hunter2", "wallet", 0xaa)) {
+    FAIL("stored key not found");
+  } else if (holds("hunter3", "wallet", 0xaa) ||
+             holds("hunter2", "wallet2", 0xaa)) {
+    FAIL("hit on a different password or id");
+  } else if (key_cache_lookup(&cache, &tag, ITERATIONS + 1, key)) {
+    FAIL("hit on different iterations");
+  } else {
+    PASS();
+  }
+}
+
+static void test_same_entry_replaced(void) {
+  TEST("Storing the same entry again replaces it");
+
+  start_session(2);
+  put("pw", "id", 0x01);
+  put("pw", "id", 0x02);
+
+  size_t used = 0;
+  for (size_t i = 0; i < KEY_CACHE_SLOTS; i++)
+    used += cache.entries[i].used;
+
+  if (used != 1 || !holds("pw", "id", 0x02)) {
+    FAIL("duplicate entry");
+  } else {
+    PASS();
+  }
+}
+
+static void test_lru_eviction(void) {
+  TEST("Full cache evicts the least recently used entry");
+
+  char id[16];
+  start_session(3);
+  for (int i = 0; i < KEY_CACHE_SLOTS; i++) {
+    snprintf(id, sizeof(id), "id%d", i);
+    put("pw", id, (uint8_t)i);
+  }
+  // Touch id0 so id1 becomes the oldest
+  bool ok = holds("pw", "id0", 0);
+  put("pw", "new", 0x55);
+
+  ok = ok && holds("pw", "new", 0x55) && !holds("pw", "id1", 1);
+  for (int i = 0; ok && i < KEY_CACHE_SLOTS; i++) {
+    if (i == 1)
+      continue;
+    snprintf(id, sizeof(id), "id%d", i);
+    ok = holds("pw", id, (uint8_t)i);
+  }
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("wrong entry evicted");
+  }
+}
+
+static void test_clear_rotates_nonce(void) {
+  TEST("Clear (wallet unload) drops entries and old tags");
+
+  start_session(4);
+  put("pw", "id", 0x11);
+
+  key_cache_tag_t old_tag;
+  uint8_t key[KEY_CACHE_KEY_SIZE];
+  tag_for("pw", "id", &old_tag);
+
+  uint8_t nonce[KEY_CACHE_NONCE_SIZE];
+  make_nonce(nonce, 5);
+  key_cache_clear(&cache, nonce);
+
+  if (!cache.enabled) {
+    FAIL("clear disabled the cache");
+    return;
+  }
+  if (holds("pw", "id", 0x11)) {
+    FAIL("entry survived clear");
+    return;
+  }
+  // A tag made before the clear must not match one stored after it
+  put("pw", "id", 0x12);
+  if (key_cache_lookup(&cache, &old_tag, ITERATIONS, key)) {
+    FAIL("tag from previous nonce matched");
+  } else if (!holds("pw", "id", 0x12)) {
+    FAIL("cache unusable after clear");
+  } else {
+    PASS();
+  }
+}
+
+static void test_disabled(void) {
+  TEST("Disabled cache wipes, misses and drops stores");
+
+  start_session(6);
+  put("pw", "id", 0x21);
+  key_cache_disable(&cache);
+
+  static const uint8_t zero[sizeof(cache.entries)];
+  static const uint8_t zero_nonce[KEY_CACHE_NONCE_SIZE];
+  bool wiped = memcmp(cache.entries, zero, sizeof(zero)) == 0 &&
+               memcmp(cache.nonce, zero_nonce, sizeof(zero_nonce)) == 0;
+
+  put("pw", "id", 0x22);
+  bool stored = memcmp(cache.entries, zero, sizeof(zero)) != 0;
+
+  uint8_t nonce[KEY_CACHE_NONCE_SIZE];
+  make_nonce(nonce, 7);
+  key_cache_clear(&cache, nonce);
+  bool stayed_off = !cache.enabled && memcmp(cache.nonce, zero_nonce,
+                                             sizeof(zero_nonce)) == 0;
+
+  if (!wiped) {
+    FAIL("disable left key material");
+  } else if (stored || holds("pw", "id", 0x22)) {
+    FAIL("store while disabled");
+  } else if (!stayed_off) {
+    FAIL("clear re-enabled the cache");
+  } else {
+    PASS();
+  }
+}
+
+static void test_zero_state_disabled(void) {
+  TEST("Zero-initialised cache starts disabled");
+
+  key_cache_t fresh;
+  memset(&fresh, 0, sizeof(fresh));
+  key_cache_tag_t tag;
+  uint8_t key[KEY_CACHE_KEY_SIZE];
+  memset(&tag, 0, sizeof(tag));
+  memset(key, 0x33, sizeof(key));
+  key_cache_store(&fresh, &tag, 0, key);
+
+  if (key_cache_lookup(&fresh, &tag, 0, key)) {
+    FAIL("zero state cached a key");
+  } else {
+    PASS();
+  }
+}
+
+/* ---------- Benchmark ---------- */
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void bench_lookup(void) {
+  char id[16];
+  start_session(8);
+  for (int i = 0; i < KEY_CACHE_SLOTS; i++) {
+    snprintf(id, sizeof(id), "id%d", i);
+    put("correct horse battery staple", id, (uint8_t)i);
+  }
+
+  const int iters = 100000;
+  volatile int hits = 0;
+  uint8_t key[KEY_CACHE_KEY_SIZE];
+  key_cache_tag_t tag;
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++) {
+    tag_for("correct horse battery staple", "id7", &tag);
+    hits += key_cache_lookup(&cache, &tag, ITERATIONS, key);
+  }
+  double t1 = now_ms();
+  (void)hits;
+  printf("\nBenchmark:\n");
+  printf("  Tag + lookup, full cache: %.2f us\n\n",
+         (t1 - t0) * 1000.0 / iters);
+}
+
+int main(void) {
+  printf("=== Key Cache Tests ===\n\n");
+
+  test_hit_and_miss();
+  test_same_entry_replaced();
+  test_lru_eviction();
+  test_clear_rotates_nonce();
+  test_disabled();
+  test_zero_state_disabled();
+
+  bench_lookup();
+  key_cache_disable(&cache);
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+#ifndef MESSAGE_SIGN_H
+#define MESSAGE_SIGN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bitcoin message signing: legacy signmessage and BIP322 simple
+ *
+ * Everything up to the elliptic curve operations: parsing sign and verify
+ * requests, the hashes to sign, BIP137 compact signature headers and the
+ * BIP322 witness encoding. The caller signs and verifies the hashes with
+ * its own secp256k1 and does the base64.
+ *
+ * Legacy signatures commit to SHA256d("\x18Bitcoin Signed Message:\n" ||
+ * varint(len) || message). BIP322 simple signatures spend a virtual
+ * output paying to the address; the signed hash is the BIP143 (P2WPKH) or
+ * BIP341 key path (P2TR) sighash of that spend.
+ */
+
+#define MESSAGE_SIGN_HASH_LEN 32
+#define MESSAGE_SIGN_MAX_PATH 10
+#define MESSAGE_SIGN_LEGACY_SIG_LEN 65 // Header byte and 64-byte compact
+#define MESSAGE_SIGN_MAX_WITNESS_ITEMS 2
+
+typedef enum {
+  MESSAGE_SIGN_OK = 0,
+  MESSAGE_SIGN_ERR_INVALID_ARG = -1,
+  MESSAGE_SIGN_ERR_BUFFER = -2, // Output buffer too small
+  MESSAGE_SIGN_ERR_FORMAT = -3, // Malformed request, path or witness
+} message_sign_error_t;
+
+typedef enum {
+  MESSAGE_SIGN_SCRIPT_UNKNOWN,
+  MESSAGE_SIGN_SCRIPT_P2PKH,
+  MESSAGE_SIGN_SCRIPT_P2SH_P2WPKH,
+  MESSAGE_SIGN_SCRIPT_P2WPKH,
+  MESSAGE_SIGN_SCRIPT_P2TR,
+} message_sign_script_t;
+
+/**
+ * @brief A message to sign
+ *
+ * Either plain text (the whole QR is the message) or the
+ * "signmessage <path> ascii:<message>" convention, where the path may
+ * mark hardened steps with h or '.
+ */
+typedef struct {
+  const char *message; // Points into the parsed text, not terminated
+  size_t message_len;
+  uint32_t path[MESSAGE_SIGN_MAX_PATH];
+  size_t path_len; // 0 when the request names no path
+} message_sign_request_t;
+
+/**
+ * @brief A signed message to verify, in the armored form wallets export:
+ *
+ *   -----BEGIN BITCOIN SIGNED MESSAGE-----
+ *   <message>
+ *   -----BEGIN SIGNATURE-----
+ *   <address>
+ *   <base64 signature>
+ *   -----END BITCOIN SIGNED MESSAGE-----
+ *
+ * All fields point into the parsed text and are not terminated.
+ */
+typedef struct {
+  const char *message;
+  size_t message_len;
+  const char *address;
+  size_t address_len;
+  const char *signature;
+  size_t signature_len;
+} message_sign_signed_t;
+
+/** @brief Decoded BIP322 witness stack; items point into the input */
+typedef struct {
+  const uint8_t *items[MESSAGE_SIGN_MAX_WITNESS_ITEMS];
+  size_t lens[MESSAGE_SIGN_MAX_WITNESS_ITEMS];
+  size_t count;
+} message_sign_witness_t;
+
+/** @brief Parse a scanned sign request */
+message_sign_error_t message_sign_parse_request(const char *text, size_t len,
+                                                message_sign_request_t *req);
+
+/** @brief Parse an armored signed message */
+message_sign_error_t message_sign_parse_signed(const char *text, size_t len,
+                                               message_sign_signed_t *out);
+
+/**
+ * @brief Format a path as "m/84'/0'/0'/0/0"
+ * @return Length written, or 0 if out is too small
+ */
+size_t message_sign_format_path(const uint32_t *path, size_t path_len,
+                                char *out, size_t out_len);
+
+/** @brief Single-key script type of a scriptPubKey */
+message_sign_script_t message_sign_script_type(const uint8_t *script,
+                                               size_t script_len);
+
+/** @brief Hash signed by a legacy signmessage signature */
+void message_sign_legacy_hash(const uint8_t *message, size_t len,
+                              uint8_t out[MESSAGE_SIGN_HASH_LEN]);
+
+/**
+ * @brief BIP137 header byte of a compressed-key compact signature
+ * @param recid Recovery id (0 to 3)
+ * @return Header, or 0 for P2TR and unknown scripts
+ */
+uint8_t message_sign_legacy_header(message_sign_script_t type, uint8_t recid);
+
+/**
+ * @brief Split a BIP137 header byte (27 to 42)
+ * @param type Receives P2PKH for both the uncompressed and compressed ranges
+ * @return false if the header is out of range
+ */
+bool message_sign_legacy_parse_header(uint8_t header, uint8_t *recid,
+                                      bool *compressed,
+                                      message_sign_script_t *type);
+
+/** @brief BIP322 tagged message hash */
+void message_sign_bip322_hash(const uint8_t *message, size_t len,
+                              uint8_t out[MESSAGE_SIGN_HASH_LEN]);
+
+/**
+ * @brief Ids of the BIP322 to_spend and to_sign transactions, internal
+ * byte order (the BIP lists them for its vectors)
+ */
+void message_sign_bip322_txids(const uint8_t *script, size_t script_len,
+                               const uint8_t *message, size_t len,
+                               uint8_t to_spend[MESSAGE_SIGN_HASH_LEN],
+                               uint8_t to_sign[MESSAGE_SIGN_HASH_LEN]);
+
+/**
+ * @brief Hash a BIP322 simple signature signs
+ *
+ * @param script scriptPubKey of the address, P2WPKH or P2TR
+ * @param sighash_type SIGHASH_ALL (1) for P2WPKH; DEFAULT (0) or ALL for
+ *                     P2TR
+ * @return false for other scripts or types, or on allocation failure
+ */
+bool message_sign_bip322_sighash(const uint8_t *script, size_t script_len,
+                                 const uint8_t *message, size_t len,
+                                 uint8_t sighash_type,
+                                 uint8_t out[MESSAGE_SIGN_HASH_LEN]);
+
+/**
+ * @brief Serialize a witness stack (the BIP322 simple signature before
+ * base64)
+ * @return Length written, or 0 if out is too small or an item is too long
+ */
+size_t message_sign_bip322_witness(const uint8_t *const *items,
+                                   const size_t *lens, size_t count,
+                                   uint8_t *out, size_t out_len);
+
+/** @brief Decode a serialized witness stack of up to two items */
+message_sign_error_t
+message_sign_bip322_parse_witness(const uint8_t *in, size_t len,
+                                  message_sign_witness_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MESSAGE_SIGN_H
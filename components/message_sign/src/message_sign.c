@@ -0,0 +1,469 @@
+/*
+ * Bitcoin message signing: legacy signmessage and BIP322 simple
+ */
+
+#include "message_sign.h"
+#include "segwit_sighash.h"
+
+#include <sha2.h>
+#include <string.h>
+
+#define HARDENED 0x80000000u
+
+#define OP_0 0x00
+#define OP_1 0x51
+#define OP_RETURN 0x6a
+#define OP_DUP 0x76
+#define OP_HASH160 0xa9
+#define OP_EQUAL 0x87
+#define OP_EQUALVERIFY 0x88
+#define OP_CHECKSIG 0xac
+
+// BIP137 header ranges, each four recovery ids wide
+#define HEADER_P2PKH_UNCOMPRESSED 27
+#define HEADER_P2PKH 31
+#define HEADER_P2SH_P2WPKH 35
+#define HEADER_P2WPKH 39
+#define HEADER_END 43
+
+static const char sign_prefix[] = "signmessage ";
+static const char ascii_prefix[] = "ascii:";
+static const char armor_begin[] = "-----BEGIN BITCOIN SIGNED MESSAGE-----";
+// Electrum writes the first marker, Sparrow the second
+static const char *const armor_signature[] = {
+    "-----BEGIN SIGNATURE-----", "-----BEGIN BITCOIN SIGNATURE-----"};
+#define ARMOR_SIGNATURE_COUNT                                                  \
+  (sizeof(armor_signature) / sizeof(armor_signature[0]))
+
+/* ---------- Parsing ---------- */
+
+static bool starts_with(const char *text, size_t len, const char *prefix) {
+  size_t n = strlen(prefix);
+  return len >= n && memcmp(text, prefix, n) == 0;
+}
+
+static bool parse_path(const char *p, size_t len, uint32_t *path,
+                       size_t *depth_out) {
+  if (starts_with(p, len, "m/")) {
+    p += 2;
+    len -= 2;
+  }
+
+  size_t depth = 0;
+  size_t i = 0;
+  while (i < len) {
+    if (depth == MESSAGE_SIGN_MAX_PATH || p[i] < '0' || p[i] > '9')
+      return false;
+    uint64_t value = 0;
+    while (i < len && p[i] >= '0' && p[i] <= '9') {
+      value = value * 10 + (uint64_t)(p[i++] - '0');
+      if (value >= HARDENED)
+        return false;
+    }
+    if (i < len && (p[i] == 'h' || p[i] == 'H' || p[i] == '\'')) {
+      value |= HARDENED;
+      i++;
+    }
+    path[depth++] = (uint32_t)value;
+    if (i < len && p[i++] != '/')
+      return false;
+    if (i == len && p[i - 1] == '/')
+      return false;
+  }
+  *depth_out = depth;
+  return depth > 0;
+}
+
+message_sign_error_t message_sign_parse_request(const char *text, size_t len,
+                                                message_sign_request_t *req) {
+  if (!text || !req)
+    return MESSAGE_SIGN_ERR_INVALID_ARG;
+  memset(req, 0, sizeof(*req));
+  if (len == 0)
+    return MESSAGE_SIGN_ERR_FORMAT;
+
+  if (!starts_with(text, len, sign_prefix)) {
+    req->message = text;
+    req->message_len = len;
+    return MESSAGE_SIGN_OK;
+  }
+
+  const char *p = text + strlen(sign_prefix);
+  const char *end = text + len;
+  const char *space = memchr(p, ' ', (size_t)(end - p));
+  if (!space || !parse_path(p, (size_t)(space - p), req->path, &req->path_len))
+    return MESSAGE_SIGN_ERR_FORMAT;
+
+  p = space + 1;
+  if (!starts_with(p, (size_t)(end - p), ascii_prefix)) {
+    req->path_len = 0;
+    return MESSAGE_SIGN_ERR_FORMAT;
+  }
+  p += strlen(ascii_prefix);
+  req->message = p;
+  req->message_len = (size_t)(end - p);
+  return MESSAGE_SIGN_OK;
+}
+
+// Next line of [*p, end) without its line ending; advances *p past it
+static size_t next_line(const char **p, const char *end, const char **line) {
+  const char *nl = memchr(*p, '\n', (size_t)(end - *p));
+  const char *stop = nl ? nl : end;
+  *line = *p;
+  size_t n = (size_t)(stop - *p);
+  if (n > 0 && (*p)[n - 1] == '\r')
+    n--;
+  *p = nl ? nl + 1 : end;
+  return n;
+}
+
+static void trim(const char **s, size_t *n) {
+  while (*n > 0 && (**s == ' ' || **s == '\t')) {
+    (*s)++;
+    (*n)--;
+  }
+  while (*n > 0 && ((*s)[*n - 1] == ' ' || (*s)[*n - 1] == '\t'))
+    (*n)--;
+}
+
+// Next non-blank line, trimmed; 0 at the end of the text
+static size_t next_field(const char **p, const char *end, const char **line) {
+  while (*p < end) {
+    size_t n = next_line(p, end, line);
+    trim(line, &n);
+    if (n > 0)
+      return n;
+  }
+  return 0;
+}
+
+message_sign_error_t message_sign_parse_signed(const char *text, size_t len,
+                                               message_sign_signed_t *out) {
+  if (!text || !out)
+    return MESSAGE_SIGN_ERR_INVALID_ARG;
+  memset(out, 0, sizeof(*out));
+
+  const char *p = text;
+  const char *end = text + len;
+  const char *line;
+  size_t n = next_field(&p, end, &line);
+  if (n != strlen(armor_begin) || memcmp(line, armor_begin, n) != 0)
+    return MESSAGE_SIGN_ERR_FORMAT;
+
+  // The message runs up to the signature marker line, whatever it contains
+  const char *message = p;
+  for (;;) {
+    if (p >= end)
+      return MESSAGE_SIGN_ERR_FORMAT;
+    const char *line_start = p;
+    n = next_line(&p, end, &line);
+    bool marker = false;
+    for (size_t i = 0; i < ARMOR_SIGNATURE_COUNT; i++) {
+      marker = marker || (n == strlen(armor_signature[i]) &&
+                          memcmp(line, armor_signature[i], n) == 0);
+    }
+    if (marker) {
+      size_t message_len = (size_t)(line_start - message);
+      // Drop the line ending before the marker
+      if (message_len > 0 && message[message_len - 1] == '\n')
+        message_len--;
+      if (message_len > 0 && message[message_len - 1] == '\r')
+        message_len--;
+      out->message = message;
+      out->message_len = message_len;
+      break;
+    }
+  }
+
+  out->address_len = next_field(&p, end, &out->address);
+  out->signature_len = next_field(&p, end, &out->signature);
+  if (out->address_len == 0 || out->signature_len == 0 ||
+      out->address[0] == '-' || out->signature[0] == '-') {
+    memset(out, 0, sizeof(*out));
+    return MESSAGE_SIGN_ERR_FORMAT;
+  }
+  return MESSAGE_SIGN_OK;
+}
+
+size_t message_sign_format_path(const uint32_t *path, size_t path_len,
+                                char *out, size_t out_len) {
+  if (!path || !out || out_len < 2)
+    return 0;
+
+  size_t n = 0;
+  out[n++] = 'm';
+  for (size_t i = 0; i < path_len; i++) {
+    char digits[10];
+    size_t d = 0;
+    uint32_t v = path[i] & ~HARDENED;
+    do {
+      digits[d++] = (char)('0' + v % 10);
+      v /= 10;
+    } while (v);
+    size_t need = 1 + d + (path[i] & HARDENED ? 1 : 0);
+    if (n + need + 1 > out_len)
+      return 0;
+    out[n++] = '/';
+    while (d)
+      out[n++] = digits[--d];
+    if (path[i] & HARDENED)
+      out[n++] = '\'';
+  }
+  out[n] = '\0';
+  return n;
+}
+
+/* ---------- Hashes ---------- */
+
+message_sign_script_t message_sign_script_type(const uint8_t *script,
+                                               size_t script_len) {
+  if (!script)
+    return MESSAGE_SIGN_SCRIPT_UNKNOWN;
+  if (script_len == 25 && script[0] == OP_DUP && script[1] == OP_HASH160 &&
+      script[2] == 20 && script[23] == OP_EQUALVERIFY &&
+      script[24] == OP_CHECKSIG)
+    return MESSAGE_SIGN_SCRIPT_P2PKH;
+  if (script_len == 23 && script[0] == OP_HASH160 && script[1] == 20 &&
+      script[22] == OP_EQUAL)
+    return MESSAGE_SIGN_SCRIPT_P2SH_P2WPKH;
+  if (script_len == 22 && script[0] == OP_0 && script[1] == 20)
+    return MESSAGE_SIGN_SCRIPT_P2WPKH;
+  if (script_len == 34 && script[0] == OP_1 && script[1] == 32)
+    return MESSAGE_SIGN_SCRIPT_P2TR;
+  return MESSAGE_SIGN_SCRIPT_UNKNOWN;
+}
+
+static size_t write_varint(uint8_t *out, uint64_t v) {
+  if (v < 0xfd) {
+    out[0] = (uint8_t)v;
+    return 1;
+  }
+  size_t width = v <= 0xffff ? 2 : v <= 0xffffffffu ? 4 : 8;
+  out[0] = width == 2 ? 0xfd : width == 4 ? 0xfe : 0xff;
+  for (size_t i = 0; i < width; i++)
+    out[1 + i] = (uint8_t)(v >> (8 * i));
+  return 1 + width;
+}
+
+static void sha256d_final(sha2_256_ctx *ctx, uint8_t out[32]) {
+  sha2_256_final(ctx, out);
+  sha2_256_init(ctx);
+  sha2_256_update(ctx, out, 32);
+  sha2_256_final(ctx, out);
+}
+
+void message_sign_legacy_hash(const uint8_t *message, size_t len,
+                              uint8_t out[MESSAGE_SIGN_HASH_LEN]) {
+  static const char magic[] = "\x18"
+                              "Bitcoin Signed Message:\n";
+  uint8_t varint[9];
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, (const uint8_t *)magic, sizeof(magic) - 1);
+  sha2_256_update(&ctx, varint, write_varint(varint, len));
+  if (len)
+    sha2_256_update(&ctx, message, len);
+  sha256d_final(&ctx, out);
+}
+
+uint8_t message_sign_legacy_header(message_sign_script_t type, uint8_t recid) {
+  if (recid > 3)
+    return 0;
+  switch (type) {
+  case MESSAGE_SIGN_SCRIPT_P2PKH:
+    return HEADER_P2PKH + recid;
+  case MESSAGE_SIGN_SCRIPT_P2SH_P2WPKH:
+    return HEADER_P2SH_P2WPKH + recid;
+  case MESSAGE_SIGN_SCRIPT_P2WPKH:
+    return HEADER_P2WPKH + recid;
+  default:
+    return 0;
+  }
+}
+
+bool message_sign_legacy_parse_header(uint8_t header, uint8_t *recid,
+                                      bool *compressed,
+                                      message_sign_script_t *type) {
+  if (header < HEADER_P2PKH_UNCOMPRESSED || header >= HEADER_END)
+    return false;
+  if (recid)
+    *recid = (header - HEADER_P2PKH_UNCOMPRESSED) & 3;
+  if (compressed)
+    *compressed = header >= HEADER_P2PKH;
+  if (type) {
+    *type = header >= HEADER_P2WPKH        ? MESSAGE_SIGN_SCRIPT_P2WPKH
+            : header >= HEADER_P2SH_P2WPKH ? MESSAGE_SIGN_SCRIPT_P2SH_P2WPKH
+                                           : MESSAGE_SIGN_SCRIPT_P2PKH;
+  }
+  return true;
+}
+
+void message_sign_bip322_hash(const uint8_t *message, size_t len,
+                              uint8_t out[MESSAGE_SIGN_HASH_LEN]) {
+  static const char tag[] = "BIP0322-signed-message";
+  uint8_t tag_hash[32];
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, (const uint8_t *)tag, sizeof(tag) - 1);
+  sha2_256_final(&ctx, tag_hash);
+
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, tag_hash, sizeof(tag_hash));
+  sha2_256_update(&ctx, tag_hash, sizeof(tag_hash));
+  if (len)
+    sha2_256_update(&ctx, message, len);
+  sha2_256_final(&ctx, out);
+}
+
+/*
+ * to_spend: version 0, locktime 0, one input spending 0000...:0xffffffff
+ * with scriptSig OP_0 PUSH32(message hash) and sequence 0, one output of
+ * 0 sat paying to the address.
+ */
+static void to_spend_txid(const uint8_t *script, size_t script_len,
+                          const uint8_t *message, size_t len,
+                          uint8_t out[32]) {
+  uint8_t buf[64];
+  uint8_t hash[32];
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+
+  memset(buf, 0, 5);
+  buf[4] = 1; // Version 0, one input
+  sha2_256_update(&ctx, buf, 5);
+  memset(buf, 0, 32);
+  memset(buf + 32, 0xff, 4);
+  sha2_256_update(&ctx, buf, 36);
+
+  message_sign_bip322_hash(message, len, hash);
+  buf[0] = 34;
+  buf[1] = OP_0;
+  buf[2] = 32;
+  memcpy(buf + 3, hash, 32);
+  memset(buf + 35, 0, 4); // Sequence
+  buf[39] = 1;            // One output
+  memset(buf + 40, 0, 8); // Value
+  size_t n = 48 + write_varint(buf + 48, script_len);
+  sha2_256_update(&ctx, buf, n);
+  sha2_256_update(&ctx, script, script_len);
+  memset(buf, 0, 4); // Locktime
+  sha2_256_update(&ctx, buf, 4);
+  sha256d_final(&ctx, out);
+}
+
+void message_sign_bip322_txids(const uint8_t *script, size_t script_len,
+                               const uint8_t *message, size_t len,
+                               uint8_t to_spend[MESSAGE_SIGN_HASH_LEN],
+                               uint8_t to_sign[MESSAGE_SIGN_HASH_LEN]) {
+  to_spend_txid(script, script_len, message, len, to_spend);
+
+  // to_sign without its witness: spends to_spend:0, pays 0 sat to
+  // OP_RETURN
+  uint8_t buf[64];
+  memset(buf, 0, sizeof(buf));
+  buf[4] = 1;
+  memcpy(buf + 5, to_spend, 32);
+  // Index 0, empty scriptSig, sequence 0
+  buf[46] = 1; // One output, value 0
+  buf[55] = 1;
+  buf[56] = OP_RETURN;
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, buf, 61); // Locktime 0
+  sha256d_final(&ctx, to_sign);
+}
+
+bool message_sign_bip322_sighash(const uint8_t *script, size_t script_len,
+                                 const uint8_t *message, size_t len,
+                                 uint8_t sighash_type,
+                                 uint8_t out[MESSAGE_SIGN_HASH_LEN]) {
+  message_sign_script_t type = message_sign_script_type(script, script_len);
+  if (type == MESSAGE_SIGN_SCRIPT_P2WPKH) {
+    if (sighash_type != SEGWIT_SIGHASH_ALL)
+      return false;
+  } else if (type == MESSAGE_SIGN_SCRIPT_P2TR) {
+    if (sighash_type != SEGWIT_SIGHASH_DEFAULT &&
+        sighash_type != SEGWIT_SIGHASH_ALL)
+      return false;
+  } else {
+    return false;
+  }
+
+  uint8_t to_spend[32];
+  to_spend_txid(script, script_len, message, len, to_spend);
+
+  static const uint8_t op_return = OP_RETURN;
+  segwit_sighash_t *cache = segwit_sighash_create(0, 0);
+  if (!cache)
+    return false;
+  segwit_sighash_add_input(cache, to_spend, 0, 0);
+  segwit_sighash_add_spent_output(cache, 0, script, script_len);
+  segwit_sighash_add_output(cache, 0, &op_return, 1);
+  segwit_sighash_finalize(cache);
+
+  bool ok;
+  if (type == MESSAGE_SIGN_SCRIPT_P2WPKH) {
+    // scriptCode of P2WPKH is the P2PKH script of the key hash
+    uint8_t script_code[25] = {OP_DUP, OP_HASH160, 20};
+    memcpy(script_code + 3, script + 2, 20);
+    script_code[23] = OP_EQUALVERIFY;
+    script_code[24] = OP_CHECKSIG;
+    ok = segwit_sighash_input(cache, to_spend, 0, 0, script_code,
+                              sizeof(script_code), 0, sighash_type, out);
+  } else {
+    ok = segwit_sighash_taproot_input(cache, 0, sighash_type, out);
+  }
+  segwit_sighash_destroy(cache);
+  return ok;
+}
+
+/* ---------- Witness ---------- */
+
+size_t message_sign_bip322_witness(const uint8_t *const *items,
+                                   const size_t *lens, size_t count,
+                                   uint8_t *out, size_t out_len) {
+  if (!items || !lens || !out || count == 0 || count >= 0xfd)
+    return 0;
+
+  size_t n = 0;
+  if (out_len < 1)
+    return 0;
+  out[n++] = (uint8_t)count;
+  for (size_t i = 0; i < count; i++) {
+    if (lens[i] >= 0xfd || out_len - n < 1 + lens[i])
+      return 0;
+    out[n++] = (uint8_t)lens[i];
+    memcpy(out + n, items[i], lens[i]);
+    n += lens[i];
+  }
+  return n;
+}
+
+message_sign_error_t
+message_sign_bip322_parse_witness(const uint8_t *in, size_t len,
+                                  message_sign_witness_t *out) {
+  if (!in || !out)
+    return MESSAGE_SIGN_ERR_INVALID_ARG;
+  memset(out, 0, sizeof(*out));
+
+  // Simple signatures hold a signature and at most a key, all short
+  if (len < 1 || in[0] == 0 || in[0] > MESSAGE_SIGN_MAX_WITNESS_ITEMS)
+    return MESSAGE_SIGN_ERR_FORMAT;
+  size_t count = in[0];
+  size_t n = 1;
+  for (size_t i = 0; i < count; i++) {
+    if (n >= len || in[n] >= 0xfd || len - n - 1 < in[n]) {
+      memset(out, 0, sizeof(*out));
+      return MESSAGE_SIGN_ERR_FORMAT;
+    }
+    out->lens[i] = in[n++];
+    out->items[i] = in + n;
+    n += out->lens[i];
+  }
+  if (n != len) {
+    memset(out, 0, sizeof(*out));
+    return MESSAGE_SIGN_ERR_FORMAT;
+  }
+  out->count = count;
+  return MESSAGE_SIGN_OK;
+}
@@ -0,0 +1,440 @@
+/*
+ * Message Signing Test Suite
+ * Compile with: make
+ * Run: ./test_message_sign
+ *
+ * BIP322 message hashes, transaction ids and signatures are the vectors
+ * from BIP322. The sighashes were checked with an independent Python
+ * implementation by verifying the BIP's ECDSA and Schnorr signatures
+ * against them; the legacy hashes come from the same script.
+ */
+
+#include "message_sign.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static size_t from_hex(const char *hex, uint8_t *out) {
+  size_t n = strlen(hex) / 2;
+  for (size_t i = 0; i < n; i++) {
+    unsigned v;
+    sscanf(hex + i * 2, "%2x", &v);
+    out[i] = (uint8_t)v;
+  }
+  return n;
+}
+
+static bool equals_hex(const uint8_t *bytes, size_t len, const char *hex) {
+  uint8_t expected[128];
+  return from_hex(hex, expected) == len && memcmp(bytes, expected, len) == 0;
+}
+
+// Transaction ids are listed in display order, the reverse of internal
+static bool txid_equals_hex(const uint8_t *txid, const char *hex) {
+  uint8_t reversed[32];
+  for (int i = 0; i < 32; i++)
+    reversed[i] = txid[31 - i];
+  return equals_hex(reversed, 32, hex);
+}
+
+static bool span_equals(const char *s, size_t len, const char *expected) {
+  return len == strlen(expected) && memcmp(s, expected, len) == 0;
+}
+
+#define HELLO "Hello World"
+#define HELLO_LEN (sizeof(HELLO) - 1)
+
+// bc1q9vza2e8x573nczrlzms0wvx3gsqjx7vavgkx0l
+static const char *p2wpkh_script =
+    "00142b05d564e6a7a33c087f16e0f730d1440123799d";
+// bc1ppv609nr0vr25u07u95waq5lucwfm6tde4nydujnu8npg4q75mr5sxq8lt3
+static const char *p2tr_script =
+    "51200b34f2cc6f60d54e3fdc2d1dd053fcc393bd2db9acc8de4a7c3cc28a83d4d8e9";
+
+/* ---------- Tests ---------- */
+
+static void test_bip322_vectors(void) {
+  TEST("BIP322 message hashes and transaction ids");
+
+  uint8_t script[34];
+  size_t script_len = from_hex(p2wpkh_script, script);
+  uint8_t hash[32], to_spend[32], to_sign[32];
+  bool ok = true;
+
+  message_sign_bip322_hash(NULL, 0, hash);
+  ok = ok && equals_hex(hash, 32,
+                        "c90c269c4f8fcbe6880f72a721ddfbf1914268a794cbb21cfa"
+                        "fee13770ae19f1");
+  message_sign_bip322_hash((const uint8_t *)HELLO, HELLO_LEN, hash);
+  ok = ok && equals_hex(hash, 32,
+                        "f0eb03b1a75ac6d9847f55c624a99169b5dccba2a31f5b23be"
+                        "a77ba270de0a7a");
+
+  message_sign_bip322_txids(script, script_len, NULL, 0, to_spend, to_sign);
+  ok = ok && txid_equals_hex(to_spend, "c5680aa69bb8d860bf82d4e9cd3504b55dde"
+                                       "018de765a91bb566283c545a99a7");
+  ok = ok && txid_equals_hex(to_sign, "1e9654e951a5ba44c8604c4de6c67fd78a27e"
+                                      "81dcadcfe1edf638ba3aaebaed6");
+
+  message_sign_bip322_txids(script, script_len, (const uint8_t *)HELLO,
+                            HELLO_LEN, to_spend, to_sign);
+  ok = ok && txid_equals_hex(to_spend, "b79d196740ad5217771c1098fc4a4b51e053"
+                                       "5c32236c71f1ea4d61a2d603352b");
+  ok = ok && txid_equals_hex(to_sign, "88737ae86f2077145f93cc4b153ae9a1cb8d5"
+                                      "6afa511988c149c5c8c9d93bddf");
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("hash or txid mismatch");
+  }
+}
+
+static void test_bip322_sighash(void) {
+  TEST("BIP322 sighashes (P2WPKH, P2TR)");
+
+  uint8_t script[34];
+  size_t script_len = from_hex(p2wpkh_script, script);
+  uint8_t hash[32];
+  bool ok = true;
+
+  ok = ok && message_sign_bip322_sighash(script, script_len, NULL, 0, 1, hash);
+  ok = ok && equals_hex(hash, 32,
+                        "a3c9a960285a7e9320dae83b3be680c04e5599b3356d0f3fc1"
+                        "1b82cb84ec4f0b");
+  ok = ok && message_sign_bip322_sighash(script, script_len,
+                                         (const uint8_t *)HELLO, HELLO_LEN, 1,
+                                         hash);
+  ok = ok && equals_hex(hash, 32,
+                        "af8a0cd31d9b0976e2aab2b82974c4388c4a3532b2ef828b96"
+                        "f14039ca372c14");
+  // P2WPKH signs with SIGHASH_ALL only
+  ok = ok && !message_sign_bip322_sighash(script, script_len, NULL, 0, 0, hash);
+
+  // The BIP's taproot signature carries an explicit SIGHASH_ALL
+  script_len = from_hex(p2tr_script, script);
+  ok = ok && message_sign_bip322_sighash(script, script_len,
+                                         (const uint8_t *)HELLO, HELLO_LEN, 1,
+                                         hash);
+  ok = ok && equals_hex(hash, 32,
+                        "3c32825d6b1de7ec928033cbad24e7bfe51aeb16a493c76fbf"
+                        "59dd7b445ded22");
+  uint8_t hash_default[32];
+  ok = ok && message_sign_bip322_sighash(script, script_len,
+                                         (const uint8_t *)HELLO, HELLO_LEN, 0,
+                                         hash_default);
+  ok = ok && memcmp(hash, hash_default, 32) != 0;
+
+  // Legacy scripts have no BIP322 simple signature
+  script_len = from_hex("76a9142b05d564e6a7a33c087f16e0f730d1440123799d88ac",
+                        script);
+  ok = ok && !message_sign_bip322_sighash(script, script_len, NULL, 0, 1, hash);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("sighash mismatch");
+  }
+}
+
+static void test_bip322_witness(void) {
+  TEST("BIP322 witness encode and decode");
+
+  // Signature of "" from the BIP, base64 decoded
+  static const char *sig_hex =
+      "024730440220336801010aaf657d79662cac98a990a43ac6f376af2c84f8f76401cc"
+      "b9d0231602201693a4e683db4a91944ca5cb11527840366daf583a2c695fccf8e934"
+      "83b52e34012102c7f12003196442943d8588e01aee840423cc54fc1521526a3b85c2"
+      "b0cbd58872";
+  uint8_t sig[128];
+  size_t sig_len = from_hex(sig_hex, sig);
+  message_sign_witness_t w;
+  bool ok = message_sign_bip322_parse_witness(sig, sig_len, &w) ==
+            MESSAGE_SIGN_OK;
+  ok = ok && w.count == 2 && w.lens[0] == 71 && w.lens[1] == 33;
+  ok = ok && w.items[0][0] == 0x30 && w.items[0][70] == 0x01;
+  ok = ok && equals_hex(w.items[1], w.lens[1],
+                        "02c7f12003196442943d8588e01aee840423cc54fc1521526a"
+                        "3b85c2b0cbd58872");
+
+  uint8_t out[128];
+  size_t n = ok ? message_sign_bip322_witness(w.items, w.lens, w.count, out,
+                                              sizeof(out))
+                : 0;
+  ok = ok && n == sig_len && memcmp(out, sig, n) == 0;
+  ok = ok && message_sign_bip322_witness(w.items, w.lens, w.count, out,
+                                         sig_len - 1) == 0;
+
+  // Truncated, trailing bytes, too many items
+  ok = ok && message_sign_bip322_parse_witness(sig, sig_len - 1, &w) ==
+                 MESSAGE_SIGN_ERR_FORMAT;
+  sig[sig_len] = 0;
+  ok = ok && message_sign_bip322_parse_witness(sig, sig_len + 1, &w) ==
+                 MESSAGE_SIGN_ERR_FORMAT;
+  sig[0] = 3;
+  ok = ok && message_sign_bip322_parse_witness(sig, sig_len, &w) ==
+                 MESSAGE_SIGN_ERR_FORMAT;
+  ok = ok && w.count == 0;
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("witness mismatch");
+  }
+}
+
+static void test_legacy(void) {
+  TEST("Legacy message hash and BIP137 headers");
+
+  uint8_t hash[32];
+  bool ok = true;
+  message_sign_legacy_hash((const uint8_t *)HELLO, HELLO_LEN, hash);
+  ok = ok && equals_hex(hash, 32,
+                        "a7af0baad5ae99b97fc69b3a0d1abcf3ef17f131cc4776e1bc"
+                        "11933ec8550f49");
+  message_sign_legacy_hash(NULL, 0, hash);
+  ok = ok && equals_hex(hash, 32,
+                        "80e795d4a4caadd7047af389d9f7f220562feb6196032e2131"
+                        "e10563352c4bcc");
+  // Over 252 bytes the length takes a three-byte varint
+  uint8_t long_msg[300];
+  memset(long_msg, 'a', sizeof(long_msg));
+  message_sign_legacy_hash(long_msg, sizeof(long_msg), hash);
+  ok = ok && equals_hex(hash, 32,
+                        "3ec158a43b80359df647352dac1d37dbf26a94e5f06e579076"
+                        "0290c75cd11dc0");
+
+  ok = ok && message_sign_legacy_header(MESSAGE_SIGN_SCRIPT_P2PKH, 1) == 32;
+  ok = ok &&
+       message_sign_legacy_header(MESSAGE_SIGN_SCRIPT_P2SH_P2WPKH, 0) == 35;
+  ok = ok && message_sign_legacy_header(MESSAGE_SIGN_SCRIPT_P2WPKH, 3) == 42;
+  ok = ok && message_sign_legacy_header(MESSAGE_SIGN_SCRIPT_P2TR, 0) == 0;
+  ok = ok && message_sign_legacy_header(MESSAGE_SIGN_SCRIPT_P2PKH, 4) == 0;
+
+  uint8_t recid = 0;
+  bool compressed = true;
+  message_sign_script_t type = MESSAGE_SIGN_SCRIPT_UNKNOWN;
+  ok = ok && message_sign_legacy_parse_header(28, &recid, &compressed, &type);
+  ok = ok && recid == 1 && !compressed && type == MESSAGE_SIGN_SCRIPT_P2PKH;
+  ok = ok && message_sign_legacy_parse_header(37, &recid, &compressed, &type);
+  ok = ok && recid == 2 && compressed &&
+       type == MESSAGE_SIGN_SCRIPT_P2SH_P2WPKH;
+  ok = ok && message_sign_legacy_parse_header(39, &recid, &compressed, &type);
+  ok = ok && recid == 0 && type == MESSAGE_SIGN_SCRIPT_P2WPKH;
+  ok = ok && !message_sign_legacy_parse_header(26, NULL, NULL, NULL);
+  ok = ok && !message_sign_legacy_parse_header(43, NULL, NULL, NULL);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("legacy mismatch");
+  }
+}
+
+static void test_script_type(void) {
+  TEST("Script types");
+
+  uint8_t script[40];
+  bool ok = true;
+  size_t n = from_hex(p2wpkh_script, script);
+  ok = ok && message_sign_script_type(script, n) == MESSAGE_SIGN_SCRIPT_P2WPKH;
+  n = from_hex(p2tr_script, script);
+  ok = ok && message_sign_script_type(script, n) == MESSAGE_SIGN_SCRIPT_P2TR;
+  n = from_hex("76a9142b05d564e6a7a33c087f16e0f730d1440123799d88ac", script);
+  ok = ok && message_sign_script_type(script, n) == MESSAGE_SIGN_SCRIPT_P2PKH;
+  n = from_hex("a9142b05d564e6a7a33c087f16e0f730d1440123799d87", script);
+  ok = ok &&
+       message_sign_script_type(script, n) == MESSAGE_SIGN_SCRIPT_P2SH_P2WPKH;
+  // P2WSH
+  n = from_hex("00200b34f2cc6f60d54e3fdc2d1dd053fcc393bd2db9acc8de4a7c3cc28a"
+               "83d4d8e9",
+               script);
+  ok = ok &&
+       message_sign_script_type(script, n) == MESSAGE_SIGN_SCRIPT_UNKNOWN;
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("wrong type");
+  }
+}
+
+static void test_parse_request(void) {
+  TEST("Sign request parsing");
+
+  message_sign_request_t req;
+  char path[64];
+  bool ok = true;
+
+  const char *plain = "I own this address";
+  ok = ok && message_sign_parse_request(plain, strlen(plain), &req) ==
+                 MESSAGE_SIGN_OK;
+  ok = ok && req.path_len == 0 &&
+       span_equals(req.message, req.message_len, plain);
+
+  const char *cmd = "signmessage m/84h/0h/0h/0/5 ascii:Hello World, again";
+  ok = ok && message_sign_parse_request(cmd, strlen(cmd), &req) ==
+                 MESSAGE_SIGN_OK;
+  ok = ok && span_equals(req.message, req.message_len, "Hello World, again");
+  ok = ok && req.path_len == 5 && req.path[0] == (84 | 0x80000000u) &&
+       req.path[4] == 5;
+  ok = ok && message_sign_format_path(req.path, req.path_len, path,
+                                      sizeof(path)) == 15 &&
+       strcmp(path, "m/84'/0'/0'/0/5") == 0;
+  ok = ok && message_sign_format_path(req.path, req.path_len, path, 15) == 0;
+
+  // Apostrophes and no m/ prefix
+  const char *quoted = "signmessage 86'/1'/0'/1/0 ascii:x";
+  ok = ok && message_sign_parse_request(quoted, strlen(quoted), &req) ==
+                 MESSAGE_SIGN_OK;
+  ok = ok && req.path_len == 5 && req.path[1] == (1 | 0x80000000u) &&
+       span_equals(req.message, req.message_len, "x");
+
+  static const char *const bad[] = {
+      "signmessage m/84h/0h/0h/0/0 hex:00",  // Only ascii: payloads
+      "signmessage m/84h//0 ascii:x",        // Empty step
+      "signmessage m/84h/0h/ ascii:x",       // Trailing slash
+      "signmessage m/2147483648/0 ascii:x",  // Index over 2^31 - 1
+      "signmessage m/1/2/3/4/5/6/7/8/9/10/11 ascii:x", // Too deep
+      "signmessage m/84x ascii:x",
+      "signmessage m/84h",
+  };
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    ok = ok && message_sign_parse_request(bad[i], strlen(bad[i]), &req) ==
+                   MESSAGE_SIGN_ERR_FORMAT;
+  }
+  ok = ok && message_sign_parse_request("", 0, &req) == MESSAGE_SIGN_ERR_FORMAT;
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("parse mismatch");
+  }
+}
+
+static void test_parse_signed(void) {
+  TEST("Signed message parsing");
+
+  message_sign_signed_t s;
+  bool ok = true;
+
+  // Electrum style, CRLF, message over two lines
+  const char *electrum = "-----BEGIN BITCOIN SIGNED MESSAGE-----\r\n"
+                         "line one\r\n"
+                         "line two\r\n"
+                         "-----BEGIN SIGNATURE-----\r\n"
+                         "bc1q9vza2e8x573nczrlzms0wvx3gsqjx7vavgkx0l\r\n"
+                         "AkcwRAIg\r\n"
+                         "-----END BITCOIN SIGNED MESSAGE-----\r\n";
+  ok = ok && message_sign_parse_signed(electrum, strlen(electrum), &s) ==
+                 MESSAGE_SIGN_OK;
+  ok = ok && span_equals(s.message, s.message_len, "line one\r\nline two");
+  ok = ok && span_equals(s.address, s.address_len,
+                         "bc1q9vza2e8x573nczrlzms0wvx3gsqjx7vavgkx0l");
+  ok = ok && span_equals(s.signature, s.signature_len, "AkcwRAIg");
+
+  // Sparrow style, empty message, no trailer
+  const char *sparrow = "-----BEGIN BITCOIN SIGNED MESSAGE-----\n"
+                        "\n"
+                        "-----BEGIN BITCOIN SIGNATURE-----\n"
+                        "  1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2 \n"
+                        "\n"
+                        "H+abc=\n";
+  ok = ok && message_sign_parse_signed(sparrow, strlen(sparrow), &s) ==
+                 MESSAGE_SIGN_OK;
+  ok = ok && s.message_len == 0;
+  ok = ok && span_equals(s.address, s.address_len,
+                         "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2");
+  ok = ok && span_equals(s.signature, s.signature_len, "H+abc=");
+
+  static const char *const bad[] = {
+      "Hello World",
+      "-----BEGIN BITCOIN SIGNED MESSAGE-----\nHello\n",
+      "-----BEGIN BITCOIN SIGNED MESSAGE-----\nHello\n"
+      "-----BEGIN SIGNATURE-----\naddress\n"
+      "-----END BITCOIN SIGNED MESSAGE-----\n",
+  };
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    ok = ok && message_sign_parse_signed(bad[i], strlen(bad[i]), &s) ==
+                   MESSAGE_SIGN_ERR_FORMAT;
+  }
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("parse mismatch");
+  }
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench(void) {
+  uint8_t script[34];
+  size_t script_len = from_hex(p2tr_script, script);
+  uint8_t *msg = malloc(4096);
+  uint8_t hash[32];
+  volatile uint8_t sink = 0;
+  if (!msg)
+    return;
+  memset(msg, 'm', 4096);
+
+  static const size_t sizes[] = {64, 4096};
+  printf("\nBenchmark (BIP322 P2TR sighash, legacy hash)\n");
+  for (size_t s = 0; s < 2; s++) {
+    const int iterations = 20000;
+    double t0 = now_ms();
+    for (int i = 0; i < iterations; i++) {
+      message_sign_bip322_sighash(script, script_len, msg, sizes[s], 0, hash);
+      sink ^= hash[0];
+    }
+    double t1 = now_ms();
+    for (int i = 0; i < iterations; i++) {
+      message_sign_legacy_hash(msg, sizes[s], hash);
+      sink ^= hash[0];
+    }
+    double t2 = now_ms();
+    printf("  %4zu-byte message: BIP322 %.2f us, legacy %.2f us\n", sizes[s],
+           (t1 - t0) * 1000.0 / iterations, (t2 - t1) * 1000.0 / iterations);
+  }
+  (void)sink;
+  free(msg);
+}
+
+int main(void) {
+  printf("=== Message Signing Tests ===\n\n");
+
+  test_bip322_vectors();
+  test_bip322_sighash();
+  test_bip322_witness();
+  test_legacy();
+  test_script_type();
+  test_parse_request();
+  test_parse_signed();
+
+  bench();
+
+  printf("\nResults: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
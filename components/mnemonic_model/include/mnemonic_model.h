@@ -0,0 +1,97 @@
+#ifndef MNEMONIC_MODEL_H
+#define MNEMONIC_MODEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief BIP39 mnemonic held as 11-bit wordlist indices
+ *
+ * Words are indices into whichever 2048-word list the caller uses, so the
+ * model never sees word strings. The indices pack into the bit string
+ * ENT || CS (ENT = 32 * n / 3 bits, CS = n / 3 bits for n words):
+ *
+ * - checksum validation packs once and hashes the entropy with a single
+ *   SHA-256 (one compression block, at most 32 bytes)
+ * - the checksum-correct last word keeps the entropy bits of the current
+ *   last word and replaces its CS low bits
+ * - last-word candidates enumerate the free entropy bits of the last word
+ *   over the same packing (128 hashes for 12 words, 8 for 24)
+ *
+ * Slots start out as MNEMONIC_MODEL_NO_WORD; a model with unset slots is
+ * never valid. Only 12, 15, 18, 21 and 24 words carry a checksum.
+ */
+
+#define MNEMONIC_MODEL_MAX_WORDS 24
+#define MNEMONIC_MODEL_MAX_ENTROPY 32 // Bytes, for 24 words
+#define MNEMONIC_MODEL_NO_WORD 0xFFFF
+#define MNEMONIC_MODEL_WORDLIST_SIZE 2048
+
+typedef struct {
+  uint16_t words[MNEMONIC_MODEL_MAX_WORDS];
+  uint8_t count;
+} mnemonic_model_t;
+
+/**
+ * @brief Empty model of count words (1-24), every slot unset
+ */
+bool mnemonic_model_init(mnemonic_model_t *m, size_t count);
+
+/**
+ * @brief Set slot pos to a wordlist index, or MNEMONIC_MODEL_NO_WORD
+ */
+bool mnemonic_model_set(mnemonic_model_t *m, size_t pos, uint16_t index);
+
+/** @brief True for the BIP39 lengths (12, 15, 18, 21, 24) */
+bool mnemonic_model_count_supported(size_t count);
+
+/** @brief True if every slot holds a word */
+bool mnemonic_model_is_complete(const mnemonic_model_t *m);
+
+/**
+ * @brief Entropy encoded by the words (the checksum bits are dropped)
+ *
+ * @return Entropy length in bytes, or 0 if the model is incomplete or its
+ *         length is unsupported
+ */
+size_t mnemonic_model_entropy(const mnemonic_model_t *m,
+                              uint8_t out[MNEMONIC_MODEL_MAX_ENTROPY]);
+
+/**
+ * @brief True if the model is complete and its checksum matches
+ */
+bool mnemonic_model_checksum_valid(const mnemonic_model_t *m);
+
+/**
+ * @brief Rewrite the last word so the checksum matches
+ *
+ * Keeps the entropy bits of the current last word (zero if it is unset).
+ * The other words must be set.
+ *
+ * @return true if the last word now makes the mnemonic valid
+ */
+bool mnemonic_model_fix_last_word(mnemonic_model_t *m);
+
+/**
+ * @brief Every last word that completes the first count - 1 words
+ *
+ * Candidates come out in ascending index order.
+ *
+ * @return Number written to out (at most max), 0 if a word is missing
+ */
+size_t mnemonic_model_last_word_candidates(const mnemonic_model_t *m,
+                                           uint16_t *out, size_t max);
+
+/** @brief Wipe all words */
+void mnemonic_model_wipe(mnemonic_model_t *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MNEMONIC_MODEL_H
@@ -0,0 +1,151 @@
+#include "mnemonic_model.h"
+
+#include <sha2.h>
+#include <string.h>
+
+// 24 words x 11 bits
+#define PACKED_MAX 33
+
+static void *(*const volatile wipe_memset)(void *, int, size_t) = memset;
+
+static void wipe(void *p, size_t len) { wipe_memset(p, 0, len); }
+
+// Big-endian 11-bit concatenation of words[0..n), zero padded
+static void pack(const uint16_t *words, size_t n, uint8_t out[PACKED_MAX]) {
+  memset(out, 0, PACKED_MAX);
+  uint32_t acc = 0;
+  int acc_bits = 0;
+  size_t pos = 0;
+  for (size_t i = 0; i < n; i++) {
+    acc = (acc << 11) | (words[i] & 0x7FF);
+    acc_bits += 11;
+    while (acc_bits >= 8) {
+      acc_bits -= 8;
+      out[pos++] = (uint8_t)(acc >> acc_bits);
+    }
+  }
+  if (acc_bits)
+    out[pos] = (uint8_t)(acc << (8 - acc_bits));
+}
+
+static size_t checksum_bits(size_t count) { return count / 3; }
+
+static size_t entropy_len(size_t count) { return count * 4 / 3; }
+
+// Top cs bits of SHA-256(entropy)
+static uint16_t checksum_of(const uint8_t *entropy, size_t len, size_t cs) {
+  uint8_t digest[SHA2_256_LEN];
+  sha2_256(entropy, len, digest);
+  uint16_t sum = (uint16_t)(digest[0] >> (8 - cs));
+  wipe(digest, sizeof(digest));
+  return sum;
+}
+
+static bool prefix_complete(const mnemonic_model_t *m, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (m->words[i] >= MNEMONIC_MODEL_WORDLIST_SIZE)
+      return false;
+  }
+  return true;
+}
+
+bool mnemonic_model_init(mnemonic_model_t *m, size_t count) {
+  if (!m || count == 0 || count > MNEMONIC_MODEL_MAX_WORDS)
+    return false;
+  for (size_t i = 0; i < MNEMONIC_MODEL_MAX_WORDS; i++)
+    m->words[i] = MNEMONIC_MODEL_NO_WORD;
+  m->count = (uint8_t)count;
+  return true;
+}
+
+bool mnemonic_model_set(mnemonic_model_t *m, size_t pos, uint16_t index) {
+  if (!m || pos >= m->count)
+    return false;
+  if (index >= MNEMONIC_MODEL_WORDLIST_SIZE && index != MNEMONIC_MODEL_NO_WORD)
+    return false;
+  m->words[pos] = index;
+  return true;
+}
+
+bool mnemonic_model_count_supported(size_t count) {
+  return count >= 12 && count <= MNEMONIC_MODEL_MAX_WORDS && count % 3 == 0;
+}
+
+bool mnemonic_model_is_complete(const mnemonic_model_t *m) {
+  return m && m->count > 0 && prefix_complete(m, m->count);
+}
+
+size_t mnemonic_model_entropy(const mnemonic_model_t *m,
+                              uint8_t out[MNEMONIC_MODEL_MAX_ENTROPY]) {
+  if (!out || !mnemonic_model_is_complete(m) ||
+      !mnemonic_model_count_supported(m->count))
+    return 0;
+
+  uint8_t packed[PACKED_MAX];
+  pack(m->words, m->count, packed);
+  size_t len = entropy_len(m->count);
+  memcpy(out, packed, len);
+  wipe(packed, sizeof(packed));
+  return len;
+}
+
+bool mnemonic_model_checksum_valid(const mnemonic_model_t *m) {
+  uint8_t entropy[MNEMONIC_MODEL_MAX_ENTROPY];
+  size_t len = mnemonic_model_entropy(m, entropy);
+  if (len == 0)
+    return false;
+
+  size_t cs = checksum_bits(m->count);
+  uint16_t expected = checksum_of(entropy, len, cs);
+  wipe(entropy, sizeof(entropy));
+  return (m->words[m->count - 1] & ((1u << cs) - 1)) == expected;
+}
+
+bool mnemonic_model_fix_last_word(mnemonic_model_t *m) {
+  if (!m || !mnemonic_model_count_supported(m->count) ||
+      !prefix_complete(m, m->count - 1u))
+    return false;
+
+  size_t cs = checksum_bits(m->count);
+  uint16_t *last = &m->words[m->count - 1];
+  if (*last == MNEMONIC_MODEL_NO_WORD)
+    *last = 0;
+  *last &= (uint16_t)~((1u << cs) - 1);
+
+  // The checksum bits sit after the entropy, so they don't affect it
+  uint8_t entropy[MNEMONIC_MODEL_MAX_ENTROPY];
+  size_t len = mnemonic_model_entropy(m, entropy);
+  *last |= checksum_of(entropy, len, cs);
+  wipe(entropy, sizeof(entropy));
+  return true;
+}
+
+size_t mnemonic_model_last_word_candidates(const mnemonic_model_t *m,
+                                           uint16_t *out, size_t max) {
+  if (!m || !out || !mnemonic_model_count_supported(m->count) ||
+      !prefix_complete(m, m->count - 1u))
+    return 0;
+
+  size_t cs = checksum_bits(m->count);
+  size_t free_bits = 11 - cs; // Entropy bits carried by the last word
+  size_t len = entropy_len(m->count);
+
+  // The entropy ends on a byte boundary and free_bits <= 7, so the last
+  // word's entropy bits are the low bits of the final entropy byte
+  uint8_t packed[PACKED_MAX];
+  pack(m->words, m->count - 1u, packed);
+  uint8_t base = packed[len - 1];
+
+  size_t n = 0;
+  for (uint16_t v = 0; v < (1u << free_bits) && n < max; v++) {
+    packed[len - 1] = (uint8_t)(base | v);
+    out[n++] = (uint16_t)((v << cs) | checksum_of(packed, len, cs));
+  }
+  wipe(packed, sizeof(packed));
+  return n;
+}
+
+void mnemonic_model_wipe(mnemonic_model_t *m) {
+  if (m)
+    wipe(m, sizeof(*m));
+}
@@ -0,0 +1,318 @@
+/*
+ * Mnemonic Model Test Suite
+ * Compile with: make
+ * Run: ./test_mnemonic_model
+ *
+ * Vectors are the BIP39 reference (Trezor) vectors in wordlist-index form,
+ * e.g. "abandon x11 about" is eleven 0s and 3.
+ */
+
+#include "mnemonic_model.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ---------- Vectors ---------- */
+
+typedef struct {
+  const char *entropy_hex;
+  size_t count;
+  uint16_t words[24];
+} vector_t;
+
+static const vector_t vectors[] = {
+    {"00000000000000000000000000000000", 12, {[11] = 3}},
+    {"7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f",
+     12,
+     {1019, 2015, 1790, 2039, 1983, 1533, 2031, 1919, 1019, 2015, 1790,
+      2040}},
+    {"80808080808080808080808080808080",
+     12,
+     {1028, 32, 257, 8, 64, 514, 16, 128, 1028, 32, 257, 4}},
+    {"9e885d952ad362caeb4efe34a8e91bd2",
+     12,
+     {1268, 535, 810, 685, 433, 811, 1385, 1790, 421, 570, 567, 1313}},
+    {"6610b25967cdcca9d59875f5cb50b0ea75433311869e930b",
+     18,
+     {816, 1068, 1202, 1660, 1766, 679, 691, 117, 1966, 724, 353, 1703, 673,
+      1228, 560, 1694, 1176, 722}},
+    {"0000000000000000000000000000000000000000000000000000000000000000",
+     24,
+     {[23] = 102}},
+    {"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     24,
+     {2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047,
+      2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047, 2047,
+      1967}},
+};
+
+#define NUM_VECTORS (sizeof(vectors) / sizeof(vectors[0]))
+
+static size_t from_hex(const char *hex, uint8_t *out) {
+  size_t n = strlen(hex) / 2;
+  for (size_t i = 0; i < n; i++) {
+    unsigned v;
+    sscanf(hex + i * 2, "%2x", &v);
+    out[i] = (uint8_t)v;
+  }
+  return n;
+}
+
+static void load(mnemonic_model_t *m, const vector_t *v) {
+  mnemonic_model_init(m, v->count);
+  for (size_t i = 0; i < v->count; i++)
+    mnemonic_model_set(m, i, v->words[i]);
+}
+
+/* ---------- Tests ---------- */
+
+static void test_vectors_valid(void) {
+  TEST("reference vectors validate and unpack to their entropy");
+  for (size_t i = 0; i < NUM_VECTORS; i++) {
+    mnemonic_model_t m;
+    load(&m, &vectors[i]);
+    uint8_t expected[32], entropy[32];
+    size_t len = from_hex(vectors[i].entropy_hex, expected);
+    if (!mnemonic_model_checksum_valid(&m)) {
+      FAIL("checksum rejected");
+      return;
+    }
+    if (mnemonic_model_entropy(&m, entropy) != len ||
+        memcmp(entropy, expected, len) != 0) {
+      FAIL("entropy mismatch");
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_checksum_detects_edits(void) {
+  TEST("single-word edits that break the checksum are rejected");
+  mnemonic_model_t m;
+  load(&m, &vectors[3]);
+  // Flipping a checksum bit of the last word always breaks it
+  m.words[11] ^= 1;
+  if (mnemonic_model_checksum_valid(&m)) {
+    FAIL("bad checksum accepted");
+    return;
+  }
+  // Changing an earlier word is caught unless the 4-bit checksum collides
+  load(&m, &vectors[3]);
+  int accepted = 0;
+  for (uint16_t w = 0; w < MNEMONIC_MODEL_WORDLIST_SIZE; w++) {
+    if (w == vectors[3].words[0])
+      continue;
+    m.words[0] = w;
+    accepted += mnemonic_model_checksum_valid(&m);
+  }
+  // Expect about 2047 / 16
+  if (accepted < 64 || accepted > 192) {
+    FAIL("collision rate far from 1/16");
+    return;
+  }
+  PASS();
+}
+
+static void test_incomplete_and_unsupported(void) {
+  TEST("unset slots and non-BIP39 lengths are never valid");
+  mnemonic_model_t m;
+  load(&m, &vectors[0]);
+  mnemonic_model_set(&m, 5, MNEMONIC_MODEL_NO_WORD);
+  uint8_t entropy[32];
+  if (mnemonic_model_checksum_valid(&m) || mnemonic_model_is_complete(&m) ||
+      mnemonic_model_entropy(&m, entropy) != 0) {
+    FAIL("incomplete model accepted");
+    return;
+  }
+  if (mnemonic_model_set(&m, 12, 0) || mnemonic_model_set(&m, 0, 2048)) {
+    FAIL("out-of-range set accepted");
+    return;
+  }
+  if (mnemonic_model_init(&m, 25) || mnemonic_model_init(&m, 0)) {
+    FAIL("bad length accepted");
+    return;
+  }
+  mnemonic_model_init(&m, 13);
+  for (size_t i = 0; i < 13; i++)
+    mnemonic_model_set(&m, i, 0);
+  if (mnemonic_model_checksum_valid(&m) || mnemonic_model_fix_last_word(&m)) {
+    FAIL("13 words treated as BIP39");
+    return;
+  }
+  PASS();
+}
+
+static void test_fix_last_word(void) {
+  TEST("fixing the last word keeps its entropy bits");
+  for (size_t i = 0; i < NUM_VECTORS; i++) {
+    const vector_t *v = &vectors[i];
+    mnemonic_model_t m;
+    load(&m, v);
+    size_t cs = v->count / 3;
+    // Corrupt only the checksum bits
+    m.words[v->count - 1] ^= (uint16_t)((1u << cs) - 1);
+    if (!mnemonic_model_fix_last_word(&m) ||
+        m.words[v->count - 1] != v->words[v->count - 1]) {
+      FAIL("did not restore the reference last word");
+      return;
+    }
+  }
+
+  // An unset last word becomes the all-zero-entropy candidate
+  mnemonic_model_t m;
+  load(&m, &vectors[0]);
+  mnemonic_model_set(&m, 11, MNEMONIC_MODEL_NO_WORD);
+  if (!mnemonic_model_fix_last_word(&m) || m.words[11] != 3) {
+    FAIL("unset last word");
+    return;
+  }
+  mnemonic_model_set(&m, 4, MNEMONIC_MODEL_NO_WORD);
+  if (mnemonic_model_fix_last_word(&m)) {
+    FAIL("fixed with a missing word");
+    return;
+  }
+  PASS();
+}
+
+static void test_last_word_candidates(void) {
+  TEST("last-word candidates are exactly the valid completions");
+  for (size_t i = 0; i < NUM_VECTORS; i++) {
+    const vector_t *v = &vectors[i];
+    mnemonic_model_t m;
+    load(&m, v);
+    mnemonic_model_set(&m, v->count - 1, MNEMONIC_MODEL_NO_WORD);
+
+    uint16_t cands[128];
+    size_t expect = 1u << (11 - v->count / 3);
+    size_t n = mnemonic_model_last_word_candidates(&m, cands, 128);
+    if (n != expect) {
+      FAIL("wrong candidate count");
+      return;
+    }
+    bool found = false;
+    for (size_t j = 0; j < n; j++) {
+      if (j > 0 && cands[j] <= cands[j - 1]) {
+        FAIL("candidates not ascending");
+        return;
+      }
+      mnemonic_model_set(&m, v->count - 1, cands[j]);
+      if (!mnemonic_model_checksum_valid(&m)) {
+        FAIL("invalid candidate");
+        return;
+      }
+      found |= cands[j] == v->words[v->count - 1];
+    }
+    if (!found) {
+      FAIL("reference last word missing");
+      return;
+    }
+  }
+
+  // Brute force: no valid completion is left out
+  mnemonic_model_t m;
+  load(&m, &vectors[1]);
+  size_t valid = 0;
+  for (uint16_t w = 0; w < MNEMONIC_MODEL_WORDLIST_SIZE; w++) {
+    m.words[11] = w;
+    valid += mnemonic_model_checksum_valid(&m);
+  }
+  if (valid != 128) {
+    FAIL("brute force disagrees");
+    return;
+  }
+
+  uint16_t few[4];
+  if (mnemonic_model_last_word_candidates(&m, few, 4) != 4) {
+    FAIL("max not honoured");
+    return;
+  }
+  PASS();
+}
+
+static void test_wipe(void) {
+  TEST("wipe clears every word");
+  mnemonic_model_t m;
+  load(&m, &vectors[6]);
+  mnemonic_model_wipe(&m);
+  for (size_t i = 0; i < MNEMONIC_MODEL_MAX_WORDS; i++) {
+    if (m.words[i] != 0) {
+      FAIL("word survived");
+      return;
+    }
+  }
+  if (m.count != 0 || mnemonic_model_checksum_valid(&m)) {
+    FAIL("wiped model still valid");
+    return;
+  }
+  PASS();
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench(void) {
+  mnemonic_model_t m;
+  load(&m, &vectors[6]);
+  const int iters = 200000;
+  volatile int sink = 0;
+
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++) {
+    m.words[i % 23] = (uint16_t)(i & 0x7FF);
+    sink += mnemonic_model_checksum_valid(&m);
+  }
+  double t1 = now_ms();
+
+  load(&m, &vectors[0]);
+  uint16_t cands[128];
+  const int cand_iters = 2000;
+  double t2 = now_ms();
+  for (int i = 0; i < cand_iters; i++) {
+    m.words[i % 11] = (uint16_t)(i & 0x7FF);
+    sink += (int)mnemonic_model_last_word_candidates(&m, cands, 128);
+  }
+  double t3 = now_ms();
+  (void)sink;
+
+  printf("\nBenchmark:\n");
+  printf("  24-word checksum check: %.2f us\n", (t1 - t0) * 1000.0 / iters);
+  printf("  12-word last-word candidates (128): %.2f us\n",
+         (t3 - t2) * 1000.0 / cand_iters);
+}
+
+int main(void) {
+  printf("=== Mnemonic Model Tests ===\n\n");
+
+  test_vectors_valid();
+  test_checksum_detects_edits();
+  test_incomplete_and_unsupported();
+  test_fix_last_word();
+  test_last_word_candidates();
+  test_wipe();
+
+  bench();
+
+  printf("\nResults: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
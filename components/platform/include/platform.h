@@ -0,0 +1,128 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Persistence and device-key primitives behind one interface
+ *
+ * Settings, PIN and storage code reach NVS, the SPIFFS and SD file systems
+ * and the eFuse-keyed HMAC peripheral only through these calls. The
+ * firmware links platform_esp.c (ESP-IDF); host tests link platform_host.c,
+ * an in-memory implementation with fault injection (see platform_host.h).
+ *
+ * Semantics follow the device: a key-value set is atomic per key and is
+ * durable once it returns, commit flushes whatever the backend buffers, and
+ * a file write replaces the whole file but can be torn by a power cut.
+ */
+
+#define PLATFORM_HMAC_LEN 32
+
+// Paths passed to platform_fs_* are absolute, under these mount points
+#define PLATFORM_FLASH_MOUNT_POINT "/spiffs"
+#define PLATFORM_SD_MOUNT_POINT "/sdcard"
+
+typedef enum {
+  PLATFORM_OK = 0,
+  PLATFORM_ERR_ARG,
+  PLATFORM_ERR_NOT_FOUND,
+  PLATFORM_ERR_NO_SPACE,
+  PLATFORM_ERR_NO_MEM,
+  PLATFORM_ERR_IO,          // Read/write failure, including power loss
+  PLATFORM_ERR_UNAVAILABLE, // Medium not present, key not provisioned
+} platform_err_t;
+
+/* ---------- Key-value store (NVS) ---------- */
+
+typedef uint32_t platform_kv_t;
+
+platform_err_t platform_kv_open(const char *ns, platform_kv_t *kv_out);
+
+platform_err_t platform_kv_get_u8(platform_kv_t kv, const char *key,
+                                  uint8_t *value);
+platform_err_t platform_kv_get_u16(platform_kv_t kv, const char *key,
+                                   uint16_t *value);
+
+/**
+ * @brief Read a blob
+ * @param len In: capacity of buf. Out: blob length.
+ */
+platform_err_t platform_kv_get_blob(platform_kv_t kv, const char *key,
+                                    void *buf, size_t *len);
+
+platform_err_t platform_kv_set_u8(platform_kv_t kv, const char *key,
+                                  uint8_t value);
+platform_err_t platform_kv_set_u16(platform_kv_t kv, const char *key,
+                                   uint16_t value);
+platform_err_t platform_kv_set_blob(platform_kv_t kv, const char *key,
+                                    const void *data, size_t len);
+
+platform_err_t platform_kv_erase_all(platform_kv_t kv);
+platform_err_t platform_kv_commit(platform_kv_t kv);
+
+/* ---------- File systems ---------- */
+
+typedef enum {
+  PLATFORM_VOL_FLASH = 0, // Internal SPIFFS
+  PLATFORM_VOL_SD,        // Removable FAT card
+} platform_volume_t;
+
+/**
+ * @brief Mount a volume if it is not mounted yet
+ */
+platform_err_t platform_fs_mount(platform_volume_t vol);
+bool platform_fs_is_mounted(platform_volume_t vol);
+
+/**
+ * @brief Read a whole file into a heap buffer (caller frees)
+ *
+ * Empty files are reported as PLATFORM_ERR_NOT_FOUND.
+ */
+platform_err_t platform_fs_read(platform_volume_t vol, const char *path,
+                                uint8_t **data_out, size_t *len_out);
+
+/**
+ * @brief Create or replace a file
+ */
+platform_err_t platform_fs_write(platform_volume_t vol, const char *path,
+                                 const uint8_t *data, size_t len);
+
+platform_err_t platform_fs_delete(platform_volume_t vol, const char *path);
+bool platform_fs_exists(platform_volume_t vol, const char *path);
+platform_err_t platform_fs_mkdir(platform_volume_t vol, const char *path);
+
+/**
+ * @brief Names of the regular files in a directory
+ *
+ * @param names_out Receives the names (free with platform_fs_free_list)
+ */
+platform_err_t platform_fs_list(platform_volume_t vol, const char *dir,
+                                char ***names_out, int *count_out);
+void platform_fs_free_list(char **names, int count);
+
+/**
+ * @brief Erase the whole volume and remount it empty (flash only)
+ */
+platform_err_t platform_fs_format(platform_volume_t vol);
+
+/* ---------- Device key ---------- */
+
+/**
+ * @brief HMAC-SHA256 of msg under the device's hardware key
+ *
+ * @return PLATFORM_ERR_UNAVAILABLE if no key is provisioned
+ */
+platform_err_t platform_hmac_device_key(const uint8_t *msg, size_t len,
+                                        uint8_t out[PLATFORM_HMAC_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PLATFORM_H
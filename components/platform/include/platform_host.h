@@ -0,0 +1,80 @@
+#ifndef PLATFORM_HOST_H
+#define PLATFORM_HOST_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Controls for the in-memory host backend (platform_host.c)
+ *
+ * The host backend keeps NVS keys and both volumes in RAM and lets tests
+ * inject the failures the device sees in the field:
+ *
+ * - Power cut: after N more successful writes every write fails and the
+ *   next file write is torn (only its first half lands). Key-value writes
+ *   stay atomic, as NVS guarantees. platform_host_reboot() restores power
+ *   and drops open handles and mounts; stored data survives.
+ * - Full media: per-volume byte capacity and a key-value entry limit.
+ * - Read errors: every read fails until cleared.
+ * - Device key: absent (HMAC unavailable) or a given 32-byte key.
+ *
+ * The HMAC is a keyed hash with the right shape (stable, key- and
+ * message-dependent) but is not HMAC-SHA256; nothing here is meant to be
+ * compared with device output.
+ */
+
+/**
+ * @brief Erase everything and clear all faults
+ */
+void platform_host_reset(void);
+
+/**
+ * @brief Simulate a reset: clear power-cut state, close handles, unmount
+ */
+void platform_host_reboot(void);
+
+/**
+ * @brief Cut power after this many more successful writes (-1: never)
+ */
+void platform_host_power_cut_after(int writes);
+
+/**
+ * @brief True once the simulated power cut has happened
+ */
+bool platform_host_powered_off(void);
+
+/**
+ * @brief Bytes a volume can hold (0: unlimited)
+ */
+void platform_host_set_capacity(platform_volume_t vol, size_t bytes);
+
+/**
+ * @brief Key-value entries the store can hold (0: the built-in maximum)
+ */
+void platform_host_set_kv_capacity(size_t entries);
+
+void platform_host_fail_reads(bool fail);
+
+/**
+ * @brief Whether the SD card is inserted (mount fails without it)
+ */
+void platform_host_set_sd_present(bool present);
+
+/**
+ * @brief Provision (key != NULL) or remove the device HMAC key
+ */
+void platform_host_set_device_key(const uint8_t key[32]);
+
+/**
+ * @brief Successful writes since the last reset (key-value and files)
+ */
+unsigned platform_host_write_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PLATFORM_HOST_H
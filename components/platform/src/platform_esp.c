@@ -0,0 +1,256 @@
+/*
+ * Platform backend: ESP-IDF (NVS, SPIFFS, SD card, HMAC peripheral)
+ */
+
+#include "platform.h"
+#include <dirent.h>
+#include <errno.h>
+#include <esp_hmac.h>
+#include <esp_partition.h>
+#include <esp_spiffs.h>
+#include <nvs.h>
+#include <sd_card.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SPIFFS_PARTITION_LABEL "storage"
+
+static bool spiffs_mounted = false;
+
+static platform_err_t from_esp(esp_err_t err) {
+  switch (err) {
+  case ESP_OK:
+    return PLATFORM_OK;
+  case ESP_ERR_INVALID_ARG:
+    return PLATFORM_ERR_ARG;
+  case ESP_ERR_NOT_FOUND:
+  case ESP_ERR_NVS_NOT_FOUND:
+    return PLATFORM_ERR_NOT_FOUND;
+  case ESP_ERR_NVS_NOT_ENOUGH_SPACE:
+    return PLATFORM_ERR_NO_SPACE;
+  case ESP_ERR_NO_MEM:
+    return PLATFORM_ERR_NO_MEM;
+  case ESP_ERR_INVALID_SIZE:
+  case ESP_ERR_NVS_INVALID_LENGTH:
+    return PLATFORM_ERR_ARG;
+  default:
+    return PLATFORM_ERR_IO;
+  }
+}
+
+/* ---------- Key-value store ---------- */
+
+platform_err_t platform_kv_open(const char *ns, platform_kv_t *kv_out) {
+  nvs_handle_t h;
+  esp_err_t err = nvs_open(ns, NVS_READWRITE, &h);
+  if (err == ESP_OK)
+    *kv_out = (platform_kv_t)h;
+  return from_esp(err);
+}
+
+platform_err_t platform_kv_get_u8(platform_kv_t kv, const char *key,
+                                  uint8_t *value) {
+  return from_esp(nvs_get_u8((nvs_handle_t)kv, key, value));
+}
+
+platform_err_t platform_kv_get_u16(platform_kv_t kv, const char *key,
+                                   uint16_t *value) {
+  return from_esp(nvs_get_u16((nvs_handle_t)kv, key, value));
+}
+
+platform_err_t platform_kv_get_blob(platform_kv_t kv, const char *key,
+                                    void *buf, size_t *len) {
+  return from_esp(nvs_get_blob((nvs_handle_t)kv, key, buf, len));
+}
+
+platform_err_t platform_kv_set_u8(platform_kv_t kv, const char *key,
+                                  uint8_t value) {
+  return from_esp(nvs_set_u8((nvs_handle_t)kv, key, value));
+}
+
+platform_err_t platform_kv_set_u16(platform_kv_t kv, const char *key,
+                                   uint16_t value) {
+  return from_esp(nvs_set_u16((nvs_handle_t)kv, key, value));
+}
+
+platform_err_t platform_kv_set_blob(platform_kv_t kv, const char *key,
+                                    const void *data, size_t len) {
+  return from_esp(nvs_set_blob((nvs_handle_t)kv, key, data, len));
+}
+
+platform_err_t platform_kv_erase_all(platform_kv_t kv) {
+  return from_esp(nvs_erase_all((nvs_handle_t)kv));
+}
+
+platform_err_t platform_kv_commit(platform_kv_t kv) {
+  return from_esp(nvs_commit((nvs_handle_t)kv));
+}
+
+/* ---------- File systems ---------- */
+
+platform_err_t platform_fs_mount(platform_volume_t vol) {
+  if (vol == PLATFORM_VOL_SD)
+    return sd_card_is_mounted() ? PLATFORM_OK : from_esp(sd_card_init());
+
+  if (spiffs_mounted)
+    return PLATFORM_OK;
+
+  esp_vfs_spiffs_conf_t conf = {
+      .base_path = PLATFORM_FLASH_MOUNT_POINT,
+      .partition_label = SPIFFS_PARTITION_LABEL,
+      .max_files = 5,
+      .format_if_mount_failed = true,
+  };
+
+  esp_err_t ret = esp_vfs_spiffs_register(&conf);
+  if (ret == ESP_OK)
+    spiffs_mounted = true;
+  return from_esp(ret);
+}
+
+bool platform_fs_is_mounted(platform_volume_t vol) {
+  return vol == PLATFORM_VOL_SD ? sd_card_is_mounted() : spiffs_mounted;
+}
+
+platform_err_t platform_fs_read(platform_volume_t vol, const char *path,
+                                uint8_t **data_out, size_t *len_out) {
+  if (vol == PLATFORM_VOL_SD)
+    return from_esp(sd_card_read_file(path, data_out, len_out));
+
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return PLATFORM_ERR_NOT_FOUND;
+
+  fseek(f, 0, SEEK_END);
+  long fsize = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  if (fsize <= 0) {
+    fclose(f);
+    return PLATFORM_ERR_NOT_FOUND;
+  }
+
+  uint8_t *data = malloc((size_t)fsize);
+  if (!data) {
+    fclose(f);
+    return PLATFORM_ERR_NO_MEM;
+  }
+
+  size_t nread = fread(data, 1, (size_t)fsize, f);
+  fclose(f);
+
+  *data_out = data;
+  *len_out = nread;
+  return PLATFORM_OK;
+}
+
+platform_err_t platform_fs_write(platform_volume_t vol, const char *path,
+                                 const uint8_t *data, size_t len) {
+  if (vol == PLATFORM_VOL_SD)
+    return from_esp(sd_card_write_file(path, data, len));
+
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return PLATFORM_ERR_IO;
+  size_t written = fwrite(data, 1, len, f);
+  int write_errno = errno;
+  fclose(f);
+  if (written == len)
+    return PLATFORM_OK;
+  return write_errno == ENOSPC ? PLATFORM_ERR_NO_SPACE : PLATFORM_ERR_IO;
+}
+
+platform_err_t platform_fs_delete(platform_volume_t vol, const char *path) {
+  if (vol == PLATFORM_VOL_SD)
+    return from_esp(sd_card_delete_file(path));
+  return (unlink(path) == 0) ? PLATFORM_OK : PLATFORM_ERR_IO;
+}
+
+bool platform_fs_exists(platform_volume_t vol, const char *path) {
+  if (vol == PLATFORM_VOL_SD) {
+    bool exists = false;
+    sd_card_file_exists(path, &exists);
+    return exists;
+  }
+  struct stat st;
+  return stat(path, &st) == 0;
+}
+
+platform_err_t platform_fs_mkdir(platform_volume_t vol, const char *path) {
+  // SPIFFS is flat; directories only exist on the card
+  if (vol == PLATFORM_VOL_FLASH)
+    return PLATFORM_OK;
+  return (mkdir(path, 0775) == 0 || errno == EEXIST) ? PLATFORM_OK
+                                                     : PLATFORM_ERR_IO;
+}
+
+platform_err_t platform_fs_list(platform_volume_t vol, const char *dir,
+                                char ***names_out, int *count_out) {
+  if (vol == PLATFORM_VOL_SD)
+    return from_esp(sd_card_list_files(dir, names_out, count_out));
+
+  DIR *d = opendir(dir);
+  if (!d)
+    return PLATFORM_ERR_IO;
+
+  char **names = NULL;
+  int count = 0;
+  struct dirent *entry;
+  while ((entry = readdir(d)) != NULL) {
+    char **tmp = realloc(names, (size_t)(count + 1) * sizeof(char *));
+    if (!tmp || !(tmp[count] = strdup(entry->d_name))) {
+      platform_fs_free_list(tmp ? tmp : names, count);
+      closedir(d);
+      return PLATFORM_ERR_NO_MEM;
+    }
+    names = tmp;
+    count++;
+  }
+
+  closedir(d);
+  *names_out = names;
+  *count_out = count;
+  return PLATFORM_OK;
+}
+
+void platform_fs_free_list(char **names, int count) {
+  if (!names)
+    return;
+  for (int i = 0; i < count; i++)
+    free(names[i]);
+  free(names);
+}
+
+platform_err_t platform_fs_format(platform_volume_t vol) {
+  if (vol != PLATFORM_VOL_FLASH)
+    return PLATFORM_ERR_ARG;
+
+  if (spiffs_mounted) {
+    esp_vfs_spiffs_unregister(SPIFFS_PARTITION_LABEL);
+    spiffs_mounted = false;
+  }
+
+  const esp_partition_t *part = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS,
+      SPIFFS_PARTITION_LABEL);
+  if (!part)
+    return PLATFORM_ERR_NOT_FOUND;
+
+  esp_err_t ret = esp_partition_erase_range(part, 0, part->size);
+  if (ret != ESP_OK)
+    return from_esp(ret);
+
+  /* Remount — format_if_mount_failed creates a fresh filesystem */
+  return platform_fs_mount(PLATFORM_VOL_FLASH);
+}
+
+/* ---------- Device key ---------- */
+
+platform_err_t platform_hmac_device_key(const uint8_t *msg, size_t len,
+                                        uint8_t out[PLATFORM_HMAC_LEN]) {
+  esp_err_t err = esp_hmac_calculate(HMAC_KEY5, msg, len, out);
+  return err == ESP_OK ? PLATFORM_OK : PLATFORM_ERR_UNAVAILABLE;
+}
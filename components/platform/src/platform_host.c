@@ -0,0 +1,520 @@
+/*
+ * Platform backend: in-memory host emulation with fault injection
+ */
+
+#include "platform_host.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define KV_MAX_ENTRIES 128
+#define KV_MAX_NAMESPACES 8
+#define KV_MAX_NAME 16 // NVS limit, including the NUL
+#define KV_MAX_BLOB 256
+#define FS_MAX_PATH 128
+#define FS_MAX_DIRS 16
+
+enum { KV_U8, KV_U16, KV_BLOB };
+
+typedef struct {
+  bool used;
+  uint8_t ns;
+  char key[KV_MAX_NAME];
+  uint8_t type;
+  size_t len;
+  uint8_t data[KV_MAX_BLOB];
+} kv_entry_t;
+
+typedef struct {
+  char path[FS_MAX_PATH];
+  uint8_t *data;
+  size_t len;
+} fs_file_t;
+
+typedef struct {
+  fs_file_t *files;
+  size_t num_files;
+  char dirs[FS_MAX_DIRS][FS_MAX_PATH];
+  size_t num_dirs;
+  size_t capacity;
+  bool mounted;
+} fs_volume_t;
+
+static kv_entry_t kv_entries[KV_MAX_ENTRIES];
+static char kv_namespaces[KV_MAX_NAMESPACES][KV_MAX_NAME];
+static bool kv_open[KV_MAX_NAMESPACES];
+static size_t kv_capacity = 0;
+
+static fs_volume_t volumes[2];
+
+static int power_budget = -1;
+static bool powered_off = false;
+static bool fail_reads = false;
+static bool sd_present = true;
+static bool has_device_key = false;
+static uint8_t device_key[32];
+static unsigned write_count = 0;
+
+/* ---------- Fault injection ---------- */
+
+// Account for one write; false if the power cut happens now or already has
+static bool consume_write(void) {
+  if (powered_off)
+    return false;
+  if (power_budget == 0) {
+    powered_off = true;
+    return false;
+  }
+  if (power_budget > 0)
+    power_budget--;
+  write_count++;
+  return true;
+}
+
+static bool read_ok(void) { return !fail_reads && !powered_off; }
+
+void platform_host_reset(void) {
+  for (int v = 0; v < 2; v++) {
+    for (size_t i = 0; i < volumes[v].num_files; i++)
+      free(volumes[v].files[i].data);
+    free(volumes[v].files);
+  }
+  memset(volumes, 0, sizeof(volumes));
+  memset(kv_entries, 0, sizeof(kv_entries));
+  memset(kv_namespaces, 0, sizeof(kv_namespaces));
+  memset(kv_open, 0, sizeof(kv_open));
+  kv_capacity = 0;
+  power_budget = -1;
+  powered_off = false;
+  fail_reads = false;
+  sd_present = true;
+  has_device_key = false;
+  memset(device_key, 0, sizeof(device_key));
+  write_count = 0;
+}
+
+void platform_host_reboot(void) {
+  power_budget = -1;
+  powered_off = false;
+  memset(kv_open, 0, sizeof(kv_open));
+  volumes[PLATFORM_VOL_FLASH].mounted = false;
+  volumes[PLATFORM_VOL_SD].mounted = false;
+}
+
+void platform_host_power_cut_after(int writes) {
+  power_budget = writes < 0 ? -1 : writes;
+}
+
+bool platform_host_powered_off(void) { return powered_off; }
+
+void platform_host_set_capacity(platform_volume_t vol, size_t bytes) {
+  volumes[vol].capacity = bytes;
+}
+
+void platform_host_set_kv_capacity(size_t entries) { kv_capacity = entries; }
+
+void platform_host_fail_reads(bool fail) { fail_reads = fail; }
+
+void platform_host_set_sd_present(bool present) {
+  sd_present = present;
+  if (!present)
+    volumes[PLATFORM_VOL_SD].mounted = false;
+}
+
+void platform_host_set_device_key(const uint8_t key[32]) {
+  has_device_key = key != NULL;
+  if (key)
+    memcpy(device_key, key, sizeof(device_key));
+  else
+    memset(device_key, 0, sizeof(device_key));
+}
+
+unsigned platform_host_write_count(void) { return write_count; }
+
+/* ---------- Key-value store ---------- */
+
+static bool kv_handle_ok(platform_kv_t kv) {
+  return kv >= 1 && kv <= KV_MAX_NAMESPACES && kv_open[kv - 1];
+}
+
+static kv_entry_t *kv_find(platform_kv_t kv, const char *key) {
+  for (size_t i = 0; i < KV_MAX_ENTRIES; i++) {
+    if (kv_entries[i].used && kv_entries[i].ns == kv - 1 &&
+        strcmp(kv_entries[i].key, key) == 0)
+      return &kv_entries[i];
+  }
+  return NULL;
+}
+
+static platform_err_t kv_get(platform_kv_t kv, const char *key, uint8_t type,
+                             void *buf, size_t *len) {
+  if (!kv_handle_ok(kv) || !key || !len)
+    return PLATFORM_ERR_ARG;
+  if (!read_ok())
+    return PLATFORM_ERR_IO;
+  const kv_entry_t *e = kv_find(kv, key);
+  if (!e || e->type != type)
+    return PLATFORM_ERR_NOT_FOUND;
+  if (!buf) {
+    *len = e->len;
+    return PLATFORM_OK;
+  }
+  if (*len < e->len)
+    return PLATFORM_ERR_ARG;
+  memcpy(buf, e->data, e->len);
+  *len = e->len;
+  return PLATFORM_OK;
+}
+
+static platform_err_t kv_set(platform_kv_t kv, const char *key, uint8_t type,
+                             const void *data, size_t len) {
+  if (!kv_handle_ok(kv) || !key || strlen(key) >= KV_MAX_NAME ||
+      len > KV_MAX_BLOB)
+    return PLATFORM_ERR_ARG;
+
+  kv_entry_t *e = kv_find(kv, key);
+  if (!e) {
+    size_t used = 0;
+    for (size_t i = 0; i < KV_MAX_ENTRIES; i++) {
+      if (kv_entries[i].used)
+        used++;
+      else if (!e)
+        e = &kv_entries[i];
+    }
+    if (!e || (kv_capacity > 0 && used >= kv_capacity))
+      return PLATFORM_ERR_NO_SPACE;
+  }
+
+  // NVS writes a key atomically: a cut leaves the old value in place
+  if (!consume_write())
+    return PLATFORM_ERR_IO;
+
+  e->used = true;
+  e->ns = (uint8_t)(kv - 1);
+  strcpy(e->key, key);
+  e->type = type;
+  e->len = len;
+  memcpy(e->data, data, len);
+  return PLATFORM_OK;
+}
+
+platform_err_t platform_kv_open(const char *ns, platform_kv_t *kv_out) {
+  if (!ns || !kv_out || strlen(ns) >= KV_MAX_NAME)
+    return PLATFORM_ERR_ARG;
+  if (powered_off)
+    return PLATFORM_ERR_IO;
+
+  int slot = -1;
+  for (int i = 0; i < KV_MAX_NAMESPACES; i++) {
+    if (strcmp(kv_namespaces[i], ns) == 0) {
+      slot = i;
+      break;
+    }
+    if (slot < 0 && kv_namespaces[i][0] == '\0')
+      slot = i;
+  }
+  if (slot < 0)
+    return PLATFORM_ERR_NO_SPACE;
+
+  strcpy(kv_namespaces[slot], ns);
+  kv_open[slot] = true;
+  *kv_out = (platform_kv_t)(slot + 1);
+  return PLATFORM_OK;
+}
+
+platform_err_t platform_kv_get_u8(platform_kv_t kv, const char *key,
+                                  uint8_t *value) {
+  size_t len = sizeof(*value);
+  return kv_get(kv, key, KV_U8, value, &len);
+}
+
+platform_err_t platform_kv_get_u16(platform_kv_t kv, const char *key,
+                                   uint16_t *value) {
+  size_t len = sizeof(*value);
+  return kv_get(kv, key, KV_U16, value, &len);
+}
+
+platform_err_t platform_kv_get_blob(platform_kv_t kv, const char *key,
+                                    void *buf, size_t *len) {
+  return kv_get(kv, key, KV_BLOB, buf, len);
+}
+
+platform_err_t platform_kv_set_u8(platform_kv_t kv, const char *key,
+                                  uint8_t value) {
+  return kv_set(kv, key, KV_U8, &value, sizeof(value));
+}
+
+platform_err_t platform_kv_set_u16(platform_kv_t kv, const char *key,
+                                   uint16_t value) {
+  return kv_set(kv, key, KV_U16, &value, sizeof(value));
+}
+
+platform_err_t platform_kv_set_blob(platform_kv_t kv, const char *key,
+                                    const void *data, size_t len) {
+  if (!data && len > 0)
+    return PLATFORM_ERR_ARG;
+  return kv_set(kv, key, KV_BLOB, data, len);
+}
+
+platform_err_t platform_kv_erase_all(platform_kv_t kv) {
+  if (!kv_handle_ok(kv))
+    return PLATFORM_ERR_ARG;
+  if (!consume_write())
+    return PLATFORM_ERR_IO;
+  for (size_t i = 0; i < KV_MAX_ENTRIES; i++) {
+    if (kv_entries[i].used && kv_entries[i].ns == kv - 1)
+      memset(&kv_entries[i], 0, sizeof(kv_entries[i]));
+  }
+  return PLATFORM_OK;
+}
+
+platform_err_t platform_kv_commit(platform_kv_t kv) {
+  if (!kv_handle_ok(kv))
+    return PLATFORM_ERR_ARG;
+  // Sets are already durable; a commit only fails once power is gone
+  return powered_off ? PLATFORM_ERR_IO : PLATFORM_OK;
+}
+
+/* ---------- File systems ---------- */
+
+static fs_volume_t *mounted_volume(platform_volume_t vol) {
+  if (vol != PLATFORM_VOL_FLASH && vol != PLATFORM_VOL_SD)
+    return NULL;
+  if (vol == PLATFORM_VOL_SD && !sd_present)
+    return NULL;
+  return volumes[vol].mounted ? &volumes[vol] : NULL;
+}
+
+static fs_file_t *fs_find(fs_volume_t *v, const char *path) {
+  for (size_t i = 0; i < v->num_files; i++) {
+    if (strcmp(v->files[i].path, path) == 0)
+      return &v->files[i];
+  }
+  return NULL;
+}
+
+static size_t fs_used(const fs_volume_t *v) {
+  size_t used = 0;
+  for (size_t i = 0; i < v->num_files; i++)
+    used += v->files[i].len;
+  return used;
+}
+
+platform_err_t platform_fs_mount(platform_volume_t vol) {
+  if (vol != PLATFORM_VOL_FLASH && vol != PLATFORM_VOL_SD)
+    return PLATFORM_ERR_ARG;
+  if (powered_off)
+    return PLATFORM_ERR_IO;
+  if (vol == PLATFORM_VOL_SD && !sd_present)
+    return PLATFORM_ERR_UNAVAILABLE;
+  volumes[vol].mounted = true;
+  return PLATFORM_OK;
+}
+
+bool platform_fs_is_mounted(platform_volume_t vol) {
+  return mounted_volume(vol) != NULL;
+}
+
+platform_err_t platform_fs_read(platform_volume_t vol, const char *path,
+                                uint8_t **data_out, size_t *len_out) {
+  fs_volume_t *v = mounted_volume(vol);
+  if (!v)
+    return PLATFORM_ERR_UNAVAILABLE;
+  if (!path || !data_out || !len_out)
+    return PLATFORM_ERR_ARG;
+  if (!read_ok())
+    return PLATFORM_ERR_IO;
+
+  const fs_file_t *f = fs_find(v, path);
+  if (!f || f->len == 0)
+    return PLATFORM_ERR_NOT_FOUND;
+
+  uint8_t *data = malloc(f->len);
+  if (!data)
+    return PLATFORM_ERR_NO_MEM;
+  memcpy(data, f->data, f->len);
+  *data_out = data;
+  *len_out = f->len;
+  return PLATFORM_OK;
+}
+
+platform_err_t platform_fs_write(platform_volume_t vol, const char *path,
+                                 const uint8_t *data, size_t len) {
+  fs_volume_t *v = mounted_volume(vol);
+  if (!v)
+    return PLATFORM_ERR_UNAVAILABLE;
+  if (!path || strlen(path) >= FS_MAX_PATH || (!data && len > 0))
+    return PLATFORM_ERR_ARG;
+
+  fs_file_t *f = fs_find(v, path);
+  size_t old_len = f ? f->len : 0;
+  if (v->capacity > 0 && fs_used(v) - old_len + len > v->capacity)
+    return PLATFORM_ERR_NO_SPACE;
+
+  bool was_off = powered_off;
+  bool ok = consume_write();
+  if (!ok && was_off)
+    return PLATFORM_ERR_IO;
+  // A cut during the write leaves the file truncated to what reached flash
+  size_t stored_len = ok ? len : len / 2;
+
+  uint8_t *copy = NULL;
+  if (stored_len > 0) {
+    copy = malloc(stored_len);
+    if (!copy)
+      return PLATFORM_ERR_NO_MEM;
+    memcpy(copy, data, stored_len);
+  }
+
+  if (!f) {
+    fs_file_t *tmp = realloc(v->files, (v->num_files + 1) * sizeof(*tmp));
+    if (!tmp) {
+      free(copy);
+      return PLATFORM_ERR_NO_MEM;
+    }
+    v->files = tmp;
+    f = &v->files[v->num_files++];
+    strcpy(f->path, path);
+    f->data = NULL;
+  }
+  free(f->data);
+  f->data = copy;
+  f->len = stored_len;
+  return ok ? PLATFORM_OK : PLATFORM_ERR_IO;
+}
+
+platform_err_t platform_fs_delete(platform_volume_t vol, const char *path) {
+  fs_volume_t *v = mounted_volume(vol);
+  if (!v)
+    return PLATFORM_ERR_UNAVAILABLE;
+  if (!path)
+    return PLATFORM_ERR_ARG;
+  fs_file_t *f = fs_find(v, path);
+  if (!f)
+    return PLATFORM_ERR_NOT_FOUND;
+  if (!consume_write())
+    return PLATFORM_ERR_IO;
+
+  free(f->data);
+  *f = v->files[--v->num_files];
+  return PLATFORM_OK;
+}
+
+bool platform_fs_exists(platform_volume_t vol, const char *path) {
+  fs_volume_t *v = mounted_volume(vol);
+  return v && path && read_ok() && fs_find(v, path) != NULL;
+}
+
+static bool dir_exists(const fs_volume_t *v, platform_volume_t vol,
+                       const char *dir) {
+  const char *root = vol == PLATFORM_VOL_FLASH ? PLATFORM_FLASH_MOUNT_POINT
+                                               : PLATFORM_SD_MOUNT_POINT;
+  if (strcmp(dir, root) == 0)
+    return true;
+  for (size_t i = 0; i < v->num_dirs; i++) {
+    if (strcmp(v->dirs[i], dir) == 0)
+      return true;
+  }
+  return false;
+}
+
+platform_err_t platform_fs_mkdir(platform_volume_t vol, const char *path) {
+  fs_volume_t *v = mounted_volume(vol);
+  if (!v)
+    return PLATFORM_ERR_UNAVAILABLE;
+  if (!path || strlen(path) >= FS_MAX_PATH)
+    return PLATFORM_ERR_ARG;
+  if (vol == PLATFORM_VOL_FLASH || dir_exists(v, vol, path))
+    return PLATFORM_OK;
+  if (v->num_dirs >= FS_MAX_DIRS)
+    return PLATFORM_ERR_NO_SPACE;
+  if (!consume_write())
+    return PLATFORM_ERR_IO;
+  strcpy(v->dirs[v->num_dirs++], path);
+  return PLATFORM_OK;
+}
+
+platform_err_t platform_fs_list(platform_volume_t vol, const char *dir,
+                                char ***names_out, int *count_out) {
+  fs_volume_t *v = mounted_volume(vol);
+  if (!v)
+    return PLATFORM_ERR_UNAVAILABLE;
+  if (!dir || !names_out || !count_out)
+    return PLATFORM_ERR_ARG;
+  if (!read_ok())
+    return PLATFORM_ERR_IO;
+  if (!dir_exists(v, vol, dir))
+    return PLATFORM_ERR_NOT_FOUND;
+
+  size_t dir_len = strlen(dir);
+  char **names = NULL;
+  int count = 0;
+  for (size_t i = 0; i < v->num_files; i++) {
+    const char *path = v->files[i].path;
+    if (strncmp(path, dir, dir_len) != 0 || path[dir_len] != '/' ||
+        strchr(path + dir_len + 1, '/'))
+      continue;
+    char **tmp = realloc(names, (size_t)(count + 1) * sizeof(char *));
+    if (!tmp || !(tmp[count] = strdup(path + dir_len + 1))) {
+      platform_fs_free_list(tmp ? tmp : names, count);
+      return PLATFORM_ERR_NO_MEM;
+    }
+    names = tmp;
+    count++;
+  }
+  *names_out = names;
+  *count_out = count;
+  return PLATFORM_OK;
+}
+
+void platform_fs_free_list(char **names, int count) {
+  if (!names)
+    return;
+  for (int i = 0; i < count; i++)
+    free(names[i]);
+  free(names);
+}
+
+platform_err_t platform_fs_format(platform_volume_t vol) {
+  if (vol != PLATFORM_VOL_FLASH)
+    return PLATFORM_ERR_ARG;
+  if (!consume_write())
+    return PLATFORM_ERR_IO;
+  fs_volume_t *v = &volumes[vol];
+  for (size_t i = 0; i < v->num_files; i++)
+    free(v->files[i].data);
+  free(v->files);
+  v->files = NULL;
+  v->num_files = 0;
+  v->mounted = true;
+  return PLATFORM_OK;
+}
+
+/* ---------- Device key ---------- */
+
+static uint64_t mix64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+platform_err_t platform_hmac_device_key(const uint8_t *msg, size_t len,
+                                        uint8_t out[PLATFORM_HMAC_LEN]) {
+  if (!has_device_key)
+    return PLATFORM_ERR_UNAVAILABLE;
+  if ((!msg && len > 0) || !out)
+    return PLATFORM_ERR_ARG;
+
+  for (int lane = 0; lane < PLATFORM_HMAC_LEN / 8; lane++) {
+    uint64_t h = mix64(0xcbf29ce484222325ULL + (uint64_t)lane);
+    for (size_t i = 0; i < sizeof(device_key); i++)
+      h = mix64(h ^ device_key[i]);
+    for (size_t i = 0; i < len; i++)
+      h = mix64(h ^ msg[i]);
+    h = mix64(h ^ len);
+    for (int b = 0; b < 8; b++)
+      out[lane * 8 + b] = (uint8_t)(h >> (8 * b));
+  }
+  return PLATFORM_OK;
+}
@@ -0,0 +1,45 @@
+#ifndef PSBT_KEYPATH_H
+#define PSBT_KEYPATH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Key origin of a PSBT BIP32 derivation value
+ *
+ * PSBT_{IN,OUT}_BIP32_DERIVATION values are the key origin itself:
+ * fingerprint(4) followed by the path, 4 bytes per level. The BIP371
+ * PSBT_{IN,OUT}_TAP_BIP32_DERIVATION values put a compact-size count and
+ * the 32-byte hashes of the tapleaves the key appears in first, so a
+ * BIP86 key-path entry is 0x00 followed by the origin.
+ *
+ * libwally keeps both as raw map values; this finds the origin in either
+ * without copying.
+ */
+
+#define PSBT_KEYPATH_FINGERPRINT_LEN 4
+
+/**
+ * @brief Locate the fingerprint and path in a derivation value
+ *
+ * @param taproot true for a TAP_BIP32_DERIVATION value
+ * @param origin_out Set to the fingerprint, followed by the path
+ * @param origin_len_out Fingerprint plus path length, a multiple of 4
+ * @param num_leaves_out Tapleaves the key is used in, 0 for a key-path
+ *                       only key and for non-taproot values (optional)
+ * @return false if the value is truncated or not a whole number of levels
+ */
+bool psbt_keypath_origin(const uint8_t *value, size_t value_len, bool taproot,
+                         const uint8_t **origin_out, size_t *origin_len_out,
+                         size_t *num_leaves_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PSBT_KEYPATH_H
@@ -0,0 +1,47 @@
+#include "psbt_keypath.h"
+
+#define LEAF_HASH_LEN 32
+
+// Bitcoin compact-size integer; returns its encoded length, 0 if truncated
+static size_t read_compact_size(const uint8_t *p, size_t len, uint64_t *out) {
+  if (len < 1)
+    return 0;
+  size_t width = p[0] < 0xfd ? 0 : p[0] == 0xfd ? 2 : p[0] == 0xfe ? 4 : 8;
+  if (width == 0) {
+    *out = p[0];
+    return 1;
+  }
+  if (len < 1 + width)
+    return 0;
+  uint64_t v = 0;
+  for (size_t i = width; i > 0; i--)
+    v = (v << 8) | p[i];
+  *out = v;
+  return 1 + width;
+}
+
+bool psbt_keypath_origin(const uint8_t *value, size_t value_len, bool taproot,
+                         const uint8_t **origin_out, size_t *origin_len_out,
+                         size_t *num_leaves_out) {
+  if (!value || !origin_out || !origin_len_out)
+    return false;
+
+  uint64_t num_leaves = 0;
+  size_t offset = 0;
+  if (taproot) {
+    offset = read_compact_size(value, value_len, &num_leaves);
+    if (offset == 0 || num_leaves > (value_len - offset) / LEAF_HASH_LEN)
+      return false;
+    offset += (size_t)num_leaves * LEAF_HASH_LEN;
+  }
+
+  size_t origin_len = value_len - offset;
+  if (origin_len < PSBT_KEYPATH_FINGERPRINT_LEN || origin_len % 4 != 0)
+    return false;
+
+  *origin_out = value + offset;
+  *origin_len_out = origin_len;
+  if (num_leaves_out)
+    *num_leaves_out = (size_t)num_leaves;
+  return true;
+}
@@ -0,0 +1,282 @@
+/*
+ * PSBT Keypath Test Suite
+ * Compile with: make
+ * Run: ./test_psbt_keypath
+ *
+ * The PSBT below is BIP371-encoded and spends the BIP86 test vector key
+ * m/86'/0'/0'/0/0 of "abandon ... about" (master fingerprint 73c5da0a):
+ * the input carries that key's PSBT_IN_TAP_BIP32_DERIVATION (no leaves)
+ * and a second key used in one tapleaf; the change output carries
+ * PSBT_OUT_TAP_BIP32_DERIVATION for m/86'/0'/0'/1/0.
+ */
+
+#include "psbt_keypath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+#define H 0x80000000u
+
+static const char *bip86_psbt =
+    "cHNidP8BAIkCAAAAAQABAgMEBQYHCAkKCwwNDg8QERITFBUWFxgZGhscHR4fAAAAAAD9////"
+    "AkCcAAAAAAAAIlEgpghp8NvPHcZZyc7Lr4BQE16p6M3EhwU/HcaICUncaEwoIwAAAAAAACJR"
+    "IKYIafDbzx3GWcnOy6+AUBNeqejNxIcFPx3GiAlJ3GhMAAAAAAABAStQwwAAAAAAACJRIKYI"
+    "afDbzx3GWcnOy6+AUBNeqejNxIcFPx3GiAlJ3GhMIRbMikvGTYl73cX7wvZw96i6CzhneRBs"
+    "8SI8b8XXzW/BFRkAc8XaClYAAIAAAACAAAAAgAAAAAAAAAAAIRaD3+haMVHSUXKQ2kYf4oFV"
+    "ke9p8rGKLOY/AWl6izExRTkBq6urq6urq6urq6urq6urq6urq6urq6urq6urq6urq6tzxdoK"
+    "VgAAgAAAAIAAAACAAAAAAAEAAAABFyDMikvGTYl73cX7wvZw96i6CzhneRBs8SI8b8XXzW/B"
+    "FQAAAQUgOZ8bL0OT8poYyTeFnF3Yp3NQEDFX64gPAujAghQnfO8hBzmfGy9Dk/KaGMk3hZxd"
+    "2KdzUBAxV+uIDwLowIIUJ3zvGQBzxdoKVgAAgAAAAIAAAACAAQAAAAAAAAAA";
+
+static const uint8_t fingerprint[4] = {0x73, 0xc5, 0xda, 0x0a};
+
+/* ---------- PSBT walking ---------- */
+
+static uint8_t psbt[1024];
+static size_t psbt_len;
+
+static int b64_value(char c) {
+  const char *table =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  const char *p = strchr(table, c);
+  return (c && p) ? (int)(p - table) : -1;
+}
+
+static size_t b64_decode(const char *in, uint8_t *out) {
+  size_t n = 0;
+  uint32_t acc = 0;
+  int bits = 0;
+  for (; *in && *in != '='; in++) {
+    acc = (acc << 6) | (uint32_t)b64_value(*in);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out[n++] = (uint8_t)(acc >> bits);
+    }
+  }
+  return n;
+}
+
+static size_t compact_size(const uint8_t *p, size_t *len) {
+  // Every length in the test PSBT fits in one byte
+  *len = p[0];
+  return 1;
+}
+
+typedef struct {
+  const uint8_t *key;
+  size_t key_len;
+  const uint8_t *value;
+  size_t value_len;
+} kv_t;
+
+// Nth key-value pair of type `type` in map `map_index` (0 is the global
+// map, then inputs, then outputs)
+static bool find_kv(size_t map_index, uint8_t type, size_t nth, kv_t *out) {
+  size_t pos = 5; // "psbt" 0xff
+  size_t map = 0;
+  while (pos < psbt_len) {
+    size_t key_len, value_len;
+    pos += compact_size(psbt + pos, &key_len);
+    if (key_len == 0) {
+      map++;
+      continue;
+    }
+    const uint8_t *key = psbt + pos;
+    pos += key_len;
+    pos += compact_size(psbt + pos, &value_len);
+    if (map == map_index && key[0] == type && nth-- == 0) {
+      out->key = key;
+      out->key_len = key_len;
+      out->value = psbt + pos;
+      out->value_len = value_len;
+      return true;
+    }
+    pos += value_len;
+  }
+  return false;
+}
+
+static bool origin_is(const uint8_t *origin, size_t origin_len,
+                      const uint32_t *path, size_t depth) {
+  if (origin_len != 4 + depth * 4 || memcmp(origin, fingerprint, 4) != 0)
+    return false;
+  for (size_t i = 0; i < depth; i++) {
+    const uint8_t *p = origin + 4 + i * 4;
+    uint32_t level = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    if (level != path[i])
+      return false;
+  }
+  return true;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_bip86_key_path(void) {
+  TEST("BIP86 key-path input derivation (0x00 || origin)");
+
+  static const uint32_t path[] = {86 | H, H, H, 0, 0};
+  kv_t kv;
+  const uint8_t *origin;
+  size_t origin_len, leaves = 99;
+
+  if (!find_kv(1, 0x16, 0, &kv) || kv.key_len != 33 || kv.value_len != 25) {
+    FAIL("PSBT_IN_TAP_BIP32_DERIVATION not found");
+    return;
+  }
+  // The leaf count byte is what broke reading this as a plain keypath
+  if (!psbt_keypath_origin(kv.value, kv.value_len, true, &origin,
+                           &origin_len, &leaves) ||
+      leaves != 0 || !origin_is(origin, origin_len, path, 5)) {
+    FAIL("wrong origin");
+    return;
+  }
+  PASS();
+}
+
+static void test_script_path_leaves(void) {
+  TEST("Script-path input derivation skips leaf hashes");
+
+  static const uint32_t path[] = {86 | H, H, H, 0, 1};
+  kv_t kv;
+  const uint8_t *origin;
+  size_t origin_len, leaves = 0;
+
+  if (!find_kv(1, 0x16, 1, &kv) || kv.value_len != 1 + 32 + 24) {
+    FAIL("second derivation not found");
+    return;
+  }
+  if (!psbt_keypath_origin(kv.value, kv.value_len, true, &origin,
+                           &origin_len, &leaves) ||
+      leaves != 1 || !origin_is(origin, origin_len, path, 5)) {
+    FAIL("wrong origin");
+    return;
+  }
+  PASS();
+}
+
+static void test_change_output(void) {
+  TEST("Taproot change output derivation");
+
+  static const uint32_t path[] = {86 | H, H, H, 1, 0};
+  kv_t kv;
+  const uint8_t *origin;
+  size_t origin_len;
+
+  if (!find_kv(3, 0x07, 0, &kv)) {
+    FAIL("PSBT_OUT_TAP_BIP32_DERIVATION not found");
+    return;
+  }
+  if (!psbt_keypath_origin(kv.value, kv.value_len, true, &origin,
+                           &origin_len, NULL) ||
+      !origin_is(origin, origin_len, path, 5)) {
+    FAIL("wrong origin");
+    return;
+  }
+  PASS();
+}
+
+static void test_plain_and_malformed(void) {
+  TEST("BIP32 values pass through, malformed values are rejected");
+
+  uint8_t value[1 + 2 * 32 + 24];
+  const uint8_t *origin;
+  size_t origin_len, leaves = 99;
+  bool ok = true;
+
+  // Segwit v0 value: the origin itself, however it starts
+  memset(value, 0, sizeof(value));
+  memcpy(value, fingerprint, 4);
+  ok = ok && psbt_keypath_origin(value, 24, false, &origin, &origin_len,
+                                 &leaves) &&
+       origin == value && origin_len == 24 && leaves == 0;
+
+  // Leaf count larger than the hashes present
+  value[0] = 3;
+  ok = ok && !psbt_keypath_origin(value, sizeof(value), true, &origin,
+                                  &origin_len, NULL);
+  // Origin not a whole number of levels
+  value[0] = 2;
+  ok = ok && psbt_keypath_origin(value, sizeof(value), true, &origin,
+                                 &origin_len, &leaves) &&
+       leaves == 2 && origin_len == 24;
+  ok = ok && !psbt_keypath_origin(value, sizeof(value) - 1, true, &origin,
+                                  &origin_len, NULL);
+  // 8-byte count that would overflow the offset
+  memset(value, 0xff, 9);
+  ok = ok && !psbt_keypath_origin(value, sizeof(value), true, &origin,
+                                  &origin_len, NULL);
+  // No fingerprint
+  value[0] = 0;
+  ok = ok && !psbt_keypath_origin(value, 1, true, &origin, &origin_len,
+                                  NULL) &&
+       !psbt_keypath_origin(value, 0, false, &origin, &origin_len, NULL);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("unexpected result");
+  }
+}
+
+/* ---------- Benchmark ---------- */
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void bench_origin(void) {
+  kv_t kv;
+  if (!find_kv(1, 0x16, 1, &kv))
+    return;
+
+  const int iters = 10000000;
+  volatile size_t sink = 0;
+  const uint8_t *origin;
+  size_t origin_len;
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++) {
+    psbt_keypath_origin(kv.value, kv.value_len, true, &origin, &origin_len,
+                        NULL);
+    sink += origin_len;
+  }
+  double t1 = now_ms();
+  (void)sink;
+  printf("\nBenchmark:\n");
+  printf("  Taproot origin, one leaf: %.2f ns\n\n",
+         (t1 - t0) * 1e6 / iters);
+}
+
+int main(void) {
+  printf("=== PSBT Keypath Tests ===\n\n");
+
+  psbt_len = b64_decode(bip86_psbt, psbt);
+
+  test_bip86_key_path();
+  test_script_path_leaves();
+  test_change_output();
+  test_plain_and_malformed();
+
+  bench_origin();
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+#ifndef PSBT_WRITER_H
+#define PSBT_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Streaming BIP174 PSBT serializer
+ *
+ * Writes magic, key-value records and map separators straight into one
+ * caller-owned buffer, as raw bytes or as base64 encoded on the fly. With a
+ * NULL buffer the writer only counts, so a caller can size the output with
+ * the same code path that fills it and never hold an intermediate copy.
+ *
+ * Usage: init, magic, then for each map its records followed by a
+ * separator, then finish. Values too large to pass in one piece are written
+ * with psbt_writer_record_begin() followed by the value bytes.
+ */
+
+// BIP174 key types used by signatures-only PSBTs
+#define PSBT_GLOBAL_UNSIGNED_TX 0x00
+#define PSBT_IN_NON_WITNESS_UTXO 0x00
+#define PSBT_IN_WITNESS_UTXO 0x01
+#define PSBT_IN_PARTIAL_SIG 0x02
+#define PSBT_IN_REDEEM_SCRIPT 0x04
+#define PSBT_IN_WITNESS_SCRIPT 0x05
+#define PSBT_IN_FINAL_SCRIPTSIG 0x07
+#define PSBT_IN_FINAL_SCRIPTWITNESS 0x08
+#define PSBT_IN_TAP_KEY_SIG 0x13
+
+typedef struct {
+  uint8_t *buf; // NULL: count only
+  size_t cap;
+  size_t len; // Output bytes produced (encoded length in base64 mode)
+  bool base64;
+  bool overflow;
+  uint8_t carry[3]; // Pending raw bytes not yet forming a base64 group
+  size_t carry_len;
+} psbt_writer_t;
+
+/**
+ * @brief Start writing
+ *
+ * @param buf Output buffer, or NULL to only count
+ * @param cap Capacity of buf
+ * @param base64 Encode as base64 (finish() adds a NUL terminator)
+ */
+void psbt_writer_init(psbt_writer_t *w, uint8_t *buf, size_t cap, bool base64);
+
+void psbt_writer_bytes(psbt_writer_t *w, const uint8_t *data, size_t len);
+void psbt_writer_u32le(psbt_writer_t *w, uint32_t v);
+void psbt_writer_u64le(psbt_writer_t *w, uint64_t v);
+void psbt_writer_varint(psbt_writer_t *w, uint64_t v);
+
+/**
+ * @brief Bitcoin CompactSize length of v
+ */
+size_t psbt_writer_varint_len(uint64_t v);
+
+/**
+ * @brief "psbt" magic followed by 0xff
+ */
+void psbt_writer_magic(psbt_writer_t *w);
+
+/**
+ * @brief Key and value length of a record; value_len bytes must follow
+ *
+ * @param type Key type
+ * @param keydata Key data after the type byte (may be NULL if empty)
+ * @param keydata_len Length of keydata
+ * @param value_len Length of the value the caller writes next
+ */
+void psbt_writer_record_begin(psbt_writer_t *w, uint8_t type,
+                              const uint8_t *keydata, size_t keydata_len,
+                              size_t value_len);
+
+/**
+ * @brief Complete key-value record
+ */
+void psbt_writer_record(psbt_writer_t *w, uint8_t type, const uint8_t *keydata,
+                        size_t keydata_len, const uint8_t *value,
+                        size_t value_len);
+
+/**
+ * @brief End of the current map
+ */
+void psbt_writer_separator(psbt_writer_t *w);
+
+/**
+ * @brief Flush pending base64 output and NUL-terminate it
+ *
+ * @param len_out Bytes written (or needed, when counting), excluding the
+ * NUL terminator
+ * @return false if the buffer was too small
+ */
+bool psbt_writer_finish(psbt_writer_t *w, size_t *len_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PSBT_WRITER_H
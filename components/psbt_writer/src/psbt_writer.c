@@ -0,0 +1,157 @@
+/*
+ * Streaming BIP174 PSBT serializer
+ */
+
+#include "psbt_writer.h"
+#include <string.h>
+
+static const char BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static void emit(psbt_writer_t *w, const uint8_t *data, size_t len) {
+  if (w->buf) {
+    if (len > w->cap - w->len) {
+      w->overflow = true;
+      return;
+    }
+    memcpy(w->buf + w->len, data, len);
+  }
+  w->len += len;
+}
+
+static void emit_base64_group(psbt_writer_t *w, const uint8_t *in,
+                              size_t in_len) {
+  uint32_t v = (uint32_t)in[0] << 16;
+  if (in_len > 1)
+    v |= (uint32_t)in[1] << 8;
+  if (in_len > 2)
+    v |= in[2];
+
+  uint8_t out[4];
+  out[0] = BASE64_CHARS[(v >> 18) & 0x3F];
+  out[1] = BASE64_CHARS[(v >> 12) & 0x3F];
+  out[2] = in_len > 1 ? BASE64_CHARS[(v >> 6) & 0x3F] : '=';
+  out[3] = in_len > 2 ? BASE64_CHARS[v & 0x3F] : '=';
+  emit(w, out, sizeof(out));
+}
+
+void psbt_writer_init(psbt_writer_t *w, uint8_t *buf, size_t cap,
+                      bool base64) {
+  memset(w, 0, sizeof(*w));
+  w->buf = buf;
+  w->cap = buf ? cap : 0;
+  w->base64 = base64;
+}
+
+void psbt_writer_bytes(psbt_writer_t *w, const uint8_t *data, size_t len) {
+  if (w->overflow || len == 0)
+    return;
+
+  if (!w->base64) {
+    emit(w, data, len);
+    return;
+  }
+
+  // Complete a pending group first, then encode whole groups in place
+  while (w->carry_len > 0 && w->carry_len < 3 && len > 0) {
+    w->carry[w->carry_len++] = *data++;
+    len--;
+  }
+  if (w->carry_len == 3) {
+    emit_base64_group(w, w->carry, 3);
+    w->carry_len = 0;
+  }
+
+  if (!w->buf) {
+    // Counting only: whole groups contribute 4 characters each
+    w->len += (len / 3) * 4;
+    data += len - len % 3;
+    len %= 3;
+  } else {
+    for (; len >= 3; data += 3, len -= 3)
+      emit_base64_group(w, data, 3);
+  }
+
+  memcpy(w->carry + w->carry_len, data, len);
+  w->carry_len += len;
+}
+
+void psbt_writer_u32le(psbt_writer_t *w, uint32_t v) {
+  uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16),
+                  (uint8_t)(v >> 24)};
+  psbt_writer_bytes(w, b, sizeof(b));
+}
+
+void psbt_writer_u64le(psbt_writer_t *w, uint64_t v) {
+  psbt_writer_u32le(w, (uint32_t)v);
+  psbt_writer_u32le(w, (uint32_t)(v >> 32));
+}
+
+size_t psbt_writer_varint_len(uint64_t v) {
+  if (v < 0xfd)
+    return 1;
+  if (v <= 0xffff)
+    return 3;
+  if (v <= 0xffffffff)
+    return 5;
+  return 9;
+}
+
+void psbt_writer_varint(psbt_writer_t *w, uint64_t v) {
+  uint8_t b[9];
+  size_t n = psbt_writer_varint_len(v);
+  if (n == 1) {
+    b[0] = (uint8_t)v;
+  } else {
+    b[0] = (n == 3) ? 0xfd : (n == 5) ? 0xfe : 0xff;
+    for (size_t i = 1; i < n; i++)
+      b[i] = (uint8_t)(v >> (8 * (i - 1)));
+  }
+  psbt_writer_bytes(w, b, n);
+}
+
+void psbt_writer_magic(psbt_writer_t *w) {
+  static const uint8_t magic[5] = {'p', 's', 'b', 't', 0xff};
+  psbt_writer_bytes(w, magic, sizeof(magic));
+}
+
+void psbt_writer_record_begin(psbt_writer_t *w, uint8_t type,
+                              const uint8_t *keydata, size_t keydata_len,
+                              size_t value_len) {
+  psbt_writer_varint(w, 1 + keydata_len);
+  psbt_writer_bytes(w, &type, 1);
+  if (keydata_len > 0)
+    psbt_writer_bytes(w, keydata, keydata_len);
+  psbt_writer_varint(w, value_len);
+}
+
+void psbt_writer_record(psbt_writer_t *w, uint8_t type, const uint8_t *keydata,
+                        size_t keydata_len, const uint8_t *value,
+                        size_t value_len) {
+  psbt_writer_record_begin(w, type, keydata, keydata_len, value_len);
+  psbt_writer_bytes(w, value, value_len);
+}
+
+void psbt_writer_separator(psbt_writer_t *w) {
+  static const uint8_t sep = 0x00;
+  psbt_writer_bytes(w, &sep, 1);
+}
+
+bool psbt_writer_finish(psbt_writer_t *w, size_t *len_out) {
+  if (w->base64 && !w->overflow) {
+    if (w->carry_len > 0)
+      emit_base64_group(w, w->carry, w->carry_len);
+    w->carry_len = 0;
+
+    if (w->buf) {
+      if (w->len >= w->cap)
+        w->overflow = true;
+      else
+        w->buf[w->len] = '\0';
+    }
+  }
+
+  if (len_out)
+    *len_out = w->len;
+  return !w->overflow;
+}
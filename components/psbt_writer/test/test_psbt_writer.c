@@ -0,0 +1,263 @@
+/*
+ * PSBT Writer Test Suite
+ * Compile with: make
+ * Run: ./test_psbt_writer
+ *
+ * The framing test rebuilds the first valid PSBT from BIP174 (one P2PKH
+ * input with its non-witness UTXO) record by record and expects the exact
+ * published base64. Values are sliced from the decoded vector, so the test
+ * checks key/length/separator encoding and the streaming base64 encoder.
+ */
+
+#include "psbt_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static const char BIP174_P2PKH[] =
+    "cHNidP8BAHUCAAAAASaBcTce3/KF6Tet7qSze3gADAVmy7OtZGQXE8pCFxv2AAAAAAD+////"
+    "AtPf9QUAAAAAGXapFNDFmQPFusKGh2DpD9UhpGZap2UgiKwA4fUFAAAAABepFDVF5uM7gyxH"
+    "BQ8k0+65PJwDlIvHh7MuEwAAAQD9pQEBAAAAAAECiaPHHqtNIOA3G7ukzGmPopXJRjr6Ljl/"
+    "hTPMti+VZ+UBAAAAFxYAFL4Y0VKpsBIDna89p95PUzSe7LmF/////4b4qkOnHf8USIk6UwpyN+"
+    "9rRgi7st0tAXHmOuxqSJC0AQAAABcWABT+Pp7xp0XpdNkCxDVZQ6vLNL1TU/////8CAMLrCwAA"
+    "AAAZdqkUhc/xCX/Z4Ai7NK9wnGIZeziXikiIrHL++E4sAAAAF6kUM5cluiHv1irHU6m80GfW"
+    "x6ajnQWHAkcwRAIgJxK+IuAnDzlPVoMR3HyppolwuAJf3TskAinwf4pfOiQCIAGLONfc0xTn"
+    "NMkna9b7QPZzMlvEuqFEyADS8vAtsnZcASED0uFWdJQbrUqZY3LLh+GFbTZSYG2YVi/jnF6e"
+    "fkE/IQUCSDBFAiEA0SuFLYXc2WHS9fSrZgZU327tzHlMDDPOXMMJ/7X85Y0CIGczio4OFyXB"
+    "l/saiK9Z9R5E5CVbIBZ8hoQDHAXR8lkqASECI7cr7vCWXRC+B3jv7NYfysb3mk6haTkzgHNE"
+    "ZPhPKrMAAAAAAAAA";
+
+// Decoded vector layout
+#define TX_OFFSET 8
+#define TX_LEN 117
+#define UTXO_OFFSET 131
+#define UTXO_LEN 421
+#define RAW_LEN 555
+
+static size_t base64_decode(const char *in, uint8_t *out) {
+  static const char chars[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t n = 0;
+  uint32_t acc = 0;
+  int bits = 0;
+  for (; *in && *in != '='; in++) {
+    const char *p = strchr(chars, *in);
+    acc = (acc << 6) | (uint32_t)(p - chars);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out[n++] = (uint8_t)(acc >> bits);
+    }
+  }
+  return n;
+}
+
+// Write the vector through the writer; chunk > 0 feeds values in pieces
+static bool write_vector(psbt_writer_t *w, const uint8_t *raw, size_t chunk,
+                         size_t *len_out) {
+  psbt_writer_magic(w);
+
+  psbt_writer_record_begin(w, PSBT_GLOBAL_UNSIGNED_TX, NULL, 0, TX_LEN);
+  for (size_t off = 0; off < TX_LEN;) {
+    size_t n = (chunk == 0 || chunk > TX_LEN - off) ? TX_LEN - off : chunk;
+    psbt_writer_bytes(w, raw + TX_OFFSET + off, n);
+    off += n;
+  }
+  psbt_writer_separator(w);
+
+  psbt_writer_record_begin(w, PSBT_IN_NON_WITNESS_UTXO, NULL, 0, UTXO_LEN);
+  for (size_t off = 0; off < UTXO_LEN;) {
+    size_t n =
+        (chunk == 0 || chunk > UTXO_LEN - off) ? UTXO_LEN - off : chunk;
+    psbt_writer_bytes(w, raw + UTXO_OFFSET + off, n);
+    off += n;
+  }
+  psbt_writer_separator(w);
+
+  // Two outputs with empty maps
+  psbt_writer_separator(w);
+  psbt_writer_separator(w);
+
+  return psbt_writer_finish(w, len_out);
+}
+
+static void test_bip174_framing(void) {
+  TEST("BIP174 vector framing (binary)");
+  uint8_t raw[RAW_LEN + 8];
+  if (base64_decode(BIP174_P2PKH, raw) != RAW_LEN) {
+    FAIL("vector decode");
+    return;
+  }
+
+  uint8_t out[RAW_LEN];
+  psbt_writer_t w;
+  size_t len = 0;
+  psbt_writer_init(&w, out, sizeof(out), false);
+  if (!write_vector(&w, raw, 0, &len) || len != RAW_LEN ||
+      memcmp(out, raw, RAW_LEN) != 0) {
+    FAIL("binary output differs from vector");
+    return;
+  }
+  PASS();
+}
+
+static void test_bip174_base64(void) {
+  TEST("BIP174 vector streamed as base64");
+  uint8_t raw[RAW_LEN + 8];
+  base64_decode(BIP174_P2PKH, raw);
+
+  size_t expected_len = strlen(BIP174_P2PKH);
+  static const size_t chunks[] = {0, 1, 2, 3, 4, 5, 7, 64};
+  for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+    uint8_t out[1024];
+    psbt_writer_t w;
+    size_t len = 0;
+    psbt_writer_init(&w, out, sizeof(out), true);
+    if (!write_vector(&w, raw, chunks[c], &len) || len != expected_len ||
+        strcmp((const char *)out, BIP174_P2PKH) != 0) {
+      char msg[64];
+      snprintf(msg, sizeof(msg), "mismatch with %zu-byte chunks", chunks[c]);
+      FAIL(msg);
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_counting_pass(void) {
+  TEST("Counting pass matches written length");
+  uint8_t raw[RAW_LEN + 8];
+  base64_decode(BIP174_P2PKH, raw);
+
+  for (int b64 = 0; b64 <= 1; b64++) {
+    psbt_writer_t w;
+    size_t counted = 0;
+    psbt_writer_init(&w, NULL, 0, b64);
+    if (!write_vector(&w, raw, 5, &counted)) {
+      FAIL("counting pass failed");
+      return;
+    }
+
+    // Exact-size buffer (plus NUL for base64) must be enough
+    uint8_t *buf = malloc(counted + (b64 ? 1 : 0));
+    size_t written = 0;
+    psbt_writer_init(&w, buf, counted + (b64 ? 1 : 0), b64);
+    bool ok = write_vector(&w, raw, 0, &written);
+    free(buf);
+    if (!ok || written != counted) {
+      FAIL("written length differs from counted length");
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_overflow(void) {
+  TEST("Short buffer reports overflow");
+  uint8_t raw[RAW_LEN + 8];
+  base64_decode(BIP174_P2PKH, raw);
+
+  uint8_t out[RAW_LEN];
+  psbt_writer_t w;
+  psbt_writer_init(&w, out, RAW_LEN - 1, false);
+  if (write_vector(&w, raw, 0, NULL)) {
+    FAIL("binary overflow not detected");
+    return;
+  }
+
+  // Room for the characters but not the NUL terminator
+  size_t b64_len = strlen(BIP174_P2PKH);
+  uint8_t *b64 = malloc(b64_len);
+  psbt_writer_init(&w, b64, b64_len, true);
+  bool ok = write_vector(&w, raw, 0, NULL);
+  free(b64);
+  if (ok) {
+    FAIL("missing NUL room not detected");
+    return;
+  }
+  PASS();
+}
+
+static void test_varint(void) {
+  TEST("CompactSize encoding");
+  static const struct {
+    uint64_t v;
+    const uint8_t enc[9];
+    size_t len;
+  } cases[] = {
+      {0x00, {0x00}, 1},
+      {0xfc, {0xfc}, 1},
+      {0xfd, {0xfd, 0xfd, 0x00}, 3},
+      {0xffff, {0xfd, 0xff, 0xff}, 3},
+      {0x10000, {0xfe, 0x00, 0x00, 0x01, 0x00}, 5},
+      {0x100000000ULL, {0xff, 0, 0, 0, 0, 1, 0, 0, 0}, 9},
+  };
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    uint8_t out[9];
+    psbt_writer_t w;
+    size_t len = 0;
+    psbt_writer_init(&w, out, sizeof(out), false);
+    psbt_writer_varint(&w, cases[i].v);
+    if (!psbt_writer_finish(&w, &len) || len != cases[i].len ||
+        psbt_writer_varint_len(cases[i].v) != cases[i].len ||
+        memcmp(out, cases[i].enc, len) != 0) {
+      FAIL("bad encoding");
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_base64_padding(void) {
+  TEST("Base64 padding for 1 and 2 trailing bytes");
+  static const struct {
+    const char *in;
+    const char *out;
+  } cases[] = {
+      {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"}, {"foob", "Zm9vYg=="},
+  };
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    char out[16];
+    psbt_writer_t w;
+    size_t len = 0;
+    psbt_writer_init(&w, (uint8_t *)out, sizeof(out), true);
+    psbt_writer_bytes(&w, (const uint8_t *)cases[i].in, strlen(cases[i].in));
+    if (!psbt_writer_finish(&w, &len) || strcmp(out, cases[i].out) != 0 ||
+        len != strlen(cases[i].out)) {
+      FAIL(cases[i].in);
+      return;
+    }
+  }
+  PASS();
+}
+
+int main(void) {
+  printf("=== PSBT Writer Test Suite ===\n\n");
+
+  test_varint();
+  test_base64_padding();
+  test_bip174_framing();
+  test_bip174_base64();
+  test_counting_pass();
+  test_overflow();
+
+  printf("\nResults: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+#ifndef SANKEY_RASTER_H
+#define SANKEY_RASTER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fixed-point span rasterizer for the Sankey diagram
+ *
+ * Draws anti-aliased vertical spans into an RGB565 buffer. Each primitive
+ * first computes the top/bottom edge of every column in 16.16 fixed point
+ * (cubic edges by forward differencing), then fills the spans two columns
+ * at a time with 32-bit writes where the buffer alignment allows it.
+ *
+ * Edge semantics match the original per-pixel renderer: the pixel holding
+ * the top edge is blended with 1 - frac(top), the one holding the bottom
+ * edge with frac(bottom), everything in between is solid.
+ *
+ * No LVGL dependency so it can be built and checked on the host.
+ */
+
+typedef struct {
+  uint16_t *pixels; // RGB565, row-major
+  int32_t width;
+  int32_t height;
+  uint32_t stride; // Bytes per row
+} sankey_raster_t;
+
+/** @brief Convert 0xRRGGBB to RGB565 (same rounding as lv_color_to_u16) */
+uint16_t sankey_raster_rgb565(uint32_t rgb);
+
+/** @brief Fill the whole canvas with one colour */
+void sankey_raster_fill(const sankey_raster_t *r, uint16_t color);
+
+/**
+ * @brief Horizontal band with a left-to-right colour gradient
+ *
+ * Columns x_start..x_end inclusive; nothing is drawn if they are equal.
+ * Colours are 0xRRGGBB.
+ */
+void sankey_raster_band(const sankey_raster_t *r, int32_t x_start,
+                        int32_t x_end, float y_top, float y_bot,
+                        uint32_t left_rgb, uint32_t right_rgb);
+
+/** @brief Solid rectangle over columns x_start..x_end inclusive */
+void sankey_raster_rect(const sankey_raster_t *r, int32_t x_start,
+                        int32_t x_end, float y_top, float y_bot, uint16_t color);
+
+/**
+ * @brief Ribbon between two vertical segments along a smoothstep Bézier
+ *
+ * Edges follow the cubic with control points (y0, y0, y3, y3) and evenly
+ * spaced x, and the colour is interpolated from start to end.
+ */
+void sankey_raster_ribbon(const sankey_raster_t *r, float x0, float y0_top,
+                          float y0_bot, float x3, float y3_top, float y3_bot,
+                          uint32_t start_rgb, uint32_t end_rgb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SANKEY_RASTER_H
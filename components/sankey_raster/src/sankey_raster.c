@@ -0,0 +1,368 @@
+#include "sankey_raster.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Columns are generated in batches of this size before being filled */
+#define COLUMN_BATCH 64
+
+typedef struct {
+  int32_t y_top; // Row holding the top edge (blended with a_top)
+  int32_t y_bot; // Row holding the bottom edge (blended with a_bot)
+  uint8_t a_top;
+  uint8_t a_bot;
+  uint16_t color;
+} column_t;
+
+/* Cubic edge in 32.32 fixed point, stepped one column at a time */
+typedef struct {
+  int64_t y;
+  int64_t d1;
+  int64_t d2;
+  int64_t d3;
+} edge_t;
+
+/* Exact v / 255 for 0 <= v < 65535 */
+#define DIV255(v) (((v) + 1 + ((v) >> 8)) >> 8)
+
+static inline uint16_t *row_ptr(const sankey_raster_t *r, int32_t y) {
+  return (uint16_t *)((uint8_t *)r->pixels + (size_t)y * r->stride);
+}
+
+static inline uint16_t blend565(uint16_t fg, uint16_t bg, uint32_t alpha) {
+  uint32_t inv = 255 - alpha;
+  uint32_t red = (fg >> 11) * alpha + (bg >> 11) * inv;
+  uint32_t green = ((fg >> 5) & 0x3F) * alpha + ((bg >> 5) & 0x3F) * inv;
+  uint32_t blue = (fg & 0x1F) * alpha + (bg & 0x1F) * inv;
+  return (uint16_t)((DIV255(red) << 11) | (DIV255(green) << 5) | DIV255(blue));
+}
+
+static inline void blend_pixel(const sankey_raster_t *r, int32_t x, int32_t y,
+                               uint16_t color, uint8_t alpha) {
+  if (alpha == 0 || y < 0 || y >= r->height)
+    return;
+  uint16_t *px = row_ptr(r, y) + x;
+  *px = (alpha == 255) ? color : blend565(color, *px, alpha);
+}
+
+static inline void fill_column(const sankey_raster_t *r, int32_t x, int32_t y0,
+                               int32_t y1, uint16_t color) {
+  uint16_t *px = row_ptr(r, y0) + x;
+  for (int32_t y = y0; y <= y1; y++) {
+    *px = color;
+    px = (uint16_t *)((uint8_t *)px + r->stride);
+  }
+}
+
+static inline uint32_t pair_word(uint16_t left, uint16_t right) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return ((uint32_t)left << 16) | right;
+#else
+  return ((uint32_t)right << 16) | left;
+#endif
+}
+
+/* Solid rows of a column clipped to the canvas; false if empty */
+static inline bool solid_rows(const sankey_raster_t *r, const column_t *c,
+                              int32_t *y0, int32_t *y1) {
+  *y0 = c->y_top + 1 < 0 ? 0 : c->y_top + 1;
+  *y1 = c->y_bot - 1 >= r->height ? r->height - 1 : c->y_bot - 1;
+  return *y0 <= *y1;
+}
+
+static void emit_edges(const sankey_raster_t *r, int32_t x,
+                       const column_t *c) {
+  blend_pixel(r, x, c->y_top, c->color, c->a_top);
+  if (c->y_bot > c->y_top)
+    blend_pixel(r, x, c->y_bot, c->color, c->a_bot);
+}
+
+static void emit_column(const sankey_raster_t *r, int32_t x,
+                        const column_t *c) {
+  int32_t y0, y1;
+  if (solid_rows(r, c, &y0, &y1))
+    fill_column(r, x, y0, y1, c->color);
+  emit_edges(r, x, c);
+}
+
+/* Columns x (4-byte aligned) and x + 1: shared rows use one 32-bit store */
+static void emit_pair(const sankey_raster_t *r, int32_t x, const column_t *a,
+                      const column_t *b) {
+  int32_t a0, a1, b0, b1;
+  bool has_a = solid_rows(r, a, &a0, &a1);
+  bool has_b = solid_rows(r, b, &b0, &b1);
+
+  int32_t o0 = 0, o1 = -1;
+  if (has_a && has_b) {
+    o0 = a0 > b0 ? a0 : b0;
+    o1 = a1 < b1 ? a1 : b1;
+  }
+
+  if (o0 <= o1) {
+    uint32_t word = pair_word(a->color, b->color);
+    uint32_t *px = (uint32_t *)(row_ptr(r, o0) + x);
+    for (int32_t y = o0; y <= o1; y++) {
+      *px = word;
+      px = (uint32_t *)((uint8_t *)px + r->stride);
+    }
+    if (a0 < o0)
+      fill_column(r, x, a0, o0 - 1, a->color);
+    if (a1 > o1)
+      fill_column(r, x, o1 + 1, a1, a->color);
+    if (b0 < o0)
+      fill_column(r, x + 1, b0, o0 - 1, b->color);
+    if (b1 > o1)
+      fill_column(r, x + 1, o1 + 1, b1, b->color);
+  } else {
+    if (has_a)
+      fill_column(r, x, a0, a1, a->color);
+    if (has_b)
+      fill_column(r, x + 1, b0, b1, b->color);
+  }
+
+  emit_edges(r, x, a);
+  emit_edges(r, x + 1, b);
+}
+
+static void emit_columns(const sankey_raster_t *r, int32_t x_first,
+                         const column_t *cols, size_t count) {
+  bool can_pair =
+      ((uintptr_t)r->pixels & 3) == 0 && (r->stride & 3) == 0;
+
+  size_t i = 0;
+  while (i < count) {
+    int32_t x = x_first + (int32_t)i;
+    if (x < 0 || x >= r->width) {
+      i++;
+      continue;
+    }
+    if (can_pair && (x & 1) == 0 && i + 1 < count && x + 1 < r->width) {
+      emit_pair(r, x, &cols[i], &cols[i + 1]);
+      i += 2;
+    } else {
+      emit_column(r, x, &cols[i]);
+      i++;
+    }
+  }
+}
+
+/* Same truncation as the float renderer this replaces */
+static void column_edges_float(column_t *c, float y_top, float y_bot) {
+  c->y_top = (int32_t)y_top;
+  c->y_bot = (int32_t)y_bot;
+  c->a_top = 255 - (uint8_t)((y_top - c->y_top) * 255.0f);
+  c->a_bot = (uint8_t)((y_bot - c->y_bot) * 255.0f);
+}
+
+static void column_edges_fixed(column_t *c, int32_t top_q16, int32_t bot_q16) {
+  if (top_q16 > bot_q16) {
+    int32_t tmp = top_q16;
+    top_q16 = bot_q16;
+    bot_q16 = tmp;
+  }
+  c->y_top = top_q16 >> 16;
+  c->y_bot = bot_q16 >> 16;
+  c->a_top = 255 - (uint8_t)(((uint32_t)(top_q16 & 0xFFFF) * 255) >> 16);
+  c->a_bot = (uint8_t)(((uint32_t)(bot_q16 & 0xFFFF) * 255) >> 16);
+}
+
+static inline uint8_t channel(uint32_t rgb, int shift) {
+  return (uint8_t)(rgb >> shift);
+}
+
+uint16_t sankey_raster_rgb565(uint32_t rgb) {
+  return (uint16_t)(((channel(rgb, 16) & 0xF8) << 8) |
+                    ((channel(rgb, 8) & 0xFC) << 3) | (channel(rgb, 0) >> 3));
+}
+
+/* c1 + t * (c2 - c1) per channel, t in 0..65536 */
+static uint16_t lerp565_q16(uint32_t c1, uint32_t c2, int32_t t) {
+  uint32_t out = 0;
+  for (int shift = 0; shift <= 16; shift += 8) {
+    int32_t a = channel(c1, shift);
+    int32_t d = (int32_t)channel(c2, shift) - a;
+    out |= (uint32_t)(a + ((d * t) >> 16)) << shift;
+  }
+  return sankey_raster_rgb565(out);
+}
+
+static uint16_t lerp565_float(uint32_t c1, uint32_t c2, float t) {
+  if (t <= 0.0f)
+    return sankey_raster_rgb565(c1);
+  if (t >= 1.0f)
+    return sankey_raster_rgb565(c2);
+  uint32_t out = 0;
+  for (int shift = 0; shift <= 16; shift += 8) {
+    uint8_t a = channel(c1, shift);
+    uint8_t b = channel(c2, shift);
+    out |= (uint32_t)(uint8_t)(a + t * (b - a)) << shift;
+  }
+  return sankey_raster_rgb565(out);
+}
+
+void sankey_raster_fill(const sankey_raster_t *r, uint16_t color) {
+  if (!r || !r->pixels)
+    return;
+
+  uint32_t word = pair_word(color, color);
+  for (int32_t y = 0; y < r->height; y++) {
+    uint16_t *row = row_ptr(r, y);
+    int32_t x = 0;
+    if (((uintptr_t)row & 3) != 0 && x < r->width)
+      row[x++] = color;
+    uint32_t *pair = (uint32_t *)(row + x);
+    for (; x + 1 < r->width; x += 2)
+      *pair++ = word;
+    if (x < r->width)
+      row[x] = color;
+  }
+}
+
+static void draw_flat(const sankey_raster_t *r, int32_t x_start,
+                      int32_t x_end, float y_top, float y_bot,
+                      uint32_t left_rgb, uint32_t right_rgb, int32_t width) {
+  column_t proto;
+  column_edges_float(&proto, y_top, y_bot);
+  bool gradient = left_rgb != right_rgb;
+  proto.color = sankey_raster_rgb565(left_rgb);
+
+  column_t cols[COLUMN_BATCH];
+  for (int32_t x = x_start; x <= x_end; x += COLUMN_BATCH) {
+    size_t n = (size_t)(x_end - x + 1);
+    if (n > COLUMN_BATCH)
+      n = COLUMN_BATCH;
+    for (size_t i = 0; i < n; i++) {
+      cols[i] = proto;
+      if (gradient)
+        cols[i].color = lerp565_float(
+            left_rgb, right_rgb, (float)(x + (int32_t)i - x_start) / width);
+    }
+    emit_columns(r, x, cols, n);
+  }
+}
+
+void sankey_raster_band(const sankey_raster_t *r, int32_t x_start,
+                        int32_t x_end, float y_top, float y_bot,
+                        uint32_t left_rgb, uint32_t right_rgb) {
+  if (!r || !r->pixels)
+    return;
+  if (x_start > x_end) {
+    int32_t tmp = x_start;
+    x_start = x_end;
+    x_end = tmp;
+    uint32_t tmp_c = left_rgb;
+    left_rgb = right_rgb;
+    right_rgb = tmp_c;
+  }
+  if (y_top > y_bot) {
+    float tmp = y_top;
+    y_top = y_bot;
+    y_bot = tmp;
+  }
+  int32_t width = x_end - x_start;
+  if (width <= 0)
+    return;
+  draw_flat(r, x_start, x_end, y_top, y_bot, left_rgb, right_rgb, width);
+}
+
+void sankey_raster_rect(const sankey_raster_t *r, int32_t x_start,
+                        int32_t x_end, float y_top, float y_bot,
+                        uint16_t color) {
+  if (!r || !r->pixels || x_start > x_end)
+    return;
+
+  column_t proto;
+  column_edges_float(&proto, y_top, y_bot);
+  proto.color = color;
+
+  column_t cols[COLUMN_BATCH];
+  for (size_t i = 0; i < COLUMN_BATCH; i++)
+    cols[i] = proto;
+  for (int32_t x = x_start; x <= x_end; x += COLUMN_BATCH) {
+    size_t n = (size_t)(x_end - x + 1);
+    emit_columns(r, x, cols, n > COLUMN_BATCH ? COLUMN_BATCH : n);
+  }
+}
+
+static int64_t to_q32(double v) {
+  return (int64_t)(v * 4294967296.0 + (v >= 0 ? 0.5 : -0.5));
+}
+
+static int32_t to_q16(float v) {
+  return (int32_t)(v * 65536.0f + (v >= 0 ? 0.5f : -0.5f));
+}
+
+/*
+ * p(u) = ya + (yb - ya) * (3u^2 - 2u^3), sampled at u0, u0 + h, ...
+ * Differences are exact for a cubic, so 32 fractional bits keep the
+ * accumulated error well below 1/256 px over a full screen width.
+ */
+static void edge_init(edge_t *e, float ya, float yb, double u0, double h) {
+  double c = 3.0 * ((double)yb - ya);
+  double d = -2.0 * ((double)yb - ya);
+  double h2 = h * h, h3 = h2 * h;
+
+  e->y = to_q32(ya + c * u0 * u0 + d * u0 * u0 * u0);
+  e->d1 = to_q32(c * (2.0 * u0 * h + h2) +
+                 d * (3.0 * u0 * u0 * h + 3.0 * u0 * h2 + h3));
+  e->d2 = to_q32(2.0 * c * h2 + d * (6.0 * u0 * h2 + 6.0 * h3));
+  e->d3 = to_q32(6.0 * d * h3);
+}
+
+static inline int32_t edge_step(edge_t *e) {
+  int32_t y = (int32_t)(e->y >> 16);
+  e->y += e->d1;
+  e->d1 += e->d2;
+  e->d2 += e->d3;
+  return y;
+}
+
+void sankey_raster_ribbon(const sankey_raster_t *r, float x0, float y0_top,
+                          float y0_bot, float x3, float y3_top, float y3_bot,
+                          uint32_t start_rgb, uint32_t end_rgb) {
+  if (!r || !r->pixels || !(x3 > x0))
+    return;
+
+  int32_t x_first = (int32_t)(x0 + 0.5f);
+  int32_t x_last = (int32_t)(x3 + 0.5f);
+  double h = 1.0 / ((double)x3 - x0);
+  double u0 = ((double)x_first - x0) * h;
+
+  edge_t top, bot;
+  edge_init(&top, y0_top, y3_top, u0, h);
+  edge_init(&bot, y0_bot, y3_bot, u0, h);
+
+  /* Columns rounded in from outside [x0, x3] clamp to the end points */
+  int32_t start_top = to_q16(y0_top), start_bot = to_q16(y0_bot);
+  int32_t end_top = to_q16(y3_top), end_bot = to_q16(y3_bot);
+
+  bool gradient = start_rgb != end_rgb;
+  uint16_t solid = sankey_raster_rgb565(start_rgb);
+  int64_t t = to_q32(u0);
+  int64_t t_step = to_q32(h);
+
+  column_t cols[COLUMN_BATCH];
+  for (int32_t x = x_first; x <= x_last; x += COLUMN_BATCH) {
+    size_t n = (size_t)(x_last - x + 1);
+    if (n > COLUMN_BATCH)
+      n = COLUMN_BATCH;
+    for (size_t i = 0; i < n; i++) {
+      int32_t y_top = edge_step(&top);
+      int32_t y_bot = edge_step(&bot);
+      int32_t t16 = (int32_t)(t >> 16);
+      t += t_step;
+
+      if (t16 < 0) {
+        y_top = start_top;
+        y_bot = start_bot;
+        t16 = 0;
+      } else if (t16 > 0x10000) {
+        y_top = end_top;
+        y_bot = end_bot;
+        t16 = 0x10000;
+      }
+      column_edges_fixed(&cols[i], y_top, y_bot);
+      cols[i].color = gradient ? lerp565_q16(start_rgb, end_rgb, t16) : solid;
+    }
+    emit_columns(r, x, cols, n);
+  }
+}
@@ -0,0 +1,570 @@
+/*
+ * Sankey Raster Test Suite
+ * Compile with: make
+ * Run: ./test_sankey_raster
+ *
+ * The golden images come from the float, per-pixel renderer that
+ * main/ui/sankey.c used before the span rasterizer (reproduced below, with
+ * the ribbon parameter solved exactly instead of by binary search).
+ */
+
+#include "sankey_raster.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+#define BG_RGB 0x101010
+#define WHITE_RGB 0xFFFFFF
+
+/* ---------- Reference renderer (float, one pixel at a time) ---------- */
+
+typedef struct {
+  uint8_t r, g, b;
+} rgb_t;
+
+static rgb_t rgb_of(uint32_t v) {
+  rgb_t c = {(uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v};
+  return c;
+}
+
+static uint16_t rgb_to_u16(rgb_t c) {
+  return ((c.r & 0xF8) << 8) + ((c.g & 0xFC) << 3) + ((c.b & 0xF8) >> 3);
+}
+
+static float bezier_eval(float p0, float p1, float p2, float p3, float t) {
+  float mt = 1.0f - t;
+  float mt2 = mt * mt;
+  float t2 = t * t;
+  return mt2 * mt * p0 + 3.0f * mt2 * t * p1 + 3.0f * mt * t2 * p2 +
+         t2 * t * p3;
+}
+
+static rgb_t color_lerp(rgb_t c1, rgb_t c2, float t) {
+  if (t <= 0.0f)
+    return c1;
+  if (t >= 1.0f)
+    return c2;
+  rgb_t c = {(uint8_t)(c1.r + t * (c2.r - c1.r)),
+             (uint8_t)(c1.g + t * (c2.g - c1.g)),
+             (uint8_t)(c1.b + t * (c2.b - c1.b))};
+  return c;
+}
+
+static void ref_set_pixel(const sankey_raster_t *d, int32_t x, int32_t y,
+                          uint16_t color16) {
+  if (x < 0 || x >= d->width || y < 0 || y >= d->height)
+    return;
+  uint16_t *row = (uint16_t *)((uint8_t *)d->pixels + y * d->stride);
+  row[x] = color16;
+}
+
+static void ref_set_pixel_blended(const sankey_raster_t *d, int32_t x,
+                                  int32_t y, uint16_t fg, uint8_t alpha) {
+  if (x < 0 || x >= d->width || y < 0 || y >= d->height)
+    return;
+  uint16_t *row = (uint16_t *)((uint8_t *)d->pixels + y * d->stride);
+  if (alpha >= 255) {
+    row[x] = fg;
+  } else if (alpha > 0) {
+    uint16_t bg = row[x];
+    uint8_t inv = 255 - alpha;
+    row[x] =
+        ((((fg >> 11) * alpha + (bg >> 11) * inv) / 255) << 11) |
+        (((((fg >> 5) & 0x3F) * alpha + ((bg >> 5) & 0x3F) * inv) / 255) << 5) |
+        (((fg & 0x1F) * alpha + (bg & 0x1F) * inv) / 255);
+  }
+}
+
+static void ref_aa_column(const sankey_raster_t *d, int32_t x, float y_top_f,
+                          float y_bot_f, uint16_t color16) {
+  int32_t y_top = (int32_t)y_top_f;
+  int32_t y_bot = (int32_t)y_bot_f;
+
+  ref_set_pixel_blended(d, x, y_top, color16,
+                        255 - (uint8_t)((y_top_f - y_top) * 255.0f));
+  for (int32_t y = y_top + 1; y < y_bot; y++)
+    ref_set_pixel(d, x, y, color16);
+  if (y_bot > y_top)
+    ref_set_pixel_blended(d, x, y_bot, color16,
+                          (uint8_t)((y_bot_f - y_bot) * 255.0f));
+}
+
+static void ref_fill(const sankey_raster_t *d, uint16_t color) {
+  for (int32_t y = 0; y < d->height; y++)
+    for (int32_t x = 0; x < d->width; x++)
+      ref_set_pixel(d, x, y, color);
+}
+
+static void ref_band(const sankey_raster_t *d, int32_t x_start, int32_t x_end,
+                     float y_top_f, float y_bot_f, uint32_t left,
+                     uint32_t right) {
+  rgb_t left_color = rgb_of(left), right_color = rgb_of(right);
+  if (x_start > x_end) {
+    int32_t tmp = x_start;
+    x_start = x_end;
+    x_end = tmp;
+    rgb_t tmp_c = left_color;
+    left_color = right_color;
+    right_color = tmp_c;
+  }
+  if (y_top_f > y_bot_f) {
+    float tmp = y_top_f;
+    y_top_f = y_bot_f;
+    y_bot_f = tmp;
+  }
+  int32_t width = x_end - x_start;
+  if (width <= 0)
+    return;
+
+  for (int32_t x = x_start; x <= x_end; x++)
+    ref_aa_column(d, x, y_top_f, y_bot_f,
+                  rgb_to_u16(color_lerp(left_color, right_color,
+                                        (float)(x - x_start) / width)));
+}
+
+static void ref_rect(const sankey_raster_t *d, int32_t x_start, int32_t x_end,
+                     float y_top, float y_bot, uint16_t color) {
+  for (int32_t x = x_start; x <= x_end; x++)
+    ref_aa_column(d, x, y_top, y_bot, color);
+}
+
+static void ref_ribbon(const sankey_raster_t *d, float x0, float y0_top,
+                       float y0_bot, float x3, float y3_top, float y3_bot,
+                       uint32_t start, uint32_t end) {
+  rgb_t start_color = rgb_of(start), end_color = rgb_of(end);
+
+  for (int32_t x = (int32_t)(x0 + 0.5f); x <= (int32_t)(x3 + 0.5f); x++) {
+    /* x(t) is linear for evenly spaced control points; the old renderer
+     * approximated this t with a 10-step binary search */
+    float t = (x - x0) / (x3 - x0);
+    if (t < 0.0f)
+      t = 0.0f;
+    if (t > 1.0f)
+      t = 1.0f;
+
+    float y_top_f = bezier_eval(y0_top, y0_top, y3_top, y3_top, t);
+    float y_bot_f = bezier_eval(y0_bot, y0_bot, y3_bot, y3_bot, t);
+    if (y_top_f > y_bot_f) {
+      float tmp = y_top_f;
+      y_top_f = y_bot_f;
+      y_bot_f = tmp;
+    }
+
+    ref_aa_column(d, x, y_top_f, y_bot_f,
+                  rgb_to_u16(color_lerp(start_color, end_color, t)));
+  }
+}
+
+/* The old renderer exactly, for timing only */
+static void legacy_ribbon(const sankey_raster_t *d, float x0, float y0_top,
+                          float y0_bot, float x3, float y3_top, float y3_bot,
+                          uint32_t start, uint32_t end) {
+  rgb_t start_color = rgb_of(start), end_color = rgb_of(end);
+  float dx = (x3 - x0) / 3.0f;
+  float bx1 = x0 + dx, bx2 = x3 - dx;
+
+  for (int32_t x = (int32_t)(x0 + 0.5f); x <= (int32_t)(x3 + 0.5f); x++) {
+    float t_lo = 0.0f, t_hi = 1.0f;
+    for (int i = 0; i < 10; i++) {
+      float t_mid = (t_lo + t_hi) * 0.5f;
+      if (bezier_eval(x0, bx1, bx2, x3, t_mid) < (float)x)
+        t_lo = t_mid;
+      else
+        t_hi = t_mid;
+    }
+    float t = (t_lo + t_hi) * 0.5f;
+
+    float y_top_f = bezier_eval(y0_top, y0_top, y3_top, y3_top, t);
+    float y_bot_f = bezier_eval(y0_bot, y0_bot, y3_bot, y3_bot, t);
+    if (y_top_f > y_bot_f) {
+      float tmp = y_top_f;
+      y_top_f = y_bot_f;
+      y_bot_f = tmp;
+    }
+
+    ref_aa_column(d, x, y_top_f, y_bot_f,
+                  rgb_to_u16(color_lerp(start_color, end_color, t)));
+  }
+}
+
+/* ---------- Scene (same layout as sankey_diagram_render) ---------- */
+
+typedef struct {
+  void (*fill)(const sankey_raster_t *, uint16_t);
+  void (*band)(const sankey_raster_t *, int32_t, int32_t, float, float,
+               uint32_t, uint32_t);
+  void (*rect)(const sankey_raster_t *, int32_t, int32_t, float, float,
+               uint16_t);
+  void (*ribbon)(const sankey_raster_t *, float, float, float, float, float,
+                 float, uint32_t, uint32_t);
+} renderer_t;
+
+static const renderer_t reference = {ref_fill, ref_band, ref_rect, ref_ribbon};
+static const renderer_t legacy = {ref_fill, ref_band, ref_rect, legacy_ribbon};
+static const renderer_t spans = {sankey_raster_fill, sankey_raster_band,
+                                 sankey_raster_rect, sankey_raster_ribbon};
+
+#define MAX_FLOWS 16
+#define MIN_THICKNESS 4
+#define THICKNESS_BUDGET_PCT 30
+
+static void layout(const uint64_t *amounts, size_t count, uint64_t total,
+                   int32_t height, float *thickness, float *y_center) {
+  float budget = height * THICKNESS_BUDGET_PCT / 100.0f;
+  float gap = (count > 1)
+                  ? height * (100 - THICKNESS_BUDGET_PCT) / 100.0f / (count - 1)
+                  : 0;
+  float total_raw = 0;
+  for (size_t i = 0; i < count; i++) {
+    thickness[i] = (float)amounts[i] / total * budget;
+    if (thickness[i] < MIN_THICKNESS)
+      thickness[i] = MIN_THICKNESS;
+    total_raw += thickness[i];
+  }
+  if (total_raw > budget)
+    for (size_t i = 0; i < count; i++)
+      thickness[i] *= budget / total_raw;
+
+  float y = thickness[0] / 2.0f;
+  for (size_t i = 0; i < count; i++) {
+    y_center[i] = y;
+    if (i < count - 1)
+      y += thickness[i] / 2.0f + gap + thickness[i + 1] / 2.0f;
+  }
+}
+
+static void render_scene(const renderer_t *ops, const sankey_raster_t *d,
+                         const uint64_t *in, size_t n_in, const uint64_t *out,
+                         size_t n_out, const uint32_t *colors) {
+  ops->fill(d, sankey_raster_rgb565(BG_RGB));
+
+  uint64_t total = 0;
+  for (size_t i = 0; i < n_in; i++)
+    total += in[i];
+
+  float in_th[MAX_FLOWS], in_y[MAX_FLOWS], out_th[MAX_FLOWS], out_y[MAX_FLOWS];
+  layout(in, n_in, total, d->height, in_th, in_y);
+  layout(out, n_out, total, d->height, out_th, out_y);
+
+  float center_x = d->width / 2.0f, center_y = d->height / 2.0f;
+  float in_stack = 0, out_stack = 0;
+  for (size_t i = 0; i < n_in; i++)
+    in_stack += in_th[i];
+  for (size_t i = 0; i < n_out; i++)
+    out_stack += out_th[i];
+
+  float fade_width = d->width * 0.05f;
+  float fade_start_x = d->width - fade_width;
+  float rect_width = d->width * 0.1f;
+  float rect_left = center_x - rect_width / 2.0f;
+  float rect_right = center_x + rect_width / 2.0f;
+  float stack = in_stack > out_stack ? in_stack : out_stack;
+
+  float y_pos = center_y - in_stack / 2.0f;
+  for (size_t i = 0; i < n_in; i++) {
+    float half = in_th[i] / 2.0f;
+    float pos = y_pos + half;
+    y_pos += in_th[i];
+    ops->band(d, 0, (int32_t)fade_width, in_y[i] - half, in_y[i] + half,
+              BG_RGB, WHITE_RGB);
+    ops->ribbon(d, fade_width, in_y[i] - half, in_y[i] + half, rect_left,
+                pos - half, pos + half, WHITE_RGB, WHITE_RGB);
+  }
+
+  y_pos = center_y - out_stack / 2.0f;
+  for (size_t i = 0; i < n_out; i++) {
+    float half = out_th[i] / 2.0f;
+    float pos = y_pos + half;
+    y_pos += out_th[i];
+    ops->ribbon(d, rect_right, pos - half, pos + half, fade_start_x,
+                out_y[i] - half, out_y[i] + half, WHITE_RGB, colors[i]);
+    ops->band(d, (int32_t)fade_start_x, d->width - 1, out_y[i] - half,
+              out_y[i] + half, colors[i], BG_RGB);
+  }
+
+  ops->rect(d, (int32_t)rect_left, (int32_t)rect_right,
+            center_y - stack / 2.0f, center_y + stack / 2.0f,
+            sankey_raster_rgb565(WHITE_RGB));
+}
+
+/* ---------- Helpers ---------- */
+
+#define GUARD 0xA5
+
+typedef struct {
+  sankey_raster_t raster;
+  uint8_t *mem;
+  size_t mem_len;
+} canvas_t;
+
+/* Canvas surrounded by guard bytes; offset misaligns the pixel pointer */
+static canvas_t canvas_new(int32_t width, int32_t height, uint32_t stride,
+                           size_t offset) {
+  canvas_t c;
+  c.mem_len = 64 + offset + (size_t)stride * height + 64;
+  c.mem = malloc(c.mem_len);
+  memset(c.mem, GUARD, c.mem_len);
+  c.raster.pixels = (uint16_t *)(c.mem + 64 + offset);
+  c.raster.width = width;
+  c.raster.height = height;
+  c.raster.stride = stride;
+  return c;
+}
+
+static void canvas_free(canvas_t *c) { free(c->mem); }
+
+static uint16_t px(const sankey_raster_t *r, int32_t x, int32_t y) {
+  return ((const uint16_t *)((const uint8_t *)r->pixels + y * r->stride))[x];
+}
+
+static int channel_diff(uint16_t a, uint16_t b) {
+  int dr = abs((a >> 11) - (b >> 11));
+  int dg = abs(((a >> 5) & 0x3F) - ((b >> 5) & 0x3F));
+  int db = abs((a & 0x1F) - (b & 0x1F));
+  int m = dr > dg ? dr : dg;
+  return m > db ? m : db;
+}
+
+/* Largest per-channel difference and number of differing pixels */
+static int compare(const sankey_raster_t *a, const sankey_raster_t *b,
+                   size_t *differing) {
+  int worst = 0;
+  *differing = 0;
+  for (int32_t y = 0; y < a->height; y++)
+    for (int32_t x = 0; x < a->width; x++) {
+      int d = channel_diff(px(a, x, y), px(b, x, y));
+      if (d) {
+        (*differing)++;
+        if (d > worst)
+          worst = d;
+      }
+    }
+  return worst;
+}
+
+/* Guard bytes outside the pixel area (including stride padding) intact */
+static int guards_intact(const canvas_t *c) {
+  const uint8_t *base = (const uint8_t *)c->raster.pixels;
+  for (const uint8_t *p = c->mem; p < base; p++)
+    if (*p != GUARD)
+      return 0;
+  size_t row_bytes = (size_t)c->raster.width * 2;
+  for (int32_t y = 0; y < c->raster.height; y++)
+    for (size_t i = row_bytes; i < c->raster.stride; i++)
+      if (base[y * c->raster.stride + i] != GUARD)
+        return 0;
+  const uint8_t *end = base + (size_t)c->raster.stride * c->raster.height;
+  for (const uint8_t *p = end; p < c->mem + c->mem_len; p++)
+    if (*p != GUARD)
+      return 0;
+  return 1;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static const uint64_t inputs16[16] = {
+    120000, 5000,  330000, 42000, 9000,   1500000, 77000, 2100,
+    610000, 18000, 900,    25000, 440000, 3000,    99000, 50000};
+static const uint64_t outputs16[16] = {
+    800000, 12000, 4000,  260000, 700,   55000, 91000, 330000,
+    6000,   47000, 21000, 150000, 8000,  2000,  64000, 1100000};
+static const uint32_t colors16[16] = {
+    0xF7931A, 0x00C853, 0x2196F3, 0xE91E63, 0x9C27B0, 0xFFEB3B,
+    0x00BCD4, 0xFF5722, 0x8BC34A, 0x3F51B5, 0xCDDC39, 0x795548,
+    0x607D8B, 0xFFC107, 0x009688, 0xF44336};
+
+/* ---------- Tests ---------- */
+
+static void test_div255_blend(void) {
+  TEST("shift blend matches divide-by-255");
+
+  /* Every fg/bg channel pair and alpha for the 6-bit green channel */
+  sankey_raster_t ref = {0}, out = {0};
+  uint16_t a = 0, b = 0;
+  ref.pixels = &a;
+  out.pixels = &b;
+  ref.width = ref.height = out.width = out.height = 1;
+  ref.stride = out.stride = 2;
+
+  for (uint32_t fg = 0; fg < 64; fg++)
+    for (uint32_t bg = 0; bg < 64; bg += 7)
+      for (int alpha = 1; alpha < 255; alpha += 3) {
+        uint16_t fg16 = (uint16_t)((fg >> 1) << 11 | fg << 5 | (fg >> 1));
+        uint16_t bg16 = (uint16_t)((bg >> 1) << 11 | bg << 5 | (bg >> 1));
+        float y = 1.0f - alpha / 255.0f + 0.0001f;
+        a = b = bg16;
+        ref_rect(&ref, 0, 0, y - 1.0f, 5.0f, fg16);
+        sankey_raster_rect(&out, 0, 0, y - 1.0f, 5.0f, fg16);
+        if (a != b) {
+          FAIL("blend mismatch");
+          return;
+        }
+      }
+  PASS();
+}
+
+static void test_fill(void) {
+  TEST("fill with odd width and unaligned stride");
+
+  canvas_t c = canvas_new(37, 11, 37 * 2 + 2, 2);
+  sankey_raster_fill(&c.raster, 0x1234);
+  for (int32_t y = 0; y < 11; y++)
+    for (int32_t x = 0; x < 37; x++)
+      if (px(&c.raster, x, y) != 0x1234) {
+        FAIL("pixel not filled");
+        canvas_free(&c);
+        return;
+      }
+  if (!guards_intact(&c))
+    FAIL("wrote outside canvas");
+  else
+    PASS();
+  canvas_free(&c);
+}
+
+static void test_band_exact(void) {
+  TEST("gradient band identical to reference");
+
+  canvas_t ref = canvas_new(64, 40, 128, 0);
+  canvas_t out = canvas_new(64, 40, 128, 0);
+  ref_fill(&ref.raster, 0x0841);
+  sankey_raster_fill(&out.raster, 0x0841);
+  ref_band(&ref.raster, 50, 3, 7.3f, 31.77f, 0xF7931A, 0x2196F3);
+  sankey_raster_band(&out.raster, 50, 3, 7.3f, 31.77f, 0xF7931A, 0x2196F3);
+  ref_rect(&ref.raster, 20, 28, 2.6f, 37.1f, 0xFFFF);
+  sankey_raster_rect(&out.raster, 20, 28, 2.6f, 37.1f, 0xFFFF);
+
+  size_t differing;
+  if (compare(&ref.raster, &out.raster, &differing) != 0)
+    FAIL("pixels differ");
+  else
+    PASS();
+  canvas_free(&ref);
+  canvas_free(&out);
+}
+
+static void test_ribbon_close(void) {
+  TEST("ribbon within 1 LSB of reference");
+
+  canvas_t ref = canvas_new(200, 120, 400, 0);
+  canvas_t out = canvas_new(200, 120, 400, 0);
+  ref_fill(&ref.raster, 0);
+  sankey_raster_fill(&out.raster, 0);
+  ref_ribbon(&ref.raster, 10.4f, 5.2f, 17.9f, 187.6f, 90.3f, 103.0f, 0xFFFFFF,
+             0xE91E63);
+  sankey_raster_ribbon(&out.raster, 10.4f, 5.2f, 17.9f, 187.6f, 90.3f, 103.0f,
+                       0xFFFFFF, 0xE91E63);
+
+  size_t differing;
+  int worst = compare(&ref.raster, &out.raster, &differing);
+  char msg[64];
+  snprintf(msg, sizeof(msg), "max diff %d over %zu px", worst, differing);
+  if (worst > 1)
+    FAIL(msg);
+  else
+    PASS();
+  canvas_free(&ref);
+  canvas_free(&out);
+}
+
+static void test_clipping(void) {
+  TEST("primitives clipped to canvas");
+
+  canvas_t c = canvas_new(50, 30, 104, 0);
+  sankey_raster_fill(&c.raster, 0);
+  sankey_raster_ribbon(&c.raster, -20.5f, -15.0f, 10.0f, 70.2f, 20.0f, 45.5f,
+                       0xFFFFFF, 0x00FF00);
+  sankey_raster_band(&c.raster, -10, 80, -3.5f, 40.2f, 0xFF0000, 0x0000FF);
+  sankey_raster_rect(&c.raster, 45, 60, 25.5f, 31.0f, 0xFFFF);
+  if (!guards_intact(&c))
+    FAIL("wrote outside canvas");
+  else
+    PASS();
+  canvas_free(&c);
+}
+
+static void test_golden_scene(int32_t width, int32_t height, uint32_t stride,
+                              size_t offset, const char *name) {
+  TEST(name);
+
+  canvas_t ref = canvas_new(width, height, stride, offset);
+  canvas_t out = canvas_new(width, height, stride, offset);
+  render_scene(&reference, &ref.raster, inputs16, 16, outputs16, 16,
+               colors16);
+  render_scene(&spans, &out.raster, inputs16, 16, outputs16, 16, colors16);
+
+  size_t differing;
+  int worst = compare(&ref.raster, &out.raster, &differing);
+  char msg[96];
+  snprintf(msg, sizeof(msg), "max diff %d over %zu px", worst, differing);
+  if (worst > 1)
+    FAIL(msg);
+  else if (!guards_intact(&out))
+    FAIL("wrote outside canvas");
+  else {
+    printf("(%zu edge px off by 1) ", differing);
+    PASS();
+  }
+  canvas_free(&ref);
+  canvas_free(&out);
+}
+
+static void benchmark(void) {
+  const int32_t width = 680, height = 160;
+  const int rounds = 50;
+  canvas_t c = canvas_new(width, height, width * 2, 0);
+
+  double t0 = now_ms();
+  for (int i = 0; i < rounds; i++)
+    render_scene(&legacy, &c.raster, inputs16, 16, outputs16, 16, colors16);
+  double t1 = now_ms();
+  for (int i = 0; i < rounds; i++)
+    render_scene(&spans, &c.raster, inputs16, 16, outputs16, 16, colors16);
+  double t2 = now_ms();
+
+  printf("\nBenchmark (%dx%d, 16 in / 16 out, %d renders):\n", width, height,
+         rounds);
+  printf("  per-pixel float: %.3f ms/render\n", (t1 - t0) / rounds);
+  printf("  spans:           %.3f ms/render\n", (t2 - t1) / rounds);
+  canvas_free(&c);
+}
+
+int main(void) {
+  printf("Sankey Raster Test Suite\n");
+  printf("========================\n\n");
+
+  test_div255_blend();
+  test_fill();
+  test_band_exact();
+  test_ribbon_close();
+  test_clipping();
+  test_golden_scene(680, 160, 680 * 2, 0, "16x16 scene vs golden (aligned)");
+  test_golden_scene(333, 97, 333 * 2, 2, "16x16 scene vs golden (unaligned)");
+
+  benchmark();
+
+  printf("\n========================\n");
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+
+  return tests_failed > 0 ? 1 : 0;
+}
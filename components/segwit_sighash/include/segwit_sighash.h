@@ -0,0 +1,131 @@
+#ifndef SEGWIT_SIGHASH_H
+#define SEGWIT_SIGHASH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Segwit (BIP143, BIP341) signature hashes with shared midstates
+ *
+ * hashPrevouts, hashSequence and hashOutputs are the same for every input of
+ * a transaction. Computing them inside each signature hash makes signing N
+ * inputs O(N^2); this cache hashes the transaction once and then produces
+ * each input's sighash from a fixed-size preimage.
+ *
+ * Usage: create, add every input then every output in transaction order,
+ * finalize, then call segwit_sighash_input() for each input to sign.
+ *
+ * Taproot (BIP341) key-path hashes use the same pass: add the output spent
+ * by each input as well and call segwit_sighash_taproot_input().
+ *
+ * SIGHASH_SINGLE needs the output at the input's index and is left to the
+ * caller's general-purpose signer, as is ANYONECANPAY for taproot.
+ */
+
+#define SEGWIT_SIGHASH_DEFAULT 0x00 // Taproot only, signs like ALL
+#define SEGWIT_SIGHASH_ALL 0x01
+#define SEGWIT_SIGHASH_NONE 0x02
+#define SEGWIT_SIGHASH_SINGLE 0x03
+#define SEGWIT_SIGHASH_ANYONECANPAY 0x80
+
+#define SEGWIT_SIGHASH_LEN 32
+
+typedef struct segwit_sighash segwit_sighash_t;
+
+/**
+ * @brief Start a cache for one transaction
+ *
+ * @param version Transaction version
+ * @param locktime Transaction locktime
+ * @return New cache, or NULL on allocation failure
+ */
+segwit_sighash_t *segwit_sighash_create(uint32_t version, uint32_t locktime);
+
+/**
+ * @brief Add the next transaction input
+ *
+ * @param txhash Previous transaction hash (internal byte order)
+ * @param index Previous output index
+ * @param sequence Input sequence number
+ * @return false if the cache is already finalized
+ */
+bool segwit_sighash_add_input(segwit_sighash_t *cache, const uint8_t *txhash,
+                              uint32_t index, uint32_t sequence);
+
+/**
+ * @brief Add the output spent by the next input (needed for taproot only)
+ *
+ * Call once per input, in input order.
+ *
+ * @param satoshi Value of the spent output
+ * @param script scriptPubKey of the spent output
+ * @param script_len Length of script
+ * @return false if the cache is already finalized
+ */
+bool segwit_sighash_add_spent_output(segwit_sighash_t *cache, uint64_t satoshi,
+                                     const uint8_t *script, size_t script_len);
+
+/**
+ * @brief Add the next transaction output
+ *
+ * @param satoshi Output value
+ * @param script scriptPubKey
+ * @param script_len Length of script
+ * @return false if the cache is already finalized
+ */
+bool segwit_sighash_add_output(segwit_sighash_t *cache, uint64_t satoshi,
+                               const uint8_t *script, size_t script_len);
+
+/**
+ * @brief Compute the midstates; no inputs or outputs may be added after
+ */
+void segwit_sighash_finalize(segwit_sighash_t *cache);
+
+/**
+ * @brief Signature hash of one input
+ *
+ * @param cache Finalized cache
+ * @param txhash Outpoint hash of the input being signed
+ * @param index Outpoint index of the input being signed
+ * @param sequence Sequence of the input being signed
+ * @param script_code BIP143 scriptCode, without length prefix
+ * @param script_code_len Length of script_code
+ * @param satoshi Value of the output being spent
+ * @param sighash_type SEGWIT_SIGHASH_* type, optionally | ANYONECANPAY
+ * @param hash_out Output buffer of SEGWIT_SIGHASH_LEN bytes
+ * @return false if not finalized or sighash_type is unsupported
+ */
+bool segwit_sighash_input(const segwit_sighash_t *cache, const uint8_t *txhash,
+                          uint32_t index, uint32_t sequence,
+                          const uint8_t *script_code, size_t script_code_len,
+                          uint64_t satoshi, uint32_t sighash_type,
+                          uint8_t *hash_out);
+
+/**
+ * @brief BIP341 key-path signature hash of one input
+ *
+ * @param cache Finalized cache with a spent output for every input
+ * @param input_index Index of the input being signed
+ * @param sighash_type SEGWIT_SIGHASH_DEFAULT, _ALL or _NONE
+ * @param hash_out Output buffer of SEGWIT_SIGHASH_LEN bytes
+ * @return false if spent outputs are missing or the type is unsupported
+ */
+bool segwit_sighash_taproot_input(const segwit_sighash_t *cache,
+                                  uint32_t input_index, uint32_t sighash_type,
+                                  uint8_t *hash_out);
+
+/**
+ * @brief Free a cache
+ */
+void segwit_sighash_destroy(segwit_sighash_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEGWIT_SIGHASH_H
@@ -0,0 +1,255 @@
+#include "segwit_sighash.h"
+
+#include <sha2.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct segwit_sighash {
+  uint32_t version;
+  uint32_t locktime;
+  bool finalized;
+  size_t num_inputs;
+  size_t num_spent; // Spent outputs added, must equal num_inputs for BIP341
+
+  // Running hashes while the transaction is added
+  sha2_256_ctx prevouts_ctx;
+  sha2_256_ctx sequence_ctx;
+  sha2_256_ctx outputs_ctx;
+  sha2_256_ctx amounts_ctx;
+  sha2_256_ctx scriptpubkeys_ctx;
+
+  // BIP341 single-SHA256 midstates; BIP143 hashes them once more
+  uint8_t sha_prevouts[32];
+  uint8_t sha_sequences[32];
+  uint8_t sha_outputs[32];
+  uint8_t sha_amounts[32];
+  uint8_t sha_scriptpubkeys[32];
+  uint8_t hash_prevouts[32];
+  uint8_t hash_sequence[32];
+  uint8_t hash_outputs[32];
+};
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+  put_u32(p, (uint32_t)v);
+  put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+// Bitcoin CompactSize; returns bytes written (at most 9)
+static size_t put_varint(uint8_t *p, uint64_t v) {
+  if (v < 0xfd) {
+    p[0] = (uint8_t)v;
+    return 1;
+  }
+  if (v <= 0xffff) {
+    p[0] = 0xfd;
+    p[1] = (uint8_t)v;
+    p[2] = (uint8_t)(v >> 8);
+    return 3;
+  }
+  if (v <= 0xffffffff) {
+    p[0] = 0xfe;
+    put_u32(p + 1, (uint32_t)v);
+    return 5;
+  }
+  p[0] = 0xff;
+  put_u64(p + 1, v);
+  return 9;
+}
+
+// Finish the single SHA-256 in ctx and hash the digest once more
+static void finish_double(sha2_256_ctx *ctx, uint8_t out[32]) {
+  uint8_t first[32];
+  sha2_256_final(ctx, first);
+  sha2_256(first, sizeof(first), out);
+}
+
+segwit_sighash_t *segwit_sighash_create(uint32_t version, uint32_t locktime) {
+  segwit_sighash_t *cache = calloc(1, sizeof(*cache));
+  if (!cache)
+    return NULL;
+
+  cache->version = version;
+  cache->locktime = locktime;
+  sha2_256_init(&cache->prevouts_ctx);
+  sha2_256_init(&cache->sequence_ctx);
+  sha2_256_init(&cache->outputs_ctx);
+  sha2_256_init(&cache->amounts_ctx);
+  sha2_256_init(&cache->scriptpubkeys_ctx);
+  return cache;
+}
+
+bool segwit_sighash_add_input(segwit_sighash_t *cache, const uint8_t *txhash,
+                              uint32_t index, uint32_t sequence) {
+  if (!cache || cache->finalized)
+    return false;
+
+  uint8_t buf[4];
+  sha2_256_update(&cache->prevouts_ctx, txhash, 32);
+  put_u32(buf, index);
+  sha2_256_update(&cache->prevouts_ctx, buf, 4);
+  put_u32(buf, sequence);
+  sha2_256_update(&cache->sequence_ctx, buf, 4);
+  cache->num_inputs++;
+  return true;
+}
+
+bool segwit_sighash_add_spent_output(segwit_sighash_t *cache, uint64_t satoshi,
+                                     const uint8_t *script, size_t script_len) {
+  if (!cache || cache->finalized)
+    return false;
+
+  uint8_t buf[9];
+  put_u64(buf, satoshi);
+  sha2_256_update(&cache->amounts_ctx, buf, 8);
+  size_t n = put_varint(buf, script_len);
+  sha2_256_update(&cache->scriptpubkeys_ctx, buf, n);
+  sha2_256_update(&cache->scriptpubkeys_ctx, script, script_len);
+  cache->num_spent++;
+  return true;
+}
+
+bool segwit_sighash_add_output(segwit_sighash_t *cache, uint64_t satoshi,
+                               const uint8_t *script, size_t script_len) {
+  if (!cache || cache->finalized)
+    return false;
+
+  uint8_t buf[8 + 9];
+  put_u64(buf, satoshi);
+  size_t n = 8 + put_varint(buf + 8, script_len);
+  sha2_256_update(&cache->outputs_ctx, buf, n);
+  sha2_256_update(&cache->outputs_ctx, script, script_len);
+  return true;
+}
+
+void segwit_sighash_finalize(segwit_sighash_t *cache) {
+  if (!cache || cache->finalized)
+    return;
+
+  sha2_256_final(&cache->prevouts_ctx, cache->sha_prevouts);
+  sha2_256_final(&cache->sequence_ctx, cache->sha_sequences);
+  sha2_256_final(&cache->outputs_ctx, cache->sha_outputs);
+  sha2_256_final(&cache->amounts_ctx, cache->sha_amounts);
+  sha2_256_final(&cache->scriptpubkeys_ctx, cache->sha_scriptpubkeys);
+  sha2_256(cache->sha_prevouts, 32, cache->hash_prevouts);
+  sha2_256(cache->sha_sequences, 32, cache->hash_sequence);
+  sha2_256(cache->sha_outputs, 32, cache->hash_outputs);
+  cache->finalized = true;
+}
+
+bool segwit_sighash_input(const segwit_sighash_t *cache, const uint8_t *txhash,
+                          uint32_t index, uint32_t sequence,
+                          const uint8_t *script_code, size_t script_code_len,
+                          uint64_t satoshi, uint32_t sighash_type,
+                          uint8_t *hash_out) {
+  if (!cache || !cache->finalized || !hash_out)
+    return false;
+
+  uint32_t base = sighash_type & 0x1f;
+  bool anyone_can_pay = (sighash_type & SEGWIT_SIGHASH_ANYONECANPAY) != 0;
+  if (base != SEGWIT_SIGHASH_ALL && base != SEGWIT_SIGHASH_NONE)
+    return false;
+
+  static const uint8_t zero[32] = {0};
+  const uint8_t *prevouts = anyone_can_pay ? zero : cache->hash_prevouts;
+  const uint8_t *sequences =
+      (anyone_can_pay || base != SEGWIT_SIGHASH_ALL) ? zero
+                                                     : cache->hash_sequence;
+  const uint8_t *outputs =
+      base == SEGWIT_SIGHASH_ALL ? cache->hash_outputs : zero;
+
+  // Preimage: nVersion, hashPrevouts, hashSequence, outpoint, scriptCode,
+  // amount, nSequence, hashOutputs, nLocktime, sighash type
+  uint8_t buf[36 + 9];
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+
+  put_u32(buf, cache->version);
+  sha2_256_update(&ctx, buf, 4);
+  sha2_256_update(&ctx, prevouts, 32);
+  sha2_256_update(&ctx, sequences, 32);
+
+  memcpy(buf, txhash, 32);
+  put_u32(buf + 32, index);
+  sha2_256_update(&ctx, buf, 36);
+
+  size_t n = put_varint(buf, script_code_len);
+  sha2_256_update(&ctx, buf, n);
+  sha2_256_update(&ctx, script_code, script_code_len);
+
+  put_u64(buf, satoshi);
+  put_u32(buf + 8, sequence);
+  sha2_256_update(&ctx, buf, 12);
+  sha2_256_update(&ctx, outputs, 32);
+
+  put_u32(buf, cache->locktime);
+  put_u32(buf + 4, sighash_type);
+  sha2_256_update(&ctx, buf, 8);
+
+  finish_double(&ctx, hash_out);
+  return true;
+}
+
+bool segwit_sighash_taproot_input(const segwit_sighash_t *cache,
+                                  uint32_t input_index, uint32_t sighash_type,
+                                  uint8_t *hash_out) {
+  if (!cache || !cache->finalized || !hash_out ||
+      cache->num_spent != cache->num_inputs || input_index >= cache->num_inputs)
+    return false;
+  if (sighash_type != SEGWIT_SIGHASH_DEFAULT &&
+      sighash_type != SEGWIT_SIGHASH_ALL && sighash_type != SEGWIT_SIGHASH_NONE)
+    return false;
+
+  // Tagged hash prefix: SHA256("TapSighash") twice
+  uint8_t tag[32];
+  sha2_256((const uint8_t *)"TapSighash", 10, tag);
+
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, tag, 32);
+  sha2_256_update(&ctx, tag, 32);
+
+  // Epoch, hash_type, nVersion, nLockTime
+  uint8_t buf[10];
+  buf[0] = 0x00;
+  buf[1] = (uint8_t)sighash_type;
+  put_u32(buf + 2, cache->version);
+  put_u32(buf + 6, cache->locktime);
+  sha2_256_update(&ctx, buf, 10);
+
+  sha2_256_update(&ctx, cache->sha_prevouts, 32);
+  sha2_256_update(&ctx, cache->sha_amounts, 32);
+  sha2_256_update(&ctx, cache->sha_scriptpubkeys, 32);
+  sha2_256_update(&ctx, cache->sha_sequences, 32);
+  if (sighash_type != SEGWIT_SIGHASH_NONE)
+    sha2_256_update(&ctx, cache->sha_outputs, 32);
+
+  // spend_type 0 (key path, no annex), then the input index
+  buf[0] = 0x00;
+  put_u32(buf + 1, input_index);
+  sha2_256_update(&ctx, buf, 5);
+
+  sha2_256_final(&ctx, hash_out);
+  return true;
+}
+
+void segwit_sighash_destroy(segwit_sighash_t *cache) {
+  if (!cache)
+    return;
+  if (!cache->finalized) {
+    // Release the running contexts (needed by the mbedtls backend)
+    uint8_t scratch[32];
+    sha2_256_final(&cache->prevouts_ctx, scratch);
+    sha2_256_final(&cache->sequence_ctx, scratch);
+    sha2_256_final(&cache->outputs_ctx, scratch);
+    sha2_256_final(&cache->amounts_ctx, scratch);
+    sha2_256_final(&cache->scriptpubkeys_ctx, scratch);
+  }
+  free(cache);
+}
@@ -0,0 +1,464 @@
+/*
+ * Segwit Sighash Test Suite
+ * Compile with: make
+ * Run: ./test_segwit_sighash
+ *
+ * Vectors are the native P2WPKH example from BIP143; the taproot hashes were
+ * generated with an independent Python implementation of BIP341. The reference signer
+ * below recomputes hashPrevouts/hashSequence/hashOutputs for every input,
+ * which is what wally_psbt_sign() does per call; the benchmark compares it
+ * against the cached midstates on synthetic 10, 100 and 500-input PSBTs.
+ */
+
+#include "segwit_sighash.h"
+#include "sha2.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static void hex_to_bytes(const char *hex, uint8_t *out) {
+  for (size_t i = 0; hex[i * 2]; i++) {
+    unsigned v;
+    sscanf(hex + i * 2, "%2x", &v);
+    out[i] = (uint8_t)v;
+  }
+}
+
+static bool hash_equals_hex(const uint8_t *hash, const char *hex) {
+  uint8_t expected[32];
+  hex_to_bytes(hex, expected);
+  return memcmp(hash, expected, 32) == 0;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ---------- Synthetic transactions ---------- */
+
+typedef struct {
+  uint8_t txhash[32];
+  uint32_t index;
+  uint32_t sequence;
+  uint64_t satoshi;
+} test_input_t;
+
+typedef struct {
+  uint64_t satoshi;
+  uint8_t script[22]; // P2WPKH
+} test_output_t;
+
+typedef struct {
+  uint32_t version;
+  uint32_t locktime;
+  size_t num_inputs;
+  size_t num_outputs;
+  test_input_t *inputs;
+  test_output_t *outputs;
+} test_tx_t;
+
+static uint32_t rng_state = 0x5eed1234;
+static uint32_t rng(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static test_tx_t make_tx(size_t num_inputs, size_t num_outputs) {
+  test_tx_t tx = {2, 800000, num_inputs, num_outputs, NULL, NULL};
+  tx.inputs = calloc(num_inputs, sizeof(test_input_t));
+  tx.outputs = calloc(num_outputs, sizeof(test_output_t));
+  for (size_t i = 0; i < num_inputs; i++) {
+    for (int b = 0; b < 32; b++)
+      tx.inputs[i].txhash[b] = (uint8_t)rng();
+    tx.inputs[i].index = rng() % 4;
+    tx.inputs[i].sequence = 0xfffffffd;
+    tx.inputs[i].satoshi = 10000 + rng() % 1000000;
+  }
+  for (size_t i = 0; i < num_outputs; i++) {
+    tx.outputs[i].satoshi = 5000 + rng() % 1000000;
+    tx.outputs[i].script[0] = 0x00;
+    tx.outputs[i].script[1] = 0x14;
+    for (int b = 2; b < 22; b++)
+      tx.outputs[i].script[b] = (uint8_t)rng();
+  }
+  return tx;
+}
+
+static void free_tx(test_tx_t *tx) {
+  free(tx->inputs);
+  free(tx->outputs);
+}
+
+static segwit_sighash_t *cache_for_tx(const test_tx_t *tx) {
+  segwit_sighash_t *cache = segwit_sighash_create(tx->version, tx->locktime);
+  for (size_t i = 0; i < tx->num_inputs; i++)
+    segwit_sighash_add_input(cache, tx->inputs[i].txhash, tx->inputs[i].index,
+                             tx->inputs[i].sequence);
+  for (size_t i = 0; i < tx->num_outputs; i++)
+    segwit_sighash_add_output(cache, tx->outputs[i].satoshi,
+                              tx->outputs[i].script, 22);
+  segwit_sighash_finalize(cache);
+  return cache;
+}
+
+static void p2wpkh_script_code(const uint8_t *witness_program,
+                               uint8_t code[25]) {
+  code[0] = 0x76;
+  code[1] = 0xa9;
+  code[2] = 0x14;
+  memcpy(code + 3, witness_program, 20);
+  code[23] = 0x88;
+  code[24] = 0xac;
+}
+
+/* ---------- Reference (per-input midstates) ---------- */
+
+static void le32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++)
+    p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void le64(uint8_t *p, uint64_t v) {
+  for (int i = 0; i < 8; i++)
+    p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void dsha(const uint8_t *data, size_t len, uint8_t out[32]) {
+  sha2_256_ctx ctx;
+  uint8_t first[32];
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, data, len);
+  sha2_256_final(&ctx, first);
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, first, 32);
+  sha2_256_final(&ctx, out);
+}
+
+/* SIGHASH_ALL only; serializes the whole transaction for every input */
+static void ref_sighash_all(const test_tx_t *tx, size_t n,
+                            const uint8_t *script_code, uint8_t out[32]) {
+  size_t cap = tx->num_inputs * 36 + tx->num_outputs * 31 + 256;
+  uint8_t *buf = malloc(cap);
+  uint8_t hash_prevouts[32], hash_sequence[32], hash_outputs[32];
+  size_t len = 0;
+
+  for (size_t i = 0; i < tx->num_inputs; i++) {
+    memcpy(buf + len, tx->inputs[i].txhash, 32);
+    le32(buf + len + 32, tx->inputs[i].index);
+    len += 36;
+  }
+  dsha(buf, len, hash_prevouts);
+
+  len = 0;
+  for (size_t i = 0; i < tx->num_inputs; i++, len += 4)
+    le32(buf + len, tx->inputs[i].sequence);
+  dsha(buf, len, hash_sequence);
+
+  len = 0;
+  for (size_t i = 0; i < tx->num_outputs; i++) {
+    le64(buf + len, tx->outputs[i].satoshi);
+    buf[len + 8] = 22;
+    memcpy(buf + len + 9, tx->outputs[i].script, 22);
+    len += 31;
+  }
+  dsha(buf, len, hash_outputs);
+
+  len = 0;
+  le32(buf, tx->version);
+  memcpy(buf + 4, hash_prevouts, 32);
+  memcpy(buf + 36, hash_sequence, 32);
+  memcpy(buf + 68, tx->inputs[n].txhash, 32);
+  le32(buf + 100, tx->inputs[n].index);
+  buf[104] = 25;
+  memcpy(buf + 105, script_code, 25);
+  le64(buf + 130, tx->inputs[n].satoshi);
+  le32(buf + 138, tx->inputs[n].sequence);
+  memcpy(buf + 142, hash_outputs, 32);
+  le32(buf + 174, tx->locktime);
+  le32(buf + 178, SEGWIT_SIGHASH_ALL);
+  dsha(buf, 182, out);
+  free(buf);
+}
+
+/* ---------- Tests ---------- */
+
+static void test_sha256(void) {
+  TEST("SHA-256 (empty, abc, multi-block)");
+
+  uint8_t out[32];
+  sha2_256_ctx ctx;
+  bool ok = true;
+
+  sha2_256_init(&ctx);
+  sha2_256_final(&ctx, out);
+  ok = ok && hash_equals_hex(out, "e3b0c44298fc1c149afbf4c8996fb92427ae41e46"
+                                  "49b934ca495991b7852b855");
+
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, (const uint8_t *)"abc", 3);
+  sha2_256_final(&ctx, out);
+  ok = ok && hash_equals_hex(out, "ba7816bf8f01cfea414140de5dae2223b00361a39"
+                                  "6177a9cb410ff61f20015ad");
+
+  /* 56-byte message split across updates crosses the padding boundary */
+  const char *msg = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, (const uint8_t *)msg, 5);
+  sha2_256_update(&ctx, (const uint8_t *)msg + 5, strlen(msg) - 5);
+  sha2_256_final(&ctx, out);
+  ok = ok && hash_equals_hex(out, "248d6a61d20638b8e5c026930c3e6039a33ce4596"
+                                  "4ff2167f6ecedd419db06c1");
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("digest mismatch");
+  }
+}
+
+/* BIP143 native P2WPKH example, input 1 */
+static const char *bip143_txhash[2] = {
+    "fff7f7881a8099afa6940d42d1e7f6362bec38171ea3edf433541db4e4ad969f",
+    "ef51e1b804cc89d182d279655c3aa89e815b1b309fe287d9b2b55d57b90ec68a"};
+static const uint32_t bip143_index[2] = {0, 1};
+static const uint32_t bip143_sequence[2] = {0xffffffee, 0xffffffff};
+static const char *bip143_out_script[2] = {
+    "76a9148280b37df378db99f66f85c95a783a76ac7a6d5988ac",
+    "76a9143bde42dbee7e4dbe6a21b2d50ce2f0167faa815988ac"};
+static const uint64_t bip143_out_value[2] = {112340000, 223450000};
+static const char *bip143_script_code =
+    "76a9141d0f172a0ecb48aee1be1f2687d2963ae33f71a188ac";
+
+static segwit_sighash_t *bip143_cache_spending(bool with_spent) {
+  segwit_sighash_t *cache = segwit_sighash_create(1, 0x11);
+  uint8_t buf[34];
+  for (int i = 0; i < 2; i++) {
+    hex_to_bytes(bip143_txhash[i], buf);
+    segwit_sighash_add_input(cache, buf, bip143_index[i], bip143_sequence[i]);
+  }
+  /* Pretend both inputs spend P2TR outputs */
+  for (int i = 0; i < 2 && with_spent; i++) {
+    buf[0] = 0x51;
+    buf[1] = 0x20;
+    memset(buf + 2, 0x11 * (i + 1), 32);
+    segwit_sighash_add_spent_output(cache, i ? 600000000 : 625000000, buf,
+                                    34);
+  }
+  for (int i = 0; i < 2; i++) {
+    hex_to_bytes(bip143_out_script[i], buf);
+    segwit_sighash_add_output(cache, bip143_out_value[i], buf, 25);
+  }
+  segwit_sighash_finalize(cache);
+  return cache;
+}
+
+static segwit_sighash_t *bip143_cache(void) {
+  return bip143_cache_spending(false);
+}
+
+static bool bip143_input1(segwit_sighash_t *cache, uint32_t type,
+                          uint8_t out[32]) {
+  uint8_t txhash[32], code[25];
+  hex_to_bytes(bip143_txhash[1], txhash);
+  hex_to_bytes(bip143_script_code, code);
+  return segwit_sighash_input(cache, txhash, 1, 0xffffffff, code, 25,
+                              600000000, type, out);
+}
+
+static void test_bip143_p2wpkh(void) {
+  TEST("BIP143 native P2WPKH vector");
+
+  segwit_sighash_t *cache = bip143_cache();
+  uint8_t out[32];
+  bool ok = bip143_input1(cache, SEGWIT_SIGHASH_ALL, out) &&
+            hash_equals_hex(out, "c37af31116d1b27caf68aae9e3ac82f1477929014d5b"
+                                 "917657d0eb49478cb670");
+  segwit_sighash_destroy(cache);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("sighash mismatch");
+  }
+}
+
+static void test_sighash_types(void) {
+  TEST("NONE/ANYONECANPAY zero the skipped midstates, SINGLE refused");
+
+  segwit_sighash_t *cache = bip143_cache();
+  uint8_t out[32];
+  bool ok =
+      bip143_input1(cache, SEGWIT_SIGHASH_ALL | SEGWIT_SIGHASH_ANYONECANPAY,
+                    out) &&
+      hash_equals_hex(out, "fc5b6bbc855883bcfdaefb77071740ccde4929f15e6a1328"
+                           "6584e779b2529d91");
+  ok = ok &&
+       bip143_input1(cache, SEGWIT_SIGHASH_NONE | SEGWIT_SIGHASH_ANYONECANPAY,
+                     out) &&
+       hash_equals_hex(out, "4abb5ef58a968f8e1ab88a9fb72f2ce74b3022e65d334ac7"
+                            "b8aeda747515dc15");
+  ok = ok && !bip143_input1(cache, SEGWIT_SIGHASH_SINGLE, out);
+  segwit_sighash_destroy(cache);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("sighash mismatch");
+  }
+}
+
+static void test_taproot_key_path(void) {
+  TEST("BIP341 key-path sighash (DEFAULT, ALL, NONE)");
+
+  segwit_sighash_t *cache = bip143_cache_spending(true);
+  uint8_t out[32];
+  bool ok =
+      segwit_sighash_taproot_input(cache, 1, SEGWIT_SIGHASH_DEFAULT, out) &&
+      hash_equals_hex(out, "8c21354cb362ad61d15b6cb655553932111b4da3f74f64ac"
+                           "dccac0b6466f68b6");
+  ok = ok && segwit_sighash_taproot_input(cache, 0, SEGWIT_SIGHASH_ALL, out) &&
+       hash_equals_hex(out, "3e641b6a0c9f7d2010e60f1d714e0a24094c477f279cd7c3"
+                            "262de2f574432dde");
+  ok = ok && segwit_sighash_taproot_input(cache, 1, SEGWIT_SIGHASH_NONE, out) &&
+       hash_equals_hex(out, "96cb7c09d265b4c9d7020f5742747983f1ce6f806156656b"
+                            "ed04cc9a1a503f11");
+  ok = ok && !segwit_sighash_taproot_input(cache, 2, SEGWIT_SIGHASH_ALL, out) &&
+       !segwit_sighash_taproot_input(
+           cache, 0, SEGWIT_SIGHASH_ALL | SEGWIT_SIGHASH_ANYONECANPAY, out);
+  segwit_sighash_destroy(cache);
+
+  /* Without spent outputs only BIP143 hashes are available */
+  cache = bip143_cache();
+  ok = ok && !segwit_sighash_taproot_input(cache, 0, SEGWIT_SIGHASH_ALL, out);
+  segwit_sighash_destroy(cache);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("sighash mismatch");
+  }
+}
+
+static void test_state_checks(void) {
+  TEST("inputs rejected after finalize, sighash before");
+
+  segwit_sighash_t *cache = segwit_sighash_create(2, 0);
+  uint8_t txhash[32] = {0}, code[25] = {0}, out[32];
+  bool ok = segwit_sighash_add_input(cache, txhash, 0, 0xffffffff) &&
+            !segwit_sighash_input(cache, txhash, 0, 0xffffffff, code, 25, 1,
+                                  SEGWIT_SIGHASH_ALL, out);
+  segwit_sighash_finalize(cache);
+  ok = ok && !segwit_sighash_add_input(cache, txhash, 1, 0xffffffff) &&
+       !segwit_sighash_add_output(cache, 1, code, 22);
+  segwit_sighash_destroy(cache);
+
+  /* Unfinalized caches release their running hashes */
+  cache = segwit_sighash_create(2, 0);
+  segwit_sighash_add_input(cache, txhash, 0, 0xffffffff);
+  segwit_sighash_destroy(cache);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("state not enforced");
+  }
+}
+
+static void test_matches_reference(void) {
+  TEST("cached sighash matches per-input recomputation (50 inputs)");
+
+  test_tx_t tx = make_tx(50, 3);
+  segwit_sighash_t *cache = cache_for_tx(&tx);
+  bool ok = true;
+
+  for (size_t i = 0; i < tx.num_inputs && ok; i++) {
+    uint8_t code[25], expected[32], got[32];
+    p2wpkh_script_code(tx.outputs[i % 3].script + 2, code);
+    ref_sighash_all(&tx, i, code, expected);
+    ok = segwit_sighash_input(cache, tx.inputs[i].txhash, tx.inputs[i].index,
+                              tx.inputs[i].sequence, code, sizeof(code),
+                              tx.inputs[i].satoshi, SEGWIT_SIGHASH_ALL, got) &&
+         memcmp(expected, got, 32) == 0;
+  }
+
+  segwit_sighash_destroy(cache);
+  free_tx(&tx);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("mismatch");
+  }
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench_sign_all_inputs(void) {
+  static const size_t sizes[] = {10, 100, 500};
+
+  printf("\nSighash for every input of a PSBT (2 outputs):\n");
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    test_tx_t tx = make_tx(sizes[s], 2);
+    uint8_t code[25], out[32];
+    volatile uint8_t sink = 0;
+    p2wpkh_script_code(tx.outputs[0].script + 2, code);
+
+    double t0 = now_ms();
+    for (size_t i = 0; i < tx.num_inputs; i++) {
+      ref_sighash_all(&tx, i, code, out);
+      sink ^= out[0];
+    }
+    double t1 = now_ms();
+    segwit_sighash_t *cache = cache_for_tx(&tx);
+    for (size_t i = 0; i < tx.num_inputs; i++) {
+      segwit_sighash_input(cache, tx.inputs[i].txhash, tx.inputs[i].index,
+                           tx.inputs[i].sequence, code, sizeof(code),
+                           tx.inputs[i].satoshi, SEGWIT_SIGHASH_ALL, out);
+      sink ^= out[0];
+    }
+    segwit_sighash_destroy(cache);
+    double t2 = now_ms();
+    (void)sink;
+
+    printf("  %3zu inputs: per-input midstates %8.2f ms, cached %6.2f ms\n",
+           sizes[s], t1 - t0, t2 - t1);
+    free_tx(&tx);
+  }
+  printf("\n");
+}
+
+int main(void) {
+  printf("=== Segwit Sighash Tests ===\n\n");
+
+  test_sha256();
+  test_bip143_p2wpkh();
+  test_sighash_types();
+  test_taproot_key_path();
+  test_state_checks();
+  test_matches_reference();
+
+  bench_sign_all_inputs();
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
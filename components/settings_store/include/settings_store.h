@@ -0,0 +1,164 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Write-back cache of small integer settings over a key-value store
+ *
+ * A caller-defined schema lists every setting (namespace, key, type,
+ * default and valid range). All values are read from the backend once at
+ * init; getters then read RAM only. A setter validates against the schema
+ * and writes through with one commit, or, inside a batch, only marks the
+ * key dirty so that settings_store_commit() writes every changed key and
+ * commits each touched namespace once.
+ *
+ * Keys flagged SETTINGS_FLAG_IMMEDIATE (counters that must survive a power
+ * cut) always write and commit on set, batch or not. If that fails the
+ * cache keeps the old value, so callers must check the result before
+ * acting on the new one.
+ *
+ * The backend is a small vtable so the same schema runs against NVS on the
+ * device and against an in-memory map in host tests.
+ */
+
+#define SETTINGS_STORE_MAX_KEYS 32
+#define SETTINGS_STORE_MAX_LISTENERS 4
+
+#define SETTINGS_FLAG_IMMEDIATE 0x01
+
+typedef enum {
+  SETTINGS_TYPE_U8 = 0,
+  SETTINGS_TYPE_U16,
+} settings_type_t;
+
+typedef enum {
+  SETTINGS_STORE_OK = 0,
+  SETTINGS_STORE_ERR_ARG,     // Unknown id or bad schema
+  SETTINGS_STORE_ERR_RANGE,   // Value outside the schema range
+  SETTINGS_STORE_ERR_STATE,   // No backend, or batch misuse
+  SETTINGS_STORE_ERR_BACKEND, // Backend read/write/commit failed
+} settings_store_err_t;
+
+typedef struct {
+  const char *ns;  // Backend namespace (e.g. NVS namespace, max 15 chars)
+  const char *key; // Backend key (max 15 chars for NVS)
+  settings_type_t type;
+  uint16_t def;
+  uint16_t min;
+  uint16_t max;
+  uint8_t flags;
+} settings_key_t;
+
+typedef struct {
+  // Read a stored value; false if absent or unreadable
+  bool (*get)(void *ctx, const char *ns, const char *key,
+              settings_type_t type, uint16_t *value);
+  bool (*set)(void *ctx, const char *ns, const char *key,
+              settings_type_t type, uint16_t value);
+  bool (*commit)(void *ctx, const char *ns);
+  // Erase every key of a namespace and commit
+  bool (*erase_ns)(void *ctx, const char *ns);
+} settings_backend_t;
+
+/**
+ * @brief Called after a setting's cached value changed
+ */
+typedef void (*settings_listener_t)(size_t id, uint16_t value,
+                                    void *user_data);
+
+typedef struct {
+  const settings_key_t *schema;
+  size_t count;
+  const settings_backend_t *backend; // NULL: defaults only, sets fail
+  void *ctx;
+
+  uint16_t values[SETTINGS_STORE_MAX_KEYS];
+  uint16_t batch_start[SETTINGS_STORE_MAX_KEYS]; // For abort
+  uint32_t dirty;                                // Bit per id
+  bool in_batch;
+
+  struct {
+    settings_listener_t cb;
+    void *user_data;
+  } listeners[SETTINGS_STORE_MAX_LISTENERS];
+} settings_store_t;
+
+/**
+ * @brief Bind a schema to a backend and load every value
+ *
+ * Missing or out-of-range stored values load as the schema default.
+ *
+ * @param schema Settings, indexed by id (must outlive the store)
+ * @param count Number of settings (at most SETTINGS_STORE_MAX_KEYS)
+ * @param backend Backend, or NULL to serve defaults only
+ * @param ctx Passed to every backend call
+ */
+settings_store_err_t settings_store_init(settings_store_t *store,
+                                         const settings_key_t *schema,
+                                         size_t count,
+                                         const settings_backend_t *backend,
+                                         void *ctx);
+
+/**
+ * @brief Cached value of a setting (0 for an unknown id)
+ */
+uint16_t settings_store_get(const settings_store_t *store, size_t id);
+
+/**
+ * @brief Change a setting
+ *
+ * Outside a batch (or for SETTINGS_FLAG_IMMEDIATE keys) the value is
+ * written and committed before returning. Setting the cached value again
+ * writes nothing. On SETTINGS_STORE_ERR_BACKEND an immediate key is rolled
+ * back without notifying listeners; any other key keeps the new value,
+ * dirty, for the next commit to retry.
+ */
+settings_store_err_t settings_store_set(settings_store_t *store, size_t id,
+                                        uint16_t value);
+
+/**
+ * @brief Defer writes until settings_store_commit() or _abort()
+ */
+settings_store_err_t settings_store_begin(settings_store_t *store);
+
+/**
+ * @brief Write every key changed in the batch, one commit per namespace
+ *
+ * On a backend error the cache keeps the new values and the unwritten keys
+ * stay dirty; another commit retries them.
+ */
+settings_store_err_t settings_store_commit(settings_store_t *store);
+
+/**
+ * @brief Drop the batch, restoring (and announcing) the previous values
+ */
+void settings_store_abort(settings_store_t *store);
+
+/**
+ * @brief Erase a namespace in the backend and reload its defaults
+ */
+settings_store_err_t settings_store_reset_ns(settings_store_t *store,
+                                             const char *ns);
+
+/**
+ * @brief Register a change listener
+ * @return false if all listener slots are taken
+ */
+bool settings_store_subscribe(settings_store_t *store, settings_listener_t cb,
+                              void *user_data);
+
+void settings_store_unsubscribe(settings_store_t *store,
+                                settings_listener_t cb, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SETTINGS_STORE_H
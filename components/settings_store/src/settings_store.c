@@ -0,0 +1,216 @@
+/*
+ * Write-back cache of small integer settings over a key-value store
+ */
+
+#include "settings_store.h"
+#include <string.h>
+
+static bool in_range(const settings_key_t *k, uint16_t value) {
+  uint16_t type_max = (k->type == SETTINGS_TYPE_U8) ? UINT8_MAX : UINT16_MAX;
+  return value >= k->min && value <= k->max && value <= type_max;
+}
+
+static void notify(settings_store_t *store, size_t id) {
+  for (size_t i = 0; i < SETTINGS_STORE_MAX_LISTENERS; i++) {
+    if (store->listeners[i].cb)
+      store->listeners[i].cb(id, store->values[id],
+                             store->listeners[i].user_data);
+  }
+}
+
+static bool write_through(settings_store_t *store, size_t id) {
+  const settings_key_t *k = &store->schema[id];
+  return store->backend->set(store->ctx, k->ns, k->key, k->type,
+                             store->values[id]) &&
+         store->backend->commit(store->ctx, k->ns);
+}
+
+settings_store_err_t settings_store_init(settings_store_t *store,
+                                         const settings_key_t *schema,
+                                         size_t count,
+                                         const settings_backend_t *backend,
+                                         void *ctx) {
+  if (!store || !schema || count == 0 || count > SETTINGS_STORE_MAX_KEYS)
+    return SETTINGS_STORE_ERR_ARG;
+
+  memset(store, 0, sizeof(*store));
+  store->schema = schema;
+  store->count = count;
+  store->backend = backend;
+  store->ctx = ctx;
+
+  for (size_t id = 0; id < count; id++) {
+    const settings_key_t *k = &schema[id];
+    if (!k->ns || !k->key || !in_range(k, k->def))
+      return SETTINGS_STORE_ERR_ARG;
+
+    uint16_t value = k->def;
+    if (backend && backend->get(ctx, k->ns, k->key, k->type, &value) &&
+        in_range(k, value))
+      store->values[id] = value;
+    else
+      store->values[id] = k->def;
+  }
+  return SETTINGS_STORE_OK;
+}
+
+uint16_t settings_store_get(const settings_store_t *store, size_t id) {
+  if (!store || id >= store->count)
+    return 0;
+  return store->values[id];
+}
+
+settings_store_err_t settings_store_set(settings_store_t *store, size_t id,
+                                        uint16_t value) {
+  if (!store || id >= store->count)
+    return SETTINGS_STORE_ERR_ARG;
+  if (!store->backend)
+    return SETTINGS_STORE_ERR_STATE;
+
+  const settings_key_t *k = &store->schema[id];
+  if (!in_range(k, value))
+    return SETTINGS_STORE_ERR_RANGE;
+
+  bool immediate = !store->in_batch || (k->flags & SETTINGS_FLAG_IMMEDIATE);
+  if (value == store->values[id] && !(store->dirty & (1u << id)))
+    return SETTINGS_STORE_OK;
+
+  uint16_t previous = store->values[id];
+  store->values[id] = value;
+  if (immediate) {
+    if (!write_through(store, id)) {
+      if (k->flags & SETTINGS_FLAG_IMMEDIATE) {
+        // Never cache a counter that isn't on flash: a caller going ahead
+        // on it would lose the value to a power cut
+        store->values[id] = previous;
+        return SETTINGS_STORE_ERR_BACKEND;
+      }
+      store->dirty |= 1u << id;
+      notify(store, id);
+      return SETTINGS_STORE_ERR_BACKEND;
+    }
+    store->dirty &= ~(1u << id);
+    // Already persisted, so an abort must not roll it back
+    store->batch_start[id] = value;
+  } else {
+    store->dirty |= 1u << id;
+  }
+  notify(store, id);
+  return SETTINGS_STORE_OK;
+}
+
+settings_store_err_t settings_store_begin(settings_store_t *store) {
+  if (!store || !store->schema)
+    return SETTINGS_STORE_ERR_ARG;
+  if (store->in_batch)
+    return SETTINGS_STORE_ERR_STATE;
+  memcpy(store->batch_start, store->values, sizeof(store->values));
+  store->in_batch = true;
+  return SETTINGS_STORE_OK;
+}
+
+settings_store_err_t settings_store_commit(settings_store_t *store) {
+  if (!store || !store->schema)
+    return SETTINGS_STORE_ERR_ARG;
+  store->in_batch = false;
+  if (store->dirty == 0)
+    return SETTINGS_STORE_OK;
+  if (!store->backend)
+    return SETTINGS_STORE_ERR_STATE;
+
+  settings_store_err_t ret = SETTINGS_STORE_OK;
+  uint32_t written = 0;
+  for (size_t id = 0; id < store->count; id++) {
+    if (!(store->dirty & (1u << id)))
+      continue;
+    const settings_key_t *k = &store->schema[id];
+    if (store->backend->set(store->ctx, k->ns, k->key, k->type,
+                            store->values[id]))
+      written |= 1u << id;
+    else
+      ret = SETTINGS_STORE_ERR_BACKEND;
+  }
+
+  // One commit per namespace, at its first written key
+  for (size_t id = 0; id < store->count; id++) {
+    if (!(written & (1u << id)))
+      continue;
+    const char *ns = store->schema[id].ns;
+    uint32_t same_ns = 0;
+    for (size_t j = id; j < store->count; j++) {
+      if ((written & (1u << j)) && strcmp(store->schema[j].ns, ns) == 0)
+        same_ns |= 1u << j;
+    }
+    if (store->backend->commit(store->ctx, ns))
+      store->dirty &= ~same_ns;
+    else
+      ret = SETTINGS_STORE_ERR_BACKEND;
+    written &= ~same_ns;
+  }
+  return ret;
+}
+
+void settings_store_abort(settings_store_t *store) {
+  if (!store || !store->in_batch)
+    return;
+  store->in_batch = false;
+  for (size_t id = 0; id < store->count; id++) {
+    if (!(store->dirty & (1u << id)))
+      continue;
+    store->dirty &= ~(1u << id);
+    if (store->values[id] != store->batch_start[id]) {
+      store->values[id] = store->batch_start[id];
+      notify(store, id);
+    }
+  }
+}
+
+settings_store_err_t settings_store_reset_ns(settings_store_t *store,
+                                             const char *ns) {
+  if (!store || !store->schema || !ns)
+    return SETTINGS_STORE_ERR_ARG;
+  if (!store->backend)
+    return SETTINGS_STORE_ERR_STATE;
+  if (!store->backend->erase_ns(store->ctx, ns))
+    return SETTINGS_STORE_ERR_BACKEND;
+
+  for (size_t id = 0; id < store->count; id++) {
+    const settings_key_t *k = &store->schema[id];
+    if (strcmp(k->ns, ns) != 0)
+      continue;
+    store->dirty &= ~(1u << id);
+    store->batch_start[id] = k->def;
+    if (store->values[id] != k->def) {
+      store->values[id] = k->def;
+      notify(store, id);
+    }
+  }
+  return SETTINGS_STORE_OK;
+}
+
+bool settings_store_subscribe(settings_store_t *store, settings_listener_t cb,
+                              void *user_data) {
+  if (!store || !cb)
+    return false;
+  for (size_t i = 0; i < SETTINGS_STORE_MAX_LISTENERS; i++) {
+    if (!store->listeners[i].cb) {
+      store->listeners[i].cb = cb;
+      store->listeners[i].user_data = user_data;
+      return true;
+    }
+  }
+  return false;
+}
+
+void settings_store_unsubscribe(settings_store_t *store,
+                                settings_listener_t cb, void *user_data) {
+  if (!store)
+    return;
+  for (size_t i = 0; i < SETTINGS_STORE_MAX_LISTENERS; i++) {
+    if (store->listeners[i].cb == cb &&
+        store->listeners[i].user_data == user_data) {
+      store->listeners[i].cb = NULL;
+      store->listeners[i].user_data = NULL;
+    }
+  }
+}
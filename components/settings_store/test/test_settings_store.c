@@ -0,0 +1,424 @@
+/*
+ * Settings Store Test Suite
+ * Compile with: make
+ * Run: ./test_settings_store
+ *
+ * Runs a schema shaped like main/core/settings.c (a "settings" and a "pin"
+ * namespace, with an immediate failure counter) against an in-memory
+ * backend that counts writes and commits and can be made to fail.
+ */
+
+#include "settings_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+/* ---------- In-memory backend ---------- */
+
+#define MEM_MAX_ITEMS 32
+
+typedef struct {
+  struct {
+    char ns[16];
+    char key[16];
+    settings_type_t type;
+    uint16_t value;
+    bool used;
+  } items[MEM_MAX_ITEMS];
+  int sets;
+  int commits;
+  bool fail_sets;
+  bool fail_commits;
+} mem_backend_t;
+
+static int mem_find(mem_backend_t *m, const char *ns, const char *key) {
+  for (int i = 0; i < MEM_MAX_ITEMS; i++) {
+    if (m->items[i].used && strcmp(m->items[i].ns, ns) == 0 &&
+        strcmp(m->items[i].key, key) == 0)
+      return i;
+  }
+  return -1;
+}
+
+static bool mem_get(void *ctx, const char *ns, const char *key,
+                    settings_type_t type, uint16_t *value) {
+  mem_backend_t *m = ctx;
+  int i = mem_find(m, ns, key);
+  if (i < 0 || m->items[i].type != type)
+    return false;
+  *value = m->items[i].value;
+  return true;
+}
+
+static bool mem_set(void *ctx, const char *ns, const char *key,
+                    settings_type_t type, uint16_t value) {
+  mem_backend_t *m = ctx;
+  if (m->fail_sets)
+    return false;
+  int i = mem_find(m, ns, key);
+  for (int j = 0; i < 0 && j < MEM_MAX_ITEMS; j++) {
+    if (!m->items[j].used)
+      i = j;
+  }
+  if (i < 0)
+    return false;
+  snprintf(m->items[i].ns, sizeof(m->items[i].ns), "%s", ns);
+  snprintf(m->items[i].key, sizeof(m->items[i].key), "%s", key);
+  m->items[i].type = type;
+  m->items[i].value = value;
+  m->items[i].used = true;
+  m->sets++;
+  return true;
+}
+
+static bool mem_commit(void *ctx, const char *ns) {
+  (void)ns;
+  mem_backend_t *m = ctx;
+  if (m->fail_commits)
+    return false;
+  m->commits++;
+  return true;
+}
+
+static bool mem_erase_ns(void *ctx, const char *ns) {
+  mem_backend_t *m = ctx;
+  for (int i = 0; i < MEM_MAX_ITEMS; i++) {
+    if (m->items[i].used && strcmp(m->items[i].ns, ns) == 0)
+      m->items[i].used = false;
+  }
+  m->commits++;
+  return true;
+}
+
+static const settings_backend_t mem_backend = {
+    .get = mem_get,
+    .set = mem_set,
+    .commit = mem_commit,
+    .erase_ns = mem_erase_ns,
+};
+
+/* ---------- Schema ---------- */
+
+enum { NET, TYPE, BRIGHT, FAIL_CNT, MAX_FAIL, TIMEOUT, NUM_KEYS };
+
+static const settings_key_t schema[NUM_KEYS] = {
+    [NET] = {"settings", "def_net", SETTINGS_TYPE_U8, 0, 0, 1, 0},
+    [TYPE] = {"settings", "def_type", SETTINGS_TYPE_U8, 0, 0, 3, 0},
+    [BRIGHT] = {"settings", "bright", SETTINGS_TYPE_U8, 50, 0, 100, 0},
+    [FAIL_CNT] = {"pin", "fail_cnt", SETTINGS_TYPE_U8, 0, 0, 255,
+                  SETTINGS_FLAG_IMMEDIATE},
+    [MAX_FAIL] = {"pin", "max_fail", SETTINGS_TYPE_U8, 10, 5, 50, 0},
+    [TIMEOUT] = {"pin", "timeout", SETTINGS_TYPE_U16, 300, 0, 65535, 0},
+};
+
+typedef struct {
+  int calls;
+  size_t last_id;
+  uint16_t last_value;
+} listener_log_t;
+
+static void log_listener(size_t id, uint16_t value, void *user_data) {
+  listener_log_t *log = user_data;
+  log->calls++;
+  log->last_id = id;
+  log->last_value = value;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_load_defaults_and_stored(void) {
+  TEST("Load stored values, defaults for missing or out of range");
+  mem_backend_t mem = {0};
+  mem_set(&mem, "settings", "bright", SETTINGS_TYPE_U8, 80);
+  mem_set(&mem, "settings", "def_type", SETTINGS_TYPE_U8, 9); // Out of range
+  mem_set(&mem, "pin", "timeout", SETTINGS_TYPE_U16, 600);
+
+  settings_store_t store;
+  if (settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem) !=
+      SETTINGS_STORE_OK) {
+    FAIL("init failed");
+    return;
+  }
+  if (settings_store_get(&store, BRIGHT) != 80 ||
+      settings_store_get(&store, TYPE) != 0 ||
+      settings_store_get(&store, TIMEOUT) != 600 ||
+      settings_store_get(&store, MAX_FAIL) != 10) {
+    FAIL("wrong loaded values");
+    return;
+  }
+  PASS();
+}
+
+static void test_getters_hit_cache(void) {
+  TEST("Getters never touch the backend");
+  mem_backend_t mem = {0};
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem);
+
+  // Change the backend behind the store's back: the cache wins
+  mem_set(&mem, "settings", "bright", SETTINGS_TYPE_U8, 10);
+  if (settings_store_get(&store, BRIGHT) != 50)
+    FAIL("getter read the backend");
+  else
+    PASS();
+}
+
+static void test_write_through(void) {
+  TEST("Set outside a batch writes and commits once");
+  mem_backend_t mem = {0};
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem);
+
+  if (settings_store_set(&store, BRIGHT, 70) != SETTINGS_STORE_OK ||
+      mem.sets != 1 || mem.commits != 1) {
+    FAIL("expected one write and one commit");
+    return;
+  }
+  // Same value again: nothing to write
+  settings_store_set(&store, BRIGHT, 70);
+  if (mem.sets != 1 || mem.commits != 1) {
+    FAIL("unchanged value was written");
+    return;
+  }
+  uint16_t stored = 0;
+  if (!mem_get(&mem, "settings", "bright", SETTINGS_TYPE_U8, &stored) ||
+      stored != 70) {
+    FAIL("backend not updated");
+    return;
+  }
+  PASS();
+}
+
+static void test_range(void) {
+  TEST("Out-of-range and unknown ids rejected");
+  mem_backend_t mem = {0};
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem);
+
+  if (settings_store_set(&store, BRIGHT, 101) != SETTINGS_STORE_ERR_RANGE ||
+      settings_store_set(&store, MAX_FAIL, 4) != SETTINGS_STORE_ERR_RANGE ||
+      settings_store_set(&store, MAX_FAIL, 51) != SETTINGS_STORE_ERR_RANGE ||
+      settings_store_set(&store, NUM_KEYS, 1) != SETTINGS_STORE_ERR_ARG ||
+      mem.sets != 0 || settings_store_get(&store, MAX_FAIL) != 10) {
+    FAIL("bad value accepted");
+    return;
+  }
+  PASS();
+}
+
+static void test_batch(void) {
+  TEST("Batch writes changed keys, one commit per namespace");
+  mem_backend_t mem = {0};
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem);
+
+  settings_store_begin(&store);
+  settings_store_set(&store, NET, 1);
+  settings_store_set(&store, TYPE, 2);
+  for (uint16_t b = 0; b <= 100; b += 10)
+    settings_store_set(&store, BRIGHT, b); // Slider drag
+  settings_store_set(&store, MAX_FAIL, 20);
+  settings_store_set(&store, TIMEOUT, 120);
+  if (mem.sets != 0 || mem.commits != 0) {
+    FAIL("batch wrote early");
+    return;
+  }
+  if (settings_store_get(&store, BRIGHT) != 100) {
+    FAIL("cache not updated during batch");
+    return;
+  }
+  if (settings_store_commit(&store) != SETTINGS_STORE_OK || mem.sets != 5 ||
+      mem.commits != 2) {
+    FAIL("expected 5 writes and 2 commits");
+    return;
+  }
+
+  // Reload from the backend into a fresh store
+  settings_store_t reloaded;
+  settings_store_init(&reloaded, schema, NUM_KEYS, &mem_backend, &mem);
+  if (memcmp(reloaded.values, store.values, sizeof(store.values)) != 0) {
+    FAIL("reloaded values differ");
+    return;
+  }
+  PASS();
+}
+
+static void test_immediate_in_batch(void) {
+  TEST("Immediate keys commit inside a batch and survive abort");
+  mem_backend_t mem = {0};
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem);
+
+  settings_store_begin(&store);
+  settings_store_set(&store, BRIGHT, 20);
+  settings_store_set(&store, FAIL_CNT, 3);
+  if (mem.sets != 1 || mem.commits != 1) {
+    FAIL("failure counter not committed immediately");
+    return;
+  }
+  settings_store_abort(&store);
+
+  uint16_t stored = 0;
+  if (settings_store_get(&store, BRIGHT) != 50 ||
+      settings_store_get(&store, FAIL_CNT) != 3 ||
+      !mem_get(&mem, "pin", "fail_cnt", SETTINGS_TYPE_U8, &stored) ||
+      stored != 3 || mem.sets != 1) {
+    FAIL("abort restored the wrong values");
+    return;
+  }
+  PASS();
+}
+
+static void test_backend_failure(void) {
+  TEST("Failed commit keeps keys dirty for retry");
+  mem_backend_t mem = {0};
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem);
+
+  settings_store_begin(&store);
+  settings_store_set(&store, NET, 1);
+  settings_store_set(&store, TIMEOUT, 60);
+  mem.fail_commits = true;
+  if (settings_store_commit(&store) != SETTINGS_STORE_ERR_BACKEND) {
+    FAIL("commit failure not reported");
+    return;
+  }
+  mem.fail_commits = false;
+  mem.sets = mem.commits = 0;
+  if (settings_store_commit(&store) != SETTINGS_STORE_OK || mem.sets != 2 ||
+      mem.commits != 2 || store.dirty != 0) {
+    FAIL("retry did not flush");
+    return;
+  }
+
+  mem.fail_sets = true;
+  if (settings_store_set(&store, FAIL_CNT, 1) != SETTINGS_STORE_ERR_BACKEND) {
+    FAIL("write failure not reported");
+    return;
+  }
+  PASS();
+}
+
+static void test_immediate_failure(void) {
+  TEST("Failed immediate write leaves the cached value unchanged");
+  mem_backend_t mem = {0};
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem);
+  listener_log_t log = {0};
+  settings_store_subscribe(&store, log_listener, &log);
+
+  mem.fail_sets = true;
+  if (settings_store_set(&store, FAIL_CNT, 1) != SETTINGS_STORE_ERR_BACKEND ||
+      settings_store_get(&store, FAIL_CNT) != 0) {
+    FAIL("failed set was cached");
+    return;
+  }
+  mem.fail_sets = false;
+  mem.fail_commits = true;
+  settings_store_begin(&store);
+  if (settings_store_set(&store, FAIL_CNT, 1) != SETTINGS_STORE_ERR_BACKEND ||
+      settings_store_get(&store, FAIL_CNT) != 0) {
+    FAIL("failed commit was cached");
+    return;
+  }
+  settings_store_abort(&store);
+  if (store.dirty != 0 || log.calls != 0) {
+    FAIL("rolled back key left dirty or notified");
+    return;
+  }
+
+  // A non-immediate key outside a batch keeps the value for a retry
+  if (settings_store_set(&store, NET, 1) != SETTINGS_STORE_ERR_BACKEND ||
+      settings_store_get(&store, NET) != 1 || !(store.dirty & (1u << NET))) {
+    FAIL("plain key not kept dirty");
+    return;
+  }
+  PASS();
+}
+
+static void test_listeners(void) {
+  TEST("Listeners see changes, aborts and resets");
+  mem_backend_t mem = {0};
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, &mem_backend, &mem);
+
+  listener_log_t log = {0};
+  settings_store_subscribe(&store, log_listener, &log);
+
+  settings_store_set(&store, BRIGHT, 60);
+  settings_store_set(&store, BRIGHT, 60); // No change, no call
+  if (log.calls != 1 || log.last_id != BRIGHT || log.last_value != 60) {
+    FAIL("set not announced once");
+    return;
+  }
+
+  settings_store_begin(&store);
+  settings_store_set(&store, NET, 1);
+  settings_store_abort(&store);
+  if (log.calls != 3 || log.last_id != NET || log.last_value != 0) {
+    FAIL("abort not announced");
+    return;
+  }
+
+  settings_store_set(&store, TIMEOUT, 30);
+  settings_store_reset_ns(&store, "pin");
+  if (log.calls != 5 || log.last_id != TIMEOUT || log.last_value != 300 ||
+      settings_store_get(&store, BRIGHT) != 60) {
+    FAIL("reset not announced or touched other namespace");
+    return;
+  }
+
+  settings_store_unsubscribe(&store, log_listener, &log);
+  settings_store_set(&store, BRIGHT, 61);
+  if (log.calls != 5) {
+    FAIL("unsubscribed listener called");
+    return;
+  }
+  PASS();
+}
+
+static void test_no_backend(void) {
+  TEST("No backend serves defaults and refuses writes");
+  settings_store_t store;
+  settings_store_init(&store, schema, NUM_KEYS, NULL, NULL);
+  if (settings_store_get(&store, BRIGHT) != 50 ||
+      settings_store_get(&store, TIMEOUT) != 300 ||
+      settings_store_set(&store, BRIGHT, 1) != SETTINGS_STORE_ERR_STATE) {
+    FAIL("unexpected behaviour");
+    return;
+  }
+  PASS();
+}
+
+int main(void) {
+  printf("=== Settings Store Tests ===\n\n");
+
+  test_load_defaults_and_stored();
+  test_getters_hit_cache();
+  test_write_through();
+  test_range();
+  test_batch();
+  test_immediate_in_batch();
+  test_backend_failure();
+  test_immediate_failure();
+  test_listeners();
+  test_no_backend();
+
+  printf("\nResults: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+#ifndef SHA2_H
+#define SHA2_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include <mbedtls/sha256.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief SHA-256, HMAC-SHA256/512 and PBKDF2-HMAC-SHA256
+ *
+ * The one hash backend shared by the wallet's components: mbedtls on device
+ * (hardware accelerated), a portable implementation on host builds and
+ * tests. Callers link exactly one of src/sha2_mbedtls.c and src/sha2_soft.c.
+ *
+ * Temporary state holding keys or passwords is wiped before returning.
+ */
+
+#define SHA2_256_LEN 32
+#define SHA2_512_LEN 64
+
+// PBKDF2 iterations between tick calls
+#define SHA2_PBKDF2_TICK 1000
+
+#ifdef ESP_PLATFORM
+typedef mbedtls_sha256_context sha2_256_ctx;
+#else
+typedef struct {
+  uint32_t state[8];
+  uint64_t total; // Bytes hashed so far
+  uint8_t block[64];
+} sha2_256_ctx;
+#endif
+
+void sha2_256_init(sha2_256_ctx *ctx);
+void sha2_256_update(sha2_256_ctx *ctx, const uint8_t *data, size_t len);
+/* Writes the digest and releases the context */
+void sha2_256_final(sha2_256_ctx *ctx, uint8_t out[SHA2_256_LEN]);
+
+void sha2_256(const uint8_t *data, size_t len, uint8_t out[SHA2_256_LEN]);
+
+void sha2_hmac_sha256(const uint8_t *key, size_t key_len, const uint8_t *msg,
+                      size_t msg_len, uint8_t out[SHA2_256_LEN]);
+void sha2_hmac_sha512(const uint8_t *key, size_t key_len, const uint8_t *msg,
+                      size_t msg_len, uint8_t out[SHA2_512_LEN]);
+
+typedef bool (*sha2_tick_fn)(uint32_t iterations_done, void *ctx);
+
+/**
+ * PBKDF2-HMAC-SHA256 of at most one block (out_len <= 32). The key
+ * schedule is set up once; each iteration reuses it. tick (optional) is
+ * called every SHA2_PBKDF2_TICK iterations and stops the derivation by
+ * returning false.
+ * @return false if stopped or on a backend error
+ */
+bool sha2_pbkdf2_sha256(const uint8_t *pw, size_t pw_len, const uint8_t *salt,
+                        size_t salt_len, uint32_t iterations, uint8_t *out,
+                        size_t out_len, sha2_tick_fn tick, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHA2_H
@@ -0,0 +1,85 @@
+/*
+ * SHA-2 backend: mbedtls
+ * Used for device builds.
+ */
+
+#include "sha2.h"
+
+#include <mbedtls/md.h>
+#include <string.h>
+
+static void *(*const volatile wipe_memset)(void *, int, size_t) = memset;
+
+void sha2_256_init(sha2_256_ctx *ctx) {
+  mbedtls_sha256_init(ctx);
+  mbedtls_sha256_starts(ctx, 0);
+}
+
+void sha2_256_update(sha2_256_ctx *ctx, const uint8_t *data, size_t len) {
+  mbedtls_sha256_update(ctx, data, len);
+}
+
+void sha2_256_final(sha2_256_ctx *ctx, uint8_t out[SHA2_256_LEN]) {
+  mbedtls_sha256_finish(ctx, out);
+  mbedtls_sha256_free(ctx);
+}
+
+void sha2_256(const uint8_t *data, size_t len, uint8_t out[SHA2_256_LEN]) {
+  mbedtls_sha256(data, len, out, 0);
+}
+
+void sha2_hmac_sha256(const uint8_t *key, size_t key_len, const uint8_t *msg,
+                      size_t msg_len, uint8_t out[SHA2_256_LEN]) {
+  mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key, key_len,
+                  msg, msg_len, out);
+}
+
+void sha2_hmac_sha512(const uint8_t *key, size_t key_len, const uint8_t *msg,
+                      size_t msg_len, uint8_t out[SHA2_512_LEN]) {
+  mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA512), key, key_len,
+                  msg, msg_len, out);
+}
+
+bool sha2_pbkdf2_sha256(const uint8_t *pw, size_t pw_len, const uint8_t *salt,
+                        size_t salt_len, uint32_t iterations, uint8_t *out,
+                        size_t out_len, sha2_tick_fn tick, void *ctx) {
+  static const uint8_t block_one[4] = {0, 0, 0, 1};
+  uint8_t u[32], t[32];
+  bool ok = false;
+  mbedtls_md_context_t md;
+
+  if (out_len > sizeof(t) || iterations == 0)
+    return false;
+
+  // hmac_reset keeps the keyed inner state, so each iteration is two
+  // compressions rather than four
+  mbedtls_md_init(&md);
+  if (mbedtls_md_setup(&md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                       1) != 0 ||
+      mbedtls_md_hmac_starts(&md, pw, pw_len) != 0 ||
+      mbedtls_md_hmac_update(&md, salt, salt_len) != 0 ||
+      mbedtls_md_hmac_update(&md, block_one, sizeof(block_one)) != 0 ||
+      mbedtls_md_hmac_finish(&md, u) != 0)
+    goto out;
+  memcpy(t, u, sizeof(t));
+
+  for (uint32_t i = 1; i < iterations; i++) {
+    if (mbedtls_md_hmac_reset(&md) != 0 ||
+        mbedtls_md_hmac_update(&md, u, sizeof(u)) != 0 ||
+        mbedtls_md_hmac_finish(&md, u) != 0)
+      goto out;
+    for (size_t j = 0; j < sizeof(t); j++)
+      t[j] ^= u[j];
+    if (tick && (i + 1) % SHA2_PBKDF2_TICK == 0 && !tick(i + 1, ctx))
+      goto out;
+  }
+
+  memcpy(out, t, out_len);
+  ok = true;
+
+out:
+  mbedtls_md_free(&md);
+  wipe_memset(u, 0, sizeof(u));
+  wipe_memset(t, 0, sizeof(t));
+  return ok;
+}
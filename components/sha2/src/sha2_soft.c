@@ -0,0 +1,374 @@
+/*
+ * SHA-2 backend: portable C (FIPS 180-4, RFC 2104, RFC 8018)
+ * Used for host builds and tests.
+ */
+
+#include "sha2.h"
+
+#include <string.h>
+
+typedef struct {
+  uint64_t state[8];
+  uint64_t total;
+  uint8_t block[128];
+} sha512_ctx;
+
+typedef struct {
+  sha2_256_ctx inner; // Keyed with ipad, nothing hashed after it
+  sha2_256_ctx outer; // Keyed with opad
+} hmac_ctx;
+
+static void *(*const volatile wipe_memset)(void *, int, size_t) = memset;
+
+/* ---------- SHA-256 ---------- */
+
+static const uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void compress256(uint32_t state[8], const uint8_t block[64]) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++) {
+    w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+           (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
+  }
+  for (int i = 16; i < 64; i++) {
+    uint32_t s0 = ROR32(w[i - 15], 7) ^ ROR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = ROR32(w[i - 2], 17) ^ ROR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; i++) {
+    uint32_t t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) +
+                  ((e & f) ^ (~e & g)) + K256[i] + w[i];
+    uint32_t t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) +
+                  ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+void sha2_256_init(sha2_256_ctx *ctx) {
+  static const uint32_t iv[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                 0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                 0x1f83d9ab, 0x5be0cd19};
+  memcpy(ctx->state, iv, sizeof(iv));
+  ctx->total = 0;
+}
+
+void sha2_256_update(sha2_256_ctx *ctx, const uint8_t *data, size_t len) {
+  size_t used = ctx->total % 64;
+  ctx->total += len;
+
+  if (used) {
+    size_t take = 64 - used < len ? 64 - used : len;
+    memcpy(ctx->block + used, data, take);
+    data += take;
+    len -= take;
+    if (used + take < 64)
+      return;
+    compress256(ctx->state, ctx->block);
+  }
+
+  for (; len >= 64; data += 64, len -= 64)
+    compress256(ctx->state, data);
+
+  memcpy(ctx->block, data, len);
+}
+
+void sha2_256_final(sha2_256_ctx *ctx, uint8_t out[SHA2_256_LEN]) {
+  uint64_t bits = ctx->total * 8;
+  size_t used = ctx->total % 64;
+
+  ctx->block[used++] = 0x80;
+  if (used > 56) {
+    memset(ctx->block + used, 0, 64 - used);
+    compress256(ctx->state, ctx->block);
+    used = 0;
+  }
+  memset(ctx->block + used, 0, 56 - used);
+  for (int i = 0; i < 8; i++)
+    ctx->block[56 + i] = (uint8_t)(bits >> (56 - i * 8));
+  compress256(ctx->state, ctx->block);
+
+  for (int i = 0; i < 8; i++) {
+    out[i * 4] = (uint8_t)(ctx->state[i] >> 24);
+    out[i * 4 + 1] = (uint8_t)(ctx->state[i] >> 16);
+    out[i * 4 + 2] = (uint8_t)(ctx->state[i] >> 8);
+    out[i * 4 + 3] = (uint8_t)ctx->state[i];
+  }
+  wipe_memset(ctx, 0, sizeof(*ctx));
+}
+
+void sha2_256(const uint8_t *data, size_t len, uint8_t out[SHA2_256_LEN]) {
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, data, len);
+  sha2_256_final(&ctx, out);
+}
+
+/* ---------- SHA-512, HMAC-SHA512 ---------- */
+
+static const uint64_t K512[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+    0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+    0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+    0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+    0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+    0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+    0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+    0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+    0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+    0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+    0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+    0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+    0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+    0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+    0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+    0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+    0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+    0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+    0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+    0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+    0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL};
+
+#define ROR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static void compress512(uint64_t state[8], const uint8_t block[128]) {
+  uint64_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = 0;
+    for (int j = 0; j < 8; j++)
+      w[i] = w[i] << 8 | block[i * 8 + j];
+  }
+  for (int i = 16; i < 80; i++) {
+    uint64_t s0 = ROR64(w[i - 15], 1) ^ ROR64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+    uint64_t s1 = ROR64(w[i - 2], 19) ^ ROR64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 80; i++) {
+    uint64_t t1 = h + (ROR64(e, 14) ^ ROR64(e, 18) ^ ROR64(e, 41)) +
+                  ((e & f) ^ (~e & g)) + K512[i] + w[i];
+    uint64_t t2 = (ROR64(a, 28) ^ ROR64(a, 34) ^ ROR64(a, 39)) +
+                  ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+  wipe_memset(w, 0, sizeof(w));
+}
+
+static void sha512_init(sha512_ctx *ctx) {
+  static const uint64_t iv[8] = {
+      0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+      0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+      0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL};
+  memcpy(ctx->state, iv, sizeof(iv));
+  ctx->total = 0;
+}
+
+static void sha512_update(sha512_ctx *ctx, const uint8_t *data, size_t len) {
+  size_t used = ctx->total % 128;
+  ctx->total += len;
+  while (len > 0) {
+    size_t n = 128 - used < len ? 128 - used : len;
+    memcpy(ctx->block + used, data, n);
+    used += n;
+    data += n;
+    len -= n;
+    if (used == 128) {
+      compress512(ctx->state, ctx->block);
+      used = 0;
+    }
+  }
+}
+
+static void sha512_final(sha512_ctx *ctx, uint8_t out[64]) {
+  size_t used = ctx->total % 128;
+  uint64_t bits = ctx->total * 8;
+
+  ctx->block[used++] = 0x80;
+  if (used > 112) {
+    memset(ctx->block + used, 0, 128 - used);
+    compress512(ctx->state, ctx->block);
+    used = 0;
+  }
+  // Messages here are far below 2^64 bits; the high length word is zero
+  memset(ctx->block + used, 0, 120 - used);
+  for (int i = 0; i < 8; i++)
+    ctx->block[120 + i] = (uint8_t)(bits >> (56 - 8 * i));
+  compress512(ctx->state, ctx->block);
+
+  for (int i = 0; i < 8; i++) {
+    for (int j = 0; j < 8; j++)
+      out[i * 8 + j] = (uint8_t)(ctx->state[i] >> (56 - 8 * j));
+  }
+  wipe_memset(ctx, 0, sizeof(*ctx));
+}
+
+void sha2_hmac_sha512(const uint8_t *key, size_t key_len, const uint8_t *msg,
+                      size_t msg_len, uint8_t out[SHA2_512_LEN]) {
+  uint8_t k[128] = {0};
+  uint8_t pad[128];
+  uint8_t inner[64];
+  sha512_ctx ctx;
+
+  if (key_len > sizeof(k)) {
+    sha512_init(&ctx);
+    sha512_update(&ctx, key, key_len);
+    sha512_final(&ctx, k);
+  } else {
+    memcpy(k, key, key_len);
+  }
+
+  for (size_t i = 0; i < sizeof(pad); i++)
+    pad[i] = k[i] ^ 0x36;
+  sha512_init(&ctx);
+  sha512_update(&ctx, pad, sizeof(pad));
+  sha512_update(&ctx, msg, msg_len);
+  sha512_final(&ctx, inner);
+
+  for (size_t i = 0; i < sizeof(pad); i++)
+    pad[i] = k[i] ^ 0x5c;
+  sha512_init(&ctx);
+  sha512_update(&ctx, pad, sizeof(pad));
+  sha512_update(&ctx, inner, sizeof(inner));
+  sha512_final(&ctx, out);
+
+  wipe_memset(k, 0, sizeof(k));
+  wipe_memset(pad, 0, sizeof(pad));
+  wipe_memset(inner, 0, sizeof(inner));
+}
+
+/* ---------- HMAC-SHA256, PBKDF2 ---------- */
+
+static void hmac_init(hmac_ctx *h, const uint8_t *key, size_t key_len) {
+  uint8_t pad[64] = {0};
+  if (key_len > sizeof(pad)) {
+    sha2_256_init(&h->inner);
+    sha2_256_update(&h->inner, key, key_len);
+    sha2_256_final(&h->inner, pad);
+  } else {
+    memcpy(pad, key, key_len);
+  }
+
+  for (size_t i = 0; i < sizeof(pad); i++)
+    pad[i] ^= 0x36;
+  sha2_256_init(&h->inner);
+  sha2_256_update(&h->inner, pad, sizeof(pad));
+
+  for (size_t i = 0; i < sizeof(pad); i++)
+    pad[i] ^= 0x36 ^ 0x5c;
+  sha2_256_init(&h->outer);
+  sha2_256_update(&h->outer, pad, sizeof(pad));
+  wipe_memset(pad, 0, sizeof(pad));
+}
+
+// Finish an inner hash started from h->inner
+static void hmac_finish(const hmac_ctx *h, sha2_256_ctx *inner,
+                        uint8_t out[32]) {
+  sha2_256_ctx outer = h->outer;
+  sha2_256_final(inner, out);
+  sha2_256_update(&outer, out, 32);
+  sha2_256_final(&outer, out);
+}
+
+void sha2_hmac_sha256(const uint8_t *key, size_t key_len, const uint8_t *msg,
+                      size_t msg_len, uint8_t out[SHA2_256_LEN]) {
+  hmac_ctx h;
+  hmac_init(&h, key, key_len);
+  sha2_256_ctx inner = h.inner;
+  sha2_256_update(&inner, msg, msg_len);
+  hmac_finish(&h, &inner, out);
+  wipe_memset(&h, 0, sizeof(h));
+}
+
+bool sha2_pbkdf2_sha256(const uint8_t *pw, size_t pw_len, const uint8_t *salt,
+                        size_t salt_len, uint32_t iterations, uint8_t *out,
+                        size_t out_len, sha2_tick_fn tick, void *ctx) {
+  static const uint8_t block_one[4] = {0, 0, 0, 1};
+  uint8_t u[32], t[32];
+  bool ok = false;
+  hmac_ctx h;
+  sha2_256_ctx inner;
+
+  if (out_len > sizeof(t) || iterations == 0)
+    return false;
+
+  hmac_init(&h, pw, pw_len);
+  inner = h.inner;
+  sha2_256_update(&inner, salt, salt_len);
+  sha2_256_update(&inner, block_one, sizeof(block_one));
+  hmac_finish(&h, &inner, u);
+  memcpy(t, u, sizeof(t));
+
+  for (uint32_t i = 1; i < iterations; i++) {
+    inner = h.inner;
+    sha2_256_update(&inner, u, sizeof(u));
+    hmac_finish(&h, &inner, u);
+    for (size_t j = 0; j < sizeof(t); j++)
+      t[j] ^= u[j];
+    if (tick && (i + 1) % SHA2_PBKDF2_TICK == 0 && !tick(i + 1, ctx))
+      goto out;
+  }
+
+  memcpy(out, t, out_len);
+  ok = true;
+
+out:
+  wipe_memset(&h, 0, sizeof(h));
+  wipe_memset(&inner, 0, sizeof(inner));
+  wipe_memset(u, 0, sizeof(u));
+  wipe_memset(t, 0, sizeof(t));
+  return ok;
+}
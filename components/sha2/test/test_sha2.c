@@ -0,0 +1,269 @@
+/*
+ * SHA-2 Test Suite
+ * Compile with: make
+ * Run: ./test_sha2
+ *
+ * Vectors are from FIPS 180-4 (SHA-256) and RFC 4231 (HMAC-SHA256/512);
+ * PBKDF2-HMAC-SHA256 uses the RFC 6070 inputs with SHA-256.
+ */
+
+#include "sha2.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static void hex_to_bytes(const char *hex, uint8_t *out) {
+  for (size_t i = 0; hex[i * 2]; i++) {
+    unsigned v;
+    sscanf(hex + i * 2, "%2x", &v);
+    out[i] = (uint8_t)v;
+  }
+}
+
+static bool equals_hex(const uint8_t *data, const char *hex) {
+  uint8_t expected[64];
+  size_t len = strlen(hex) / 2;
+  hex_to_bytes(hex, expected);
+  return memcmp(data, expected, len) == 0;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_sha256(void) {
+  TEST("SHA-256 (empty, abc, multi-block)");
+
+  uint8_t out[SHA2_256_LEN];
+  sha2_256_ctx ctx;
+  bool ok = true;
+
+  sha2_256_init(&ctx);
+  sha2_256_final(&ctx, out);
+  ok = ok && equals_hex(out, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934c"
+                             "a495991b7852b855");
+
+  sha2_256((const uint8_t *)"abc", 3, out);
+  ok = ok && equals_hex(out, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9c"
+                             "b410ff61f20015ad");
+
+  /* 56-byte message split across updates crosses the padding boundary */
+  const char *msg = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  sha2_256_init(&ctx);
+  sha2_256_update(&ctx, (const uint8_t *)msg, 5);
+  sha2_256_update(&ctx, (const uint8_t *)msg + 5, strlen(msg) - 5);
+  sha2_256_final(&ctx, out);
+  ok = ok && equals_hex(out, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167"
+                             "f6ecedd419db06c1");
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("digest mismatch");
+  }
+}
+
+static void test_sha256_million(void) {
+  TEST("SHA-256 of one million 'a' in uneven chunks");
+
+  static uint8_t chunk[997];
+  memset(chunk, 'a', sizeof(chunk));
+  sha2_256_ctx ctx;
+  sha2_256_init(&ctx);
+  size_t left = 1000000;
+  while (left) {
+    size_t n = left < sizeof(chunk) ? left : sizeof(chunk);
+    sha2_256_update(&ctx, chunk, n);
+    left -= n;
+  }
+  uint8_t out[SHA2_256_LEN];
+  sha2_256_final(&ctx, out);
+
+  if (equals_hex(out, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39"
+                      "ccc7112cd0")) {
+    PASS();
+  } else {
+    FAIL("digest mismatch");
+  }
+}
+
+static const struct {
+  const char *key_hex; // NULL: 131 bytes of 0xaa
+  const char *msg;
+  const char *sha256;
+  const char *sha512;
+} hmac_vectors[] = {
+    {"0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b", "Hi There",
+     "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+     "87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cde"
+     "daa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854"},
+    {"4a656665", "what do ya want for nothing?",
+     "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+     "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+     "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"},
+    {NULL, "Test Using Larger Than Block-Size Key - Hash Key First",
+     "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+     "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+     "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598"},
+};
+
+static void test_hmac(void) {
+  TEST("HMAC-SHA256 and HMAC-SHA512 (RFC 4231 cases 1, 2, 6)");
+
+  bool ok = true;
+  for (size_t i = 0; i < sizeof(hmac_vectors) / sizeof(hmac_vectors[0]);
+       i++) {
+    uint8_t key[131];
+    size_t key_len;
+    if (hmac_vectors[i].key_hex) {
+      key_len = strlen(hmac_vectors[i].key_hex) / 2;
+      hex_to_bytes(hmac_vectors[i].key_hex, key);
+    } else {
+      key_len = sizeof(key);
+      memset(key, 0xaa, key_len);
+    }
+    const uint8_t *msg = (const uint8_t *)hmac_vectors[i].msg;
+    size_t msg_len = strlen(hmac_vectors[i].msg);
+
+    uint8_t out256[SHA2_256_LEN], out512[SHA2_512_LEN];
+    sha2_hmac_sha256(key, key_len, msg, msg_len, out256);
+    sha2_hmac_sha512(key, key_len, msg, msg_len, out512);
+    ok = ok && equals_hex(out256, hmac_vectors[i].sha256) &&
+         equals_hex(out512, hmac_vectors[i].sha512);
+  }
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("MAC mismatch");
+  }
+}
+
+static void test_pbkdf2(void) {
+  TEST("PBKDF2-HMAC-SHA256 (1, 2, 4096 iterations, short output)");
+
+  const uint8_t *pw = (const uint8_t *)"password";
+  const uint8_t *salt = (const uint8_t *)"salt";
+  uint8_t out[SHA2_256_LEN];
+  bool ok = true;
+
+  ok = ok && sha2_pbkdf2_sha256(pw, 8, salt, 4, 1, out, 32, NULL, NULL) &&
+       equals_hex(out, "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805"
+                       "987cb70be17b");
+  ok = ok && sha2_pbkdf2_sha256(pw, 8, salt, 4, 2, out, 32, NULL, NULL) &&
+       equals_hex(out, "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2"
+                       "d85a95474c43");
+  ok = ok && sha2_pbkdf2_sha256(pw, 8, salt, 4, 4096, out, 32, NULL, NULL) &&
+       equals_hex(out, "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a496"
+                       "3873aa98134a");
+
+  const char *long_pw = "passwordPASSWORDpassword";
+  const char *long_salt = "saltSALTsaltSALTsaltSALTsaltSALTsalt";
+  ok = ok &&
+       sha2_pbkdf2_sha256((const uint8_t *)long_pw, strlen(long_pw),
+                          (const uint8_t *)long_salt, strlen(long_salt), 4096,
+                          out, 25, NULL, NULL) &&
+       equals_hex(out, "348c89dbcbd32b2f32d814b8116e84cf2b17347ebc1800181c");
+
+  // More than one output block is not supported
+  uint8_t big[SHA2_256_LEN + 1];
+  ok = ok && !sha2_pbkdf2_sha256(pw, 8, salt, 4, 1, big, sizeof(big), NULL,
+                                 NULL);
+  ok = ok && !sha2_pbkdf2_sha256(pw, 8, salt, 4, 0, out, 32, NULL, NULL);
+
+  if (ok) {
+    PASS();
+  } else {
+    FAIL("derived key mismatch");
+  }
+}
+
+static bool count_ticks(uint32_t done, void *ctx) {
+  uint32_t *calls = ctx;
+  (*calls)++;
+  return done < 3 * SHA2_PBKDF2_TICK;
+}
+
+static void test_pbkdf2_tick(void) {
+  TEST("PBKDF2 tick reports progress and stops the derivation");
+
+  const uint8_t *pw = (const uint8_t *)"password";
+  const uint8_t *salt = (const uint8_t *)"salt";
+  uint8_t out[SHA2_256_LEN];
+  uint32_t calls = 0;
+
+  bool stopped = !sha2_pbkdf2_sha256(pw, 8, salt, 4, 10 * SHA2_PBKDF2_TICK,
+                                     out, 32, count_ticks, &calls);
+
+  if (stopped && calls == 3) {
+    PASS();
+  } else {
+    FAIL("tick not honoured");
+  }
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench(void) {
+  static uint8_t buf[4096];
+  memset(buf, 0x5a, sizeof(buf));
+  uint8_t out[SHA2_512_LEN];
+  volatile uint8_t sink = 0;
+
+  const int iters = 5000;
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++) {
+    sha2_256(buf, sizeof(buf), out);
+    sink ^= out[0];
+  }
+  double t1 = now_ms();
+  for (int i = 0; i < iters * 10; i++) {
+    sha2_hmac_sha512(buf, 32, buf + 32, 32, out);
+    sink ^= out[0];
+  }
+  double t2 = now_ms();
+  sha2_pbkdf2_sha256(buf, 16, buf, 16, 10000, out, 32, NULL, NULL);
+  double t3 = now_ms();
+  (void)sink;
+
+  printf("\nBenchmark:\n");
+  printf("  SHA-256, 4096 bytes:       %.2f us\n", (t1 - t0) * 1000.0 / iters);
+  printf("  HMAC-SHA512, 32 bytes:     %.2f us\n",
+         (t2 - t1) * 1000.0 / (iters * 10));
+  printf("  PBKDF2-SHA256, 10000 iter: %.2f ms\n\n", t3 - t2);
+}
+
+int main(void) {
+  printf("=== SHA-2 Tests ===\n\n");
+
+  test_sha256();
+  test_sha256_million();
+  test_hmac();
+  test_pbkdf2();
+  test_pbkdf2_tick();
+
+  bench();
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
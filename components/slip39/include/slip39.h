@@ -0,0 +1,238 @@
+#ifndef SLIP39_H
+#define SLIP39_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief SLIP-39 Shamir backup shares
+ *
+ * A master secret (16 to 32 bytes, even) is encrypted with a four-round
+ * Feistel network keyed by PBKDF2-HMAC-SHA256 of the passphrase, then
+ * split twice with Shamir's scheme over GF(256): into groups, and each
+ * group secret into member shares. Any group threshold of groups, each
+ * with its member threshold of shares, recovers it.
+ *
+ * A share is 4 header words (identifier, extendable flag, iteration
+ * exponent, group and member fields), the padded share value and a
+ * 3-word RS1024 checksum; words are 10-bit indices into a 1024-word list.
+ * 20 words carry a 128-bit secret, 33 words a 256-bit one.
+ *
+ * Shares are handled as indices and plain structs; only the wordlist
+ * helpers see strings. The Feistel rounds are the only slow part (10000
+ * PBKDF2 iterations per exponent step in total) and report progress so
+ * they can run on a worker and be cancelled.
+ */
+
+#define SLIP39_WORDS 1024
+#define SLIP39_MIN_SECRET 16
+#define SLIP39_MAX_SECRET 32
+#define SLIP39_MIN_SHARE_WORDS 20
+#define SLIP39_MAX_SHARE_WORDS 33
+#define SLIP39_MAX_WORD_LEN 8
+#define SLIP39_MAX_GROUPS 16
+#define SLIP39_MAX_MEMBERS 16
+#define SLIP39_MAX_EXPONENT 15
+#define SLIP39_MAX_SET_SHARES 32 // Shares a recovery set holds at once
+#define SLIP39_MAX_PASSPHRASE 256
+
+typedef enum {
+  SLIP39_OK = 0,
+  SLIP39_ERR_INVALID_ARG = -1,
+  SLIP39_ERR_WORD = -2,        // Not in the wordlist
+  SLIP39_ERR_LENGTH = -3,      // Share or secret length not allowed
+  SLIP39_ERR_CHECKSUM = -4,    // RS1024 checksum mismatch
+  SLIP39_ERR_PADDING = -5,     // Non-zero padding bits
+  SLIP39_ERR_HEADER = -6,      // Group index or threshold above group count
+  SLIP39_ERR_MISMATCH = -7,    // Share from a different backup
+  SLIP39_ERR_DUPLICATE = -8,   // Share already in the set
+  SLIP39_ERR_FULL = -9,        // Set holds SLIP39_MAX_SET_SHARES
+  SLIP39_ERR_INCOMPLETE = -10, // Not enough groups or members
+  SLIP39_ERR_DIGEST = -11,     // Shares combine to an inconsistent secret
+  SLIP39_ERR_PASSPHRASE = -12, // Not printable ASCII, or too long
+  SLIP39_ERR_CANCELLED = -13,
+  SLIP39_ERR_CRYPTO = -14,
+} slip39_error_t;
+
+typedef struct {
+  uint16_t identifier; // 15 bits, random per backup
+  bool extendable;     // Identifier not mixed into the encryption salt
+  uint8_t iteration_exponent;
+  uint8_t group_index;
+  uint8_t group_threshold;
+  uint8_t group_count;
+  uint8_t member_index;
+  uint8_t member_threshold;
+  uint8_t value_len;
+  uint8_t value[SLIP39_MAX_SECRET];
+} slip39_share_t;
+
+typedef struct {
+  slip39_share_t shares[SLIP39_MAX_SET_SHARES];
+  uint8_t count;
+} slip39_set_t;
+
+typedef struct {
+  uint8_t group_threshold; // 0 while the set is empty
+  uint8_t group_count;
+  uint8_t groups_complete;
+  // Per group index; member_threshold is 0 until a share of it is added
+  uint8_t member_threshold[SLIP39_MAX_GROUPS];
+  uint8_t member_count[SLIP39_MAX_GROUPS];
+} slip39_status_t;
+
+typedef struct {
+  uint8_t threshold;
+  uint8_t count;
+} slip39_group_spec_t;
+
+/** @brief Progress (0-100); returning false cancels */
+typedef bool (*slip39_progress_fn)(uint8_t percent, void *ctx);
+
+/** @brief Fills buf with cryptographically secure random bytes */
+typedef void (*slip39_random_fn)(uint8_t *buf, size_t len);
+
+const char *slip39_error_str(slip39_error_t err);
+
+/* ---------- Wordlist ---------- */
+
+/** @return The word, or NULL if index >= SLIP39_WORDS */
+const char *slip39_word(uint16_t index);
+
+/**
+ * @brief Exact lookup, or by the first four letters, which are unique
+ * @return Index, or -1
+ */
+int slip39_word_index(const char *word);
+
+/**
+ * @brief Words starting with prefix
+ * @param first Receives the first match (optional)
+ * @return Number of matches, contiguous from *first
+ */
+int slip39_prefix_range(const char *prefix, size_t len, uint16_t *first);
+
+/** @brief Bit N set if prefix + ('a' + N) starts some word */
+uint32_t slip39_next_letters(const char *prefix, size_t len);
+
+/* ---------- Shares ---------- */
+
+/** @return Words in a share carrying a secret_len-byte value */
+size_t slip39_share_words(size_t secret_len);
+
+/**
+ * @brief Decode and checksum-verify word indices
+ */
+slip39_error_t slip39_share_decode(const uint16_t *words, size_t count,
+                                   slip39_share_t *out);
+
+/**
+ * @brief Encode a share, adding its padding and checksum
+ * @return Word count, or 0 if a field is out of range or max is too small
+ */
+size_t slip39_share_encode(const slip39_share_t *share, uint16_t *words,
+                           size_t max);
+
+/**
+ * @brief Decode a space-separated share mnemonic
+ */
+slip39_error_t slip39_share_parse(const char *mnemonic, slip39_share_t *out);
+
+/**
+ * @brief Space-separated words of a share
+ * @return Length written (excluding NUL), 0 if it does not fit
+ */
+size_t slip39_share_format(const slip39_share_t *share, char *out,
+                           size_t out_len);
+
+/* ---------- Recovery ---------- */
+
+void slip39_set_init(slip39_set_t *set);
+
+/**
+ * @brief Add a share, checking it belongs with those already added
+ *
+ * Shares must agree on identifier, extendable flag, iteration exponent,
+ * group threshold and count and value length, and within a group on the
+ * member threshold. Re-adding a share is SLIP39_ERR_DUPLICATE; a
+ * different share with a taken member index is SLIP39_ERR_MISMATCH.
+ */
+slip39_error_t slip39_set_add(slip39_set_t *set, const slip39_share_t *share);
+
+void slip39_set_status(const slip39_set_t *set, slip39_status_t *out);
+
+/** @brief Enough groups have their member threshold of shares */
+bool slip39_set_ready(const slip39_set_t *set);
+
+/**
+ * @brief Combine the shares into the encrypted master secret
+ *
+ * Cheap (interpolation and two HMACs); the slow part is slip39_decrypt.
+ *
+ * @param ems At least SLIP39_MAX_SECRET bytes
+ */
+slip39_error_t slip39_set_combine(const slip39_set_t *set, uint8_t *ems,
+                                  size_t *ems_len);
+
+/**
+ * @brief Combine and decrypt in one go
+ *
+ * @param secret At least SLIP39_MAX_SECRET bytes
+ */
+slip39_error_t slip39_recover(const slip39_set_t *set, const char *passphrase,
+                              uint8_t *secret, size_t *secret_len,
+                              slip39_progress_fn progress, void *ctx);
+
+void slip39_set_wipe(slip39_set_t *set);
+
+/* ---------- Encryption ---------- */
+
+/**
+ * @brief Feistel encryption of the master secret
+ *
+ * passphrase may be NULL (empty); otherwise printable ASCII, at most
+ * SLIP39_MAX_PASSPHRASE characters. in and out may alias.
+ */
+slip39_error_t slip39_encrypt(const uint8_t *in, size_t len,
+                              const char *passphrase, uint16_t identifier,
+                              bool extendable, uint8_t iteration_exponent,
+                              uint8_t *out, slip39_progress_fn progress,
+                              void *ctx);
+
+slip39_error_t slip39_decrypt(const uint8_t *in, size_t len,
+                              const char *passphrase, uint16_t identifier,
+                              bool extendable, uint8_t iteration_exponent,
+                              uint8_t *out, slip39_progress_fn progress,
+                              void *ctx);
+
+/* ---------- Generation ---------- */
+
+/**
+ * @brief Split a master secret into a new set of shares
+ *
+ * Shares come out group by group, members in order. A group with
+ * threshold 1 must have count 1.
+ *
+ * @param shares Receives the sum of the group counts
+ * @param share_count Receives how many were written
+ */
+slip39_error_t slip39_split(const uint8_t *secret, size_t len,
+                            const char *passphrase, bool extendable,
+                            uint8_t iteration_exponent,
+                            uint8_t group_threshold,
+                            const slip39_group_spec_t *groups,
+                            uint8_t group_count, slip39_random_fn random,
+                            slip39_share_t *shares, size_t max_shares,
+                            size_t *share_count, slip39_progress_fn progress,
+                            void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLIP39_H
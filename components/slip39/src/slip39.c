@@ -0,0 +1,839 @@
+/*
+ * SLIP-39 Shamir backup shares
+ *
+ * See slip39.h for the scheme. GF(256) arithmetic uses the Rijndael
+ * polynomial through log/exp tables; RS1024 works on 10-bit symbols over
+ * x^10 + x^3 + 1.
+ */
+
+#include "slip39.h"
+#include "slip39_wordlist.h"
+
+#include <sha2.h>
+#include <string.h>
+
+#define RADIX_BITS 10
+#define ID_BITS 15
+#define HEADER_WORDS 4 // Identifier through member threshold: 40 bits
+#define CHECKSUM_WORDS 3
+#define DIGEST_LEN 4
+#define SECRET_INDEX 255
+#define DIGEST_INDEX 254
+#define BASE_ITERATIONS 10000
+#define ROUNDS 4
+
+static void *(*const volatile wipe_memset)(void *, int, size_t) = memset;
+
+static const uint8_t gf_exp[255] = {
+    0x01, 0x03, 0x05, 0x0f, 0x11, 0x33, 0x55, 0xff, 0x1a, 0x2e, 0x72, 0x96,
+    0xa1, 0xf8, 0x13, 0x35, 0x5f, 0xe1, 0x38, 0x48, 0xd8, 0x73, 0x95, 0xa4,
+    0xf7, 0x02, 0x06, 0x0a, 0x1e, 0x22, 0x66, 0xaa, 0xe5, 0x34, 0x5c, 0xe4,
+    0x37, 0x59, 0xeb, 0x26, 0x6a, 0xbe, 0xd9, 0x70, 0x90, 0xab, 0xe6, 0x31,
+    0x53, 0xf5, 0x04, 0x0c, 0x14, 0x3c, 0x44, 0xcc, 0x4f, 0xd1, 0x68, 0xb8,
+    0xd3, 0x6e, 0xb2, 0xcd, 0x4c, 0xd4, 0x67, 0xa9, 0xe0, 0x3b, 0x4d, 0xd7,
+    0x62, 0xa6, 0xf1, 0x08, 0x18, 0x28, 0x78, 0x88, 0x83, 0x9e, 0xb9, 0xd0,
+    0x6b, 0xbd, 0xdc, 0x7f, 0x81, 0x98, 0xb3, 0xce, 0x49, 0xdb, 0x76, 0x9a,
+    0xb5, 0xc4, 0x57, 0xf9, 0x10, 0x30, 0x50, 0xf0, 0x0b, 0x1d, 0x27, 0x69,
+    0xbb, 0xd6, 0x61, 0xa3, 0xfe, 0x19, 0x2b, 0x7d, 0x87, 0x92, 0xad, 0xec,
+    0x2f, 0x71, 0x93, 0xae, 0xe9, 0x20, 0x60, 0xa0, 0xfb, 0x16, 0x3a, 0x4e,
+    0xd2, 0x6d, 0xb7, 0xc2, 0x5d, 0xe7, 0x32, 0x56, 0xfa, 0x15, 0x3f, 0x41,
+    0xc3, 0x5e, 0xe2, 0x3d, 0x47, 0xc9, 0x40, 0xc0, 0x5b, 0xed, 0x2c, 0x74,
+    0x9c, 0xbf, 0xda, 0x75, 0x9f, 0xba, 0xd5, 0x64, 0xac, 0xef, 0x2a, 0x7e,
+    0x82, 0x9d, 0xbc, 0xdf, 0x7a, 0x8e, 0x89, 0x80, 0x9b, 0xb6, 0xc1, 0x58,
+    0xe8, 0x23, 0x65, 0xaf, 0xea, 0x25, 0x6f, 0xb1, 0xc8, 0x43, 0xc5, 0x54,
+    0xfc, 0x1f, 0x21, 0x63, 0xa5, 0xf4, 0x07, 0x09, 0x1b, 0x2d, 0x77, 0x99,
+    0xb0, 0xcb, 0x46, 0xca, 0x45, 0xcf, 0x4a, 0xde, 0x79, 0x8b, 0x86, 0x91,
+    0xa8, 0xe3, 0x3e, 0x42, 0xc6, 0x51, 0xf3, 0x0e, 0x12, 0x36, 0x5a, 0xee,
+    0x29, 0x7b, 0x8d, 0x8c, 0x8f, 0x8a, 0x85, 0x94, 0xa7, 0xf2, 0x0d, 0x17,
+    0x39, 0x4b, 0xdd, 0x7c, 0x84, 0x97, 0xa2, 0xfd, 0x1c, 0x24, 0x6c, 0xb4,
+    0xc7, 0x52, 0xf6,
+};
+static const uint8_t gf_log[256] = {
+    0x00, 0x00, 0x19, 0x01, 0x32, 0x02, 0x1a, 0xc6, 0x4b, 0xc7, 0x1b, 0x68,
+    0x33, 0xee, 0xdf, 0x03, 0x64, 0x04, 0xe0, 0x0e, 0x34, 0x8d, 0x81, 0xef,
+    0x4c, 0x71, 0x08, 0xc8, 0xf8, 0x69, 0x1c, 0xc1, 0x7d, 0xc2, 0x1d, 0xb5,
+    0xf9, 0xb9, 0x27, 0x6a, 0x4d, 0xe4, 0xa6, 0x72, 0x9a, 0xc9, 0x09, 0x78,
+    0x65, 0x2f, 0x8a, 0x05, 0x21, 0x0f, 0xe1, 0x24, 0x12, 0xf0, 0x82, 0x45,
+    0x35, 0x93, 0xda, 0x8e, 0x96, 0x8f, 0xdb, 0xbd, 0x36, 0xd0, 0xce, 0x94,
+    0x13, 0x5c, 0xd2, 0xf1, 0x40, 0x46, 0x83, 0x38, 0x66, 0xdd, 0xfd, 0x30,
+    0xbf, 0x06, 0x8b, 0x62, 0xb3, 0x25, 0xe2, 0x98, 0x22, 0x88, 0x91, 0x10,
+    0x7e, 0x6e, 0x48, 0xc3, 0xa3, 0xb6, 0x1e, 0x42, 0x3a, 0x6b, 0x28, 0x54,
+    0xfa, 0x85, 0x3d, 0xba, 0x2b, 0x79, 0x0a, 0x15, 0x9b, 0x9f, 0x5e, 0xca,
+    0x4e, 0xd4, 0xac, 0xe5, 0xf3, 0x73, 0xa7, 0x57, 0xaf, 0x58, 0xa8, 0x50,
+    0xf4, 0xea, 0xd6, 0x74, 0x4f, 0xae, 0xe9, 0xd5, 0xe7, 0xe6, 0xad, 0xe8,
+    0x2c, 0xd7, 0x75, 0x7a, 0xeb, 0x16, 0x0b, 0xf5, 0x59, 0xcb, 0x5f, 0xb0,
+    0x9c, 0xa9, 0x51, 0xa0, 0x7f, 0x0c, 0xf6, 0x6f, 0x17, 0xc4, 0x49, 0xec,
+    0xd8, 0x43, 0x1f, 0x2d, 0xa4, 0x76, 0x7b, 0xb7, 0xcc, 0xbb, 0x3e, 0x5a,
+    0xfb, 0x60, 0xb1, 0x86, 0x3b, 0x52, 0xa1, 0x6c, 0xaa, 0x55, 0x29, 0x9d,
+    0x97, 0xb2, 0x87, 0x90, 0x61, 0xbe, 0xdc, 0xfc, 0xbc, 0x95, 0xcf, 0xcd,
+    0x37, 0x3f, 0x5b, 0xd1, 0x53, 0x39, 0x84, 0x3c, 0x41, 0xa2, 0x6d, 0x47,
+    0x14, 0x2a, 0x9e, 0x5d, 0x56, 0xf2, 0xd3, 0xab, 0x44, 0x11, 0x92, 0xd9,
+    0x23, 0x20, 0x2e, 0x89, 0xb4, 0x7c, 0xb8, 0x26, 0x77, 0x99, 0xe3, 0xa5,
+    0x67, 0x4a, 0xed, 0xde, 0xc5, 0x31, 0xfe, 0x18, 0x0d, 0x63, 0x8c, 0x80,
+    0xc0, 0xf7, 0x70, 0x07,
+};
+
+static const uint32_t rs1024_gen[RADIX_BITS] = {
+    0x00e0e040, 0x01c1c080, 0x03838100, 0x07070200, 0x0e0e0009,
+    0x1c0c2412, 0x38086c24, 0x3090fc48, 0x21b1f890, 0x03f3f120};
+
+const char *slip39_error_str(slip39_error_t err) {
+  switch (err) {
+  case SLIP39_OK:
+    return "OK";
+  case SLIP39_ERR_INVALID_ARG:
+    return "Invalid argument";
+  case SLIP39_ERR_WORD:
+    return "Unknown word";
+  case SLIP39_ERR_LENGTH:
+    return "Invalid share length";
+  case SLIP39_ERR_CHECKSUM:
+    return "Invalid checksum";
+  case SLIP39_ERR_PADDING:
+    return "Invalid padding";
+  case SLIP39_ERR_HEADER:
+    return "Invalid group settings";
+  case SLIP39_ERR_MISMATCH:
+    return "Share is from another backup";
+  case SLIP39_ERR_DUPLICATE:
+    return "Share already entered";
+  case SLIP39_ERR_FULL:
+    return "Too many shares";
+  case SLIP39_ERR_INCOMPLETE:
+    return "Not enough shares";
+  case SLIP39_ERR_DIGEST:
+    return "Shares do not match";
+  case SLIP39_ERR_PASSPHRASE:
+    return "Passphrase must be printable ASCII";
+  case SLIP39_ERR_CANCELLED:
+    return "Cancelled";
+  case SLIP39_ERR_CRYPTO:
+    return "Crypto error";
+  }
+  return "Unknown error";
+}
+
+/* ---------- Wordlist ---------- */
+
+const char *slip39_word(uint16_t index) {
+  return index < SLIP39_WORDS ? slip39_wordlist[index] : NULL;
+}
+
+// First word whose first len letters are >= prefix (upper: > prefix)
+static int bound(const char *prefix, size_t len, bool upper) {
+  int lo = 0, hi = SLIP39_WORDS;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    int cmp = strncmp(slip39_wordlist[mid], prefix, len);
+    if (cmp < 0 || (upper && cmp == 0))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+int slip39_prefix_range(const char *prefix, size_t len, uint16_t *first) {
+  if (!prefix)
+    prefix = "";
+  int lo = bound(prefix, len, false);
+  int hi = bound(prefix, len, true);
+  if (first)
+    *first = (uint16_t)lo;
+  return hi - lo;
+}
+
+int slip39_word_index(const char *word) {
+  if (!word)
+    return -1;
+  size_t len = strlen(word);
+  if (len < 4 || len > SLIP39_MAX_WORD_LEN)
+    return -1;
+  // Four letters already single out one word, so any longer prefix of it
+  // (the whole word included) is that word
+  uint16_t first;
+  return slip39_prefix_range(word, len, &first) == 1 ? first : -1;
+}
+
+uint32_t slip39_next_letters(const char *prefix, size_t len) {
+  uint16_t first;
+  int n = slip39_prefix_range(prefix, len, &first);
+  uint32_t mask = 0;
+  for (int i = first; i < first + n; i++) {
+    char c = slip39_wordlist[i][len];
+    if (c >= 'a' && c <= 'z')
+      mask |= 1u << (c - 'a');
+  }
+  return mask;
+}
+
+/* ---------- RS1024 ---------- */
+
+static uint32_t rs1024_step(uint32_t chk, uint32_t value) {
+  uint32_t top = chk >> 20;
+  chk = (chk & 0xfffff) << RADIX_BITS ^ value;
+  for (int i = 0; i < RADIX_BITS; i++) {
+    if ((top >> i) & 1)
+      chk ^= rs1024_gen[i];
+  }
+  return chk;
+}
+
+// Checksum state after the customization string, the words and `zeros`
+// zero words (the checksum slots when encoding)
+static uint32_t rs1024_polymod(bool extendable, const uint16_t *words,
+                               size_t count, size_t zeros) {
+  const char *cs = extendable ? "shamir_extendable" : "shamir";
+  uint32_t chk = 1;
+  for (; *cs; cs++)
+    chk = rs1024_step(chk, (uint8_t)*cs);
+  for (size_t i = 0; i < count; i++)
+    chk = rs1024_step(chk, words[i]);
+  for (size_t i = 0; i < zeros; i++)
+    chk = rs1024_step(chk, 0);
+  return chk;
+}
+
+/* ---------- Shares ---------- */
+
+static bool secret_len_valid(size_t len) {
+  return len >= SLIP39_MIN_SECRET && len <= SLIP39_MAX_SECRET && len % 2 == 0;
+}
+
+static bool share_fields_valid(const slip39_share_t *s) {
+  return s->identifier >> ID_BITS == 0 &&
+         s->iteration_exponent <= SLIP39_MAX_EXPONENT &&
+         s->group_count >= 1 && s->group_count <= SLIP39_MAX_GROUPS &&
+         s->group_threshold >= 1 && s->group_threshold <= s->group_count &&
+         s->group_index < s->group_count &&
+         s->member_threshold >= 1 &&
+         s->member_threshold <= SLIP39_MAX_MEMBERS &&
+         s->member_index < SLIP39_MAX_MEMBERS && secret_len_valid(s->value_len);
+}
+
+size_t slip39_share_words(size_t secret_len) {
+  return HEADER_WORDS + (secret_len * 8 + RADIX_BITS - 1) / RADIX_BITS +
+         CHECKSUM_WORDS;
+}
+
+slip39_error_t slip39_share_decode(const uint16_t *words, size_t count,
+                                   slip39_share_t *out) {
+  if (!words || !out)
+    return SLIP39_ERR_INVALID_ARG;
+  if (count < SLIP39_MIN_SHARE_WORDS || count > SLIP39_MAX_SHARE_WORDS)
+    return SLIP39_ERR_LENGTH;
+  for (size_t i = 0; i < count; i++) {
+    if (words[i] >= SLIP39_WORDS)
+      return SLIP39_ERR_WORD;
+  }
+
+  // The value is padded at the front to whole words, with under a byte
+  size_t value_words = count - HEADER_WORDS - CHECKSUM_WORDS;
+  size_t value_len = value_words * RADIX_BITS / 16 * 2;
+  size_t padding = value_words * RADIX_BITS - value_len * 8;
+  if (padding > 8 || !secret_len_valid(value_len))
+    return SLIP39_ERR_LENGTH;
+
+  bool extendable = (words[1] >> 4) & 1;
+  if (rs1024_polymod(extendable, words, count, 0) != 1)
+    return SLIP39_ERR_CHECKSUM;
+
+  uint64_t header = 0;
+  for (int i = 0; i < HEADER_WORDS; i++)
+    header = header << RADIX_BITS | words[i];
+
+  slip39_share_t s = {
+      .identifier = (uint16_t)(header >> 25),
+      .extendable = extendable,
+      .iteration_exponent = (header >> 20) & 0xf,
+      .group_index = (header >> 16) & 0xf,
+      .group_threshold = ((header >> 12) & 0xf) + 1,
+      .group_count = ((header >> 8) & 0xf) + 1,
+      .member_index = (header >> 4) & 0xf,
+      .member_threshold = (header & 0xf) + 1,
+      .value_len = (uint8_t)value_len,
+  };
+  if (s.group_threshold > s.group_count || s.group_index >= s.group_count)
+    return SLIP39_ERR_HEADER;
+
+  slip39_error_t err = SLIP39_OK;
+  uint32_t acc = 0;
+  unsigned bits = 0;
+  size_t n = 0;
+  for (size_t i = HEADER_WORDS; i < count - CHECKSUM_WORDS; i++) {
+    acc = acc << RADIX_BITS | words[i];
+    bits += RADIX_BITS;
+    if (padding) {
+      if (acc >> (bits - padding)) {
+        err = SLIP39_ERR_PADDING;
+        break;
+      }
+      bits -= padding;
+      padding = 0;
+    }
+    while (bits >= 8) {
+      bits -= 8;
+      s.value[n++] = (uint8_t)(acc >> bits);
+      acc &= (1u << bits) - 1;
+    }
+  }
+
+  if (err == SLIP39_OK)
+    *out = s;
+  wipe_memset(&s, 0, sizeof(s));
+  return err;
+}
+
+size_t slip39_share_encode(const slip39_share_t *share, uint16_t *words,
+                           size_t max) {
+  if (!share || !words || !share_fields_valid(share))
+    return 0;
+  size_t count = slip39_share_words(share->value_len);
+  if (count > max)
+    return 0;
+
+  uint64_t header = (uint64_t)share->identifier << 25 |
+                    (uint64_t)share->extendable << 24 |
+                    (uint64_t)share->iteration_exponent << 20 |
+                    (uint64_t)share->group_index << 16 |
+                    (uint64_t)(share->group_threshold - 1) << 12 |
+                    (uint64_t)(share->group_count - 1) << 8 |
+                    (uint64_t)share->member_index << 4 |
+                    (uint64_t)(share->member_threshold - 1);
+  for (int i = 0; i < HEADER_WORDS; i++)
+    words[i] = (header >> (RADIX_BITS * (HEADER_WORDS - 1 - i))) & 0x3ff;
+
+  // Leading zero padding counts as bits already taken
+  size_t value_words = count - HEADER_WORDS - CHECKSUM_WORDS;
+  uint32_t acc = 0;
+  unsigned bits = value_words * RADIX_BITS - share->value_len * 8;
+  size_t w = HEADER_WORDS;
+  for (size_t i = 0; i < share->value_len; i++) {
+    acc = acc << 8 | share->value[i];
+    bits += 8;
+    if (bits >= RADIX_BITS) {
+      bits -= RADIX_BITS;
+      words[w++] = (acc >> bits) & 0x3ff;
+      acc &= (1u << bits) - 1;
+    }
+  }
+
+  uint32_t chk =
+      rs1024_polymod(share->extendable, words, w, CHECKSUM_WORDS) ^ 1;
+  for (int i = 0; i < CHECKSUM_WORDS; i++)
+    words[w + i] = (chk >> (RADIX_BITS * (CHECKSUM_WORDS - 1 - i))) & 0x3ff;
+  return count;
+}
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+slip39_error_t slip39_share_parse(const char *mnemonic, slip39_share_t *out) {
+  if (!mnemonic || !out)
+    return SLIP39_ERR_INVALID_ARG;
+
+  uint16_t words[SLIP39_MAX_SHARE_WORDS];
+  char word[SLIP39_MAX_WORD_LEN + 1];
+  size_t count = 0;
+  slip39_error_t err = SLIP39_OK;
+  const char *p = mnemonic;
+
+  while (err == SLIP39_OK) {
+    while (is_space(*p))
+      p++;
+    if (!*p)
+      break;
+
+    size_t len = 0;
+    for (; *p && !is_space(*p); p++) {
+      if (len == SLIP39_MAX_WORD_LEN) {
+        err = SLIP39_ERR_WORD;
+        break;
+      }
+      char c = *p;
+      word[len++] = c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+    }
+    word[len] = '\0';
+
+    int index = slip39_word_index(word);
+    if (err != SLIP39_OK)
+      break;
+    if (index < 0)
+      err = SLIP39_ERR_WORD;
+    else if (count == SLIP39_MAX_SHARE_WORDS)
+      err = SLIP39_ERR_LENGTH;
+    else
+      words[count++] = (uint16_t)index;
+  }
+
+  if (err == SLIP39_OK)
+    err = slip39_share_decode(words, count, out);
+  wipe_memset(words, 0, sizeof(words));
+  wipe_memset(word, 0, sizeof(word));
+  return err;
+}
+
+size_t slip39_share_format(const slip39_share_t *share, char *out,
+                           size_t out_len) {
+  uint16_t words[SLIP39_MAX_SHARE_WORDS];
+  size_t count = slip39_share_encode(share, words, SLIP39_MAX_SHARE_WORDS);
+  if (!count || !out || out_len == 0)
+    return 0;
+
+  size_t pos = 0;
+  for (size_t i = 0; i < count; i++) {
+    const char *w = slip39_wordlist[words[i]];
+    size_t len = strlen(w);
+    if (pos + (i > 0) + len >= out_len) {
+      wipe_memset(out, 0, out_len);
+      pos = 0;
+      break;
+    }
+    if (i > 0)
+      out[pos++] = ' ';
+    memcpy(out + pos, w, len);
+    pos += len;
+    out[pos] = '\0';
+  }
+  wipe_memset(words, 0, sizeof(words));
+  return pos;
+}
+
+/* ---------- Shamir over GF(256) ---------- */
+
+// Value at x of the polynomial through (xs[i], ys[i]), len bytes wide
+static void interpolate(const uint8_t *xs, const uint8_t *const *ys,
+                        size_t n, size_t len, uint8_t x, uint8_t *out) {
+  for (size_t i = 0; i < n; i++) {
+    if (xs[i] == x) {
+      memcpy(out, ys[i], len);
+      return;
+    }
+  }
+
+  int log_prod = 0;
+  for (size_t i = 0; i < n; i++)
+    log_prod += gf_log[xs[i] ^ x];
+
+  memset(out, 0, len);
+  for (size_t i = 0; i < n; i++) {
+    // log of the Lagrange basis polynomial for xs[i], evaluated at x;
+    // log[0] is 0, so j == i drops out
+    int log_basis = log_prod - gf_log[xs[i] ^ x];
+    for (size_t j = 0; j < n; j++)
+      log_basis -= gf_log[xs[i] ^ xs[j]];
+    log_basis %= 255;
+    if (log_basis < 0)
+      log_basis += 255;
+
+    for (size_t k = 0; k < len; k++) {
+      if (ys[i][k])
+        out[k] ^= gf_exp[(gf_log[ys[i][k]] + log_basis) % 255];
+    }
+  }
+}
+
+// Shares at x = 0..count-1. threshold - 2 of them are random; the rest
+// interpolate through those, the digest share and the secret
+static void split_secret(uint8_t threshold, uint8_t count,
+                         const uint8_t *secret, size_t len,
+                         slip39_random_fn random,
+                         uint8_t out[][SLIP39_MAX_SECRET]) {
+  if (threshold == 1) {
+    for (uint8_t i = 0; i < count; i++)
+      memcpy(out[i], secret, len);
+    return;
+  }
+
+  uint8_t digest_share[SLIP39_MAX_SECRET];
+  uint8_t mac[SHA2_256_LEN];
+  random(digest_share + DIGEST_LEN, len - DIGEST_LEN);
+  sha2_hmac_sha256(digest_share + DIGEST_LEN, len - DIGEST_LEN, secret, len,
+                   mac);
+  memcpy(digest_share, mac, DIGEST_LEN);
+
+  uint8_t xs[SLIP39_MAX_MEMBERS];
+  const uint8_t *ys[SLIP39_MAX_MEMBERS];
+  size_t n = 0;
+  for (uint8_t i = 0; i < threshold - 2; i++) {
+    random(out[i], len);
+    xs[n] = i;
+    ys[n++] = out[i];
+  }
+  xs[n] = DIGEST_INDEX;
+  ys[n++] = digest_share;
+  xs[n] = SECRET_INDEX;
+  ys[n++] = secret;
+
+  for (uint8_t i = threshold - 2; i < count; i++)
+    interpolate(xs, ys, n, len, i, out[i]);
+
+  wipe_memset(digest_share, 0, sizeof(digest_share));
+  wipe_memset(mac, 0, sizeof(mac));
+}
+
+static slip39_error_t recover_secret(uint8_t threshold, const uint8_t *xs,
+                                     const uint8_t *const *ys, size_t len,
+                                     uint8_t *out) {
+  if (threshold == 1) {
+    memcpy(out, ys[0], len);
+    return SLIP39_OK;
+  }
+
+  uint8_t digest_share[SLIP39_MAX_SECRET];
+  uint8_t mac[SHA2_256_LEN];
+  interpolate(xs, ys, threshold, len, SECRET_INDEX, out);
+  interpolate(xs, ys, threshold, len, DIGEST_INDEX, digest_share);
+  sha2_hmac_sha256(digest_share + DIGEST_LEN, len - DIGEST_LEN, out, len,
+                   mac);
+
+  uint8_t diff = 0;
+  for (int i = 0; i < DIGEST_LEN; i++)
+    diff |= mac[i] ^ digest_share[i];
+
+  wipe_memset(digest_share, 0, sizeof(digest_share));
+  wipe_memset(mac, 0, sizeof(mac));
+  if (diff) {
+    wipe_memset(out, 0, len);
+    return SLIP39_ERR_DIGEST;
+  }
+  return SLIP39_OK;
+}
+
+/* ---------- Recovery ---------- */
+
+void slip39_set_init(slip39_set_t *set) {
+  if (set)
+    memset(set, 0, sizeof(*set));
+}
+
+slip39_error_t slip39_set_add(slip39_set_t *set, const slip39_share_t *share) {
+  if (!set || !share || !share_fields_valid(share))
+    return SLIP39_ERR_INVALID_ARG;
+
+  if (set->count > 0) {
+    const slip39_share_t *f = &set->shares[0];
+    if (share->identifier != f->identifier ||
+        share->extendable != f->extendable ||
+        share->iteration_exponent != f->iteration_exponent ||
+        share->group_threshold != f->group_threshold ||
+        share->group_count != f->group_count ||
+        share->value_len != f->value_len)
+      return SLIP39_ERR_MISMATCH;
+  }
+
+  for (size_t i = 0; i < set->count; i++) {
+    const slip39_share_t *s = &set->shares[i];
+    if (s->group_index != share->group_index)
+      continue;
+    if (s->member_threshold != share->member_threshold)
+      return SLIP39_ERR_MISMATCH;
+    if (s->member_index == share->member_index) {
+      return memcmp(s->value, share->value, s->value_len) == 0
+                 ? SLIP39_ERR_DUPLICATE
+                 : SLIP39_ERR_MISMATCH;
+    }
+  }
+
+  if (set->count >= SLIP39_MAX_SET_SHARES)
+    return SLIP39_ERR_FULL;
+  set->shares[set->count++] = *share;
+  return SLIP39_OK;
+}
+
+void slip39_set_status(const slip39_set_t *set, slip39_status_t *out) {
+  if (!out)
+    return;
+  memset(out, 0, sizeof(*out));
+  if (!set || set->count == 0)
+    return;
+
+  out->group_threshold = set->shares[0].group_threshold;
+  out->group_count = set->shares[0].group_count;
+  for (size_t i = 0; i < set->count; i++) {
+    const slip39_share_t *s = &set->shares[i];
+    out->member_threshold[s->group_index] = s->member_threshold;
+    out->member_count[s->group_index]++;
+  }
+  for (int g = 0; g < SLIP39_MAX_GROUPS; g++) {
+    if (out->member_threshold[g] &&
+        out->member_count[g] >= out->member_threshold[g])
+      out->groups_complete++;
+  }
+}
+
+bool slip39_set_ready(const slip39_set_t *set) {
+  slip39_status_t status;
+  slip39_set_status(set, &status);
+  return status.group_threshold > 0 &&
+         status.groups_complete >= status.group_threshold;
+}
+
+slip39_error_t slip39_set_combine(const slip39_set_t *set, uint8_t *ems,
+                                  size_t *ems_len) {
+  if (!set || !ems || !ems_len)
+    return SLIP39_ERR_INVALID_ARG;
+  if (!slip39_set_ready(set))
+    return SLIP39_ERR_INCOMPLETE;
+
+  const slip39_share_t *first = &set->shares[0];
+  size_t len = first->value_len;
+  uint8_t group_secrets[SLIP39_MAX_GROUPS][SLIP39_MAX_SECRET];
+  uint8_t group_xs[SLIP39_MAX_GROUPS];
+  const uint8_t *group_ys[SLIP39_MAX_GROUPS];
+  size_t groups = 0;
+  slip39_error_t err = SLIP39_OK;
+
+  for (uint8_t g = 0; g < SLIP39_MAX_GROUPS && groups < first->group_threshold;
+       g++) {
+    uint8_t xs[SLIP39_MAX_MEMBERS];
+    const uint8_t *ys[SLIP39_MAX_MEMBERS];
+    uint8_t threshold = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < set->count && (!threshold || n < threshold); i++) {
+      const slip39_share_t *s = &set->shares[i];
+      if (s->group_index != g)
+        continue;
+      threshold = s->member_threshold;
+      xs[n] = s->member_index;
+      ys[n++] = s->value;
+    }
+    if (!threshold || n < threshold)
+      continue;
+
+    err = recover_secret(threshold, xs, ys, len, group_secrets[groups]);
+    if (err != SLIP39_OK)
+      break;
+    group_xs[groups] = g;
+    group_ys[groups] = group_secrets[groups];
+    groups++;
+  }
+
+  if (err == SLIP39_OK)
+    err = recover_secret(first->group_threshold, group_xs, group_ys, len, ems);
+  if (err == SLIP39_OK)
+    *ems_len = len;
+  wipe_memset(group_secrets, 0, sizeof(group_secrets));
+  return err;
+}
+
+slip39_error_t slip39_recover(const slip39_set_t *set, const char *passphrase,
+                              uint8_t *secret, size_t *secret_len,
+                              slip39_progress_fn progress, void *ctx) {
+  if (!secret || !secret_len)
+    return SLIP39_ERR_INVALID_ARG;
+
+  uint8_t ems[SLIP39_MAX_SECRET];
+  size_t len = 0;
+  slip39_error_t err = slip39_set_combine(set, ems, &len);
+  if (err == SLIP39_OK) {
+    const slip39_share_t *first = &set->shares[0];
+    err = slip39_decrypt(ems, len, passphrase, first->identifier,
+                         first->extendable, first->iteration_exponent, secret,
+                         progress, ctx);
+  }
+  if (err == SLIP39_OK)
+    *secret_len = len;
+  wipe_memset(ems, 0, sizeof(ems));
+  return err;
+}
+
+void slip39_set_wipe(slip39_set_t *set) {
+  if (set)
+    wipe_memset(set, 0, sizeof(*set));
+}
+
+/* ---------- Encryption ---------- */
+
+typedef struct {
+  slip39_progress_fn progress;
+  void *ctx;
+  uint32_t done; // Iterations of finished rounds
+  uint32_t total;
+  bool cancelled;
+} feistel_tick_t;
+
+static bool feistel_tick(uint32_t iterations_done, void *ctx) {
+  feistel_tick_t *t = ctx;
+  if (t->progress &&
+      !t->progress((uint8_t)((uint64_t)(t->done + iterations_done) * 100 /
+                             t->total),
+                   t->ctx))
+    t->cancelled = true;
+  return !t->cancelled;
+}
+
+static bool passphrase_valid(const char *passphrase) {
+  for (const char *p = passphrase; p && *p; p++) {
+    if (*p < 32 || *p > 126)
+      return false;
+  }
+  return true;
+}
+
+// Round i keys PBKDF2 with i || passphrase, salted with the (identifier
+// prefix and the) right half; decryption runs the rounds backwards
+static slip39_error_t feistel(const uint8_t *in, size_t len,
+                              const char *passphrase, uint16_t identifier,
+                              bool extendable, uint8_t iteration_exponent,
+                              uint8_t *out, bool decrypt,
+                              slip39_progress_fn progress, void *ctx) {
+  if (!in || !out || identifier >> ID_BITS ||
+      iteration_exponent > SLIP39_MAX_EXPONENT)
+    return SLIP39_ERR_INVALID_ARG;
+  if (!secret_len_valid(len))
+    return SLIP39_ERR_LENGTH;
+  if (!passphrase_valid(passphrase))
+    return SLIP39_ERR_PASSPHRASE;
+
+  size_t pass_len = passphrase ? strlen(passphrase) : 0;
+  uint8_t pw[1 + SLIP39_MAX_PASSPHRASE];
+  if (pass_len > sizeof(pw) - 1)
+    return SLIP39_ERR_PASSPHRASE;
+  if (pass_len)
+    memcpy(pw + 1, passphrase, pass_len);
+
+  size_t half = len / 2;
+  uint8_t l[SLIP39_MAX_SECRET / 2], r[SLIP39_MAX_SECRET / 2];
+  uint8_t f[SLIP39_MAX_SECRET / 2];
+  uint8_t salt[8 + SLIP39_MAX_SECRET / 2];
+  size_t prefix = 0;
+  if (!extendable) {
+    memcpy(salt, "shamir", 6);
+    salt[6] = (uint8_t)(identifier >> 8);
+    salt[7] = (uint8_t)identifier;
+    prefix = 8;
+  }
+
+  uint32_t iterations = (BASE_ITERATIONS << iteration_exponent) / ROUNDS;
+  feistel_tick_t tick = {.progress = progress,
+                         .ctx = ctx,
+                         .total = iterations * ROUNDS};
+  slip39_error_t err = SLIP39_OK;
+
+  memcpy(l, in, half);
+  memcpy(r, in + half, half);
+  for (int step = 0; step < ROUNDS; step++) {
+    pw[0] = (uint8_t)(decrypt ? ROUNDS - 1 - step : step);
+    memcpy(salt + prefix, r, half);
+    if (!sha2_pbkdf2_sha256(pw, 1 + pass_len, salt, prefix + half,
+                            iterations, f, half, feistel_tick, &tick)) {
+      err = tick.cancelled ? SLIP39_ERR_CANCELLED : SLIP39_ERR_CRYPTO;
+      break;
+    }
+    for (size_t k = 0; k < half; k++)
+      f[k] ^= l[k];
+    memcpy(l, r, half);
+    memcpy(r, f, half);
+
+    tick.done += iterations;
+    if (!feistel_tick(0, &tick)) {
+      err = SLIP39_ERR_CANCELLED;
+      break;
+    }
+  }
+
+  if (err == SLIP39_OK) {
+    memcpy(out, r, half);
+    memcpy(out + half, l, half);
+  }
+  wipe_memset(pw, 0, sizeof(pw));
+  wipe_memset(l, 0, sizeof(l));
+  wipe_memset(r, 0, sizeof(r));
+  wipe_memset(f, 0, sizeof(f));
+  wipe_memset(salt, 0, sizeof(salt));
+  return err;
+}
+
+slip39_error_t slip39_encrypt(const uint8_t *in, size_t len,
+                              const char *passphrase, uint16_t identifier,
+                              bool extendable, uint8_t iteration_exponent,
+                              uint8_t *out, slip39_progress_fn progress,
+                              void *ctx) {
+  return feistel(in, len, passphrase, identifier, extendable,
+                 iteration_exponent, out, false, progress, ctx);
+}
+
+slip39_error_t slip39_decrypt(const uint8_t *in, size_t len,
+                              const char *passphrase, uint16_t identifier,
+                              bool extendable, uint8_t iteration_exponent,
+                              uint8_t *out, slip39_progress_fn progress,
+                              void *ctx) {
+  return feistel(in, len, passphrase, identifier, extendable,
+                 iteration_exponent, out, true, progress, ctx);
+}
+
+/* ---------- Generation ---------- */
+
+slip39_error_t slip39_split(const uint8_t *secret, size_t len,
+                            const char *passphrase, bool extendable,
+                            uint8_t iteration_exponent,
+                            uint8_t group_threshold,
+                            const slip39_group_spec_t *groups,
+                            uint8_t group_count, slip39_random_fn random,
+                            slip39_share_t *shares, size_t max_shares,
+                            size_t *share_count, slip39_progress_fn progress,
+                            void *ctx) {
+  if (!secret || !groups || !random || !shares || !share_count)
+    return SLIP39_ERR_INVALID_ARG;
+  if (!secret_len_valid(len))
+    return SLIP39_ERR_LENGTH;
+  if (group_count < 1 || group_count > SLIP39_MAX_GROUPS ||
+      group_threshold < 1 || group_threshold > group_count)
+    return SLIP39_ERR_INVALID_ARG;
+
+  size_t total = 0;
+  for (uint8_t g = 0; g < group_count; g++) {
+    const slip39_group_spec_t *spec = &groups[g];
+    if (spec->threshold < 1 || spec->threshold > spec->count ||
+        spec->count > SLIP39_MAX_MEMBERS ||
+        (spec->threshold == 1 && spec->count > 1))
+      return SLIP39_ERR_INVALID_ARG;
+    total += spec->count;
+  }
+  if (total > max_shares)
+    return SLIP39_ERR_INVALID_ARG;
+
+  uint8_t id_bytes[2];
+  random(id_bytes, sizeof(id_bytes));
+  uint16_t identifier = (uint16_t)((id_bytes[0] << 8 | id_bytes[1]) &
+                                   ((1u << ID_BITS) - 1));
+
+  uint8_t ems[SLIP39_MAX_SECRET];
+  slip39_error_t err =
+      slip39_encrypt(secret, len, passphrase, identifier, extendable,
+                     iteration_exponent, ems, progress, ctx);
+  if (err != SLIP39_OK)
+    return err;
+
+  uint8_t group_secrets[SLIP39_MAX_GROUPS][SLIP39_MAX_SECRET];
+  uint8_t members[SLIP39_MAX_MEMBERS][SLIP39_MAX_SECRET];
+  split_secret(group_threshold, group_count, ems, len, random, group_secrets);
+
+  size_t n = 0;
+  for (uint8_t g = 0; g < group_count; g++) {
+    split_secret(groups[g].threshold, groups[g].count, group_secrets[g], len,
+                 random, members);
+    for (uint8_t m = 0; m < groups[g].count; m++) {
+      slip39_share_t *s = &shares[n++];
+      memset(s, 0, sizeof(*s));
+      s->identifier = identifier;
+      s->extendable = extendable;
+      s->iteration_exponent = iteration_exponent;
+      s->group_index = g;
+      s->group_threshold = group_threshold;
+      s->group_count = group_count;
+      s->member_index = m;
+      s->member_threshold = groups[g].threshold;
+      s->value_len = (uint8_t)len;
+      memcpy(s->value, members[m], len);
+    }
+  }
+
+  wipe_memset(ems, 0, sizeof(ems));
+  wipe_memset(group_secrets, 0, sizeof(group_secrets));
+  wipe_memset(members, 0, sizeof(members));
+  *share_count = n;
+  return SLIP39_OK;
+}
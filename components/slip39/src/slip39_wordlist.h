@@ -0,0 +1,8 @@
+#ifndef SLIP39_WORDLIST_H
+#define SLIP39_WORDLIST_H
+
+#include "slip39.h"
+
+extern const char *const slip39_wordlist[SLIP39_WORDS];
+
+#endif // SLIP39_WORDLIST_H
@@ -0,0 +1,505 @@
+/*
+ * SLIP-39 Test Suite
+ * Compile with: make
+ * Run: ./test_slip39
+ *
+ * Vectors are from the SLIP-39 reference test set (passphrase "TREZOR");
+ * generated sets use a seeded generator so failures reproduce.
+ */
+
+#include "slip39.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static uint32_t rng_state = 1;
+
+static void test_random(uint8_t *buf, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    buf[i] = (uint8_t)rng_state;
+  }
+}
+
+static size_t from_hex(const char *hex, uint8_t *out) {
+  size_t n = strlen(hex) / 2;
+  for (size_t i = 0; i < n; i++) {
+    unsigned v;
+    sscanf(hex + i * 2, "%2x", &v);
+    out[i] = (uint8_t)v;
+  }
+  return n;
+}
+
+/* ---------- Vectors ---------- */
+
+typedef struct {
+  const char *description;
+  const char *shares[4];
+  const char *secret_hex; // NULL: the set must be rejected
+} vector_t;
+
+static const vector_t vectors[] = {
+    {"1-of-1, 128 bits",
+     {"duckling enlarge academic academic agency result length solution "
+      "fridge kidney coal piece deal husband erode duke ajar critical "
+      "decision keyboard"},
+     "bb54aac4b89dc868ba37d9cc21b2cece"},
+    {"invalid checksum",
+     {"duckling enlarge academic academic agency result length solution "
+      "fridge kidney coal piece deal husband erode duke ajar critical "
+      "decision kidney"},
+     NULL},
+    {"2-of-3 members, 128 bits",
+     {"shadow pistol academic always adequate wildlife fancy gross oasis "
+      "cylinder mustang wrist rescue view short owner flip making coding "
+      "armed",
+      "shadow pistol academic acid actress prayer class unknown daughter "
+      "sweater depict flip twice unkind craft early superior advocate guest "
+      "smoking"},
+     "b43ceb7e57a0ea8766221624d01b0864"},
+    {"1-of-1, 256 bits",
+     {"theory painting academic academic armed sweater year military elder "
+      "discuss acne wildlife boring employer fused large satoshi bundle "
+      "carbon diagnose anatomy hamster leaves tracks paces beyond phantom "
+      "capital marvel lips brave detect luck"},
+     "989baf9dcaad5b10ca33dfd8cc75e42477025dce88ae83e75a230086a0e00e92"},
+};
+
+#define NUM_VECTORS (sizeof(vectors) / sizeof(vectors[0]))
+
+static slip39_error_t recover_vector(const vector_t *v, uint8_t *secret,
+                                     size_t *len) {
+  slip39_set_t set;
+  slip39_set_init(&set);
+  slip39_error_t err = SLIP39_OK;
+  for (int i = 0; i < 4 && v->shares[i] && err == SLIP39_OK; i++) {
+    slip39_share_t share;
+    err = slip39_share_parse(v->shares[i], &share);
+    if (err == SLIP39_OK)
+      err = slip39_set_add(&set, &share);
+  }
+  if (err == SLIP39_OK)
+    err = slip39_recover(&set, "TREZOR", secret, len, NULL, NULL);
+  slip39_set_wipe(&set);
+  return err;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_wordlist(void) {
+  TEST("wordlist is sorted with unique four-letter prefixes");
+  for (uint16_t i = 1; i < SLIP39_WORDS; i++) {
+    if (strncmp(slip39_word(i - 1), slip39_word(i), 4) >= 0) {
+      FAIL("order or prefix collision");
+      return;
+    }
+  }
+  if (slip39_word(SLIP39_WORDS) != NULL ||
+      strcmp(slip39_word(0), "academic") != 0 ||
+      strcmp(slip39_word(SLIP39_WORDS - 1), "zero") != 0) {
+    FAIL("bounds");
+    return;
+  }
+  if (slip39_word_index("academic") != 0 || slip39_word_index("acad") != 0 ||
+      slip39_word_index("aca") != -1 || slip39_word_index("academix") != -1 ||
+      slip39_word_index("zero") != SLIP39_WORDS - 1) {
+    FAIL("lookup");
+    return;
+  }
+  uint16_t first;
+  if (slip39_prefix_range("", 0, &first) != SLIP39_WORDS || first != 0 ||
+      slip39_prefix_range("ac", 2, &first) != 7 || first != 0 ||
+      slip39_prefix_range("q", 1, NULL) != 4) {
+    FAIL("prefix range");
+    return;
+  }
+  // "ac" continues as academic, acid, acne, acquire, acrobat, activity, actress
+  uint32_t expect = 1u << ('a' - 'a') | 1u << ('i' - 'a') |
+                    1u << ('n' - 'a') | 1u << ('q' - 'a') |
+                    1u << ('r' - 'a') | 1u << ('t' - 'a');
+  if (slip39_next_letters("ac", 2) != expect ||
+      slip39_next_letters("x", 1) != 0) {
+    FAIL("next letters");
+    return;
+  }
+  PASS();
+}
+
+static void test_vectors(void) {
+  TEST("reference vectors recover their master secrets");
+  for (size_t i = 0; i < NUM_VECTORS; i++) {
+    const vector_t *v = &vectors[i];
+    uint8_t secret[SLIP39_MAX_SECRET], expected[SLIP39_MAX_SECRET];
+    size_t len = 0;
+    slip39_error_t err = recover_vector(v, secret, &len);
+    if (!v->secret_hex) {
+      if (err == SLIP39_OK) {
+        FAIL(v->description);
+        return;
+      }
+      continue;
+    }
+    size_t expected_len = from_hex(v->secret_hex, expected);
+    if (err != SLIP39_OK || len != expected_len ||
+        memcmp(secret, expected, len) != 0) {
+      FAIL(v->description);
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_share_roundtrip(void) {
+  TEST("shares decode and re-encode to the same words");
+  for (size_t i = 0; i < NUM_VECTORS; i++) {
+    for (int j = 0; j < 4 && vectors[i].shares[j]; j++) {
+      if (!vectors[i].secret_hex)
+        continue;
+      slip39_share_t share;
+      char text[SLIP39_MAX_SHARE_WORDS * (SLIP39_MAX_WORD_LEN + 1)];
+      if (slip39_share_parse(vectors[i].shares[j], &share) != SLIP39_OK ||
+          slip39_share_format(&share, text, sizeof(text)) == 0 ||
+          strcmp(text, vectors[i].shares[j]) != 0) {
+        FAIL(vectors[i].description);
+        return;
+      }
+      if (slip39_share_format(&share, text, 20) != 0) {
+        FAIL("short buffer accepted");
+        return;
+      }
+    }
+  }
+
+  slip39_share_t share;
+  slip39_share_parse(vectors[2].shares[0], &share);
+  if (share.iteration_exponent != 2 || share.extendable ||
+      share.group_threshold != 1 || share.group_count != 1 ||
+      share.member_threshold != 2 || share.value_len != 16) {
+    FAIL("header fields");
+    return;
+  }
+  PASS();
+}
+
+static void test_decode_errors(void) {
+  TEST("malformed shares are rejected with the right error");
+  slip39_share_t share;
+  // Same words as vector 1 with a padding bit set and the checksum fixed
+  if (slip39_share_parse("duckling enlarge academic academic lily result "
+                         "length solution fridge kidney coal piece deal "
+                         "husband erode duke ajar faint holiday crazy",
+                         &share) != SLIP39_ERR_PADDING) {
+    FAIL("padding");
+    return;
+  }
+  if (slip39_share_parse(vectors[1].shares[0], &share) !=
+      SLIP39_ERR_CHECKSUM) {
+    FAIL("checksum");
+    return;
+  }
+  if (slip39_share_parse("duckling enlarge academic", &share) !=
+      SLIP39_ERR_LENGTH) {
+    FAIL("length");
+    return;
+  }
+  if (slip39_share_parse("duckling enlarge bitcoin", &share) !=
+      SLIP39_ERR_WORD) {
+    FAIL("word");
+    return;
+  }
+
+  // 21 words: 140 value bits would leave 12 bits of padding
+  uint16_t words[SLIP39_MAX_SHARE_WORDS] = {0};
+  if (slip39_share_decode(words, 21, &share) != SLIP39_ERR_LENGTH) {
+    FAIL("21 words");
+    return;
+  }
+  if (slip39_share_parse("DUCKLING Enlarge academic academic agency result "
+                         "length solution fridge kidney coal piece deal "
+                         "husband erode duke ajar critical decision keyboard",
+                         &share) != SLIP39_OK) {
+    FAIL("upper case");
+    return;
+  }
+  PASS();
+}
+
+static bool generate(slip39_share_t *shares, size_t *count, size_t len,
+                     bool extendable, const char *passphrase,
+                     uint8_t *secret) {
+  static const slip39_group_spec_t groups[] = {{1, 1}, {2, 3}, {3, 5}};
+  test_random(secret, len);
+  return slip39_split(secret, len, passphrase, extendable, 0, 2, groups, 3,
+                      test_random, shares, 16, count, NULL,
+                      NULL) == SLIP39_OK &&
+         *count == 9;
+}
+
+static slip39_error_t recover_subset(const slip39_share_t *shares,
+                                     const int *pick, int n,
+                                     const char *passphrase, uint8_t *secret,
+                                     size_t *len) {
+  slip39_set_t set;
+  slip39_set_init(&set);
+  slip39_error_t err = SLIP39_OK;
+  for (int i = 0; i < n && err == SLIP39_OK; i++) {
+    // Through words, as a user would enter them
+    uint16_t words[SLIP39_MAX_SHARE_WORDS];
+    slip39_share_t decoded;
+    size_t count =
+        slip39_share_encode(&shares[pick[i]], words, SLIP39_MAX_SHARE_WORDS);
+    err = slip39_share_decode(words, count, &decoded);
+    if (err == SLIP39_OK)
+      err = slip39_set_add(&set, &decoded);
+  }
+  if (err == SLIP39_OK)
+    err = slip39_recover(&set, passphrase, secret, len, NULL, NULL);
+  slip39_set_wipe(&set);
+  return err;
+}
+
+static void test_split_recover(void) {
+  TEST("generated 2-of-3 group sets recover from any qualifying subset");
+  // Groups: 0 = {0} 1-of-1, 1 = {1,2,3} 2-of-3, 2 = {4..8} 3-of-5
+  static const int subsets[][5] = {
+      {0, 1, 2, -1}, {3, 0, 2, -1}, {0, 8, 5, 6, -1}, {2, 3, 4, 6, 7}};
+  for (int ext = 0; ext < 2; ext++) {
+    for (size_t len = 16; len <= 32; len += 16) {
+      slip39_share_t shares[16];
+      size_t count;
+      uint8_t secret[SLIP39_MAX_SECRET], out[SLIP39_MAX_SECRET];
+      size_t out_len;
+      if (!generate(shares, &count, len, ext, "pass", secret)) {
+        FAIL("split");
+        return;
+      }
+      if (slip39_share_words(len) != (len == 16 ? 20u : 33u)) {
+        FAIL("share length");
+        return;
+      }
+      for (size_t s = 0; s < sizeof(subsets) / sizeof(subsets[0]); s++) {
+        int n = 0;
+        while (n < 5 && subsets[s][n] >= 0)
+          n++;
+        if (recover_subset(shares, subsets[s], n, "pass", out, &out_len) !=
+                SLIP39_OK ||
+            out_len != len || memcmp(out, secret, len) != 0) {
+          FAIL("recover");
+          return;
+        }
+      }
+
+      // A wrong passphrase decrypts to another (plausible) secret
+      if (recover_subset(shares, subsets[0], 3, "", out, &out_len) !=
+              SLIP39_OK ||
+          memcmp(out, secret, len) == 0) {
+        FAIL("passphrase ignored");
+        return;
+      }
+    }
+  }
+  PASS();
+}
+
+static void test_set_tracking(void) {
+  TEST("set tracks groups and rejects foreign or repeated shares");
+  slip39_share_t shares[16], other[16];
+  size_t count, other_count;
+  uint8_t secret[SLIP39_MAX_SECRET];
+  if (!generate(shares, &count, 16, true, NULL, secret) ||
+      !generate(other, &other_count, 16, true, NULL, secret)) {
+    FAIL("split");
+    return;
+  }
+
+  slip39_set_t set;
+  slip39_status_t st;
+  slip39_set_init(&set);
+  slip39_set_status(&set, &st);
+  if (st.group_threshold != 0 || slip39_set_ready(&set)) {
+    FAIL("empty set");
+    return;
+  }
+
+  slip39_set_add(&set, &shares[4]);
+  slip39_set_add(&set, &shares[5]);
+  slip39_set_status(&set, &st);
+  if (st.group_threshold != 2 || st.group_count != 3 ||
+      st.groups_complete != 0 || st.member_threshold[2] != 3 ||
+      st.member_count[2] != 2 || st.member_threshold[1] != 0) {
+    FAIL("partial status");
+    return;
+  }
+
+  if (slip39_set_add(&set, &shares[5]) != SLIP39_ERR_DUPLICATE ||
+      slip39_set_add(&set, &other[6]) != SLIP39_ERR_MISMATCH) {
+    FAIL("duplicate / foreign share");
+    return;
+  }
+  slip39_share_t forged = shares[6];
+  forged.member_index = shares[4].member_index;
+  if (slip39_set_add(&set, &forged) != SLIP39_ERR_MISMATCH) {
+    FAIL("conflicting member index");
+    return;
+  }
+
+  uint8_t ems[SLIP39_MAX_SECRET];
+  size_t ems_len;
+  if (slip39_set_combine(&set, ems, &ems_len) != SLIP39_ERR_INCOMPLETE) {
+    FAIL("combined early");
+    return;
+  }
+
+  // A corrupted value keeps a valid checksum once re-encoded, but the
+  // digest share no longer matches
+  slip39_share_t bad = shares[6];
+  bad.value[3] ^= 0x40;
+  slip39_set_add(&set, &bad);
+  slip39_set_add(&set, &shares[0]);
+  if (!slip39_set_ready(&set) ||
+      slip39_set_combine(&set, ems, &ems_len) != SLIP39_ERR_DIGEST) {
+    FAIL("digest");
+    return;
+  }
+  slip39_set_wipe(&set);
+  PASS();
+}
+
+typedef struct {
+  int calls;
+  uint8_t last;
+  bool monotonic;
+  uint8_t cancel_at; // 0: never
+} progress_log_t;
+
+static bool log_progress(uint8_t percent, void *ctx) {
+  progress_log_t *log = ctx;
+  log->monotonic &= percent >= log->last;
+  log->last = percent;
+  log->calls++;
+  return !log->cancel_at || percent < log->cancel_at;
+}
+
+static void test_progress_cancel(void) {
+  TEST("Feistel rounds report progress and stop when cancelled");
+  uint8_t secret[16] = {1, 2, 3}, out[16];
+  progress_log_t log = {.monotonic = true};
+  if (slip39_encrypt(secret, 16, "x", 1234, false, 1, out, log_progress,
+                     &log) != SLIP39_OK ||
+      !log.monotonic || log.last != 100 || log.calls < 8) {
+    FAIL("progress");
+    return;
+  }
+
+  uint8_t back[16];
+  slip39_decrypt(out, 16, "x", 1234, false, 1, back, NULL, NULL);
+  if (memcmp(back, secret, 16) != 0) {
+    FAIL("decrypt");
+    return;
+  }
+
+  progress_log_t stop = {.monotonic = true, .cancel_at = 50};
+  if (slip39_decrypt(out, 16, "x", 1234, false, 1, back, log_progress,
+                     &stop) != SLIP39_ERR_CANCELLED ||
+      stop.last < 50 || stop.last > 75) {
+    FAIL("cancel");
+    return;
+  }
+
+  if (slip39_encrypt(secret, 16, "caf\xc3\xa9", 0, false, 0, out, NULL,
+                     NULL) != SLIP39_ERR_PASSPHRASE ||
+      slip39_encrypt(secret, 15, NULL, 0, false, 0, out, NULL, NULL) !=
+          SLIP39_ERR_LENGTH) {
+    FAIL("argument checks");
+    return;
+  }
+  PASS();
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench(void) {
+  slip39_share_t share;
+  uint16_t words[SLIP39_MAX_SHARE_WORDS];
+  slip39_share_parse(vectors[3].shares[0], &share);
+  size_t count = slip39_share_encode(&share, words, SLIP39_MAX_SHARE_WORDS);
+  volatile int sink = 0;
+
+  const int iters = 100000;
+  double t0 = now_ms();
+  for (int i = 0; i < iters; i++)
+    sink += slip39_share_decode(words, count, &share);
+  double t1 = now_ms();
+
+  slip39_share_t shares[16];
+  size_t n;
+  uint8_t secret[SLIP39_MAX_SECRET];
+  generate(shares, &n, 32, true, NULL, secret);
+  slip39_set_t set;
+  slip39_set_init(&set);
+  for (int i = 4; i < 9; i++)
+    slip39_set_add(&set, &shares[i]);
+  slip39_set_add(&set, &shares[0]);
+  uint8_t ems[SLIP39_MAX_SECRET];
+  size_t ems_len;
+  const int combine_iters = 20000;
+  double t2 = now_ms();
+  for (int i = 0; i < combine_iters; i++)
+    sink += slip39_set_combine(&set, ems, &ems_len);
+  double t3 = now_ms();
+
+  double t4 = now_ms();
+  slip39_decrypt(ems, 32, "TREZOR", 0, true, 0, secret, NULL, NULL);
+  double t5 = now_ms();
+  (void)sink;
+
+  printf("\nBenchmark:\n");
+  printf("  33-word share decode + checksum: %.2f us\n",
+         (t1 - t0) * 1000.0 / iters);
+  printf("  Combine 2 groups (1-of-1, 3-of-5): %.2f us\n",
+         (t3 - t2) * 1000.0 / combine_iters);
+  printf("  Feistel decrypt, exponent 0 (10000 iterations): %.1f ms\n",
+         t5 - t4);
+}
+
+int main(void) {
+  printf("=== SLIP-39 Tests ===\n\n");
+
+  test_wordlist();
+  test_vectors();
+  test_share_roundtrip();
+  test_decode_errors();
+  test_split_recover();
+  test_set_tracking();
+  test_progress_cancel();
+
+  bench();
+
+  printf("\nResults: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+#ifndef TX_WEIGHT_H
+#define TX_WEIGHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Signed-transaction weight estimate from an unsigned transaction
+ *
+ * The non-witness part is sized exactly from the outputs and the input
+ * count. Each input's scriptSig and witness are sized from the script type
+ * of the output it spends and, for P2SH and P2WSH, the redeem or witness
+ * script the PSBT carries:
+ *
+ * - P2PKH, P2WPKH, P2SH-P2WPKH: one signature and a compressed key
+ * - P2SH, P2WSH, P2SH-P2WSH m-of-n multisig (multi or sortedmulti): the
+ *   dummy element plus m signatures plus the script
+ * - P2TR: a key-path Schnorr signature with the default sighash
+ *
+ * ECDSA signatures are counted at their 72-byte maximum. Low-R signers
+ * produce 71 bytes, so the estimate can be up to one vbyte per signature
+ * high and the fee rate shown a little under the real one.
+ *
+ * Everything is one pass over the inputs and outputs.
+ */
+
+typedef enum {
+  TX_WEIGHT_UNKNOWN = 0,
+  TX_WEIGHT_P2PKH,
+  TX_WEIGHT_P2WPKH,
+  TX_WEIGHT_P2SH_P2WPKH,
+  TX_WEIGHT_P2SH_MULTISIG,
+  TX_WEIGHT_P2WSH_MULTISIG,
+  TX_WEIGHT_P2SH_P2WSH_MULTISIG,
+  TX_WEIGHT_P2TR_KEYPATH,
+} tx_weight_input_type_t;
+
+typedef struct {
+  const uint8_t *spk; // scriptPubKey of the output being spent
+  size_t spk_len;
+  const uint8_t *redeem_script; // NULL if the PSBT has none
+  size_t redeem_script_len;
+  const uint8_t *witness_script; // NULL if the PSBT has none
+  size_t witness_script_len;
+} tx_weight_input_t;
+
+typedef struct {
+  uint32_t weight;
+  uint32_t vsize; // ceil(weight / 4)
+  bool has_witness;
+} tx_weight_result_t;
+
+/**
+ * @brief How an input will be spent, or TX_WEIGHT_UNKNOWN
+ */
+tx_weight_input_type_t tx_weight_classify(const tx_weight_input_t *in);
+
+/**
+ * @brief Estimate the signed transaction's weight
+ *
+ * @param out_spk_lens scriptPubKey length of each output
+ * @return false if any input can't be sized (result left zeroed)
+ */
+bool tx_weight_estimate(const tx_weight_input_t *inputs, size_t num_inputs,
+                        const size_t *out_spk_lens, size_t num_outputs,
+                        tx_weight_result_t *result);
+
+/**
+ * @brief Fee rate in tenths of a sat/vB, rounded down (0 if vsize is 0)
+ */
+uint64_t tx_weight_fee_rate_x10(uint64_t fee, uint32_t vsize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TX_WEIGHT_H
@@ -0,0 +1,208 @@
+/*
+ * Transaction weight estimate for PSBT review
+ */
+
+#include "tx_weight.h"
+#include <string.h>
+
+#define ECDSA_SIG_MAX 72   // DER signature plus sighash byte
+#define SCHNORR_SIG_LEN 64 // SIGHASH_DEFAULT omits the sighash byte
+#define COMPRESSED_PUBKEY_LEN 33
+
+#define OP_0 0x00
+#define OP_1 0x51
+#define OP_16 0x60
+#define OP_CHECKMULTISIG 0xae
+
+static size_t varint_len(uint64_t n) {
+  if (n < 0xfd)
+    return 1;
+  if (n <= 0xffff)
+    return 3;
+  if (n <= 0xffffffff)
+    return 5;
+  return 9;
+}
+
+// Opcode bytes needed to push n bytes of data
+static size_t push_opcode_len(size_t n) {
+  if (n < 76)
+    return 1;
+  if (n <= 0xff)
+    return 2;
+  if (n <= 0xffff)
+    return 3;
+  return 5;
+}
+
+static bool is_p2pkh(const uint8_t *s, size_t len) {
+  return len == 25 && s[0] == 0x76 && s[1] == 0xa9 && s[2] == 0x14 &&
+         s[23] == 0x88 && s[24] == 0xac;
+}
+
+static bool is_p2sh(const uint8_t *s, size_t len) {
+  return len == 23 && s[0] == 0xa9 && s[1] == 0x14 && s[22] == 0x87;
+}
+
+static bool is_p2wpkh(const uint8_t *s, size_t len) {
+  return len == 22 && s[0] == OP_0 && s[1] == 0x14;
+}
+
+static bool is_p2wsh(const uint8_t *s, size_t len) {
+  return len == 34 && s[0] == OP_0 && s[1] == 0x20;
+}
+
+static bool is_p2tr(const uint8_t *s, size_t len) {
+  return len == 34 && s[0] == OP_1 && s[1] == 0x20;
+}
+
+// OP_m <33-byte key> x n OP_n OP_CHECKMULTISIG; returns m, or 0
+static unsigned multisig_threshold(const uint8_t *s, size_t len) {
+  if (!s || len < 3 || s[0] < OP_1 || s[0] > OP_16 ||
+      s[len - 1] != OP_CHECKMULTISIG || s[len - 2] < OP_1 ||
+      s[len - 2] > OP_16)
+    return 0;
+  unsigned m = s[0] - OP_1 + 1;
+  unsigned n = s[len - 2] - OP_1 + 1;
+  if (m > n || len != 3 + (size_t)n * (1 + COMPRESSED_PUBKEY_LEN))
+    return 0;
+  for (unsigned i = 0; i < n; i++) {
+    if (s[1 + i * (1 + COMPRESSED_PUBKEY_LEN)] != COMPRESSED_PUBKEY_LEN)
+      return 0;
+  }
+  return m;
+}
+
+tx_weight_input_type_t tx_weight_classify(const tx_weight_input_t *in) {
+  if (!in || !in->spk)
+    return TX_WEIGHT_UNKNOWN;
+  const uint8_t *rs = in->redeem_script;
+  size_t rs_len = rs ? in->redeem_script_len : 0;
+  const uint8_t *ws = in->witness_script;
+  size_t ws_len = ws ? in->witness_script_len : 0;
+
+  if (is_p2pkh(in->spk, in->spk_len))
+    return TX_WEIGHT_P2PKH;
+  if (is_p2wpkh(in->spk, in->spk_len))
+    return TX_WEIGHT_P2WPKH;
+  if (is_p2tr(in->spk, in->spk_len))
+    return TX_WEIGHT_P2TR_KEYPATH;
+  if (is_p2wsh(in->spk, in->spk_len))
+    return multisig_threshold(ws, ws_len) ? TX_WEIGHT_P2WSH_MULTISIG
+                                          : TX_WEIGHT_UNKNOWN;
+  if (!is_p2sh(in->spk, in->spk_len) || !rs)
+    return TX_WEIGHT_UNKNOWN;
+
+  if (is_p2wpkh(rs, rs_len))
+    return TX_WEIGHT_P2SH_P2WPKH;
+  if (is_p2wsh(rs, rs_len))
+    return multisig_threshold(ws, ws_len) ? TX_WEIGHT_P2SH_P2WSH_MULTISIG
+                                          : TX_WEIGHT_UNKNOWN;
+  return multisig_threshold(rs, rs_len) ? TX_WEIGHT_P2SH_MULTISIG
+                                        : TX_WEIGHT_UNKNOWN;
+}
+
+// Witness bytes for m signatures plus the script, after the dummy element
+static size_t multisig_witness_len(unsigned m, size_t script_len) {
+  return varint_len(m + 2) + 1 + m * (1 + ECDSA_SIG_MAX) +
+         varint_len(script_len) + script_len;
+}
+
+// scriptSig and witness sizes of a signed input
+static bool input_sizes(const tx_weight_input_t *in, size_t *script_sig,
+                        size_t *witness) {
+  const size_t wpkh_witness =
+      1 + (1 + ECDSA_SIG_MAX) + (1 + COMPRESSED_PUBKEY_LEN);
+
+  switch (tx_weight_classify(in)) {
+  case TX_WEIGHT_P2PKH:
+    *script_sig = (1 + ECDSA_SIG_MAX) + (1 + COMPRESSED_PUBKEY_LEN);
+    *witness = 0;
+    return true;
+  case TX_WEIGHT_P2WPKH:
+    *script_sig = 0;
+    *witness = wpkh_witness;
+    return true;
+  case TX_WEIGHT_P2SH_P2WPKH:
+    *script_sig = 1 + in->redeem_script_len;
+    *witness = wpkh_witness;
+    return true;
+  case TX_WEIGHT_P2SH_MULTISIG: {
+    unsigned m =
+        multisig_threshold(in->redeem_script, in->redeem_script_len);
+    *script_sig = 1 + m * (1 + ECDSA_SIG_MAX) +
+                  push_opcode_len(in->redeem_script_len) +
+                  in->redeem_script_len;
+    *witness = 0;
+    return true;
+  }
+  case TX_WEIGHT_P2WSH_MULTISIG:
+    *script_sig = 0;
+    *witness = multisig_witness_len(
+        multisig_threshold(in->witness_script, in->witness_script_len),
+        in->witness_script_len);
+    return true;
+  case TX_WEIGHT_P2SH_P2WSH_MULTISIG:
+    *script_sig = 1 + in->redeem_script_len;
+    *witness = multisig_witness_len(
+        multisig_threshold(in->witness_script, in->witness_script_len),
+        in->witness_script_len);
+    return true;
+  case TX_WEIGHT_P2TR_KEYPATH:
+    *script_sig = 0;
+    *witness = 1 + 1 + SCHNORR_SIG_LEN;
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool tx_weight_estimate(const tx_weight_input_t *inputs, size_t num_inputs,
+                        const size_t *out_spk_lens, size_t num_outputs,
+                        tx_weight_result_t *result) {
+  if (!result)
+    return false;
+  memset(result, 0, sizeof(*result));
+  if ((!inputs && num_inputs > 0) || (!out_spk_lens && num_outputs > 0))
+    return false;
+
+  // Version and locktime, then the counts
+  uint64_t base = 4 + 4 + varint_len(num_inputs) + varint_len(num_outputs);
+  uint64_t witness = 0;
+  size_t witness_inputs = 0;
+
+  for (size_t i = 0; i < num_inputs; i++) {
+    size_t script_sig, wit;
+    if (!input_sizes(&inputs[i], &script_sig, &wit))
+      return false;
+    // Outpoint, scriptSig, sequence
+    base += 36 + varint_len(script_sig) + script_sig + 4;
+    witness += wit;
+    witness_inputs += wit > 0;
+  }
+
+  for (size_t i = 0; i < num_outputs; i++)
+    base += 8 + varint_len(out_spk_lens[i]) + out_spk_lens[i];
+
+  uint64_t weight = base * 4;
+  if (witness_inputs > 0) {
+    // Marker and flag, and an empty stack for each non-witness input
+    weight += 2 + witness + (num_inputs - witness_inputs);
+    result->has_witness = true;
+  }
+  if (weight > UINT32_MAX)
+    return false;
+
+  result->weight = (uint32_t)weight;
+  result->vsize = (uint32_t)((weight + 3) / 4);
+  return true;
+}
+
+uint64_t tx_weight_fee_rate_x10(uint64_t fee, uint32_t vsize) {
+  if (vsize == 0)
+    return 0;
+  // Values come from the PSBT and aren't bounded by the money supply
+  if (fee > UINT64_MAX / 10)
+    return UINT64_MAX;
+  return fee * 10 / vsize;
+}
@@ -0,0 +1,240 @@
+/*
+ * Transaction Weight Test Suite
+ * Compile with: make
+ * Run: ./test_tx_weight
+ *
+ * Expected sizes are the commonly published figures for each script type
+ * (e.g. 141 vB for a 1-in 2-out P2WPKH spend, 111 vB for 1-in 1-out
+ * taproot, 297 bytes for a P2SH 2-of-3 input), all with 72-byte ECDSA
+ * signatures.
+ */
+
+#include "tx_weight.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) printf("Testing: %s... ", name)
+#define PASS()                                                                 \
+  do {                                                                         \
+    printf("PASS\n");                                                          \
+    tests_passed++;                                                            \
+  } while (0)
+#define FAIL(msg)                                                              \
+  do {                                                                         \
+    printf("FAIL: %s\n", msg);                                                 \
+    tests_failed++;                                                            \
+  } while (0)
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ---------- Scripts ---------- */
+
+static uint8_t p2pkh[25] = {0x76, 0xa9, 0x14, [23] = 0x88, [24] = 0xac};
+static uint8_t p2sh[23] = {0xa9, 0x14, [22] = 0x87};
+static uint8_t p2wpkh[22] = {0x00, 0x14};
+static uint8_t p2wsh[34] = {0x00, 0x20};
+static uint8_t p2tr[34] = {0x51, 0x20};
+
+// OP_m <key> x n OP_n OP_CHECKMULTISIG
+static size_t make_multisig(uint8_t *out, unsigned m, unsigned n) {
+  size_t len = 0;
+  out[len++] = (uint8_t)(0x50 + m);
+  for (unsigned i = 0; i < n; i++) {
+    out[len++] = 33;
+    out[len] = 0x02;
+    memset(out + len + 1, (int)i + 1, 32);
+    len += 33;
+  }
+  out[len++] = (uint8_t)(0x50 + n);
+  out[len++] = 0xae;
+  return len;
+}
+
+static tx_weight_input_t input(const uint8_t *spk, size_t spk_len) {
+  tx_weight_input_t in = {.spk = spk, .spk_len = spk_len};
+  return in;
+}
+
+static bool check(const char *what, const tx_weight_input_t *ins, size_t n_in,
+                  const size_t *outs, size_t n_out, uint32_t weight,
+                  uint32_t vsize) {
+  tx_weight_result_t r;
+  if (!tx_weight_estimate(ins, n_in, outs, n_out, &r) || r.weight != weight ||
+      r.vsize != vsize) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%s: weight %u vsize %u, expected %u/%u", what,
+             r.weight, r.vsize, weight, vsize);
+    FAIL(msg);
+    return false;
+  }
+  return true;
+}
+
+/* ---------- Tests ---------- */
+
+static void test_single_sig(void) {
+  TEST("single-sig spends");
+  tx_weight_input_t wpkh = input(p2wpkh, sizeof(p2wpkh));
+  tx_weight_input_t tr = input(p2tr, sizeof(p2tr));
+  tx_weight_input_t pkh = input(p2pkh, sizeof(p2pkh));
+  tx_weight_input_t sh_wpkh = input(p2sh, sizeof(p2sh));
+  sh_wpkh.redeem_script = p2wpkh;
+  sh_wpkh.redeem_script_len = sizeof(p2wpkh);
+
+  const size_t two_wpkh[] = {22, 22};
+  const size_t one_tr[] = {34};
+  const size_t one_pkh[] = {25};
+  const size_t one_wpkh[] = {22};
+  if (!check("p2wpkh 1-2", &wpkh, 1, two_wpkh, 2, 562, 141) ||
+      !check("p2tr 1-1", &tr, 1, one_tr, 1, 444, 111) ||
+      !check("p2pkh 1-1", &pkh, 1, one_pkh, 1, 768, 192) ||
+      !check("p2sh-p2wpkh 1-1", &sh_wpkh, 1, one_wpkh, 1, 530, 133))
+    return;
+
+  // A legacy input in a segwit transaction adds an empty witness stack
+  tx_weight_input_t mixed[] = {pkh, wpkh};
+  // Base: 4 + 1 + 148 + 41 + 1 + 31 + 4 = 230
+  if (!check("p2pkh + p2wpkh", mixed, 2, one_wpkh, 1, 4 * 230 + 2 + 1 + 108,
+             258))
+    return;
+  PASS();
+}
+
+static void test_multisig(void) {
+  TEST("2-of-3 multisig in P2WSH, P2SH-P2WSH and P2SH");
+  uint8_t ms[256];
+  size_t ms_len = make_multisig(ms, 2, 3);
+  const size_t one_wsh[] = {34};
+
+  tx_weight_input_t wsh = input(p2wsh, sizeof(p2wsh));
+  wsh.witness_script = ms;
+  wsh.witness_script_len = ms_len;
+  // Input: 41 * 4 + 254 witness = 418 weight, the usual 104.5 vB
+  if (!check("p2wsh 2-of-3", &wsh, 1, one_wsh, 1, 632, 158))
+    return;
+
+  tx_weight_input_t sh_wsh = input(p2sh, sizeof(p2sh));
+  sh_wsh.redeem_script = p2wsh;
+  sh_wsh.redeem_script_len = sizeof(p2wsh);
+  sh_wsh.witness_script = ms;
+  sh_wsh.witness_script_len = ms_len;
+  if (!check("p2sh-p2wsh 2-of-3", &sh_wsh, 1, one_wsh, 1, 632 + 35 * 4,
+             158 + 35))
+    return;
+
+  // scriptSig: OP_0, 2 sigs, OP_PUSHDATA1 105-byte script; 297-byte input
+  tx_weight_input_t sh = input(p2sh, sizeof(p2sh));
+  sh.redeem_script = ms;
+  sh.redeem_script_len = ms_len;
+  const size_t one_sh[] = {23};
+  uint32_t base = 4 + 1 + 297 + 1 + (8 + 1 + 23) + 4;
+  if (!check("p2sh 2-of-3", &sh, 1, one_sh, 1, base * 4, base))
+    return;
+
+  // 15-of-15 needs a 3-byte varint for its witness script length
+  uint8_t big[600];
+  size_t big_len = make_multisig(big, 15, 15);
+  wsh.witness_script = big;
+  wsh.witness_script_len = big_len;
+  uint32_t wit = 1 + 1 + 15 * 73 + 3 + (uint32_t)big_len;
+  if (!check("p2wsh 15-of-15", &wsh, 1, one_wsh, 1, 94 * 4 + 2 + wit,
+             (94 * 4 + 2 + wit + 3) / 4))
+    return;
+  PASS();
+}
+
+static void test_unknown_inputs(void) {
+  TEST("inputs that can't be sized");
+  uint8_t not_ms[4] = {0x52, 0x52, 0x93, 0x87}; // OP_2 OP_2 OP_ADD OP_EQUAL
+  uint8_t ms[256];
+  size_t ms_len = make_multisig(ms, 2, 3);
+  ms[1] = 65; // Uncompressed-key length byte
+  const size_t outs[] = {22};
+
+  tx_weight_input_t cases[4];
+  cases[0] = input(p2wsh, sizeof(p2wsh)); // No witness script
+  cases[1] = input(p2wsh, sizeof(p2wsh));
+  cases[1].witness_script = not_ms;
+  cases[1].witness_script_len = sizeof(not_ms);
+  cases[2] = input(p2sh, sizeof(p2sh));
+  cases[2].redeem_script = ms;
+  cases[2].redeem_script_len = ms_len;
+  uint8_t op_return[3] = {0x6a, 0x01, 0x00};
+  cases[3] = input(op_return, sizeof(op_return));
+
+  for (int i = 0; i < 4; i++) {
+    tx_weight_result_t r;
+    if (tx_weight_classify(&cases[i]) != TX_WEIGHT_UNKNOWN ||
+        tx_weight_estimate(&cases[i], 1, outs, 1, &r) || r.vsize != 0) {
+      char msg[32];
+      snprintf(msg, sizeof(msg), "case %d was sized", i);
+      FAIL(msg);
+      return;
+    }
+  }
+  PASS();
+}
+
+static void test_fee_rate(void) {
+  TEST("fee rate in tenths of sat/vB");
+  if (tx_weight_fee_rate_x10(1410, 141) != 100 ||
+      tx_weight_fee_rate_x10(1000, 141) != 70 ||
+      tx_weight_fee_rate_x10(1000, 0) != 0 ||
+      tx_weight_fee_rate_x10(UINT64_MAX, 1) != UINT64_MAX) {
+    FAIL("wrong rate");
+    return;
+  }
+  PASS();
+}
+
+/* ---------- Benchmark ---------- */
+
+static void bench_estimate(void) {
+  printf("\nEstimate, p2wpkh inputs + 2 outputs:\n");
+  static const size_t sizes[] = {1, 10, 100, 1000};
+  const size_t outs[] = {22, 34};
+  tx_weight_input_t *ins = malloc(1000 * sizeof(*ins));
+  if (!ins)
+    return;
+  for (size_t i = 0; i < 1000; i++)
+    ins[i] = input(p2wpkh, sizeof(p2wpkh));
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    const int iters = 2000000 / (int)sizes[s];
+    tx_weight_result_t r;
+    volatile uint32_t sink = 0;
+    double t0 = now_ms();
+    for (int i = 0; i < iters; i++) {
+      tx_weight_estimate(ins, sizes[s], outs, 2, &r);
+      sink += r.vsize;
+    }
+    double t1 = now_ms();
+    (void)sink;
+    printf("  %4zu inputs: %.3f us\n", sizes[s], (t1 - t0) * 1000.0 / iters);
+  }
+  free(ins);
+  printf("\n");
+}
+
+int main(void) {
+  printf("=== Transaction Weight Tests ===\n\n");
+
+  test_single_sig();
+  test_multisig();
+  test_unknown_inputs();
+  test_fee_rate();
+
+  bench_estimate();
+
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -5,6 +5,7 @@
 #include <mbedtls/gcm.h>
 #include <mbedtls/pkcs5.h>
 #include <mbedtls/sha256.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* --- Key Derivation --- */
@@ -34,6 +35,51 @@ int crypto_sha256(const uint8_t *data, size_t data_len, uint8_t *hash_out) {
   return (ret == 0) ? CRYPTO_OK : CRYPTO_ERR_INTERNAL;
 }
 
+struct crypto_sha256_stream {
+  mbedtls_sha256_context ctx;
+};
+
+crypto_sha256_stream_t *crypto_sha256_stream_new(void) {
+  crypto_sha256_stream_t *s = malloc(sizeof(*s));
+  if (!s) {
+    return NULL;
+  }
+  mbedtls_sha256_init(&s->ctx);
+  if (mbedtls_sha256_starts(&s->ctx, 0) != 0) {
+    crypto_sha256_stream_free(s);
+    return NULL;
+  }
+  return s;
+}
+
+int crypto_sha256_stream_update(crypto_sha256_stream_t *s, const uint8_t *data,
+                                size_t data_len) {
+  if (!s || (!data && data_len > 0)) {
+    return CRYPTO_ERR_INVALID_ARG;
+  }
+  int ret = mbedtls_sha256_update(&s->ctx, data, data_len);
+  return (ret == 0) ? CRYPTO_OK : CRYPTO_ERR_INTERNAL;
+}
+
+int crypto_sha256_stream_finish(crypto_sha256_stream_t *s, uint8_t *hash_out) {
+  if (!s || !hash_out) {
+    crypto_sha256_stream_free(s);
+    return CRYPTO_ERR_INVALID_ARG;
+  }
+  int ret = mbedtls_sha256_finish(&s->ctx, hash_out);
+  crypto_sha256_stream_free(s);
+  return (ret == 0) ? CRYPTO_OK : CRYPTO_ERR_INTERNAL;
+}
+
+void crypto_sha256_stream_free(crypto_sha256_stream_t *s) {
+  if (!s) {
+    return;
+  }
+  mbedtls_sha256_free(&s->ctx);
+  secure_memzero(s, sizeof(*s));
+  free(s);
+}
+
 /* --- AES-256-ECB --- */
 
 int crypto_aes_ecb_encrypt(const uint8_t key[CRYPTO_AES_KEY_SIZE],
@@ -37,6 +37,17 @@ int crypto_pbkdf2_sha256(const uint8_t *password, size_t password_len,
 /* SHA-256 hash. hash_out must be at least CRYPTO_SHA256_SIZE bytes. */
 int crypto_sha256(const uint8_t *data, size_t data_len, uint8_t *hash_out);
 
+/* Incremental SHA-256 for input that is never held in full. The context is
+ * heap-allocated; finish and free both wipe and release it. */
+typedef struct crypto_sha256_stream crypto_sha256_stream_t;
+
+crypto_sha256_stream_t *crypto_sha256_stream_new(void);
+int crypto_sha256_stream_update(crypto_sha256_stream_t *s, const uint8_t *data,
+                                size_t data_len);
+/* Writes CRYPTO_SHA256_SIZE bytes to hash_out and frees s. */
+int crypto_sha256_stream_finish(crypto_sha256_stream_t *s, uint8_t *hash_out);
+void crypto_sha256_stream_free(crypto_sha256_stream_t *s);
+
 /* --- AES-256-ECB --- */
 
 /* Encrypt/decrypt in ECB mode. input_len must be a multiple of 16. */
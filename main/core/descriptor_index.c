@@ -0,0 +1,169 @@
+// Stored descriptor lookup for PSBTs
+
+#include "descriptor_index.h"
+#include <descriptor_registry.h>
+#include <esp_log.h>
+#include <platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wally_map.h>
+
+static const char *TAG = "DESC_INDEX";
+
+static desc_registry_t *registry = NULL;
+static bool indexed_sd = false; // SD was mounted when the index was built
+
+static void index_location(storage_location_t loc) {
+  char **files = NULL;
+  int count = 0;
+  if (storage_list_descriptors(loc, &files, &count) != ESP_OK)
+    return;
+
+  for (int i = 0; i < count; i++) {
+    uint8_t *data = NULL;
+    size_t len = 0;
+    bool encrypted = false;
+    if (storage_load_descriptor(loc, files[i], &data, &len, &encrypted) !=
+        ESP_OK)
+      continue;
+    if (!encrypted)
+      desc_registry_add(registry, (const char *)data, len, files[i],
+                        (uint32_t)loc);
+    free(data);
+  }
+  storage_free_file_list(files, count);
+}
+
+static bool ensure_index(void) {
+  bool sd_mounted = platform_fs_is_mounted(PLATFORM_VOL_SD);
+  if (registry && indexed_sd == sd_mounted)
+    return true;
+
+  descriptor_index_invalidate();
+  registry = desc_registry_create();
+  if (!registry)
+    return false;
+
+  index_location(STORAGE_FLASH);
+  if (sd_mounted)
+    index_location(STORAGE_SD);
+  indexed_sd = sd_mounted;
+
+  ESP_LOGI(TAG, "Indexed %u descriptors",
+           (unsigned)desc_registry_count(registry));
+  return true;
+}
+
+// k of a multi() script: its first opcode, OP_1..OP_16
+static uint32_t script_threshold(const struct wally_map_item *script) {
+  if (!script || script->value_len == 0)
+    return 0;
+  uint8_t op = script->value[0];
+  return (op >= 0x51 && op <= 0x60) ? (uint32_t)(op - 0x50) : 0;
+}
+
+// Cosigner origins of one input: each keypath without its change/index
+static bool build_query(const struct wally_psbt_input *in,
+                        desc_reg_query_t *query) {
+  const struct wally_map_item *witness_script = wally_map_get_integer(
+      &in->psbt_fields, WALLY_PSBT_IN_WITNESS_SCRIPT);
+  const struct wally_map_item *redeem_script =
+      wally_map_get_integer(&in->psbt_fields, WALLY_PSBT_IN_REDEEM_SCRIPT);
+
+  memset(query, 0, sizeof(*query));
+  if (witness_script) {
+    query->script =
+        redeem_script ? DESC_REG_SCRIPT_SH_WSH : DESC_REG_SCRIPT_WSH;
+    query->threshold = script_threshold(witness_script);
+  } else if (redeem_script) {
+    query->script = DESC_REG_SCRIPT_SH;
+    query->threshold = script_threshold(redeem_script);
+  } else {
+    return false;
+  }
+
+  const struct wally_map *keypaths = &in->keypaths;
+  if (keypaths->num_items < 2 || keypaths->num_items > DESC_SCAN_MAX_KEYS)
+    return false;
+
+  for (size_t i = 0; i < keypaths->num_items; i++) {
+    const struct wally_map_item *item = &keypaths->items[i];
+    if (item->value_len < 4 + 2 * 4 || (item->value_len - 4) % 4 != 0)
+      return false;
+    size_t depth = (item->value_len - 4) / 4 - 2;
+    if (depth > DESC_SCAN_MAX_PATH)
+      return false;
+
+    desc_reg_origin_t *origin = &query->keys[i];
+    memcpy(origin->fingerprint, item->value, 4);
+    for (size_t j = 0; j < depth; j++) {
+      const unsigned char *p = item->value + 4 + j * 4;
+      origin->path[j] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                        ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    origin->depth = depth;
+  }
+  query->num_keys = keypaths->num_items;
+  return true;
+}
+
+descriptor_index_result_t
+descriptor_index_match_psbt(const struct wally_psbt *psbt,
+                            storage_location_t *loc_out, char *filename_out,
+                            size_t filename_size) {
+  if (!psbt || !loc_out || !filename_out || filename_size == 0)
+    return DESCRIPTOR_INDEX_NONE;
+  if (!ensure_index() || desc_registry_count(registry) == 0)
+    return DESCRIPTOR_INDEX_NONE;
+
+  desc_reg_query_t *query = malloc(sizeof(*query));
+  if (!query)
+    return DESCRIPTOR_INDEX_NONE;
+
+  const char *match_id = NULL;
+  uint32_t match_tag = 0;
+  size_t matched = 0, unmatched = 0;
+  descriptor_index_result_t result = DESCRIPTOR_INDEX_NONE;
+
+  for (size_t i = 0; i < psbt->num_inputs; i++) {
+    if (!build_query(&psbt->inputs[i], query))
+      continue;
+
+    const char *id = NULL;
+    uint32_t tag = 0;
+    desc_reg_match_t m = desc_registry_match(registry, query, &id, &tag);
+    if (m == DESC_REG_MATCH_AMBIGUOUS) {
+      result = DESCRIPTOR_INDEX_AMBIGUOUS;
+      break;
+    }
+    if (m == DESC_REG_MATCH_NONE) {
+      unmatched++;
+      continue;
+    }
+    if (matched > 0 && (tag != match_tag || strcmp(id, match_id) != 0)) {
+      result = DESCRIPTOR_INDEX_MISMATCH;
+      break;
+    }
+    match_id = id;
+    match_tag = tag;
+    matched++;
+  }
+  free(query);
+
+  if (result != DESCRIPTOR_INDEX_NONE)
+    return result;
+  if (matched == 0)
+    return DESCRIPTOR_INDEX_NONE;
+  if (unmatched > 0)
+    return DESCRIPTOR_INDEX_MISMATCH;
+
+  *loc_out = (storage_location_t)match_tag;
+  snprintf(filename_out, filename_size, "%s", match_id);
+  return DESCRIPTOR_INDEX_FOUND;
+}
+
+void descriptor_index_invalidate(void) {
+  desc_registry_destroy(registry);
+  registry = NULL;
+}
@@ -0,0 +1,35 @@
+// Stored descriptor lookup for PSBTs
+//
+// Indexes the plaintext multisig descriptors on flash (and SD, when mounted)
+// by their key origins, so a multisig PSBT finds its wallet descriptor
+// without the user browsing storage. Encrypted descriptors need their
+// passphrase and are not indexed.
+
+#ifndef DESCRIPTOR_INDEX_H
+#define DESCRIPTOR_INDEX_H
+
+#include "storage.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <wally_psbt.h>
+
+typedef enum {
+  DESCRIPTOR_INDEX_NONE = 0,  // No stored descriptor has the PSBT's keys
+  DESCRIPTOR_INDEX_FOUND,     // Exactly one descriptor covers every input
+  DESCRIPTOR_INDEX_AMBIGUOUS, // Several descriptors share the PSBT's keys
+  DESCRIPTOR_INDEX_MISMATCH,  // Inputs belong to different (or no) wallets
+} descriptor_index_result_t;
+
+/* Find the stored descriptor every multisig input of the PSBT belongs to.
+ * On FOUND, loc_out and filename_out name the file for
+ * storage_load_descriptor(). The index is built on first use. */
+descriptor_index_result_t
+descriptor_index_match_psbt(const struct wally_psbt *psbt,
+                            storage_location_t *loc_out, char *filename_out,
+                            size_t filename_size);
+
+/* Drop the index; the next match re-reads storage. Called whenever stored
+ * descriptors change. */
+void descriptor_index_invalidate(void);
+
+#endif // DESCRIPTOR_INDEX_H
@@ -1,7 +1,10 @@
 #include "descriptor_validator.h"
 #include "key.h"
 #include "wallet.h"
+#include "../utils/secure_mem.h"
+#include <descriptor_scan.h>
 #include <esp_log.h>
+#include <job_executor.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,15 +28,120 @@ typedef struct {
   bool needs_policy_change;
   bool needs_account_change;
   descriptor_info_t info;
+  desc_scan_t scan;                    // Keys, origins and threshold
+  struct wally_descriptor *descriptor; // Parsed on the job executor
+  uint32_t descriptor_network;         // WALLY_NETWORK_* it parsed with
+  int key_index;                       // Our key in scan.keys
 } validation_context_t;
 
 static validation_context_t *current_ctx = NULL;
 
+// ---------------------------------------------------------------------------
+// Background parsing: wally_descriptor_parse has deep call chains and takes
+// noticeable time for large multisig descriptors, so it runs on the job
+// executor, once per validation. Everything the validator compares or shows
+// comes from the single-pass desc_scan() result instead of re-reading keys
+// back out of the parsed descriptor. The next validation stage is resumed on
+// the LVGL task.
+// ---------------------------------------------------------------------------
+
+typedef void (*parse_next_fn)(struct wally_descriptor *descriptor,
+                              uint32_t network);
+
+typedef struct {
+  char *descriptor_str;
+  uint32_t network;
+  bool try_other_network;
+  struct wally_descriptor *descriptor;
+} parse_scratch_t;
+
+static uint32_t wally_network(wallet_network_t network) {
+  return (network == WALLET_NETWORK_MAINNET) ? WALLY_NETWORK_BITCOIN_MAINNET
+                                             : WALLY_NETWORK_BITCOIN_TESTNET;
+}
+
+static job_t *parse_job = NULL;
+static parse_next_fn parse_next = NULL;
+
+static int parse_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)ctx;
+  parse_scratch_t *p = scratch;
+
+  int ret = wally_descriptor_parse(p->descriptor_str, NULL, p->network, 0,
+                                   &p->descriptor);
+
+  // If parsing fails with current network, try the other network
+  if (ret != WALLY_OK && p->try_other_network) {
+    p->network = (p->network == WALLY_NETWORK_BITCOIN_MAINNET)
+                     ? WALLY_NETWORK_BITCOIN_TESTNET
+                     : WALLY_NETWORK_BITCOIN_MAINNET;
+    ret = wally_descriptor_parse(p->descriptor_str, NULL, p->network, 0,
+                                 &p->descriptor);
+  }
+  return ret;
+}
+
+static void parse_cleanup(void *scratch) {
+  parse_scratch_t *p = scratch;
+  free(p->descriptor_str);
+  if (p->descriptor)
+    wally_descriptor_free(p->descriptor);
+}
+
+static void parse_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  parse_scratch_t *p = scratch;
+  parse_job = NULL;
+
+  if (result != WALLY_OK) {
+    ESP_LOGE(TAG, "Failed to parse descriptor: %d", result);
+  }
+
+  // Ownership of the parsed descriptor moves to the next stage
+  struct wally_descriptor *descriptor = p->descriptor;
+  p->descriptor = NULL;
+  parse_next_fn next = parse_next;
+  parse_next = NULL;
+  next(result == WALLY_OK ? descriptor : NULL, p->network);
+}
+
+static bool parse_descriptor_async(bool try_other_network, parse_next_fn next) {
+  parse_scratch_t init = {0};
+  init.network = wally_network(wallet_get_network());
+  init.try_other_network = try_other_network;
+  init.descriptor_str = strdup(current_ctx->descriptor_str);
+  if (!init.descriptor_str)
+    return false;
+
+  job_desc_t desc = {.run = parse_run,
+                     .done = parse_done,
+                     .cleanup = parse_cleanup,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  parse_next = next;
+  parse_job = job_submit(&desc);
+  if (!parse_job) {
+    parse_next = NULL;
+    free(init.descriptor_str);
+    return false;
+  }
+  return true;
+}
+
 static void cleanup_context(void) {
+  if (parse_job) {
+    job_cancel(parse_job);
+    parse_job = NULL;
+    parse_next = NULL;
+  }
   if (current_ctx) {
     if (current_ctx->descriptor_str) {
       free(current_ctx->descriptor_str);
     }
+    if (current_ctx->descriptor) {
+      wally_descriptor_free(current_ctx->descriptor);
+    }
     free(current_ctx);
     current_ctx = NULL;
   }
@@ -52,24 +160,16 @@ static void complete_validation(descriptor_validation_result_t result) {
 
 // Find key index in descriptor that matches our fingerprint
 // Returns -1 if not found
-static int find_matching_key_index(struct wally_descriptor *descriptor) {
+static int find_matching_key_index(const desc_scan_t *scan) {
   unsigned char wallet_fp[BIP32_KEY_FINGERPRINT_LEN];
   if (!key_get_fingerprint(wallet_fp)) {
     return -1;
   }
 
-  uint32_t num_keys = 0;
-  if (wally_descriptor_get_num_keys(descriptor, &num_keys) != WALLY_OK) {
-    return -1;
-  }
-
-  for (uint32_t i = 0; i < num_keys; i++) {
-    unsigned char key_fp[BIP32_KEY_FINGERPRINT_LEN];
-    int ret = wally_descriptor_get_key_origin_fingerprint(
-        descriptor, i, key_fp, BIP32_KEY_FINGERPRINT_LEN);
-
-    if (ret == WALLY_OK &&
-        memcmp(wallet_fp, key_fp, BIP32_KEY_FINGERPRINT_LEN) == 0) {
+  for (size_t i = 0; i < scan->num_keys; i++) {
+    if (scan->keys[i].has_origin &&
+        memcmp(wallet_fp, scan->keys[i].fingerprint,
+               BIP32_KEY_FINGERPRINT_LEN) == 0) {
       return (int)i;
     }
   }
@@ -77,55 +177,20 @@ static int find_matching_key_index(struct wally_descriptor *descriptor) {
   return -1;
 }
 
-// Parse origin path like "48'/0'/0'/2'" into network, policy, account
-static bool parse_origin_path(const char *path, wallet_network_t *network_out,
+// Map an origin path like 48'/0'/0'/2' to network, policy, account
+static bool parse_origin_path(const desc_scan_key_t *key,
+                              wallet_network_t *network_out,
                               wallet_policy_t *policy_out,
                               uint32_t *account_out) {
-  if (!path || !network_out || !policy_out || !account_out) {
-    return false;
-  }
-
-  // Path format: "purpose'/coin'/account'[/script']"
   // BIP84 (singlesig): 84'/coin'/account'
   // BIP48 (multisig): 48'/coin'/account'/script'
-  uint32_t purpose = 0, coin = 0, account = 0;
-  const char *p = path;
-  const char *start;
-
-  // Parse purpose
-  start = p;
-  while (*p >= '0' && *p <= '9') {
-    purpose = purpose * 10 + (*p - '0');
-    p++;
-  }
-  if (p == start)
-    return false;
-  if (*p == '\'' || *p == 'h')
-    p++;
-  if (*p == '/')
-    p++;
-
-  // Parse coin type
-  start = p;
-  while (*p >= '0' && *p <= '9') {
-    coin = coin * 10 + (*p - '0');
-    p++;
-  }
-  if (p == start)
-    return false;
-  if (*p == '\'' || *p == 'h')
-    p++;
-  if (*p == '/')
-    p++;
-
-  // Parse account
-  start = p;
-  while (*p >= '0' && *p <= '9') {
-    account = account * 10 + (*p - '0');
-    p++;
-  }
-  if (p == start)
+  if (!key->has_origin || key->path_depth < 3) {
     return false;
+  }
+
+  uint32_t purpose = key->path[0] & ~DESC_SCAN_HARDENED;
+  uint32_t coin = key->path[1] & ~DESC_SCAN_HARDENED;
+  uint32_t account = key->path[2] & ~DESC_SCAN_HARDENED;
 
   // Determine network from coin type
   *network_out = (coin == 0) ? WALLET_NETWORK_MAINNET : WALLET_NETWORK_TESTNET;
@@ -142,121 +207,45 @@ static bool parse_origin_path(const char *path, wallet_network_t *network_out,
   return true;
 }
 
-// Extract xpub from key string
-// Key format: "[fingerprint/path]xpub..." or just "xpub..."
-static char *extract_xpub_from_key(const char *key_str) {
-  if (!key_str) {
-    return NULL;
-  }
-
-  // Find start of xpub (skip origin info if present)
-  const char *xpub_start = key_str;
-  if (key_str[0] == '[') {
-    const char *close = strchr(key_str, ']');
-    if (close) {
-      xpub_start = close + 1;
-    }
-  }
-
-  // Find xpub prefix (xpub or tpub)
-  const char *prefix = strstr(xpub_start, "pub");
-  if (!prefix || prefix == xpub_start) {
-    return NULL;
-  }
-  prefix--; // Back up to 'x' or 't'
-
-  // Find end of xpub (stop at / or end of string)
-  const char *end = prefix;
-  while (*end && *end != '/' && *end != ')' && *end != ',' && *end != '<') {
-    end++;
-  }
-
-  size_t len = end - prefix;
-  char *xpub = malloc(len + 1);
-  if (!xpub) {
-    return NULL;
-  }
-
-  memcpy(xpub, prefix, len);
-  xpub[len] = '\0';
-
-  return xpub;
-}
-
-// Parse multisig threshold from descriptor string (e.g., "multi(2,..." -> 2)
-static uint32_t parse_multisig_threshold(const char *descriptor_str) {
-  const char *multi = strstr(descriptor_str, "multi(");
-  if (!multi) {
-    return 0;
-  }
-  const char *num_start = multi + 6; // skip "multi("
-  char *end = NULL;
-  long val = strtol(num_start, &end, 10);
-  if (end == num_start || val <= 0) {
-    return 0;
-  }
-  return (uint32_t)val;
-}
-
-// Extract descriptor info (policy type, keys) from parsed descriptor
-static bool extract_descriptor_info(struct wally_descriptor *descriptor,
-                                    const char *descriptor_str,
+// Fill descriptor info (policy type, keys) from the scan
+static void extract_descriptor_info(const char *descriptor_str,
+                                    const desc_scan_t *scan,
                                     descriptor_info_t *info) {
   memset(info, 0, sizeof(descriptor_info_t));
 
-  uint32_t num_keys = 0;
-  if (wally_descriptor_get_num_keys(descriptor, &num_keys) != WALLY_OK) {
-    return false;
-  }
-
-  info->is_multisig = (num_keys > 1);
-  info->num_keys = (num_keys > DESCRIPTOR_INFO_MAX_KEYS)
+  info->is_multisig = (scan->num_keys > 1);
+  info->num_keys = (scan->num_keys > DESCRIPTOR_INFO_MAX_KEYS)
                        ? DESCRIPTOR_INFO_MAX_KEYS
-                       : num_keys;
+                       : (uint32_t)scan->num_keys;
 
   if (info->is_multisig) {
-    info->threshold = parse_multisig_threshold(descriptor_str);
+    info->threshold = scan->threshold;
   }
 
   for (uint32_t i = 0; i < info->num_keys; i++) {
-    // Fingerprint
-    unsigned char fp[BIP32_KEY_FINGERPRINT_LEN];
-    if (wally_descriptor_get_key_origin_fingerprint(
-            descriptor, i, fp, BIP32_KEY_FINGERPRINT_LEN) == WALLY_OK) {
+    const desc_scan_key_t *key = &scan->keys[i];
+
+    if (key->has_origin) {
+      const uint8_t *fp = key->fingerprint;
       snprintf(info->keys[i].fingerprint_hex,
                sizeof(info->keys[i].fingerprint_hex), "%02X%02X%02X%02X", fp[0],
                fp[1], fp[2], fp[3]);
+      snprintf(info->keys[i].derivation, sizeof(info->keys[i].derivation),
+               "m/%.*s", (int)key->path_len, descriptor_str + key->path_offset);
     } else {
       strncpy(info->keys[i].fingerprint_hex, "N/A",
               sizeof(info->keys[i].fingerprint_hex));
-    }
-
-    // Xpub
-    char *key_str = NULL;
-    if (wally_descriptor_get_key(descriptor, i, &key_str) == WALLY_OK) {
-      char *xpub = extract_xpub_from_key(key_str);
-      if (xpub) {
-        strncpy(info->keys[i].xpub, xpub, sizeof(info->keys[i].xpub) - 1);
-        info->keys[i].xpub[sizeof(info->keys[i].xpub) - 1] = '\0';
-        free(xpub);
-      }
-      wally_free_string(key_str);
-    }
-
-    // Derivation path
-    char *path_str = NULL;
-    if (wally_descriptor_get_key_origin_path_str(descriptor, i, &path_str) ==
-        WALLY_OK) {
-      snprintf(info->keys[i].derivation, sizeof(info->keys[i].derivation),
-               "m/%s", path_str);
-      wally_free_string(path_str);
-    } else {
       strncpy(info->keys[i].derivation, "N/A",
               sizeof(info->keys[i].derivation));
     }
-  }
 
-  return true;
+    size_t xpub_len = key->xpub_len;
+    if (xpub_len > sizeof(info->keys[i].xpub) - 1) {
+      xpub_len = sizeof(info->keys[i].xpub) - 1;
+    }
+    memcpy(info->keys[i].xpub, descriptor_str + key->xpub_offset, xpub_len);
+    info->keys[i].xpub[xpub_len] = '\0';
+  }
 }
 
 // Callback after user confirms/declines descriptor info
@@ -268,75 +257,36 @@ static void info_confirm_proceed(bool confirmed, void *user_data) {
     return;
   }
 
-  if (!wallet_load_descriptor(current_ctx->descriptor_str)) {
-    ESP_LOGE(TAG, "Failed to load descriptor");
-    complete_validation(VALIDATION_INTERNAL_ERROR);
-    return;
-  }
+  // Hand the descriptor parsed on the worker to the wallet
+  wallet_adopt_descriptor(current_ctx->descriptor);
+  current_ctx->descriptor = NULL;
 
   complete_validation(VALIDATION_SUCCESS);
 }
 
-// Re-parse descriptor, verify xpub matches wallet, extract info, and show it.
-static void verify_xpub_and_show_info(void) {
-  uint32_t wally_network = (wallet_get_network() == WALLET_NETWORK_MAINNET)
-                               ? WALLY_NETWORK_BITCOIN_MAINNET
-                               : WALLY_NETWORK_BITCOIN_TESTNET;
-
-  struct wally_descriptor *descriptor = NULL;
-  if (wally_descriptor_parse(current_ctx->descriptor_str, NULL, wally_network,
-                             0, &descriptor) != WALLY_OK) {
-    ESP_LOGE(TAG, "Failed to parse descriptor for xpub verification");
-    complete_validation(VALIDATION_PARSE_ERROR);
-    return;
-  }
-
-  int key_index = find_matching_key_index(descriptor);
-  if (key_index < 0) {
-    wally_descriptor_free(descriptor);
-    complete_validation(VALIDATION_FINGERPRINT_NOT_FOUND);
-    return;
-  }
-
-  char *key_str = NULL;
-  if (wally_descriptor_get_key(descriptor, key_index, &key_str) != WALLY_OK) {
-    wally_descriptor_free(descriptor);
-    complete_validation(VALIDATION_INTERNAL_ERROR);
-    return;
-  }
-
-  char *descriptor_xpub = extract_xpub_from_key(key_str);
-  wally_free_string(key_str);
-
-  if (!descriptor_xpub) {
-    wally_descriptor_free(descriptor);
-    complete_validation(VALIDATION_PARSE_ERROR);
-    return;
-  }
+// Verify xpub matches wallet, extract info, and show it.
+static void show_verified_info(void) {
+  const desc_scan_key_t *key = &current_ctx->scan.keys[current_ctx->key_index];
+  const char *descriptor_xpub = current_ctx->descriptor_str + key->xpub_offset;
 
   char *wallet_xpub = NULL;
   if (!wallet_get_account_xpub(&wallet_xpub)) {
-    free(descriptor_xpub);
-    wally_descriptor_free(descriptor);
     complete_validation(VALIDATION_INTERNAL_ERROR);
     return;
   }
 
-  bool xpub_match = (strcmp(descriptor_xpub, wallet_xpub) == 0);
-  free(descriptor_xpub);
+  bool xpub_match = (strlen(wallet_xpub) == key->xpub_len &&
+                     memcmp(descriptor_xpub, wallet_xpub, key->xpub_len) == 0);
   wally_free_string(wallet_xpub);
 
   if (!xpub_match) {
     ESP_LOGE(TAG, "XPub mismatch");
-    wally_descriptor_free(descriptor);
     complete_validation(VALIDATION_XPUB_MISMATCH);
     return;
   }
 
-  // Extract descriptor info before freeing
-  extract_descriptor_info(descriptor, current_ctx->descriptor_str,
+  extract_descriptor_info(current_ctx->descriptor_str, &current_ctx->scan,
                           &current_ctx->info);
-  wally_descriptor_free(descriptor);
 
   // Show info confirmation if callback is set, otherwise auto-confirm
   if (current_ctx->info_confirm_cb) {
@@ -346,16 +296,50 @@ static void verify_xpub_and_show_info(void) {
   }
 }
 
+static void reparsed_verify(struct wally_descriptor *descriptor,
+                            uint32_t network) {
+  if (!descriptor) {
+    ESP_LOGE(TAG, "Failed to parse descriptor for xpub verification");
+    complete_validation(VALIDATION_PARSE_ERROR);
+    return;
+  }
+  current_ctx->descriptor = descriptor;
+  current_ctx->descriptor_network = network;
+  show_verified_info();
+}
+
+// The descriptor from stage 1 is reused when it parsed against the (possibly
+// changed) wallet network; otherwise it is re-parsed for that network.
+static void verify_xpub_and_show_info(void) {
+  uint32_t network = wally_network(wallet_get_network());
+  if (current_ctx->descriptor &&
+      current_ctx->descriptor_network == network) {
+    show_verified_info();
+    return;
+  }
+
+  if (current_ctx->descriptor) {
+    wally_descriptor_free(current_ctx->descriptor);
+    current_ctx->descriptor = NULL;
+  }
+  if (!parse_descriptor_async(false, reparsed_verify))
+    complete_validation(VALIDATION_INTERNAL_ERROR);
+}
+
 // Apply settings changes and verify xpub
 static void apply_changes_and_verify(void) {
   if (!current_ctx) {
     return;
   }
 
-  // Get current mnemonic for reinit
+  // Get current mnemonic (or SLIP-39 master secret) for reinit
   char *mnemonic = NULL;
-  if (!key_get_mnemonic(&mnemonic)) {
-    ESP_LOGE(TAG, "Failed to get mnemonic");
+  unsigned char secret[KEY_MAX_MASTER_SECRET];
+  size_t secret_len = 0;
+  bool has_mnemonic = key_has_mnemonic();
+  if (has_mnemonic ? !key_get_mnemonic(&mnemonic)
+                   : !key_get_master_secret(secret, &secret_len)) {
+    ESP_LOGE(TAG, "Failed to get key material");
     complete_validation(VALIDATION_INTERNAL_ERROR);
     return;
   }
@@ -368,13 +352,17 @@ static void apply_changes_and_verify(void) {
   wallet_set_policy(current_ctx->target_policy);
 
   // Reload key - passphrase is already applied in current key
-  if (!key_load_from_mnemonic(mnemonic, NULL, is_testnet)) {
+  bool reloaded =
+      has_mnemonic
+          ? key_load_from_mnemonic(mnemonic, NULL, is_testnet)
+          : key_load_from_master_secret(secret, secret_len, is_testnet);
+  SECURE_FREE_STRING(mnemonic);
+  secure_memzero(secret, sizeof(secret));
+  if (!reloaded) {
     ESP_LOGE(TAG, "Failed to reload key");
-    free(mnemonic);
     complete_validation(VALIDATION_INTERNAL_ERROR);
     return;
   }
-  free(mnemonic);
 
   if (!wallet_init(current_ctx->target_network)) {
     ESP_LOGE(TAG, "Failed to reinit wallet");
@@ -398,30 +386,20 @@ static void attribute_change_confirm_cb(bool confirmed, void *user_data) {
 }
 
 // Stage 2 & 3: Check attributes and verify xpub
-static void check_attributes_and_verify(struct wally_descriptor *descriptor,
-                                        int key_index) {
-  // Get origin path for our key
-  char *origin_path = NULL;
-  if (wally_descriptor_get_key_origin_path_str(descriptor, key_index,
-                                               &origin_path) != WALLY_OK) {
-    ESP_LOGE(TAG, "Failed to get key origin path");
-    complete_validation(VALIDATION_PARSE_ERROR);
-    return;
-  }
+static void check_attributes_and_verify(void) {
+  const desc_scan_key_t *key = &current_ctx->scan.keys[current_ctx->key_index];
 
-  // Parse the origin path to extract attributes
+  // Extract attributes from our key's origin path
   wallet_network_t desc_network;
   wallet_policy_t desc_policy;
   uint32_t desc_account;
 
-  if (!parse_origin_path(origin_path, &desc_network, &desc_policy,
-                         &desc_account)) {
-    ESP_LOGE(TAG, "Failed to parse origin path: %s", origin_path);
-    wally_free_string(origin_path);
+  if (!parse_origin_path(key, &desc_network, &desc_policy, &desc_account)) {
+    ESP_LOGE(TAG, "Failed to parse origin path: %.*s", (int)key->path_len,
+             current_ctx->descriptor_str + key->path_offset);
     complete_validation(VALIDATION_PARSE_ERROR);
     return;
   }
-  wally_free_string(origin_path);
 
   // Get current wallet attributes
   wallet_network_t wallet_network = wallet_get_network();
@@ -491,6 +469,27 @@ static void check_attributes_and_verify(struct wally_descriptor *descriptor,
   }
 }
 
+// Stage 1: Find our key by fingerprint, then check attributes and verify xpub
+static void check_parsed_descriptor(struct wally_descriptor *descriptor,
+                                    uint32_t network) {
+  if (!descriptor) {
+    complete_validation(VALIDATION_PARSE_ERROR);
+    return;
+  }
+  current_ctx->descriptor = descriptor;
+  current_ctx->descriptor_network = network;
+
+  current_ctx->key_index = find_matching_key_index(&current_ctx->scan);
+  if (current_ctx->key_index < 0) {
+    ESP_LOGE(TAG, "Wallet fingerprint not found in descriptor");
+    complete_validation(VALIDATION_FINGERPRINT_NOT_FOUND);
+    return;
+  }
+
+  // Stage 2 & 3: Check attributes and verify xpub
+  check_attributes_and_verify();
+}
+
 void descriptor_validate_and_load(const char *descriptor_str,
                                   validation_complete_cb callback,
                                   validation_confirm_cb confirm_cb,
@@ -531,40 +530,19 @@ void descriptor_validate_and_load(const char *descriptor_str,
   current_ctx->info_confirm_cb = info_confirm_cb;
   current_ctx->user_data = user_data;
 
-  // Parse descriptor
-  uint32_t wally_network = (wallet_get_network() == WALLET_NETWORK_MAINNET)
-                               ? WALLY_NETWORK_BITCOIN_MAINNET
-                               : WALLY_NETWORK_BITCOIN_TESTNET;
-
-  struct wally_descriptor *descriptor = NULL;
-  int ret = wally_descriptor_parse(descriptor_str, NULL, wally_network, 0,
-                                   &descriptor);
-
-  // If parsing fails with current network, try the other network
-  if (ret != WALLY_OK) {
-    wally_network = (wally_network == WALLY_NETWORK_BITCOIN_MAINNET)
-                        ? WALLY_NETWORK_BITCOIN_TESTNET
-                        : WALLY_NETWORK_BITCOIN_MAINNET;
-    ret = wally_descriptor_parse(descriptor_str, NULL, wally_network, 0,
-                                 &descriptor);
-  }
-
-  if (ret != WALLY_OK) {
-    ESP_LOGE(TAG, "Failed to parse descriptor: %d", ret);
+  // Single pass over the string: checksum, keys, origins, threshold
+  desc_scan_error_t scan_err =
+      desc_scan(current_ctx->descriptor_str,
+                strlen(current_ctx->descriptor_str), &current_ctx->scan);
+  if (scan_err != DESC_SCAN_OK) {
+    ESP_LOGE(TAG, "Descriptor scan failed: %s",
+             desc_scan_error_str(scan_err));
     complete_validation(VALIDATION_PARSE_ERROR);
     return;
   }
 
-  // Stage 1: Find our key by fingerprint
-  int key_index = find_matching_key_index(descriptor);
-  if (key_index < 0) {
-    ESP_LOGE(TAG, "Wallet fingerprint not found in descriptor");
-    wally_descriptor_free(descriptor);
-    complete_validation(VALIDATION_FINGERPRINT_NOT_FOUND);
-    return;
+  // Parse descriptor in the background; stage 1 resumes on the LVGL task
+  if (!parse_descriptor_async(true, check_parsed_descriptor)) {
+    complete_validation(VALIDATION_INTERNAL_ERROR);
   }
-
-  // Stage 2 & 3: Check attributes and verify xpub
-  check_attributes_and_verify(descriptor, key_index);
-  wally_descriptor_free(descriptor);
 }
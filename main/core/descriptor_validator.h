@@ -46,7 +46,8 @@ typedef void (*validation_info_confirm_cb)(const descriptor_info_t *info,
 // If settings mismatch, uses confirm_cb to prompt (NULL = auto-decline).
 // After xpub match, uses info_confirm_cb to show descriptor info
 // (NULL = auto-confirm).
-// Calls callback with result (may be async if user confirmation needed).
+// Calls callback with result. Usually async: parsing runs on the job
+// executor and user confirmation may be needed.
 void descriptor_validate_and_load(const char *descriptor_str,
                                   validation_complete_cb callback,
                                   validation_confirm_cb confirm_cb,
@@ -10,10 +10,12 @@
 #include "kef.h"
 #include "../utils/secure_mem.h"
 #include "crypto_utils.h"
+#include <key_cache.h>
 
 /* Raw deflate compress / decompress (wbits = 10) */
 #include "../../components/bbqr/src/miniz.h"
 
+#include <freertos/FreeRTOS.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -66,6 +68,101 @@ static const kef_version_info_t *find_version(uint8_t ver) {
   return NULL;
 }
 
+/* ------------------------------------------------------------------ */
+/*  Session derived-key cache                                          */
+/* ------------------------------------------------------------------ */
+
+/*
+ * The LRU itself lives in key_cache; this wrapper supplies the random
+ * session nonces and the lock.  The table is a static (internal RAM, never
+ * PSRAM) and only derivations that authenticated successfully are stored.
+ */
+
+static key_cache_t cache;
+/* Lookups happen on job-executor workers; only short copies run locked */
+static portMUX_TYPE cache_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void kef_cache_enable(void) {
+  uint8_t nonce[KEY_CACHE_NONCE_SIZE];
+  crypto_random_bytes(nonce, sizeof(nonce));
+  taskENTER_CRITICAL(&cache_lock);
+  key_cache_enable(&cache, nonce);
+  taskEXIT_CRITICAL(&cache_lock);
+  secure_memzero(nonce, sizeof(nonce));
+}
+
+void kef_cache_disable(void) {
+  taskENTER_CRITICAL(&cache_lock);
+  key_cache_disable(&cache);
+  taskEXIT_CRITICAL(&cache_lock);
+}
+
+void kef_cache_clear(void) {
+  uint8_t nonce[KEY_CACHE_NONCE_SIZE];
+  crypto_random_bytes(nonce, sizeof(nonce));
+  taskENTER_CRITICAL(&cache_lock);
+  key_cache_clear(&cache, nonce);
+  taskEXIT_CRITICAL(&cache_lock);
+  secure_memzero(nonce, sizeof(nonce));
+}
+
+bool kef_cache_is_enabled(void) { return cache.enabled; }
+
+/* Hash outside the lock on a copy of the nonce; false while disabled */
+static bool cache_make_tag(const uint8_t *password, size_t pw_len,
+                           const uint8_t *id, size_t id_len,
+                           key_cache_tag_t *tag) {
+  uint8_t nonce[KEY_CACHE_NONCE_SIZE];
+  taskENTER_CRITICAL(&cache_lock);
+  bool enabled = cache.enabled;
+  memcpy(nonce, cache.nonce, sizeof(nonce));
+  taskEXIT_CRITICAL(&cache_lock);
+  if (enabled)
+    key_cache_make_tag(nonce, password, pw_len, id, id_len, tag);
+  secure_memzero(nonce, sizeof(nonce));
+  return enabled;
+}
+
+static bool cache_lookup(const key_cache_tag_t *tag, uint32_t iterations,
+                         uint8_t key_out[CRYPTO_AES_KEY_SIZE]) {
+  taskENTER_CRITICAL(&cache_lock);
+  bool hit = key_cache_lookup(&cache, tag, iterations, key_out);
+  taskEXIT_CRITICAL(&cache_lock);
+  return hit;
+}
+
+static void cache_store(const key_cache_tag_t *tag, uint32_t iterations,
+                        const uint8_t key[CRYPTO_AES_KEY_SIZE]) {
+  taskENTER_CRITICAL(&cache_lock);
+  key_cache_store(&cache, tag, iterations, key);
+  taskEXIT_CRITICAL(&cache_lock);
+}
+
+/*
+ * Derive the AES key, consulting the session cache first.
+ * *cacheable is set when the caller should cache_store() on success;
+ * tag is then filled in for it.
+ */
+static kef_error_t derive_key(const uint8_t *password, size_t pw_len,
+                              const uint8_t *id, size_t id_len,
+                              uint32_t iterations,
+                              uint8_t key[CRYPTO_AES_KEY_SIZE],
+                              key_cache_tag_t *tag, bool *cacheable) {
+  *cacheable = false;
+  if (cache_make_tag(password, pw_len, id, id_len, tag)) {
+    if (cache_lookup(tag, iterations, key))
+      return KEF_OK;
+    *cacheable = true;
+  }
+
+  if (crypto_pbkdf2_sha256(password, pw_len, id, id_len, iterations, key,
+                           CRYPTO_AES_KEY_SIZE) != CRYPTO_OK) {
+    *cacheable = false;
+    return KEF_ERR_CRYPTO;
+  }
+  return KEF_OK;
+}
+
 /* ------------------------------------------------------------------ */
 /*  Iteration encoding                                                 */
 /* ------------------------------------------------------------------ */
@@ -372,6 +469,8 @@ kef_error_t kef_encrypt(const uint8_t *id, size_t id_len, uint8_t version,
   uint8_t *padded = NULL; /* after padding, ready for cipher */
   size_t padded_len = 0;
   uint8_t *envelope = NULL;
+  key_cache_tag_t cache_tag;
+  bool cacheable = false;
   int rc;
 
   /* --- Validate -------------------------------------------------- */
@@ -385,12 +484,10 @@ kef_error_t kef_encrypt(const uint8_t *id, size_t id_len, uint8_t version,
     return KEF_ERR_UNSUPPORTED_VERSION;
 
   /* --- Derive key ------------------------------------------------ */
-  rc = crypto_pbkdf2_sha256(password, pw_len, id, id_len, iterations, key,
-                            CRYPTO_AES_KEY_SIZE);
-  if (rc != CRYPTO_OK) {
-    err = KEF_ERR_CRYPTO;
+  err = derive_key(password, pw_len, id, id_len, iterations, key, &cache_tag,
+                   &cacheable);
+  if (err != KEF_OK)
     goto cleanup;
-  }
 
   /* --- Generate IV ----------------------------------------------- */
   memset(iv, 0, sizeof(iv));
@@ -515,9 +612,12 @@ kef_error_t kef_encrypt(const uint8_t *id, size_t id_len, uint8_t version,
   *out_len = env_size;
   envelope = NULL; /* prevent cleanup from freeing */
   err = KEF_OK;
+  if (cacheable)
+    cache_store(&cache_tag, iterations, key);
 
 cleanup:
   secure_memzero(key, sizeof(key));
+  secure_memzero(&cache_tag, sizeof(cache_tag));
   secure_memzero(iv, sizeof(iv));
   secure_memzero(auth_buf, sizeof(auth_buf));
   if (compressed) {
@@ -545,6 +645,8 @@ kef_error_t kef_decrypt(const uint8_t *envelope, size_t env_len,
                         size_t *out_len) {
   kef_error_t err = KEF_ERR_CRYPTO;
   uint8_t key[CRYPTO_AES_KEY_SIZE];
+  key_cache_tag_t cache_tag;
+  bool cacheable = false;
   uint8_t *decrypted = NULL;
   size_t cipher_len = 0;
   int rc;
@@ -601,12 +703,10 @@ kef_error_t kef_decrypt(const uint8_t *envelope, size_t env_len,
     return KEF_ERR_ENVELOPE_TOO_SHORT;
 
   /* --- Derive key ------------------------------------------------ */
-  rc = crypto_pbkdf2_sha256(password, pw_len, id, id_len, iterations, key,
-                            CRYPTO_AES_KEY_SIZE);
-  if (rc != CRYPTO_OK) {
-    err = KEF_ERR_CRYPTO;
+  err = derive_key(password, pw_len, id, id_len, iterations, key, &cache_tag,
+                   &cacheable);
+  if (err != KEF_OK)
     goto cleanup;
-  }
 
   /* --- Decrypt --------------------------------------------------- */
   decrypted = malloc(cipher_len);
@@ -721,9 +821,12 @@ kef_error_t kef_decrypt(const uint8_t *envelope, size_t env_len,
     *out_len = plain_len;
   }
   err = KEF_OK;
+  if (cacheable)
+    cache_store(&cache_tag, iterations, key);
 
 cleanup:
   secure_memzero(key, sizeof(key));
+  secure_memzero(&cache_tag, sizeof(cache_tag));
   if (decrypted) {
     secure_memzero(decrypted, cipher_len);
     free(decrypted);
@@ -79,6 +79,20 @@ kef_error_t kef_decrypt(const uint8_t *envelope, size_t env_len,
                         const uint8_t *password, size_t pw_len, uint8_t **out,
                         size_t *out_len);
 
+/*
+ * Session derived-key cache (off by default).
+ *
+ * While enabled, kef_encrypt / kef_decrypt remember up to a few PBKDF2
+ * results keyed by a session-salted password hash, id and iterations,
+ * skipping re-derivation for repeat operations. Enabling starts a fresh
+ * session; disabling wipes every entry. Clearing wipes the entries and
+ * rotates the session salt but leaves the cache enabled.
+ */
+void kef_cache_enable(void);
+void kef_cache_disable(void);
+void kef_cache_clear(void);
+bool kef_cache_is_enabled(void);
+
 /*
  * Parse header fields without decrypting.
  * id_out points into the envelope buffer (not a copy).
@@ -1,15 +1,28 @@
 #include "key.h"
+#include "../utils/bip39_filter.h"
 #include "../utils/secure_mem.h"
+#include <bip39_lang.h>
+#include <bip85.h>
 #include <esp_log.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wally_bip39.h>
+#include <wally_core.h>
 #include <wally_crypto.h>
 
 static struct ext_key *master_key = NULL;
 static unsigned char fingerprint[BIP32_KEY_FINGERPRINT_LEN];
 static char *stored_mnemonic = NULL;
+// SLIP-39 master secret, for keys recovered from shares (no mnemonic)
+static unsigned char stored_secret[KEY_MAX_MASTER_SECRET];
+static size_t stored_secret_len = 0;
 static bool key_loaded = false;
+// BIP85: the hardened parent of the last child derived (its path minus the
+// index), so consecutive indices cost one derivation each
+static struct ext_key *bip85_parent = NULL;
+static uint32_t bip85_parent_path[BIP85_MAX_PATH];
+static size_t bip85_parent_depth = 0;
 
 bool key_init(void) {
   key_loaded = false;
@@ -20,6 +33,77 @@ bool key_init(void) {
 
 bool key_is_loaded(void) { return key_loaded; }
 
+// NFKD copy, which is what BIP39 hashes (caller frees)
+static char *nfkd_dup(const char *text) {
+  size_t cap = strlen(text) * 3 + 1;
+  char *out = malloc(cap);
+  if (out && !bip39_lang_nfkd(text, out, cap)) {
+    secure_memzero(out, cap);
+    free(out);
+    return NULL;
+  }
+  return out;
+}
+
+int key_mnemonic_to_seed(const char *mnemonic, const char *passphrase,
+                         unsigned char *seed, size_t seed_len) {
+  if (!mnemonic) {
+    return WALLY_EINVAL;
+  }
+
+  char *norm_mnemonic = nfkd_dup(mnemonic);
+  char *norm_passphrase = passphrase ? nfkd_dup(passphrase) : NULL;
+  int ret = WALLY_ENOMEM;
+  if (norm_mnemonic && (!passphrase || norm_passphrase)) {
+    ret = bip39_mnemonic_to_seed512(norm_mnemonic, norm_passphrase, seed,
+                                    seed_len);
+  }
+  SECURE_FREE_STRING(norm_mnemonic);
+  SECURE_FREE_STRING(norm_passphrase);
+  return ret;
+}
+
+// Master key and fingerprint from a BIP32 seed
+static bool load_from_seed(const unsigned char *seed, size_t seed_len,
+                           bool is_testnet) {
+  uint32_t bip32_version =
+      is_testnet ? BIP32_VER_TEST_PRIVATE : BIP32_VER_MAIN_PRIVATE;
+  int ret = bip32_key_from_seed_alloc(seed, seed_len, bip32_version, 0,
+                                      &master_key);
+  if (ret != WALLY_OK) {
+    return false;
+  }
+
+  ret = bip32_key_get_fingerprint(master_key, fingerprint,
+                                  BIP32_KEY_FINGERPRINT_LEN);
+  if (ret != WALLY_OK) {
+    bip32_key_free(master_key);
+    master_key = NULL;
+    return false;
+  }
+  return true;
+}
+
+// Master key from the seed, keeping the mnemonic for reloads and backup
+static bool install_mnemonic_key(const char *mnemonic,
+                                 const unsigned char *seed, size_t seed_len,
+                                 bool is_testnet) {
+  if (!load_from_seed(seed, seed_len, is_testnet)) {
+    return false;
+  }
+
+  // Stored normalized: ASCII spaces, decomposed accents
+  stored_mnemonic = nfkd_dup(mnemonic);
+  if (!stored_mnemonic) {
+    bip32_key_free(master_key);
+    master_key = NULL;
+    return false;
+  }
+
+  key_loaded = true;
+  return true;
+}
+
 bool key_load_from_mnemonic(const char *mnemonic, const char *passphrase,
                             bool is_testnet) {
   if (!mnemonic) {
@@ -33,55 +117,80 @@ bool key_load_from_mnemonic(const char *mnemonic, const char *passphrase,
   int ret;
   unsigned char seed[BIP39_SEED_LEN_512];
 
-  ret = bip39_mnemonic_validate(NULL, mnemonic);
-  if (ret != WALLY_OK) {
+  // Any loaded wordlist; the language was picked when the mnemonic was
+  // entered or scanned
+  if (!bip39_filter_validate_mnemonic(mnemonic)) {
     return false;
   }
 
-  ret = bip39_mnemonic_to_seed512(mnemonic, passphrase, seed, sizeof(seed));
+  ret = key_mnemonic_to_seed(mnemonic, passphrase, seed, sizeof(seed));
   if (ret != WALLY_OK) {
     secure_memzero(seed, sizeof(seed));
     return false;
   }
 
-  uint32_t bip32_version =
-      is_testnet ? BIP32_VER_TEST_PRIVATE : BIP32_VER_MAIN_PRIVATE;
-  ret = bip32_key_from_seed_alloc(seed, sizeof(seed), bip32_version, 0,
-                                  &master_key);
-  if (ret != WALLY_OK) {
-    secure_memzero(seed, sizeof(seed));
+  bool ok = install_mnemonic_key(mnemonic, seed, sizeof(seed), is_testnet);
+  secure_memzero(seed, sizeof(seed));
+  return ok;
+}
+
+bool key_load_from_mnemonic_seed(const char *mnemonic,
+                                 const unsigned char *seed, size_t seed_len,
+                                 bool is_testnet) {
+  if (!mnemonic || !seed || seed_len != BIP39_SEED_LEN_512) {
     return false;
   }
 
-  ret = bip32_key_get_fingerprint(master_key, fingerprint,
-                                  BIP32_KEY_FINGERPRINT_LEN);
-  if (ret != WALLY_OK) {
-    bip32_key_free(master_key);
-    master_key = NULL;
-    secure_memzero(seed, sizeof(seed));
+  if (key_loaded) {
+    key_unload();
+  }
+
+  if (!bip39_filter_validate_mnemonic(mnemonic)) {
     return false;
   }
 
-  stored_mnemonic = strdup(mnemonic);
-  if (!stored_mnemonic) {
-    bip32_key_free(master_key);
-    master_key = NULL;
-    secure_memzero(seed, sizeof(seed));
+  return install_mnemonic_key(mnemonic, seed, seed_len, is_testnet);
+}
+
+bool key_load_from_master_secret(const unsigned char *secret, size_t len,
+                                 bool is_testnet) {
+  // BIP32 takes 16 to 64 byte seeds; SLIP-39 secrets are 16 to 32
+  if (!secret || len < 16 || len > KEY_MAX_MASTER_SECRET) {
     return false;
   }
 
-  secure_memzero(seed, sizeof(seed));
-  key_loaded = true;
+  if (key_loaded) {
+    key_unload();
+  }
 
+  if (!load_from_seed(secret, len, is_testnet)) {
+    return false;
+  }
+
+  memcpy(stored_secret, secret, len);
+  stored_secret_len = len;
+  key_loaded = true;
   return true;
 }
 
+static void bip85_forget_parent(void) {
+  if (bip85_parent) {
+    bip32_key_free(bip85_parent);
+    bip85_parent = NULL;
+  }
+  secure_memzero(bip85_parent_path, sizeof(bip85_parent_path));
+  bip85_parent_depth = 0;
+}
+
 void key_unload(void) {
+  bip85_forget_parent();
   if (master_key) {
     bip32_key_free(master_key);
     master_key = NULL;
   }
   SECURE_FREE_STRING(stored_mnemonic);
+  secure_memzero(stored_secret, sizeof(stored_secret));
+  stored_secret_len = 0;
   secure_memzero(fingerprint, sizeof(fingerprint));
   key_loaded = false;
 }
@@ -192,6 +301,28 @@ bool key_get_master_xpub(char **xpub_out) {
   return (ret == WALLY_OK);
 }
 
+bool key_has_mnemonic(void) { return key_loaded && stored_mnemonic; }
+
+bool key_get_master_secret(unsigned char *out, size_t *len_out) {
+  if (!key_loaded || stored_mnemonic || !out || !len_out) {
+    return false;
+  }
+  memcpy(out, stored_secret, stored_secret_len);
+  *len_out = stored_secret_len;
+  return true;
+}
+
+bool key_get_entropy(unsigned char *out, size_t *len_out) {
+  if (!key_loaded || !out || !len_out) {
+    return false;
+  }
+  if (!stored_mnemonic) {
+    return key_get_master_secret(out, len_out);
+  }
+  *len_out = bip39_filter_mnemonic_entropy(stored_mnemonic, out);
+  return *len_out > 0;
+}
+
 bool key_get_mnemonic(char **mnemonic_out) {
   if (!key_loaded || !stored_mnemonic || !mnemonic_out) {
     return false;
@@ -263,4 +394,73 @@ bool key_get_derived_key(const char *path, struct ext_key **key_out) {
   return (ret == WALLY_OK);
 }
 
+// Entropy of the key at a BIP85 path, deriving the parent only when it
+// differs from the kept one
+static bool bip85_entropy(const uint32_t *path, size_t depth,
+                          unsigned char entropy[BIP85_ENTROPY_LEN]) {
+  size_t parent_depth = depth - 1;
+  if (!bip85_parent || bip85_parent_depth != parent_depth ||
+      memcmp(bip85_parent_path, path, parent_depth * sizeof(uint32_t)) != 0) {
+    bip85_forget_parent();
+    if (bip32_key_from_parent_path_alloc(
+            master_key, path, parent_depth,
+            BIP32_FLAG_KEY_PRIVATE | BIP32_FLAG_SKIP_HASH,
+            &bip85_parent) != WALLY_OK) {
+      bip85_parent = NULL;
+      return false;
+    }
+    memcpy(bip85_parent_path, path, parent_depth * sizeof(uint32_t));
+    bip85_parent_depth = parent_depth;
+  }
+
+  struct ext_key child;
+  if (bip32_key_from_parent(bip85_parent, path[parent_depth],
+                            BIP32_FLAG_KEY_PRIVATE | BIP32_FLAG_SKIP_HASH,
+                            &child) != WALLY_OK) {
+    secure_memzero(&child, sizeof(child));
+    return false;
+  }
+  // priv_key carries a leading 0x00
+  bip85_entropy_from_k(child.priv_key + 1, entropy);
+  secure_memzero(&child, sizeof(child));
+  return true;
+}
+
+bool key_bip85_derive(bip85_app_t app, uint32_t param, uint32_t index,
+                      char **out) {
+  if (!key_loaded || !out) {
+    return false;
+  }
+
+  uint32_t path[BIP85_MAX_PATH];
+  size_t depth = bip85_path(app, param, index, path);
+  unsigned char entropy[BIP85_ENTROPY_LEN];
+  if (depth == 0 || !bip85_entropy(path, depth, entropy)) {
+    return false;
+  }
+
+  bool ok = false;
+  *out = NULL;
+  if (app == BIP85_APP_BIP39) {
+    char *mnemonic = NULL;
+    if (bip39_mnemonic_from_bytes(NULL, entropy,
+                                  bip85_bip39_entropy_len(param),
+                                  &mnemonic) == WALLY_OK) {
+      *out = strdup(mnemonic);
+      ok = *out != NULL;
+      secure_memzero(mnemonic, strlen(mnemonic));
+      wally_free_string(mnemonic);
+    }
+  } else {
+    size_t len = (app == BIP85_APP_HEX ? param * 2 : param) + 1;
+    *out = malloc(len);
+    ok = *out && bip85_format(app, param, entropy, *out, len) == BIP85_OK;
+    if (!ok) {
+      SECURE_FREE_BUFFER(*out, len);
+    }
+  }
+  secure_memzero(entropy, sizeof(entropy));
+  return ok;
+}
+
 void key_cleanup(void) { key_unload(); }
@@ -1,22 +1,53 @@
 #ifndef KEY_H
 #define KEY_H
 
+#include <bip85.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <wally_bip32.h>
 
+#define KEY_MAX_MASTER_SECRET 32
+
 bool key_init(void);
+// BIP39 seed of a mnemonic in any supported language; both strings are
+// NFKD-normalized first. Returns a WALLY_* code.
+int key_mnemonic_to_seed(const char *mnemonic, const char *passphrase,
+                         unsigned char *seed, size_t seed_len);
 bool key_is_loaded(void);
 bool key_load_from_mnemonic(const char *mnemonic, const char *passphrase,
                             bool is_testnet);
+// Same, from the BIP39 seed of mnemonic already derived with
+// key_mnemonic_to_seed() (e.g. on a job worker). Changes the loaded key,
+// so UI thread only
+bool key_load_from_mnemonic_seed(const char *mnemonic,
+                                 const unsigned char *seed, size_t seed_len,
+                                 bool is_testnet);
+// Key whose BIP32 seed is the secret itself, as SLIP-39 recovers it.
+// Such a key has no mnemonic; the secret is kept for reloads and backup.
+bool key_load_from_master_secret(const unsigned char *secret, size_t len,
+                                 bool is_testnet);
 void key_unload(void);
 bool key_get_fingerprint(unsigned char *fingerprint_out);
 bool key_get_fingerprint_hex(char *hex_out);
 bool key_get_xpub(const char *path, char **xpub_out);
 bool key_get_master_xpub(char **xpub_out);
+// False for keys loaded from a master secret
+bool key_has_mnemonic(void);
+// Only for keys loaded from a master secret; out holds
+// KEY_MAX_MASTER_SECRET bytes
+bool key_get_master_secret(unsigned char *out, size_t *len_out);
+// Secret a backup is made from: the BIP39 entropy, or the master secret.
+// out holds KEY_MAX_MASTER_SECRET bytes
+bool key_get_entropy(unsigned char *out, size_t *len_out);
 bool key_get_mnemonic(char **mnemonic_out);
 bool key_get_mnemonic_words(char ***words_out, size_t *word_count_out);
 bool key_get_derived_key(const char *path, struct ext_key **key_out);
+// BIP85 child of the loaded key: an English mnemonic for BIP85_APP_BIP39,
+// else the application's text. The hardened parent is kept between calls,
+// so stepping through indices derives one child each. UI thread only;
+// caller frees out (SECURE_FREE_STRING)
+bool key_bip85_derive(bip85_app_t app, uint32_t param, uint32_t index,
+                      char **out);
 void key_cleanup(void);
 
 #endif // KEY_H
@@ -0,0 +1,396 @@
+#include "message.h"
+#include "key.h"
+#include "psbt.h"
+#include "../utils/secure_mem.h"
+#include <stdlib.h>
+#include <string.h>
+#include <wally_address.h>
+#include <wally_bip32.h>
+#include <wally_core.h>
+#include <wally_crypto.h>
+#include <wally_script.h>
+
+#define HARDENED BIP32_INITIAL_HARDENED_CHILD
+#define SIGHASH_DEFAULT 0x00
+#define SIGHASH_ALL 0x01
+
+// Witness of a P2WPKH signature: DER signature with its sighash byte, key
+#define MAX_WITNESS_LEN (1 + 1 + EC_SIGNATURE_DER_MAX_LEN + 1 + 1 + \
+                         EC_PUBLIC_KEY_LEN)
+#define MAX_SIGNATURE_BASE64 128
+
+static message_sign_script_t script_type_of(wallet_type_t type) {
+  switch (type) {
+  case WALLET_TYPE_LEGACY:
+    return MESSAGE_SIGN_SCRIPT_P2PKH;
+  case WALLET_TYPE_NESTED_SEGWIT:
+    return MESSAGE_SIGN_SCRIPT_P2SH_P2WPKH;
+  case WALLET_TYPE_TAPROOT:
+    return MESSAGE_SIGN_SCRIPT_P2TR;
+  default:
+    return MESSAGE_SIGN_SCRIPT_P2WPKH;
+  }
+}
+
+bool message_format_supported(wallet_type_t type, message_format_t format) {
+  if (format == MESSAGE_FORMAT_BIP322) {
+    return type == WALLET_TYPE_NATIVE_SEGWIT || type == WALLET_TYPE_TAPROOT;
+  }
+  return type != WALLET_TYPE_TAPROOT;
+}
+
+static bool target_key(const message_target_t *target,
+                       struct ext_key **key_out, unsigned char *script,
+                       size_t *script_len) {
+  if (!key_get_derived_key(target->path_str, key_out)) {
+    return false;
+  }
+  if (!wallet_script_from_pubkey(target->type, (*key_out)->pub_key, script,
+                                 script_len)) {
+    bip32_key_free(*key_out);
+    *key_out = NULL;
+    return false;
+  }
+  return true;
+}
+
+bool message_resolve_target(const message_sign_request_t *req,
+                            message_target_t *target_out) {
+  if (!req || !target_out || !key_is_loaded() || !wallet_is_initialized()) {
+    return false;
+  }
+  memset(target_out, 0, sizeof(*target_out));
+
+  if (req->path_len > 0) {
+    memcpy(target_out->path, req->path, req->path_len * sizeof(uint32_t));
+    target_out->path_len = req->path_len;
+    if (!(req->path[0] & HARDENED) ||
+        !wallet_type_from_purpose(req->path[0] & ~HARDENED,
+                                  &target_out->type)) {
+      target_out->type = wallet_get_type();
+    }
+  } else {
+    // First receive address of the wallet's single-sig account
+    uint32_t coin = wallet_get_network() == WALLET_NETWORK_MAINNET ? 0 : 1;
+    target_out->type = wallet_get_type();
+    target_out->path[0] = wallet_type_purpose(target_out->type) | HARDENED;
+    target_out->path[1] = coin | HARDENED;
+    target_out->path[2] = wallet_get_account() | HARDENED;
+    target_out->path[3] = 0;
+    target_out->path[4] = 0;
+    target_out->path_len = 5;
+  }
+
+  if (!message_sign_format_path(target_out->path, target_out->path_len,
+                                target_out->path_str,
+                                sizeof(target_out->path_str))) {
+    return false;
+  }
+
+  struct ext_key *key = NULL;
+  unsigned char script[WALLY_WITNESSSCRIPT_MAX_LEN];
+  size_t script_len = 0;
+  if (!target_key(target_out, &key, script, &script_len)) {
+    return false;
+  }
+  bip32_key_free(key);
+
+  target_out->address = psbt_scriptpubkey_to_address(
+      script, script_len, wallet_get_network() == WALLET_NETWORK_TESTNET);
+  return target_out->address != NULL;
+}
+
+void message_target_clear(message_target_t *target) {
+  if (!target) {
+    return;
+  }
+  free(target->address);
+  memset(target, 0, sizeof(*target));
+}
+
+static bool sign_legacy(const struct ext_key *key, wallet_type_t type,
+                        const char *message, size_t len,
+                        unsigned char *out, size_t *out_len) {
+  unsigned char hash[MESSAGE_SIGN_HASH_LEN];
+  message_sign_legacy_hash((const uint8_t *)message, len, hash);
+  bool ok = wally_ec_sig_from_bytes(key->priv_key + 1, EC_PRIVATE_KEY_LEN,
+                                    hash, sizeof(hash),
+                                    EC_FLAG_ECDSA | EC_FLAG_RECOVERABLE, out,
+                                    EC_SIGNATURE_RECOVERABLE_LEN) == WALLY_OK;
+  wally_bzero(hash, sizeof(hash));
+  if (!ok) {
+    return false;
+  }
+  // wally writes the P2PKH compressed header; BIP137 marks segwit types
+  out[0] = message_sign_legacy_header(script_type_of(type), (out[0] - 27) & 3);
+  *out_len = EC_SIGNATURE_RECOVERABLE_LEN;
+  return out[0] != 0;
+}
+
+static bool sign_bip322(const struct ext_key *key, wallet_type_t type,
+                        const unsigned char *script, size_t script_len,
+                        const char *message, size_t len, unsigned char *out,
+                        size_t *out_len) {
+  unsigned char hash[MESSAGE_SIGN_HASH_LEN];
+  uint8_t sighash = type == WALLET_TYPE_TAPROOT ? SIGHASH_DEFAULT : SIGHASH_ALL;
+  if (!message_sign_bip322_sighash(script, script_len, (const uint8_t *)message,
+                                   len, sighash, hash)) {
+    return false;
+  }
+
+  unsigned char sig[EC_SIGNATURE_LEN];
+  unsigned char der[EC_SIGNATURE_DER_MAX_LEN + 1];
+  const uint8_t *items[MESSAGE_SIGN_MAX_WITNESS_ITEMS];
+  size_t lens[MESSAGE_SIGN_MAX_WITNESS_ITEMS];
+  size_t count = 0;
+  bool ok;
+
+  if (type == WALLET_TYPE_TAPROOT) {
+    // BIP86 key path: the output key is the internal key tweaked with an
+    // empty script tree
+    unsigned char tweaked[EC_PRIVATE_KEY_LEN];
+    ok = wally_ec_private_key_bip341_tweak(key->priv_key + 1,
+                                           EC_PRIVATE_KEY_LEN, NULL, 0, 0,
+                                           tweaked, sizeof(tweaked)) ==
+             WALLY_OK &&
+         wally_ec_sig_from_bytes(tweaked, sizeof(tweaked), hash, sizeof(hash),
+                                 EC_FLAG_SCHNORR, sig,
+                                 sizeof(sig)) == WALLY_OK;
+    secure_memzero(tweaked, sizeof(tweaked));
+    items[count] = sig;
+    lens[count++] = sizeof(sig);
+  } else {
+    size_t der_len = 0;
+    ok = wally_ec_sig_from_bytes(key->priv_key + 1, EC_PRIVATE_KEY_LEN, hash,
+                                 sizeof(hash), EC_FLAG_ECDSA | EC_FLAG_GRIND_R,
+                                 sig, sizeof(sig)) == WALLY_OK &&
+         wally_ec_sig_to_der(sig, sizeof(sig), der, sizeof(der) - 1,
+                             &der_len) == WALLY_OK;
+    der[der_len++] = SIGHASH_ALL;
+    items[count] = der;
+    lens[count++] = der_len;
+    items[count] = key->pub_key;
+    lens[count++] = EC_PUBLIC_KEY_LEN;
+  }
+  wally_bzero(hash, sizeof(hash));
+  if (!ok) {
+    return false;
+  }
+
+  *out_len = message_sign_bip322_witness(items, lens, count, out,
+                                         MAX_WITNESS_LEN);
+  return *out_len > 0;
+}
+
+bool message_sign(const message_target_t *target, const char *message,
+                  size_t len, message_format_t format, char **signature_out) {
+  if (!target || !message || !signature_out ||
+      !message_format_supported(target->type, format)) {
+    return false;
+  }
+  *signature_out = NULL;
+
+  struct ext_key *key = NULL;
+  unsigned char script[WALLY_WITNESSSCRIPT_MAX_LEN];
+  size_t script_len = 0;
+  if (!target_key(target, &key, script, &script_len)) {
+    return false;
+  }
+
+  unsigned char sig[MAX_WITNESS_LEN];
+  size_t sig_len = 0;
+  bool ok = format == MESSAGE_FORMAT_LEGACY
+                ? sign_legacy(key, target->type, message, len, sig, &sig_len)
+                : sign_bip322(key, target->type, script, script_len, message,
+                              len, sig, &sig_len);
+  bip32_key_free(key);
+
+  return ok && wally_base64_from_bytes(sig, sig_len, 0, signature_out) ==
+                   WALLY_OK;
+}
+
+/* ---------- Verification ---------- */
+
+static bool address_to_script(const char *address, bool is_testnet,
+                              unsigned char *script, size_t *script_len) {
+  const char *hrp = is_testnet ? "tb" : "bc";
+  uint32_t network = is_testnet ? WALLY_NETWORK_BITCOIN_TESTNET
+                                : WALLY_NETWORK_BITCOIN_MAINNET;
+  return wally_addr_segwit_to_bytes(address, hrp, 0, script,
+                                    WALLY_WITNESSSCRIPT_MAX_LEN,
+                                    script_len) == WALLY_OK ||
+         wally_address_to_scriptpubkey(address, network, script,
+                                       WALLY_WITNESSSCRIPT_MAX_LEN,
+                                       script_len) == WALLY_OK;
+}
+
+static bool script_equals(const unsigned char *a, size_t a_len,
+                          const unsigned char *b, size_t b_len) {
+  return a_len == b_len && memcmp(a, b, a_len) == 0;
+}
+
+static message_verify_result_t verify_legacy(const unsigned char *sig,
+                                             const unsigned char *script,
+                                             size_t script_len,
+                                             const message_sign_signed_t *s) {
+  uint8_t recid;
+  bool compressed;
+  if (!message_sign_legacy_parse_header(sig[0], &recid, &compressed, NULL)) {
+    return MESSAGE_VERIFY_BAD_SIGNATURE;
+  }
+
+  unsigned char hash[MESSAGE_SIGN_HASH_LEN];
+  message_sign_legacy_hash((const uint8_t *)s->message, s->message_len, hash);
+  unsigned char normalized[EC_SIGNATURE_RECOVERABLE_LEN];
+  memcpy(normalized, sig, sizeof(normalized));
+  normalized[0] = 31 + recid;
+  unsigned char pub_key[EC_PUBLIC_KEY_LEN];
+  if (wally_ec_sig_to_public_key(hash, sizeof(hash), normalized,
+                                 sizeof(normalized), pub_key,
+                                 sizeof(pub_key)) != WALLY_OK) {
+    return MESSAGE_VERIFY_INVALID;
+  }
+
+  unsigned char candidate[WALLY_WITNESSSCRIPT_MAX_LEN];
+  size_t candidate_len = 0;
+  if (!compressed) {
+    unsigned char full[EC_PUBLIC_KEY_UNCOMPRESSED_LEN];
+    bool ok = wally_ec_public_key_decompress(pub_key, sizeof(pub_key), full,
+                                             sizeof(full)) == WALLY_OK &&
+              wally_scriptpubkey_p2pkh_from_bytes(
+                  full, sizeof(full), WALLY_SCRIPT_HASH160, candidate,
+                  sizeof(candidate), &candidate_len) == WALLY_OK;
+    return ok && script_equals(candidate, candidate_len, script, script_len)
+               ? MESSAGE_VERIFY_VALID
+               : MESSAGE_VERIFY_INVALID;
+  }
+
+  // Wallets disagree on the segwit headers, so any single-key script of
+  // the recovered key counts
+  static const wallet_type_t types[] = {WALLET_TYPE_LEGACY,
+                                        WALLET_TYPE_NESTED_SEGWIT,
+                                        WALLET_TYPE_NATIVE_SEGWIT};
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    if (wallet_script_from_pubkey(types[i], pub_key, candidate,
+                                  &candidate_len) &&
+        script_equals(candidate, candidate_len, script, script_len)) {
+      return MESSAGE_VERIFY_VALID;
+    }
+  }
+  return MESSAGE_VERIFY_INVALID;
+}
+
+static message_verify_result_t verify_bip322(const unsigned char *sig,
+                                             size_t sig_len,
+                                             const unsigned char *script,
+                                             size_t script_len,
+                                             const message_sign_signed_t *s) {
+  message_sign_witness_t w;
+  if (message_sign_bip322_parse_witness(sig, sig_len, &w) != MESSAGE_SIGN_OK) {
+    return MESSAGE_VERIFY_BAD_SIGNATURE;
+  }
+
+  unsigned char hash[MESSAGE_SIGN_HASH_LEN];
+  unsigned char compact[EC_SIGNATURE_LEN];
+  unsigned char pub_key[EC_PUBLIC_KEY_LEN];
+  uint32_t flags;
+
+  switch (message_sign_script_type(script, script_len)) {
+  case MESSAGE_SIGN_SCRIPT_P2WPKH: {
+    unsigned char candidate[WALLY_WITNESSSCRIPT_MAX_LEN];
+    size_t candidate_len = 0;
+    if (w.count != 2 || w.lens[1] != EC_PUBLIC_KEY_LEN || w.lens[0] < 2 ||
+        w.items[0][w.lens[0] - 1] != SIGHASH_ALL ||
+        wally_ec_sig_from_der(w.items[0], w.lens[0] - 1, compact,
+                              sizeof(compact)) != WALLY_OK) {
+      return MESSAGE_VERIFY_BAD_SIGNATURE;
+    }
+    memcpy(pub_key, w.items[1], EC_PUBLIC_KEY_LEN);
+    if (!wallet_script_from_pubkey(WALLET_TYPE_NATIVE_SEGWIT, pub_key,
+                                   candidate, &candidate_len) ||
+        !script_equals(candidate, candidate_len, script, script_len)) {
+      return MESSAGE_VERIFY_INVALID;
+    }
+    if (!message_sign_bip322_sighash(script, script_len,
+                                     (const uint8_t *)s->message,
+                                     s->message_len, SIGHASH_ALL, hash)) {
+      return MESSAGE_VERIFY_INVALID;
+    }
+    flags = EC_FLAG_ECDSA;
+    break;
+  }
+  case MESSAGE_SIGN_SCRIPT_P2TR: {
+    // 64 bytes for SIGHASH_DEFAULT, else the type is appended
+    uint8_t sighash = SIGHASH_DEFAULT;
+    if (w.count != 1 ||
+        (w.lens[0] != EC_SIGNATURE_LEN && w.lens[0] != EC_SIGNATURE_LEN + 1)) {
+      return MESSAGE_VERIFY_BAD_SIGNATURE;
+    }
+    if (w.lens[0] == EC_SIGNATURE_LEN + 1) {
+      sighash = w.items[0][EC_SIGNATURE_LEN];
+      if (sighash != SIGHASH_ALL) {
+        return MESSAGE_VERIFY_BAD_SIGNATURE;
+      }
+    }
+    memcpy(compact, w.items[0], EC_SIGNATURE_LEN);
+    // Output key from the script; the parity byte is ignored for Schnorr
+    pub_key[0] = 0x02;
+    memcpy(pub_key + 1, script + 2, EC_XONLY_PUBLIC_KEY_LEN);
+    if (!message_sign_bip322_sighash(script, script_len,
+                                     (const uint8_t *)s->message,
+                                     s->message_len, sighash, hash)) {
+      return MESSAGE_VERIFY_INVALID;
+    }
+    flags = EC_FLAG_SCHNORR;
+    break;
+  }
+  default:
+    return MESSAGE_VERIFY_BAD_ADDRESS;
+  }
+
+  return wally_ec_sig_verify(pub_key, sizeof(pub_key), hash, sizeof(hash),
+                             flags, compact, sizeof(compact)) == WALLY_OK
+             ? MESSAGE_VERIFY_VALID
+             : MESSAGE_VERIFY_INVALID;
+}
+
+message_verify_result_t message_verify(const message_sign_signed_t *signed_msg,
+                                       bool is_testnet) {
+  if (!signed_msg || !signed_msg->address || !signed_msg->signature) {
+    return MESSAGE_VERIFY_BAD_SIGNATURE;
+  }
+
+  // Fields point into the scanned text; wally needs them terminated
+  char address[128];
+  char signature[MAX_SIGNATURE_BASE64 + 1];
+  if (signed_msg->address_len >= sizeof(address)) {
+    return MESSAGE_VERIFY_BAD_ADDRESS;
+  }
+  if (signed_msg->signature_len >= sizeof(signature)) {
+    return MESSAGE_VERIFY_BAD_SIGNATURE;
+  }
+  memcpy(address, signed_msg->address, signed_msg->address_len);
+  address[signed_msg->address_len] = '\0';
+  memcpy(signature, signed_msg->signature, signed_msg->signature_len);
+  signature[signed_msg->signature_len] = '\0';
+
+  unsigned char script[WALLY_WITNESSSCRIPT_MAX_LEN];
+  size_t script_len = 0;
+  if (!address_to_script(address, is_testnet, script, &script_len)) {
+    return MESSAGE_VERIFY_BAD_ADDRESS;
+  }
+
+  unsigned char sig[MAX_SIGNATURE_BASE64];
+  size_t sig_len = 0;
+  if (wally_base64_to_bytes(signature, 0, sig, sizeof(sig), &sig_len) !=
+      WALLY_OK) {
+    return MESSAGE_VERIFY_BAD_SIGNATURE;
+  }
+
+  // A BIP322 witness never starts with a header byte of 27 or more
+  if (sig_len == EC_SIGNATURE_RECOVERABLE_LEN &&
+      message_sign_legacy_parse_header(sig[0], NULL, NULL, NULL)) {
+    return verify_legacy(sig, script, script_len, signed_msg);
+  }
+  return verify_bip322(sig, sig_len, script, script_len, signed_msg);
+}
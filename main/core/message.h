@@ -0,0 +1,50 @@
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#include "wallet.h"
+#include <message_sign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+  MESSAGE_FORMAT_LEGACY, // BIP137 compact signature (P2PKH, P2SH-P2WPKH,
+                         // P2WPKH)
+  MESSAGE_FORMAT_BIP322, // BIP322 simple (P2WPKH, P2TR)
+} message_format_t;
+
+typedef enum {
+  MESSAGE_VERIFY_VALID,
+  MESSAGE_VERIFY_INVALID,       // Well formed, but not signed by the address
+  MESSAGE_VERIFY_BAD_ADDRESS,   // Not an address of the current network
+  MESSAGE_VERIFY_BAD_SIGNATURE, // Not base64 or not a known encoding
+} message_verify_result_t;
+
+// Key a sign request resolves to: the request's path, or the wallet's
+// first receive address when it names none. The script type follows the
+// path's purpose (44, 49, 84, 86), else the wallet's single-sig type
+typedef struct {
+  uint32_t path[MESSAGE_SIGN_MAX_PATH];
+  size_t path_len;
+  wallet_type_t type;
+  char path_str[MESSAGE_SIGN_MAX_PATH * 12 + 2];
+  char *address; // Freed by message_target_clear()
+} message_target_t;
+
+bool message_resolve_target(const message_sign_request_t *req,
+                            message_target_t *target_out);
+void message_target_clear(message_target_t *target);
+
+// Formats the target's script type can be signed in
+bool message_format_supported(wallet_type_t type, message_format_t format);
+
+// Sign with the loaded key; signature_out is base64 (wally_free_string)
+bool message_sign(const message_target_t *target, const char *message,
+                  size_t len, message_format_t format, char **signature_out);
+
+// Verify a legacy or BIP322 simple signature; legacy signatures are
+// accepted for any single-key address their key hashes to
+message_verify_result_t message_verify(const message_sign_signed_t *signed_msg,
+                                       bool is_testnet);
+
+#endif // MESSAGE_H
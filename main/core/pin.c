@@ -7,30 +7,24 @@
 #include "storage.h"
 
 #include <esp_efuse.h>
-#include <esp_hmac.h>
 #include <esp_log.h>
 #include <esp_system.h>
-#include <nvs.h>
-#include <nvs_flash.h>
+#include <platform.h>
 #include <string.h>
 #include <wally_bip39.h>
 
 static const char *TAG = "PIN";
 
-// NVS namespace and keys
+// NVS namespace and the hash key; scalar PIN settings live in the settings
+// schema (same namespace) and are read from its cache
 static const char *PIN_NVS_NAMESPACE = "pin";
 static const char *KEY_PIN_HASH = "pin_hash";
-static const char *KEY_SPLIT_POS = "split_pos";
-static const char *KEY_FAIL_CNT = "fail_cnt";
-static const char *KEY_MAX_FAIL = "max_fail";
-static const char *KEY_TIMEOUT = "timeout";
-static const char *KEY_HAS_EFUSE = "has_efuse";
 
 // Salt derivation tags
 static const char *HMAC_SALT_TAG = "C-Krux-PIN-salt-v1";
 static const char *FALLBACK_SALT_TAG = "C-Krux-fallback-salt-v1";
 
-static nvs_handle_t pin_nvs;
+static platform_kv_t pin_kv;
 static bool initialized = false;
 
 // ---------------------------------------------------------------------------
@@ -47,11 +41,11 @@ static esp_err_t compute_device_salt(uint8_t salt_out[PIN_HASH_SIZE]) {
     return ESP_FAIL;
   }
 
-  esp_err_t err =
-      esp_hmac_calculate(HMAC_KEY5, tag_hash, sizeof(tag_hash), salt_out);
+  platform_err_t err =
+      platform_hmac_device_key(tag_hash, sizeof(tag_hash), salt_out);
   secure_memzero(tag_hash, sizeof(tag_hash));
 
-  if (err == ESP_OK)
+  if (err == PLATFORM_OK)
     return ESP_OK;
 
   // Fallback: deterministic salt (no eFuse)
@@ -68,10 +62,10 @@ static esp_err_t compute_device_salt(uint8_t salt_out[PIN_HASH_SIZE]) {
 esp_err_t pin_init(void) {
   if (initialized)
     return ESP_OK;
-  esp_err_t err = nvs_open(PIN_NVS_NAMESPACE, NVS_READWRITE, &pin_nvs);
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-    return err;
+  platform_err_t err = platform_kv_open(PIN_NVS_NAMESPACE, &pin_kv);
+  if (err != PLATFORM_OK) {
+    ESP_LOGE(TAG, "Failed to open NVS namespace (%d)", (int)err);
+    return ESP_FAIL;
   }
   initialized = true;
   return ESP_OK;
@@ -123,11 +117,7 @@ esp_err_t pin_efuse_provision(void) {
     ESP_LOGW(TAG, "Failed to write-protect eFuse key: %s",
              esp_err_to_name(err));
 
-  // Track in NVS
-  if (initialized) {
-    nvs_set_u8(pin_nvs, KEY_HAS_EFUSE, 1);
-    nvs_commit(pin_nvs);
-  }
+  settings_set(SETTING_PIN_HAS_EFUSE, 1);
 
   return ESP_OK;
 }
@@ -153,12 +143,12 @@ esp_err_t pin_compute_anti_phishing(const char *prefix, size_t len,
 
   // HMAC(KEY5, prefix_hash)
   uint8_t hmac_out[32];
-  esp_err_t err =
-      esp_hmac_calculate(HMAC_KEY5, prefix_hash, sizeof(prefix_hash), hmac_out);
+  platform_err_t err =
+      platform_hmac_device_key(prefix_hash, sizeof(prefix_hash), hmac_out);
   secure_memzero(prefix_hash, sizeof(prefix_hash));
-  if (err != ESP_OK) {
+  if (err != PLATFORM_OK) {
     secure_memzero(hmac_out, sizeof(hmac_out));
-    return err;
+    return ESP_ERR_NOT_SUPPORTED;
   }
 
   // Extract two 11-bit indices from first 3 bytes (22 bits used)
@@ -206,9 +196,9 @@ bool pin_is_configured(void) {
     return false;
   uint8_t hash[PIN_HASH_SIZE];
   size_t len = PIN_HASH_SIZE;
-  esp_err_t err = nvs_get_blob(pin_nvs, KEY_PIN_HASH, hash, &len);
+  platform_err_t err = platform_kv_get_blob(pin_kv, KEY_PIN_HASH, hash, &len);
   secure_memzero(hash, sizeof(hash));
-  return (err == ESP_OK && len == PIN_HASH_SIZE);
+  return (err == PLATFORM_OK && len == PIN_HASH_SIZE);
 }
 
 esp_err_t pin_setup(const char *pin, size_t len, uint8_t split_pos) {
@@ -233,109 +223,127 @@ esp_err_t pin_setup(const char *pin, size_t len, uint8_t split_pos) {
     return ESP_FAIL;
   }
 
-  err = nvs_set_blob(pin_nvs, KEY_PIN_HASH, hash, PIN_HASH_SIZE);
+  platform_err_t perr =
+      platform_kv_set_blob(pin_kv, KEY_PIN_HASH, hash, PIN_HASH_SIZE);
   secure_memzero(hash, sizeof(hash));
-  if (err != ESP_OK)
-    return err;
+  if (perr == PLATFORM_OK)
+    perr = platform_kv_commit(pin_kv);
+  if (perr != PLATFORM_OK)
+    return perr == PLATFORM_ERR_NO_SPACE ? ESP_ERR_NO_MEM : ESP_FAIL;
 
-  err = nvs_set_u8(pin_nvs, KEY_SPLIT_POS, split_pos);
+  // Max failures and timeout keep their cached values (defaults if unset)
+  err = settings_set(SETTING_PIN_SPLIT_POS, split_pos);
   if (err != ESP_OK)
     return err;
-
-  // Reset failure count
-  nvs_set_u8(pin_nvs, KEY_FAIL_CNT, 0);
-
-  // Set defaults for max_fail and timeout if not already configured
-  uint8_t tmp8;
-  if (nvs_get_u8(pin_nvs, KEY_MAX_FAIL, &tmp8) != ESP_OK)
-    nvs_set_u8(pin_nvs, KEY_MAX_FAIL, PIN_DEFAULT_MAX_FAILURES);
-  uint16_t tmp16;
-  if (nvs_get_u16(pin_nvs, KEY_TIMEOUT, &tmp16) != ESP_OK)
-    nvs_set_u16(pin_nvs, KEY_TIMEOUT, PIN_DEFAULT_TIMEOUT_SEC);
+  settings_set(SETTING_PIN_FAIL_CNT, 0);
 
   // Record eFuse availability
   uint8_t has_efuse = (pin_efuse_check() == PIN_EFUSE_PROVISIONED) ? 1 : 0;
-  nvs_set_u8(pin_nvs, KEY_HAS_EFUSE, has_efuse);
-
-  return nvs_commit(pin_nvs);
+  return settings_set(SETTING_PIN_HAS_EFUSE, has_efuse);
 }
 
-pin_verify_result_t pin_verify(const char *pin, size_t len) {
-  if (!initialized || !pin || len == 0 || len > PIN_MAX_LENGTH)
+pin_verify_result_t pin_verify_begin(void) {
+  if (!initialized)
     return PIN_VERIFY_WRONG;
 
-  uint8_t fail_cnt = 0;
-  nvs_get_u8(pin_nvs, KEY_FAIL_CNT, &fail_cnt);
-
-  uint8_t max_fail = PIN_DEFAULT_MAX_FAILURES;
-  nvs_get_u8(pin_nvs, KEY_MAX_FAIL, &max_fail);
-
   // Pre-increment failure count and commit before the slow PBKDF2 so that
   // a power-cut during verification cannot gift the attacker a free attempt.
+  // The counter is an immediate-commit setting, so this holds even while a
+  // settings batch is open.
+  uint8_t fail_cnt = pin_get_fail_count();
   uint8_t pending_cnt = (fail_cnt < 255) ? fail_cnt + 1 : fail_cnt;
-  nvs_set_u8(pin_nvs, KEY_FAIL_CNT, pending_cnt);
-  nvs_commit(pin_nvs);
+  esp_err_t err = settings_set(SETTING_PIN_FAIL_CNT, pending_cnt);
+  if (err != ESP_OK) {
+    // Not on flash, so this attempt would be free: don't make it
+    ESP_LOGE(TAG, "Failed to commit failure count: %s", esp_err_to_name(err));
+    return PIN_VERIFY_ERROR;
+  }
+  return PIN_VERIFY_OK;
+}
+
+void pin_verify_abort(void) {
+  uint8_t fail_cnt = pin_get_fail_count();
+  if (fail_cnt > 0)
+    settings_set(SETTING_PIN_FAIL_CNT, fail_cnt - 1);
+}
+
+bool pin_verify_hash(const char *pin, size_t len,
+                     uint8_t hash_out[PIN_HASH_SIZE]) {
+  if (!pin || len == 0 || len > PIN_MAX_LENGTH)
+    return false;
 
-  // Always run PBKDF2 to prevent timing oracle at wipe threshold
   uint8_t salt[PIN_HASH_SIZE];
   if (compute_device_salt(salt) != ESP_OK) {
     secure_memzero(salt, sizeof(salt));
-    if (pending_cnt >= max_fail) {
-      pin_wipe_all();
-      return PIN_VERIFY_WIPED; // unreachable
-    }
-    return PIN_VERIFY_WRONG;
+    return false;
   }
 
-  uint8_t attempt_hash[PIN_HASH_SIZE];
-  int rc =
-      crypto_pbkdf2_sha256((const uint8_t *)pin, len, salt, sizeof(salt),
-                           PIN_PBKDF2_ITERATIONS, attempt_hash, PIN_HASH_SIZE);
+  int rc = crypto_pbkdf2_sha256((const uint8_t *)pin, len, salt, sizeof(salt),
+                                PIN_PBKDF2_ITERATIONS, hash_out, PIN_HASH_SIZE);
   secure_memzero(salt, sizeof(salt));
   if (rc != CRYPTO_OK) {
-    secure_memzero(attempt_hash, sizeof(attempt_hash));
-    if (pending_cnt >= max_fail) {
-      pin_wipe_all();
-      return PIN_VERIFY_WIPED; // unreachable
-    }
-    return PIN_VERIFY_WRONG;
+    secure_memzero(hash_out, PIN_HASH_SIZE);
+    return false;
   }
+  return true;
+}
+
+pin_verify_result_t pin_verify_finish(const uint8_t hash[PIN_HASH_SIZE],
+                                      bool hashed) {
+  // The count committed by pin_verify_begin()
+  uint8_t pending_cnt = pin_get_fail_count();
+  uint8_t max_fail = pin_get_max_failures();
 
   // Check wipe threshold after PBKDF2 (uniform timing)
   if (pending_cnt >= max_fail) {
-    secure_memzero(attempt_hash, sizeof(attempt_hash));
     ESP_LOGW(TAG, "Max failures reached (%u/%u), wiping device", pending_cnt,
              max_fail);
     pin_wipe_all();
     return PIN_VERIFY_WIPED; // unreachable
   }
+  if (!hashed)
+    return PIN_VERIFY_WRONG;
 
   // Load stored hash
   uint8_t stored_hash[PIN_HASH_SIZE];
   size_t hash_len = PIN_HASH_SIZE;
-  esp_err_t err = nvs_get_blob(pin_nvs, KEY_PIN_HASH, stored_hash, &hash_len);
-  if (err != ESP_OK || hash_len != PIN_HASH_SIZE) {
-    secure_memzero(attempt_hash, sizeof(attempt_hash));
+  platform_err_t err =
+      platform_kv_get_blob(pin_kv, KEY_PIN_HASH, stored_hash, &hash_len);
+  if (err != PLATFORM_OK || hash_len != PIN_HASH_SIZE) {
     secure_memzero(stored_hash, sizeof(stored_hash));
     return PIN_VERIFY_WRONG;
   }
 
   // Constant-time comparison
-  int match = secure_memcmp(attempt_hash, stored_hash, PIN_HASH_SIZE);
-  secure_memzero(attempt_hash, sizeof(attempt_hash));
+  int match = secure_memcmp(hash, stored_hash, PIN_HASH_SIZE);
   secure_memzero(stored_hash, sizeof(stored_hash));
 
   if (match == 0) {
     // Correct PIN — roll back the pre-incremented failure count
-    nvs_set_u8(pin_nvs, KEY_FAIL_CNT, 0);
-    nvs_commit(pin_nvs);
+    settings_set(SETTING_PIN_FAIL_CNT, 0);
     return PIN_VERIFY_OK;
   }
 
-  // Wrong PIN — failure count was already persisted above
+  // Wrong PIN — failure count was already persisted by pin_verify_begin()
   return PIN_VERIFY_DELAY;
 }
 
+pin_verify_result_t pin_verify(const char *pin, size_t len) {
+  if (!pin || len == 0 || len > PIN_MAX_LENGTH)
+    return PIN_VERIFY_WRONG;
+
+  pin_verify_result_t result = pin_verify_begin();
+  if (result != PIN_VERIFY_OK)
+    return result;
+
+  // Always run PBKDF2 to prevent timing oracle at wipe threshold
+  uint8_t attempt_hash[PIN_HASH_SIZE];
+  bool hashed = pin_verify_hash(pin, len, attempt_hash);
+  result = pin_verify_finish(attempt_hash, hashed);
+  secure_memzero(attempt_hash, sizeof(attempt_hash));
+  return result;
+}
+
 esp_err_t pin_change(const char *new_pin, size_t len, uint8_t split_pos) {
   // Caller must verify old PIN first via pin_verify()
   return pin_setup(new_pin, len, split_pos);
@@ -344,10 +352,8 @@ esp_err_t pin_change(const char *new_pin, size_t len, uint8_t split_pos) {
 esp_err_t pin_remove(void) {
   if (!initialized)
     return ESP_ERR_INVALID_STATE;
-  esp_err_t err = nvs_erase_all(pin_nvs);
-  if (err != ESP_OK)
-    return err;
-  return nvs_commit(pin_nvs);
+  // Erases the hash with the rest of the namespace and resets the cache
+  return settings_reset_pin();
 }
 
 // ---------------------------------------------------------------------------
@@ -355,18 +361,11 @@ esp_err_t pin_remove(void) {
 // ---------------------------------------------------------------------------
 
 uint8_t pin_get_split_position(void) {
-  if (!initialized)
-    return 1;
-  uint8_t pos = 1;
-  nvs_get_u8(pin_nvs, KEY_SPLIT_POS, &pos);
-  return pos;
+  return (uint8_t)settings_get(SETTING_PIN_SPLIT_POS);
 }
 
 uint32_t pin_get_delay_ms(void) {
-  if (!initialized)
-    return 0;
-  uint8_t fail_cnt = 0;
-  nvs_get_u8(pin_nvs, KEY_FAIL_CNT, &fail_cnt);
+  uint8_t fail_cnt = pin_get_fail_count();
   if (fail_cnt == 0)
     return 0;
   // 2^fail_cnt seconds, capped at 32768s
@@ -375,55 +374,28 @@ uint32_t pin_get_delay_ms(void) {
 }
 
 uint8_t pin_get_fail_count(void) {
-  if (!initialized)
-    return 0;
-  uint8_t val = 0;
-  nvs_get_u8(pin_nvs, KEY_FAIL_CNT, &val);
-  return val;
+  return (uint8_t)settings_get(SETTING_PIN_FAIL_CNT);
 }
 
 uint8_t pin_get_max_failures(void) {
-  if (!initialized)
-    return PIN_DEFAULT_MAX_FAILURES;
-  uint8_t val = PIN_DEFAULT_MAX_FAILURES;
-  nvs_get_u8(pin_nvs, KEY_MAX_FAIL, &val);
-  return val;
+  return (uint8_t)settings_get(SETTING_PIN_MAX_FAIL);
 }
 
 bool pin_has_anti_phishing(void) {
-  if (!initialized)
-    return false;
-  uint8_t val = 0;
-  nvs_get_u8(pin_nvs, KEY_HAS_EFUSE, &val);
-  return val != 0;
+  return settings_get(SETTING_PIN_HAS_EFUSE) != 0;
 }
 
 uint16_t pin_get_session_timeout(void) {
-  if (!initialized)
-    return PIN_DEFAULT_TIMEOUT_SEC;
-  uint16_t val = PIN_DEFAULT_TIMEOUT_SEC;
-  nvs_get_u16(pin_nvs, KEY_TIMEOUT, &val);
-  return val;
+  return settings_get(SETTING_PIN_TIMEOUT);
 }
 
 esp_err_t pin_set_session_timeout(uint16_t sec) {
-  if (!initialized)
-    return ESP_ERR_INVALID_STATE;
-  esp_err_t err = nvs_set_u16(pin_nvs, KEY_TIMEOUT, sec);
-  if (err != ESP_OK)
-    return err;
-  return nvs_commit(pin_nvs);
+  return settings_set(SETTING_PIN_TIMEOUT, sec);
 }
 
+// Range (5..50) is enforced by the settings schema
 esp_err_t pin_set_max_failures(uint8_t max) {
-  if (!initialized)
-    return ESP_ERR_INVALID_STATE;
-  if (max < 5 || max > 50)
-    return ESP_ERR_INVALID_ARG;
-  esp_err_t err = nvs_set_u8(pin_nvs, KEY_MAX_FAIL, max);
-  if (err != ESP_OK)
-    return err;
-  return nvs_commit(pin_nvs);
+  return settings_set(SETTING_PIN_MAX_FAIL, max);
 }
 
 // ---------------------------------------------------------------------------
@@ -434,10 +406,7 @@ esp_err_t pin_wipe_all(void) {
   ESP_LOGW(TAG, "Wiping all data");
 
   // Erase PIN NVS namespace
-  if (initialized) {
-    nvs_erase_all(pin_nvs);
-    nvs_commit(pin_nvs);
-  }
+  settings_reset_pin();
 
   // Reset settings
   settings_reset_all();
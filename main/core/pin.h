@@ -1,9 +1,12 @@
 // PIN authentication with split-PIN anti-phishing
 //
-// Uses a separate NVS namespace ("pin") from settings. Device salt is derived
-// from the ESP32-P4 HMAC peripheral (eFuse KEY5) so it can't be extracted from
-// a flash dump. If the HMAC peripheral is unavailable, falls back to a
-// deterministic salt (anti-phishing words are skipped).
+// Uses a separate NVS namespace ("pin") from settings. The hash is stored
+// here; split position, counters and timeout are schema entries in
+// settings.c, cached in RAM, with the failure counter committed on every
+// change. Device salt is derived from the ESP32-P4 HMAC peripheral (eFuse
+// KEY5) so it can't be extracted from a flash dump. If the HMAC peripheral is
+// unavailable, falls back to a deterministic salt (anti-phishing words are
+// skipped).
 
 #ifndef PIN_H
 #define PIN_H
@@ -31,6 +34,7 @@ typedef enum {
   PIN_VERIFY_WRONG,
   PIN_VERIFY_DELAY,
   PIN_VERIFY_WIPED,
+  PIN_VERIFY_ERROR, // Failure count not committed; PIN not checked
 } pin_verify_result_t;
 
 /* Initialization — opens the "pin" NVS namespace. Safe to call multiple times.
@@ -58,6 +62,23 @@ esp_err_t pin_compute_anti_phishing(const char *prefix, size_t len,
 bool pin_is_configured(void);
 esp_err_t pin_setup(const char *pin, size_t len, uint8_t split_pos);
 pin_verify_result_t pin_verify(const char *pin, size_t len);
+
+/* pin_verify() in steps, for callers that run the slow part on a worker.
+ * begin, abort and finish read and write settings, so they run on the LVGL
+ * task like every other settings user; pin_verify_hash() is only the device
+ * HMAC and PBKDF2 and may run on any task.
+ *
+ * begin commits the pre-incremented failure count and returns PIN_VERIFY_OK
+ * if the attempt may go ahead, else the result to report (PIN_VERIFY_ERROR
+ * if the count could not be committed). abort undoes
+ * begin when no hash was computed. finish wipes at the failure limit, then
+ * compares the hash (hashed is pin_verify_hash()'s result). */
+pin_verify_result_t pin_verify_begin(void);
+void pin_verify_abort(void);
+bool pin_verify_hash(const char *pin, size_t len,
+                     uint8_t hash_out[PIN_HASH_SIZE]);
+pin_verify_result_t pin_verify_finish(const uint8_t hash[PIN_HASH_SIZE],
+                                      bool hashed);
 esp_err_t pin_change(const char *new_pin, size_t len, uint8_t split_pos);
 
 /* Remove PIN without wiping user data (for "Disable PIN" in settings) */
@@ -2,11 +2,17 @@
 #include "key.h"
 #include "wallet.h"
 #include <esp_log.h>
+#include <psbt_keypath.h>
+#include <psbt_writer.h>
+#include <segwit_sighash.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <tx_weight.h>
 #include <wally_address.h>
 #include <wally_bip32.h>
 #include <wally_core.h>
+#include <wally_crypto.h>
 #include <wally_descriptor.h>
 #include <wally_map.h>
 #include <wally_psbt_members.h>
@@ -15,6 +21,9 @@
 
 static const char *TAG = "PSBT";
 
+// Larger witness scripts are left to wally_psbt_sign()
+#define MAX_SCRIPT_CODE_LEN 520
+
 uint64_t psbt_get_input_value(const struct wally_psbt *psbt, size_t index) {
   struct wally_tx_output *utxo = NULL;
   uint64_t value = 0;
@@ -28,6 +37,70 @@ uint64_t psbt_get_input_value(const struct wally_psbt *psbt, size_t index) {
   return value;
 }
 
+// Output spent by an input: the witness UTXO, else the prevout of the full
+// previous transaction
+static const struct wally_tx_output *
+spent_output(const struct wally_psbt_input *in,
+             const struct wally_tx_input *txin) {
+  if (in->witness_utxo) {
+    return in->witness_utxo;
+  }
+  if (in->utxo && txin->index < in->utxo->num_outputs) {
+    return &in->utxo->outputs[txin->index];
+  }
+  return NULL;
+}
+
+static void script_field(const struct wally_map *fields, uint32_t type,
+                         const uint8_t **script, size_t *len) {
+  const struct wally_map_item *item = wally_map_get_integer(fields, type);
+  *script = item ? item->value : NULL;
+  *len = item ? item->value_len : 0;
+}
+
+bool psbt_estimate_vsize(const struct wally_psbt *psbt,
+                         const struct wally_tx *global_tx,
+                         uint32_t *vsize_out) {
+  if (!psbt || !global_tx || !vsize_out ||
+      global_tx->num_inputs != psbt->num_inputs) {
+    return false;
+  }
+
+  tx_weight_input_t *inputs =
+      malloc((global_tx->num_inputs + 1) * sizeof(*inputs));
+  size_t *out_lens = malloc((global_tx->num_outputs + 1) * sizeof(size_t));
+  bool ok = inputs && out_lens;
+
+  for (size_t i = 0; ok && i < global_tx->num_inputs; i++) {
+    const struct wally_psbt_input *in = &psbt->inputs[i];
+    const struct wally_tx_output *utxo =
+        spent_output(in, &global_tx->inputs[i]);
+    if (!utxo) {
+      ok = false;
+      break;
+    }
+    inputs[i].spk = utxo->script;
+    inputs[i].spk_len = utxo->script_len;
+    script_field(&in->psbt_fields, WALLY_PSBT_IN_REDEEM_SCRIPT,
+                 &inputs[i].redeem_script, &inputs[i].redeem_script_len);
+    script_field(&in->psbt_fields, WALLY_PSBT_IN_WITNESS_SCRIPT,
+                 &inputs[i].witness_script, &inputs[i].witness_script_len);
+  }
+  for (size_t i = 0; ok && i < global_tx->num_outputs; i++) {
+    out_lens[i] = global_tx->outputs[i].script_len;
+  }
+
+  tx_weight_result_t result;
+  ok = ok && tx_weight_estimate(inputs, global_tx->num_inputs, out_lens,
+                                global_tx->num_outputs, &result);
+  free(inputs);
+  free(out_lens);
+  if (ok) {
+    *vsize_out = result.vsize;
+  }
+  return ok;
+}
+
 static bool check_keypath_network(const unsigned char *keypath,
                                   size_t keypath_len, bool *is_testnet) {
   if (keypath_len < 12) {
@@ -46,40 +119,55 @@ static bool check_keypath_network(const unsigned char *keypath,
   return false;
 }
 
+// Fingerprint and path of a keypath map entry. libwally keeps taproot
+// (PSBT_*_TAP_BIP32_DERIVATION) values raw, with the hashes of the leaves
+// the key is used in before the fingerprint; num_leaves is optional.
+static bool item_keypath(const struct wally_map_item *item, bool taproot,
+                         const unsigned char **keypath_out,
+                         size_t *keypath_len_out, size_t *num_leaves) {
+  return psbt_keypath_origin(item->value, item->value_len, taproot,
+                             keypath_out, keypath_len_out, num_leaves);
+}
+
+// First BIP32 keypath of an input or output: segwit v0 keypaths, then
+// taproot paths
+static bool first_keypath(const struct wally_map *keypaths,
+                          const struct wally_map *taproot_paths,
+                          const unsigned char **keypath_out,
+                          size_t *keypath_len_out) {
+  bool taproot = keypaths->num_items == 0;
+  const struct wally_map *map = taproot ? taproot_paths : keypaths;
+  if (map->num_items == 0) {
+    return false;
+  }
+  return item_keypath(&map->items[0], taproot, keypath_out, keypath_len_out,
+                      NULL);
+}
+
 bool psbt_detect_network(const struct wally_psbt *psbt) {
   if (!psbt) {
     return false;
   }
 
-  unsigned char keypath[100];
-  size_t keypath_len, keypaths_size;
+  const unsigned char *keypath;
+  size_t keypath_len;
   bool is_testnet;
 
   // Check outputs first
-  size_t num_outputs = 0;
-  wally_psbt_get_num_outputs(psbt, &num_outputs);
-
-  for (size_t i = 0; i < num_outputs; i++) {
-    if (wally_psbt_get_output_keypaths_size(psbt, i, &keypaths_size) ==
-            WALLY_OK &&
-        keypaths_size > 0 &&
-        wally_psbt_get_output_keypath(psbt, i, 0, keypath, sizeof(keypath),
-                                      &keypath_len) == WALLY_OK &&
+  for (size_t i = 0; i < psbt->num_outputs; i++) {
+    if (first_keypath(&psbt->outputs[i].keypaths,
+                      &psbt->outputs[i].taproot_leaf_paths, &keypath,
+                      &keypath_len) &&
         check_keypath_network(keypath, keypath_len, &is_testnet)) {
       return is_testnet;
     }
   }
 
   // Check inputs as fallback
-  size_t num_inputs = 0;
-  wally_psbt_get_num_inputs(psbt, &num_inputs);
-
-  for (size_t i = 0; i < num_inputs; i++) {
-    if (wally_psbt_get_input_keypaths_size(psbt, i, &keypaths_size) ==
-            WALLY_OK &&
-        keypaths_size > 0 &&
-        wally_psbt_get_input_keypath(psbt, i, 0, keypath, sizeof(keypath),
-                                     &keypath_len) == WALLY_OK &&
+  for (size_t i = 0; i < psbt->num_inputs; i++) {
+    if (first_keypath(&psbt->inputs[i].keypaths,
+                      &psbt->inputs[i].taproot_leaf_paths, &keypath,
+                      &keypath_len) &&
         check_keypath_network(keypath, keypath_len, &is_testnet)) {
       return is_testnet;
     }
@@ -88,18 +176,88 @@ bool psbt_detect_network(const struct wally_psbt *psbt) {
   return false; // Default to mainnet
 }
 
-static bool extract_account_from_keypath(const unsigned char *keypath,
-                                         size_t keypath_len,
-                                         uint32_t *account_out) {
-  if (keypath_len < 16) {
+// One of our keypaths, classified by its purpose. Single-sig purposes
+// (44, 49, 84, 86) fix the script type of every address below them; BIP48
+// multisig carries the script type as an extra hardened level.
+// Keypath: [fingerprint(4)] [purpose(4)] [coin(4)] [account(4)]
+// ([script(4)]) [change(4)] [index(4)]
+typedef struct {
+  bool multisig;
+  wallet_type_t type; // Single-sig only
+  uint32_t coin;
+  uint32_t account;
+  uint32_t change;
+  uint32_t index;
+  char prefix[48]; // Hardened account path, e.g. "m/49'/0'/0'"
+} keypath_info_t;
+
+static bool classify_keypath(const unsigned char *keypath, size_t keypath_len,
+                             const unsigned char *fingerprint,
+                             keypath_info_t *info) {
+  if (!keypath || keypath_len < 24 ||
+      memcmp(keypath, fingerprint, BIP32_KEY_FINGERPRINT_LEN) != 0) {
     return false;
   }
 
-  uint32_t account;
+  uint32_t purpose, coin_type, account;
+  memcpy(&purpose, keypath + 4, sizeof(uint32_t));
+  memcpy(&coin_type, keypath + 8, sizeof(uint32_t));
   memcpy(&account, keypath + 12, sizeof(uint32_t));
+  if (!(purpose & coin_type & account & 0x80000000)) {
+    return false;
+  }
+  info->coin = coin_type & 0x7FFFFFFF;
+  info->account = account & 0x7FFFFFFF;
+
+  size_t child_offset;
+  if ((purpose & 0x7FFFFFFF) == 48) {
+    uint32_t script_type;
+    memcpy(&script_type, keypath + 16, sizeof(uint32_t));
+    if (keypath_len != 28 || !(script_type & 0x80000000)) {
+      return false;
+    }
+    info->multisig = true;
+    info->type = WALLET_TYPE_NATIVE_SEGWIT;
+    snprintf(info->prefix, sizeof(info->prefix), "m/48'/%u'/%u'/%u'",
+             info->coin, info->account, script_type & 0x7FFFFFFF);
+    child_offset = 20;
+  } else {
+    if (keypath_len != 24 ||
+        !wallet_type_from_purpose(purpose & 0x7FFFFFFF, &info->type)) {
+      return false;
+    }
+    info->multisig = false;
+    snprintf(info->prefix, sizeof(info->prefix), "m/%u'/%u'/%u'",
+             purpose & 0x7FFFFFFF, info->coin, info->account);
+    child_offset = 16;
+  }
 
-  // Remove hardened bit to get actual account number
-  *account_out = account & 0x7FFFFFFF;
+  memcpy(&info->change, keypath + child_offset, sizeof(uint32_t));
+  memcpy(&info->index, keypath + child_offset + 4, sizeof(uint32_t));
+  return info->change <= 1 && !(info->index & 0x80000000);
+}
+
+static bool merge_detected_account(const struct wally_map *keypaths,
+                                   bool taproot,
+                                   const unsigned char *fingerprint,
+                                   uint32_t *detected, bool *found) {
+  for (size_t i = 0; i < keypaths->num_items; i++) {
+    const unsigned char *keypath;
+    size_t keypath_len;
+    keypath_info_t info;
+    if (!item_keypath(&keypaths->items[i], taproot, &keypath, &keypath_len,
+                      NULL) ||
+        !classify_keypath(keypath, keypath_len, fingerprint, &info)) {
+      continue;
+    }
+    if (!*found) {
+      *detected = info.account;
+      *found = true;
+    } else if (info.account != *detected) {
+      // Inconsistent accounts found
+      return false;
+    }
+  }
   return true;
 }
 
@@ -108,54 +266,31 @@ int32_t psbt_detect_account(const struct wally_psbt *psbt) {
     return -1;
   }
 
-  unsigned char keypath[100];
-  size_t keypath_len, keypaths_size;
+  unsigned char our_fingerprint[BIP32_KEY_FINGERPRINT_LEN];
+  if (!key_get_fingerprint(our_fingerprint)) {
+    return -1;
+  }
+
   uint32_t detected_account = 0;
   bool found = false;
 
-  // Check outputs first (more reliable for change outputs)
-  size_t num_outputs = 0;
-  wally_psbt_get_num_outputs(psbt, &num_outputs);
-
-  for (size_t i = 0; i < num_outputs; i++) {
-    if (wally_psbt_get_output_keypaths_size(psbt, i, &keypaths_size) ==
-            WALLY_OK &&
-        keypaths_size > 0 &&
-        wally_psbt_get_output_keypath(psbt, i, 0, keypath, sizeof(keypath),
-                                      &keypath_len) == WALLY_OK) {
-      uint32_t account;
-      if (extract_account_from_keypath(keypath, keypath_len, &account)) {
-        if (!found) {
-          detected_account = account;
-          found = true;
-        } else if (account != detected_account) {
-          // Inconsistent accounts found
-          return -1;
-        }
-      }
+  // Outputs first (more reliable for change outputs), then inputs; every
+  // keypath of ours counts, whatever its purpose
+  for (size_t i = 0; i < psbt->num_outputs; i++) {
+    if (!merge_detected_account(&psbt->outputs[i].keypaths, false,
+                                our_fingerprint, &detected_account, &found) ||
+        !merge_detected_account(&psbt->outputs[i].taproot_leaf_paths, true,
+                                our_fingerprint, &detected_account, &found)) {
+      return -1;
     }
   }
 
-  // Check inputs as fallback
-  size_t num_inputs = 0;
-  wally_psbt_get_num_inputs(psbt, &num_inputs);
-
-  for (size_t i = 0; i < num_inputs; i++) {
-    if (wally_psbt_get_input_keypaths_size(psbt, i, &keypaths_size) ==
-            WALLY_OK &&
-        keypaths_size > 0 &&
-        wally_psbt_get_input_keypath(psbt, i, 0, keypath, sizeof(keypath),
-                                     &keypath_len) == WALLY_OK) {
-      uint32_t account;
-      if (extract_account_from_keypath(keypath, keypath_len, &account)) {
-        if (!found) {
-          detected_account = account;
-          found = true;
-        } else if (account != detected_account) {
-          // Inconsistent accounts found
-          return -1;
-        }
-      }
+  for (size_t i = 0; i < psbt->num_inputs; i++) {
+    if (!merge_detected_account(&psbt->inputs[i].keypaths, false,
+                                our_fingerprint, &detected_account, &found) ||
+        !merge_detected_account(&psbt->inputs[i].taproot_leaf_paths, true,
+                                our_fingerprint, &detected_account, &found)) {
+      return -1;
     }
   }
 
@@ -199,17 +334,46 @@ char *psbt_scriptpubkey_to_address(const unsigned char *script,
   return address;
 }
 
-bool psbt_get_output_derivation(const struct wally_psbt *psbt,
-                                size_t output_index, bool is_testnet,
-                                bool *is_change, uint32_t *address_index) {
-  if (!psbt || !is_change || !address_index) {
-    return false;
+// Does the output pay to the single-sig address the keypath describes?
+static bool output_matches_keypath(const keypath_info_t *info,
+                                   const struct wally_tx_output *output) {
+  unsigned char script[WALLY_WITNESSSCRIPT_MAX_LEN];
+  size_t script_len = 0;
+  bool ok;
+
+  uint32_t wallet_coin =
+      (wallet_get_network() == WALLET_NETWORK_TESTNET) ? 1 : 0;
+  if (wallet_get_policy() == WALLET_POLICY_SINGLESIG &&
+      info->type == wallet_get_type() && info->coin == wallet_coin &&
+      info->account == wallet_get_account()) {
+    // The wallet's own account: cached account key and tweaked keys
+    ok = wallet_get_scriptpubkey(info->change == 1, info->index, script,
+                                 &script_len);
+  } else {
+    char path[72];
+    snprintf(path, sizeof(path), "%s/%u/%u", info->prefix, info->change,
+             info->index);
+    struct ext_key *key = NULL;
+    ok = key_get_derived_key(path, &key) &&
+         wallet_script_from_pubkey(info->type, key->pub_key, script,
+                                   &script_len);
+    if (key) {
+      bip32_key_free(key);
+    }
   }
 
-  size_t keypaths_size = 0;
-  if (wally_psbt_get_output_keypaths_size(psbt, output_index, &keypaths_size) !=
-          WALLY_OK ||
-      keypaths_size == 0) {
+  return ok && script_len == output->script_len &&
+         memcmp(script, output->script, script_len) == 0;
+}
+
+bool psbt_get_output_derivation(const struct wally_psbt *psbt,
+                                size_t output_index,
+                                const struct wally_tx *global_tx,
+                                bool is_testnet, bool *is_change,
+                                uint32_t *address_index) {
+  if (!psbt || !global_tx || !is_change || !address_index ||
+      output_index >= psbt->num_outputs ||
+      output_index >= global_tx->num_outputs) {
     return false;
   }
 
@@ -218,41 +382,309 @@ bool psbt_get_output_derivation(const struct wally_psbt *psbt,
     return false;
   }
 
-  for (size_t i = 0; i < keypaths_size; i++) {
-    unsigned char keypath[100];
-    size_t keypath_len = 0;
+  // Taproot outputs carry their paths in PSBT_OUT_TAP_BIP32_DERIVATION,
+  // keyed by x-only public key; every other purpose uses BIP32 keypaths
+  const struct wally_map *maps[2] = {
+      &psbt->outputs[output_index].keypaths,
+      &psbt->outputs[output_index].taproot_leaf_paths};
+  uint32_t expected_coin = is_testnet ? 1 : 0;
+
+  for (size_t m = 0; m < 2; m++) {
+    bool taproot_map = (m == 1);
+    for (size_t i = 0; i < maps[m]->num_items; i++) {
+      const unsigned char *keypath;
+      size_t keypath_len;
+      keypath_info_t info;
+
+      if (!item_keypath(&maps[m]->items[i], taproot_map, &keypath,
+                        &keypath_len, NULL) ||
+          !classify_keypath(keypath, keypath_len, our_fingerprint, &info) ||
+          info.multisig || (info.type == WALLET_TYPE_TAPROOT) != taproot_map ||
+          info.coin != expected_coin ||
+          info.account != wallet_get_account()) {
+        continue;
+      }
 
-    if (wally_psbt_get_output_keypath(psbt, output_index, i, keypath,
-                                      sizeof(keypath),
-                                      &keypath_len) != WALLY_OK ||
-        keypath_len < 24) {
-      continue;
+      if (output_matches_keypath(&info, &global_tx->outputs[output_index])) {
+        *is_change = (info.change == 1);
+        *address_index = info.index;
+        return true;
+      }
     }
+  }
 
-    if (memcmp(keypath, our_fingerprint, BIP32_KEY_FINGERPRINT_LEN) != 0) {
-      continue;
+  return false;
+}
+
+// Account-level keys reused for every input under the same hardened prefix,
+// so each input only pays for the two unhardened child derivations. A few
+// slots keep mixed-purpose PSBTs from re-deriving on every switch.
+#define ACCOUNT_KEY_CACHE_SIZE 4
+
+typedef struct {
+  char prefix[48];
+  struct ext_key *key;
+} account_key_entry_t;
+
+typedef struct {
+  account_key_entry_t entries[ACCOUNT_KEY_CACHE_SIZE];
+  size_t next;
+} account_key_cache_t;
+
+static bool derive_signing_key(account_key_cache_t *cache, const char *prefix,
+                               uint32_t change_val, uint32_t index_val,
+                               struct ext_key **key_out) {
+  account_key_entry_t *entry = NULL;
+  for (size_t i = 0; i < ACCOUNT_KEY_CACHE_SIZE; i++) {
+    if (cache->entries[i].key &&
+        strcmp(cache->entries[i].prefix, prefix) == 0) {
+      entry = &cache->entries[i];
+      break;
     }
+  }
 
-    uint32_t purpose, coin_type, account, change_val, index_val;
-    memcpy(&purpose, keypath + 4, sizeof(uint32_t));
-    memcpy(&coin_type, keypath + 8, sizeof(uint32_t));
-    memcpy(&account, keypath + 12, sizeof(uint32_t));
-    memcpy(&change_val, keypath + 16, sizeof(uint32_t));
-    memcpy(&index_val, keypath + 20, sizeof(uint32_t));
+  if (!entry) {
+    entry = &cache->entries[cache->next];
+    cache->next = (cache->next + 1) % ACCOUNT_KEY_CACHE_SIZE;
+    if (entry->key) {
+      bip32_key_free(entry->key);
+      entry->key = NULL;
+    }
+    if (!key_get_derived_key(prefix, &entry->key)) {
+      return false;
+    }
+    snprintf(entry->prefix, sizeof(entry->prefix), "%s", prefix);
+  }
 
-    uint32_t expected_coin = is_testnet ? (0x80000000 | 1) : (0x80000000 | 0);
-    uint32_t expected_account = 0x80000000 | wallet_get_account();
+  uint32_t child_path[2] = {change_val, index_val};
+  return bip32_key_from_parent_path_alloc(
+             entry->key, child_path, 2,
+             BIP32_FLAG_KEY_PRIVATE | BIP32_FLAG_SKIP_HASH,
+             key_out) == WALLY_OK;
+}
 
-    if (purpose == (0x80000000 | 84) && coin_type == expected_coin &&
-        account == expected_account && !(change_val & 0x80000000) &&
-        !(index_val & 0x80000000)) {
-      *is_change = (change_val == 1);
-      *address_index = index_val;
-      return true;
+static void account_key_cache_clear(account_key_cache_t *cache) {
+  for (size_t i = 0; i < ACCOUNT_KEY_CACHE_SIZE; i++) {
+    if (cache->entries[i].key) {
+      bip32_key_free(cache->entries[i].key);
+      cache->entries[i].key = NULL;
     }
   }
+}
 
-  return false;
+// Hash prevouts, sequences and outputs once for the whole transaction.
+// Taproot also commits to every spent output, so those are only added when
+// the PSBT has a witness UTXO for each input.
+static segwit_sighash_t *build_sighash_cache(const struct wally_psbt *psbt,
+                                             const struct wally_tx *tx) {
+  segwit_sighash_t *cache = segwit_sighash_create(tx->version, tx->locktime);
+  if (!cache) {
+    return NULL;
+  }
+
+  bool have_spent_outputs = true;
+  for (size_t i = 0; i < tx->num_inputs; i++) {
+    segwit_sighash_add_input(cache, tx->inputs[i].txhash, tx->inputs[i].index,
+                             tx->inputs[i].sequence);
+    if (!psbt->inputs[i].witness_utxo) {
+      have_spent_outputs = false;
+    }
+  }
+  for (size_t i = 0; have_spent_outputs && i < tx->num_inputs; i++) {
+    const struct wally_tx_output *utxo = psbt->inputs[i].witness_utxo;
+    segwit_sighash_add_spent_output(cache, utxo->satoshi, utxo->script,
+                                    utxo->script_len);
+  }
+  for (size_t i = 0; i < tx->num_outputs; i++) {
+    segwit_sighash_add_output(cache, tx->outputs[i].satoshi,
+                              tx->outputs[i].script,
+                              tx->outputs[i].script_len);
+  }
+  segwit_sighash_finalize(cache);
+  return cache;
+}
+
+// BIP143 scriptCode for P2WPKH, P2SH-P2WPKH, P2WSH and P2SH-P2WSH inputs.
+// Returns false for anything else (legacy, taproot).
+static bool get_input_script_code(const struct wally_psbt *psbt, size_t index,
+                                  const struct wally_tx_output *utxo,
+                                  unsigned char *code, size_t code_cap,
+                                  size_t *code_len) {
+  size_t witness_script_len = 0;
+  if (wally_psbt_get_input_witness_script_len(psbt, index,
+                                              &witness_script_len) ==
+          WALLY_OK &&
+      witness_script_len > 0) {
+    return witness_script_len <= code_cap &&
+           wally_psbt_get_input_witness_script(psbt, index, code, code_cap,
+                                               code_len) == WALLY_OK;
+  }
+
+  const unsigned char *program = utxo->script;
+  size_t program_len = utxo->script_len;
+  unsigned char redeem[WALLY_SCRIPTPUBKEY_P2WPKH_LEN];
+  size_t redeem_len = 0;
+  if (wally_psbt_get_input_redeem_script_len(psbt, index, &redeem_len) ==
+          WALLY_OK &&
+      redeem_len > 0) {
+    if (redeem_len != sizeof(redeem) ||
+        wally_psbt_get_input_redeem_script(psbt, index, redeem, sizeof(redeem),
+                                           &redeem_len) != WALLY_OK) {
+      return false;
+    }
+    program = redeem;
+    program_len = redeem_len;
+  }
+
+  // P2WPKH program 0x00 0x14 <hash160> signs as P2PKH
+  if (program_len != WALLY_SCRIPTPUBKEY_P2WPKH_LEN || program[0] != 0x00 ||
+      program[1] != HASH160_LEN || code_cap < WALLY_SCRIPTPUBKEY_P2PKH_LEN) {
+    return false;
+  }
+  return wally_scriptpubkey_p2pkh_from_bytes(program + 2, HASH160_LEN, 0, code,
+                                             code_cap, code_len) == WALLY_OK;
+}
+
+// Sign one segwit v0 input against the cached midstates. Returns false if
+// the input needs the general signer (no witness UTXO, legacy, taproot,
+// SIGHASH_SINGLE) or signing failed.
+static bool sign_input_cached(struct wally_psbt *psbt, size_t index,
+                              const struct wally_tx *tx,
+                              const segwit_sighash_t *cache,
+                              const struct ext_key *derived_key) {
+  const struct wally_tx_output *utxo = psbt->inputs[index].witness_utxo;
+  if (!cache || !utxo) {
+    return false;
+  }
+
+  unsigned char script_code[MAX_SCRIPT_CODE_LEN];
+  size_t script_code_len = 0;
+  if (!get_input_script_code(psbt, index, utxo, script_code,
+                             sizeof(script_code), &script_code_len)) {
+    return false;
+  }
+
+  uint32_t sighash = psbt->inputs[index].sighash;
+  if (sighash == 0) {
+    sighash = WALLY_SIGHASH_ALL;
+  }
+
+  unsigned char hash[SEGWIT_SIGHASH_LEN];
+  const struct wally_tx_input *in = &tx->inputs[index];
+  if (!segwit_sighash_input(cache, in->txhash, in->index, in->sequence,
+                            script_code, script_code_len, utxo->satoshi,
+                            sighash, hash)) {
+    return false;
+  }
+
+  unsigned char sig[EC_SIGNATURE_LEN];
+  unsigned char der[EC_SIGNATURE_DER_MAX_LEN + 1];
+  size_t der_len = 0;
+  bool ok = wally_ec_sig_from_bytes(derived_key->priv_key + 1,
+                                    EC_PRIVATE_KEY_LEN, hash, sizeof(hash),
+                                    EC_FLAG_ECDSA | EC_FLAG_GRIND_R, sig,
+                                    sizeof(sig)) == WALLY_OK &&
+            wally_ec_sig_to_der(sig, sizeof(sig), der, sizeof(der) - 1,
+                                &der_len) == WALLY_OK;
+  wally_bzero(hash, sizeof(hash));
+  if (!ok) {
+    return false;
+  }
+
+  der[der_len++] = (unsigned char)sighash;
+  return wally_psbt_add_input_signature(psbt, index, derived_key->pub_key,
+                                        EC_PUBLIC_KEY_LEN, der,
+                                        der_len) == WALLY_OK;
+}
+
+// BIP86 private keys tweaked with an empty script tree, kept for the
+// duration of one psbt_sign() call so inputs spending the same address
+// don't redo the TapTweak
+#define TWEAKED_KEY_CACHE_SIZE 8
+
+typedef struct {
+  bool valid;
+  uint32_t change;
+  uint32_t index;
+  unsigned char priv_key[EC_PRIVATE_KEY_LEN];
+} tweaked_key_entry_t;
+
+typedef struct {
+  tweaked_key_entry_t entries[TWEAKED_KEY_CACHE_SIZE];
+  size_t next;
+} tweaked_key_cache_t;
+
+static const unsigned char *get_tweaked_key(tweaked_key_cache_t *cache,
+                                            const struct ext_key *derived_key,
+                                            uint32_t change_val,
+                                            uint32_t index_val) {
+  for (size_t i = 0; i < TWEAKED_KEY_CACHE_SIZE; i++) {
+    tweaked_key_entry_t *entry = &cache->entries[i];
+    if (entry->valid && entry->change == change_val &&
+        entry->index == index_val) {
+      return entry->priv_key;
+    }
+  }
+
+  tweaked_key_entry_t *entry = &cache->entries[cache->next];
+  cache->next = (cache->next + 1) % TWEAKED_KEY_CACHE_SIZE;
+  if (wally_ec_private_key_bip341_tweak(
+          derived_key->priv_key + 1, EC_PRIVATE_KEY_LEN, NULL, 0, 0,
+          entry->priv_key, sizeof(entry->priv_key)) != WALLY_OK) {
+    entry->valid = false;
+    return NULL;
+  }
+  entry->change = change_val;
+  entry->index = index_val;
+  entry->valid = true;
+  return entry->priv_key;
+}
+
+// Schnorr key-path signature for a BIP86 input. Returns false if the input
+// needs the general signer (script path, missing spent outputs, SINGLE or
+// ANYONECANPAY) or signing failed.
+static bool sign_taproot_cached(struct wally_psbt *psbt, size_t index,
+                                const segwit_sighash_t *cache,
+                                tweaked_key_cache_t *tweaked_keys,
+                                const struct ext_key *derived_key,
+                                uint32_t change_val, uint32_t index_val) {
+  if (!cache) {
+    return false;
+  }
+
+  // Leaf hashes for our key mean it signs in a script path
+  const struct wally_map_item *leaves =
+      wally_map_get(&psbt->inputs[index].taproot_leaf_hashes,
+                    derived_key->pub_key + 1, EC_XONLY_PUBLIC_KEY_LEN);
+  if (leaves && leaves->value_len > 0) {
+    return false;
+  }
+
+  uint32_t sighash = psbt->inputs[index].sighash;
+  unsigned char hash[SEGWIT_SIGHASH_LEN];
+  if (!segwit_sighash_taproot_input(cache, (uint32_t)index, sighash, hash)) {
+    return false;
+  }
+
+  const unsigned char *priv_key =
+      get_tweaked_key(tweaked_keys, derived_key, change_val, index_val);
+  unsigned char sig[EC_SIGNATURE_LEN + 1];
+  bool ok = priv_key &&
+            wally_ec_sig_from_bytes(priv_key, EC_PRIVATE_KEY_LEN, hash,
+                                    sizeof(hash), EC_FLAG_SCHNORR, sig,
+                                    EC_SIGNATURE_LEN) == WALLY_OK;
+  wally_bzero(hash, sizeof(hash));
+  if (!ok) {
+    return false;
+  }
+
+  // SIGHASH_DEFAULT signatures are 64 bytes, anything else appends the type
+  size_t sig_len = EC_SIGNATURE_LEN;
+  if (sighash != SEGWIT_SIGHASH_DEFAULT) {
+    sig[sig_len++] = (unsigned char)sighash;
+  }
+  return wally_psbt_set_input_taproot_signature(psbt, index, sig, sig_len) ==
+         WALLY_OK;
 }
 
 size_t psbt_sign(struct wally_psbt *psbt, bool is_testnet) {
@@ -273,217 +705,279 @@ size_t psbt_sign(struct wally_psbt *psbt, bool is_testnet) {
     return 0;
   }
 
+  // Inputs the cache can't handle fall back to wally_psbt_sign()
+  struct wally_tx *global_tx = NULL;
+  segwit_sighash_t *sighash_cache = NULL;
+  if (wally_psbt_get_global_tx_alloc(psbt, &global_tx) == WALLY_OK &&
+      global_tx && global_tx->num_inputs == num_inputs) {
+    sighash_cache = build_sighash_cache(psbt, global_tx);
+  }
+
+  account_key_cache_t account_key = {0};
+  tweaked_key_cache_t tweaked_keys = {0};
   size_t signatures_added = 0;
 
   for (size_t i = 0; i < num_inputs; i++) {
-    size_t keypaths_size = 0;
-    if (wally_psbt_get_input_keypaths_size(psbt, i, &keypaths_size) !=
-            WALLY_OK ||
-        keypaths_size == 0) {
-      continue;
-    }
-
-    for (size_t j = 0; j < keypaths_size; j++) {
-      unsigned char keypath[100];
-      size_t keypath_len = 0;
-
-      if (wally_psbt_get_input_keypath(psbt, i, j, keypath, sizeof(keypath),
-                                       &keypath_len) != WALLY_OK) {
-        continue;
-      }
-
-      if (memcmp(keypath, our_fingerprint, BIP32_KEY_FINGERPRINT_LEN) != 0) {
-        continue;
-      }
+    // Segwit v0 and legacy keys sit in the BIP32 keypaths, BIP86 x-only
+    // internal keys in the taproot keypaths
+    const struct wally_map *maps[2] = {&psbt->inputs[i].keypaths,
+                                       &psbt->inputs[i].taproot_leaf_paths};
+    bool input_signed = false;
+
+    for (size_t m = 0; m < 2 && !input_signed; m++) {
+      bool taproot_map = (m == 1);
+      size_t key_len =
+          taproot_map ? EC_XONLY_PUBLIC_KEY_LEN : EC_PUBLIC_KEY_LEN;
+
+      for (size_t j = 0; j < maps[m]->num_items && !input_signed; j++) {
+        const struct wally_map_item *item = &maps[m]->items[j];
+        const unsigned char *keypath;
+        size_t keypath_len, num_leaves;
+        keypath_info_t info;
+
+        // Only key-path spends are signed: a taproot key listed with
+        // leaves is a script-path key
+        if (item->key_len != key_len ||
+            !item_keypath(item, taproot_map, &keypath, &keypath_len,
+                          &num_leaves) ||
+            num_leaves != 0 ||
+            !classify_keypath(keypath, keypath_len, our_fingerprint, &info) ||
+            info.account != wallet_get_account() ||
+            (info.type == WALLET_TYPE_TAPROOT) != taproot_map) {
+          continue;
+        }
 
-      uint32_t purpose, coin_type, account;
-      memcpy(&purpose, keypath + 4, sizeof(uint32_t));
-      memcpy(&coin_type, keypath + 8, sizeof(uint32_t));
-      memcpy(&account, keypath + 12, sizeof(uint32_t));
-
-      uint32_t expected_account = 0x80000000 | wallet_get_account();
-      uint32_t coin_value = coin_type & 0x7FFFFFFF;
-      uint32_t purpose_value = purpose & 0x7FFFFFFF;
-
-      char path_str[64];
-
-      // BIP84 single-sig: m/84'/coin'/account'/change/index (24 bytes keypath)
-      // BIP48 multisig: m/48'/coin'/account'/script_type'/change/index (28
-      // bytes keypath)
-      if (purpose_value == 84 && keypath_len >= 24 &&
-          account == expected_account) {
-        uint32_t change_val, index_val;
-        memcpy(&change_val, keypath + 16, sizeof(uint32_t));
-        memcpy(&index_val, keypath + 20, sizeof(uint32_t));
-
-        snprintf(path_str, sizeof(path_str), "m/84'/%u'/%u'/%u/%u", coin_value,
-                 wallet_get_account(), change_val, index_val);
-      } else if (purpose_value == 48 && keypath_len >= 28 &&
-                 account == expected_account) {
-        uint32_t script_type, change_val, index_val;
-        memcpy(&script_type, keypath + 16, sizeof(uint32_t));
-        memcpy(&change_val, keypath + 20, sizeof(uint32_t));
-        memcpy(&index_val, keypath + 24, sizeof(uint32_t));
-
-        uint32_t script_type_value = script_type & 0x7FFFFFFF;
-        snprintf(path_str, sizeof(path_str), "m/48'/%u'/%u'/%u'/%u/%u",
-                 coin_value, wallet_get_account(), script_type_value,
-                 change_val, index_val);
-      } else {
-        continue;
-      }
+        struct ext_key *derived_key = NULL;
+        if (!derive_signing_key(&account_key, info.prefix, info.change,
+                                info.index, &derived_key)) {
+          ESP_LOGE(TAG, "Failed to derive key for path: %s/%u/%u",
+                   info.prefix, info.change, info.index);
+          continue;
+        }
 
-      struct ext_key *derived_key = NULL;
-      if (!key_get_derived_key(path_str, &derived_key)) {
-        ESP_LOGE(TAG, "Failed to derive key for path: %s", path_str);
-        continue;
-      }
+        // The keypath must belong to the key we derived for it
+        const unsigned char *pub_key =
+            taproot_map ? derived_key->pub_key + 1 : derived_key->pub_key;
+        if (memcmp(pub_key, item->key, key_len) != 0) {
+          bip32_key_free(derived_key);
+          continue;
+        }
 
-      int ret = wally_psbt_sign(psbt, derived_key->priv_key + 1,
+        bool cached =
+            taproot_map
+                ? sign_taproot_cached(psbt, i, sighash_cache, &tweaked_keys,
+                                      derived_key, info.change, info.index)
+                : sign_input_cached(psbt, i, global_tx, sighash_cache,
+                                    derived_key);
+        int ret = WALLY_OK;
+        if (!cached) {
+          ret = wally_psbt_sign(psbt, derived_key->priv_key + 1,
                                 EC_PRIVATE_KEY_LEN, EC_FLAG_GRIND_R);
+        }
 
-      bip32_key_free(derived_key);
+        bip32_key_free(derived_key);
 
-      if (ret == WALLY_OK) {
-        signatures_added++;
-        break;
-      } else {
-        ESP_LOGE(TAG, "Failed to sign input %zu: %d", i, ret);
+        if (ret == WALLY_OK) {
+          signatures_added++;
+          input_signed = true;
+        } else {
+          ESP_LOGE(TAG, "Failed to sign input %zu: %d", i, ret);
+        }
       }
     }
   }
 
+  account_key_cache_clear(&account_key);
+  wally_bzero(&tweaked_keys, sizeof(tweaked_keys));
+  segwit_sighash_destroy(sighash_cache);
+  if (global_tx) {
+    wally_tx_free(global_tx);
+  }
+
   return signatures_added;
 }
 
-struct wally_psbt *psbt_trim(const struct wally_psbt *psbt) {
-  if (!psbt) {
-    return NULL;
+// Bitcoin transaction serialization straight into the writer. Witness data
+// is included only if requested and present, matching wally_tx_to_bytes()
+static void write_tx(psbt_writer_t *w, const struct wally_tx *tx,
+                     bool with_witness) {
+  bool segwit = false;
+  for (size_t i = 0; with_witness && i < tx->num_inputs; i++) {
+    if (tx->inputs[i].witness && tx->inputs[i].witness->num_items > 0) {
+      segwit = true;
+    }
   }
 
-  struct wally_tx *global_tx = NULL;
-  if (wally_psbt_get_global_tx_alloc(psbt, &global_tx) != WALLY_OK ||
-      !global_tx) {
-    return NULL;
+  static const uint8_t segwit_marker[2] = {0x00, 0x01};
+  psbt_writer_u32le(w, tx->version);
+  if (segwit) {
+    psbt_writer_bytes(w, segwit_marker, sizeof(segwit_marker));
   }
 
-  struct wally_psbt *trimmed = NULL;
-  if (wally_psbt_from_tx(global_tx, 0, 0, &trimmed) != WALLY_OK) {
-    wally_tx_free(global_tx);
-    return NULL;
+  psbt_writer_varint(w, tx->num_inputs);
+  for (size_t i = 0; i < tx->num_inputs; i++) {
+    const struct wally_tx_input *in = &tx->inputs[i];
+    psbt_writer_bytes(w, in->txhash, WALLY_TXHASH_LEN);
+    psbt_writer_u32le(w, in->index);
+    psbt_writer_varint(w, in->script_len);
+    psbt_writer_bytes(w, in->script, in->script_len);
+    psbt_writer_u32le(w, in->sequence);
   }
-  wally_tx_free(global_tx);
 
-  size_t num_inputs = 0;
-  wally_psbt_get_num_inputs(psbt, &num_inputs);
+  psbt_writer_varint(w, tx->num_outputs);
+  for (size_t i = 0; i < tx->num_outputs; i++) {
+    const struct wally_tx_output *out = &tx->outputs[i];
+    psbt_writer_u64le(w, out->satoshi);
+    psbt_writer_varint(w, out->script_len);
+    psbt_writer_bytes(w, out->script, out->script_len);
+  }
 
-  for (size_t i = 0; i < num_inputs; i++) {
-    // Copy partial signatures using direct map access
-    size_t sigs_size = 0;
-    if (wally_psbt_get_input_signatures_size(psbt, i, &sigs_size) == WALLY_OK &&
-        sigs_size > 0) {
-      // Access the signatures map directly from the source PSBT input
-      const struct wally_map *sig_map = &psbt->inputs[i].signatures;
-      for (size_t j = 0; j < sig_map->num_items; j++) {
-        const struct wally_map_item *item = &sig_map->items[j];
-        if (item->key && item->key_len > 0 && item->value &&
-            item->value_len > 0) {
-          wally_psbt_add_input_signature(trimmed, i, item->key, item->key_len,
-                                         item->value, item->value_len);
-        }
-      }
+  for (size_t i = 0; segwit && i < tx->num_inputs; i++) {
+    const struct wally_tx_witness_stack *stack = tx->inputs[i].witness;
+    size_t num_items = stack ? stack->num_items : 0;
+    psbt_writer_varint(w, num_items);
+    for (size_t j = 0; j < num_items; j++) {
+      psbt_writer_varint(w, stack->items[j].witness_len);
+      psbt_writer_bytes(w, stack->items[j].witness,
+                        stack->items[j].witness_len);
     }
+  }
 
-    // Copy final witness if present
-    struct wally_tx_witness_stack *witness = NULL;
-    if (wally_psbt_get_input_final_witness_alloc(psbt, i, &witness) ==
-            WALLY_OK &&
-        witness) {
-      wally_psbt_set_input_final_witness(trimmed, i, witness);
-      wally_tx_witness_stack_free(witness);
-    }
-
-    // Copy final scriptsig if present
-    size_t scriptsig_len = 0;
-    if (wally_psbt_get_input_final_scriptsig_len(psbt, i, &scriptsig_len) ==
-            WALLY_OK &&
-        scriptsig_len > 0) {
-      unsigned char *scriptsig = malloc(scriptsig_len);
-      if (scriptsig) {
-        size_t written = 0;
-        if (wally_psbt_get_input_final_scriptsig(
-                psbt, i, scriptsig, scriptsig_len, &written) == WALLY_OK) {
-          wally_psbt_set_input_final_scriptsig(trimmed, i, scriptsig, written);
-        }
-        free(scriptsig);
-      }
+  psbt_writer_u32le(w, tx->locktime);
+}
+
+static size_t tx_length(const struct wally_tx *tx, bool with_witness) {
+  psbt_writer_t counter;
+  psbt_writer_init(&counter, NULL, 0, false);
+  write_tx(&counter, tx, with_witness);
+  return counter.len;
+}
+
+static void write_field(psbt_writer_t *w, const struct wally_map *fields,
+                        uint8_t type) {
+  const struct wally_map_item *item = wally_map_get_integer(fields, type);
+  if (item && item->value_len > 0) {
+    psbt_writer_record(w, type, NULL, 0, item->value, item->value_len);
+  }
+}
+
+// Input map of a signatures-only PSBT: signatures plus the UTXOs and
+// scripts a coordinator needs to validate and finalize them
+static void write_signed_input(psbt_writer_t *w,
+                               const struct wally_psbt_input *in) {
+  if (in->utxo) {
+    psbt_writer_record_begin(w, PSBT_IN_NON_WITNESS_UTXO, NULL, 0,
+                             tx_length(in->utxo, true));
+    write_tx(w, in->utxo, true);
+  }
+
+  if (in->witness_utxo) {
+    const struct wally_tx_output *utxo = in->witness_utxo;
+    psbt_writer_record_begin(w, PSBT_IN_WITNESS_UTXO, NULL, 0,
+                             8 + psbt_writer_varint_len(utxo->script_len) +
+                                 utxo->script_len);
+    psbt_writer_u64le(w, utxo->satoshi);
+    psbt_writer_varint(w, utxo->script_len);
+    psbt_writer_bytes(w, utxo->script, utxo->script_len);
+  }
+
+  for (size_t j = 0; j < in->signatures.num_items; j++) {
+    const struct wally_map_item *item = &in->signatures.items[j];
+    if (item->key_len > 0 && item->value_len > 0) {
+      psbt_writer_record(w, PSBT_IN_PARTIAL_SIG, item->key, item->key_len,
+                         item->value, item->value_len);
     }
+  }
 
-    // Copy witness UTXO if present
-    struct wally_tx_output *witness_utxo = NULL;
-    if (wally_psbt_get_input_witness_utxo_alloc(psbt, i, &witness_utxo) ==
-            WALLY_OK &&
-        witness_utxo) {
-      wally_psbt_set_input_witness_utxo(trimmed, i, witness_utxo);
-      wally_tx_output_free(witness_utxo);
-    }
-
-    // Copy non-witness UTXO if present (for legacy inputs)
-    struct wally_tx *utxo = NULL;
-    if (wally_psbt_get_input_utxo_alloc(psbt, i, &utxo) == WALLY_OK && utxo) {
-      wally_psbt_set_input_utxo(trimmed, i, utxo);
-      wally_tx_free(utxo);
-    }
-
-    // Copy redeem script if present (P2SH)
-    size_t redeem_len = 0;
-    if (wally_psbt_get_input_redeem_script_len(psbt, i, &redeem_len) ==
-            WALLY_OK &&
-        redeem_len > 0) {
-      unsigned char *redeem = malloc(redeem_len);
-      if (redeem) {
-        size_t written = 0;
-        if (wally_psbt_get_input_redeem_script(psbt, i, redeem, redeem_len,
-                                               &written) == WALLY_OK) {
-          wally_psbt_set_input_redeem_script(trimmed, i, redeem, written);
-        }
-        free(redeem);
-      }
+  write_field(w, &in->psbt_fields, PSBT_IN_REDEEM_SCRIPT);
+  write_field(w, &in->psbt_fields, PSBT_IN_WITNESS_SCRIPT);
+  write_field(w, &in->psbt_fields, PSBT_IN_FINAL_SCRIPTSIG);
+
+  const struct wally_tx_witness_stack *stack = in->final_witness;
+  if (stack && stack->num_items > 0) {
+    size_t value_len = psbt_writer_varint_len(stack->num_items);
+    for (size_t j = 0; j < stack->num_items; j++) {
+      value_len += psbt_writer_varint_len(stack->items[j].witness_len) +
+                   stack->items[j].witness_len;
+    }
+    psbt_writer_record_begin(w, PSBT_IN_FINAL_SCRIPTWITNESS, NULL, 0,
+                             value_len);
+    psbt_writer_varint(w, stack->num_items);
+    for (size_t j = 0; j < stack->num_items; j++) {
+      psbt_writer_varint(w, stack->items[j].witness_len);
+      psbt_writer_bytes(w, stack->items[j].witness,
+                        stack->items[j].witness_len);
     }
+  }
 
-    // Copy witness script if present (P2WSH)
-    size_t witness_script_len = 0;
-    if (wally_psbt_get_input_witness_script_len(psbt, i, &witness_script_len) ==
-            WALLY_OK &&
-        witness_script_len > 0) {
-      unsigned char *witness_script = malloc(witness_script_len);
-      if (witness_script) {
-        size_t written = 0;
-        if (wally_psbt_get_input_witness_script(psbt, i, witness_script,
-                                                witness_script_len,
-                                                &written) == WALLY_OK) {
-          wally_psbt_set_input_witness_script(trimmed, i, witness_script,
-                                              written);
-        }
-        free(witness_script);
-      }
+  write_field(w, &in->psbt_fields, PSBT_IN_TAP_KEY_SIG);
+  psbt_writer_separator(w);
+}
+
+static bool write_signed_psbt(psbt_writer_t *w, const struct wally_psbt *psbt,
+                              const struct wally_tx *tx, size_t *len_out) {
+  psbt_writer_magic(w);
+  psbt_writer_record_begin(w, PSBT_GLOBAL_UNSIGNED_TX, NULL, 0,
+                           tx_length(tx, false));
+  write_tx(w, tx, false);
+  psbt_writer_separator(w);
+
+  for (size_t i = 0; i < psbt->num_inputs; i++) {
+    write_signed_input(w, &psbt->inputs[i]);
+  }
+  // Output maps stay empty
+  for (size_t i = 0; i < psbt->num_outputs; i++) {
+    psbt_writer_separator(w);
+  }
+  return psbt_writer_finish(w, len_out);
+}
+
+bool psbt_serialize_signed(const struct wally_psbt *psbt, bool base64,
+                           unsigned char **out, size_t *out_len) {
+  if (!psbt || !out || !out_len) {
+    return false;
+  }
+  *out = NULL;
+  *out_len = 0;
+
+  // Version 0 PSBTs carry the unsigned tx; v2 ones have to build it
+  struct wally_tx *allocated_tx = NULL;
+  const struct wally_tx *tx = psbt->tx;
+  if (!tx) {
+    if (wally_psbt_get_global_tx_alloc(psbt, &allocated_tx) != WALLY_OK ||
+        !allocated_tx) {
+      return false;
     }
+    tx = allocated_tx;
+  }
 
-    // Copy taproot key signature if present
-    size_t tap_sig_len = 0;
-    if (wally_psbt_get_input_taproot_signature_len(psbt, i, &tap_sig_len) ==
-            WALLY_OK &&
-        tap_sig_len > 0) {
-      unsigned char tap_sig[65];
-      size_t written = 0;
-      if (wally_psbt_get_input_taproot_signature(
-              psbt, i, tap_sig, sizeof(tap_sig), &written) == WALLY_OK) {
-        wally_psbt_set_input_taproot_signature(trimmed, i, tap_sig, written);
+  bool ok = false;
+  psbt_writer_t w;
+  size_t len = 0;
+
+  // Size with a counting pass, then fill one exact buffer
+  psbt_writer_init(&w, NULL, 0, base64);
+  if (tx->num_inputs == psbt->num_inputs &&
+      tx->num_outputs == psbt->num_outputs &&
+      write_signed_psbt(&w, psbt, tx, &len)) {
+    size_t cap = len + (base64 ? 1 : 0);
+    unsigned char *buf = malloc(cap);
+    if (buf) {
+      psbt_writer_init(&w, buf, cap, base64);
+      if (write_signed_psbt(&w, psbt, tx, &len)) {
+        *out = buf;
+        *out_len = len;
+        ok = true;
+      } else {
+        free(buf);
       }
     }
   }
 
-  return trimmed;
+  if (allocated_tx) {
+    wally_tx_free(allocated_tx);
+  }
+  return ok;
 }
 
 bool psbt_is_multisig(const struct wally_psbt *psbt) {
@@ -9,11 +9,18 @@
 // Get input value in satoshis
 uint64_t psbt_get_input_value(const struct wally_psbt *psbt, size_t index);
 
+// Estimated vsize of the transaction once every input is signed
+// Sizes each input from its UTXO script and the PSBT's redeem/witness
+// scripts; false if any input isn't single-sig, multisig or taproot
+// key-path (see tx_weight.h)
+bool psbt_estimate_vsize(const struct wally_psbt *psbt,
+                         const struct wally_tx *global_tx, uint32_t *vsize_out);
+
 // Detect network from derivation paths (returns true if testnet)
 bool psbt_detect_network(const struct wally_psbt *psbt);
 
 // Detect account from derivation paths
-// Returns the account number from PSBT derivation paths
+// Returns the account number from our PSBT derivation paths, any purpose
 // Returns -1 if no derivation info found or inconsistent accounts
 int32_t psbt_detect_account(const struct wally_psbt *psbt);
 
@@ -21,18 +28,28 @@ int32_t psbt_detect_account(const struct wally_psbt *psbt);
 char *psbt_scriptpubkey_to_address(const unsigned char *script,
                                    size_t script_len, bool is_testnet);
 
-// Verify output belongs to our wallet and extract derivation info
+// Verify a single-sig output belongs to our wallet and extract derivation info
+// Accepts BIP44/49/84 keypaths and BIP86 taproot keypaths; the output script
+// must match the script type implied by the keypath's purpose
 bool psbt_get_output_derivation(const struct wally_psbt *psbt,
-                                size_t output_index, bool is_testnet,
-                                bool *is_change, uint32_t *address_index);
+                                size_t output_index,
+                                const struct wally_tx *global_tx,
+                                bool is_testnet, bool *is_change,
+                                uint32_t *address_index);
 
 // Sign PSBT inputs with loaded key
+// Segwit v0 inputs share one set of BIP143 midstates across the transaction
+// Keypaths are matched by purpose (44, 49, 84, 86 and 48), so mixed-purpose
+// PSBTs sign in one pass; BIP86 inputs are key-path signed
 // Returns number of signatures added (0 if none)
 size_t psbt_sign(struct wally_psbt *psbt, bool is_testnet);
 
-// Create a trimmed PSBT containing only signatures and minimal validation data
-// Returns new PSBT on success (caller must free), NULL on failure
-struct wally_psbt *psbt_trim(const struct wally_psbt *psbt);
+// Serialize the signatures-only PSBT (unsigned tx, signatures and the UTXOs
+// and scripts needed to validate them) straight from a signed PSBT
+// base64: NUL-terminated base64 text, otherwise raw bytes
+// Nothing is cloned; out is one exact-size buffer (caller must free)
+bool psbt_serialize_signed(const struct wally_psbt *psbt, bool base64,
+                           unsigned char **out, size_t *out_len);
 
 // Check if PSBT is a multisig transaction
 // Returns true if any input has witness script and multiple keypaths
@@ -1,6 +1,8 @@
 // Session timeout — locks device after user inactivity
 
 #include "session.h"
+#include "kef.h"
+#include "settings.h"
 #include <lvgl.h>
 
 static lv_timer_t *session_timer = NULL;
@@ -27,6 +29,7 @@ void session_start(uint16_t timeout_sec) {
 
   timeout_ms = (uint32_t)timeout_sec * 1000;
   session_timer = lv_timer_create(session_timer_cb, 1000, NULL);
+  session_apply_kef_cache();
 }
 
 void session_stop(void) {
@@ -35,6 +38,18 @@ void session_stop(void) {
     session_timer = NULL;
   }
   timeout_ms = 0;
+  kef_cache_disable();
+}
+
+// Derived KEF keys may be reused only while a timed session is active, and
+// only if the user turned the cache on
+void session_apply_kef_cache(void) {
+  if (session_timer && settings_get_kef_cache()) {
+    if (!kef_cache_is_enabled())
+      kef_cache_enable();
+  } else {
+    kef_cache_disable();
+  }
 }
 
 void session_set_expired_callback(session_expired_cb_t cb) { expired_cb = cb; }
@@ -13,6 +13,10 @@ void session_start(uint16_t timeout_sec);
 /* Stop monitoring (e.g. when PIN is removed). */
 void session_stop(void);
 
+/* Enable the KEF key cache if a session is running and the user opted in,
+ * otherwise disable and wipe it. Call after changing the setting. */
+void session_apply_kef_cache(void);
+
 /* Register callback invoked when session expires. */
 void session_set_expired_callback(session_expired_cb_t cb);
 
@@ -1,92 +1,246 @@
 // Persistent settings backed by NVS (Non-Volatile Storage)
 
 #include "settings.h"
+#include "pin.h"
 #include <esp_log.h>
-#include <nvs.h>
-#include <nvs_flash.h>
+#include <platform.h>
+#include <string.h>
 
 static const char *TAG = "SETTINGS";
-static const char *NVS_NAMESPACE = "settings";
-static const char *KEY_DEFAULT_NET = "def_net";
-static const char *KEY_DEFAULT_POL = "def_pol";
-static const char *KEY_BRIGHTNESS = "bright";
+static const char *NS_SETTINGS = "settings";
+static const char *NS_PIN = "pin";
 
-static nvs_handle_t settings_nvs;
+// Well above any normal fee market, low enough to catch a mistyped fee
+#define SETTINGS_DEFAULT_MAX_FEE_RATE 1000
+
+// Indexed by setting_id_t; keys keep their pre-schema NVS names
+static const settings_key_t schema[SETTING_COUNT] = {
+    [SETTING_DEFAULT_NET] = {"settings", "def_net", SETTINGS_TYPE_U8,
+                             WALLET_NETWORK_MAINNET, WALLET_NETWORK_MAINNET,
+                             WALLET_NETWORK_TESTNET, 0},
+    [SETTING_DEFAULT_POL] = {"settings", "def_pol", SETTINGS_TYPE_U8,
+                             WALLET_POLICY_SINGLESIG, WALLET_POLICY_SINGLESIG,
+                             WALLET_POLICY_MULTISIG, 0},
+    [SETTING_DEFAULT_TYPE] = {"settings", "def_type", SETTINGS_TYPE_U8,
+                              WALLET_TYPE_NATIVE_SEGWIT,
+                              WALLET_TYPE_NATIVE_SEGWIT, WALLET_TYPE_LEGACY,
+                              0},
+    [SETTING_BRIGHTNESS] = {"settings", "bright", SETTINGS_TYPE_U8, 50, 0, 100,
+                            0},
+    [SETTING_MAX_FEE_RATE] = {"settings", "max_fee", SETTINGS_TYPE_U16,
+                              SETTINGS_DEFAULT_MAX_FEE_RATE, 1, 10000, 0},
+    // Opt-in: keeps password-derived keys in RAM for the session
+    [SETTING_KEF_CACHE] = {"settings", "kef_cache", SETTINGS_TYPE_U8, 0, 0, 1,
+                           0},
+    [SETTING_PIN_SPLIT_POS] = {"pin", "split_pos", SETTINGS_TYPE_U8, 1, 1,
+                               PIN_MAX_LENGTH - 1, 0},
+    // Persisted before each PBKDF2 so a power cut can't refund an attempt
+    [SETTING_PIN_FAIL_CNT] = {"pin", "fail_cnt", SETTINGS_TYPE_U8, 0, 0, 255,
+                              SETTINGS_FLAG_IMMEDIATE},
+    [SETTING_PIN_MAX_FAIL] = {"pin", "max_fail", SETTINGS_TYPE_U8,
+                              PIN_DEFAULT_MAX_FAILURES, 5, 50, 0},
+    [SETTING_PIN_TIMEOUT] = {"pin", "timeout", SETTINGS_TYPE_U16,
+                             PIN_DEFAULT_TIMEOUT_SEC, 0, UINT16_MAX, 0},
+    [SETTING_PIN_HAS_EFUSE] = {"pin", "has_efuse", SETTINGS_TYPE_U8, 0, 0, 1,
+                               0},
+};
+
+static settings_store_t store;
 static bool initialized = false;
 
+// ---------------------------------------------------------------------------
+// Key-value backend
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  platform_kv_t settings;
+  platform_kv_t pin;
+} kv_backend_ctx_t;
+
+static kv_backend_ctx_t kv_ctx;
+
+static platform_kv_t ns_handle(void *ctx, const char *ns) {
+  kv_backend_ctx_t *c = ctx;
+  return strcmp(ns, NS_PIN) == 0 ? c->pin : c->settings;
+}
+
+static bool kv_backend_get(void *ctx, const char *ns, const char *key,
+                           settings_type_t type, uint16_t *value) {
+  platform_kv_t kv = ns_handle(ctx, ns);
+  if (type == SETTINGS_TYPE_U16)
+    return platform_kv_get_u16(kv, key, value) == PLATFORM_OK;
+  uint8_t v8 = 0;
+  if (platform_kv_get_u8(kv, key, &v8) != PLATFORM_OK)
+    return false;
+  *value = v8;
+  return true;
+}
+
+static bool kv_backend_set(void *ctx, const char *ns, const char *key,
+                           settings_type_t type, uint16_t value) {
+  platform_kv_t kv = ns_handle(ctx, ns);
+  if (type == SETTINGS_TYPE_U16)
+    return platform_kv_set_u16(kv, key, value) == PLATFORM_OK;
+  return platform_kv_set_u8(kv, key, (uint8_t)value) == PLATFORM_OK;
+}
+
+static bool kv_backend_commit(void *ctx, const char *ns) {
+  return platform_kv_commit(ns_handle(ctx, ns)) == PLATFORM_OK;
+}
+
+static bool kv_backend_erase_ns(void *ctx, const char *ns) {
+  platform_kv_t kv = ns_handle(ctx, ns);
+  return platform_kv_erase_all(kv) == PLATFORM_OK &&
+         platform_kv_commit(kv) == PLATFORM_OK;
+}
+
+static const settings_backend_t kv_backend = {
+    .get = kv_backend_get,
+    .set = kv_backend_set,
+    .commit = kv_backend_commit,
+    .erase_ns = kv_backend_erase_ns,
+};
+
+static esp_err_t to_esp_err(settings_store_err_t err) {
+  switch (err) {
+  case SETTINGS_STORE_OK:
+    return ESP_OK;
+  case SETTINGS_STORE_ERR_ARG:
+  case SETTINGS_STORE_ERR_RANGE:
+    return ESP_ERR_INVALID_ARG;
+  case SETTINGS_STORE_ERR_STATE:
+    return ESP_ERR_INVALID_STATE;
+  default:
+    return ESP_FAIL;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Store
+// ---------------------------------------------------------------------------
+
 esp_err_t settings_init(void) {
-  esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &settings_nvs);
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-    return err;
+  if (initialized)
+    return ESP_OK;
+
+  platform_err_t err = platform_kv_open(NS_SETTINGS, &kv_ctx.settings);
+  if (err == PLATFORM_OK)
+    err = platform_kv_open(NS_PIN, &kv_ctx.pin);
+  if (err != PLATFORM_OK) {
+    ESP_LOGE(TAG, "Failed to open NVS namespace (%d)", (int)err);
+    // Serve defaults; setters report ESP_ERR_INVALID_STATE
+    settings_store_init(&store, schema, SETTING_COUNT, NULL, NULL);
+    initialized = true;
+    return ESP_FAIL;
   }
+
+  settings_store_init(&store, schema, SETTING_COUNT, &kv_backend, &kv_ctx);
   initialized = true;
   return ESP_OK;
 }
 
-wallet_network_t settings_get_default_network(void) {
+uint16_t settings_get(setting_id_t id) {
+  if (id >= SETTING_COUNT)
+    return 0;
   if (!initialized)
-    return WALLET_NETWORK_MAINNET;
-  uint8_t val = 0;
-  if (nvs_get_u8(settings_nvs, KEY_DEFAULT_NET, &val) != ESP_OK)
-    return WALLET_NETWORK_MAINNET;
-  return (val <= WALLET_NETWORK_TESTNET) ? (wallet_network_t)val
-                                         : WALLET_NETWORK_MAINNET;
+    return schema[id].def;
+  return settings_store_get(&store, id);
 }
 
-esp_err_t settings_set_default_network(wallet_network_t network) {
+esp_err_t settings_set(setting_id_t id, uint16_t value) {
   if (!initialized)
     return ESP_ERR_INVALID_STATE;
-  esp_err_t err = nvs_set_u8(settings_nvs, KEY_DEFAULT_NET, (uint8_t)network);
-  if (err != ESP_OK)
-    return err;
-  return nvs_commit(settings_nvs);
+  return to_esp_err(settings_store_set(&store, id, value));
 }
 
-wallet_policy_t settings_get_default_policy(void) {
+esp_err_t settings_begin(void) {
   if (!initialized)
-    return WALLET_POLICY_SINGLESIG;
-  uint8_t val = 0;
-  if (nvs_get_u8(settings_nvs, KEY_DEFAULT_POL, &val) != ESP_OK)
-    return WALLET_POLICY_SINGLESIG;
-  return (val <= WALLET_POLICY_MULTISIG) ? (wallet_policy_t)val
-                                         : WALLET_POLICY_SINGLESIG;
+    return ESP_ERR_INVALID_STATE;
+  return to_esp_err(settings_store_begin(&store));
 }
 
-esp_err_t settings_set_default_policy(wallet_policy_t policy) {
+esp_err_t settings_commit(void) {
   if (!initialized)
     return ESP_ERR_INVALID_STATE;
-  esp_err_t err = nvs_set_u8(settings_nvs, KEY_DEFAULT_POL, (uint8_t)policy);
+  esp_err_t err = to_esp_err(settings_store_commit(&store));
   if (err != ESP_OK)
-    return err;
-  return nvs_commit(settings_nvs);
+    ESP_LOGE(TAG, "Failed to commit settings: %s", esp_err_to_name(err));
+  return err;
+}
+
+void settings_abort(void) {
+  if (initialized)
+    settings_store_abort(&store);
+}
+
+bool settings_subscribe(settings_listener_t cb, void *user_data) {
+  return settings_store_subscribe(&store, cb, user_data);
+}
+
+void settings_unsubscribe(settings_listener_t cb, void *user_data) {
+  settings_store_unsubscribe(&store, cb, user_data);
+}
+
+// ---------------------------------------------------------------------------
+// Typed accessors
+// ---------------------------------------------------------------------------
+
+wallet_network_t settings_get_default_network(void) {
+  return (wallet_network_t)settings_get(SETTING_DEFAULT_NET);
+}
+
+esp_err_t settings_set_default_network(wallet_network_t network) {
+  return settings_set(SETTING_DEFAULT_NET, (uint16_t)network);
+}
+
+wallet_policy_t settings_get_default_policy(void) {
+  return (wallet_policy_t)settings_get(SETTING_DEFAULT_POL);
+}
+
+esp_err_t settings_set_default_policy(wallet_policy_t policy) {
+  return settings_set(SETTING_DEFAULT_POL, (uint16_t)policy);
+}
+
+wallet_type_t settings_get_default_type(void) {
+  return (wallet_type_t)settings_get(SETTING_DEFAULT_TYPE);
+}
+
+esp_err_t settings_set_default_type(wallet_type_t type) {
+  return settings_set(SETTING_DEFAULT_TYPE, (uint16_t)type);
 }
 
 uint8_t settings_get_brightness(void) {
-  if (!initialized)
-    return 50;
-  uint8_t val = 50;
-  if (nvs_get_u8(settings_nvs, KEY_BRIGHTNESS, &val) != ESP_OK)
-    return 50;
-  return (val <= 100) ? val : 50;
+  return (uint8_t)settings_get(SETTING_BRIGHTNESS);
 }
 
 esp_err_t settings_set_brightness(uint8_t brightness) {
-  if (!initialized)
-    return ESP_ERR_INVALID_STATE;
   if (brightness > 100)
     brightness = 100;
-  esp_err_t err = nvs_set_u8(settings_nvs, KEY_BRIGHTNESS, brightness);
-  if (err != ESP_OK)
-    return err;
-  return nvs_commit(settings_nvs);
+  return settings_set(SETTING_BRIGHTNESS, brightness);
+}
+
+uint16_t settings_get_max_fee_rate(void) {
+  return settings_get(SETTING_MAX_FEE_RATE);
+}
+
+esp_err_t settings_set_max_fee_rate(uint16_t sat_per_vb) {
+  return settings_set(SETTING_MAX_FEE_RATE, sat_per_vb);
+}
+
+bool settings_get_kef_cache(void) { return settings_get(SETTING_KEF_CACHE); }
+
+esp_err_t settings_set_kef_cache(bool enabled) {
+  return settings_set(SETTING_KEF_CACHE, enabled ? 1 : 0);
 }
 
 esp_err_t settings_reset_all(void) {
   if (!initialized)
     return ESP_ERR_INVALID_STATE;
-  esp_err_t err = nvs_erase_all(settings_nvs);
-  if (err != ESP_OK)
-    return err;
-  return nvs_commit(settings_nvs);
+  return to_esp_err(settings_store_reset_ns(&store, NS_SETTINGS));
+}
+
+esp_err_t settings_reset_pin(void) {
+  if (!initialized)
+    return ESP_ERR_INVALID_STATE;
+  return to_esp_err(settings_store_reset_ns(&store, NS_PIN));
 }
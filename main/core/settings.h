@@ -1,18 +1,64 @@
 // Persistent settings backed by NVS (Non-Volatile Storage)
+//
+// Every setting, including the PIN counters in the "pin" namespace, is
+// described once in the schema in settings.c and cached in RAM at
+// settings_init(). Getters never touch flash. Setters write through unless
+// a batch is open, in which case settings_commit() writes all changes at
+// once. The PIN failure counter always commits immediately.
 
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
 #include "wallet.h"
 #include <esp_err.h>
+#include <settings_store.h>
+
+typedef enum {
+  SETTING_DEFAULT_NET = 0,
+  SETTING_DEFAULT_POL,
+  SETTING_DEFAULT_TYPE,
+  SETTING_BRIGHTNESS,
+  SETTING_MAX_FEE_RATE, // sat/vB above which PSBT review warns
+  SETTING_KEF_CACHE,    // Reuse derived KEF keys during a PIN session
+  SETTING_PIN_SPLIT_POS,
+  SETTING_PIN_FAIL_CNT,
+  SETTING_PIN_MAX_FAIL,
+  SETTING_PIN_TIMEOUT,
+  SETTING_PIN_HAS_EFUSE,
+  SETTING_COUNT,
+} setting_id_t;
 
 esp_err_t settings_init(void);
+
+/* Generic access by id; out-of-range values are rejected */
+uint16_t settings_get(setting_id_t id);
+esp_err_t settings_set(setting_id_t id, uint16_t value);
+
+/* Batches: setters only update the cache until settings_commit(), which
+ * writes every changed key with one commit per namespace. */
+esp_err_t settings_begin(void);
+esp_err_t settings_commit(void);
+void settings_abort(void);
+
+/* Change notification (called on the task that changed the value) */
+bool settings_subscribe(settings_listener_t cb, void *user_data);
+void settings_unsubscribe(settings_listener_t cb, void *user_data);
+
 wallet_network_t settings_get_default_network(void);
 esp_err_t settings_set_default_network(wallet_network_t network);
 wallet_policy_t settings_get_default_policy(void);
 esp_err_t settings_set_default_policy(wallet_policy_t policy);
+wallet_type_t settings_get_default_type(void);
+esp_err_t settings_set_default_type(wallet_type_t type);
 uint8_t settings_get_brightness(void);
 esp_err_t settings_set_brightness(uint8_t brightness);
+uint16_t settings_get_max_fee_rate(void);
+esp_err_t settings_set_max_fee_rate(uint16_t sat_per_vb);
+bool settings_get_kef_cache(void);
+esp_err_t settings_set_kef_cache(bool enabled);
 esp_err_t settings_reset_all(void);
 
+/* Erase the "pin" namespace (hash included) and reload its defaults */
+esp_err_t settings_reset_pin(void);
+
 #endif // SETTINGS_H
@@ -2,62 +2,39 @@
 
 #include "storage.h"
 #include "crypto_utils.h"
+#include "descriptor_index.h"
 #include "kef.h"
 
-#include <dirent.h>
-#include <esp_partition.h>
-#include <esp_spiffs.h>
 #include <mbedtls/base64.h>
-#include <sd_card.h>
+#include <platform.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/stat.h>
-#include <unistd.h>
 
-#define SPIFFS_PARTITION_LABEL "storage"
-
-static bool spiffs_mounted = false;
+#define STORAGE_SD_ROOT_DIR "/sdcard/kern"
 
 /* ========== Low-level file helpers ========== */
 
-static esp_err_t read_flash_file(const char *path, uint8_t **data_out,
-                                 size_t *len_out) {
-  FILE *f = fopen(path, "rb");
-  if (!f)
+static esp_err_t to_esp_err(platform_err_t err) {
+  switch (err) {
+  case PLATFORM_OK:
+    return ESP_OK;
+  case PLATFORM_ERR_ARG:
+    return ESP_ERR_INVALID_ARG;
+  case PLATFORM_ERR_NOT_FOUND:
     return ESP_ERR_NOT_FOUND;
-
-  fseek(f, 0, SEEK_END);
-  long fsize = ftell(f);
-  fseek(f, 0, SEEK_SET);
-
-  if (fsize <= 0) {
-    fclose(f);
-    return ESP_ERR_INVALID_SIZE;
-  }
-
-  uint8_t *data = malloc((size_t)fsize);
-  if (!data) {
-    fclose(f);
+  case PLATFORM_ERR_NO_MEM:
+  case PLATFORM_ERR_NO_SPACE:
     return ESP_ERR_NO_MEM;
+  case PLATFORM_ERR_UNAVAILABLE:
+    return ESP_ERR_INVALID_STATE;
+  default:
+    return ESP_FAIL;
   }
-
-  size_t nread = fread(data, 1, (size_t)fsize, f);
-  fclose(f);
-
-  *data_out = data;
-  *len_out = nread;
-  return ESP_OK;
 }
 
-static esp_err_t write_flash_file(const char *path, const uint8_t *data,
-                                  size_t len) {
-  FILE *f = fopen(path, "wb");
-  if (!f)
-    return ESP_FAIL;
-  size_t written = fwrite(data, 1, len, f);
-  fclose(f);
-  return (written == len) ? ESP_OK : ESP_FAIL;
+static platform_volume_t volume_of(storage_location_t loc) {
+  return loc == STORAGE_FLASH ? PLATFORM_VOL_FLASH : PLATFORM_VOL_SD;
 }
 
 static esp_err_t base64_encode_alloc(const uint8_t *in, size_t in_len,
@@ -120,20 +97,7 @@ static const storage_item_config_t descriptor_config = {
 /* ========== Initialization ========== */
 
 esp_err_t storage_init(void) {
-  if (spiffs_mounted)
-    return ESP_OK;
-
-  esp_vfs_spiffs_conf_t conf = {
-      .base_path = STORAGE_FLASH_BASE_PATH,
-      .partition_label = SPIFFS_PARTITION_LABEL,
-      .max_files = 5,
-      .format_if_mount_failed = true,
-  };
-
-  esp_err_t ret = esp_vfs_spiffs_register(&conf);
-  if (ret == ESP_OK)
-    spiffs_mounted = true;
-  return ret;
+  return to_esp_err(platform_fs_mount(PLATFORM_VOL_FLASH));
 }
 
 /* ========== ID sanitization ========== */
@@ -213,16 +177,14 @@ static void item_build_path(const storage_item_config_t *cfg,
 
 static esp_err_t item_init_location(const storage_item_config_t *cfg,
                                     storage_location_t loc) {
-  if (loc == STORAGE_FLASH)
-    return storage_init();
-
-  if (!sd_card_is_mounted()) {
-    esp_err_t ret = sd_card_init();
-    if (ret != ESP_OK)
-      return ret;
+  platform_volume_t vol = volume_of(loc);
+  platform_err_t err = platform_fs_mount(vol);
+  if (err != PLATFORM_OK)
+    return to_esp_err(err);
+  if (loc == STORAGE_SD) {
+    platform_fs_mkdir(vol, STORAGE_SD_ROOT_DIR);
+    platform_fs_mkdir(vol, cfg->sd_dir);
   }
-  mkdir("/sdcard/kern", 0775);
-  mkdir(cfg->sd_dir, 0775);
   return ESP_OK;
 }
 
@@ -254,22 +216,19 @@ static esp_err_t item_save(const storage_item_config_t *cfg,
   char path[96];
   item_build_path(cfg, loc, filename, path, sizeof(path));
 
-  if (loc == STORAGE_FLASH)
-    return write_flash_file(path, data, len);
-
-  if (base64_on_sd) {
+  if (loc == STORAGE_SD && base64_on_sd) {
     unsigned char *b64 = NULL;
     size_t b64_len = 0;
     ret = base64_encode_alloc(data, len, &b64, &b64_len);
     if (ret != ESP_OK)
       return ret;
 
-    ret = sd_card_write_file(path, b64, b64_len);
+    ret = to_esp_err(platform_fs_write(PLATFORM_VOL_SD, path, b64, b64_len));
     free(b64);
     return ret;
   }
 
-  return sd_card_write_file(path, data, len);
+  return to_esp_err(platform_fs_write(volume_of(loc), path, data, len));
 }
 
 static esp_err_t item_load_file(const storage_item_config_t *cfg,
@@ -289,14 +248,10 @@ static esp_err_t item_load_file(const storage_item_config_t *cfg,
   char path[96];
   item_build_path(cfg, loc, filename, path, sizeof(path));
 
-  if (loc == STORAGE_FLASH)
-    return read_flash_file(path, data_out, len_out);
-
-  /* SD card */
   uint8_t *raw = NULL;
   size_t raw_len = 0;
 
-  ret = sd_card_read_file(path, &raw, &raw_len);
+  ret = to_esp_err(platform_fs_read(volume_of(loc), path, &raw, &raw_len));
   if (ret != ESP_OK)
     return ret;
 
@@ -332,75 +287,32 @@ static esp_err_t item_list(const storage_item_config_t *cfg,
   if (ret != ESP_OK)
     return ret;
 
-  if (loc == STORAGE_SD) {
-    char **all_files = NULL;
-    int all_count = 0;
-
-    ret = sd_card_list_files(cfg->sd_dir, &all_files, &all_count);
-    if (ret != ESP_OK)
-      return ret;
-
-    char **filtered = NULL;
-    int filtered_count = 0;
+  /* Flash is flat, so items are told apart by prefix; SD uses a directory */
+  const char *dir =
+      loc == STORAGE_FLASH ? STORAGE_FLASH_BASE_PATH : cfg->sd_dir;
+  const char *prefix = loc == STORAGE_FLASH ? cfg->flash_prefix : "";
+  size_t prefix_len = strlen(prefix);
 
-    for (int i = 0; i < all_count; i++) {
-      bool match = false;
-      for (int e = 0; e < ext_count; e++) {
-        if (filename_has_ext(all_files[i], extensions[e])) {
-          match = true;
-          break;
-        }
-      }
-      if (!match)
-        continue;
-
-      char **tmp =
-          realloc(filtered, (size_t)(filtered_count + 1) * sizeof(char *));
-      if (!tmp) {
-        storage_free_file_list(filtered, filtered_count);
-        sd_card_free_file_list(all_files, all_count);
-        return ESP_ERR_NO_MEM;
-      }
-      filtered = tmp;
-      filtered[filtered_count] = strdup(all_files[i]);
-      if (!filtered[filtered_count]) {
-        storage_free_file_list(filtered, filtered_count);
-        sd_card_free_file_list(all_files, all_count);
-        return ESP_ERR_NO_MEM;
-      }
-      filtered_count++;
-    }
-
-    sd_card_free_file_list(all_files, all_count);
-    *filenames_out = filtered;
-    *count_out = filtered_count;
-    return ESP_OK;
-  }
-
-  /* Flash: enumerate SPIFFS directory */
-  DIR *dir = opendir(STORAGE_FLASH_BASE_PATH);
-  if (!dir)
-    return ESP_FAIL;
-
-  char **files = NULL;
-  int count = 0;
-  struct dirent *entry;
-  size_t prefix_len = strlen(cfg->flash_prefix);
+  char **all_files = NULL;
+  int all_count = 0;
+  ret = to_esp_err(
+      platform_fs_list(volume_of(loc), dir, &all_files, &all_count));
+  if (ret != ESP_OK)
+    return ret;
 
-  while ((entry = readdir(dir)) != NULL) {
-    const char *name = entry->d_name;
-    size_t nlen = strlen(name);
+  char **filtered = NULL;
+  int filtered_count = 0;
 
-    /* Must start with the flash prefix */
-    if (nlen < prefix_len + 4)
-      continue;
-    if (strncmp(name, cfg->flash_prefix, prefix_len) != 0)
+  for (int i = 0; i < all_count; i++) {
+    const char *name = all_files[i];
+    if (strncmp(name, prefix, prefix_len) != 0)
       continue;
 
-    /* Must end with one of the accepted extensions */
     bool match = false;
     for (int e = 0; e < ext_count; e++) {
-      if (filename_has_ext(name, extensions[e])) {
+      /* Require a non-empty id between prefix and extension */
+      if (strlen(name) > prefix_len + strlen(extensions[e]) &&
+          filename_has_ext(name, extensions[e])) {
         match = true;
         break;
       }
@@ -408,25 +320,20 @@ static esp_err_t item_list(const storage_item_config_t *cfg,
     if (!match)
       continue;
 
-    char **tmp = realloc(files, (size_t)(count + 1) * sizeof(char *));
-    if (!tmp) {
-      storage_free_file_list(files, count);
-      closedir(dir);
+    char **tmp =
+        realloc(filtered, (size_t)(filtered_count + 1) * sizeof(char *));
+    if (!tmp || !(tmp[filtered_count] = strdup(name))) {
+      storage_free_file_list(tmp ? tmp : filtered, filtered_count);
+      platform_fs_free_list(all_files, all_count);
       return ESP_ERR_NO_MEM;
     }
-    files = tmp;
-    files[count] = strdup(name);
-    if (!files[count]) {
-      storage_free_file_list(files, count);
-      closedir(dir);
-      return ESP_ERR_NO_MEM;
-    }
-    count++;
+    filtered = tmp;
+    filtered_count++;
   }
 
-  closedir(dir);
-  *filenames_out = files;
-  *count_out = count;
+  platform_fs_free_list(all_files, all_count);
+  *filenames_out = filtered;
+  *count_out = filtered_count;
   return ESP_OK;
 }
 
@@ -442,10 +349,7 @@ static esp_err_t item_delete(const storage_item_config_t *cfg,
   char path[96];
   item_build_path(cfg, loc, filename, path, sizeof(path));
 
-  if (loc == STORAGE_FLASH)
-    return (unlink(path) == 0) ? ESP_OK : ESP_FAIL;
-
-  return sd_card_delete_file(path);
+  return to_esp_err(platform_fs_delete(volume_of(loc), path));
 }
 
 static bool item_exists(const storage_item_config_t *cfg,
@@ -463,18 +367,12 @@ static bool item_exists(const storage_item_config_t *cfg,
   char path[96];
   item_build_path(cfg, loc, filename, path, sizeof(path));
 
-  if (loc == STORAGE_FLASH) {
-    if (storage_init() != ESP_OK)
-      return false;
-    struct stat st;
-    return (stat(path, &st) == 0);
-  }
-
-  if (!sd_card_is_mounted())
+  /* Flash is mounted on demand; an SD card that isn't mounted has nothing */
+  if (loc == STORAGE_FLASH && storage_init() != ESP_OK)
+    return false;
+  if (!platform_fs_is_mounted(volume_of(loc)))
     return false;
-  bool exists = false;
-  sd_card_file_exists(path, &exists);
-  return exists;
+  return platform_fs_exists(volume_of(loc), path);
 }
 
 /* ========== Mnemonic public API (thin wrappers) ========== */
@@ -513,6 +411,7 @@ esp_err_t storage_save_descriptor(storage_location_t loc, const char *id,
                                   bool encrypted) {
   const char *ext =
       encrypted ? STORAGE_DESCRIPTOR_EXT_KEF : STORAGE_DESCRIPTOR_EXT_TXT;
+  descriptor_index_invalidate();
   return item_save(&descriptor_config, loc, id, data, len, ext,
                    encrypted /* only base64-encode .kef on SD */);
 }
@@ -541,6 +440,7 @@ esp_err_t storage_list_descriptors(storage_location_t loc,
 
 esp_err_t storage_delete_descriptor(storage_location_t loc,
                                     const char *filename) {
+  descriptor_index_invalidate();
   return item_delete(&descriptor_config, loc, filename);
 }
 
@@ -572,23 +472,8 @@ char *storage_get_kef_display_name(const uint8_t *data, size_t len) {
 }
 
 esp_err_t storage_wipe_flash(void) {
-  if (spiffs_mounted) {
-    esp_vfs_spiffs_unregister(SPIFFS_PARTITION_LABEL);
-    spiffs_mounted = false;
-  }
-
-  const esp_partition_t *part = esp_partition_find_first(
-      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS,
-      SPIFFS_PARTITION_LABEL);
-  if (!part)
-    return ESP_ERR_NOT_FOUND;
-
-  esp_err_t ret = esp_partition_erase_range(part, 0, part->size);
-  if (ret != ESP_OK)
-    return ret;
-
-  /* Remount — format_if_mount_failed creates a fresh filesystem */
-  return storage_init();
+  descriptor_index_invalidate();
+  return to_esp_err(platform_fs_format(PLATFORM_VOL_FLASH));
 }
 
 void storage_free_file_list(char **files, int count) {
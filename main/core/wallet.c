@@ -1,5 +1,7 @@
 #include "wallet.h"
+#include "kef.h"
 #include "key.h"
+#include <descriptor_scan.h>
 #include <esp_log.h>
 #include <stdio.h>
 #include <string.h>
@@ -14,6 +16,7 @@ static const char *TAG = "wallet";
 
 static bool wallet_initialized = false;
 static wallet_type_t wallet_type = WALLET_TYPE_NATIVE_SEGWIT;
+static wallet_type_t pending_type = WALLET_TYPE_NATIVE_SEGWIT;
 static wallet_network_t wallet_network = WALLET_NETWORK_MAINNET;
 static wallet_policy_t wallet_policy = WALLET_POLICY_SINGLESIG;
 static struct ext_key *account_key = NULL;
@@ -23,25 +26,114 @@ static char derivation_path_buffer[48];
 // Descriptor for multisig wallets
 static struct wally_descriptor *loaded_descriptor = NULL;
 
+// Tweaked BIP86 output keys, so address sweeps and change checks don't redo
+// the TapTweak point multiplication. Direct-mapped on (index, chain), which
+// keeps a sweep of consecutive indices in distinct slots.
+#define TAPROOT_KEY_CACHE_SIZE 64
+
+typedef struct {
+  bool valid;
+  uint32_t chain;
+  uint32_t index;
+  unsigned char output_key[EC_XONLY_PUBLIC_KEY_LEN];
+} taproot_key_entry_t;
+
+static taproot_key_entry_t taproot_key_cache[TAPROOT_KEY_CACHE_SIZE];
+
+uint32_t wallet_type_purpose(wallet_type_t type) {
+  switch (type) {
+  case WALLET_TYPE_TAPROOT:
+    return 86;
+  case WALLET_TYPE_NESTED_SEGWIT:
+    return 49;
+  case WALLET_TYPE_LEGACY:
+    return 44;
+  default:
+    return 84;
+  }
+}
+
+bool wallet_type_from_purpose(uint32_t purpose, wallet_type_t *type_out) {
+  switch (purpose) {
+  case 84:
+    *type_out = WALLET_TYPE_NATIVE_SEGWIT;
+    return true;
+  case 86:
+    *type_out = WALLET_TYPE_TAPROOT;
+    return true;
+  case 49:
+    *type_out = WALLET_TYPE_NESTED_SEGWIT;
+    return true;
+  case 44:
+    *type_out = WALLET_TYPE_LEGACY;
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool wallet_script_from_pubkey(wallet_type_t type, const unsigned char *pub_key,
+                               unsigned char *script_out,
+                               size_t *script_len_out) {
+  switch (type) {
+  case WALLET_TYPE_TAPROOT: {
+    // BIP86 output key: internal key tweaked with an empty script tree
+    unsigned char tweaked[EC_PUBLIC_KEY_LEN];
+    if (wally_ec_public_key_bip341_tweak(pub_key, EC_PUBLIC_KEY_LEN, NULL, 0,
+                                         0, tweaked,
+                                         sizeof(tweaked)) != WALLY_OK) {
+      return false;
+    }
+    script_out[0] = OP_1;
+    script_out[1] = EC_XONLY_PUBLIC_KEY_LEN;
+    memcpy(script_out + 2, tweaked + 1, EC_XONLY_PUBLIC_KEY_LEN);
+    *script_len_out = WALLY_SCRIPTPUBKEY_P2TR_LEN;
+    return true;
+  }
+  case WALLET_TYPE_NESTED_SEGWIT: {
+    // P2SH wrapping the P2WPKH witness program
+    unsigned char program[WALLY_SCRIPTPUBKEY_P2WPKH_LEN];
+    size_t program_len = 0;
+    return wally_witness_program_from_bytes(
+               pub_key, EC_PUBLIC_KEY_LEN, WALLY_SCRIPT_HASH160, program,
+               sizeof(program), &program_len) == WALLY_OK &&
+           wally_scriptpubkey_p2sh_from_bytes(
+               program, program_len, WALLY_SCRIPT_HASH160, script_out,
+               WALLY_WITNESSSCRIPT_MAX_LEN, script_len_out) == WALLY_OK;
+  }
+  case WALLET_TYPE_LEGACY:
+    return wally_scriptpubkey_p2pkh_from_bytes(
+               pub_key, EC_PUBLIC_KEY_LEN, WALLY_SCRIPT_HASH160, script_out,
+               WALLY_WITNESSSCRIPT_MAX_LEN, script_len_out) == WALLY_OK;
+  default:
+    return wally_witness_program_from_bytes(
+               pub_key, EC_PUBLIC_KEY_LEN, WALLY_SCRIPT_HASH160, script_out,
+               WALLY_WITNESSSCRIPT_MAX_LEN, script_len_out) == WALLY_OK;
+  }
+}
+
 int wallet_format_derivation_path(char *buf, size_t buf_size,
-                                  wallet_policy_t policy,
+                                  wallet_policy_t policy, wallet_type_t type,
                                   wallet_network_t network, uint32_t account) {
   uint32_t coin = (network == WALLET_NETWORK_MAINNET) ? 0 : 1;
   if (policy == WALLET_POLICY_MULTISIG) {
     return snprintf(buf, buf_size, "m/48'/%u'/%u'/2'", coin, account);
   }
-  return snprintf(buf, buf_size, "m/84'/%u'/%u'", coin, account);
+  return snprintf(buf, buf_size, "m/%u'/%u'/%u'", wallet_type_purpose(type),
+                  coin, account);
 }
 
 int wallet_format_derivation_compact(char *buf, size_t buf_size,
                                      wallet_policy_t policy,
+                                     wallet_type_t type,
                                      wallet_network_t network,
                                      uint32_t account) {
   uint32_t coin = (network == WALLET_NETWORK_MAINNET) ? 0 : 1;
   if (policy == WALLET_POLICY_MULTISIG) {
     return snprintf(buf, buf_size, "48h/%uh/%uh/2h", coin, account);
   }
-  return snprintf(buf, buf_size, "84h/%uh/%uh", coin, account);
+  return snprintf(buf, buf_size, "%uh/%uh/%uh", wallet_type_purpose(type),
+                  coin, account);
 }
 
 bool wallet_init(wallet_network_t network) {
@@ -54,17 +146,18 @@ bool wallet_init(wallet_network_t network) {
   }
 
   wallet_network = network;
+  wallet_type = pending_type;
 
   wallet_format_derivation_path(derivation_path_buffer,
                                 sizeof(derivation_path_buffer), wallet_policy,
-                                network, wallet_account);
+                                wallet_type, network, wallet_account);
 
   if (!key_get_derived_key(derivation_path_buffer, &account_key)) {
     return false;
   }
 
+  memset(taproot_key_cache, 0, sizeof(taproot_key_cache));
   wallet_initialized = true;
-  wallet_type = WALLET_TYPE_NATIVE_SEGWIT;
 
   return true;
 }
@@ -73,6 +166,14 @@ bool wallet_is_initialized(void) { return wallet_initialized; }
 
 wallet_type_t wallet_get_type(void) { return wallet_type; }
 
+bool wallet_set_type(wallet_type_t type) {
+  if (type > WALLET_TYPE_LEGACY) {
+    return false;
+  }
+  pending_type = type;
+  return true;
+}
+
 wallet_network_t wallet_get_network(void) { return wallet_network; }
 
 const char *wallet_get_derivation(void) {
@@ -90,12 +191,30 @@ bool wallet_get_account_xpub(char **xpub_out) {
   return (ret == WALLY_OK);
 }
 
+static taproot_key_entry_t *taproot_key_slot(uint32_t chain, uint32_t index) {
+  return &taproot_key_cache[(index * 2 + chain) % TAPROOT_KEY_CACHE_SIZE];
+}
+
+
+// scriptPubKey for the single-sig address at chain/index
 // chain: 0 = receive, 1 = change
-static bool derive_address(uint32_t chain, uint32_t index, char **address_out) {
+static bool derive_script(uint32_t chain, uint32_t index,
+                          unsigned char *script_out, size_t *script_len_out) {
   if (!wallet_initialized || !account_key || chain > 1) {
     return false;
   }
 
+  // Cached taproot keys skip the derivation as well as the tweak
+  taproot_key_entry_t *entry = taproot_key_slot(chain, index);
+  if (wallet_type == WALLET_TYPE_TAPROOT && entry->valid &&
+      entry->chain == chain && entry->index == index) {
+    script_out[0] = OP_1;
+    script_out[1] = EC_XONLY_PUBLIC_KEY_LEN;
+    memcpy(script_out + 2, entry->output_key, EC_XONLY_PUBLIC_KEY_LEN);
+    *script_len_out = WALLY_SCRIPTPUBKEY_P2TR_LEN;
+    return true;
+  }
+
   uint32_t chain_path[1] = {chain};
   struct ext_key *chain_key = NULL;
   int ret = bip32_key_from_parent_path_alloc(
@@ -114,20 +233,42 @@ static bool derive_address(uint32_t chain, uint32_t index, char **address_out) {
     return false;
   }
 
+  bool ok = wallet_script_from_pubkey(wallet_type, addr_key->pub_key,
+                                      script_out, script_len_out);
+  bip32_key_free(addr_key);
+
+  if (ok && wallet_type == WALLET_TYPE_TAPROOT) {
+    memcpy(entry->output_key, script_out + 2, EC_XONLY_PUBLIC_KEY_LEN);
+    entry->chain = chain;
+    entry->index = index;
+    entry->valid = true;
+  }
+
+  return ok;
+}
+
+static bool derive_address(uint32_t chain, uint32_t index, char **address_out) {
   unsigned char script[WALLY_WITNESSSCRIPT_MAX_LEN];
   size_t script_len;
 
-  ret = wally_witness_program_from_bytes(addr_key->pub_key, EC_PUBLIC_KEY_LEN,
-                                         WALLY_SCRIPT_HASH160, script,
-                                         sizeof(script), &script_len);
-  bip32_key_free(addr_key);
-
-  if (ret != WALLY_OK) {
+  if (!derive_script(chain, index, script, &script_len)) {
     return false;
   }
 
+  // P2PKH and P2SH encode as base58check
+  if (wallet_type == WALLET_TYPE_LEGACY ||
+      wallet_type == WALLET_TYPE_NESTED_SEGWIT) {
+    uint32_t network = (wallet_network == WALLET_NETWORK_MAINNET)
+                           ? WALLY_NETWORK_BITCOIN_MAINNET
+                           : WALLY_NETWORK_BITCOIN_TESTNET;
+    return wally_scriptpubkey_to_address(script, script_len, network,
+                                         address_out) == WALLY_OK;
+  }
+
+  // Segwit v0 encodes as bech32, v1 (taproot) as bech32m
   const char *hrp = (wallet_network == WALLET_NETWORK_MAINNET) ? "bc" : "tb";
-  ret = wally_addr_segwit_from_bytes(script, script_len, hrp, 0, address_out);
+  int ret = wally_addr_segwit_from_bytes(script, script_len, hrp, 0,
+                                         address_out);
   return (ret == WALLY_OK);
 }
 
@@ -147,38 +288,14 @@ bool wallet_get_change_address(uint32_t index, char **address_out) {
 
 // Get scriptPubKey for a wallet address
 // is_change: false = receive (chain 0), true = change (chain 1)
+// script_out must hold WALLY_WITNESSSCRIPT_MAX_LEN bytes
 bool wallet_get_scriptpubkey(bool is_change, uint32_t index,
                              unsigned char *script_out,
                              size_t *script_len_out) {
-  if (!wallet_initialized || !account_key || !script_out || !script_len_out) {
-    return false;
-  }
-
-  uint32_t chain = is_change ? 1 : 0;
-  uint32_t chain_path[1] = {chain};
-  struct ext_key *chain_key = NULL;
-  int ret = bip32_key_from_parent_path_alloc(
-      account_key, chain_path, 1, BIP32_FLAG_KEY_PRIVATE, &chain_key);
-  if (ret != WALLY_OK) {
-    return false;
-  }
-
-  uint32_t addr_path[1] = {index};
-  struct ext_key *addr_key = NULL;
-  ret = bip32_key_from_parent_path_alloc(chain_key, addr_path, 1,
-                                         BIP32_FLAG_KEY_PUBLIC, &addr_key);
-  bip32_key_free(chain_key);
-
-  if (ret != WALLY_OK) {
+  if (!script_out || !script_len_out) {
     return false;
   }
-
-  ret = wally_witness_program_from_bytes(
-      addr_key->pub_key, EC_PUBLIC_KEY_LEN, WALLY_SCRIPT_HASH160, script_out,
-      WALLY_WITNESSSCRIPT_MAX_LEN, script_len_out);
-  bip32_key_free(addr_key);
-
-  return (ret == WALLY_OK);
+  return derive_script(is_change ? 1 : 0, index, script_out, script_len_out);
 }
 
 uint32_t wallet_get_account(void) { return wallet_account; }
@@ -197,11 +314,13 @@ void wallet_cleanup(void) {
     wally_descriptor_free(loaded_descriptor);
     loaded_descriptor = NULL;
   }
+  memset(taproot_key_cache, 0, sizeof(taproot_key_cache));
   wallet_initialized = false;
   wallet_account = 0;
 }
 
 void wallet_unload(void) {
+  kef_cache_clear();
   key_unload();
   wallet_cleanup();
 }
@@ -242,6 +361,12 @@ bool wallet_load_descriptor(const char *descriptor_str) {
   return true;
 }
 
+void wallet_adopt_descriptor(struct wally_descriptor *descriptor) {
+  if (loaded_descriptor && loaded_descriptor != descriptor)
+    wally_descriptor_free(loaded_descriptor);
+  loaded_descriptor = descriptor;
+}
+
 void wallet_clear_descriptor(void) {
   if (loaded_descriptor) {
     wally_descriptor_free(loaded_descriptor);
@@ -250,74 +375,10 @@ void wallet_clear_descriptor(void) {
 }
 
 /*
- * Descriptor checksum (BIP-380) — computed over the h-normalized canonical
- * form so the result matches coordinators like Sparrow that use 'h' for
- * hardened derivation.
- *
- * Algorithm adapted from bitcoin-core / libwally descriptor.c.
+ * Canonical descriptor with its BIP-380 checksum. Hardened steps are
+ * written 'h' and the checksum is computed over that form, so the result
+ * matches coordinators like Sparrow.
  */
-
-// clang-format off
-static const unsigned char desc_cksum_pos[] = {
-  0x5f,0x3c,0x5d,0x5c,0x1d,0x1e,0x33,0x10,0x0b,0x0c,0x12,0x34,0x0f,0x35,0x36,0x11,
-  0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x1c,0x37,0x38,0x39,0x3a,0x3b,
-  0x1b,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x21,0x22,0x23,0x24,0x25,0x26,0x27,
-  0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,0x30,0x31,0x32,0x0d,0x5e,0x0e,0x3d,0x3e,
-  0x5b,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x41,0x42,0x43,0x44,0x45,0x46,0x47,
-  0x48,0x49,0x4a,0x4b,0x4c,0x4d,0x4e,0x4f,0x50,0x51,0x52,0x1f,0x3f,0x20,0x40
-};
-// clang-format on
-
-static const char desc_cksum_charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
-
-static uint64_t desc_polymod(uint64_t c, int val) {
-  uint8_t c0 = c >> 35;
-  c = ((c & 0x7ffffffff) << 5) ^ val;
-  if (c0 & 1)
-    c ^= 0xf5dee51989;
-  if (c0 & 2)
-    c ^= 0xa9fdca3312;
-  if (c0 & 4)
-    c ^= 0x1bab10e32d;
-  if (c0 & 8)
-    c ^= 0x3706b1677a;
-  if (c0 & 16)
-    c ^= 0x644d626ffd;
-  return c;
-}
-
-static bool desc_compute_checksum(const char *str, size_t len, char out[9]) {
-  uint64_t c = 1;
-  int cls = 0, clscount = 0;
-
-  for (size_t i = 0; i < len; i++) {
-    char ch = str[i];
-    if (ch < ' ' || ch > '~')
-      return false;
-    size_t pos = desc_cksum_pos[(unsigned char)(ch - ' ')];
-    if (pos == 0)
-      return false;
-    --pos;
-    c = desc_polymod(c, pos & 31);
-    cls = cls * 3 + (int)(pos >> 5);
-    if (++clscount == 3) {
-      c = desc_polymod(c, cls);
-      cls = 0;
-      clscount = 0;
-    }
-  }
-  if (clscount > 0)
-    c = desc_polymod(c, cls);
-  for (int i = 0; i < 8; i++)
-    c = desc_polymod(c, 0);
-  c ^= 1;
-
-  for (int i = 0; i < 8; i++)
-    out[i] = desc_cksum_charset[(c >> (5 * (7 - i))) & 31];
-  out[8] = '\0';
-  return true;
-}
-
 bool wallet_get_descriptor_string(char **output) {
   if (!loaded_descriptor || !output)
     return false;
@@ -339,7 +400,7 @@ bool wallet_get_descriptor_string(char **output) {
 
   /* Compute checksum over the h-normalized body */
   char cksum[9];
-  if (!desc_compute_checksum(canonical, body_len, cksum)) {
+  if (!desc_scan_checksum(canonical, body_len, cksum)) {
     wally_free_string(canonical);
     return false;
   }
@@ -5,8 +5,14 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct wally_descriptor;
+
+// Single-sig script type (multisig follows the loaded descriptor)
 typedef enum {
-  WALLET_TYPE_NATIVE_SEGWIT = 0,
+  WALLET_TYPE_NATIVE_SEGWIT = 0, // BIP84 P2WPKH
+  WALLET_TYPE_TAPROOT = 1,       // BIP86 P2TR key path
+  WALLET_TYPE_NESTED_SEGWIT = 2, // BIP49 P2SH-P2WPKH
+  WALLET_TYPE_LEGACY = 3,        // BIP44 P2PKH
 } wallet_type_t;
 
 typedef enum {
@@ -19,20 +25,35 @@ typedef enum {
   WALLET_POLICY_MULTISIG = 1,
 } wallet_policy_t;
 
-// Format derivation path: "m/84'/0'/0'" or "m/48'/0'/0'/2'"
+// BIP44-style purpose for a single-sig script type (44, 49, 84 or 86)
+uint32_t wallet_type_purpose(wallet_type_t type);
+// Script type implied by a single-sig purpose (unhardened value)
+bool wallet_type_from_purpose(uint32_t purpose, wallet_type_t *type_out);
+
+// scriptPubKey of a single-sig address for a compressed public key
+// Taproot applies the BIP86 tweak; script_out must hold
+// WALLY_WITNESSSCRIPT_MAX_LEN bytes
+bool wallet_script_from_pubkey(wallet_type_t type, const unsigned char *pub_key,
+                               unsigned char *script_out,
+                               size_t *script_len_out);
+
+// Format derivation path: "m/84'/0'/0'", "m/86'/0'/0'" or "m/48'/0'/0'/2'"
 int wallet_format_derivation_path(char *buf, size_t buf_size,
-                                  wallet_policy_t policy,
+                                  wallet_policy_t policy, wallet_type_t type,
                                   wallet_network_t network, uint32_t account);
 
-// Format compact derivation: "84h/0h/0h" or "48h/0h/0h/2h"
+// Format compact derivation: "84h/0h/0h", "86h/0h/0h" or "48h/0h/0h/2h"
 int wallet_format_derivation_compact(char *buf, size_t buf_size,
                                      wallet_policy_t policy,
+                                     wallet_type_t type,
                                      wallet_network_t network,
                                      uint32_t account);
 
 bool wallet_init(wallet_network_t network);
 bool wallet_is_initialized(void);
 wallet_type_t wallet_get_type(void);
+// Takes effect on the next wallet_init()
+bool wallet_set_type(wallet_type_t type);
 wallet_network_t wallet_get_network(void);
 const char *wallet_get_derivation(void);
 bool wallet_get_account_xpub(char **xpub_out);
@@ -52,6 +73,8 @@ bool wallet_set_policy(wallet_policy_t policy);
 // Descriptor management (for multisig)
 bool wallet_has_descriptor(void);
 bool wallet_load_descriptor(const char *descriptor_str);
+// Takes ownership of an already parsed descriptor (replaces any loaded one)
+void wallet_adopt_descriptor(struct wally_descriptor *descriptor);
 void wallet_clear_descriptor(void);
 bool wallet_get_descriptor_string(char **output);
 bool wallet_get_descriptor_checksum(char **output);
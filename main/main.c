@@ -6,6 +6,7 @@
 #include "pages/pin/pin_page.h"
 #include "pages/screensaver.h"
 #include "ui/assets/kern_logo_lvgl.h"
+#include "ui/nav.h"
 #include "ui/theme.h"
 #include "utils/bip39_filter.h"
 #include <bsp/display.h>
@@ -15,6 +16,7 @@
 #include <esp_log.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <job_executor.h>
 #include <lvgl.h>
 #include <nvs_flash.h>
 #include <wally_core.h>
@@ -44,10 +46,51 @@ static void screensaver_dismissed_cb(void) {
 
 static void session_expired_handler(void) {
   wallet_unload();
+  nav_clear();
   lv_obj_clean(lv_screen_active());
   screensaver_create(lv_screen_active(), screensaver_dismissed_cb);
 }
 
+// ---------------------------------------------------------------------------
+// Settings: apply brightness whenever it changes (e.g. while dragging the
+// slider, before the batch is committed)
+// ---------------------------------------------------------------------------
+
+static void setting_changed_cb(size_t id, uint16_t value, void *user_data) {
+  (void)user_data;
+  if (id == SETTING_BRIGHTNESS)
+    bsp_display_brightness_set(value);
+}
+
+// ---------------------------------------------------------------------------
+// Background jobs: results are delivered on the LVGL task
+// ---------------------------------------------------------------------------
+
+static void job_dispatch_async_cb(void *arg) {
+  (void)arg;
+  job_executor_dispatch();
+}
+
+#define JOB_NOTIFY_ATTEMPTS 3
+
+// Called from a worker; lv_async_call must run under the LVGL lock. It
+// allocates, so a failure is retried briefly before the executor is told
+// to try again on its next event.
+static bool job_notify_ui(void) {
+  for (int attempt = 0; attempt < JOB_NOTIFY_ATTEMPTS; attempt++) {
+    if (attempt > 0)
+      vTaskDelay(pdMS_TO_TICKS(10));
+    if (!lvgl_port_lock(0))
+      continue;
+    lv_result_t res = lv_async_call(job_dispatch_async_cb, NULL);
+    lvgl_port_unlock();
+    if (res == LV_RESULT_OK)
+      return true;
+  }
+  ESP_LOGE(TAG, "Failed to schedule job dispatch");
+  return false;
+}
+
 // ---------------------------------------------------------------------------
 
 void app_main(void) {
@@ -90,6 +133,7 @@ void app_main(void) {
 
   // Now turn on backlight
   bsp_display_brightness_set(settings_get_brightness());
+  settings_subscribe(setting_changed_cb, NULL);
 
   // Show animated logo splash screen
   kern_logo_animated(screen);
@@ -106,6 +150,12 @@ void app_main(void) {
     abort();
   }
 
+  // Worker pool for PBKDF2, seed derivation and other long operations
+  job_executor_config_t job_cfg = {.num_workers = 0, .notify = job_notify_ui};
+  if (!job_executor_init(&job_cfg)) {
+    abort();
+  }
+
   // Initialize BIP39 wordlist (needed for anti-phishing words)
   bip39_filter_init();
 
@@ -120,6 +170,7 @@ void app_main(void) {
 
   // Clear the screen
   lv_obj_clean(screen);
+  nav_init(screen);
 
   // PIN gate: if PIN is configured, require unlock before login
   if (pin_is_configured()) {
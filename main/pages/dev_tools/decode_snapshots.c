@@ -315,7 +315,7 @@ static void process_and_display_file(int index) {
 
   /* Decode QR codes */
   int num_codes = k_quirc_count(q);
-  k_quirc_result_t result;
+  k_quirc_result_t result = {0};
   bool decoded_ok = false;
   int version = 0;
   int payload_len = 0;
@@ -329,6 +329,7 @@ static void process_and_display_file(int index) {
       break;
     }
   }
+  k_quirc_result_free(&result);
 
   int num_grids = dbg ? dbg->num_grids : 0;
   int num_capstones = dbg ? dbg->num_capstones : 0;
@@ -153,7 +153,7 @@ static void decode_task(void *arg) {
       continue;
     }
 
-    k_quirc_result_t result;
+    k_quirc_result_t result = {0};
     int64_t start_time = esp_timer_get_time();
     int qr_count =
         k_quirc_decode_grayscale(gray_data, width, height, &result, 1, true);
@@ -167,6 +167,7 @@ static void decode_task(void *arg) {
       decode_result.failed_count++;
       ESP_LOGW(TAG, "%s: NO QR [%lld ms]", files[i], elapsed_us / 1000);
     }
+    k_quirc_result_free(&result);
 
     free(file_data);
   }
@@ -41,6 +41,18 @@ static char stored_addresses[NUM_ADDRESSES][128];
 static uint32_t stored_indices[NUM_ADDRESSES];
 static int stored_count = 0;
 
+// Wallet state the list was built for; a retained page is rebuilt on
+// resume only if this changed while it was hidden
+typedef struct {
+  wallet_network_t network;
+  wallet_type_t type;
+  wallet_policy_t policy;
+  uint32_t account;
+  char descriptor_checksum[9];
+} view_state_t;
+
+static view_state_t built_for;
+
 static lv_obj_t *scan_button = NULL;
 static char *scanned_address = NULL;
 static uint32_t scan_search_start = 0;
@@ -51,6 +63,20 @@ static void scan_button_cb(lv_event_t *e);
 static void return_from_scan_cb(void);
 static void perform_address_sweep(void);
 
+static void read_view_state(view_state_t *out) {
+  memset(out, 0, sizeof(*out));
+  out->network = wallet_get_network();
+  out->type = wallet_get_type();
+  out->policy = wallet_get_policy();
+  out->account = wallet_get_account();
+  char *checksum = NULL;
+  if (wallet_has_descriptor() && wallet_get_descriptor_checksum(&checksum)) {
+    snprintf(out->descriptor_checksum, sizeof(out->descriptor_checksum), "%s",
+             checksum);
+    free(checksum);
+  }
+}
+
 // Format address as 4-char blocks with alternating main/highlight colors
 static void format_address_colored_blocks(char *dest, size_t dest_size,
                                           const char *address) {
@@ -129,6 +155,7 @@ static void on_descriptor_loaded(void) {
     lv_obj_add_flag(load_descriptor_btn, LV_OBJ_FLAG_HIDDEN);
   if (btn_cont)
     lv_obj_clear_flag(btn_cont, LV_OBJ_FLAG_HIDDEN);
+  read_view_state(&built_for);
   refresh_address_list();
 }
 
@@ -599,6 +626,7 @@ void addresses_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
                         LV_FLEX_ALIGN_SPACE_EVENLY, LV_FLEX_ALIGN_CENTER);
   lv_obj_set_flex_grow(address_list_container, 1);
 
+  read_view_state(&built_for);
   refresh_address_list();
 
   // Back button (on parent for absolute positioning)
@@ -611,11 +639,40 @@ void addresses_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
 void addresses_page_show(void) {
   if (addresses_screen)
     lv_obj_clear_flag(addresses_screen, LV_OBJ_FLAG_HIDDEN);
+  if (back_button)
+    lv_obj_clear_flag(back_button, LV_OBJ_FLAG_HIDDEN);
+  if (settings_button)
+    lv_obj_clear_flag(settings_button, LV_OBJ_FLAG_HIDDEN);
 }
 
 void addresses_page_hide(void) {
   if (addresses_screen)
     lv_obj_add_flag(addresses_screen, LV_OBJ_FLAG_HIDDEN);
+  if (back_button)
+    lv_obj_add_flag(back_button, LV_OBJ_FLAG_HIDDEN);
+  if (settings_button)
+    lv_obj_add_flag(settings_button, LV_OBJ_FLAG_HIDDEN);
+}
+
+void addresses_page_resume(void) {
+  if (!addresses_screen)
+    return;
+
+  view_state_t now;
+  read_view_state(&now);
+  if (memcmp(&now, &built_for, sizeof(now)) != 0) {
+    void (*saved_callback)(void) = return_callback;
+    addresses_page_destroy();
+    addresses_page_create(lv_screen_active(), saved_callback);
+    return;
+  }
+
+  // Pages created while this one was hidden are stacked above it
+  lv_obj_move_foreground(addresses_screen);
+  if (back_button)
+    lv_obj_move_foreground(back_button);
+  if (settings_button)
+    lv_obj_move_foreground(settings_button);
 }
 
 void addresses_page_destroy(void) {
@@ -20,6 +20,12 @@ void addresses_page_show(void);
  */
 void addresses_page_hide(void);
 
+/**
+ * Reopen a hidden page kept alive by nav, keeping the page and offset it
+ * was left on. Rebuilds it if the wallet settings or descriptor changed.
+ */
+void addresses_page_resume(void);
+
 /**
  * Destroy the addresses page and free resources
  */
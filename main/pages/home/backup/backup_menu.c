@@ -1,6 +1,7 @@
 // Backup Menu Page
 
 #include "backup_menu.h"
+#include "../../../core/key.h"
 #include "../../../core/storage.h"
 #include "../../../ui/dialog.h"
 #include "../../../ui/menu.h"
@@ -8,6 +9,7 @@
 #include "../../store_mnemonic.h"
 #include "mnemonic_qr.h"
 #include "mnemonic_words.h"
+#include "slip39_shares.h"
 #include <lvgl.h>
 
 static ui_menu_t *backup_menu = NULL;
@@ -38,6 +40,16 @@ static void launch_qr(void) {
   mnemonic_qr_page_show();
 }
 
+static void return_from_slip39_shares_cb(void) {
+  slip39_shares_page_destroy();
+  backup_menu_page_show();
+}
+
+static void launch_slip39(void) {
+  slip39_shares_page_create(lv_screen_active(), return_from_slip39_shares_cb);
+  slip39_shares_page_show();
+}
+
 static void danger_confirm_cb(bool confirmed, void *user_data) {
   (void)user_data;
   if (!confirmed)
@@ -56,6 +68,8 @@ static void menu_words_cb(void) { warn_and_launch(launch_words); }
 
 static void menu_qr_cb(void) { warn_and_launch(launch_qr); }
 
+static void menu_slip39_cb(void) { warn_and_launch(launch_slip39); }
+
 /* --- Save to Flash / SD callbacks --- */
 
 static void return_from_store_cb(void) {
@@ -97,10 +111,16 @@ void backup_menu_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   if (!backup_menu)
     return;
 
-  ui_menu_add_entry(backup_menu, "Words", menu_words_cb);
-  ui_menu_add_entry(backup_menu, "QR Code", menu_qr_cb);
-  ui_menu_add_entry(backup_menu, "Save to Flash", menu_save_flash_cb);
-  ui_menu_add_entry(backup_menu, "Save to SD", menu_save_sd_cb);
+  // Keys recovered from SLIP-39 shares have no mnemonic to show or store
+  if (key_has_mnemonic()) {
+    ui_menu_add_entry(backup_menu, "Words", menu_words_cb);
+    ui_menu_add_entry(backup_menu, "QR Code", menu_qr_cb);
+  }
+  ui_menu_add_entry(backup_menu, "SLIP-39 Shares", menu_slip39_cb);
+  if (key_has_mnemonic()) {
+    ui_menu_add_entry(backup_menu, "Save to Flash", menu_save_flash_cb);
+    ui_menu_add_entry(backup_menu, "Save to SD", menu_save_sd_cb);
+  }
 }
 
 void backup_menu_page_show(void) {
@@ -112,6 +132,12 @@ void backup_menu_page_show(void) {
   }
 }
 
+void backup_menu_page_resume(void) {
+  // Pages created while this one was hidden are stacked above it
+  if (backup_menu_screen)
+    lv_obj_move_foreground(backup_menu_screen);
+}
+
 void backup_menu_page_hide(void) {
   if (backup_menu_screen) {
     lv_obj_add_flag(backup_menu_screen, LV_OBJ_FLAG_HIDDEN);
@@ -20,6 +20,11 @@ void backup_menu_page_create(lv_obj_t *parent, void (*return_cb)(void));
  */
 void backup_menu_page_show(void);
 
+/**
+ * Reopen a hidden backup menu kept alive by nav
+ */
+void backup_menu_page_resume(void);
+
 /**
  * Hide the backup menu page
  */
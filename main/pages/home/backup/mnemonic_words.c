@@ -3,9 +3,11 @@
 #include "mnemonic_words.h"
 #include "../../../core/key.h"
 #include "../../../ui/theme.h"
+#include "../../../utils/secure_mem.h"
 #include <lvgl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 static lv_obj_t *mnemonic_screen = NULL;
 static void (*return_callback)(void) = NULL;
@@ -16,22 +18,27 @@ static void back_cb(lv_event_t *e) {
     return_callback();
 }
 
-void mnemonic_words_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
-  if (!parent || !key_is_loaded())
-    return;
-
-  return_callback = return_cb;
-
-  char **words = NULL;
-  size_t word_count = 0;
-  if (!key_get_mnemonic_words(&words, &word_count))
-    return;
+static void create_column(lv_obj_t *parent, char **words, size_t first,
+                          size_t end) {
+  char word_list[512];
+  int offset = 0;
+  for (size_t i = first; i < end; i++) {
+    offset += snprintf(word_list + offset, sizeof(word_list) - offset,
+                       "%s%zu. %s", i > first ? "\n" : "", i + 1, words[i]);
+  }
+  lv_obj_t *label = theme_create_label(parent, word_list, false);
+  lv_obj_set_style_text_font(label, theme_font_medium(), 0);
+  lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, 0);
+  secure_memzero(word_list, sizeof(word_list));
+}
 
+static void create_page(lv_obj_t *parent, const char *title, char **words,
+                        size_t word_count) {
   mnemonic_screen = theme_create_page_container(parent);
   lv_obj_add_flag(mnemonic_screen, LV_OBJ_FLAG_CLICKABLE);
   lv_obj_add_event_cb(mnemonic_screen, back_cb, LV_EVENT_CLICKED, NULL);
 
-  theme_create_page_title(mnemonic_screen, "BIP39 Words");
+  theme_create_page_title(mnemonic_screen, title);
 
   lv_obj_t *content = lv_obj_create(mnemonic_screen);
   lv_obj_set_size(content, LV_PCT(100), LV_SIZE_CONTENT);
@@ -45,46 +52,61 @@ void mnemonic_words_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   lv_obj_set_flex_align(content, LV_FLEX_ALIGN_SPACE_EVENLY,
                         LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
 
-  char word_list[512];
-  int offset = 0;
-
-  if (word_count == 12) {
-    for (size_t i = 0; i < word_count; i++) {
-      offset += snprintf(word_list + offset, sizeof(word_list) - offset,
-                         "%s%zu. %s", i > 0 ? "\n" : "", i + 1, words[i]);
-    }
-    lv_obj_t *label = theme_create_label(content, word_list, false);
-    lv_obj_set_style_text_font(label, theme_font_medium(), 0);
-    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, 0);
-
-  } else if (word_count == 24) {
-    for (size_t i = 0; i < 12; i++) {
-      offset += snprintf(word_list + offset, sizeof(word_list) - offset,
-                         "%s%zu. %s", i > 0 ? "\n" : "", i + 1, words[i]);
-    }
-    lv_obj_t *left = theme_create_label(content, word_list, false);
-    lv_obj_set_style_text_font(left, theme_font_medium(), 0);
-    lv_obj_set_style_text_align(left, LV_TEXT_ALIGN_LEFT, 0);
-
-    offset = 0;
-    for (size_t i = 12; i < 24; i++) {
-      offset += snprintf(word_list + offset, sizeof(word_list) - offset,
-                         "%s%zu. %s", i > 12 ? "\n" : "", i + 1, words[i]);
-    }
-    lv_obj_t *right = theme_create_label(content, word_list, false);
-    lv_obj_set_style_text_font(right, theme_font_medium(), 0);
-    lv_obj_set_style_text_align(right, LV_TEXT_ALIGN_LEFT, 0);
+  // Up to 12 words in one column, otherwise two halves (18 as 9 + 9)
+  if (word_count <= 12) {
+    create_column(content, words, 0, word_count);
+  } else {
+    size_t half = (word_count + 1) / 2;
+    create_column(content, words, 0, half);
+    create_column(content, words, half, word_count);
   }
 
-  for (size_t i = 0; i < word_count; i++)
-    free(words[i]);
-  free(words);
-
   lv_obj_t *hint = theme_create_label(mnemonic_screen, "Tap to return", false);
   lv_obj_set_style_text_align(hint, LV_TEXT_ALIGN_CENTER, 0);
   lv_obj_align(hint, LV_ALIGN_BOTTOM_MID, 0, -theme_get_default_padding());
 }
 
+void mnemonic_words_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
+  if (!parent || !key_is_loaded())
+    return;
+
+  return_callback = return_cb;
+
+  char **words = NULL;
+  size_t word_count = 0;
+  if (!key_get_mnemonic_words(&words, &word_count))
+    return;
+
+  create_page(parent, "BIP39 Words", words, word_count);
+
+  for (size_t i = 0; i < word_count; i++)
+    SECURE_FREE_STRING(words[i]);
+  free(words);
+}
+
+void mnemonic_words_page_create_for(lv_obj_t *parent, void (*return_cb)(void),
+                                    const char *title, const char *mnemonic) {
+  if (!parent || !mnemonic)
+    return;
+
+  return_callback = return_cb;
+
+  size_t len = strlen(mnemonic);
+  char *copy = strdup(mnemonic);
+  if (!copy)
+    return;
+
+  char *words[24];
+  size_t word_count = 0;
+  for (char *token = strtok(copy, " "); token && word_count < 24;
+       token = strtok(NULL, " "))
+    words[word_count++] = token;
+
+  create_page(parent, title ? title : "BIP39 Words", words, word_count);
+  // strtok cut the copy into words; wipe all of it
+  SECURE_FREE_BUFFER(copy, len);
+}
+
 void mnemonic_words_page_show(void) {
   if (mnemonic_screen)
     lv_obj_clear_flag(mnemonic_screen, LV_OBJ_FLAG_HIDDEN);
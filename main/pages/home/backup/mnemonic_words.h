@@ -1,6 +1,6 @@
 /*
  * Mnemonic Words Backup Page
- * Displays BIP39 mnemonic words for backup
+ * Displays BIP39 mnemonic words for backup, or any given mnemonic
  */
 
 #ifndef MNEMONIC_WORDS_H
@@ -15,6 +15,16 @@
  */
 void mnemonic_words_page_create(lv_obj_t *parent, void (*return_cb)(void));
 
+/**
+ * Create the page for a mnemonic other than the loaded key's
+ * @param parent Parent LVGL object
+ * @param return_cb Callback to call when returning from this page
+ * @param title Page title (NULL for the default)
+ * @param mnemonic Space-separated words, up to 24 (copied)
+ */
+void mnemonic_words_page_create_for(lv_obj_t *parent, void (*return_cb)(void),
+                                    const char *title, const char *mnemonic);
+
 /**
  * Show the mnemonic words page
  */
@@ -0,0 +1,397 @@
+// SLIP-39 Shares Backup Page
+
+#include "slip39_shares.h"
+#include "../../../core/crypto_utils.h"
+#include "../../../core/key.h"
+#include "../../../ui/dialog.h"
+#include "../../../ui/menu.h"
+#include "../../../ui/theme.h"
+#include "../../../utils/secure_mem.h"
+#include "../../passphrase.h"
+#include <job_executor.h>
+#include <lvgl.h>
+#include <slip39.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wally_bip32.h>
+#include <wally_core.h>
+
+/*
+ * New backups are single-group sets, extendable (the identifier is not
+ * part of the encryption, so more shares can be made later) with
+ * iteration exponent 1. The Feistel encryption runs on the job executor.
+ *
+ * A mnemonic-loaded key is backed up by its BIP39 entropy. SLIP-39 uses
+ * the master secret directly as the BIP32 seed, so those shares restore a
+ * different wallet than the mnemonic does; its fingerprint is shown
+ * before anything is generated.
+ */
+
+#define ITERATION_EXPONENT 1
+#define WORDS_PER_COLUMN 11
+
+typedef struct {
+  uint8_t threshold;
+  uint8_t count;
+} scheme_t;
+
+static const scheme_t schemes[] = {{1, 1}, {2, 3}, {3, 5}};
+#define SCHEME_COUNT (sizeof(schemes) / sizeof(schemes[0]))
+
+static lv_obj_t *slip39_screen = NULL;
+static lv_obj_t *share_view = NULL;
+static lv_obj_t *progress_dialog = NULL;
+static ui_menu_t *scheme_menu = NULL;
+static void (*return_callback)(void) = NULL;
+
+static uint8_t secret[KEY_MAX_MASTER_SECRET];
+static size_t secret_len = 0;
+static scheme_t selected_scheme;
+static slip39_share_t shares[SLIP39_MAX_MEMBERS];
+static size_t share_count = 0;
+static size_t shown_share = 0;
+
+static job_t *split_job = NULL;
+
+typedef struct {
+  uint8_t secret[SLIP39_MAX_SECRET]; // Own copies: the job may outlive
+  size_t secret_len;                 // the page
+  char passphrase[SLIP39_MAX_PASSPHRASE + 1];
+  slip39_group_spec_t group;
+  slip39_share_t shares[SLIP39_MAX_MEMBERS];
+  size_t share_count;
+} split_scratch_t;
+
+static void show_scheme_menu(void);
+
+static void close_progress(void) {
+  if (progress_dialog) {
+    lv_obj_del(progress_dialog);
+    progress_dialog = NULL;
+  }
+}
+
+static void show_progress(uint8_t percent) {
+  char msg[32];
+  snprintf(msg, sizeof(msg), "Encrypting... %u%%", percent);
+  close_progress();
+  progress_dialog =
+      dialog_show_progress("SLIP-39", msg, DIALOG_STYLE_OVERLAY);
+}
+
+static void finish(void) {
+  if (return_callback)
+    return_callback();
+}
+
+/* ---------- Share display ---------- */
+
+static void show_share(void);
+
+static void share_tap_cb(lv_event_t *e) {
+  (void)e;
+  if (++shown_share < share_count)
+    show_share();
+  else
+    finish();
+}
+
+static void add_column(lv_obj_t *parent, const uint16_t *words, size_t first,
+                       size_t end) {
+  char text[WORDS_PER_COLUMN * 16];
+  int offset = 0;
+  for (size_t i = first; i < end; i++) {
+    offset += snprintf(text + offset, sizeof(text) - offset, "%s%zu. %s",
+                       i > first ? "\n" : "", i + 1, slip39_word(words[i]));
+  }
+  lv_obj_t *label = theme_create_label(parent, text, false);
+  lv_obj_set_style_text_font(label, theme_font_small(), 0);
+  lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_LEFT, 0);
+  secure_memzero(text, sizeof(text));
+}
+
+static void show_share(void) {
+  if (share_view) {
+    lv_obj_del(share_view);
+    share_view = NULL;
+  }
+
+  uint16_t words[SLIP39_MAX_SHARE_WORDS];
+  size_t count = slip39_share_encode(&shares[shown_share], words,
+                                     SLIP39_MAX_SHARE_WORDS);
+  if (!count) {
+    dialog_show_error("Failed to encode share", finish, 0);
+    return;
+  }
+
+  share_view = theme_create_page_container(slip39_screen);
+  lv_obj_add_flag(share_view, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_add_event_cb(share_view, share_tap_cb, LV_EVENT_CLICKED, NULL);
+
+  char title[48];
+  snprintf(title, sizeof(title), "Share %u/%u (%u needed)",
+           (unsigned)(shown_share + 1), (unsigned)share_count,
+           selected_scheme.threshold);
+  theme_create_page_title(share_view, title);
+
+  lv_obj_t *content = lv_obj_create(share_view);
+  lv_obj_set_size(content, LV_PCT(100), LV_SIZE_CONTENT);
+  lv_obj_set_style_pad_all(content, 0, 0);
+  lv_obj_set_style_border_width(content, 0, 0);
+  lv_obj_set_style_bg_opa(content, LV_OPA_TRANSP, 0);
+  lv_obj_set_flex_grow(content, 1);
+  lv_obj_add_flag(content, LV_OBJ_FLAG_EVENT_BUBBLE);
+  lv_obj_align(content, LV_ALIGN_CENTER, 0, 0);
+  lv_obj_set_flex_flow(content, LV_FLEX_FLOW_ROW);
+  lv_obj_set_flex_align(content, LV_FLEX_ALIGN_SPACE_EVENLY,
+                        LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+  // Even columns: 20 words as 2 x 10, 33 as 3 x 11
+  size_t columns = (count + WORDS_PER_COLUMN - 1) / WORDS_PER_COLUMN;
+  size_t per_column = (count + columns - 1) / columns;
+  for (size_t first = 0; first < count; first += per_column) {
+    size_t end = first + per_column < count ? first + per_column : count;
+    add_column(content, words, first, end);
+  }
+  secure_memzero(words, sizeof(words));
+
+  const char *hint =
+      shown_share + 1 < share_count ? "Tap for next share" : "Tap to return";
+  lv_obj_t *hint_label = theme_create_label(share_view, hint, false);
+  lv_obj_set_style_text_align(hint_label, LV_TEXT_ALIGN_CENTER, 0);
+  lv_obj_align(hint_label, LV_ALIGN_BOTTOM_MID, 0,
+               -theme_get_default_padding());
+}
+
+/* ---------- Generation ---------- */
+
+static void random_bytes(uint8_t *buf, size_t len) {
+  crypto_random_bytes(buf, len);
+}
+
+static bool split_progress(uint8_t percent, void *ctx) {
+  job_t *job = ctx;
+  job_report_progress(job, percent);
+  return !job_is_cancelled(job);
+}
+
+/* Runs on a worker — does NOT touch LVGL */
+static int split_run(job_t *job, void *scratch, void *ctx) {
+  (void)ctx;
+  split_scratch_t *s = scratch;
+
+  slip39_error_t err = slip39_split(
+      s->secret, s->secret_len, s->passphrase[0] ? s->passphrase : NULL,
+      true, ITERATION_EXPONENT, 1, &s->group, 1, random_bytes, s->shares,
+      SLIP39_MAX_MEMBERS, &s->share_count, split_progress, job);
+  secure_memzero(s->secret, sizeof(s->secret));
+  secure_memzero(s->passphrase, sizeof(s->passphrase));
+  return err;
+}
+
+static void split_progress_cb(uint8_t percent, void *ctx) {
+  (void)ctx;
+  if (split_job)
+    show_progress(percent);
+}
+
+/* Back on the LVGL task */
+static void split_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  split_scratch_t *s = scratch;
+  split_job = NULL;
+  close_progress();
+
+  if (result != SLIP39_OK) {
+    dialog_show_error(slip39_error_str((slip39_error_t)result), finish, 0);
+    return;
+  }
+
+  memcpy(shares, s->shares, sizeof(shares));
+  share_count = s->share_count;
+  shown_share = 0;
+  show_share();
+}
+
+static void start_split(const char *passphrase) {
+  if (split_job)
+    return;
+  if (passphrase && strlen(passphrase) > SLIP39_MAX_PASSPHRASE) {
+    dialog_show_error("Passphrase too long", show_scheme_menu, 0);
+    return;
+  }
+
+  split_scratch_t *init = malloc(sizeof(*init));
+  if (!init) {
+    dialog_show_error("Out of memory", finish, 0);
+    return;
+  }
+  memset(init, 0, sizeof(*init));
+  memcpy(init->secret, secret, secret_len);
+  init->secret_len = secret_len;
+  if (passphrase)
+    strncpy(init->passphrase, passphrase, sizeof(init->passphrase) - 1);
+  init->group.threshold = selected_scheme.threshold;
+  init->group.count = selected_scheme.count;
+
+  slip39_shares_page_show();
+  show_progress(0);
+
+  job_desc_t desc = {.run = split_run,
+                     .done = split_done,
+                     .progress = split_progress_cb,
+                     .scratch_init = init,
+                     .scratch_len = sizeof(*init)};
+  split_job = job_submit(&desc);
+  secure_memzero(init, sizeof(*init));
+  free(init);
+  if (!split_job) {
+    close_progress();
+    dialog_show_error("Failed to start encryption", finish, 0);
+  }
+}
+
+/* ---------- Options ---------- */
+
+static void passphrase_return_cb(void) {
+  passphrase_page_destroy();
+  slip39_shares_page_show();
+  show_scheme_menu();
+}
+
+static void passphrase_success_cb(const char *passphrase) {
+  // Copied into the job scratch before the page wipes it
+  start_split(passphrase);
+  passphrase_page_destroy();
+}
+
+static void passphrase_confirm_cb(bool confirmed, void *user_data) {
+  (void)user_data;
+  if (confirmed) {
+    slip39_shares_page_hide();
+    passphrase_page_create(lv_screen_active(), passphrase_return_cb,
+                           passphrase_success_cb);
+  } else {
+    start_split(NULL);
+  }
+}
+
+static void scheme_selected_cb(void) {
+  if (!scheme_menu)
+    return;
+  int selected = ui_menu_get_selected(scheme_menu);
+  if (selected < 0 || selected >= (int)SCHEME_COUNT)
+    return;
+  selected_scheme = schemes[selected];
+
+  ui_menu_destroy(scheme_menu);
+  scheme_menu = NULL;
+  dialog_show_confirm("Protect the shares with a passphrase?\n\n"
+                      "It will be needed to recover them.",
+                      passphrase_confirm_cb, NULL, DIALOG_STYLE_OVERLAY);
+}
+
+static void show_scheme_menu(void) {
+  if (scheme_menu)
+    ui_menu_destroy(scheme_menu);
+
+  scheme_menu = ui_menu_create(slip39_screen, "SLIP-39 Shares", finish);
+  if (!scheme_menu)
+    return;
+
+  for (size_t i = 0; i < SCHEME_COUNT; i++) {
+    char name[24];
+    snprintf(name, sizeof(name), "%u of %u shares", schemes[i].threshold,
+             schemes[i].count);
+    ui_menu_add_entry(scheme_menu, name, scheme_selected_cb);
+  }
+  ui_menu_show(scheme_menu);
+}
+
+static void different_wallet_cb(bool confirmed, void *user_data) {
+  (void)user_data;
+  if (confirmed)
+    show_scheme_menu();
+  else
+    finish();
+}
+
+void slip39_shares_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
+  if (!parent || !key_is_loaded())
+    return;
+
+  return_callback = return_cb;
+  share_count = 0;
+  shown_share = 0;
+
+  slip39_screen = theme_create_page_container(parent);
+
+  if (!key_get_entropy(secret, &secret_len) ||
+      secret_len < SLIP39_MIN_SECRET || secret_len % 2) {
+    dialog_show_error("Key cannot be split", finish, 0);
+    return;
+  }
+
+  if (!key_has_mnemonic()) {
+    show_scheme_menu();
+    return;
+  }
+
+  // Fingerprint of the wallet these shares restore
+  struct ext_key *master_key = NULL;
+  unsigned char fp[BIP32_KEY_FINGERPRINT_LEN];
+  if (bip32_key_from_seed_alloc(secret, secret_len, BIP32_VER_MAIN_PRIVATE, 0,
+                                &master_key) != WALLY_OK) {
+    dialog_show_error("Failed to derive key", finish, 0);
+    return;
+  }
+  bip32_key_get_fingerprint(master_key, fp, BIP32_KEY_FINGERPRINT_LEN);
+  bip32_key_free(master_key);
+
+  char msg[200];
+  snprintf(msg, sizeof(msg),
+           "Shares made from this mnemonic restore a different wallet, "
+           "fingerprint %02x%02x%02x%02x, not this one.\n\nContinue?",
+           fp[0], fp[1], fp[2], fp[3]);
+  dialog_show_confirm(msg, different_wallet_cb, NULL, DIALOG_STYLE_OVERLAY);
+}
+
+void slip39_shares_page_show(void) {
+  if (slip39_screen)
+    lv_obj_clear_flag(slip39_screen, LV_OBJ_FLAG_HIDDEN);
+  if (scheme_menu)
+    ui_menu_show(scheme_menu);
+}
+
+void slip39_shares_page_hide(void) {
+  if (slip39_screen)
+    lv_obj_add_flag(slip39_screen, LV_OBJ_FLAG_HIDDEN);
+  if (scheme_menu)
+    ui_menu_hide(scheme_menu);
+}
+
+void slip39_shares_page_destroy(void) {
+  /* A running job finishes on its own copies; only delivery is suppressed */
+  if (split_job) {
+    job_cancel(split_job);
+    split_job = NULL;
+  }
+  close_progress();
+  if (scheme_menu) {
+    ui_menu_destroy(scheme_menu);
+    scheme_menu = NULL;
+  }
+  if (slip39_screen) {
+    lv_obj_del(slip39_screen);
+    slip39_screen = NULL;
+  }
+  share_view = NULL;
+
+  secure_memzero(secret, sizeof(secret));
+  secret_len = 0;
+  secure_memzero(shares, sizeof(shares));
+  share_count = 0;
+  shown_share = 0;
+  return_callback = NULL;
+}
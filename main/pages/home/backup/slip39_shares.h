@@ -0,0 +1,33 @@
+/*
+ * SLIP-39 Shares Backup Page
+ * Splits the loaded key's secret into a new set of Shamir shares
+ */
+
+#ifndef SLIP39_SHARES_H
+#define SLIP39_SHARES_H
+
+#include <lvgl.h>
+
+/**
+ * Create the SLIP-39 shares page
+ * @param parent Parent LVGL object
+ * @param return_cb Callback to call when returning from this page
+ */
+void slip39_shares_page_create(lv_obj_t *parent, void (*return_cb)(void));
+
+/**
+ * Show the SLIP-39 shares page
+ */
+void slip39_shares_page_show(void);
+
+/**
+ * Hide the SLIP-39 shares page
+ */
+void slip39_shares_page_hide(void);
+
+/**
+ * Destroy the SLIP-39 shares page and free resources
+ */
+void slip39_shares_page_destroy(void);
+
+#endif // SLIP39_SHARES_H
@@ -0,0 +1,396 @@
+// BIP85 Child Page
+
+#include "bip85_child.h"
+#include "../../core/key.h"
+#include "../../qr/viewer.h"
+#include "../../ui/dialog.h"
+#include "../../ui/input_helpers.h"
+#include "../../ui/menu.h"
+#include "../../ui/theme.h"
+#include "../../utils/secure_mem.h"
+#include "backup/mnemonic_words.h"
+#include <lvgl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * One menu entry per application. The result screen steps through
+ * indices; key.c keeps the hardened parent of the selected application,
+ * so each step derives a single child.
+ */
+
+typedef struct {
+  const char *name;
+  bip85_app_t app;
+  uint32_t param;
+} child_type_t;
+
+static const child_type_t child_types[] = {
+    {"12 Words", BIP85_APP_BIP39, 12},
+    {"18 Words", BIP85_APP_BIP39, 18},
+    {"24 Words", BIP85_APP_BIP39, 24},
+    {"Hex, 32 Bytes", BIP85_APP_HEX, 32},
+    {"Password, Base64", BIP85_APP_PWD_BASE64, 21},
+    {"Password, Base85", BIP85_APP_PWD_BASE85, 20},
+};
+#define CHILD_TYPE_COUNT (sizeof(child_types) / sizeof(child_types[0]))
+
+static lv_obj_t *bip85_screen = NULL;
+static lv_obj_t *result_view = NULL;
+static lv_obj_t *index_label = NULL;
+static lv_obj_t *output_label = NULL;
+static ui_menu_t *type_menu = NULL;
+static void (*return_callback)(void) = NULL;
+
+static const child_type_t *selected_type = NULL;
+static uint32_t child_index = 0;
+static char *child_output = NULL;
+
+static lv_obj_t *index_overlay = NULL;
+static lv_obj_t *index_numpad = NULL;
+static lv_obj_t *index_input_label = NULL;
+static char index_input_buffer[12];
+static int index_input_len = 0;
+
+static const char *numpad_map[] = {"1",
+                                   "2",
+                                   "3",
+                                   "\n",
+                                   "4",
+                                   "5",
+                                   "6",
+                                   "\n",
+                                   "7",
+                                   "8",
+                                   "9",
+                                   "\n",
+                                   LV_SYMBOL_BACKSPACE,
+                                   "0",
+                                   LV_SYMBOL_OK,
+                                   ""};
+
+static void show_type_menu(void);
+
+static void finish(void) {
+  if (return_callback)
+    return_callback();
+}
+
+static void clear_output(void) { SECURE_FREE_STRING(child_output); }
+
+/* ---------- Result ---------- */
+
+static void close_result(void) {
+  if (result_view) {
+    lv_obj_del(result_view);
+    result_view = NULL;
+    index_label = NULL;
+    output_label = NULL;
+  }
+  clear_output();
+}
+
+static void update_result(void) {
+  clear_output();
+  if (!key_bip85_derive(selected_type->app, selected_type->param, child_index,
+                        &child_output)) {
+    close_result();
+    dialog_show_error("Derivation failed", show_type_menu, 0);
+    return;
+  }
+
+  char text[24];
+  snprintf(text, sizeof(text), "Index %u", (unsigned)child_index);
+  lv_label_set_text(index_label, text);
+  lv_label_set_text(output_label, child_output);
+}
+
+static void prev_cb(lv_event_t *e) {
+  (void)e;
+  if (child_index > 0) {
+    child_index--;
+    update_result();
+  }
+}
+
+static void next_cb(lv_event_t *e) {
+  (void)e;
+  if (child_index < BIP85_MAX_INDEX) {
+    child_index++;
+    update_result();
+  }
+}
+
+static void return_from_words_cb(void) {
+  mnemonic_words_page_destroy();
+  bip85_child_page_show();
+}
+
+static void words_cb(lv_event_t *e) {
+  (void)e;
+  if (!child_output)
+    return;
+  bip85_child_page_hide();
+  mnemonic_words_page_create_for(lv_screen_active(), return_from_words_cb,
+                                 selected_type->name, child_output);
+  mnemonic_words_page_show();
+}
+
+static void return_from_qr_cb(void) {
+  qr_viewer_page_destroy();
+  bip85_child_page_show();
+}
+
+static void qr_cb(lv_event_t *e) {
+  (void)e;
+  if (!child_output)
+    return;
+  bip85_child_page_hide();
+  qr_viewer_page_create(lv_screen_active(), child_output, selected_type->name,
+                        return_from_qr_cb);
+  qr_viewer_page_show();
+}
+
+static void result_back_cb(lv_event_t *e) {
+  (void)e;
+  close_result();
+  show_type_menu();
+}
+
+/* ---------- Index entry ---------- */
+
+static void update_index_input_display(void) {
+  if (!index_input_label)
+    return;
+  char display[14];
+  if (index_input_len == 0) {
+    snprintf(display, sizeof(display), "_");
+  } else {
+    snprintf(display, sizeof(display), "%s_", index_input_buffer);
+  }
+  lv_label_set_text(index_input_label, display);
+}
+
+static void update_numpad_buttons(void) {
+  if (!index_numpad)
+    return;
+
+  bool empty = (index_input_len == 0);
+  if (empty) {
+    lv_btnmatrix_set_btn_ctrl(index_numpad, 12, LV_BTNMATRIX_CTRL_DISABLED);
+    lv_btnmatrix_set_btn_ctrl(index_numpad, 14, LV_BTNMATRIX_CTRL_DISABLED);
+  } else {
+    lv_btnmatrix_clear_btn_ctrl(index_numpad, 12, LV_BTNMATRIX_CTRL_DISABLED);
+    lv_btnmatrix_clear_btn_ctrl(index_numpad, 14, LV_BTNMATRIX_CTRL_DISABLED);
+  }
+}
+
+static void close_index_overlay(void) {
+  if (index_overlay) {
+    lv_obj_del(index_overlay);
+    index_overlay = NULL;
+    index_numpad = NULL;
+    index_input_label = NULL;
+  }
+}
+
+static void numpad_event_cb(lv_event_t *e) {
+  lv_obj_t *btnm = lv_event_get_target(e);
+  uint32_t btn_id = lv_btnmatrix_get_selected_btn(btnm);
+  const char *txt = lv_btnmatrix_get_btn_text(btnm, btn_id);
+
+  if (strcmp(txt, LV_SYMBOL_OK) == 0) {
+    close_index_overlay();
+    if (index_input_len > 0) {
+      unsigned long val = strtoul(index_input_buffer, NULL, 10);
+      if (val <= BIP85_MAX_INDEX && val != child_index) {
+        child_index = (uint32_t)val;
+        update_result();
+      }
+    }
+  } else if (strcmp(txt, LV_SYMBOL_BACKSPACE) == 0) {
+    if (index_input_len > 0) {
+      index_input_len--;
+      index_input_buffer[index_input_len] = '\0';
+      update_index_input_display();
+      update_numpad_buttons();
+    }
+  } else if (index_input_len < 10) {
+    index_input_buffer[index_input_len++] = txt[0];
+    index_input_buffer[index_input_len] = '\0';
+    update_index_input_display();
+    update_numpad_buttons();
+  }
+}
+
+static void index_btn_cb(lv_event_t *e) {
+  (void)e;
+  index_input_len = snprintf(index_input_buffer, sizeof(index_input_buffer),
+                             "%u", (unsigned)child_index);
+
+  index_overlay = lv_obj_create(lv_screen_active());
+  lv_obj_remove_style_all(index_overlay);
+  lv_obj_set_size(index_overlay, LV_PCT(100), LV_PCT(100));
+  lv_obj_set_style_bg_color(index_overlay, lv_color_black(), 0);
+  lv_obj_set_style_bg_opa(index_overlay, LV_OPA_50, 0);
+  lv_obj_add_flag(index_overlay, LV_OBJ_FLAG_CLICKABLE);
+
+  lv_obj_t *modal = lv_obj_create(index_overlay);
+  lv_obj_set_size(modal, LV_PCT(80), LV_PCT(80));
+  lv_obj_center(modal);
+  theme_apply_frame(modal);
+  lv_obj_set_style_bg_opa(modal, LV_OPA_90, 0);
+  lv_obj_clear_flag(modal, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_flex_flow(modal, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_flex_align(modal, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER,
+                        LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_pad_all(modal, theme_get_default_padding(), 0);
+  lv_obj_set_style_pad_gap(modal, 15, 0);
+
+  lv_obj_t *title = lv_label_create(modal);
+  lv_label_set_text(title, "Index");
+  lv_obj_set_style_text_font(title, theme_font_medium(), 0);
+  lv_obj_set_style_text_color(title, main_color(), 0);
+
+  index_input_label = lv_label_create(modal);
+  lv_obj_set_style_text_font(index_input_label, theme_font_medium(), 0);
+  lv_obj_set_style_text_color(index_input_label, highlight_color(), 0);
+  update_index_input_display();
+
+  index_numpad = lv_btnmatrix_create(modal);
+  lv_btnmatrix_set_map(index_numpad, numpad_map);
+  lv_obj_set_size(index_numpad, LV_PCT(100), LV_PCT(70));
+  lv_obj_set_flex_grow(index_numpad, 1);
+  theme_apply_btnmatrix(index_numpad);
+  lv_obj_add_event_cb(index_numpad, numpad_event_cb, LV_EVENT_VALUE_CHANGED,
+                      NULL);
+
+  update_numpad_buttons();
+}
+
+/* ---------- Layout ---------- */
+
+static lv_obj_t *add_button(lv_obj_t *parent, const char *text, bool primary,
+                            lv_event_cb_t cb) {
+  lv_obj_t *btn = theme_create_button(parent, text, primary);
+  lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
+  return btn;
+}
+
+static void show_result(void) {
+  result_view = theme_create_page_container(bip85_screen);
+  lv_obj_set_flex_flow(result_view, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_flex_align(result_view, LV_FLEX_ALIGN_START,
+                        LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_pad_gap(result_view, theme_get_default_padding(), 0);
+
+  theme_create_page_title(result_view, selected_type->name);
+
+  lv_obj_t *index_row = theme_create_flex_row(result_view);
+  add_button(index_row, LV_SYMBOL_LEFT, false, prev_cb);
+  lv_obj_t *index_btn = add_button(index_row, "", false, index_btn_cb);
+  index_label = lv_obj_get_child(index_btn, 0);
+  add_button(index_row, LV_SYMBOL_RIGHT, false, next_cb);
+
+  output_label = theme_create_label(result_view, "", false);
+  lv_obj_set_width(output_label, LV_PCT(95));
+  lv_label_set_long_mode(output_label, LV_LABEL_LONG_WRAP);
+  lv_obj_set_style_text_align(output_label, LV_TEXT_ALIGN_CENTER, 0);
+  lv_obj_set_flex_grow(output_label, 1);
+
+  lv_obj_t *action_row = theme_create_flex_row(result_view);
+  if (selected_type->app == BIP85_APP_BIP39)
+    add_button(action_row, "Words", true, words_cb);
+  add_button(action_row, "QR Code", true, qr_cb);
+
+  lv_obj_t *back_btn = ui_create_back_button(result_view, result_back_cb);
+  lv_obj_add_flag(back_btn, LV_OBJ_FLAG_IGNORE_LAYOUT);
+
+  update_result();
+}
+
+static void type_selected_cb(void) {
+  if (!type_menu)
+    return;
+  int selected = ui_menu_get_selected(type_menu);
+  if (selected < 0 || selected >= (int)CHILD_TYPE_COUNT)
+    return;
+  selected_type = &child_types[selected];
+  child_index = 0;
+
+  ui_menu_destroy(type_menu);
+  type_menu = NULL;
+  show_result();
+}
+
+static void show_type_menu(void) {
+  if (type_menu)
+    ui_menu_destroy(type_menu);
+
+  type_menu = ui_menu_create(bip85_screen, "BIP85", finish);
+  if (!type_menu)
+    return;
+
+  for (size_t i = 0; i < CHILD_TYPE_COUNT; i++)
+    ui_menu_add_entry(type_menu, child_types[i].name, type_selected_cb);
+  ui_menu_show(type_menu);
+}
+
+static void danger_confirm_cb(bool confirmed, void *user_data) {
+  (void)user_data;
+  if (confirmed)
+    show_type_menu();
+  else
+    finish();
+}
+
+void bip85_child_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
+  if (!parent || !key_is_loaded())
+    return;
+
+  return_callback = return_cb;
+  selected_type = NULL;
+  child_index = 0;
+
+  bip85_screen = theme_create_page_container(parent);
+
+  dialog_show_danger_confirm(DIALOG_SENSITIVE_DATA_WARNING, danger_confirm_cb,
+                             NULL, DIALOG_STYLE_OVERLAY);
+}
+
+void bip85_child_page_show(void) {
+  if (bip85_screen)
+    lv_obj_clear_flag(bip85_screen, LV_OBJ_FLAG_HIDDEN);
+  if (type_menu)
+    ui_menu_show(type_menu);
+}
+
+void bip85_child_page_hide(void) {
+  if (bip85_screen)
+    lv_obj_add_flag(bip85_screen, LV_OBJ_FLAG_HIDDEN);
+  if (type_menu)
+    ui_menu_hide(type_menu);
+}
+
+void bip85_child_page_destroy(void) {
+  close_index_overlay();
+  if (type_menu) {
+    ui_menu_destroy(type_menu);
+    type_menu = NULL;
+  }
+  if (bip85_screen) {
+    lv_obj_del(bip85_screen);
+    bip85_screen = NULL;
+  }
+  result_view = NULL;
+  index_label = NULL;
+  output_label = NULL;
+  clear_output();
+
+  selected_type = NULL;
+  child_index = 0;
+  secure_memzero(index_input_buffer, sizeof(index_input_buffer));
+  index_input_len = 0;
+  return_callback = NULL;
+}
@@ -0,0 +1,33 @@
+/*
+ * BIP85 Child Page
+ * Derives child mnemonics, hex entropy and passwords from the loaded key
+ */
+
+#ifndef BIP85_CHILD_H
+#define BIP85_CHILD_H
+
+#include <lvgl.h>
+
+/**
+ * Create the BIP85 child page
+ * @param parent Parent LVGL object
+ * @param return_cb Callback to call when returning from this page
+ */
+void bip85_child_page_create(lv_obj_t *parent, void (*return_cb)(void));
+
+/**
+ * Show the BIP85 child page
+ */
+void bip85_child_page_show(void);
+
+/**
+ * Hide the BIP85 child page
+ */
+void bip85_child_page_hide(void);
+
+/**
+ * Destroy the BIP85 child page and free resources
+ */
+void bip85_child_page_destroy(void);
+
+#endif // BIP85_CHILD_H
@@ -5,11 +5,14 @@
 #include "../../ui/input_helpers.h"
 #include "../../ui/key_info.h"
 #include "../../ui/menu.h"
+#include "../../ui/nav.h"
 #include "../../ui/theme.h"
 #include "../settings/wallet_settings.h"
+#include "../sign/message_page.h"
 #include "../sign/sign.h"
 #include "addresses.h"
 #include "backup/backup_menu.h"
+#include "bip85_child.h"
 #include "public_key.h"
 #include <esp_log.h>
 #include <esp_system.h>
@@ -22,29 +25,82 @@ static void menu_backup_cb(void);
 static void menu_xpub_cb(void);
 static void menu_addresses_cb(void);
 static void menu_sign_cb(void);
+static void menu_message_cb(void);
+static void menu_bip85_cb(void);
 static void return_from_backup_menu_cb(void);
 static void return_from_public_key_cb(void);
 static void return_from_addresses_cb(void);
 static void return_from_sign_cb(void);
+static void return_from_message_cb(void);
+static void return_from_bip85_cb(void);
 static void return_from_wallet_settings_cb(void);
 
-static void menu_backup_cb(void) {
+// Approximate LVGL footprint of the pages nav keeps alive once left
+#define ADDRESSES_RETAIN_BYTES (8 * 1024)
+#define BACKUP_MENU_RETAIN_BYTES (3 * 1024)
+
+static void addresses_nav_create(void *parent, void *params) {
+  (void)params;
+  addresses_page_create(parent, return_from_addresses_cb);
+}
+
+static void addresses_nav_resume(void *params) {
+  (void)params;
+  addresses_page_resume();
+}
+
+// Keeps the list, receive/change choice and offset, and skips re-deriving
+// the addresses when reopened from home
+static const nav_page_t addresses_nav_page = {
+    .id = "addresses",
+    .create = addresses_nav_create,
+    .show = addresses_page_show,
+    .hide = addresses_page_hide,
+    .destroy = addresses_page_destroy,
+    .resume = addresses_nav_resume,
+    .retain_bytes = ADDRESSES_RETAIN_BYTES,
+};
+
+static void backup_menu_nav_create(void *parent, void *params) {
+  (void)params;
+  backup_menu_page_create(parent, return_from_backup_menu_cb);
+}
+
+static void backup_menu_nav_resume(void *params) {
+  (void)params;
+  backup_menu_page_resume();
+}
+
+// Only the menu is retained; the pages showing the mnemonic or shares are
+// opened outside nav and destroyed on return
+static const nav_page_t backup_menu_nav_page = {
+    .id = "backup_menu",
+    .create = backup_menu_nav_create,
+    .show = backup_menu_page_show,
+    .hide = backup_menu_page_hide,
+    .destroy = backup_menu_page_destroy,
+    .resume = backup_menu_nav_resume,
+    .retain_bytes = BACKUP_MENU_RETAIN_BYTES,
+};
+
+static nav_page_handle_t addresses_nav = NAV_INVALID_PAGE;
+static nav_page_handle_t backup_menu_nav = NAV_INVALID_PAGE;
+
+static void push_sub_page(nav_page_handle_t page) {
   home_page_hide();
-  backup_menu_page_create(lv_screen_active(), return_from_backup_menu_cb);
-  backup_menu_page_show();
+  if (!nav_push_handle(page, NULL))
+    home_page_show();
 }
 
+static void menu_backup_cb(void) { push_sub_page(backup_menu_nav); }
+
 static void menu_xpub_cb(void) {
   home_page_hide();
   public_key_page_create(lv_screen_active(), return_from_public_key_cb);
   public_key_page_show();
 }
 
-static void menu_addresses_cb(void) {
-  home_page_hide();
-  addresses_page_create(lv_screen_active(), return_from_addresses_cb);
-  addresses_page_show();
-}
+static void menu_addresses_cb(void) { push_sub_page(addresses_nav); }
 
 static void menu_sign_cb(void) {
   home_page_hide();
@@ -52,6 +108,18 @@ static void menu_sign_cb(void) {
   sign_page_show();
 }
 
+static void menu_message_cb(void) {
+  home_page_hide();
+  message_page_create(lv_screen_active(), return_from_message_cb);
+  message_page_show();
+}
+
+static void menu_bip85_cb(void) {
+  home_page_hide();
+  bip85_child_page_create(lv_screen_active(), return_from_bip85_cb);
+  bip85_child_page_show();
+}
+
 static void reboot_confirmed_cb(bool result, void *user_data) {
   (void)user_data;
   if (result) {
@@ -76,7 +144,7 @@ static void refresh_home_if_needed(void) {
 }
 
 static void return_from_backup_menu_cb(void) {
-  backup_menu_page_destroy();
+  nav_pop();
   home_page_show();
 }
 
@@ -86,7 +154,7 @@ static void return_from_public_key_cb(void) {
 }
 
 static void return_from_addresses_cb(void) {
-  addresses_page_destroy();
+  nav_pop();
   refresh_home_if_needed();
 }
 
@@ -95,6 +163,16 @@ static void return_from_sign_cb(void) {
   home_page_show();
 }
 
+static void return_from_message_cb(void) {
+  message_page_destroy();
+  home_page_show();
+}
+
+static void return_from_bip85_cb(void) {
+  bip85_child_page_destroy();
+  home_page_show();
+}
+
 static void settings_button_cb(lv_event_t *e) {
   (void)e;
   home_page_hide();
@@ -112,6 +190,11 @@ void home_page_create(lv_obj_t *parent) {
   if (!parent || !key_is_loaded() || !wallet_is_initialized())
     return;
 
+  if (addresses_nav == NAV_INVALID_PAGE)
+    addresses_nav = nav_register(&addresses_nav_page);
+  if (backup_menu_nav == NAV_INVALID_PAGE)
+    backup_menu_nav = nav_register(&backup_menu_nav_page);
+
   home_screen = theme_create_page_container(parent);
 
   main_menu = ui_menu_create(home_screen, "", NULL);
@@ -125,9 +208,11 @@ void home_page_create(lv_obj_t *parent) {
   lv_obj_move_to_index(header, 0);
 
   ui_menu_add_entry(main_menu, "Sign", menu_sign_cb);
+  ui_menu_add_entry(main_menu, "Message", menu_message_cb);
   ui_menu_add_entry(main_menu, "Extended Public Key", menu_xpub_cb);
   ui_menu_add_entry(main_menu, "Addresses", menu_addresses_cb);
   ui_menu_add_entry(main_menu, "Back Up", menu_backup_cb);
+  ui_menu_add_entry(main_menu, "BIP85", menu_bip85_cb);
 
   // Power button (reboot) at top-left
   power_button = ui_create_power_button(home_screen, power_button_cb);
@@ -155,6 +240,9 @@ void home_page_hide(void) {
 }
 
 void home_page_destroy(void) {
+  // Retained sub-pages were built for the settings being replaced
+  nav_drop_retained();
+
   if (power_button) {
     lv_obj_del(power_button);
     power_button = NULL;
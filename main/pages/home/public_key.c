@@ -50,7 +50,7 @@ void public_key_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   char derivation_compact[32];
   wallet_format_derivation_compact(
       derivation_compact, sizeof(derivation_compact), wallet_get_policy(),
-      wallet_get_network(), wallet_get_account());
+      wallet_get_type(), wallet_get_network(), wallet_get_account());
 
   public_key_screen = lv_obj_create(parent);
   lv_obj_set_size(public_key_screen, LV_PCT(100), LV_PCT(100));
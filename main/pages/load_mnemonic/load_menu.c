@@ -12,6 +12,7 @@
 #include "../shared/key_confirmation.h"
 #include "load_storage.h"
 #include "manual_input.h"
+#include "slip39_input.h"
 #include <lvgl.h>
 #include <stdlib.h>
 
@@ -116,6 +117,27 @@ static void from_manual_input_cb(void) {
   manual_input_page_show();
 }
 
+/* --- SLIP-39 shares --- */
+
+static void return_from_slip39_cb(void) {
+  slip39_input_page_destroy();
+  load_menu_page_show();
+}
+
+static void success_from_slip39_cb(void) {
+  slip39_input_page_destroy();
+  load_menu_page_destroy();
+  home_page_create(lv_screen_active());
+  home_page_show();
+}
+
+static void from_slip39_cb(void) {
+  load_menu_page_hide();
+  slip39_input_page_create(lv_screen_active(), return_from_slip39_cb,
+                           success_from_slip39_cb);
+  slip39_input_page_show();
+}
+
 /* --- Load from Flash / SD --- */
 
 static void return_from_storage_cb(void) {
@@ -165,6 +187,7 @@ void load_menu_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
 
   ui_menu_add_entry(load_menu, "From QR Code", from_qr_code_cb);
   ui_menu_add_entry(load_menu, "From Manual Input", from_manual_input_cb);
+  ui_menu_add_entry(load_menu, "From SLIP-39 Shares", from_slip39_cb);
   ui_menu_add_entry(load_menu, "From Flash", from_flash_cb);
   ui_menu_add_entry(load_menu, "From SD Card", from_sd_cb);
   ui_menu_show(load_menu);
@@ -21,7 +21,7 @@ typedef enum {
   MODE_WORD_SELECT
 } input_mode_t;
 
-#define MAX_MNEMONIC_LEN 256
+#define MAX_MNEMONIC_LEN 512
 
 static lv_obj_t *manual_input_screen = NULL;
 static lv_obj_t *back_btn = NULL;
@@ -67,6 +67,16 @@ static void filter_words_by_prefix(void) {
   }
 }
 
+// Filter over every language that holds all the words entered so far;
+// the first word usually settles it
+static void update_languages(void) {
+  const char *words[24];
+  for (int i = 0; i < current_word_index; i++)
+    words[i] = entered_words[i];
+  bip39_filter_set_languages(
+      bip39_filter_detect_languages(words, current_word_index));
+}
+
 static void cleanup_ui(void) {
   if (back_btn) {
     lv_obj_del(back_btn);
@@ -102,6 +112,7 @@ static void word_confirmation_cb(bool confirmed, void *user_data) {
     prefix_len = 0;
     current_prefix[0] = '\0';
     pending_word[0] = '\0';
+    update_languages();
     cleanup_ui();
 
     if (current_word_index >= total_words) {
@@ -234,6 +245,7 @@ static void on_word_count_selected(int word_count) {
   prefix_len = 0;
   current_prefix[0] = '\0';
   secure_memzero(entered_words, sizeof(entered_words));
+  update_languages();
   create_keyboard_input();
 }
 
@@ -262,6 +274,7 @@ static void keyboard_callback(char key) {
       current_prefix[BIP39_MAX_PREFIX_LEN] = '\0';
       prefix_len = strlen(current_prefix);
       entered_words[current_word_index][0] = '\0';
+      update_languages();
       update_keyboard_state();
     }
   } else if (key == UI_KB_OK) {
@@ -306,6 +319,7 @@ static void back_cb(void) {
       current_prefix[BIP39_MAX_PREFIX_LEN] = '\0';
       prefix_len = strlen(current_prefix);
       entered_words[current_word_index][0] = '\0';
+      update_languages();
       update_keyboard_state();
     } else {
       create_word_count_menu();
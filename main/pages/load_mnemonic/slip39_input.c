@@ -0,0 +1,607 @@
+// SLIP-39 Share Input Page - Shamir share entry and master secret recovery
+
+#include "slip39_input.h"
+#include "../../core/key.h"
+#include "../../core/settings.h"
+#include "../../core/wallet.h"
+#include "../../ui/dialog.h"
+#include "../../ui/input_helpers.h"
+#include "../../ui/keyboard.h"
+#include "../../ui/menu.h"
+#include "../../ui/theme.h"
+#include "../../utils/secure_mem.h"
+#include "../passphrase.h"
+#include <job_executor.h>
+#include <lvgl.h>
+#include <slip39.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wally_bip32.h>
+#include <wally_core.h>
+
+/*
+ * Words are kept as wordlist indices; a share is decoded and checked
+ * (RS1024) as soon as its last word is confirmed, then added to the set,
+ * which enforces that every share belongs to the same backup. The
+ * Feistel decryption (PBKDF2, 10000 << e iterations) runs on the job
+ * executor with per-round progress.
+ */
+
+typedef enum {
+  MODE_LENGTH_SELECT,
+  MODE_KEYBOARD_INPUT,
+  MODE_WORD_SELECT,
+  MODE_RECOVERING
+} input_mode_t;
+
+#define MAX_LISTED_WORDS 8
+
+// Secret lengths a share can carry, by common BIP39 entropy size
+static const uint8_t secret_lengths[] = {16, 20, 24, 28, 32};
+#define SECRET_LENGTH_COUNT (sizeof(secret_lengths) / sizeof(secret_lengths[0]))
+
+static lv_obj_t *slip39_screen = NULL;
+static lv_obj_t *back_btn = NULL;
+static lv_obj_t *progress_dialog = NULL;
+static ui_menu_t *current_menu = NULL;
+static ui_keyboard_t *keyboard = NULL;
+static void (*return_callback)(void) = NULL;
+static void (*success_callback)(void) = NULL;
+
+static slip39_set_t share_set;
+static uint16_t share_words[SLIP39_MAX_SHARE_WORDS];
+static size_t total_words = 0; // 0 until the share length is chosen
+static size_t current_word_index = 0;
+static char current_prefix[SLIP39_MAX_WORD_LEN + 1];
+static size_t prefix_len = 0;
+static uint16_t pending_word = 0;
+static input_mode_t current_mode = MODE_LENGTH_SELECT;
+
+// Recovered master secret awaiting the user's fingerprint confirmation
+static uint8_t recovered_secret[SLIP39_MAX_SECRET];
+static size_t recovered_len = 0;
+
+static job_t *recover_job = NULL;
+
+typedef struct {
+  slip39_set_t set; // Own copy: the job may outlive the page
+  char passphrase[SLIP39_MAX_PASSPHRASE + 1];
+  uint8_t secret[SLIP39_MAX_SECRET];
+  size_t secret_len;
+  unsigned char fingerprint[BIP32_KEY_FINGERPRINT_LEN];
+} recover_scratch_t;
+
+static void create_length_menu(void);
+static void create_keyboard_input(void);
+static void start_share(void);
+static void ask_passphrase(void);
+
+static void cleanup_ui(void) {
+  if (back_btn) {
+    lv_obj_del(back_btn);
+    back_btn = NULL;
+  }
+  if (current_menu) {
+    ui_menu_destroy(current_menu);
+    current_menu = NULL;
+  }
+  if (keyboard) {
+    ui_keyboard_destroy(keyboard);
+    keyboard = NULL;
+  }
+}
+
+static void close_progress(void) {
+  if (progress_dialog) {
+    lv_obj_del(progress_dialog);
+    progress_dialog = NULL;
+  }
+}
+
+static void show_progress(uint8_t percent) {
+  char msg[32];
+  snprintf(msg, sizeof(msg), "Decrypting... %u%%", percent);
+  close_progress();
+  progress_dialog =
+      dialog_show_progress("SLIP-39", msg, DIALOG_STYLE_OVERLAY);
+}
+
+static void reset_words(void) {
+  secure_memzero(share_words, sizeof(share_words));
+  secure_memzero(current_prefix, sizeof(current_prefix));
+  current_word_index = 0;
+  prefix_len = 0;
+  pending_word = 0;
+}
+
+static void restart_all(void) {
+  slip39_set_wipe(&share_set);
+  reset_words();
+  total_words = 0;
+  create_length_menu();
+}
+
+/* ---------- Recovery ---------- */
+
+static bool recover_progress(uint8_t percent, void *ctx) {
+  job_t *job = ctx;
+  job_report_progress(job, percent);
+  return !job_is_cancelled(job);
+}
+
+/* Runs on a worker — does NOT touch LVGL */
+static int recover_run(job_t *job, void *scratch, void *ctx) {
+  (void)ctx;
+  recover_scratch_t *s = scratch;
+
+  slip39_error_t err =
+      slip39_recover(&s->set, s->passphrase[0] ? s->passphrase : NULL,
+                     s->secret, &s->secret_len, recover_progress, job);
+  slip39_set_wipe(&s->set);
+  secure_memzero(s->passphrase, sizeof(s->passphrase));
+  if (err != SLIP39_OK)
+    return err;
+
+  // The master secret is the BIP32 seed; preview the wallet it gives
+  struct ext_key *master_key = NULL;
+  if (bip32_key_from_seed_alloc(s->secret, s->secret_len,
+                                BIP32_VER_MAIN_PRIVATE, 0,
+                                &master_key) != WALLY_OK)
+    return SLIP39_ERR_CRYPTO;
+  bip32_key_get_fingerprint(master_key, s->fingerprint,
+                            BIP32_KEY_FINGERPRINT_LEN);
+  bip32_key_free(master_key);
+  return SLIP39_OK;
+}
+
+static void recover_progress_cb(uint8_t percent, void *ctx) {
+  (void)ctx;
+  if (recover_job)
+    show_progress(percent);
+}
+
+static void load_confirm_cb(bool confirmed, void *user_data) {
+  (void)user_data;
+  if (!confirmed) {
+    secure_memzero(recovered_secret, sizeof(recovered_secret));
+    recovered_len = 0;
+    restart_all();
+    return;
+  }
+
+  wallet_network_t net = settings_get_default_network();
+  wallet_set_policy(settings_get_default_policy());
+  wallet_set_type(settings_get_default_type());
+  bool loaded = key_load_from_master_secret(
+      recovered_secret, recovered_len, net == WALLET_NETWORK_TESTNET);
+  secure_memzero(recovered_secret, sizeof(recovered_secret));
+  recovered_len = 0;
+
+  if (!loaded) {
+    dialog_show_error("Failed to load key", return_callback, 0);
+    return;
+  }
+  if (!wallet_init(net)) {
+    dialog_show_error("Failed to initialize wallet", return_callback, 0);
+    return;
+  }
+  if (success_callback)
+    success_callback();
+}
+
+/* Back on the LVGL task */
+static void recover_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  recover_scratch_t *s = scratch;
+  recover_job = NULL;
+  close_progress();
+
+  if (result == SLIP39_ERR_PASSPHRASE) {
+    dialog_show_error("Passphrase must be printable ASCII", ask_passphrase,
+                      0);
+    return;
+  }
+  if (result != SLIP39_OK) {
+    dialog_show_error(slip39_error_str((slip39_error_t)result), restart_all,
+                      0);
+    return;
+  }
+
+  memcpy(recovered_secret, s->secret, s->secret_len);
+  recovered_len = s->secret_len;
+
+  // Any passphrase decrypts to some wallet; the fingerprint tells them apart
+  char msg[96];
+  snprintf(msg, sizeof(msg), "Fingerprint: %02x%02x%02x%02x\n\nLoad wallet?",
+           s->fingerprint[0], s->fingerprint[1], s->fingerprint[2],
+           s->fingerprint[3]);
+  dialog_show_confirm(msg, load_confirm_cb, NULL, DIALOG_STYLE_OVERLAY);
+}
+
+static void recover_cleanup(void *scratch) {
+  recover_scratch_t *s = scratch;
+  slip39_set_wipe(&s->set);
+}
+
+static void start_recovery(const char *passphrase) {
+  if (recover_job)
+    return;
+  if (passphrase && strlen(passphrase) > SLIP39_MAX_PASSPHRASE) {
+    dialog_show_error("Passphrase too long", ask_passphrase, 0);
+    return;
+  }
+
+  recover_scratch_t *init = malloc(sizeof(*init));
+  if (!init) {
+    dialog_show_error("Out of memory", ask_passphrase, 0);
+    return;
+  }
+  memset(init, 0, sizeof(*init));
+  memcpy(&init->set, &share_set, sizeof(share_set));
+  if (passphrase) {
+    strncpy(init->passphrase, passphrase, sizeof(init->passphrase) - 1);
+  }
+
+  cleanup_ui();
+  current_mode = MODE_RECOVERING;
+  slip39_input_page_show();
+  show_progress(0);
+
+  job_desc_t desc = {.run = recover_run,
+                     .done = recover_done,
+                     .progress = recover_progress_cb,
+                     .cleanup = recover_cleanup,
+                     .scratch_init = init,
+                     .scratch_len = sizeof(*init)};
+  recover_job = job_submit(&desc);
+  secure_memzero(init, sizeof(*init));
+  free(init);
+  if (!recover_job) {
+    close_progress();
+    dialog_show_error("Failed to start recovery", ask_passphrase, 0);
+  }
+}
+
+/* ---------- Passphrase ---------- */
+
+static void passphrase_return_cb(void) {
+  passphrase_page_destroy();
+  ask_passphrase();
+}
+
+static void passphrase_success_cb(const char *passphrase) {
+  // Copied into the job scratch before the page wipes it
+  start_recovery(passphrase);
+  passphrase_page_destroy();
+}
+
+static void passphrase_confirm_cb(bool confirmed, void *user_data) {
+  (void)user_data;
+  if (confirmed) {
+    slip39_input_page_hide();
+    passphrase_page_create(lv_screen_active(), passphrase_return_cb,
+                           passphrase_success_cb);
+  } else {
+    start_recovery(NULL);
+  }
+}
+
+static void ask_passphrase(void) {
+  slip39_input_page_show();
+  dialog_show_confirm("Shares complete.\n\nWere they created with a "
+                      "passphrase?",
+                      passphrase_confirm_cb, NULL, DIALOG_STYLE_OVERLAY);
+}
+
+/* ---------- Shares ---------- */
+
+static void format_status(char *out, size_t out_len) {
+  slip39_status_t st;
+  slip39_set_status(&share_set, &st);
+
+  int off = snprintf(out, out_len, "Groups complete: %u of %u",
+                     st.groups_complete, st.group_threshold);
+  for (int g = 0; g < st.group_count && off < (int)out_len; g++) {
+    if (!st.member_threshold[g])
+      continue;
+    if (st.group_count == 1) {
+      off += snprintf(out + off, out_len - off, "\nShares: %u of %u",
+                      st.member_count[g], st.member_threshold[g]);
+    } else {
+      off += snprintf(out + off, out_len - off, "\nGroup %d: %u of %u", g + 1,
+                      st.member_count[g], st.member_threshold[g]);
+    }
+  }
+}
+
+static void next_share_cb(void *user_data) {
+  (void)user_data;
+  start_share();
+}
+
+static void finish_share(void) {
+  slip39_share_t share;
+  slip39_error_t err =
+      slip39_share_decode(share_words, total_words, &share);
+  if (err == SLIP39_OK)
+    err = slip39_set_add(&share_set, &share);
+  secure_memzero(&share, sizeof(share));
+
+  if (err == SLIP39_ERR_CHECKSUM || err == SLIP39_ERR_PADDING ||
+      err == SLIP39_ERR_HEADER) {
+    // Likely a mistyped word; let them step back through the share
+    current_word_index = total_words - 1;
+    pending_word = share_words[current_word_index];
+    snprintf(current_prefix, sizeof(current_prefix), "%s",
+             slip39_word(pending_word));
+    prefix_len = strlen(current_prefix);
+    dialog_show_error(slip39_error_str(err), create_keyboard_input, 0);
+    return;
+  }
+  if (err != SLIP39_OK) {
+    dialog_show_error(slip39_error_str(err), start_share, 0);
+    return;
+  }
+
+  if (slip39_set_ready(&share_set)) {
+    ask_passphrase();
+    return;
+  }
+
+  char msg[160];
+  format_status(msg, sizeof(msg));
+  dialog_show_info("Share Added", msg, next_share_cb, NULL,
+                   DIALOG_STYLE_OVERLAY);
+}
+
+/* ---------- Word entry ---------- */
+
+static void update_keyboard_state(void) {
+  if (!keyboard)
+    return;
+
+  char title[48];
+  snprintf(title, sizeof(title), "Share %u: Word %u/%u",
+           share_set.count + 1, (unsigned)(current_word_index + 1),
+           (unsigned)total_words);
+  ui_keyboard_set_title(keyboard, title);
+  ui_keyboard_set_input_text(keyboard, current_prefix);
+
+  int match_count = slip39_prefix_range(current_prefix, prefix_len, NULL);
+  ui_keyboard_set_letters_enabled(
+      keyboard, slip39_next_letters(current_prefix, prefix_len));
+  ui_keyboard_set_key_enabled(keyboard, UI_KB_KEY_BACKSPACE,
+                              prefix_len > 0 || current_word_index > 0);
+  ui_keyboard_set_ok_enabled(keyboard, prefix_len > 0 && match_count > 0 &&
+                                           match_count <= MAX_LISTED_WORDS);
+}
+
+static void word_confirmation_cb(bool confirmed, void *user_data) {
+  (void)user_data;
+  if (!confirmed) {
+    create_keyboard_input();
+    return;
+  }
+
+  share_words[current_word_index++] = pending_word;
+  prefix_len = 0;
+  current_prefix[0] = '\0';
+  cleanup_ui();
+
+  if (current_word_index >= total_words)
+    finish_share();
+  else
+    create_keyboard_input();
+}
+
+static void show_word_confirmation(uint16_t index) {
+  pending_word = index;
+
+  char msg[64];
+  snprintf(msg, sizeof(msg), "Word %u: %s", (unsigned)(current_word_index + 1),
+           slip39_word(index));
+  dialog_show_confirm(msg, word_confirmation_cb, NULL, DIALOG_STYLE_OVERLAY);
+}
+
+static void step_back(void) {
+  if (prefix_len > 0) {
+    prefix_len = 0;
+    current_prefix[0] = '\0';
+  } else if (current_word_index > 0) {
+    current_word_index--;
+    snprintf(current_prefix, sizeof(current_prefix), "%s",
+             slip39_word(share_words[current_word_index]));
+    prefix_len = strlen(current_prefix);
+    share_words[current_word_index] = 0;
+  }
+  update_keyboard_state();
+}
+
+static void word_selected_cb(void) {
+  if (!current_menu)
+    return;
+
+  int selected = ui_menu_get_selected(current_menu);
+  uint16_t first = 0;
+  int count = slip39_prefix_range(current_prefix, prefix_len, &first);
+  if (selected < 0 || selected >= count)
+    return;
+
+  ui_menu_hide(current_menu);
+  show_word_confirmation((uint16_t)(first + selected));
+}
+
+static void create_word_select_menu(void) {
+  uint16_t first = 0;
+  int count = slip39_prefix_range(current_prefix, prefix_len, &first);
+  if (count <= 0 || count > MAX_LISTED_WORDS)
+    return;
+
+  cleanup_ui();
+  current_mode = MODE_WORD_SELECT;
+
+  char title[64];
+  snprintf(title, sizeof(title), "Select: %s...", current_prefix);
+  current_menu = ui_menu_create(slip39_screen, title, create_keyboard_input);
+  if (!current_menu)
+    return;
+
+  for (int i = 0; i < count; i++)
+    ui_menu_add_entry(current_menu, slip39_word(first + i), word_selected_cb);
+  ui_menu_show(current_menu);
+}
+
+static void keyboard_callback(char key) {
+  if (key >= 'a' && key <= 'z') {
+    if (prefix_len < SLIP39_MAX_WORD_LEN) {
+      current_prefix[prefix_len++] = key;
+      current_prefix[prefix_len] = '\0';
+
+      uint16_t first = 0;
+      if (slip39_prefix_range(current_prefix, prefix_len, &first) == 1)
+        show_word_confirmation(first);
+      else
+        update_keyboard_state();
+    }
+  } else if (key == UI_KB_BACKSPACE) {
+    if (prefix_len > 0) {
+      current_prefix[--prefix_len] = '\0';
+      update_keyboard_state();
+    } else {
+      step_back();
+    }
+  } else if (key == UI_KB_OK) {
+    create_word_select_menu();
+  }
+}
+
+static void back_confirm_cb(bool confirmed, void *user_data) {
+  (void)user_data;
+  if (confirmed && return_callback)
+    return_callback();
+}
+
+static void back_btn_cb(lv_event_t *e) {
+  (void)e;
+  dialog_show_confirm(share_set.count ? "Discard entered shares?"
+                                      : "Are you sure?",
+                      back_confirm_cb, NULL, DIALOG_STYLE_OVERLAY);
+}
+
+static void create_keyboard_input(void) {
+  cleanup_ui();
+  current_mode = MODE_KEYBOARD_INPUT;
+
+  keyboard = ui_keyboard_create(slip39_screen, "", keyboard_callback);
+  if (!keyboard)
+    return;
+
+  back_btn = ui_create_back_button(slip39_screen, back_btn_cb);
+
+  update_keyboard_state();
+  ui_keyboard_show(keyboard);
+}
+
+// Every share of a backup has the same length, set by the first one
+static void start_share(void) {
+  reset_words();
+  if (share_set.count > 0) {
+    total_words = slip39_share_words(share_set.shares[0].value_len);
+    create_keyboard_input();
+  } else {
+    create_length_menu();
+  }
+}
+
+static void length_selected_cb(void) {
+  if (!current_menu)
+    return;
+  int selected = ui_menu_get_selected(current_menu);
+  if (selected < 0 || selected >= (int)SECRET_LENGTH_COUNT)
+    return;
+  total_words = slip39_share_words(secret_lengths[selected]);
+  reset_words();
+  create_keyboard_input();
+}
+
+static void length_back_cb(void) {
+  if (return_callback)
+    return_callback();
+}
+
+static void create_length_menu(void) {
+  cleanup_ui();
+  current_mode = MODE_LENGTH_SELECT;
+
+  current_menu = ui_menu_create(slip39_screen, "Share Length", length_back_cb);
+  if (!current_menu)
+    return;
+
+  for (size_t i = 0; i < SECRET_LENGTH_COUNT; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "%u words",
+             (unsigned)slip39_share_words(secret_lengths[i]));
+    ui_menu_add_entry(current_menu, name, length_selected_cb);
+  }
+  ui_menu_show(current_menu);
+}
+
+void slip39_input_page_create(lv_obj_t *parent, void (*return_cb)(void),
+                              void (*success_cb)(void)) {
+  if (!parent)
+    return;
+
+  return_callback = return_cb;
+  success_callback = success_cb;
+
+  slip39_set_init(&share_set);
+  reset_words();
+  total_words = 0;
+
+  slip39_screen = theme_create_page_container(parent);
+  create_length_menu();
+}
+
+void slip39_input_page_show(void) {
+  if (slip39_screen)
+    lv_obj_clear_flag(slip39_screen, LV_OBJ_FLAG_HIDDEN);
+  if (current_mode == MODE_KEYBOARD_INPUT && keyboard)
+    ui_keyboard_show(keyboard);
+  else if (current_menu)
+    ui_menu_show(current_menu);
+}
+
+void slip39_input_page_hide(void) {
+  if (slip39_screen)
+    lv_obj_add_flag(slip39_screen, LV_OBJ_FLAG_HIDDEN);
+  if (keyboard)
+    ui_keyboard_hide(keyboard);
+  if (current_menu)
+    ui_menu_hide(current_menu);
+}
+
+void slip39_input_page_destroy(void) {
+  /* A running job finishes on its own copies; only delivery is suppressed */
+  if (recover_job) {
+    job_cancel(recover_job);
+    recover_job = NULL;
+  }
+  cleanup_ui();
+  close_progress();
+
+  if (slip39_screen) {
+    lv_obj_del(slip39_screen);
+    slip39_screen = NULL;
+  }
+
+  slip39_set_wipe(&share_set);
+  reset_words();
+  secure_memzero(recovered_secret, sizeof(recovered_secret));
+  recovered_len = 0;
+  total_words = 0;
+
+  return_callback = NULL;
+  success_callback = NULL;
+  current_mode = MODE_LENGTH_SELECT;
+}
@@ -0,0 +1,40 @@
+/*
+ * SLIP-39 Share Input Page Header
+ * Collects Shamir shares word by word and recovers the master secret
+ */
+
+#ifndef SLIP39_INPUT_H
+#define SLIP39_INPUT_H
+
+#include <lvgl.h>
+
+/**
+ * @brief Create the SLIP-39 share input page
+ *
+ * Shares are entered one at a time until enough groups are complete; the
+ * master secret is then decrypted on the job executor and loaded as the
+ * key.
+ *
+ * @param parent Parent LVGL object where the page will be created
+ * @param return_cb Callback function to call when returning to previous page
+ * @param success_cb Callback function to call once the key is loaded
+ */
+void slip39_input_page_create(lv_obj_t *parent, void (*return_cb)(void),
+                              void (*success_cb)(void));
+
+/**
+ * @brief Show the SLIP-39 share input page
+ */
+void slip39_input_page_show(void);
+
+/**
+ * @brief Hide the SLIP-39 share input page
+ */
+void slip39_input_page_hide(void);
+
+/**
+ * @brief Destroy the SLIP-39 share input page and free resources
+ */
+void slip39_input_page_destroy(void);
+
+#endif // SLIP39_INPUT_H
@@ -9,7 +9,6 @@
 #include "../../ui/theme.h"
 #include "../pin/pin_page.h"
 #include "../pin/pin_settings.h"
-#include <bsp/display.h>
 #include <lvgl.h>
 
 // -- Top-level settings menu --
@@ -21,6 +20,7 @@ static void (*return_callback)(void) = NULL;
 static lv_obj_t *detail_screen = NULL;
 static lv_obj_t *network_dropdown = NULL;
 static lv_obj_t *policy_dropdown = NULL;
+static lv_obj_t *type_dropdown = NULL;
 
 // -- Brightness detail page --
 static lv_obj_t *brightness_screen = NULL;
@@ -49,6 +49,12 @@ static void policy_dropdown_cb(lv_event_t *e) {
   settings_set_default_policy(pol);
 }
 
+static void type_dropdown_cb(lv_event_t *e) {
+  // Dropdown order follows wallet_type_t
+  uint16_t sel = lv_dropdown_get_selected(lv_event_get_target(e));
+  settings_set_default_type((wallet_type_t)sel);
+}
+
 static void detail_back_cb(lv_event_t *e) {
   (void)e;
   destroy_detail_page();
@@ -57,6 +63,8 @@ static void detail_back_cb(lv_event_t *e) {
 
 static void show_detail_page(void) {
   ui_menu_hide(settings_menu);
+  // Dropdown changes are written together when the page closes
+  settings_begin();
 
   detail_screen = theme_create_page_container(lv_screen_active());
 
@@ -91,15 +99,29 @@ static void show_detail_page(void) {
   lv_obj_add_event_cb(policy_dropdown, policy_dropdown_cb,
                       LV_EVENT_VALUE_CHANGED, NULL);
   lv_obj_align_to(policy_dropdown, pol_label, LV_ALIGN_OUT_BOTTOM_MID, 0, 5);
+
+  // Single-sig script type label + dropdown
+  lv_obj_t *type_label = theme_create_label(detail_screen, "Script", true);
+  lv_obj_align(type_label, LV_ALIGN_CENTER, -(LV_HOR_RES / 4), 90);
+
+  type_dropdown = theme_create_dropdown(
+      detail_screen, "Native Segwit\nTaproot\nNested Segwit\nLegacy");
+  lv_dropdown_set_selected(type_dropdown, settings_get_default_type());
+  lv_obj_set_width(type_dropdown, dd_width);
+  lv_obj_add_event_cb(type_dropdown, type_dropdown_cb, LV_EVENT_VALUE_CHANGED,
+                      NULL);
+  lv_obj_align_to(type_dropdown, type_label, LV_ALIGN_OUT_BOTTOM_MID, 0, 5);
 }
 
 static void destroy_detail_page(void) {
   if (detail_screen) {
     lv_obj_del(detail_screen);
     detail_screen = NULL;
+    settings_commit();
   }
   network_dropdown = NULL;
   policy_dropdown = NULL;
+  type_dropdown = NULL;
 }
 
 // ── Screen Brightness detail page ──
@@ -107,14 +129,13 @@ static void destroy_detail_page(void) {
 static void brightness_slider_cb(lv_event_t *e) {
   lv_obj_t *slider = lv_event_get_target(e);
   int32_t val = lv_slider_get_value(slider);
-  bsp_display_brightness_set(val);
+  // Cached only until the page closes; main.c applies it to the backlight
+  settings_set_brightness((uint8_t)val);
   lv_label_set_text_fmt(brightness_label, "%d%%", (int)val);
 }
 
 static void brightness_back_cb(lv_event_t *e) {
   (void)e;
-  int32_t val = lv_slider_get_value(brightness_slider);
-  settings_set_brightness((uint8_t)val);
   destroy_brightness_page();
   ui_menu_show(settings_menu);
 }
@@ -123,6 +144,7 @@ static void show_brightness_page(void) {
   ui_menu_hide(settings_menu);
 
   brightness_screen = theme_create_page_container(lv_screen_active());
+  settings_begin();
 
   ui_create_back_button(brightness_screen, brightness_back_cb);
   theme_create_page_title(brightness_screen, "Screen Brightness");
@@ -158,6 +180,7 @@ static void destroy_brightness_page(void) {
   if (brightness_screen) {
     lv_obj_del(brightness_screen);
     brightness_screen = NULL;
+    settings_commit();
   }
   brightness_slider = NULL;
   brightness_label = NULL;
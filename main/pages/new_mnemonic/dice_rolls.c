@@ -1,10 +1,12 @@
 // Dice Rolls Page - Generate mnemonic entropy from dice rolls
 
 #include "dice_rolls.h"
+#include "../../core/crypto_utils.h"
 #include "../../ui/dialog.h"
 #include "../../ui/input_helpers.h"
 #include "../../ui/theme.h"
 #include "../../ui/word_selector.h"
+#include <dice_entropy.h>
 #include <lvgl.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,6 +19,9 @@
 #define MIN_ROLLS_12_WORDS 50
 #define MIN_ROLLS_24_WORDS 99
 #define MAX_ROLLS 256
+#define DICE_SIDES 6
+// Rolls kept unhashed so backspace can take them back
+#define UNDO_DEPTH 16
 #define ENTROPY_12_WORDS 16
 #define ENTROPY_24_WORDS 32
 
@@ -25,14 +30,23 @@ static lv_obj_t *back_btn = NULL;
 static lv_obj_t *dice_btnmatrix = NULL;
 static lv_obj_t *title_label = NULL;
 static lv_obj_t *rolls_label = NULL;
+static lv_obj_t *quality_label = NULL;
 static void (*return_callback)(void) = NULL;
 static char *completed_mnemonic = NULL;
 
 static int total_words = 0;
 static int min_rolls = 0;
-static char rolls_string[MAX_ROLLS + 1];
 static int rolls_count = 0;
 
+// Rolls older than the undo window are fed straight into the hash, so the
+// full roll string is never held. The hash input is unchanged: the ASCII
+// rolls in order, as before.
+static crypto_sha256_stream_t *rolls_hash = NULL;
+static char pending_rolls[UNDO_DEPTH];
+static dice_entropy_t pending_states[UNDO_DEPTH]; // Estimate before each
+static int pending_count = 0;
+static dice_entropy_t estimate;
+
 static void create_word_count_menu(void);
 static void create_dice_input(void);
 static void cleanup_ui(void);
@@ -66,6 +80,60 @@ static void cleanup_ui(void) {
     lv_obj_del(rolls_label);
     rolls_label = NULL;
   }
+  if (quality_label) {
+    lv_obj_del(quality_label);
+    quality_label = NULL;
+  }
+}
+
+static void reset_rolls(void) {
+  crypto_sha256_stream_free(rolls_hash);
+  rolls_hash = NULL;
+  secure_memzero(pending_rolls, sizeof(pending_rolls));
+  secure_memzero(pending_states, sizeof(pending_states));
+  secure_memzero(&estimate, sizeof(estimate));
+  pending_count = 0;
+  rolls_count = 0;
+}
+
+static bool start_rolls(void) {
+  reset_rolls();
+  rolls_hash = crypto_sha256_stream_new();
+  return rolls_hash &&
+         dice_entropy_init(&estimate, DICE_SIDES, (uint16_t)min_rolls);
+}
+
+static void add_roll(char roll) {
+  if (pending_count == UNDO_DEPTH) {
+    // Oldest pending roll leaves the undo window and goes into the hash
+    crypto_sha256_stream_update(rolls_hash, (const uint8_t *)pending_rolls, 1);
+    memmove(pending_rolls, pending_rolls + 1, UNDO_DEPTH - 1);
+    memmove(pending_states, pending_states + 1,
+            (UNDO_DEPTH - 1) * sizeof(pending_states[0]));
+    pending_count--;
+  }
+  pending_states[pending_count] = estimate;
+  pending_rolls[pending_count++] = roll;
+  dice_entropy_add(&estimate, (uint8_t)(roll - '0'));
+  rolls_count++;
+}
+
+static void undo_roll(void) {
+  pending_count--;
+  estimate = pending_states[pending_count];
+  secure_memzero(&pending_states[pending_count], sizeof(estimate));
+  pending_rolls[pending_count] = '\0';
+  rolls_count--;
+}
+
+static const char *quality_warning(const dice_entropy_report_t *r) {
+  if (r->long_run)
+    return "Same number repeated";
+  if (r->patterned)
+    return "Rolls follow a pattern";
+  if (r->skewed)
+    return "Dice look biased";
+  return NULL;
 }
 
 static void create_word_count_menu(void) {
@@ -77,8 +145,7 @@ static void create_word_count_menu(void) {
 static void back_confirm_cb(bool confirmed, void *user_data) {
   (void)user_data;
   if (confirmed) {
-    rolls_count = 0;
-    rolls_string[0] = '\0';
+    reset_rolls();
     if (return_callback)
       return_callback();
   }
@@ -103,6 +170,12 @@ static void create_dice_input(void) {
   lv_obj_set_style_text_align(rolls_label, LV_TEXT_ALIGN_CENTER, 0);
   lv_obj_align(rolls_label, LV_ALIGN_TOP_MID, 0, 130);
 
+  quality_label = lv_label_create(dice_rolls_screen);
+  lv_obj_set_style_text_font(quality_label, theme_font_small(), 0);
+  lv_obj_set_width(quality_label, LV_PCT(90));
+  lv_obj_set_style_text_align(quality_label, LV_TEXT_ALIGN_CENTER, 0);
+  lv_obj_align_to(quality_label, rolls_label, LV_ALIGN_OUT_BOTTOM_MID, 0, 10);
+
   back_btn = ui_create_back_button(dice_rolls_screen, back_btn_cb);
 
   dice_btnmatrix = lv_btnmatrix_create(dice_rolls_screen);
@@ -126,13 +199,25 @@ static void update_display(void) {
            rolls_count, min_rolls);
   lv_label_set_text(title_label, title);
 
-  if (rolls_count == 0) {
-    lv_label_set_text(rolls_label, "_");
-  } else {
-    char display[MAX_ROLLS + 2];
-    snprintf(display, sizeof(display), "%s_", rolls_string);
-    lv_label_set_text(rolls_label, display);
-  }
+  // Only the undo window is kept; older rolls show as an ellipsis
+  char display[UNDO_DEPTH + 8];
+  snprintf(display, sizeof(display), "%s%.*s_",
+           rolls_count > pending_count ? "..." : "", pending_count,
+           pending_rolls);
+  lv_label_set_text(rolls_label, display);
+  lv_obj_align_to(quality_label, rolls_label, LV_ALIGN_OUT_BOTTOM_MID, 0, 10);
+
+  dice_entropy_report_t report;
+  dice_entropy_report(&estimate, &report);
+  const char *warning = quality_warning(&report);
+  char quality[96];
+  int bits_required = total_words == 12 ? 128 : 256;
+  snprintf(quality, sizeof(quality), "~%d/%d bits%s%s",
+           (int)report.total_bits, bits_required, warning ? "\n" : "",
+           warning ? warning : "");
+  lv_label_set_text(quality_label, quality);
+  lv_obj_set_style_text_color(
+      quality_label, warning ? error_color() : secondary_color(), 0);
 
   if (dice_btnmatrix) {
     // Done button (index 7)
@@ -142,8 +227,8 @@ static void update_display(void) {
     else
       lv_btnmatrix_set_btn_ctrl(dice_btnmatrix, 7, LV_BTNMATRIX_CTRL_DISABLED);
 
-    // Backspace button (index 6)
-    if (rolls_count > 0)
+    // Backspace button (index 6), limited to the undo window
+    if (pending_count > 0)
       lv_btnmatrix_clear_btn_ctrl(dice_btnmatrix, 6,
                                   LV_BTNMATRIX_CTRL_DISABLED);
     else
@@ -161,22 +246,24 @@ static void dice_btnmatrix_event_cb(lv_event_t *e) {
 
   if (strcmp(txt, "Done") == 0) {
     if (rolls_count >= min_rolls) {
-      char msg[64];
-      snprintf(msg, sizeof(msg), "Generate %d-word mnemonic from %d rolls?",
-               total_words, rolls_count);
+      dice_entropy_report_t report;
+      dice_entropy_report(&estimate, &report);
+      const char *warning = quality_warning(&report);
+      char msg[128];
+      snprintf(msg, sizeof(msg), "%s%sGenerate %d-word mnemonic from %d rolls?",
+               warning ? warning : "", warning ? ". " : "", total_words,
+               rolls_count);
       dialog_show_confirm(msg, confirm_finish_cb, NULL, DIALOG_STYLE_OVERLAY);
     }
   } else if (strcmp(txt, LV_SYMBOL_BACKSPACE) == 0) {
-    if (rolls_count > 0) {
-      rolls_count--;
-      rolls_string[rolls_count] = '\0';
+    if (pending_count > 0) {
+      undo_roll();
       update_display();
     }
   } else {
     char dice_value = txt[0];
     if (dice_value >= '1' && dice_value <= '6' && rolls_count < MAX_ROLLS) {
-      rolls_string[rolls_count++] = dice_value;
-      rolls_string[rolls_count] = '\0';
+      add_roll(dice_value);
       update_display();
     }
   }
@@ -196,14 +283,23 @@ static bool generate_mnemonic_from_rolls(void) {
       (total_words == 12) ? ENTROPY_12_WORDS : ENTROPY_24_WORDS;
 
   unsigned char hash[SHA256_LEN];
-  if (wally_sha256((const unsigned char *)rolls_string, rolls_count, hash,
-                   sizeof(hash)) != WALLY_OK)
+  int rc = crypto_sha256_stream_update(
+      rolls_hash, (const uint8_t *)pending_rolls, (size_t)pending_count);
+  if (rc == CRYPTO_OK)
+    rc = crypto_sha256_stream_finish(rolls_hash, hash);
+  else
+    crypto_sha256_stream_free(rolls_hash);
+  rolls_hash = NULL;
+  if (rc != CRYPTO_OK) {
+    reset_rolls();
     return false;
+  }
 
   char *mnemonic = NULL;
-  if (bip39_mnemonic_from_bytes(NULL, hash, entropy_len, &mnemonic) !=
-          WALLY_OK ||
-      !mnemonic)
+  int ret = bip39_mnemonic_from_bytes(NULL, hash, entropy_len, &mnemonic);
+  secure_memzero(hash, sizeof(hash));
+  reset_rolls();
+  if (ret != WALLY_OK || !mnemonic)
     return false;
 
   if (bip39_mnemonic_validate(NULL, mnemonic) != WALLY_OK) {
@@ -216,10 +312,6 @@ static bool generate_mnemonic_from_rolls(void) {
   completed_mnemonic = strdup(mnemonic);
   wally_free_string(mnemonic);
 
-  secure_memzero(hash, sizeof(hash));
-  secure_memzero(rolls_string, sizeof(rolls_string));
-  rolls_count = 0;
-
   return true;
 }
 
@@ -237,8 +329,11 @@ static void finish_dice_rolls(void) {
 static void on_word_count_selected(int word_count) {
   total_words = word_count;
   min_rolls = (word_count == 12) ? MIN_ROLLS_12_WORDS : MIN_ROLLS_24_WORDS;
-  rolls_count = 0;
-  rolls_string[0] = '\0';
+  if (!start_rolls()) {
+    reset_rolls();
+    dialog_show_error("Out of memory", NULL, 0);
+    return;
+  }
   create_dice_input();
 }
 
@@ -263,8 +358,7 @@ void dice_rolls_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
 
   total_words = 0;
   min_rolls = 0;
-  rolls_count = 0;
-  rolls_string[0] = '\0';
+  reset_rolls();
 
   dice_rolls_screen = theme_create_page_container(parent);
 
@@ -289,8 +383,7 @@ void dice_rolls_page_destroy(void) {
     dice_rolls_screen = NULL;
   }
 
-  secure_memzero(rolls_string, sizeof(rolls_string));
-  rolls_count = 0;
+  reset_rolls();
   total_words = 0;
   min_rolls = 0;
   return_callback = NULL;
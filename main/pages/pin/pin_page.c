@@ -12,6 +12,7 @@
 #include "../../utils/secure_mem.h"
 
 #include <esp_system.h>
+#include <job_executor.h>
 #include <lvgl.h>
 #include <stdio.h>
 #include <string.h>
@@ -226,24 +227,28 @@ static void show_processing(lv_timer_cb_t callback) {
 }
 
 // ---------------------------------------------------------------------------
-// Text input ready callback (keyboard checkmark pressed)
+// Background PIN verification
 // ---------------------------------------------------------------------------
+// Only the HMAC + PBKDF2 run on the job executor. The failure counter and
+// the wipe go through settings, whose cache belongs to the LVGL task, so
+// pin_verify_begin() runs before the job and pin_verify_finish() in done.
+
+typedef struct {
+  char pin[PIN_MAX_LENGTH * 2 + 1];
+  size_t len;
+  uint8_t hash[PIN_HASH_SIZE];
+} verify_scratch_t;
+
+static job_t *verify_job = NULL;
+
+static int verify_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)ctx;
+  verify_scratch_t *v = scratch;
+  return pin_verify_hash(v->pin, v->len, v->hash) ? 1 : 0;
+}
 
-static void deferred_verify_cb(lv_timer_t *timer) {
-  (void)timer;
-
-  // Concatenate prefix + suffix
-  char full_pin[PIN_MAX_LENGTH * 2 + 1];
-  int full_len = prefix_len + suffix_len;
-  memcpy(full_pin, prefix_buf, prefix_len);
-  memcpy(full_pin + prefix_len, suffix_buf, suffix_len);
-  full_pin[full_len] = '\0';
-  secure_memzero(suffix_buf, sizeof(suffix_buf));
-  suffix_len = 0;
-
-  pin_verify_result_t result = pin_verify(full_pin, full_len);
-  secure_memzero(full_pin, sizeof(full_pin));
-
+static void handle_verify_result(pin_verify_result_t result) {
   dismiss_processing();
 
   switch (result) {
@@ -264,6 +269,11 @@ static void deferred_verify_cb(lv_timer_t *timer) {
     lv_timer_set_repeat_count(rt, 1);
     break;
   }
+  case PIN_VERIFY_ERROR:
+    clear_buffers();
+    dialog_show_error("Storage error, PIN not checked", NULL, 1500);
+    transition_to(STATE_UNLOCK);
+    break;
   default:
     clear_buffers();
     dialog_show_error("Wrong PIN", NULL, 1500);
@@ -272,6 +282,52 @@ static void deferred_verify_cb(lv_timer_t *timer) {
   }
 }
 
+static void verify_done(int status, void *scratch, void *ctx) {
+  (void)ctx;
+  verify_scratch_t *v = scratch;
+  verify_job = NULL;
+  handle_verify_result(pin_verify_finish(v->hash, status == 1));
+}
+
+static void start_verify(void) {
+  // Concatenate prefix + suffix
+  verify_scratch_t init = {0};
+  memcpy(init.pin, prefix_buf, prefix_len);
+  memcpy(init.pin + prefix_len, suffix_buf, suffix_len);
+  init.len = prefix_len + suffix_len;
+  init.pin[init.len] = '\0';
+  secure_memzero(suffix_buf, sizeof(suffix_buf));
+  suffix_len = 0;
+
+  progress_dialog =
+      dialog_show_progress("PIN", "Processing...", DIALOG_STYLE_OVERLAY);
+
+  pin_verify_result_t begun = pin_verify_begin();
+  if (begun != PIN_VERIFY_OK) {
+    secure_memzero(&init, sizeof(init));
+    handle_verify_result(begun);
+    return;
+  }
+
+  job_desc_t desc = {.run = verify_run,
+                     .done = verify_done,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  verify_job = job_submit(&desc);
+  secure_memzero(&init, sizeof(init));
+  if (!verify_job) {
+    pin_verify_abort();
+    dismiss_processing();
+    clear_buffers();
+    dialog_show_error("Failed to start verification", NULL, 1500);
+    transition_to(STATE_UNLOCK);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Text input ready callback (keyboard checkmark pressed)
+// ---------------------------------------------------------------------------
+
 static void input_ready_cb(lv_event_t *e) {
   (void)e;
   if (!text_input.textarea)
@@ -292,7 +348,7 @@ static void input_ready_cb(lv_event_t *e) {
     suffix_len = 0;
     suffix_buf[0] = '\0';
     secure_clear_textarea(text_input.textarea);
-    show_processing(deferred_verify_cb);
+    start_verify();
     break;
   }
 
@@ -958,6 +1014,10 @@ void pin_page_hide(void) {
 }
 
 void pin_page_destroy(void) {
+  if (verify_job) {
+    job_cancel(verify_job);
+    verify_job = NULL;
+  }
   clear_buffers();
   dismiss_processing();
   clear_state();
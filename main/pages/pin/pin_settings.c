@@ -1,8 +1,9 @@
-// PIN settings page — manage PIN, timeout, wipe threshold
+// PIN settings page — manage PIN, timeout, wipe threshold, key cache
 
 #include "pin_settings.h"
 #include "../../core/pin.h"
 #include "../../core/session.h"
+#include "../../core/settings.h"
 #include "../../ui/dialog.h"
 #include "../../ui/input_helpers.h"
 #include "../../ui/menu.h"
@@ -28,6 +29,10 @@ static lv_obj_t *timeout_dropdown = NULL;
 static lv_obj_t *threshold_screen = NULL;
 static lv_obj_t *threshold_dropdown = NULL;
 
+// Key cache detail page
+static lv_obj_t *key_cache_screen = NULL;
+static lv_obj_t *key_cache_dropdown = NULL;
+
 // ---------------------------------------------------------------------------
 // Forward declarations
 // ---------------------------------------------------------------------------
@@ -36,6 +41,8 @@ static void show_timeout_page(void);
 static void destroy_timeout_page(void);
 static void show_threshold_page(void);
 static void destroy_threshold_page(void);
+static void show_key_cache_page(void);
+static void destroy_key_cache_page(void);
 
 // ---------------------------------------------------------------------------
 // Change PIN
@@ -176,6 +183,55 @@ static void destroy_threshold_page(void) {
   threshold_dropdown = NULL;
 }
 
+// ---------------------------------------------------------------------------
+// Key cache
+// ---------------------------------------------------------------------------
+
+static void key_cache_dropdown_cb(lv_event_t *e) {
+  bool on = lv_dropdown_get_selected(lv_event_get_target(e)) == 1;
+  settings_set_kef_cache(on);
+  // Takes effect in the current session; turning it off wipes the keys
+  session_apply_kef_cache();
+}
+
+static void key_cache_back_cb(lv_event_t *e) {
+  (void)e;
+  destroy_key_cache_page();
+  ui_menu_show(settings_menu);
+}
+
+static void show_key_cache_page(void) {
+  ui_menu_hide(settings_menu);
+
+  key_cache_screen = theme_create_page_container(lv_screen_active());
+  ui_create_back_button(key_cache_screen, key_cache_back_cb);
+  theme_create_page_title(key_cache_screen, "Key Cache");
+
+  lv_obj_t *desc = lv_label_create(key_cache_screen);
+  lv_label_set_text(desc, "Keep keys derived from encryption passwords in "
+                          "memory until the session locks");
+  lv_obj_set_style_text_color(desc, secondary_color(), 0);
+  lv_obj_set_style_text_align(desc, LV_TEXT_ALIGN_CENTER, 0);
+  lv_obj_set_width(desc, LV_PCT(80));
+  lv_obj_align(desc, LV_ALIGN_CENTER, 0, -40);
+
+  key_cache_dropdown = theme_create_dropdown(key_cache_screen, "Off\nOn");
+  lv_obj_set_width(key_cache_dropdown, LV_HOR_RES * 30 / 100);
+  lv_obj_align(key_cache_dropdown, LV_ALIGN_CENTER, 0, 20);
+  lv_dropdown_set_selected(key_cache_dropdown,
+                           settings_get_kef_cache() ? 1 : 0);
+  lv_obj_add_event_cb(key_cache_dropdown, key_cache_dropdown_cb,
+                      LV_EVENT_VALUE_CHANGED, NULL);
+}
+
+static void destroy_key_cache_page(void) {
+  if (key_cache_screen) {
+    lv_obj_delete(key_cache_screen);
+    key_cache_screen = NULL;
+  }
+  key_cache_dropdown = NULL;
+}
+
 // ---------------------------------------------------------------------------
 // Disable PIN
 // ---------------------------------------------------------------------------
@@ -218,6 +274,7 @@ void pin_settings_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   ui_menu_add_entry(settings_menu, "Change PIN", change_pin_cb);
   ui_menu_add_entry(settings_menu, "Session Timeout", show_timeout_page);
   ui_menu_add_entry(settings_menu, "Wipe Threshold", show_threshold_page);
+  ui_menu_add_entry(settings_menu, "Key Cache", show_key_cache_page);
   ui_menu_add_entry(settings_menu, "Disable PIN", disable_pin_cb);
 }
 
@@ -234,6 +291,7 @@ void pin_settings_page_hide(void) {
 void pin_settings_page_destroy(void) {
   destroy_timeout_page();
   destroy_threshold_page();
+  destroy_key_cache_page();
   if (settings_menu) {
     ui_menu_destroy(settings_menu);
     settings_menu = NULL;
@@ -13,6 +13,7 @@
 #include "../shared/descriptor_loader.h"
 #include "../store_descriptor.h"
 #include <bbqr.h>
+#include <job_executor.h>
 #include <lvgl.h>
 #include <stdlib.h>
 #include <string.h>
@@ -51,6 +52,14 @@ static int ur_parts_count = 0;
 static lv_timer_t *animation_timer = NULL;
 static int current_part_index = 0;
 
+/* BBQr compression runs on the job executor */
+static job_t *bbqr_job = NULL;
+
+typedef struct {
+  char *descriptor;
+  BBQrParts *parts;
+} bbqr_scratch_t;
+
 /* Save type selection menu */
 static ui_menu_t *save_type_menu = NULL;
 static storage_location_t pending_save_location;
@@ -76,6 +85,10 @@ static void cleanup_ur(void) {
 }
 
 static void cleanup_qr_state(void) {
+  if (bbqr_job) {
+    job_cancel(bbqr_job);
+    bbqr_job = NULL;
+  }
   if (animation_timer) {
     lv_timer_del(animation_timer);
     animation_timer = NULL;
@@ -104,6 +117,41 @@ static void animation_timer_cb(lv_timer_t *timer) {
   }
 }
 
+static int bbqr_encode_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)ctx;
+  bbqr_scratch_t *b = scratch;
+  b->parts = bbqr_encode((const uint8_t *)b->descriptor, strlen(b->descriptor),
+                         BBQR_TYPE_UNICODE, MAX_QR_CHARS_PER_FRAME);
+  return b->parts ? 0 : -1;
+}
+
+static void bbqr_encode_cleanup(void *scratch) {
+  bbqr_scratch_t *b = scratch;
+  free(b->descriptor);
+  if (b->parts)
+    bbqr_parts_free(b->parts);
+}
+
+static void bbqr_encode_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  bbqr_scratch_t *b = scratch;
+  bbqr_job = NULL;
+
+  if (result != 0 || !qr_code)
+    return;
+
+  bbqr_parts = b->parts;
+  b->parts = NULL;
+
+  qr_update_optimal(qr_code, bbqr_parts->parts[0], NULL);
+
+  if (bbqr_parts->count > 1) {
+    animation_timer =
+        lv_timer_create(animation_timer_cb, ANIMATION_INTERVAL_MS, NULL);
+  }
+}
+
 static void update_qr_display(void) {
   if (!qr_code || !descriptor_string)
     return;
@@ -116,18 +164,18 @@ static void update_qr_display(void) {
   }
 
   if (current_format == FORMAT_BBQR_DESC) {
-    bbqr_parts = bbqr_encode((const uint8_t *)descriptor_string,
-                             strlen(descriptor_string), BBQR_TYPE_UNICODE,
-                             MAX_QR_CHARS_PER_FRAME);
-    if (!bbqr_parts)
+    bbqr_scratch_t init = {.descriptor = strdup(descriptor_string)};
+    if (!init.descriptor)
       return;
 
-    qr_update_optimal(qr_code, bbqr_parts->parts[0], NULL);
-
-    if (bbqr_parts->count > 1) {
-      animation_timer =
-          lv_timer_create(animation_timer_cb, ANIMATION_INTERVAL_MS, NULL);
-    }
+    job_desc_t desc = {.run = bbqr_encode_run,
+                       .done = bbqr_encode_done,
+                       .cleanup = bbqr_encode_cleanup,
+                       .scratch_init = &init,
+                       .scratch_len = sizeof(init)};
+    bbqr_job = job_submit(&desc);
+    if (!bbqr_job)
+      free(init.descriptor);
     return;
   }
 
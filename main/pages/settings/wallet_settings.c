@@ -24,6 +24,7 @@ static lv_obj_t *wallet_settings_screen = NULL;
 static lv_obj_t *back_button = NULL;
 static lv_obj_t *network_dropdown = NULL;
 static lv_obj_t *policy_dropdown = NULL;
+static lv_obj_t *type_dropdown = NULL;
 static lv_obj_t *passphrase_btn = NULL;
 static lv_obj_t *descriptor_btn = NULL;
 static lv_obj_t *apply_btn = NULL;
@@ -34,9 +35,14 @@ static lv_obj_t *derivation_label = NULL;
 static void (*return_callback)(void) = NULL;
 static char *stored_passphrase = NULL;
 static char *mnemonic_content = NULL;
+// Keys recovered from SLIP-39 shares have no mnemonic; their passphrase
+// was applied at recovery and cannot be changed here
+static unsigned char master_secret[KEY_MAX_MASTER_SECRET];
+static size_t master_secret_len = 0;
 static char base_fingerprint_hex[9] = {0};
 static wallet_network_t selected_network = WALLET_NETWORK_MAINNET;
 static wallet_policy_t selected_policy = WALLET_POLICY_SINGLESIG;
+static wallet_type_t selected_type = WALLET_TYPE_NATIVE_SEGWIT;
 static bool settings_changed = false;
 
 static lv_obj_t *account_btn = NULL;
@@ -86,7 +92,8 @@ static void update_derivation_path(void) {
     return;
   char path[48];
   wallet_format_derivation_path(path, sizeof(path), selected_policy,
-                                selected_network, selected_account);
+                                selected_type, selected_network,
+                                selected_account);
   lv_label_set_text(derivation_label, path);
 }
 
@@ -253,6 +260,18 @@ static void policy_dropdown_cb(lv_event_t *e) {
   }
 }
 
+static void type_dropdown_cb(lv_event_t *e) {
+  // Dropdown order follows wallet_type_t
+  uint16_t sel = lv_dropdown_get_selected(lv_event_get_target(e));
+  wallet_type_t new_type = (wallet_type_t)sel;
+  if (new_type != selected_type) {
+    selected_type = new_type;
+    settings_changed = true;
+    update_derivation_path();
+    update_apply_button_state();
+  }
+}
+
 static void add_fingerprint_pair(lv_obj_t *parent, const char *fp_hex,
                                  bool highlighted) {
   lv_color_t color = highlighted ? highlight_color() : secondary_color();
@@ -276,8 +295,8 @@ static void update_title_with_passphrase(const char *passphrase) {
   unsigned char seed[BIP39_SEED_LEN_512];
   struct ext_key *master_key = NULL;
 
-  if (bip39_mnemonic_to_seed512(mnemonic_content, passphrase, seed,
-                                sizeof(seed)) != WALLY_OK) {
+  if (key_mnemonic_to_seed(mnemonic_content, passphrase, seed,
+                           sizeof(seed)) != WALLY_OK) {
     secure_memzero(seed, sizeof(seed));
     return;
   }
@@ -337,6 +356,7 @@ static void passphrase_success_cb(const char *passphrase) {
 static void refresh_wallet_attributes(void) {
   selected_network = wallet_get_network();
   selected_policy = wallet_get_policy();
+  selected_type = wallet_get_type();
   selected_account = wallet_get_account();
   settings_changed = false;
 
@@ -346,6 +366,8 @@ static void refresh_wallet_attributes(void) {
   if (policy_dropdown)
     lv_dropdown_set_selected(
         policy_dropdown, (selected_policy == WALLET_POLICY_SINGLESIG) ? 0 : 1);
+  if (type_dropdown)
+    lv_dropdown_set_selected(type_dropdown, selected_type);
 
   update_account_display();
   update_derivation_path();
@@ -373,15 +395,21 @@ static void passphrase_btn_cb(lv_event_t *e) {
 }
 
 static void do_apply_settings(void) {
-  if (!mnemonic_content)
+  if (!mnemonic_content && !master_secret_len)
     return;
 
   bool is_testnet = (selected_network == WALLET_NETWORK_TESTNET);
   wallet_cleanup();
   wallet_set_account(selected_account);
   wallet_set_policy(selected_policy);
-
-  if (key_load_from_mnemonic(mnemonic_content, stored_passphrase, is_testnet)) {
+  wallet_set_type(selected_type);
+
+  bool loaded = mnemonic_content
+                    ? key_load_from_mnemonic(mnemonic_content,
+                                             stored_passphrase, is_testnet)
+                    : key_load_from_master_secret(
+                          master_secret, master_secret_len, is_testnet);
+  if (loaded) {
     if (!wallet_init(selected_network)) {
       dialog_show_error("Failed to initialize wallet", return_callback, 0);
       return;
@@ -405,7 +433,7 @@ static void apply_with_warning_cb(bool result, void *user_data) {
 
 static void apply_btn_cb(lv_event_t *e) {
   (void)e;
-  if (!mnemonic_content)
+  if (!mnemonic_content && !master_secret_len)
     return;
 
   if (selected_account > 99) {
@@ -417,33 +445,24 @@ static void apply_btn_cb(lv_event_t *e) {
   do_apply_settings();
 }
 
-void wallet_settings_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
-  if (!parent || !key_is_loaded() || !wallet_is_initialized())
-    return;
-
-  return_callback = return_cb;
-  selected_network = wallet_get_network();
-  selected_account = wallet_get_account();
-  selected_policy = wallet_get_policy();
-  settings_changed = false;
-
-  // Get current mnemonic for later use
+// Fingerprint of the mnemonic without passphrase
+static bool load_base_fingerprint(void) {
   if (!key_get_mnemonic(&mnemonic_content)) {
     dialog_show_error("Failed to get mnemonic", return_callback, 0);
-    return;
+    return false;
   }
 
   // Calculate base fingerprint (without passphrase)
   unsigned char seed[BIP39_SEED_LEN_512];
   struct ext_key *master_key = NULL;
 
-  if (bip39_mnemonic_to_seed512(mnemonic_content, NULL, seed, sizeof(seed)) !=
+  if (key_mnemonic_to_seed(mnemonic_content, NULL, seed, sizeof(seed)) !=
           WALLY_OK ||
       bip32_key_from_seed_alloc(seed, sizeof(seed), BIP32_VER_MAIN_PRIVATE, 0,
                                 &master_key) != WALLY_OK) {
     secure_memzero(seed, sizeof(seed));
     dialog_show_error("Failed to process mnemonic", return_callback, 0);
-    return;
+    return false;
   }
 
   unsigned char fingerprint[BIP32_KEY_FINGERPRINT_LEN];
@@ -455,13 +474,37 @@ void wallet_settings_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   if (wally_hex_from_bytes(fingerprint, BIP32_KEY_FINGERPRINT_LEN,
                            &fingerprint_hex) != WALLY_OK) {
     dialog_show_error("Failed to format fingerprint", return_callback, 0);
-    return;
+    return false;
   }
 
   strncpy(base_fingerprint_hex, fingerprint_hex,
           sizeof(base_fingerprint_hex) - 1);
   base_fingerprint_hex[sizeof(base_fingerprint_hex) - 1] = '\0';
   wally_free_string(fingerprint_hex);
+  return true;
+}
+
+void wallet_settings_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
+  if (!parent || !key_is_loaded() || !wallet_is_initialized())
+    return;
+
+  return_callback = return_cb;
+  selected_network = wallet_get_network();
+  selected_account = wallet_get_account();
+  selected_policy = wallet_get_policy();
+  selected_type = wallet_get_type();
+  settings_changed = false;
+
+  // Key material for reloading, and the fingerprint without passphrase
+  if (!key_has_mnemonic()) {
+    if (!key_get_master_secret(master_secret, &master_secret_len) ||
+        !key_get_fingerprint_hex(base_fingerprint_hex)) {
+      dialog_show_error("Failed to get key", return_callback, 0);
+      return;
+    }
+  } else if (!load_base_fingerprint()) {
+    return;
+  }
 
   // Main screen
   wallet_settings_screen = lv_obj_create(parent);
@@ -495,7 +538,8 @@ void wallet_settings_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   // Derivation path row
   char deriv_path[48];
   wallet_format_derivation_path(deriv_path, sizeof(deriv_path), selected_policy,
-                                selected_network, selected_account);
+                                selected_type, selected_network,
+                                selected_account);
   lv_obj_t *deriv_cont = ui_icon_text_row_create(header_cont, ICON_DERIVATION,
                                                  deriv_path, secondary_color());
   derivation_label = lv_obj_get_child(deriv_cont, 1);
@@ -527,6 +571,8 @@ void wallet_settings_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   theme_apply_touch_button(passphrase_btn, false);
   lv_obj_add_event_cb(passphrase_btn, passphrase_btn_cb, LV_EVENT_CLICKED,
                       NULL);
+  if (!mnemonic_content)
+    lv_obj_add_state(passphrase_btn, LV_STATE_DISABLED);
 
   lv_obj_t *pp_label = lv_label_create(passphrase_btn);
   lv_label_set_text(pp_label, "Passphrase");
@@ -597,16 +643,53 @@ void wallet_settings_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   lv_obj_add_event_cb(policy_dropdown, policy_dropdown_cb,
                       LV_EVENT_VALUE_CHANGED, NULL);
 
-  // Account label
-  lv_obj_t *acc_label = lv_label_create(content);
+  // Script type + Account row container (side by side)
+  lv_obj_t *type_acc_row = lv_obj_create(content);
+  lv_obj_set_size(type_acc_row, LV_PCT(90), LV_SIZE_CONTENT);
+  theme_apply_transparent_container(type_acc_row);
+  lv_obj_set_flex_flow(type_acc_row, LV_FLEX_FLOW_ROW);
+  lv_obj_set_flex_align(type_acc_row, LV_FLEX_ALIGN_SPACE_EVENLY,
+                        LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_margin_top(type_acc_row, 20, 0);
+
+  // Script type column (label + dropdown), single-sig only
+  lv_obj_t *type_col = lv_obj_create(type_acc_row);
+  lv_obj_set_size(type_col, LV_PCT(45), LV_SIZE_CONTENT);
+  theme_apply_transparent_container(type_col);
+  lv_obj_set_flex_flow(type_col, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_flex_align(type_col, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER,
+                        LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_pad_gap(type_col, 5, 0);
+
+  lv_obj_t *type_label = lv_label_create(type_col);
+  lv_label_set_text(type_label, "Script");
+  lv_obj_set_style_text_font(type_label, theme_font_small(), 0);
+  lv_obj_set_style_text_color(type_label, secondary_color(), 0);
+
+  type_dropdown = theme_create_dropdown(
+      type_col, "Native Segwit\nTaproot\nNested Segwit\nLegacy");
+  lv_dropdown_set_selected(type_dropdown, selected_type);
+  lv_obj_set_width(type_dropdown, LV_PCT(100));
+  lv_obj_add_event_cb(type_dropdown, type_dropdown_cb, LV_EVENT_VALUE_CHANGED,
+                      NULL);
+
+  // Account column (label + button)
+  lv_obj_t *acc_col = lv_obj_create(type_acc_row);
+  lv_obj_set_size(acc_col, LV_PCT(45), LV_SIZE_CONTENT);
+  theme_apply_transparent_container(acc_col);
+  lv_obj_set_flex_flow(acc_col, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_flex_align(acc_col, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER,
+                        LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_pad_gap(acc_col, 5, 0);
+
+  lv_obj_t *acc_label = lv_label_create(acc_col);
   lv_label_set_text(acc_label, "Account");
   lv_obj_set_style_text_font(acc_label, theme_font_small(), 0);
   lv_obj_set_style_text_color(acc_label, secondary_color(), 0);
-  lv_obj_set_style_margin_top(acc_label, 20, 0);
 
   // Account button
-  account_btn = lv_btn_create(content);
-  lv_obj_set_size(account_btn, LV_PCT(50), 50);
+  account_btn = lv_btn_create(acc_col);
+  lv_obj_set_size(account_btn, LV_PCT(100), 50);
   theme_apply_touch_button(account_btn, false);
   lv_obj_add_event_cb(account_btn, account_btn_cb, LV_EVENT_CLICKED, NULL);
 
@@ -650,6 +733,8 @@ void wallet_settings_page_destroy(void) {
 
   SECURE_FREE_STRING(stored_passphrase);
   SECURE_FREE_STRING(mnemonic_content);
+  secure_memzero(master_secret, sizeof(master_secret));
+  master_secret_len = 0;
 
   if (wallet_settings_screen) {
     lv_obj_del(wallet_settings_screen);
@@ -659,6 +744,7 @@ void wallet_settings_page_destroy(void) {
 
   network_dropdown = NULL;
   policy_dropdown = NULL;
+  type_dropdown = NULL;
   passphrase_btn = NULL;
   descriptor_btn = NULL;
   account_btn = NULL;
@@ -671,5 +757,6 @@ void wallet_settings_page_destroy(void) {
   return_callback = NULL;
   selected_network = WALLET_NETWORK_MAINNET;
   selected_policy = WALLET_POLICY_SINGLESIG;
+  selected_type = WALLET_TYPE_NATIVE_SEGWIT;
   settings_changed = false;
 }
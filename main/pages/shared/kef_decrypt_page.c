@@ -3,9 +3,10 @@
  * Key entry + decryption for KEF-encrypted data.
  * Follows the same pattern as passphrase.c.
  *
- * Decryption (PBKDF2 with 100k+ iterations) runs on a separate FreeRTOS
- * task to avoid triggering the watchdog on the LVGL task.  An LVGL timer
- * polls for completion and handles the result on the UI thread.
+ * Decryption (PBKDF2 with 100k+ iterations) runs on the shared job executor
+ * to keep the LVGL task responsive.  The result is delivered back on the UI
+ * thread; key and plaintext copies live in the job's scratch and are wiped
+ * when it completes.
  */
 
 #include "kef_decrypt_page.h"
@@ -14,34 +15,32 @@
 #include "../../ui/input_helpers.h"
 #include "../../ui/theme.h"
 #include "../../utils/secure_mem.h"
-#include <esp_task_wdt.h>
-#include <freertos/FreeRTOS.h>
-#include <freertos/idf_additions.h>
-#include <freertos/task.h>
+#include <job_executor.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define DECRYPT_TASK_STACK_SIZE 8192
-
 static lv_obj_t *kef_screen = NULL;
 static lv_obj_t *progress_dialog = NULL;
 static ui_text_input_t text_input = {0};
-static lv_timer_t *poll_timer = NULL;
 
 static void (*return_callback)(void) = NULL;
 static kef_decrypt_success_cb_t success_callback = NULL;
 
 static uint8_t *envelope_copy = NULL;
 static size_t envelope_copy_len = 0;
-static uint8_t *key_copy = NULL;
-static size_t key_copy_len = 0;
 static uint8_t *decrypted_data = NULL;
 static size_t decrypted_len = 0;
 
-/* Shared state between FreeRTOS task and LVGL timer */
-static volatile bool decrypt_done = false;
-static kef_error_t decrypt_result = KEF_OK;
-static TaskHandle_t decrypt_task_handle = NULL;
+static job_t *decrypt_job = NULL;
+
+typedef struct {
+  uint8_t *envelope; /* Own copy: the job may outlive the page */
+  size_t envelope_len;
+  uint8_t *key;
+  size_t key_len;
+  uint8_t *out;
+  size_t out_len;
+} decrypt_scratch_t;
 
 static void show_input(void) {
   ui_text_input_show(&text_input);
@@ -57,46 +56,41 @@ static void show_loading(void) {
       dialog_show_progress("KEF", "Decrypting...", DIALOG_STYLE_OVERLAY);
 }
 
-/* Runs on CPU 1 — does NOT touch LVGL */
-static void decrypt_task(void *arg) {
-  (void)arg;
-
-  /* Temporarily unsubscribe IDLE1 from WDT so PBKDF2 doesn't trigger it */
-  TaskHandle_t idle1 = xTaskGetIdleTaskHandleForCore(1);
-  esp_task_wdt_delete(idle1);
-
-  /* Free any previous decrypted data */
-  if (decrypted_data) {
-    SECURE_FREE_BUFFER(decrypted_data, decrypted_len);
-    decrypted_len = 0;
-  }
+/* Runs on a worker — does NOT touch LVGL */
+static int decrypt_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)ctx;
+  decrypt_scratch_t *d = scratch;
 
-  decrypt_result = kef_decrypt(envelope_copy, envelope_copy_len, key_copy,
-                               key_copy_len, &decrypted_data, &decrypted_len);
+  kef_error_t err = kef_decrypt(d->envelope, d->envelope_len, d->key,
+                                d->key_len, &d->out, &d->out_len);
 
   /* Zero key immediately after use */
-  SECURE_FREE_BUFFER(key_copy, key_copy_len);
-  key_copy_len = 0;
-
-  /* Re-subscribe IDLE1 to WDT before exiting */
-  esp_task_wdt_add(idle1);
-
-  decrypt_done = true;
-  vTaskDelete(NULL);
+  SECURE_FREE_BUFFER(d->key, d->key_len);
+  d->key_len = 0;
+  return err;
 }
 
-/* LVGL timer polls for decrypt task completion */
-static void poll_timer_cb(lv_timer_t *timer) {
-  (void)timer;
-  if (!decrypt_done)
-    return;
+static void decrypt_cleanup(void *scratch) {
+  decrypt_scratch_t *d = scratch;
+  SECURE_FREE_BUFFER(d->envelope, d->envelope_len);
+  SECURE_FREE_BUFFER(d->key, d->key_len);
+  SECURE_FREE_BUFFER(d->out, d->out_len);
+}
 
-  /* Task finished — stop polling */
-  lv_timer_del(poll_timer);
-  poll_timer = NULL;
-  decrypt_task_handle = NULL;
+/* Back on the LVGL task */
+static void decrypt_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  decrypt_scratch_t *d = scratch;
+  decrypt_job = NULL;
 
-  if (decrypt_result == KEF_OK) {
+  if (result == KEF_OK) {
+    /* Take ownership of the plaintext; freed on page destroy */
+    SECURE_FREE_BUFFER(decrypted_data, decrypted_len);
+    decrypted_data = d->out;
+    decrypted_len = d->out_len;
+    d->out = NULL;
+    d->out_len = 0;
     if (success_callback)
       success_callback(decrypted_data, decrypted_len);
     return;
@@ -107,43 +101,47 @@ static void poll_timer_cb(lv_timer_t *timer) {
   if (text_input.textarea)
     lv_textarea_set_text(text_input.textarea, "");
 
-  if (decrypt_result == KEF_ERR_AUTH) {
+  if (result == KEF_ERR_AUTH) {
     dialog_show_error("Wrong key", NULL, 0);
   } else {
-    dialog_show_error(kef_error_str(decrypt_result), NULL, 0);
+    dialog_show_error(kef_error_str((kef_error_t)result), NULL, 0);
   }
 }
 
 static void keyboard_ready_cb(lv_event_t *e) {
   (void)e;
   const char *text = lv_textarea_get_text(text_input.textarea);
-  if (!text || text[0] == '\0')
+  if (!text || text[0] == '\0' || decrypt_job)
     return;
 
   /* Copy key before clearing textarea */
-  key_copy_len = strlen(text);
-  key_copy = malloc(key_copy_len);
-  if (!key_copy)
+  decrypt_scratch_t init = {0};
+  init.key_len = strlen(text);
+  init.key = malloc(init.key_len);
+  init.envelope = malloc(envelope_copy_len);
+  if (!init.key || !init.envelope) {
+    decrypt_cleanup(&init);
     return;
-  memcpy(key_copy, text, key_copy_len);
+  }
+  memcpy(init.key, text, init.key_len);
+  memcpy(init.envelope, envelope_copy, envelope_copy_len);
+  init.envelope_len = envelope_copy_len;
 
   lv_textarea_set_text(text_input.textarea, "");
   show_loading();
 
-  /* Launch decryption on CPU 1 to keep LVGL (CPU 0) responsive */
-  decrypt_done = false;
-  if (xTaskCreatePinnedToCore(decrypt_task, "kef_dec", DECRYPT_TASK_STACK_SIZE,
-                              NULL, 5, &decrypt_task_handle, 1) != pdPASS) {
-    /* Fallback: if task creation fails, clean up and show error */
-    SECURE_FREE_BUFFER(key_copy, key_copy_len);
-    key_copy_len = 0;
+  job_desc_t desc = {.run = decrypt_run,
+                     .done = decrypt_done,
+                     .cleanup = decrypt_cleanup,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  decrypt_job = job_submit(&desc);
+  if (!decrypt_job) {
+    decrypt_cleanup(&init);
     show_input();
-    dialog_show_error("Task creation failed", NULL, 0);
-    return;
+    dialog_show_error("Failed to start decryption", NULL, 0);
   }
-
-  /* Poll every 100ms for task completion */
-  poll_timer = lv_timer_create(poll_timer_cb, 100, NULL);
+  secure_memzero(&init, sizeof(init));
 }
 
 static void back_btn_cb(lv_event_t *e) {
@@ -218,15 +216,11 @@ void kef_decrypt_page_hide(void) {
 }
 
 void kef_decrypt_page_destroy(void) {
-  if (decrypt_task_handle) {
-    vTaskDelete(decrypt_task_handle);
-    decrypt_task_handle = NULL;
-  }
-  if (poll_timer) {
-    lv_timer_del(poll_timer);
-    poll_timer = NULL;
+  /* A running job finishes on its own copies; only delivery is suppressed */
+  if (decrypt_job) {
+    job_cancel(decrypt_job);
+    decrypt_job = NULL;
   }
-  decrypt_done = false;
   ui_text_input_destroy(&text_input);
   if (kef_screen) {
     lv_obj_del(kef_screen);
@@ -239,8 +233,6 @@ void kef_decrypt_page_destroy(void) {
 
   SECURE_FREE_BUFFER(envelope_copy, envelope_copy_len);
   envelope_copy_len = 0;
-  SECURE_FREE_BUFFER(key_copy, key_copy_len);
-  key_copy_len = 0;
   SECURE_FREE_BUFFER(decrypted_data, decrypted_len);
   decrypted_len = 0;
 
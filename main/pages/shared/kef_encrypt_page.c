@@ -2,7 +2,8 @@
  * KEF Encrypt Page
  *
  * Shared encryption flow: fingerprint/custom ID prompt, two-step key
- * confirmation, and background encryption on CPU 1.  On success the
+ * confirmation, and background encryption on the shared job executor.
+ * On success the
  * caller-supplied callback receives the encrypted KEF envelope.
  *
  * Mirrors the kef_decrypt_page pattern.
@@ -16,15 +17,11 @@
 #include "../../ui/theme.h"
 #include "../../utils/secure_mem.h"
 
-#include <esp_task_wdt.h>
-#include <freertos/FreeRTOS.h>
-#include <freertos/idf_additions.h>
-#include <freertos/task.h>
+#include <job_executor.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define KEF_ITERATIONS 100000
-#define ENCRYPT_TASK_STACK_SIZE 8192
 
 static lv_obj_t *overlay_screen = NULL;
 static lv_obj_t *overlay_title = NULL;
@@ -42,15 +39,20 @@ static size_t data_copy_len = 0;
 /* KEF ID (suggested, fingerprint, or custom) */
 static char kef_id[64] = {0};
 
-/* Background encryption task */
-static TaskHandle_t encrypt_task_handle = NULL;
-static lv_timer_t *encrypt_poll_timer = NULL;
-static volatile bool encrypt_done = false;
-static kef_error_t encrypt_result = KEF_OK;
+/* Background encryption job */
+static job_t *encrypt_job = NULL;
 
-/* Key material */
-static uint8_t *encrypt_key_copy = NULL;
-static size_t encrypt_key_copy_len = 0;
+typedef struct {
+  char id[64];
+  uint8_t *key;
+  size_t key_len;
+  uint8_t *data; /* Own copy: the job may outlive the page */
+  size_t data_len;
+  uint8_t *envelope;
+  size_t envelope_len;
+} encrypt_scratch_t;
+
+/* Result (owned by the page until destroy) */
 static uint8_t *encrypt_envelope = NULL;
 static size_t encrypt_envelope_len = 0;
 
@@ -156,15 +158,10 @@ static void key_changed_cb(lv_event_t *e) {
 /* ---------- Overlay management ---------- */
 
 static void destroy_overlay(void) {
-  if (encrypt_task_handle) {
-    vTaskDelete(encrypt_task_handle);
-    encrypt_task_handle = NULL;
-  }
-  if (encrypt_poll_timer) {
-    lv_timer_del(encrypt_poll_timer);
-    encrypt_poll_timer = NULL;
+  if (encrypt_job) {
+    job_cancel(encrypt_job);
+    encrypt_job = NULL;
   }
-  encrypt_done = false;
   ui_text_input_destroy(&text_input);
 
   if (progress_dialog) {
@@ -176,8 +173,6 @@ static void destroy_overlay(void) {
     overlay_screen = NULL;
   }
 
-  SECURE_FREE_BUFFER(encrypt_key_copy, encrypt_key_copy_len);
-  encrypt_key_copy_len = 0;
   SECURE_FREE_BUFFER(confirm_key, confirm_key_len);
   confirm_key_len = 0;
   overlay_title = NULL;
@@ -216,44 +211,44 @@ static void create_overlay(const char *title, const char *placeholder,
   }
 }
 
-/* ---------- Encryption task (runs on CPU 1) ---------- */
+/* ---------- Encryption job (runs on a worker) ---------- */
 
-static void encrypt_task(void *arg) {
-  (void)arg;
+static int encrypt_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)ctx;
+  encrypt_scratch_t *w = scratch;
 
-  TaskHandle_t idle1 = xTaskGetIdleTaskHandleForCore(1);
-  esp_task_wdt_delete(idle1);
+  kef_error_t err = kef_encrypt((const uint8_t *)w->id, strlen(w->id),
+                                KEF_V20_GCM_E4, w->key, w->key_len,
+                                KEF_ITERATIONS, w->data, w->data_len,
+                                &w->envelope, &w->envelope_len);
 
-  if (encrypt_envelope) {
-    SECURE_FREE_BUFFER(encrypt_envelope, encrypt_envelope_len);
-    encrypt_envelope_len = 0;
-  }
-
-  encrypt_result = kef_encrypt(
-      (const uint8_t *)kef_id, strlen(kef_id), KEF_V20_GCM_E4, encrypt_key_copy,
-      encrypt_key_copy_len, KEF_ITERATIONS, data_copy, data_copy_len,
-      &encrypt_envelope, &encrypt_envelope_len);
-
-  SECURE_FREE_BUFFER(encrypt_key_copy, encrypt_key_copy_len);
-  encrypt_key_copy_len = 0;
+  SECURE_FREE_BUFFER(w->key, w->key_len);
+  w->key_len = 0;
+  return err;
+}
 
-  esp_task_wdt_add(idle1);
-  encrypt_done = true;
-  vTaskDelete(NULL);
+static void encrypt_cleanup(void *scratch) {
+  encrypt_scratch_t *w = scratch;
+  SECURE_FREE_BUFFER(w->key, w->key_len);
+  SECURE_FREE_BUFFER(w->data, w->data_len);
+  SECURE_FREE_BUFFER(w->envelope, w->envelope_len);
 }
 
-/* ---------- Poll timer ---------- */
+/* ---------- Completion (LVGL task) ---------- */
 
-static void encrypt_poll_timer_cb(lv_timer_t *timer) {
-  (void)timer;
-  if (!encrypt_done)
-    return;
+static void encrypt_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  encrypt_scratch_t *w = scratch;
+  encrypt_job = NULL;
 
-  lv_timer_del(encrypt_poll_timer);
-  encrypt_poll_timer = NULL;
-  encrypt_task_handle = NULL;
+  if (result == KEF_OK) {
+    SECURE_FREE_BUFFER(encrypt_envelope, encrypt_envelope_len);
+    encrypt_envelope = w->envelope;
+    encrypt_envelope_len = w->envelope_len;
+    w->envelope = NULL;
+    w->envelope_len = 0;
 
-  if (encrypt_result == KEF_OK) {
     destroy_overlay();
 
     if (success_callback)
@@ -273,7 +268,7 @@ static void encrypt_poll_timer_cb(lv_timer_t *timer) {
     lv_textarea_set_text(text_input.textarea, "");
   if (strength_label)
     lv_obj_clear_flag(strength_label, LV_OBJ_FLAG_HIDDEN);
-  dialog_show_error(kef_error_str(encrypt_result), NULL, 0);
+  dialog_show_error(kef_error_str((kef_error_t)result), NULL, 0);
 }
 
 /* ---------- Password input with confirmation ---------- */
@@ -281,7 +276,7 @@ static void encrypt_poll_timer_cb(lv_timer_t *timer) {
 static void password_ready_cb(lv_event_t *e) {
   (void)e;
   const char *text = lv_textarea_get_text(text_input.textarea);
-  if (!text || text[0] == '\0')
+  if (!text || text[0] == '\0' || encrypt_job)
     return;
 
   size_t len = strlen(text);
@@ -314,11 +309,21 @@ static void password_ready_cb(lv_event_t *e) {
     return;
   }
 
-  /* Match — transfer to encrypt_key_copy and proceed */
-  encrypt_key_copy = confirm_key;
-  encrypt_key_copy_len = confirm_key_len;
+  /* Match — hand the key and a copy of the data to the job */
+  encrypt_scratch_t init = {0};
+  snprintf(init.id, sizeof(init.id), "%s", kef_id);
+  init.key = confirm_key;
+  init.key_len = confirm_key_len;
   confirm_key = NULL;
   confirm_key_len = 0;
+  init.data = malloc(data_copy_len);
+  if (!init.data) {
+    encrypt_cleanup(&init);
+    dialog_show_error("Out of memory", NULL, 0);
+    return;
+  }
+  memcpy(init.data, data_copy, data_copy_len);
+  init.data_len = data_copy_len;
 
   lv_textarea_set_text(text_input.textarea, "");
 
@@ -327,22 +332,22 @@ static void password_ready_cb(lv_event_t *e) {
   progress_dialog =
       dialog_show_progress("KEF", "Encrypting...", DIALOG_STYLE_OVERLAY);
 
-  /* Launch encryption on CPU 1 */
-  encrypt_done = false;
-  if (xTaskCreatePinnedToCore(encrypt_task, "kef_enc", ENCRYPT_TASK_STACK_SIZE,
-                              NULL, 5, &encrypt_task_handle, 1) != pdPASS) {
-    SECURE_FREE_BUFFER(encrypt_key_copy, encrypt_key_copy_len);
-    encrypt_key_copy_len = 0;
+  job_desc_t desc = {.run = encrypt_run,
+                     .done = encrypt_done,
+                     .cleanup = encrypt_cleanup,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  encrypt_job = job_submit(&desc);
+  if (!encrypt_job) {
+    encrypt_cleanup(&init);
     if (progress_dialog) {
       lv_obj_del(progress_dialog);
       progress_dialog = NULL;
     }
     ui_text_input_show(&text_input);
-    dialog_show_error("Task creation failed", NULL, 0);
-    return;
+    dialog_show_error("Failed to start encryption", NULL, 0);
   }
-
-  encrypt_poll_timer = lv_timer_create(encrypt_poll_timer_cb, 100, NULL);
+  secure_memzero(&init, sizeof(init));
 }
 
 static void show_password_input(void) {
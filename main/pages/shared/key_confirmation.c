@@ -8,6 +8,7 @@
 #include "../../ui/theme.h"
 #include "../../utils/memory_utils.h"
 #include "../../utils/secure_mem.h"
+#include <job_executor.h>
 #include <lvgl.h>
 #include <string.h>
 #include <wally_bip32.h>
@@ -22,6 +23,78 @@ static void (*return_callback)(void) = NULL;
 static void (*success_callback)(void) = NULL;
 static char *mnemonic_content = NULL;
 
+/* BIP39 seed derivation (PBKDF2-SHA512, 2048 rounds) runs on the job
+ * executor, both for the preview fingerprint and for the final key load.
+ * Workers only fill the scratch; the key itself is installed from the
+ * done callback, on the LVGL task, like every other change to it. */
+static job_t *seed_job = NULL;
+
+typedef struct {
+  char *mnemonic;
+  bool is_testnet;
+  unsigned char seed[BIP39_SEED_LEN_512];
+  unsigned char fingerprint[BIP32_KEY_FINGERPRINT_LEN];
+} seed_scratch_t;
+
+static void create_ui(const char *fingerprint_hex);
+
+static void seed_cleanup(void *scratch) {
+  seed_scratch_t *s = scratch;
+  SECURE_FREE_STRING(s->mnemonic);
+}
+
+static bool seed_job_submit(job_run_fn run, job_done_fn done,
+                            bool is_testnet) {
+  seed_scratch_t init = {.is_testnet = is_testnet};
+  init.mnemonic = strdup(mnemonic_content);
+  if (!init.mnemonic)
+    return false;
+
+  job_desc_t desc = {.run = run,
+                     .done = done,
+                     .cleanup = seed_cleanup,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  seed_job = job_submit(&desc);
+  if (!seed_job) {
+    seed_cleanup(&init);
+    return false;
+  }
+  return true;
+}
+
+static int load_key_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)ctx;
+  seed_scratch_t *s = scratch;
+  return key_mnemonic_to_seed(s->mnemonic, NULL, s->seed, sizeof(s->seed)) ==
+                 WALLY_OK
+             ? 0
+             : -1;
+}
+
+static void load_key_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  seed_scratch_t *s = scratch;
+  seed_job = NULL;
+
+  if (result == 0 && !key_load_from_mnemonic_seed(s->mnemonic, s->seed,
+                                                  sizeof(s->seed),
+                                                  s->is_testnet))
+    result = -1;
+
+  if (result == 0) {
+    if (!wallet_init(settings_get_default_network())) {
+      dialog_show_error("Failed to initialize wallet", return_callback, 0);
+      return;
+    }
+    if (success_callback)
+      success_callback();
+  } else {
+    dialog_show_error("Failed to load key", return_callback, 0);
+  }
+}
+
 static void loading_timer_cb(lv_timer_t *timer) {
   (void)timer;
   if (loading_timer) {
@@ -32,17 +105,53 @@ static void loading_timer_cb(lv_timer_t *timer) {
   wallet_network_t net = settings_get_default_network();
   wallet_policy_t pol = settings_get_default_policy();
   wallet_set_policy(pol);
-  if (key_load_from_mnemonic(mnemonic_content, NULL,
-                             net == WALLET_NETWORK_TESTNET)) {
-    if (!wallet_init(net)) {
-      dialog_show_error("Failed to initialize wallet", return_callback, 0);
-      return;
-    }
-    if (success_callback)
-      success_callback();
-  } else {
+  wallet_set_type(settings_get_default_type());
+  if (!seed_job_submit(load_key_run, load_key_done,
+                       net == WALLET_NETWORK_TESTNET))
     dialog_show_error("Failed to load key", return_callback, 0);
+}
+
+static int fingerprint_run(job_t *job, void *scratch, void *ctx) {
+  (void)job;
+  (void)ctx;
+  seed_scratch_t *s = scratch;
+  unsigned char seed[BIP39_SEED_LEN_512];
+  struct ext_key *master_key = NULL;
+
+  if (key_mnemonic_to_seed(s->mnemonic, NULL, seed, sizeof(seed)) !=
+          WALLY_OK ||
+      bip32_key_from_seed_alloc(seed, sizeof(seed), BIP32_VER_MAIN_PRIVATE, 0,
+                                &master_key) != WALLY_OK) {
+    secure_memzero(seed, sizeof(seed));
+    return -1;
   }
+
+  bip32_key_get_fingerprint(master_key, s->fingerprint,
+                            BIP32_KEY_FINGERPRINT_LEN);
+  secure_memzero(seed, sizeof(seed));
+  bip32_key_free(master_key);
+  return 0;
+}
+
+static void fingerprint_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  seed_scratch_t *s = scratch;
+  seed_job = NULL;
+
+  if (result != 0) {
+    dialog_show_error("Failed to process mnemonic", return_callback, 0);
+    return;
+  }
+
+  char *fingerprint_hex = NULL;
+  if (wally_hex_from_bytes(s->fingerprint, BIP32_KEY_FINGERPRINT_LEN,
+                           &fingerprint_hex) != WALLY_OK) {
+    dialog_show_error("Failed to format fingerprint", return_callback, 0);
+    return;
+  }
+
+  create_ui(fingerprint_hex);
+  wally_free_string(fingerprint_hex);
 }
 
 static void anim_size_cb(void *var, int32_t value) {
@@ -116,32 +225,8 @@ void key_confirmation_page_create(lv_obj_t *parent, void (*return_cb)(void),
     return;
   }
 
-  unsigned char fingerprint[BIP32_KEY_FINGERPRINT_LEN];
-  unsigned char seed[BIP39_SEED_LEN_512];
-  struct ext_key *master_key = NULL;
-
-  if (bip39_mnemonic_to_seed512(mnemonic_content, NULL, seed, sizeof(seed)) !=
-          WALLY_OK ||
-      bip32_key_from_seed_alloc(seed, sizeof(seed), BIP32_VER_MAIN_PRIVATE, 0,
-                                &master_key) != WALLY_OK) {
-    secure_memzero(seed, sizeof(seed));
+  if (!seed_job_submit(fingerprint_run, fingerprint_done, false))
     dialog_show_error("Failed to process mnemonic", return_callback, 0);
-    return;
-  }
-
-  bip32_key_get_fingerprint(master_key, fingerprint, BIP32_KEY_FINGERPRINT_LEN);
-  secure_memzero(seed, sizeof(seed));
-  bip32_key_free(master_key);
-
-  char *fingerprint_hex = NULL;
-  if (wally_hex_from_bytes(fingerprint, BIP32_KEY_FINGERPRINT_LEN,
-                           &fingerprint_hex) != WALLY_OK) {
-    dialog_show_error("Failed to format fingerprint", return_callback, 0);
-    return;
-  }
-
-  create_ui(fingerprint_hex);
-  wally_free_string(fingerprint_hex);
 }
 
 void key_confirmation_page_show(void) {
@@ -155,6 +240,10 @@ void key_confirmation_page_hide(void) {
 }
 
 void key_confirmation_page_destroy(void) {
+  if (seed_job) {
+    job_cancel(seed_job);
+    seed_job = NULL;
+  }
   if (loading_timer) {
     lv_timer_del(loading_timer);
     loading_timer = NULL;
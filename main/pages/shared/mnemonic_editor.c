@@ -1,6 +1,7 @@
 // Mnemonic Editor Page - Review and edit mnemonic words before loading
 
 #include "mnemonic_editor.h"
+#include "../../core/key.h"
 #include "../../ui/assets/icons_24.h"
 #include "../../ui/dialog.h"
 #include "../../ui/input_helpers.h"
@@ -9,7 +10,10 @@
 #include "../../ui/theme.h"
 #include "../../utils/bip39_filter.h"
 #include "key_confirmation.h"
+#include <bip39_lang.h>
+#include <job_executor.h>
 #include <lvgl.h>
+#include <mnemonic_model.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,7 +24,10 @@
 
 #include "../../utils/secure_mem.h"
 
-#define MAX_MNEMONIC_LEN 256
+#define MAX_MNEMONIC_LEN 512 // Room for 24 accented or kana words
+
+// Quiet period after an edit before the seed is derived for the fingerprint
+#define FINGERPRINT_DEBOUNCE_MS 400
 
 typedef enum {
   MODE_WORD_GRID,
@@ -44,8 +51,11 @@ static ui_menu_t *current_menu = NULL;
 static void (*return_callback)(void) = NULL;
 static void (*success_callback)(void) = NULL;
 
-static char entered_words[24][16];
-static char original_words[24][16];
+// Words are kept as wordlist indices in the mnemonic's language (the
+// filter's primary language); strings only exist for display and for the
+// final mnemonic handed on to key confirmation
+static mnemonic_model_t entered;
+static mnemonic_model_t original;
 static int total_words = 0;
 static int editing_word_index = -1;
 
@@ -54,10 +64,17 @@ static int prefix_len = 0;
 static const char *filtered_words[BIP39_MAX_FILTERED_WORDS];
 static int filtered_count = 0;
 static editor_mode_t current_mode = MODE_WORD_GRID;
-static char pending_word[16] = {0};
+static int pending_index = -1;
 static bool is_new_mnemonic = false;
 static lv_obj_t *checksum_error_label = NULL;
 
+// Bumped on every edit; the fingerprint shown or being derived belongs to
+// fingerprint_version
+static uint32_t words_version = 0;
+static uint32_t fingerprint_version = 0;
+static lv_timer_t *fingerprint_timer = NULL;
+static job_t *fingerprint_job = NULL;
+
 static void create_ui(void);
 static void create_word_grid(void);
 static void cleanup_editing_ui(void);
@@ -78,147 +95,143 @@ static bool is_checksum_valid(void);
 static bool recalculate_last_word(void);
 static void update_checksum_ui(void);
 
-static bool is_checksum_valid(void) {
-  char mnemonic[MAX_MNEMONIC_LEN];
-  mnemonic[0] = '\0';
+static const char *word_text(int index) {
+  const char *word = bip39_filter_get_word(entered.words[index]);
+  return word ? word : "???";
+}
 
+// Space-separated mnemonic, false if a word is missing or it doesn't fit
+static bool build_mnemonic(char *out, size_t out_len) {
+  size_t pos = 0;
   for (int i = 0; i < total_words; i++) {
+    const char *word = bip39_filter_get_mnemonic_word(entered.words[i]);
+    if (!word)
+      return false;
+    size_t word_len = strlen(word);
+    if (pos + (i > 0) + word_len >= out_len)
+      return false;
     if (i > 0)
-      strncat(mnemonic, " ", sizeof(mnemonic) - strlen(mnemonic) - 1);
-    strncat(mnemonic, entered_words[i],
-            sizeof(mnemonic) - strlen(mnemonic) - 1);
+      out[pos++] = ' ';
+    memcpy(out + pos, word, word_len);
+    pos += word_len;
   }
+  out[pos] = '\0';
+  return pos > 0;
+}
 
-  bool valid = bip39_mnemonic_validate(NULL, mnemonic) == WALLY_OK;
-  secure_memzero(mnemonic, sizeof(mnemonic));
-  return valid;
+static bool is_checksum_valid(void) {
+  return mnemonic_model_checksum_valid(&entered);
 }
 
-static bool get_mnemonic_fingerprint_hex(char *hex_out) {
-  if (!hex_out)
+static bool recalculate_last_word(void) {
+  if (total_words < 12)
     return false;
+  return mnemonic_model_fix_last_word(&entered);
+}
+
+// ---------------------------------------------------------------------------
+// Fingerprint: PBKDF2 seed derivation plus the BIP32 master key take far
+// longer than a frame, so they run on the job executor once edits have
+// settled. A new edit cancels whatever is pending.
+// ---------------------------------------------------------------------------
 
+typedef struct {
   char mnemonic[MAX_MNEMONIC_LEN];
-  mnemonic[0] = '\0';
-  for (int i = 0; i < total_words; i++) {
-    if (i > 0)
-      strncat(mnemonic, " ", sizeof(mnemonic) - strlen(mnemonic) - 1);
-    strncat(mnemonic, entered_words[i],
-            sizeof(mnemonic) - strlen(mnemonic) - 1);
-  }
+  unsigned char fingerprint[BIP32_KEY_FINGERPRINT_LEN];
+} fingerprint_scratch_t;
+
+static int fingerprint_run(job_t *job, void *scratch, void *ctx) {
+  (void)ctx;
+  fingerprint_scratch_t *f = scratch;
 
   unsigned char seed[BIP39_SEED_LEN_512];
-  if (bip39_mnemonic_to_seed512(mnemonic, NULL, seed, sizeof(seed)) !=
-      WALLY_OK) {
-    secure_memzero(mnemonic, sizeof(mnemonic));
-    secure_memzero(seed, sizeof(seed));
-    return false;
+  int ret = key_mnemonic_to_seed(f->mnemonic, NULL, seed, sizeof(seed));
+  if (ret == WALLY_OK && !job_is_cancelled(job)) {
+    struct ext_key *master_key = NULL;
+    ret = bip32_key_from_seed_alloc(seed, sizeof(seed), BIP32_VER_MAIN_PRIVATE,
+                                    0, &master_key);
+    if (ret == WALLY_OK) {
+      ret = bip32_key_get_fingerprint(master_key, f->fingerprint,
+                                      BIP32_KEY_FINGERPRINT_LEN);
+      bip32_key_free(master_key);
+    }
   }
-  secure_memzero(mnemonic, sizeof(mnemonic));
+  secure_memzero(seed, sizeof(seed));
+  return ret;
+}
 
-  struct ext_key *master_key = NULL;
-  if (bip32_key_from_seed_alloc(seed, sizeof(seed), BIP32_VER_MAIN_PRIVATE, 0,
-                                &master_key) != WALLY_OK) {
-    secure_memzero(seed, sizeof(seed));
-    return false;
+static void set_fingerprint_visible(bool visible) {
+  if (!fingerprint_icon || !fingerprint_text)
+    return;
+  if (visible) {
+    lv_obj_clear_flag(fingerprint_icon, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_clear_flag(fingerprint_text, LV_OBJ_FLAG_HIDDEN);
+  } else {
+    lv_obj_add_flag(fingerprint_icon, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_flag(fingerprint_text, LV_OBJ_FLAG_HIDDEN);
   }
-  secure_memzero(seed, sizeof(seed));
+}
 
-  unsigned char fingerprint[BIP32_KEY_FINGERPRINT_LEN];
-  if (bip32_key_get_fingerprint(master_key, fingerprint,
-                                BIP32_KEY_FINGERPRINT_LEN) != WALLY_OK) {
-    bip32_key_free(master_key);
-    return false;
+static void fingerprint_done(int result, void *scratch, void *ctx) {
+  (void)ctx;
+  fingerprint_scratch_t *f = scratch;
+  fingerprint_job = NULL;
+
+  if (result != WALLY_OK || !fingerprint_text) {
+    set_fingerprint_visible(false);
+    return;
   }
-  bip32_key_free(master_key);
 
+  char fp_hex[BIP32_KEY_FINGERPRINT_LEN * 2 + 1];
   for (int i = 0; i < BIP32_KEY_FINGERPRINT_LEN; i++)
-    sprintf(hex_out + (i * 2), "%02x", fingerprint[i]);
-  hex_out[BIP32_KEY_FINGERPRINT_LEN * 2] = '\0';
-
-  return true;
+    sprintf(fp_hex + (i * 2), "%02x", f->fingerprint[i]);
+  lv_label_set_text(fingerprint_text, fp_hex);
+  set_fingerprint_visible(true);
 }
 
-static bool recalculate_last_word(void) {
-  if (total_words < 12)
-    return false;
-
-  // Calculate entropy and checksum sizes based on word count
-  // 12 words: 128 bits entropy + 4 bits checksum = 132 bits total
-  // 24 words: 256 bits entropy + 8 bits checksum = 264 bits total
-  size_t checksum_bits = total_words / 3; // 4 for 12 words, 8 for 24 words
-  size_t entropy_bits = (total_words * 11) - checksum_bits;
-  size_t entropy_bytes = entropy_bits / 8;
-  size_t last_word_entropy_bits = 11 - checksum_bits; // 7 for 12, 3 for 24
-
-  // Pack word indices (11 bits each) from first N-1 words
-  uint8_t packed[32] = {0};
-  int bit_pos = 0;
-
-  for (int i = 0; i < total_words - 1; i++) {
-    int idx = bip39_filter_get_word_index(entered_words[i]);
-    if (idx < 0)
-      return false;
+static void fingerprint_timer_cb(lv_timer_t *timer) {
+  (void)timer;
+  fingerprint_timer = NULL; // One-shot, deleted by LVGL after this returns
 
-    // Pack 11 bits into packed array
-    for (int b = 10; b >= 0; b--) {
-      int byte_idx = bit_pos / 8;
-      int bit_idx = 7 - (bit_pos % 8);
-      if (idx & (1 << b))
-        packed[byte_idx] |= (1 << bit_idx);
-      bit_pos++;
-    }
-  }
+  fingerprint_scratch_t init = {0};
+  if (!build_mnemonic(init.mnemonic, sizeof(init.mnemonic)))
+    return;
 
-  // Pack the entropy bits from the current last word (top bits only)
-  int last_idx = bip39_filter_get_word_index(entered_words[total_words - 1]);
-  if (last_idx >= 0) {
-    for (int b = 10; b > (int)(10 - last_word_entropy_bits); b--) {
-      int byte_idx = bit_pos / 8;
-      int bit_idx = 7 - (bit_pos % 8);
-      if (last_idx & (1 << b))
-        packed[byte_idx] |= (1 << bit_idx);
-      bit_pos++;
-    }
-  }
+  job_desc_t desc = {.run = fingerprint_run,
+                     .done = fingerprint_done,
+                     .scratch_init = &init,
+                     .scratch_len = sizeof(init)};
+  fingerprint_job = job_submit(&desc);
+  secure_memzero(&init, sizeof(init));
+}
 
-  // Generate mnemonic from entropy using libwally
-  char *new_mnemonic = NULL;
-  if (bip39_mnemonic_from_bytes(NULL, packed, entropy_bytes, &new_mnemonic) !=
-      WALLY_OK) {
-    return false;
+static void cancel_fingerprint(void) {
+  if (fingerprint_timer) {
+    lv_timer_del(fingerprint_timer);
+    fingerprint_timer = NULL;
   }
-
-  // Extract last word from generated mnemonic
-  char *last_space = strrchr(new_mnemonic, ' ');
-  if (last_space) {
-    strncpy(entered_words[total_words - 1], last_space + 1,
-            sizeof(entered_words[0]) - 1);
-    entered_words[total_words - 1][sizeof(entered_words[0]) - 1] = '\0';
+  if (fingerprint_job) {
+    job_cancel(fingerprint_job);
+    fingerprint_job = NULL;
   }
-
-  wally_free_string(new_mnemonic);
-  return true;
 }
 
 static void update_fingerprint_display(void) {
   if (!fingerprint_icon || !fingerprint_text)
     return;
+  if (fingerprint_version == words_version)
+    return; // Already shown, or being derived, for these words
+  fingerprint_version = words_version;
 
-  if (is_checksum_valid()) {
-    char fp_hex[9];
-    if (get_mnemonic_fingerprint_hex(fp_hex)) {
-      lv_label_set_text(fingerprint_text, fp_hex);
-      lv_obj_clear_flag(fingerprint_icon, LV_OBJ_FLAG_HIDDEN);
-      lv_obj_clear_flag(fingerprint_text, LV_OBJ_FLAG_HIDDEN);
-    } else {
-      lv_obj_add_flag(fingerprint_icon, LV_OBJ_FLAG_HIDDEN);
-      lv_obj_add_flag(fingerprint_text, LV_OBJ_FLAG_HIDDEN);
-    }
-  } else {
-    lv_obj_add_flag(fingerprint_icon, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_add_flag(fingerprint_text, LV_OBJ_FLAG_HIDDEN);
-  }
+  cancel_fingerprint();
+  set_fingerprint_visible(false);
+  if (!is_checksum_valid())
+    return;
+
+  fingerprint_timer =
+      lv_timer_create(fingerprint_timer_cb, FINGERPRINT_DEBOUNCE_MS, NULL);
+  if (fingerprint_timer)
+    lv_timer_set_repeat_count(fingerprint_timer, 1);
 }
 
 static void update_checksum_ui(void) {
@@ -247,25 +260,39 @@ static void filter_words_by_prefix(void) {
 
 static void parse_mnemonic(const char *mnemonic) {
   total_words = 0;
-  secure_memzero(entered_words, sizeof(entered_words));
-  secure_memzero(original_words, sizeof(original_words));
+  mnemonic_model_wipe(&entered);
+  mnemonic_model_wipe(&original);
 
   if (!mnemonic || !*mnemonic)
     return;
 
+  // Edit in the mnemonic's language; English if no list has every word
+  if (!bip39_filter_use_mnemonic_language(mnemonic))
+    bip39_filter_set_languages(BIP39_LANG_MASK(BIP39_LANG_EN));
+
   char mnemonic_copy[MAX_MNEMONIC_LEN];
   strncpy(mnemonic_copy, mnemonic, sizeof(mnemonic_copy) - 1);
   mnemonic_copy[sizeof(mnemonic_copy) - 1] = '\0';
 
-  char *token = strtok(mnemonic_copy, " ");
-  while (token && total_words < 24) {
-    strncpy(entered_words[total_words], token, sizeof(entered_words[0]) - 1);
-    entered_words[total_words][sizeof(entered_words[0]) - 1] = '\0';
-    strncpy(original_words[total_words], token, sizeof(original_words[0]) - 1);
-    original_words[total_words][sizeof(original_words[0]) - 1] = '\0';
-    total_words++;
-    token = strtok(NULL, " ");
+  // Count first so the model is sized before any word goes in
+  char *tokens[MNEMONIC_MODEL_MAX_WORDS];
+  uint16_t indices[MNEMONIC_MODEL_MAX_WORDS];
+  total_words = (int)bip39_lang_split(mnemonic_copy, tokens,
+                                      MNEMONIC_MODEL_MAX_WORDS);
+  for (int i = 0; i < total_words; i++) {
+    int idx = bip39_filter_get_word_index(tokens[i]);
+    indices[i] = idx >= 0 ? (uint16_t)idx : (uint16_t)MNEMONIC_MODEL_NO_WORD;
+  }
+  secure_memzero(mnemonic_copy, sizeof(mnemonic_copy));
+
+  if (total_words > 0) {
+    mnemonic_model_init(&entered, total_words);
+    for (int i = 0; i < total_words; i++)
+      mnemonic_model_set(&entered, i, indices[i]);
+    original = entered;
   }
+  secure_memzero(indices, sizeof(indices));
+  words_version++;
 }
 
 static void cleanup_editing_ui(void) {
@@ -288,10 +315,10 @@ static void update_word_label(int index) {
     return;
 
   char text[24];
-  snprintf(text, sizeof(text), "%2d. %s", index + 1, entered_words[index]);
+  snprintf(text, sizeof(text), "%2d. %s", index + 1, word_text(index));
   lv_label_set_text(word_labels[index], text);
 
-  bool changed = strcmp(entered_words[index], original_words[index]) != 0;
+  bool changed = entered.words[index] != original.words[index];
   lv_obj_set_style_text_color(word_labels[index],
                               changed ? highlight_color() : main_color(), 0);
 }
@@ -339,7 +366,8 @@ static void word_clicked_cb(lv_event_t *e) {
     return;
 
   editing_word_index = index;
-  strncpy(current_prefix, entered_words[index], BIP39_MAX_PREFIX_LEN);
+  const char *word = bip39_filter_get_word(entered.words[index]);
+  strncpy(current_prefix, word ? word : "", BIP39_MAX_PREFIX_LEN);
   current_prefix[BIP39_MAX_PREFIX_LEN] = '\0';
   prefix_len = strlen(current_prefix);
 
@@ -393,8 +421,7 @@ static void show_keyboard_for_word(int index) {
 }
 
 static void show_word_confirmation(const char *word) {
-  strncpy(pending_word, word, sizeof(pending_word) - 1);
-  pending_word[sizeof(pending_word) - 1] = '\0';
+  pending_index = bip39_filter_get_word_index(word);
 
   char msg[64];
   snprintf(msg, sizeof(msg), "Word %d: %s", editing_word_index + 1, word);
@@ -405,10 +432,10 @@ static void show_word_confirmation(const char *word) {
 static void word_confirmation_cb(bool confirmed, void *user_data) {
   (void)user_data;
 
-  if (confirmed) {
-    snprintf(entered_words[editing_word_index], sizeof(entered_words[0]), "%s",
-             pending_word);
-    pending_word[0] = '\0';
+  if (confirmed && pending_index >= 0) {
+    mnemonic_model_set(&entered, editing_word_index, (uint16_t)pending_index);
+    pending_index = -1;
+    words_version++;
     update_word_label(editing_word_index);
 
     if (is_new_mnemonic) {
@@ -424,7 +451,7 @@ static void word_confirmation_cb(bool confirmed, void *user_data) {
 
     return_to_word_grid();
   } else {
-    pending_word[0] = '\0';
+    pending_index = -1;
     if (current_menu) {
       ui_menu_destroy(current_menu);
       current_menu = NULL;
@@ -542,16 +569,7 @@ static void load_btn_cb(lv_event_t *e) {
   (void)e;
 
   char mnemonic[MAX_MNEMONIC_LEN];
-  mnemonic[0] = '\0';
-
-  for (int i = 0; i < total_words; i++) {
-    if (i > 0)
-      strncat(mnemonic, " ", sizeof(mnemonic) - strlen(mnemonic) - 1);
-    strncat(mnemonic, entered_words[i],
-            sizeof(mnemonic) - strlen(mnemonic) - 1);
-  }
-
-  if (bip39_mnemonic_validate(NULL, mnemonic) != WALLY_OK) {
+  if (!is_checksum_valid() || !build_mnemonic(mnemonic, sizeof(mnemonic))) {
     dialog_show_error("Invalid checksum", NULL, 0);
     return;
   }
@@ -588,7 +606,7 @@ static lv_obj_t *create_column(lv_obj_t *parent, int x, int width, int height) {
 static lv_obj_t *create_word_button(lv_obj_t *parent, int index, int height,
                                     lv_color_t bg) {
   char text[24];
-  snprintf(text, sizeof(text), "%2d. %s", index + 1, entered_words[index]);
+  snprintf(text, sizeof(text), "%2d. %s", index + 1, word_text(index));
 
   lv_obj_t *btn = lv_btn_create(parent);
   lv_obj_set_size(btn, LV_PCT(100), height);
@@ -762,6 +780,7 @@ void mnemonic_editor_page_hide(void) {
 
 void mnemonic_editor_page_destroy(void) {
   cleanup_editing_ui();
+  cancel_fingerprint();
 
   if (mnemonic_editor_screen) {
     lv_obj_del(mnemonic_editor_screen);
@@ -778,10 +797,10 @@ void mnemonic_editor_page_destroy(void) {
   checksum_error_label = NULL;
   is_new_mnemonic = false;
   memset(word_labels, 0, sizeof(word_labels));
-  secure_memzero(entered_words, sizeof(entered_words));
-  secure_memzero(original_words, sizeof(original_words));
+  mnemonic_model_wipe(&entered);
+  mnemonic_model_wipe(&original);
   secure_memzero(current_prefix, sizeof(current_prefix));
-  secure_memzero(pending_word, sizeof(pending_word));
+  pending_index = -1;
 
   return_callback = NULL;
   success_callback = NULL;
@@ -800,19 +819,10 @@ char *mnemonic_editor_get_mnemonic(void) {
   if (!mnemonic)
     return NULL;
 
-  size_t pos = 0;
-  for (int i = 0; i < total_words && pos < MAX_MNEMONIC_LEN - 1; i++) {
-    if (i > 0 && pos < MAX_MNEMONIC_LEN - 1) {
-      mnemonic[pos++] = ' ';
-    }
-    size_t word_len = strlen(entered_words[i]);
-    size_t copy_len = (pos + word_len < MAX_MNEMONIC_LEN)
-                          ? word_len
-                          : MAX_MNEMONIC_LEN - 1 - pos;
-    memcpy(mnemonic + pos, entered_words[i], copy_len);
-    pos += copy_len;
+  if (!build_mnemonic(mnemonic, MAX_MNEMONIC_LEN)) {
+    secure_memzero(mnemonic, MAX_MNEMONIC_LEN);
+    free(mnemonic);
+    return NULL;
   }
-  mnemonic[pos] = '\0';
-
   return mnemonic;
 }
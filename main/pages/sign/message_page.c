@@ -0,0 +1,310 @@
+// Message Page
+
+#include "message_page.h"
+#include "../../core/key.h"
+#include "../../core/message.h"
+#include "../../core/wallet.h"
+#include "../../qr/scanner.h"
+#include "../../qr/viewer.h"
+#include "../../ui/dialog.h"
+#include "../../ui/input_helpers.h"
+#include "../../ui/menu.h"
+#include "../../ui/theme.h"
+#include <lvgl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wally_core.h>
+
+/*
+ * Sign: scan a plain-text message or "signmessage <path> ascii:<msg>",
+ * review the message and the address it signs for, then export the
+ * base64 signature as a QR code.
+ *
+ * Verify: scan an armored signed message (as Electrum, Sparrow and
+ * Bitcoin Core's GUI copy it) and check it against its address.
+ */
+
+// Longest message excerpt shown in the verify result
+#define VERIFY_EXCERPT_LEN 160
+
+static lv_obj_t *message_screen = NULL;
+static lv_obj_t *review_view = NULL;
+static ui_menu_t *action_menu = NULL;
+static void (*return_callback)(void) = NULL;
+
+static char *pending_message = NULL;
+static size_t pending_len = 0;
+static message_target_t target;
+
+static void show_action_menu(void);
+
+static void finish(void) {
+  if (return_callback)
+    return_callback();
+}
+
+static void clear_request(void) {
+  free(pending_message);
+  pending_message = NULL;
+  pending_len = 0;
+  message_target_clear(&target);
+}
+
+static void close_review(void) {
+  if (review_view) {
+    lv_obj_del(review_view);
+    review_view = NULL;
+  }
+  clear_request();
+}
+
+/* ---------- Sign ---------- */
+
+static void return_from_signature_cb(void) {
+  qr_viewer_page_destroy();
+  message_page_show();
+  show_action_menu();
+}
+
+static void sign_btn_cb(lv_event_t *e) {
+  message_format_t format =
+      (message_format_t)(intptr_t)lv_event_get_user_data(e);
+
+  char *signature = NULL;
+  if (!message_sign(&target, pending_message, pending_len, format,
+                    &signature)) {
+    close_review();
+    dialog_show_error("Failed to sign message", show_action_menu, 0);
+    return;
+  }
+  close_review();
+
+  message_page_hide();
+  qr_viewer_page_create(lv_screen_active(), signature, "Signature",
+                        return_from_signature_cb);
+  wally_free_string(signature);
+  qr_viewer_page_show();
+}
+
+static void review_back_cb(lv_event_t *e) {
+  (void)e;
+  close_review();
+  show_action_menu();
+}
+
+static void add_sign_button(lv_obj_t *row, const char *text,
+                            message_format_t format) {
+  if (!message_format_supported(target.type, format))
+    return;
+  lv_obj_t *btn = theme_create_button(row, text, true);
+  lv_obj_add_event_cb(btn, sign_btn_cb, LV_EVENT_CLICKED,
+                      (void *)(intptr_t)format);
+}
+
+static void show_review(void) {
+  review_view = theme_create_page_container(message_screen);
+  lv_obj_set_style_pad_all(review_view, theme_get_default_padding(), 0);
+  lv_obj_set_flex_flow(review_view, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_flex_align(review_view, LV_FLEX_ALIGN_START,
+                        LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+  lv_obj_set_style_pad_gap(review_view, theme_get_default_padding(), 0);
+
+  theme_create_page_title(review_view, "Sign Message");
+
+  // The message may be long; it scrolls inside its own frame
+  lv_obj_t *frame = lv_obj_create(review_view);
+  lv_obj_set_width(frame, LV_PCT(100));
+  lv_obj_set_flex_grow(frame, 1);
+  theme_apply_frame(frame);
+  lv_obj_t *message_label =
+      theme_create_label(frame, pending_message, false);
+  lv_obj_set_width(message_label, LV_PCT(100));
+  lv_label_set_long_mode(message_label, LV_LABEL_LONG_WRAP);
+
+  lv_obj_t *address_label = theme_create_label(review_view, target.address,
+                                               false);
+  lv_obj_set_width(address_label, LV_PCT(95));
+  lv_label_set_long_mode(address_label, LV_LABEL_LONG_WRAP);
+  lv_obj_set_style_text_align(address_label, LV_TEXT_ALIGN_CENTER, 0);
+  lv_obj_set_style_text_color(address_label, cyan_color(), 0);
+
+  theme_create_label(review_view, target.path_str, true);
+
+  lv_obj_t *action_row = theme_create_flex_row(review_view);
+  add_sign_button(action_row, "Sign (BIP322)", MESSAGE_FORMAT_BIP322);
+  add_sign_button(action_row, "Sign (Legacy)", MESSAGE_FORMAT_LEGACY);
+
+  lv_obj_t *back_btn = ui_create_back_button(review_view, review_back_cb);
+  lv_obj_add_flag(back_btn, LV_OBJ_FLAG_IGNORE_LAYOUT);
+}
+
+static void return_from_sign_scan_cb(void) {
+  size_t len = 0;
+  char *content = qr_scanner_get_completed_content_with_len(&len);
+  qr_scanner_page_destroy();
+  message_page_show();
+
+  if (!content) {
+    show_action_menu();
+    return;
+  }
+
+  message_sign_request_t req;
+  if (message_sign_parse_request(content, len, &req) != MESSAGE_SIGN_OK) {
+    free(content);
+    dialog_show_error("Invalid sign request", show_action_menu, 0);
+    return;
+  }
+
+  clear_request();
+  pending_message = malloc(req.message_len + 1);
+  if (pending_message) {
+    memcpy(pending_message, req.message, req.message_len);
+    pending_message[req.message_len] = '\0';
+    pending_len = req.message_len;
+  }
+  bool resolved = pending_message && message_resolve_target(&req, &target);
+  free(content);
+  if (!resolved) {
+    clear_request();
+    dialog_show_error("Cannot derive the signing key", show_action_menu, 0);
+    return;
+  }
+  if (!message_format_supported(target.type, MESSAGE_FORMAT_LEGACY) &&
+      !message_format_supported(target.type, MESSAGE_FORMAT_BIP322)) {
+    clear_request();
+    dialog_show_error("Address type cannot sign messages", show_action_menu,
+                      0);
+    return;
+  }
+
+  show_review();
+}
+
+/* ---------- Verify ---------- */
+
+static void verify_done_cb(void *user_data) {
+  (void)user_data;
+  show_action_menu();
+}
+
+static void return_from_verify_scan_cb(void) {
+  size_t len = 0;
+  char *content = qr_scanner_get_completed_content_with_len(&len);
+  qr_scanner_page_destroy();
+  message_page_show();
+
+  if (!content) {
+    show_action_menu();
+    return;
+  }
+
+  message_sign_signed_t signed_msg;
+  if (message_sign_parse_signed(content, len, &signed_msg) !=
+      MESSAGE_SIGN_OK) {
+    free(content);
+    dialog_show_error("Not a signed message", show_action_menu, 0);
+    return;
+  }
+
+  message_verify_result_t result = message_verify(
+      &signed_msg, wallet_get_network() == WALLET_NETWORK_TESTNET);
+
+  char text[VERIFY_EXCERPT_LEN + 160];
+  if (result == MESSAGE_VERIFY_VALID) {
+    int excerpt = signed_msg.message_len > VERIFY_EXCERPT_LEN
+                      ? VERIFY_EXCERPT_LEN
+                      : (int)signed_msg.message_len;
+    snprintf(text, sizeof(text), "Signed by\n%.*s\n\n%.*s%s",
+             (int)signed_msg.address_len, signed_msg.address, excerpt,
+             signed_msg.message,
+             signed_msg.message_len > VERIFY_EXCERPT_LEN ? "..." : "");
+  }
+  free(content);
+
+  switch (result) {
+  case MESSAGE_VERIFY_VALID:
+    dialog_show_info("Valid Signature", text, verify_done_cb, NULL,
+                     DIALOG_STYLE_FULLSCREEN);
+    break;
+  case MESSAGE_VERIFY_BAD_ADDRESS:
+    dialog_show_error("Unsupported address or wrong network",
+                      show_action_menu, 0);
+    break;
+  case MESSAGE_VERIFY_BAD_SIGNATURE:
+    dialog_show_error("Malformed signature", show_action_menu, 0);
+    break;
+  default:
+    dialog_show_error("Invalid signature", show_action_menu, 0);
+    break;
+  }
+}
+
+/* ---------- Menu ---------- */
+
+static void start_scan(void (*scan_cb)(void)) {
+  ui_menu_destroy(action_menu);
+  action_menu = NULL;
+  message_page_hide();
+  qr_scanner_page_create(NULL, scan_cb);
+  qr_scanner_page_show();
+}
+
+static void menu_sign_cb(void) { start_scan(return_from_sign_scan_cb); }
+
+static void menu_verify_cb(void) { start_scan(return_from_verify_scan_cb); }
+
+static void show_action_menu(void) {
+  if (action_menu)
+    ui_menu_destroy(action_menu);
+
+  action_menu = ui_menu_create(message_screen, "Message", finish);
+  if (!action_menu)
+    return;
+
+  ui_menu_add_entry(action_menu, "Sign", menu_sign_cb);
+  ui_menu_add_entry(action_menu, "Verify", menu_verify_cb);
+  ui_menu_show(action_menu);
+}
+
+void message_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
+  if (!parent || !key_is_loaded())
+    return;
+
+  return_callback = return_cb;
+  memset(&target, 0, sizeof(target));
+
+  message_screen = theme_create_page_container(parent);
+  show_action_menu();
+}
+
+void message_page_show(void) {
+  if (message_screen)
+    lv_obj_clear_flag(message_screen, LV_OBJ_FLAG_HIDDEN);
+  if (action_menu)
+    ui_menu_show(action_menu);
+}
+
+void message_page_hide(void) {
+  if (message_screen)
+    lv_obj_add_flag(message_screen, LV_OBJ_FLAG_HIDDEN);
+  if (action_menu)
+    ui_menu_hide(action_menu);
+}
+
+void message_page_destroy(void) {
+  qr_scanner_page_destroy();
+  if (action_menu) {
+    ui_menu_destroy(action_menu);
+    action_menu = NULL;
+  }
+  if (message_screen) {
+    lv_obj_del(message_screen);
+    message_screen = NULL;
+  }
+  review_view = NULL;
+  clear_request();
+  return_callback = NULL;
+}
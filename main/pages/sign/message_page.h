@@ -0,0 +1,33 @@
+/*
+ * Message Page
+ * Signs scanned messages (legacy or BIP322) and verifies signed ones
+ */
+
+#ifndef MESSAGE_PAGE_H
+#define MESSAGE_PAGE_H
+
+#include <lvgl.h>
+
+/**
+ * Create the message page
+ * @param parent Parent LVGL object
+ * @param return_cb Callback to call when returning from this page
+ */
+void message_page_create(lv_obj_t *parent, void (*return_cb)(void));
+
+/**
+ * Show the message page
+ */
+void message_page_show(void);
+
+/**
+ * Hide the message page
+ */
+void message_page_hide(void);
+
+/**
+ * Destroy the message page and free resources
+ */
+void message_page_destroy(void);
+
+#endif // MESSAGE_PAGE_H
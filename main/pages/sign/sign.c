@@ -5,8 +5,10 @@
 
 #include "sign.h"
 #include "../../../components/cUR/src/types/psbt.h"
+#include "../../core/descriptor_index.h"
 #include "../../core/key.h"
 #include "../../core/psbt.h"
+#include "../../core/settings.h"
 #include "../../core/storage.h"
 #include "../../core/wallet.h"
 #include "../../qr/parser.h"
@@ -22,7 +24,9 @@
 #include <esp_log.h>
 #include <lvgl.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <tx_weight.h>
 #include <wally_core.h>
 #include <wally_psbt.h>
 #include <wally_psbt_members.h>
@@ -66,7 +70,6 @@ static bool parse_and_display_psbt(const char *base64_data);
 static void cleanup_psbt_data(void);
 static bool create_psbt_info_display(void);
 static output_type_t classify_output(size_t output_index,
-                                     const struct wally_tx_output *tx_output,
                                      const struct wally_tx *global_tx,
                                      uint32_t *address_index_out);
 static void sign_button_cb(lv_event_t *e);
@@ -74,6 +77,7 @@ static void return_from_qr_viewer_cb(void);
 static bool check_psbt_mismatch(void);
 static void mismatch_dialog_cb(void *user_data);
 static void show_multisig_options_menu(void);
+static void load_matching_descriptor(void);
 static void return_from_descriptor_scanner_cb(void);
 
 // Format satoshis as Bitcoin with visual grouping: "1.00 000 000"
@@ -161,7 +165,6 @@ static lv_obj_t *create_btc_value_row(lv_obj_t *parent, const char *prefix,
 
 // Classify output as self-transfer, change, or spend
 static output_type_t classify_output(size_t output_index,
-                                     const struct wally_tx_output *tx_output,
                                      const struct wally_tx *global_tx,
                                      uint32_t *address_index_out) {
   bool is_change = false;
@@ -183,20 +186,10 @@ static output_type_t classify_output(size_t output_index,
     return OUTPUT_TYPE_SPEND;
   }
 
-  // Single-sig: Check if output has verified derivation path for our wallet
-  if (!psbt_get_output_derivation(current_psbt, output_index, is_testnet,
-                                  &is_change, &address_index)) {
-    return OUTPUT_TYPE_SPEND;
-  }
-
-  // Verify scriptPubKey matches derived address
-  unsigned char expected_script[WALLY_WITNESSSCRIPT_MAX_LEN];
-  size_t expected_script_len;
-
-  if (!wallet_get_scriptpubkey(is_change, address_index, expected_script,
-                               &expected_script_len) ||
-      tx_output->script_len != expected_script_len ||
-      memcmp(tx_output->script, expected_script, expected_script_len) != 0) {
+  // Single-sig: the output script must match the address its derivation
+  // path describes, for whichever purpose the path uses
+  if (!psbt_get_output_derivation(current_psbt, output_index, global_tx,
+                                  is_testnet, &is_change, &address_index)) {
     return OUTPUT_TYPE_SPEND;
   }
 
@@ -267,7 +260,7 @@ static void return_from_qr_scanner_cb(void) {
 
     // Check if this is a multisig PSBT without a loaded descriptor
     if (psbt_is_multisig(current_psbt) && !wallet_has_descriptor()) {
-      show_multisig_options_menu();
+      load_matching_descriptor();
     } else {
       if (!create_psbt_info_display()) {
         dialog_show_error("Invalid PSBT data", return_callback, 0);
@@ -420,6 +413,8 @@ static bool create_psbt_info_display(void) {
   uint64_t fee = (total_input_value > total_output_value)
                      ? (total_input_value - total_output_value)
                      : 0;
+  uint32_t vsize = 0;
+  bool have_vsize = psbt_estimate_vsize(current_psbt, global_tx, &vsize);
 
   // Allocate for outputs + fee (if non-zero)
   size_t diagram_output_count = num_outputs + (fee > 0 ? 1 : 0);
@@ -442,8 +437,7 @@ static bool create_psbt_info_display(void) {
         global_tx->outputs[i].script, global_tx->outputs[i].script_len,
         is_testnet);
     classified_outputs[i].type =
-        classify_output(i, &global_tx->outputs[i], global_tx,
-                        &classified_outputs[i].address_index);
+        classify_output(i, global_tx, &classified_outputs[i].address_index);
   }
 
   // Build diagram arrays in display order: self-transfer, change, spend, fee
@@ -677,6 +671,35 @@ static bool create_psbt_info_display(void) {
     lv_obj_t *fee_row =
         create_btc_value_row(psbt_info_container, "Fee: ", fee, error_color());
     lv_obj_set_width(fee_row, LV_PCT(100));
+
+    // Fee rate from the estimated signed size; absent for input types the
+    // estimator can't size
+    if (have_vsize) {
+      uint64_t rate_x10 = tx_weight_fee_rate_x10(fee, vsize);
+      uint16_t max_rate = settings_get_max_fee_rate();
+      bool absurd = rate_x10 > (uint64_t)max_rate * 10;
+
+      char rate_text[64];
+      snprintf(rate_text, sizeof(rate_text), "~%llu.%llu sat/vB (%lu vB)",
+               (unsigned long long)(rate_x10 / 10),
+               (unsigned long long)(rate_x10 % 10), (unsigned long)vsize);
+      lv_obj_t *rate_label =
+          theme_create_label(psbt_info_container, rate_text, false);
+      lv_obj_set_style_text_color(
+          rate_label, absurd ? error_color() : secondary_color(), 0);
+      lv_obj_set_width(rate_label, LV_PCT(100));
+
+      if (absurd) {
+        char warn_text[64];
+        snprintf(warn_text, sizeof(warn_text),
+                 LV_SYMBOL_WARNING " Fee rate above %u sat/vB", max_rate);
+        lv_obj_t *warn_label =
+            theme_create_label(psbt_info_container, warn_text, false);
+        theme_apply_label(warn_label, true);
+        lv_obj_set_style_text_color(warn_label, error_color(), 0);
+        lv_obj_set_width(warn_label, LV_PCT(100));
+      }
+    }
   }
 
   lv_obj_t *button_container = lv_obj_create(psbt_info_container);
@@ -728,23 +751,17 @@ static void sign_button_cb(lv_event_t *e) {
   }
 
   if (signed_psbt_base64) {
-    wally_free_string(signed_psbt_base64);
+    free(signed_psbt_base64);
     signed_psbt_base64 = NULL;
   }
 
-  struct wally_psbt *trimmed_psbt = psbt_trim(current_psbt);
-  struct wally_psbt *export_psbt = trimmed_psbt ? trimmed_psbt : current_psbt;
-
-  int ret = wally_psbt_to_base64(export_psbt, 0, &signed_psbt_base64);
-
-  if (trimmed_psbt) {
-    wally_psbt_free(trimmed_psbt);
-  }
-
-  if (ret != WALLY_OK) {
+  unsigned char *encoded = NULL;
+  size_t encoded_len = 0;
+  if (!psbt_serialize_signed(current_psbt, true, &encoded, &encoded_len)) {
     dialog_show_error("Failed to encode PSBT", NULL, 2000);
     return;
   }
+  signed_psbt_base64 = (char *)encoded;
 
   saved_return_callback = return_callback;
 
@@ -785,7 +802,7 @@ static void cleanup_psbt_data(void) {
   }
 
   if (signed_psbt_base64) {
-    wally_free_string(signed_psbt_base64);
+    free(signed_psbt_base64);
     signed_psbt_base64 = NULL;
   }
 
@@ -921,6 +938,52 @@ static void show_multisig_options_menu(void) {
   ui_menu_show(multisig_menu);
 }
 
+// Load the stored descriptor the PSBT's cosigner keys belong to; the
+// multisig menu stays behind it for when there is none or it is declined
+static void load_matching_descriptor(void) {
+  storage_location_t loc = STORAGE_FLASH;
+  char filename[64];
+  descriptor_index_result_t result = descriptor_index_match_psbt(
+      current_psbt, &loc, filename, sizeof(filename));
+
+  show_multisig_options_menu();
+  if (!multisig_menu)
+    return;
+
+  if (result == DESCRIPTOR_INDEX_AMBIGUOUS) {
+    dialog_show_error("Several stored descriptors match this PSBT", NULL, 0);
+    return;
+  }
+  if (result == DESCRIPTOR_INDEX_MISMATCH) {
+    dialog_show_error("PSBT inputs belong to different stored descriptors",
+                      NULL, 0);
+    return;
+  }
+  if (result != DESCRIPTOR_INDEX_FOUND)
+    return;
+
+  uint8_t *data = NULL;
+  size_t data_len = 0;
+  bool encrypted = false;
+  if (storage_load_descriptor(loc, filename, &data, &data_len, &encrypted) !=
+      ESP_OK)
+    return;
+
+  char *descriptor_str = encrypted ? NULL : malloc(data_len + 1);
+  if (descriptor_str) {
+    memcpy(descriptor_str, data, data_len);
+    descriptor_str[data_len] = '\0';
+  }
+  free(data);
+  if (!descriptor_str)
+    return;
+
+  ui_menu_hide(multisig_menu);
+  descriptor_loader_process_string(descriptor_str, descriptor_validation_cb,
+                                   NULL);
+  free(descriptor_str);
+}
+
 void sign_page_create(lv_obj_t *parent, void (*return_cb)(void)) {
   if (!parent || !key_is_loaded()) {
     return;
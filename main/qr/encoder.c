@@ -1,4 +1,6 @@
 #include "encoder.h"
+#include "../utils/bip39_filter.h"
+#include "../utils/secure_mem.h"
 #include "../managed_components/lvgl__lvgl/src/libs/qrcode/qrcodegen.h"
 #include <ctype.h>
 #include <lvgl.h>
@@ -25,8 +27,13 @@ static bool looks_like_plaintext(const char *data, size_t len) {
     char c = data[i];
     if (c == ' ') {
       has_space = true;
-    } else if (isalpha((unsigned char)c)) {
-      has_letter = true;
+    } else if ((unsigned char)c == 0xE3 && i + 2 < len &&
+               (unsigned char)data[i + 1] == 0x80 &&
+               (unsigned char)data[i + 2] == 0x80) {
+      has_space = true; // Ideographic space between Japanese words
+      i += 2;
+    } else if (isalpha((unsigned char)c) || (unsigned char)c >= 0x80) {
+      has_letter = true; // UTF-8 bytes count: accented and kana words
     } else if (!isprint((unsigned char)c)) {
       return false;
     }
@@ -178,8 +185,10 @@ char *mnemonic_qr_to_mnemonic(const char *data, size_t len,
     return mnemonic_qr_seedqr_to_mnemonic(data, len);
 
   case MNEMONIC_QR_PLAINTEXT: {
+    // Plaintext may be in any available language; SeedQR is English only
+    bip39_filter_load_languages();
     char *mnemonic = strndup(data, len);
-    if (mnemonic && bip39_mnemonic_validate(NULL, mnemonic) != WALLY_OK) {
+    if (mnemonic && !bip39_filter_validate_mnemonic(mnemonic)) {
       free(mnemonic);
       return NULL;
     }
@@ -327,111 +336,98 @@ unsigned char *mnemonic_to_compact_seedqr(const char *mnemonic,
   return result;
 }
 
-lv_result_t qr_update_binary(lv_obj_t *qr_obj, const unsigned char *data,
-                             size_t len, qr_encode_result_t *result) {
-  if (!qr_obj || !data || len == 0 || len > qrcodegen_BUFFER_LEN_MAX) {
-    return LV_RESULT_INVALID;
+bool qr_matrix_encode_binary(const unsigned char *data, size_t len,
+                             qr_matrix_t *out) {
+  if (!out || !data || len == 0 || len > qrcodegen_BUFFER_LEN_MAX) {
+    return false;
   }
 
-  lv_draw_buf_t *draw_buf = lv_canvas_get_draw_buf(qr_obj);
-  if (!draw_buf) {
-    return LV_RESULT_INVALID;
-  }
-
-  int32_t canvas_size = draw_buf->header.w;
-  uint8_t *qr_code = malloc(qrcodegen_BUFFER_LEN_MAX);
+  out->modules = 0;
+  out->qrcode = malloc(qrcodegen_BUFFER_LEN_MAX);
   uint8_t *data_buf = malloc(qrcodegen_BUFFER_LEN_MAX);
-  if (!qr_code || !data_buf) {
-    free(qr_code);
+  if (!out->qrcode || !data_buf) {
+    free(out->qrcode);
+    out->qrcode = NULL;
     free(data_buf);
-    return LV_RESULT_INVALID;
+    return false;
   }
 
   memcpy(data_buf, data, len);
-  bool ok = qrcodegen_encodeBinary(data_buf, len, qr_code, qrcodegen_Ecc_LOW,
-                                   qrcodegen_VERSION_MIN, qrcodegen_VERSION_MAX,
-                                   qrcodegen_Mask_AUTO, true);
+  bool ok = qrcodegen_encodeBinary(data_buf, len, out->qrcode,
+                                   qrcodegen_Ecc_LOW, qrcodegen_VERSION_MIN,
+                                   qrcodegen_VERSION_MAX, qrcodegen_Mask_AUTO,
+                                   true);
+  secure_memzero(data_buf, qrcodegen_BUFFER_LEN_MAX);
   free(data_buf);
   if (!ok) {
-    free(qr_code);
-    return LV_RESULT_INVALID;
-  }
-
-  int32_t qr_size = qrcodegen_getSize(qr_code);
-  int32_t scale = canvas_size / qr_size;
-  int32_t margin = (canvas_size - (qr_size * scale)) / 2;
-
-  if (result) {
-    result->modules = qr_size;
-    result->scale = scale;
-  }
-
-  lv_draw_buf_clear(draw_buf, NULL);
-  lv_canvas_set_palette(qr_obj, 0,
-                        lv_color_to_32(lv_color_white(), LV_OPA_COVER));
-  lv_canvas_set_palette(qr_obj, 1,
-                        lv_color_to_32(lv_color_black(), LV_OPA_COVER));
-
-  uint8_t *buf = (uint8_t *)draw_buf->data + 8;
-  uint32_t stride = draw_buf->header.stride;
-
-  for (int32_t qy = 0; qy < qr_size; qy++) {
-    int32_t py = margin + qy * scale;
-    for (int32_t qx = 0; qx < qr_size; qx++) {
-      if (qrcodegen_getModule(qr_code, qx, qy)) {
-        int32_t px = margin + qx * scale;
-        for (int32_t dx = 0; dx < scale; dx++) {
-          int32_t x = px + dx;
-          buf[py * stride + (x >> 3)] |= (0x80 >> (x & 7));
-        }
-      }
-    }
-    uint8_t *src_row = buf + py * stride;
-    for (int32_t dy = 1; dy < scale; dy++) {
-      memcpy(buf + (py + dy) * stride, src_row, stride);
-    }
+    qr_matrix_free(out);
+    return false;
   }
 
-  free(qr_code);
-  lv_image_cache_drop(draw_buf);
-  lv_obj_invalidate(qr_obj);
-  return LV_RESULT_OK;
+  out->modules = qrcodegen_getSize(out->qrcode);
+  return true;
 }
 
-lv_result_t qr_update_optimal(lv_obj_t *qr_obj, const char *text,
-                              qr_encode_result_t *result) {
-  if (!qr_obj || !text || strlen(text) == 0 ||
+bool qr_matrix_encode_text(const char *text, qr_matrix_t *out) {
+  if (!out || !text || strlen(text) == 0 ||
       strlen(text) > qrcodegen_BUFFER_LEN_MAX) {
-    return LV_RESULT_INVALID;
+    return false;
   }
 
-  lv_draw_buf_t *draw_buf = lv_canvas_get_draw_buf(qr_obj);
-  if (!draw_buf) {
-    return LV_RESULT_INVALID;
-  }
-
-  int32_t canvas_size = draw_buf->header.w;
-  uint8_t *qr_code = malloc(qrcodegen_BUFFER_LEN_MAX);
+  out->modules = 0;
+  out->qrcode = malloc(qrcodegen_BUFFER_LEN_MAX);
   uint8_t *temp_buf = malloc(qrcodegen_BUFFER_LEN_MAX);
-  if (!qr_code || !temp_buf) {
-    free(qr_code);
+  if (!out->qrcode || !temp_buf) {
+    free(out->qrcode);
+    out->qrcode = NULL;
     free(temp_buf);
-    return LV_RESULT_INVALID;
+    return false;
   }
 
   // Use LOW ECC with boost for optimal density while maximizing error
   // correction within the chosen version. encodeText auto-selects
   // numeric/alphanumeric/byte mode.
-  bool ok = qrcodegen_encodeText(text, temp_buf, qr_code, qrcodegen_Ecc_LOW,
-                                 qrcodegen_VERSION_MIN, qrcodegen_VERSION_MAX,
-                                 qrcodegen_Mask_AUTO, true);
+  bool ok = qrcodegen_encodeText(text, temp_buf, out->qrcode,
+                                 qrcodegen_Ecc_LOW, qrcodegen_VERSION_MIN,
+                                 qrcodegen_VERSION_MAX, qrcodegen_Mask_AUTO,
+                                 true);
+  secure_memzero(temp_buf, qrcodegen_BUFFER_LEN_MAX);
   free(temp_buf);
   if (!ok) {
-    free(qr_code);
+    qr_matrix_free(out);
+    return false;
+  }
+
+  out->modules = qrcodegen_getSize(out->qrcode);
+  return true;
+}
+
+bool qr_matrix_get_module(const qr_matrix_t *matrix, int x, int y) {
+  return matrix && matrix->qrcode &&
+         qrcodegen_getModule(matrix->qrcode, x, y);
+}
+
+void qr_matrix_free(qr_matrix_t *matrix) {
+  if (!matrix)
+    return;
+  if (matrix->qrcode) {
+    secure_memzero(matrix->qrcode, qrcodegen_BUFFER_LEN_MAX);
+    free(matrix->qrcode);
+    matrix->qrcode = NULL;
+  }
+  matrix->modules = 0;
+}
+
+/* Draw a 1 bpp matrix into an lv_qrcode canvas, centred at integer scale */
+static lv_result_t draw_matrix(lv_obj_t *qr_obj, const qr_matrix_t *matrix,
+                               qr_encode_result_t *result) {
+  lv_draw_buf_t *draw_buf = lv_canvas_get_draw_buf(qr_obj);
+  if (!draw_buf) {
     return LV_RESULT_INVALID;
   }
 
-  int32_t qr_size = qrcodegen_getSize(qr_code);
+  int32_t canvas_size = draw_buf->header.w;
+  int32_t qr_size = matrix->modules;
   int32_t scale = canvas_size / qr_size;
   int32_t margin = (canvas_size - (qr_size * scale)) / 2;
 
@@ -453,7 +449,7 @@ lv_result_t qr_update_optimal(lv_obj_t *qr_obj, const char *text,
   for (int32_t qy = 0; qy < qr_size; qy++) {
     int32_t py = margin + qy * scale;
     for (int32_t qx = 0; qx < qr_size; qx++) {
-      if (qrcodegen_getModule(qr_code, qx, qy)) {
+      if (qrcodegen_getModule(matrix->qrcode, qx, qy)) {
         int32_t px = margin + qx * scale;
         for (int32_t dx = 0; dx < scale; dx++) {
           int32_t x = px + dx;
@@ -467,8 +463,29 @@ lv_result_t qr_update_optimal(lv_obj_t *qr_obj, const char *text,
     }
   }
 
-  free(qr_code);
   lv_image_cache_drop(draw_buf);
   lv_obj_invalidate(qr_obj);
   return LV_RESULT_OK;
 }
+
+lv_result_t qr_update_binary(lv_obj_t *qr_obj, const unsigned char *data,
+                             size_t len, qr_encode_result_t *result) {
+  qr_matrix_t matrix;
+  if (!qr_obj || !qr_matrix_encode_binary(data, len, &matrix)) {
+    return LV_RESULT_INVALID;
+  }
+  lv_result_t res = draw_matrix(qr_obj, &matrix, result);
+  qr_matrix_free(&matrix);
+  return res;
+}
+
+lv_result_t qr_update_optimal(lv_obj_t *qr_obj, const char *text,
+                              qr_encode_result_t *result) {
+  qr_matrix_t matrix;
+  if (!qr_obj || !qr_matrix_encode_text(text, &matrix)) {
+    return LV_RESULT_INVALID;
+  }
+  lv_result_t res = draw_matrix(qr_obj, &matrix, result);
+  qr_matrix_free(&matrix);
+  return res;
+}
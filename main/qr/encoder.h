@@ -148,4 +148,42 @@ unsigned char *mnemonic_to_compact_seedqr(const char *mnemonic,
 lv_result_t qr_update_binary(lv_obj_t *qr_obj, const unsigned char *data,
                              size_t len, qr_encode_result_t *result);
 
+/**
+ * @brief Encoded QR symbol, for callers that draw modules themselves
+ */
+typedef struct {
+  int modules;     /**< Side length in modules */
+  uint8_t *qrcode; /**< Encoder buffer; read with qr_matrix_get_module() */
+} qr_matrix_t;
+
+/**
+ * @brief Encode text (mode auto-selected, LOW ECC with boost)
+ *
+ * @param text Text to encode
+ * @param out Receives the symbol; release with qr_matrix_free()
+ * @return true on success
+ */
+bool qr_matrix_encode_text(const char *text, qr_matrix_t *out);
+
+/**
+ * @brief Encode binary data in byte mode
+ *
+ * @param data Binary data to encode
+ * @param len Length of the data
+ * @param out Receives the symbol; release with qr_matrix_free()
+ * @return true on success
+ */
+bool qr_matrix_encode_binary(const unsigned char *data, size_t len,
+                             qr_matrix_t *out);
+
+/**
+ * @brief Read one module (true = dark)
+ */
+bool qr_matrix_get_module(const qr_matrix_t *matrix, int x, int y);
+
+/**
+ * @brief Wipe and free an encoded symbol
+ */
+void qr_matrix_free(qr_matrix_t *matrix);
+
 #endif
@@ -231,6 +231,110 @@ static int compare_parts(const void *a, const void *b) {
   return part_a->index - part_b->index;
 }
 
+// Sort parts by index and sum their lengths (capped at 1MB)
+static bool order_parts(QRPartParser *parser, size_t *total_len) {
+  qsort(parser->parts, parser->parts_count, sizeof(QRPart *), compare_parts);
+
+  size_t total = 0;
+  for (int i = 0; i < parser->parts_count; i++) {
+    if (total + parser->parts[i]->data_len < total ||
+        total + parser->parts[i]->data_len > 1024 * 1024) {
+      return false;
+    }
+    total += parser->parts[i]->data_len;
+  }
+
+  *total_len = total;
+  return true;
+}
+
+// Decode ordered BBQr part payloads straight into out. For 'Z' the output is
+// still the compressed stream.
+static bool bbqr_decode_parts(QRPartParser *parser, uint8_t *out,
+                              size_t out_cap, size_t *out_len) {
+  BBQrDecoder dec;
+  bbqr_decoder_init(&dec, parser->bbqr->encoding, out, out_cap);
+  for (int i = 0; i < parser->parts_count; i++) {
+    if (!bbqr_decoder_update(&dec, parser->parts[i]->data,
+                             parser->parts[i]->data_len)) {
+      return false;
+    }
+  }
+  return bbqr_decoder_finish(&dec, out_len);
+}
+
+// Decode a 'Z' sequence into a scratch buffer and either report the inflated
+// size (out NULL) or inflate into out (*out_len holds its capacity)
+static bool bbqr_inflate_parts(QRPartParser *parser, size_t payload_chars,
+                               uint8_t *out, size_t *out_len) {
+  size_t bound = bbqr_decoded_len_bound(BBQR_ENCODING_ZLIB, payload_chars);
+  uint8_t *compressed = (uint8_t *)malloc(bound ? bound : 1);
+  if (!compressed) {
+    return false;
+  }
+
+  size_t compressed_len;
+  bool ok = bbqr_decode_parts(parser, compressed, bound, &compressed_len);
+  if (ok) {
+    ok = out ? bbqr_inflate_into(compressed, compressed_len, out, out_len)
+             : bbqr_inflate_size(compressed, compressed_len, out_len);
+  }
+
+  free(compressed);
+  return ok;
+}
+
+// Decode a BBQr sequence into parser->bbqr->payload (NUL-terminated)
+static bool bbqr_assemble(QRPartParser *parser, size_t *result_len) {
+  size_t payload_chars;
+  if (!order_parts(parser, &payload_chars)) {
+    return false;
+  }
+
+  free(parser->bbqr->payload);
+  parser->bbqr->payload = NULL;
+
+  char encoding = parser->bbqr->encoding;
+  size_t bound = bbqr_decoded_len_bound(encoding, payload_chars);
+  uint8_t *decoded = NULL;
+  size_t decoded_len = 0;
+
+  if (encoding == BBQR_ENCODING_ZLIB) {
+    // Only the compressed stream is held alongside the output
+    size_t compressed_len;
+    uint8_t *compressed = (uint8_t *)malloc(bound ? bound : 1);
+    if (!compressed) {
+      return false;
+    }
+    if (bbqr_decode_parts(parser, compressed, bound, &compressed_len) &&
+        bbqr_inflate_size(compressed, compressed_len, &decoded_len)) {
+      decoded = (uint8_t *)malloc(decoded_len + 1);
+      if (decoded &&
+          !bbqr_inflate_into(compressed, compressed_len, decoded,
+                             &decoded_len)) {
+        free(decoded);
+        decoded = NULL;
+      }
+    }
+    free(compressed);
+  } else {
+    decoded = (uint8_t *)malloc(bound + 1);
+    if (decoded && !bbqr_decode_parts(parser, decoded, bound, &decoded_len)) {
+      free(decoded);
+      decoded = NULL;
+    }
+  }
+
+  if (!decoded) {
+    return false;
+  }
+
+  decoded[decoded_len] = '\0';
+  parser->bbqr->payload = (char *)decoded;
+  *result_len = decoded_len;
+  return true;
+}
+
 char *qr_parser_result(QRPartParser *parser, size_t *result_len) {
   if (parser->format == FORMAT_UR && parser->ur_decoder) {
     // For UR format, return a special marker string that indicates
@@ -245,74 +349,23 @@ char *qr_parser_result(QRPartParser *parser, size_t *result_len) {
   }
 
   if (parser->format == FORMAT_BBQR) {
-    // Sort parts by index
-    qsort(parser->parts, parser->parts_count, sizeof(QRPart *), compare_parts);
-
-    // Calculate total payload length
-    size_t total_payload_len = 0;
-    for (int i = 0; i < parser->parts_count; i++) {
-      if (total_payload_len + parser->parts[i]->data_len < total_payload_len ||
-          total_payload_len + parser->parts[i]->data_len > 1024 * 1024) {
-        return NULL;
-      }
-      total_payload_len += parser->parts[i]->data_len;
-    }
-
-    // Combine payloads
-    char *combined = (char *)malloc(total_payload_len + 1);
-    if (!combined) {
-      return NULL;
-    }
-
-    size_t offset = 0;
-    for (int i = 0; i < parser->parts_count; i++) {
-      memcpy(combined + offset, parser->parts[i]->data,
-             parser->parts[i]->data_len);
-      offset += parser->parts[i]->data_len;
-    }
-    combined[total_payload_len] = '\0';
-
-    // Decode payload (base32/hex decode + optional decompression)
-    size_t decoded_len = 0;
-    uint8_t *decoded = bbqr_decode_payload(parser->bbqr->encoding, combined,
-                                           total_payload_len, &decoded_len);
-    free(combined);
-
-    if (!decoded) {
+    // Hand the decoded buffer to the caller instead of copying it
+    size_t decoded_len;
+    if (!bbqr_assemble(parser, &decoded_len)) {
       return NULL;
     }
 
-    // Store decoded payload in bbqr structure
-    if (parser->bbqr->payload) {
-      free(parser->bbqr->payload);
-    }
-    parser->bbqr->payload = (char *)decoded;
-
+    char *result = parser->bbqr->payload;
+    parser->bbqr->payload = NULL;
     if (result_len) {
       *result_len = decoded_len;
     }
-
-    // Return a copy of the decoded data
-    char *result = (char *)malloc(decoded_len + 1);
-    if (!result) {
-      return NULL;
-    }
-    memcpy(result, decoded, decoded_len);
-    result[decoded_len] = '\0';
     return result;
   }
 
-  // Sort parts by index
-  qsort(parser->parts, parser->parts_count, sizeof(QRPart *), compare_parts);
-
-  // Calculate total length
-  size_t total_len = 0;
-  for (int i = 0; i < parser->parts_count; i++) {
-    if (total_len + parser->parts[i]->data_len < total_len ||
-        total_len + parser->parts[i]->data_len > 1024 * 1024) {
-      return NULL;
-    }
-    total_len += parser->parts[i]->data_len;
+  size_t total_len;
+  if (!order_parts(parser, &total_len)) {
+    return NULL;
   }
 
   // Combine parts
@@ -332,6 +385,62 @@ char *qr_parser_result(QRPartParser *parser, size_t *result_len) {
   return result;
 }
 
+bool qr_parser_result_size(QRPartParser *parser, size_t *size) {
+  if (!parser || !size || parser->format == FORMAT_UR) {
+    return false;
+  }
+
+  size_t total_len;
+  if (!order_parts(parser, &total_len)) {
+    return false;
+  }
+
+  if (parser->format != FORMAT_BBQR) {
+    *size = total_len;
+    return true;
+  }
+
+  if (parser->bbqr->encoding == BBQR_ENCODING_ZLIB) {
+    return bbqr_inflate_parts(parser, total_len, NULL, size);
+  }
+
+  *size = bbqr_decoded_len_bound(parser->bbqr->encoding, total_len);
+  return true;
+}
+
+bool qr_parser_result_into(QRPartParser *parser, uint8_t *buf, size_t buf_size,
+                           size_t *result_len) {
+  if (!parser || !buf || !result_len || parser->format == FORMAT_UR) {
+    return false;
+  }
+
+  size_t total_len;
+  if (!order_parts(parser, &total_len)) {
+    return false;
+  }
+
+  if (parser->format == FORMAT_BBQR) {
+    if (parser->bbqr->encoding == BBQR_ENCODING_ZLIB) {
+      *result_len = buf_size;
+      return bbqr_inflate_parts(parser, total_len, buf, result_len);
+    }
+    return bbqr_decode_parts(parser, buf, buf_size, result_len);
+  }
+
+  if (total_len > buf_size) {
+    return false;
+  }
+
+  size_t offset = 0;
+  for (int i = 0; i < parser->parts_count; i++) {
+    memcpy(buf + offset, parser->parts[i]->data, parser->parts[i]->data_len);
+    offset += parser->parts[i]->data_len;
+  }
+
+  *result_len = total_len;
+  return true;
+}
+
 static bool starts_with_case_insensitive(const char *str, const char *prefix) {
   while (*prefix) {
     if (tolower(*str) != tolower(*prefix))
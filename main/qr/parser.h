@@ -162,6 +162,9 @@ bool qr_parser_is_complete(QRPartParser *parser);
  * For UR format, this returns a special marker string "UR_RESULT".
  * Use qr_parser_get_ur_result() to get the actual UR data.
  *
+ * For BBQr the parts are decoded in index order straight into the returned
+ * buffer, which the caller takes over from the parser without a copy.
+ *
  * @param parser Parser instance
  * @param result_len Pointer to store the result length (optional)
  * @return Allocated string containing the result, or NULL on failure.
@@ -169,6 +172,34 @@ bool qr_parser_is_complete(QRPartParser *parser);
  */
 char *qr_parser_result(QRPartParser *parser, size_t *result_len);
 
+/**
+ * @brief Get the buffer size needed by qr_parser_result_into()
+ *
+ * For hex and base32 BBQr this is an upper bound computed from the part
+ * lengths; compressed BBQr is decoded once to learn the inflated size.
+ * Not available for UR.
+ *
+ * @param parser Parser instance (must be complete)
+ * @param size Pointer to store the required size in bytes
+ * @return true on success, false on failure
+ */
+bool qr_parser_result_size(QRPartParser *parser, size_t *size);
+
+/**
+ * @brief Assemble the result into a caller-supplied buffer
+ *
+ * Decodes the parts in index order directly into buf, with no intermediate
+ * concatenation. The output is not NUL-terminated. Not available for UR.
+ *
+ * @param parser Parser instance (must be complete)
+ * @param buf Output buffer
+ * @param buf_size Size of buf, see qr_parser_result_size()
+ * @param result_len Pointer to store the number of bytes written
+ * @return true on success, false on invalid data or a short buffer
+ */
+bool qr_parser_result_into(QRPartParser *parser, uint8_t *buf, size_t buf_size,
+                           size_t *result_len);
+
 /**
  * @brief Get the UR decoder result (for FORMAT_UR only)
  *
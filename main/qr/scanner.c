@@ -408,7 +408,7 @@ static void rgb565_to_grayscale_downsample(const uint8_t *rgb565_data,
 
 static void qr_decode_task(void *pvParameters) {
   qr_frame_data_t frame_data;
-  k_quirc_result_t qr_result;
+  k_quirc_result_t qr_result = {0};
 
   while (true) {
     if (closing || destruction_in_progress)
@@ -441,7 +441,7 @@ static void qr_decode_task(void *pvParameters) {
       gray_end = esp_timer_get_time();
       quirc_start = esp_timer_get_time();
 #endif
-      k_quirc_end(qr_decoder, false);
+      k_quirc_end(qr_decoder, true);
 #ifdef QR_PERF_DEBUG
       quirc_end = esp_timer_get_time();
 #endif
@@ -503,6 +503,7 @@ static void qr_decode_task(void *pvParameters) {
     }
   }
 
+  k_quirc_result_free(&qr_result);
   if (qr_task_done_sem)
     xSemaphoreGive(qr_task_done_sem);
   vTaskSuspend(NULL);
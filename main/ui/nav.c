@@ -2,144 +2,256 @@
 #include <string.h>
 
 #define NAV_MAX_PAGES 32
+#define NAV_ID_TABLE_SIZE 64 // Power of two, at most half full
 
 typedef struct {
   const nav_page_t *page;
+  bool retained; // Hidden but alive, off the stack
+  uint32_t last_used;
+} nav_slot_t;
+
+typedef struct {
+  nav_page_handle_t handle;
   void *params;
 } nav_stack_entry_t;
 
-static const nav_page_t *registered_pages[NAV_MAX_PAGES];
+static nav_slot_t pages[NAV_MAX_PAGES];
 static int num_registered = 0;
 
+// Open-addressed id -> handle index; lookups cost one hash and one strcmp
+static int8_t id_table[NAV_ID_TABLE_SIZE];
+
 static nav_stack_entry_t stack[NAV_MAX_STACK_DEPTH];
 static int stack_top = -1;
 
+static size_t retain_budget = NAV_DEFAULT_RETAIN_BUDGET;
+static uint32_t use_tick = 0;
+static nav_stats_t stats;
+
 static void *root_parent = NULL;
 
-static const nav_page_t *find_page(const char *id) {
+static uint32_t hash_id(const char *id) {
+  uint32_t h = 2166136261u;
+  while (*id)
+    h = (h ^ (uint8_t)*id++) * 16777619u;
+  return h;
+}
+
+// Slot for id: its entry if registered, else the empty slot to insert into
+static int id_slot(const char *id) {
+  uint32_t i = hash_id(id) & (NAV_ID_TABLE_SIZE - 1);
+  while (id_table[i] >= 0 && strcmp(pages[id_table[i]].page->id, id) != 0)
+    i = (i + 1) & (NAV_ID_TABLE_SIZE - 1);
+  return (int)i;
+}
+
+static bool on_stack(nav_page_handle_t h) {
+  for (int i = 0; i <= stack_top; i++) {
+    if (stack[i].handle == h)
+      return true;
+  }
+  return false;
+}
+
+static void destroy_page(nav_slot_t *slot) {
+  if (slot->page->destroy)
+    slot->page->destroy();
+  stats.destroys++;
+}
+
+static bool evict_lru(void) {
+  nav_slot_t *oldest = NULL;
   for (int i = 0; i < num_registered; i++) {
-    if (strcmp(registered_pages[i]->id, id) == 0) {
-      return registered_pages[i];
-    }
+    if (pages[i].retained &&
+        (!oldest || pages[i].last_used < oldest->last_used))
+      oldest = &pages[i];
   }
-  return NULL;
+  if (!oldest)
+    return false;
+  oldest->retained = false;
+  stats.retained_bytes -= oldest->page->retain_bytes;
+  stats.evictions++;
+  destroy_page(oldest);
+  return true;
+}
+
+// Bring a page onto the screen, reusing its retained instance if any
+static void enter_page(nav_page_handle_t h, void *params) {
+  nav_slot_t *slot = &pages[h];
+  if (slot->retained) {
+    slot->retained = false;
+    stats.retained_bytes -= slot->page->retain_bytes;
+    stats.resumes++;
+    if (slot->page->resume)
+      slot->page->resume(params);
+  } else {
+    stats.creates++;
+    if (slot->page->create)
+      slot->page->create(root_parent, params);
+  }
+  if (slot->page->show)
+    slot->page->show();
+  slot->last_used = ++use_tick;
+}
+
+// Take a page off the stack: keep it hidden if it fits, else destroy it
+static void leave_page(nav_page_handle_t h) {
+  nav_slot_t *slot = &pages[h];
+  if (slot->page->hide)
+    slot->page->hide();
+
+  // A page still live lower in the stack shares its static state with
+  // this instance, so it can't be kept separately
+  size_t bytes = slot->page->retain_bytes;
+  if (bytes == 0 || bytes > retain_budget || on_stack(h)) {
+    destroy_page(slot);
+    return;
+  }
+  while (stats.retained_bytes + bytes > retain_budget && evict_lru())
+    ;
+  slot->retained = true;
+  slot->last_used = ++use_tick;
+  stats.retained_bytes += bytes;
+}
+
+static bool valid_handle(nav_page_handle_t h) {
+  return h >= 0 && h < num_registered;
 }
 
 void nav_init(void *parent) {
   root_parent = parent;
   stack_top = -1;
   num_registered = 0;
+  memset(pages, 0, sizeof(pages));
+  memset(id_table, -1, sizeof(id_table));
+  retain_budget = NAV_DEFAULT_RETAIN_BUDGET;
+  use_tick = 0;
+  memset(&stats, 0, sizeof(stats));
 }
 
-void nav_register(const nav_page_t *page) {
-  if (num_registered < NAV_MAX_PAGES && page) {
-    registered_pages[num_registered++] = page;
-  }
+nav_page_handle_t nav_register(const nav_page_t *page) {
+  if (num_registered >= NAV_MAX_PAGES || !page || !page->id)
+    return NAV_INVALID_PAGE;
+  int slot = id_slot(page->id);
+  if (id_table[slot] >= 0)
+    return NAV_INVALID_PAGE;
+
+  nav_page_handle_t h = num_registered++;
+  pages[h].page = page;
+  id_table[slot] = (int8_t)h;
+  return h;
 }
 
-bool nav_push(const char *page_id, void *params) {
-  if (stack_top >= NAV_MAX_STACK_DEPTH - 1) {
-    return false;
-  }
+nav_page_handle_t nav_find(const char *page_id) {
+  if (!page_id)
+    return NAV_INVALID_PAGE;
+  int slot = id_slot(page_id);
+  return id_table[slot] >= 0 ? id_table[slot] : NAV_INVALID_PAGE;
+}
 
-  const nav_page_t *page = find_page(page_id);
-  if (!page) {
+bool nav_push_handle(nav_page_handle_t handle, void *params) {
+  if (stack_top >= NAV_MAX_STACK_DEPTH - 1 || !valid_handle(handle)) {
     return false;
   }
 
-  if (stack_top >= 0 && stack[stack_top].page->hide) {
-    stack[stack_top].page->hide();
+  if (stack_top >= 0 && pages[stack[stack_top].handle].page->hide) {
+    pages[stack[stack_top].handle].page->hide();
   }
 
   stack_top++;
-  stack[stack_top].page = page;
+  stack[stack_top].handle = handle;
   stack[stack_top].params = params;
-
-  if (page->create) {
-    page->create(root_parent, params);
-  }
-  if (page->show) {
-    page->show();
-  }
-
+  enter_page(handle, params);
   return true;
 }
 
+bool nav_push(const char *page_id, void *params) {
+  return nav_push_handle(nav_find(page_id), params);
+}
+
 bool nav_pop(void) {
   if (stack_top < 0) {
     return false;
   }
 
-  const nav_page_t *current = stack[stack_top].page;
-  if (current->hide) {
-    current->hide();
-  }
-  if (current->destroy) {
-    current->destroy();
-  }
-
+  nav_page_handle_t current = stack[stack_top].handle;
   stack_top--;
+  leave_page(current);
 
-  if (stack_top >= 0 && stack[stack_top].page->show) {
-    stack[stack_top].page->show();
+  if (stack_top >= 0) {
+    nav_slot_t *below = &pages[stack[stack_top].handle];
+    if (below->page->show)
+      below->page->show();
+    below->last_used = ++use_tick;
   }
 
   return true;
 }
 
-bool nav_replace(const char *page_id, void *params) {
-  const nav_page_t *page = find_page(page_id);
-  if (!page) {
+bool nav_replace_handle(nav_page_handle_t handle, void *params) {
+  if (!valid_handle(handle)) {
     return false;
   }
 
   if (stack_top >= 0) {
-    const nav_page_t *current = stack[stack_top].page;
-    if (current->hide) {
-      current->hide();
-    }
-    if (current->destroy) {
-      current->destroy();
-    }
-  } else {
-    stack_top = 0;
+    nav_page_handle_t current = stack[stack_top].handle;
+    stack_top--;
+    leave_page(current);
   }
 
-  stack[stack_top].page = page;
+  stack_top++;
+  stack[stack_top].handle = handle;
   stack[stack_top].params = params;
-
-  if (page->create) {
-    page->create(root_parent, params);
-  }
-  if (page->show) {
-    page->show();
-  }
-
+  enter_page(handle, params);
   return true;
 }
 
+bool nav_replace(const char *page_id, void *params) {
+  return nav_replace_handle(nav_find(page_id), params);
+}
+
 void nav_pop_to_root(void) {
   while (stack_top > 0) {
-    const nav_page_t *current = stack[stack_top].page;
-    if (current->hide) {
-      current->hide();
-    }
-    if (current->destroy) {
-      current->destroy();
-    }
+    nav_page_handle_t current = stack[stack_top].handle;
     stack_top--;
+    leave_page(current);
   }
 
-  if (stack_top >= 0 && stack[stack_top].page->show) {
-    stack[stack_top].page->show();
+  if (stack_top >= 0 && pages[stack[stack_top].handle].page->show) {
+    pages[stack[stack_top].handle].page->show();
   }
 }
 
 const char *nav_current_page_id(void) {
   if (stack_top >= 0) {
-    return stack[stack_top].page->id;
+    return pages[stack[stack_top].handle].page->id;
   }
   return NULL;
 }
 
 int nav_stack_depth(void) { return stack_top + 1; }
+
+void nav_set_retain_budget(size_t bytes) {
+  retain_budget = bytes;
+  while (stats.retained_bytes > retain_budget && evict_lru())
+    ;
+}
+
+void nav_drop_retained(void) {
+  while (evict_lru())
+    ;
+}
+
+void nav_clear(void) {
+  while (stack_top >= 0) {
+    nav_page_handle_t h = stack[stack_top--].handle;
+    if (!on_stack(h))
+      destroy_page(&pages[h]);
+  }
+  nav_drop_retained();
+}
+
+void nav_get_stats(nav_stats_t *out) {
+  if (out)
+    *out = stats;
+}
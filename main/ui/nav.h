@@ -2,13 +2,22 @@
 #define NAV_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #define NAV_MAX_STACK_DEPTH 16
+#define NAV_INVALID_PAGE (-1)
+
+// Bytes of hidden pages kept alive after they leave the stack
+#define NAV_DEFAULT_RETAIN_BUDGET (96 * 1024)
+
+typedef int nav_page_handle_t;
 
 typedef void (*nav_page_create_fn)(void *parent, void *params);
 typedef void (*nav_page_show_fn)(void);
 typedef void (*nav_page_hide_fn)(void);
 typedef void (*nav_page_destroy_fn)(void);
+typedef void (*nav_page_resume_fn)(void *params);
 
 typedef struct {
   const char *id;
@@ -16,15 +25,44 @@ typedef struct {
   nav_page_show_fn show;
   nav_page_hide_fn hide;
   nav_page_destroy_fn destroy;
+  // Called instead of create when a retained page is reopened, to refresh
+  // whatever depends on params; NULL shows the page as it was left
+  nav_page_resume_fn resume;
+  // Approximate LVGL footprint; 0 (the default) always destroys on leave.
+  // Pages showing secrets must leave this at 0.
+  size_t retain_bytes;
 } nav_page_t;
 
+typedef struct {
+  uint32_t creates;   // create() calls
+  uint32_t resumes;   // Retained pages reopened without create()
+  uint32_t destroys;  // destroy() calls, evictions included
+  uint32_t evictions; // Retained pages dropped to stay within budget
+  size_t retained_bytes;
+} nav_stats_t;
+
 void nav_init(void *root_parent);
-void nav_register(const nav_page_t *page);
+
+// Returns the page's handle, or NAV_INVALID_PAGE if full or id is taken
+nav_page_handle_t nav_register(const nav_page_t *page);
+nav_page_handle_t nav_find(const char *page_id);
+
 bool nav_push(const char *page_id, void *params);
+bool nav_push_handle(nav_page_handle_t handle, void *params);
 bool nav_pop(void);
 bool nav_replace(const char *page_id, void *params);
+bool nav_replace_handle(nav_page_handle_t handle, void *params);
 void nav_pop_to_root(void);
 const char *nav_current_page_id(void);
 int nav_stack_depth(void);
 
+// Evicts least recently used pages if the new budget is smaller
+void nav_set_retain_budget(size_t bytes);
+// Destroy every retained page (memory pressure, or before a wipe)
+void nav_drop_retained(void);
+// Destroy every page, on the stack or retained, e.g. before the screen is
+// cleaned on session expiry
+void nav_clear(void);
+void nav_get_stats(nav_stats_t *out);
+
 #endif
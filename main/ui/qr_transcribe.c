@@ -0,0 +1,408 @@
+// QR transcription view — modules, grid and shading drawn from the bitmap
+
+#include "qr_transcribe.h"
+#include "../utils/secure_mem.h"
+#include "theme.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GRID_INTERVAL_DEFAULT 5
+#define GRID_INTERVAL_21 7
+#define GRID_LINE_WIDTH 2
+#define LABEL_PAD 6
+#define LABEL_TEXT_MAX 4
+#define SHADE_OPACITY LV_OPA_70
+
+typedef struct {
+  lv_area_t box;
+  bool visible;
+  char text[LABEL_TEXT_MAX];
+} grid_label_t;
+
+struct qr_transcribe {
+  lv_obj_t *obj;
+  int32_t size;
+  int32_t inset;
+
+  /* Module bitmap, row-major, MSB first */
+  uint8_t *bits;
+  size_t bits_len;
+  int32_t row_bytes;
+  int modules;
+  int32_t scale;
+  int32_t content;
+  int32_t qr_x;
+  int32_t qr_y;
+
+  int interval;
+  int divisions;
+  int32_t cell_px;
+  grid_label_t *labels; // Column labels, then row labels
+
+  bool grid_visible;
+  int region;
+
+  lv_color_t light;
+  lv_color_t shaded_light; // Dark modules are unchanged by shading
+  lv_color_t dark;
+  lv_color_t grid_color;
+};
+
+static void view_area(const qr_transcribe_t *view, lv_area_t *area) {
+  lv_area_set(area, 0, 0, view->size - 1, view->size - 1);
+}
+
+/* ---------- Layout ---------- */
+
+static void free_labels(qr_transcribe_t *view) {
+  free(view->labels);
+  view->labels = NULL;
+}
+
+static void layout_labels(qr_transcribe_t *view) {
+  free_labels(view);
+  if (view->divisions == 0)
+    return;
+
+  view->labels = calloc(view->divisions * 2, sizeof(grid_label_t));
+  if (!view->labels)
+    return;
+
+  const lv_font_t *font = theme_font_small();
+  lv_area_t bounds;
+  view_area(view, &bounds);
+
+  for (int i = 0; i < view->divisions * 2; i++) {
+    grid_label_t *label = &view->labels[i];
+    bool is_col = i < view->divisions;
+    int index = is_col ? i : i - view->divisions;
+    if (is_col)
+      snprintf(label->text, sizeof(label->text), "%d", index);
+    else
+      snprintf(label->text, sizeof(label->text), "%c", 'A' + index);
+
+    lv_point_t size;
+    lv_text_get_size(&size, label->text, font, 0, 0, LV_COORD_MAX,
+                     LV_TEXT_FLAG_NONE);
+    int32_t cell = view->cell_px * index;
+    int32_t x = is_col ? view->qr_x + cell + (view->cell_px - size.x) / 2
+                       : view->qr_x - LABEL_PAD - size.x;
+    int32_t y = is_col ? view->qr_y - LABEL_PAD - size.y
+                       : view->qr_y + cell + (view->cell_px - size.y) / 2;
+
+    lv_area_t box;
+    lv_area_set(&box, x, y, x + size.x - 1, y + size.y - 1);
+    label->visible = lv_area_intersect(&label->box, &box, &bounds);
+  }
+}
+
+static void window_area(const qr_transcribe_t *view, int region,
+                        lv_area_t *area) {
+  int32_t x = view->qr_x + (region % view->divisions) * view->cell_px;
+  int32_t y = view->qr_y + (region / view->divisions) * view->cell_px;
+  int32_t x_end = LV_MIN(x + view->cell_px, view->qr_x + view->content);
+  int32_t y_end = LV_MIN(y + view->cell_px, view->qr_y + view->content);
+  lv_area_set(area, x, y, x_end - 1, y_end - 1);
+}
+
+/* ---------- Drawing ---------- */
+
+/*
+ * Everything is drawn straight from the module bitmap in the draw event, so
+ * the view holds no pixel buffer. Only what intersects the layer's clip
+ * area is submitted: a region step redraws two cells and a few labels.
+ */
+
+typedef struct {
+  lv_layer_t *layer;
+  lv_area_t clip; // Local coordinates
+  int32_t ox;     // Local to screen offset
+  int32_t oy;
+  lv_draw_rect_dsc_t rect;
+} draw_ctx_t;
+
+static void fill(draw_ctx_t *ctx, int32_t x1, int32_t y1, int32_t x2,
+                 int32_t y2, lv_color_t color) {
+  lv_area_t rect, area;
+  lv_area_set(&rect, x1, y1, x2, y2);
+  if (!lv_area_intersect(&area, &rect, &ctx->clip))
+    return;
+  lv_area_move(&area, ctx->ox, ctx->oy);
+  ctx->rect.bg_color = color;
+  lv_draw_rect(ctx->layer, &ctx->rect, &area);
+}
+
+static void draw_background(qr_transcribe_t *view, draw_ctx_t *ctx) {
+  if (view->region < 0) {
+    fill(ctx, 0, 0, view->size - 1, view->size - 1, view->light);
+    return;
+  }
+  lv_area_t win;
+  window_area(view, view->region, &win);
+  fill(ctx, 0, 0, view->size - 1, view->size - 1, view->shaded_light);
+  fill(ctx, win.x1, win.y1, win.x2, win.y2, view->light);
+}
+
+/* Dark modules in the clip area, one rectangle per horizontal run */
+static void draw_modules(qr_transcribe_t *view, draw_ctx_t *ctx) {
+  if (!view->bits)
+    return;
+
+  int32_t last = view->modules - 1;
+  int32_t my1 = LV_MAX(0, (ctx->clip.y1 - view->qr_y) / view->scale);
+  int32_t my2 = LV_MIN(last, (ctx->clip.y2 - view->qr_y) / view->scale);
+  int32_t mx1 = LV_MAX(0, (ctx->clip.x1 - view->qr_x) / view->scale);
+  int32_t mx2 = LV_MIN(last, (ctx->clip.x2 - view->qr_x) / view->scale);
+
+  for (int32_t my = my1; my <= my2; my++) {
+    const uint8_t *bits = view->bits + my * view->row_bytes;
+    int32_t y = view->qr_y + my * view->scale;
+    int32_t mx = mx1;
+    while (mx <= mx2) {
+      if (!(bits[mx >> 3] & (0x80 >> (mx & 7)))) {
+        mx++;
+        continue;
+      }
+      int32_t run = mx;
+      while (mx <= mx2 && (bits[mx >> 3] & (0x80 >> (mx & 7))))
+        mx++;
+      fill(ctx, view->qr_x + run * view->scale, y,
+           view->qr_x + mx * view->scale - 1, y + view->scale - 1,
+           view->dark);
+    }
+  }
+}
+
+static void draw_grid(qr_transcribe_t *view, draw_ctx_t *ctx) {
+  if (!view->grid_visible || view->divisions == 0)
+    return;
+
+  int32_t last = view->qr_y + view->content - 1;
+  for (int i = 0; i <= view->divisions; i++) {
+    int32_t mod = LV_MIN(i * view->interval, view->modules);
+    int32_t gx = view->qr_x + mod * view->scale - 1;
+    int32_t gy = view->qr_y + mod * view->scale - 1;
+    fill(ctx, gx, view->qr_y, gx + GRID_LINE_WIDTH - 1, last,
+         view->grid_color);
+    fill(ctx, view->qr_x, gy, view->qr_x + view->content - 1,
+         gy + GRID_LINE_WIDTH - 1, view->grid_color);
+  }
+}
+
+static void draw_labels(qr_transcribe_t *view, draw_ctx_t *ctx) {
+  if (!view->grid_visible || !view->labels)
+    return;
+
+  bool shaded = view->region >= 0;
+  int active_col = shaded ? view->region % view->divisions : -1;
+  int active_row = shaded ? view->region / view->divisions : -1;
+
+  lv_draw_label_dsc_t dsc;
+  lv_draw_label_dsc_init(&dsc);
+  dsc.font = theme_font_small();
+
+  for (int i = 0; i < view->divisions * 2; i++) {
+    grid_label_t *label = &view->labels[i];
+    lv_area_t box;
+    if (!label->visible || !lv_area_intersect(&box, &label->box, &ctx->clip))
+      continue;
+
+    bool active = (i < view->divisions) ? i == active_col
+                                        : i - view->divisions == active_row;
+    dsc.text = label->text;
+    dsc.color = active ? lv_color_hex(0xFFFFFF) : highlight_color();
+    box = label->box;
+    lv_area_move(&box, ctx->ox, ctx->oy);
+    lv_draw_label(ctx->layer, &dsc, &box);
+  }
+}
+
+static void draw_cb(lv_event_t *e) {
+  qr_transcribe_t *view = lv_event_get_user_data(e);
+  lv_obj_t *obj = lv_event_get_target(e);
+
+  draw_ctx_t ctx;
+  ctx.layer = lv_event_get_layer(e);
+  lv_area_t coords;
+  lv_obj_get_coords(obj, &coords);
+  if (!lv_area_intersect(&ctx.clip, &ctx.layer->_clip_area, &coords))
+    return;
+  lv_area_move(&ctx.clip, -coords.x1, -coords.y1);
+  ctx.ox = coords.x1;
+  ctx.oy = coords.y1;
+  lv_draw_rect_dsc_init(&ctx.rect);
+
+  draw_background(view, &ctx);
+  draw_modules(view, &ctx);
+  draw_grid(view, &ctx);
+  draw_labels(view, &ctx);
+}
+
+static void redraw_all(qr_transcribe_t *view) { lv_obj_invalidate(view->obj); }
+
+/* Invalidate a few areas in view coordinates */
+static void redraw_areas(qr_transcribe_t *view, const lv_area_t *areas,
+                         size_t count) {
+  lv_area_t coords;
+  lv_obj_get_coords(view->obj, &coords);
+  for (size_t i = 0; i < count; i++) {
+    lv_area_t abs = areas[i];
+    lv_area_move(&abs, coords.x1, coords.y1);
+    lv_obj_invalidate_area(view->obj, &abs);
+  }
+}
+
+/* ---------- Public API ---------- */
+
+qr_transcribe_t *qr_transcribe_create(lv_obj_t *parent, int32_t size,
+                                      int32_t inset) {
+  if (!parent || size <= 0 || inset < 0 || inset * 2 >= size)
+    return NULL;
+
+  qr_transcribe_t *view = calloc(1, sizeof(qr_transcribe_t));
+  if (!view)
+    return NULL;
+
+  view->size = size;
+  view->inset = inset;
+  view->region = -1;
+
+  view->light = lv_color_white();
+  view->dark = lv_color_black();
+  view->shaded_light = lv_color_mix(view->dark, view->light, SHADE_OPACITY);
+  view->grid_color = highlight_color();
+
+  view->obj = lv_obj_create(parent);
+  if (!view->obj) {
+    free(view);
+    return NULL;
+  }
+
+  /* Plain object: no styles, the draw event paints every pixel */
+  lv_obj_remove_style_all(view->obj);
+  lv_obj_clear_flag(view->obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_size(view->obj, size, size);
+  lv_obj_add_event_cb(view->obj, draw_cb, LV_EVENT_DRAW_MAIN, view);
+  return view;
+}
+
+void qr_transcribe_destroy(qr_transcribe_t *view) {
+  if (!view)
+    return;
+  if (view->obj)
+    lv_obj_del(view->obj);
+  free_labels(view);
+  SECURE_FREE_BUFFER(view->bits, view->bits_len);
+  free(view);
+}
+
+bool qr_transcribe_set_matrix(qr_transcribe_t *view, const qr_matrix_t *matrix,
+                              qr_encode_result_t *result) {
+  if (!view || !matrix || matrix->modules <= 0)
+    return false;
+
+  int32_t content = view->size - 2 * view->inset;
+  int32_t scale = content / matrix->modules;
+  if (scale == 0)
+    return false;
+
+  int32_t row_bytes = (matrix->modules + 7) / 8;
+  size_t bits_len = (size_t)row_bytes * matrix->modules;
+  uint8_t *bits = calloc(1, bits_len);
+  if (!bits)
+    return false;
+  for (int y = 0; y < matrix->modules; y++)
+    for (int x = 0; x < matrix->modules; x++)
+      if (qr_matrix_get_module(matrix, x, y))
+        bits[y * row_bytes + (x >> 3)] |= 0x80 >> (x & 7);
+
+  SECURE_FREE_BUFFER(view->bits, view->bits_len);
+  view->bits = bits;
+  view->bits_len = bits_len;
+  view->row_bytes = row_bytes;
+  view->modules = matrix->modules;
+  view->scale = scale;
+  view->content = matrix->modules * scale;
+  view->qr_x = view->inset + (content - view->content) / 2;
+  view->qr_y = view->qr_x;
+
+  view->interval = (view->modules == 21) ? GRID_INTERVAL_21
+                                         : GRID_INTERVAL_DEFAULT;
+  view->divisions = (view->modules + view->interval - 1) / view->interval;
+  view->cell_px = view->scale * view->interval;
+  view->region = -1;
+  layout_labels(view);
+
+  if (result) {
+    result->modules = view->modules;
+    result->scale = view->scale;
+  }
+
+  redraw_all(view);
+  return true;
+}
+
+void qr_transcribe_set_grid(qr_transcribe_t *view, bool visible) {
+  if (!view || view->grid_visible == visible)
+    return;
+  view->grid_visible = visible;
+  if (!visible)
+    view->region = -1;
+  redraw_all(view);
+}
+
+void qr_transcribe_set_region(qr_transcribe_t *view, int region) {
+  if (!view || view->divisions == 0)
+    return;
+  if (region < 0 || region >= qr_transcribe_region_count(view))
+    region = -1;
+  if (region == view->region)
+    return;
+
+  int old = view->region;
+  view->region = region;
+
+  /* Turning shading on or off changes every pixel outside the window */
+  if (old < 0 || region < 0) {
+    redraw_all(view);
+    return;
+  }
+
+  /* Otherwise only the two cells and the labels whose highlight moved */
+  lv_area_t dirty[6];
+  size_t count = 0;
+  window_area(view, old, &dirty[count++]);
+  window_area(view, region, &dirty[count++]);
+
+  int d = view->divisions;
+  int old_col = old % d, new_col = region % d;
+  int old_row = old / d, new_row = region / d;
+  grid_label_t *labels = view->labels;
+  if (labels && old_col != new_col) {
+    if (labels[old_col].visible)
+      dirty[count++] = labels[old_col].box;
+    if (labels[new_col].visible)
+      dirty[count++] = labels[new_col].box;
+  }
+  if (labels && old_row != new_row) {
+    if (labels[d + old_row].visible)
+      dirty[count++] = labels[d + old_row].box;
+    if (labels[d + new_row].visible)
+      dirty[count++] = labels[d + new_row].box;
+  }
+
+  redraw_areas(view, dirty, count);
+}
+
+int qr_transcribe_get_region(const qr_transcribe_t *view) {
+  return view ? view->region : -1;
+}
+
+int qr_transcribe_region_count(const qr_transcribe_t *view) {
+  return view ? view->divisions * view->divisions : 0;
+}
+
+lv_obj_t *qr_transcribe_get_obj(qr_transcribe_t *view) {
+  return view ? view->obj : NULL;
+}
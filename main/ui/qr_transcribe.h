@@ -0,0 +1,35 @@
+#ifndef QR_TRANSCRIBE_H
+#define QR_TRANSCRIBE_H
+
+#include "../qr/encoder.h"
+#include <lvgl.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Single-object QR view for hand transcription: modules, grid lines,
+ * row/column labels and region shading are drawn from a 1 bpp copy of the
+ * matrix, with no pixel buffer. Moving the highlighted region invalidates
+ * only the old and new cells and their labels.
+ */
+
+typedef struct qr_transcribe qr_transcribe_t;
+
+/* size: view side; inset: white border around the QR holding the labels */
+qr_transcribe_t *qr_transcribe_create(lv_obj_t *parent, int32_t size,
+                                      int32_t inset);
+void qr_transcribe_destroy(qr_transcribe_t *view);
+
+/* Copies the modules (wiped on destroy) and redraws; clears the region */
+bool qr_transcribe_set_matrix(qr_transcribe_t *view, const qr_matrix_t *matrix,
+                              qr_encode_result_t *result);
+void qr_transcribe_set_grid(qr_transcribe_t *view, bool visible);
+
+/* Highlight one grid cell (row-major index), or -1 to remove shading */
+void qr_transcribe_set_region(qr_transcribe_t *view, int region);
+int qr_transcribe_get_region(const qr_transcribe_t *view);
+int qr_transcribe_region_count(const qr_transcribe_t *view);
+
+lv_obj_t *qr_transcribe_get_obj(qr_transcribe_t *view);
+
+#endif
@@ -1,5 +1,6 @@
 #include "sankey.h"
 #include "theme.h"
+#include <sankey_raster.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -31,124 +32,6 @@ struct sankey_diagram {
   size_t output_overflow;
 };
 
-static float bezier_eval(float p0, float p1, float p2, float p3, float t) {
-  float mt = 1.0f - t;
-  float mt2 = mt * mt;
-  float t2 = t * t;
-  return mt2 * mt * p0 + 3.0f * mt2 * t * p1 + 3.0f * mt * t2 * p2 +
-         t2 * t * p3;
-}
-
-static lv_color_t color_lerp(lv_color_t c1, lv_color_t c2, float t) {
-  if (t <= 0.0f)
-    return c1;
-  if (t >= 1.0f)
-    return c2;
-  return lv_color_make((uint8_t)(c1.red + t * (c2.red - c1.red)),
-                       (uint8_t)(c1.green + t * (c2.green - c1.green)),
-                       (uint8_t)(c1.blue + t * (c2.blue - c1.blue)));
-}
-
-static inline void set_pixel(sankey_diagram_t *diagram, int32_t x, int32_t y,
-                             uint16_t color16) {
-  if (x < 0 || x >= diagram->width || y < 0 || y >= diagram->height)
-    return;
-  uint16_t *row = (uint16_t *)((uint8_t *)diagram->draw_buf->data +
-                               y * diagram->draw_buf->header.stride);
-  row[x] = color16;
-}
-
-static inline void set_pixel_blended(sankey_diagram_t *diagram, int32_t x,
-                                     int32_t y, uint16_t fg, uint8_t alpha) {
-  if (x < 0 || x >= diagram->width || y < 0 || y >= diagram->height)
-    return;
-  uint16_t *row = (uint16_t *)((uint8_t *)diagram->draw_buf->data +
-                               y * diagram->draw_buf->header.stride);
-  if (alpha >= 255) {
-    row[x] = fg;
-  } else if (alpha > 0) {
-    uint16_t bg = row[x];
-    uint8_t inv = 255 - alpha;
-    row[x] =
-        ((((fg >> 11) * alpha + (bg >> 11) * inv) / 255) << 11) |
-        (((((fg >> 5) & 0x3F) * alpha + ((bg >> 5) & 0x3F) * inv) / 255) << 5) |
-        (((fg & 0x1F) * alpha + (bg & 0x1F) * inv) / 255);
-  }
-}
-
-static void draw_aa_column(sankey_diagram_t *diagram, int32_t x, float y_top_f,
-                           float y_bot_f, uint16_t color16) {
-  int32_t y_top = (int32_t)y_top_f;
-  int32_t y_bot = (int32_t)y_bot_f;
-
-  set_pixel_blended(diagram, x, y_top, color16,
-                    255 - (uint8_t)((y_top_f - y_top) * 255.0f));
-  for (int32_t y = y_top + 1; y < y_bot; y++)
-    set_pixel(diagram, x, y, color16);
-  if (y_bot > y_top)
-    set_pixel_blended(diagram, x, y_bot, color16,
-                      (uint8_t)((y_bot_f - y_bot) * 255.0f));
-}
-
-static void draw_gradient_rect(sankey_diagram_t *diagram, int32_t x_start,
-                               int32_t x_end, float y_top_f, float y_bot_f,
-                               lv_color_t left_color, lv_color_t right_color) {
-  if (x_start > x_end) {
-    int32_t tmp = x_start;
-    x_start = x_end;
-    x_end = tmp;
-    lv_color_t tmp_c = left_color;
-    left_color = right_color;
-    right_color = tmp_c;
-  }
-  if (y_top_f > y_bot_f) {
-    float tmp = y_top_f;
-    y_top_f = y_bot_f;
-    y_bot_f = tmp;
-  }
-  int32_t width = x_end - x_start;
-  if (width <= 0)
-    return;
-
-  for (int32_t x = x_start; x <= x_end; x++) {
-    draw_aa_column(diagram, x, y_top_f, y_bot_f,
-                   lv_color_to_u16(color_lerp(left_color, right_color,
-                                              (float)(x - x_start) / width)));
-  }
-}
-
-static void draw_bezier_ribbon(sankey_diagram_t *diagram, float x0,
-                               float y0_top, float y0_bot, float x3,
-                               float y3_top, float y3_bot,
-                               lv_color_t start_color, lv_color_t end_color) {
-  float dx = (x3 - x0) / 3.0f;
-  float bx1 = x0 + dx, bx2 = x3 - dx;
-
-  for (int32_t x = (int32_t)(x0 + 0.5f); x <= (int32_t)(x3 + 0.5f); x++) {
-    // Binary search to find t for this x (10 iterations = 0.001 precision)
-    float t_lo = 0.0f, t_hi = 1.0f;
-    for (int i = 0; i < 10; i++) {
-      float t_mid = (t_lo + t_hi) * 0.5f;
-      if (bezier_eval(x0, bx1, bx2, x3, t_mid) < (float)x)
-        t_lo = t_mid;
-      else
-        t_hi = t_mid;
-    }
-    float t = (t_lo + t_hi) * 0.5f;
-
-    float y_top_f = bezier_eval(y0_top, y0_top, y3_top, y3_top, t);
-    float y_bot_f = bezier_eval(y0_bot, y0_bot, y3_bot, y3_bot, t);
-    if (y_top_f > y_bot_f) {
-      float tmp = y_top_f;
-      y_top_f = y_bot_f;
-      y_bot_f = tmp;
-    }
-
-    draw_aa_column(diagram, x, y_top_f, y_bot_f,
-                   lv_color_to_u16(color_lerp(start_color, end_color, t)));
-  }
-}
-
 static void calculate_flow_layout(sankey_flow_t *flows, size_t count,
                                   uint64_t total_amount, int32_t height,
                                   float y_offset) {
@@ -263,18 +146,14 @@ void sankey_diagram_render(sankey_diagram_t *diagram) {
   if (!diagram || !diagram->canvas || !diagram->draw_buf)
     return;
 
-  lv_draw_buf_clear(diagram->draw_buf, NULL);
-
-  uint8_t *buf = (uint8_t *)diagram->draw_buf->data;
-  uint32_t stride = diagram->draw_buf->header.stride;
-  lv_color_t bg = bg_color();
-  uint16_t bg16 = lv_color_to_u16(bg);
-
-  for (int32_t y = 0; y < diagram->height; y++) {
-    uint16_t *row = (uint16_t *)(buf + y * stride);
-    for (int32_t x = 0; x < diagram->width; x++)
-      row[x] = bg16;
-  }
+  sankey_raster_t raster = {
+      .pixels = (uint16_t *)diagram->draw_buf->data,
+      .width = diagram->width,
+      .height = diagram->height,
+      .stride = diagram->draw_buf->header.stride,
+  };
+  uint32_t bg = lv_color_to_int(bg_color());
+  sankey_raster_fill(&raster, sankey_raster_rgb565(bg));
 
   if (diagram->input_count == 0 || diagram->output_count == 0) {
     lv_obj_invalidate(diagram->canvas);
@@ -319,7 +198,7 @@ void sankey_diagram_render(sankey_diagram_t *diagram) {
 
   float fade_width = diagram->width * 0.05f;
   float fade_start_x = diagram->width - fade_width;
-  lv_color_t white = lv_color_hex(0xFFFFFF);
+  uint32_t white = 0xFFFFFF;
 
   // Central "transaction" rectangle (10% of width)
   float rect_width = diagram->width * 0.1f;
@@ -333,33 +212,33 @@ void sankey_diagram_render(sankey_diagram_t *diagram) {
 
   for (size_t i = 0; i < diagram->input_count; i++) {
     float half = diagram->inputs[i].thickness / 2.0f;
-    draw_gradient_rect(diagram, 0, (int32_t)fade_width,
+    uint32_t color = lv_color_to_int(diagram->inputs[i].color);
+    sankey_raster_band(&raster, 0, (int32_t)fade_width,
                        diagram->inputs[i].y_center - half,
                        diagram->inputs[i].y_center + half, bg, white);
-    draw_bezier_ribbon(diagram, fade_width, diagram->inputs[i].y_center - half,
-                       diagram->inputs[i].y_center + half, rect_left,
-                       input_center_positions[i] - half,
-                       input_center_positions[i] + half,
-                       diagram->inputs[i].color, diagram->inputs[i].color);
+    sankey_raster_ribbon(&raster, fade_width,
+                         diagram->inputs[i].y_center - half,
+                         diagram->inputs[i].y_center + half, rect_left,
+                         input_center_positions[i] - half,
+                         input_center_positions[i] + half, color, color);
   }
 
   for (size_t i = 0; i < diagram->output_count; i++) {
     float half = diagram->outputs[i].thickness / 2.0f;
-    draw_bezier_ribbon(diagram, rect_right, output_center_positions[i] - half,
-                       output_center_positions[i] + half, fade_start_x,
-                       diagram->outputs[i].y_center - half,
-                       diagram->outputs[i].y_center + half, white,
-                       diagram->outputs[i].color);
-    draw_gradient_rect(diagram, (int32_t)fade_start_x, diagram->width - 1,
+    uint32_t color = lv_color_to_int(diagram->outputs[i].color);
+    sankey_raster_ribbon(&raster, rect_right,
+                         output_center_positions[i] - half,
+                         output_center_positions[i] + half, fade_start_x,
+                         diagram->outputs[i].y_center - half,
+                         diagram->outputs[i].y_center + half, white, color);
+    sankey_raster_band(&raster, (int32_t)fade_start_x, diagram->width - 1,
                        diagram->outputs[i].y_center - half,
-                       diagram->outputs[i].y_center + half,
-                       diagram->outputs[i].color, bg);
+                       diagram->outputs[i].y_center + half, color, bg);
   }
 
   // Draw central rectangle last to cover AA artifacts at junctions
-  uint16_t white16 = lv_color_to_u16(white);
-  for (int32_t x = (int32_t)rect_left; x <= (int32_t)rect_right; x++)
-    draw_aa_column(diagram, x, rect_top, rect_bot, white16);
+  sankey_raster_rect(&raster, (int32_t)rect_left, (int32_t)rect_right,
+                     rect_top, rect_bot, sankey_raster_rgb565(white));
 
   free(input_center_positions);
   free(output_center_positions);
@@ -1,97 +1,291 @@
 // BIP39 word filtering utilities for smart keyboard input
 
 #include "bip39_filter.h"
+#include <bip39_lang.h>
+#include <mnemonic_model.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wally_bip39.h>
 #include <wally_core.h>
 
-static struct words *wordlist = NULL;
+// libwally's codes for the lists it ships (the component is built without
+// BUILD_MINIMAL so all of them are in); it has no Portuguese, Czech or
+// Korean list
+static const char *const wally_codes[BIP39_LANG_COUNT] = {
+    [BIP39_LANG_EN] = "en", [BIP39_LANG_ES] = "es", [BIP39_LANG_FR] = "fr",
+    [BIP39_LANG_IT] = "it", [BIP39_LANG_JA] = "jp",
+};
+
+// Languages the keyboard filters over; the lowest one is the primary
+// language, whose indices and words the index-based functions use
+static uint32_t active_languages = 0;
 
 // Cache for valid last words to avoid recalculating on every keystroke
 #define MAX_VALID_LAST_WORDS 128
 static const char *valid_last_words_cache[MAX_VALID_LAST_WORDS];
 static int valid_last_words_count = 0;
 
-bool bip39_filter_init(void) {
-  if (wordlist)
+static const char *wally_word_at(void *ctx, size_t index) {
+  return bip39_get_word_by_index(ctx, index);
+}
+
+static bool ensure_loaded(bip39_lang_t lang) {
+  if (bip39_lang_loaded() & BIP39_LANG_MASK(lang))
     return true;
-  return bip39_get_wordlist(NULL, &wordlist) == WALLY_OK;
+  struct words *wordlist = NULL;
+  if (!wally_codes[lang] ||
+      bip39_get_wordlist(wally_codes[lang], &wordlist) != WALLY_OK ||
+      !wordlist)
+    return false;
+  return bip39_lang_load(lang, wally_word_at, wordlist);
 }
 
-uint32_t bip39_filter_get_valid_letters(const char *prefix, int prefix_len) {
+static bip39_lang_t primary(void) {
+  for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+    if (active_languages & BIP39_LANG_MASK(i))
+      return (bip39_lang_t)i;
+  }
+  return BIP39_LANG_EN;
+}
+
+// Active languages whose keys are typeable
+static uint32_t keyboard_languages(void) {
   uint32_t mask = 0;
-  if (!wordlist)
-    return 0xFFFFFFFF;
+  for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+    if ((active_languages & BIP39_LANG_MASK(i)) &&
+        bip39_lang_info((bip39_lang_t)i)->latin)
+      mask |= BIP39_LANG_MASK(i);
+  }
+  return mask;
+}
 
-  for (int letter = 0; letter < 26; letter++) {
-    char test_prefix[BIP39_MAX_PREFIX_LEN + 2];
-    int test_len = prefix_len + 1;
+bool bip39_filter_init(void) {
+  if (active_languages)
+    return true;
+  if (!ensure_loaded(BIP39_LANG_EN))
+    return false;
+  active_languages = BIP39_LANG_MASK(BIP39_LANG_EN);
+  return true;
+}
 
-    if (prefix && prefix_len > 0) {
-      int copy_len =
-          prefix_len < BIP39_MAX_PREFIX_LEN ? prefix_len : BIP39_MAX_PREFIX_LEN;
-      memcpy(test_prefix, prefix, copy_len);
-      test_prefix[copy_len] = 'a' + letter;
-      test_prefix[copy_len + 1] = '\0';
-    } else {
-      test_prefix[0] = 'a' + letter;
-      test_prefix[1] = '\0';
-      test_len = 1;
+uint32_t bip39_filter_available_languages(void) {
+  uint32_t mask = bip39_lang_loaded();
+  for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+    struct words *wordlist = NULL;
+    if (wally_codes[i] &&
+        bip39_get_wordlist(wally_codes[i], &wordlist) == WALLY_OK && wordlist)
+      mask |= BIP39_LANG_MASK(i);
+  }
+  return mask;
+}
+
+void bip39_filter_load_languages(void) {
+  uint32_t available = bip39_filter_available_languages();
+  for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+    if (available & BIP39_LANG_MASK(i))
+      ensure_loaded((bip39_lang_t)i);
+  }
+}
+
+void bip39_filter_set_languages(uint32_t mask) {
+  uint32_t active = 0;
+  for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+    if ((mask & BIP39_LANG_MASK(i)) && ensure_loaded((bip39_lang_t)i))
+      active |= BIP39_LANG_MASK(i);
+  }
+  if (!active && ensure_loaded(BIP39_LANG_EN))
+    active = BIP39_LANG_MASK(BIP39_LANG_EN);
+  if (active != active_languages)
+    valid_last_words_count = 0;
+  active_languages = active;
+}
+
+uint32_t bip39_filter_get_languages(void) { return active_languages; }
+
+uint32_t bip39_filter_detect_languages(const char *const *words, int count) {
+  bip39_filter_load_languages();
+  return bip39_lang_detect(words, count > 0 ? (size_t)count : 0,
+                           bip39_lang_loaded());
+}
+
+// Checksum of words in one language; on success the entropy goes to
+// entropy (optional)
+static bool checksum_in(bip39_lang_t lang, char **words, size_t n,
+                        uint8_t *entropy, size_t *entropy_len) {
+  mnemonic_model_t model;
+  if (!mnemonic_model_count_supported(n) || !mnemonic_model_init(&model, n))
+    return false;
+  for (size_t i = 0; i < n; i++) {
+    int idx = bip39_lang_find(lang, words[i]);
+    if (idx < 0) {
+      mnemonic_model_wipe(&model);
+      return false;
     }
+    mnemonic_model_set(&model, i, (uint16_t)idx);
+  }
+  bool valid = mnemonic_model_checksum_valid(&model);
+  if (valid && entropy)
+    *entropy_len = mnemonic_model_entropy(&model, entropy);
+  mnemonic_model_wipe(&model);
+  return valid;
+}
 
-    for (size_t i = 0; i < BIP39_WORDLIST_SIZE; i++) {
-      const char *word = bip39_get_word_by_index(wordlist, i);
-      if (word && strncmp(word, test_prefix, test_len) == 0) {
-        mask |= (1u << letter);
-        break;
-      }
+// Language whose checksum accepts the mnemonic, else the first one holding
+// every word; -1 if none does. Only loaded languages are considered.
+// entropy (optional) receives the entropy of a checksum-valid mnemonic.
+static int mnemonic_language(const char *mnemonic, bool require_checksum,
+                             uint8_t *entropy, size_t *entropy_len) {
+  if (!mnemonic)
+    return -1;
+  size_t len = strlen(mnemonic);
+  char *copy = malloc(len + 1);
+  if (!copy)
+    return -1;
+  memcpy(copy, mnemonic, len + 1);
+
+  char *words[MNEMONIC_MODEL_MAX_WORDS + 1];
+  size_t n = bip39_lang_split(copy, words, MNEMONIC_MODEL_MAX_WORDS + 1);
+  uint32_t mask = n <= MNEMONIC_MODEL_MAX_WORDS
+                      ? bip39_lang_detect((const char *const *)words, n,
+                                          bip39_lang_loaded())
+                      : 0;
+
+  int found = -1;
+  for (int i = 0; i < BIP39_LANG_COUNT && mask; i++) {
+    if (!(mask & BIP39_LANG_MASK(i)))
+      continue;
+    if (checksum_in((bip39_lang_t)i, words, n, entropy, entropy_len)) {
+      found = i;
+      break;
     }
+    if (found < 0 && !require_checksum)
+      found = i;
+  }
+  memset(copy, 0, len);
+  free(copy);
+  return found;
+}
+
+bool bip39_filter_use_mnemonic_language(const char *mnemonic) {
+  bip39_filter_load_languages();
+  int lang = mnemonic_language(mnemonic, false, NULL, NULL);
+  if (lang < 0)
+    return false;
+  bip39_filter_set_languages(BIP39_LANG_MASK(lang));
+  return true;
+}
+
+bool bip39_filter_validate_mnemonic(const char *mnemonic) {
+  return mnemonic_language(mnemonic, true, NULL, NULL) >= 0;
+}
+
+size_t bip39_filter_mnemonic_entropy(const char *mnemonic, uint8_t *out) {
+  size_t len = 0;
+  if (!out || mnemonic_language(mnemonic, true, out, &len) < 0)
+    return 0;
+  return len;
+}
+
+uint32_t bip39_filter_get_valid_letters(const char *prefix, int prefix_len) {
+  if (!active_languages)
+    return 0xFFFFFFFF;
+
+  uint32_t mask = 0;
+  uint32_t langs = keyboard_languages();
+  for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+    if (!(langs & BIP39_LANG_MASK(i)))
+      continue;
+    bip39_lang_range_t r = bip39_lang_prefix(
+        (bip39_lang_t)i, prefix, prefix && prefix_len > 0 ? prefix_len : 0);
+    mask |= bip39_lang_next_letters((bip39_lang_t)i, r);
   }
   return mask;
 }
 
+// Walks the prefix ranges of every keyboard language in key order,
+// visiting each distinct key once; returns how many were visited
+static int merge_prefix(const char *prefix, int prefix_len,
+                        const char **out_words, int max_words) {
+  bip39_lang_range_t ranges[BIP39_LANG_COUNT];
+  uint32_t langs = keyboard_languages();
+  for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+    ranges[i] = (langs & BIP39_LANG_MASK(i))
+                    ? bip39_lang_prefix((bip39_lang_t)i, prefix, prefix_len)
+                    : (bip39_lang_range_t){0, 0, 0};
+  }
+
+  int count = 0;
+  for (;;) {
+    const char *min = NULL;
+    for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+      if (ranges[i].lo >= ranges[i].hi)
+        continue;
+      const char *key = bip39_lang_key_of(
+          (bip39_lang_t)i, bip39_lang_index_at((bip39_lang_t)i, ranges[i].lo));
+      if (!min || strcmp(key, min) < 0)
+        min = key;
+    }
+    if (!min || (out_words && count >= max_words))
+      return count;
+    if (out_words)
+      out_words[count] = min;
+    count++;
+    for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+      if (ranges[i].lo < ranges[i].hi &&
+          strcmp(bip39_lang_key_of((bip39_lang_t)i,
+                                   bip39_lang_index_at((bip39_lang_t)i,
+                                                       ranges[i].lo)),
+                 min) == 0)
+        ranges[i].lo++;
+    }
+  }
+}
+
 int bip39_filter_by_prefix(const char *prefix, int prefix_len,
                            const char **out_words, int max_words) {
-  int count = 0;
-  if (!wordlist || !out_words || max_words <= 0)
+  if (!active_languages || !out_words || max_words <= 0)
     return 0;
   if (!prefix || prefix_len <= 0)
     return 0;
-
-  for (size_t i = 0; i < BIP39_WORDLIST_SIZE && count < max_words; i++) {
-    const char *word = bip39_get_word_by_index(wordlist, i);
-    if (word && strncmp(word, prefix, prefix_len) == 0) {
-      out_words[count++] = word;
-    }
-  }
-  return count;
+  return merge_prefix(prefix, prefix_len, out_words, max_words);
 }
 
 int bip39_filter_count_matches(const char *prefix, int prefix_len) {
-  int count = 0;
-  if (!wordlist)
+  if (!active_languages)
     return 0;
   if (!prefix || prefix_len <= 0)
     return BIP39_WORDLIST_SIZE;
 
-  for (size_t i = 0; i < BIP39_WORDLIST_SIZE; i++) {
-    const char *word = bip39_get_word_by_index(wordlist, i);
-    if (word && strncmp(word, prefix, prefix_len) == 0)
-      count++;
+  // One language: the range size; several: distinct keys across them
+  uint32_t langs = keyboard_languages();
+  if (langs && !(langs & (langs - 1))) {
+    bip39_lang_t lang = primary();
+    for (int i = 0; i < BIP39_LANG_COUNT; i++) {
+      if (langs == BIP39_LANG_MASK(i))
+        lang = (bip39_lang_t)i;
+    }
+    bip39_lang_range_t r = bip39_lang_prefix(lang, prefix, prefix_len);
+    return r.hi - r.lo;
   }
-  return count;
+  return merge_prefix(prefix, prefix_len, NULL, 0);
 }
 
 int bip39_filter_get_word_index(const char *word) {
-  if (!wordlist || !word)
+  if (!active_languages || !word)
     return -1;
+  return bip39_lang_find(primary(), word);
+}
 
-  for (size_t i = 0; i < BIP39_WORDLIST_SIZE; i++) {
-    const char *w = bip39_get_word_by_index(wordlist, i);
-    if (w && strcmp(w, word) == 0)
-      return (int)i;
-  }
-  return -1;
+const char *bip39_filter_get_word(int index) {
+  if (!active_languages || index < 0 || index >= BIP39_WORDLIST_SIZE)
+    return NULL;
+  return bip39_lang_key_of(primary(), (uint16_t)index);
+}
+
+const char *bip39_filter_get_mnemonic_word(int index) {
+  if (!active_languages || index < 0 || index >= BIP39_WORDLIST_SIZE)
+    return NULL;
+  return bip39_lang_word(primary(), (uint16_t)index);
 }
 
 void bip39_filter_clear_last_word_cache(void) { valid_last_words_count = 0; }
@@ -108,73 +302,39 @@ static void ensure_last_word_cache(const char entered_words[24][16],
 int bip39_filter_get_valid_last_words(const char entered_words[24][16],
                                       int word_count, const char **out_words,
                                       int max_words) {
-  if (!wordlist || !entered_words || !out_words || max_words <= 0)
+  if (!active_languages || !entered_words || !out_words || max_words <= 0)
     return 0;
   if (word_count != 12 && word_count != 24)
     return 0;
 
-  // 12 words: 128 bits entropy + 4 bits checksum, last word has 7 entropy bits
-  // 24 words: 256 bits entropy + 8 bits checksum, last word has 3 entropy bits
-  size_t checksum_bits = word_count / 3;
-  size_t entropy_bytes = ((word_count * 11) - checksum_bits) / 8;
-  size_t last_word_entropy_bits = 11 - checksum_bits;
-  int num_possibilities = 1 << last_word_entropy_bits;
-
-  // Pack word indices (11 bits each) from first N-1 words
-  uint8_t packed[32] = {0};
-  int bit_pos = 0;
-
+  mnemonic_model_t model;
+  mnemonic_model_init(&model, word_count);
   for (int i = 0; i < word_count - 1; i++) {
     int idx = bip39_filter_get_word_index(entered_words[i]);
-    if (idx < 0)
+    if (idx < 0) {
+      mnemonic_model_wipe(&model);
       return 0;
-
-    for (int b = 10; b >= 0; b--) {
-      int byte_idx = bit_pos / 8;
-      int bit_idx = 7 - (bit_pos % 8);
-      if (idx & (1 << b))
-        packed[byte_idx] |= (1 << bit_idx);
-      bit_pos++;
     }
+    mnemonic_model_set(&model, i, (uint16_t)idx);
   }
 
+  // 12 words leave 7 entropy bits to the last word, 24 words leave 3
+  uint16_t candidates[MAX_VALID_LAST_WORDS];
+  size_t n = mnemonic_model_last_word_candidates(&model, candidates,
+                                                 MAX_VALID_LAST_WORDS);
+  mnemonic_model_wipe(&model);
+
   int count = 0;
   valid_last_words_count = 0;
-
-  for (int entropy_val = 0;
-       entropy_val < num_possibilities && count < max_words; entropy_val++) {
-    uint8_t test_packed[32];
-    memcpy(test_packed, packed, sizeof(test_packed));
-
-    int test_bit_pos = bit_pos;
-    for (int b = last_word_entropy_bits - 1; b >= 0; b--) {
-      int byte_idx = test_bit_pos / 8;
-      int bit_idx = 7 - (test_bit_pos % 8);
-      if (entropy_val & (1 << b))
-        test_packed[byte_idx] |= (1 << bit_idx);
-      else
-        test_packed[byte_idx] &= ~(1 << bit_idx);
-      test_bit_pos++;
-    }
-
-    char *new_mnemonic = NULL;
-    if (bip39_mnemonic_from_bytes(NULL, test_packed, entropy_bytes,
-                                  &new_mnemonic) != WALLY_OK)
+  for (size_t i = 0; i < n; i++) {
+    const char *w = bip39_filter_get_word(candidates[i]);
+    if (!w)
       continue;
-
-    char *last_space = strrchr(new_mnemonic, ' ');
-    if (last_space) {
-      int idx = bip39_filter_get_word_index(last_space + 1);
-      if (idx >= 0) {
-        const char *w = bip39_get_word_by_index(wordlist, idx);
-        out_words[count++] = w;
-        if (valid_last_words_count < MAX_VALID_LAST_WORDS)
-          valid_last_words_cache[valid_last_words_count++] = w;
-      }
-    }
-
-    wally_free_string(new_mnemonic);
+    if (count < max_words)
+      out_words[count++] = w;
+    valid_last_words_cache[valid_last_words_count++] = w;
   }
+  memset(candidates, 0, sizeof(candidates));
 
   return count;
 }
@@ -183,7 +343,7 @@ uint32_t
 bip39_filter_get_valid_letters_for_last_word(const char entered_words[24][16],
                                              int word_count, const char *prefix,
                                              int prefix_len) {
-  if (!wordlist)
+  if (!active_languages)
     return 0xFFFFFFFF;
 
   ensure_last_word_cache(entered_words, word_count);
@@ -223,7 +383,7 @@ int bip39_filter_last_word_by_prefix(const char entered_words[24][16],
                                      int word_count, const char *prefix,
                                      int prefix_len, const char **out_words,
                                      int max_words) {
-  if (!wordlist || !out_words || max_words <= 0)
+  if (!active_languages || !out_words || max_words <= 0)
     return 0;
 
   ensure_last_word_cache(entered_words, word_count);
@@ -4,19 +4,82 @@
 #define BIP39_FILTER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define BIP39_WORDLIST_SIZE 2048
 #define BIP39_MAX_FILTERED_WORDS 8
 #define BIP39_MAX_PREFIX_LEN 8
 
+/*
+ * Filtering runs over a set of active languages (BIP39_LANG_MASK bits from
+ * bip39_lang.h). Prefix functions merge the typeable (Latin-script) ones
+ * and return their ASCII keys, e.g. "abaco" for Spanish "ábaco". Index
+ * functions use the primary language, the lowest active one.
+ */
+
 /**
  * Initialize the BIP39 wordlist. Must be called before other functions.
  * Safe to call multiple times (subsequent calls are no-ops).
+ * Starts with English active.
  * @return true on success, false on failure
  */
 bool bip39_filter_init(void);
 
+/**
+ * Languages whose wordlists the firmware can provide.
+ * @return Bit mask of languages
+ */
+uint32_t bip39_filter_available_languages(void);
+
+/**
+ * Build the index of every available language (UI thread only).
+ */
+void bip39_filter_load_languages(void);
+
+/**
+ * Set the active languages, loading them as needed (UI thread only).
+ * Unavailable languages are dropped; English is used if none remain.
+ * @param mask Bit mask of languages
+ */
+void bip39_filter_set_languages(uint32_t mask);
+
+/**
+ * @return Bit mask of active languages
+ */
+uint32_t bip39_filter_get_languages(void);
+
+/**
+ * Languages containing every one of the given words (UI thread only).
+ * @param words Words in any normalization form, or keys
+ * @param count Number of words
+ * @return Bit mask of languages, all available ones if count is 0
+ */
+uint32_t bip39_filter_detect_languages(const char *const *words, int count);
+
+/**
+ * Make the mnemonic's language the only active one (UI thread only).
+ * Prefers a language whose checksum accepts it.
+ * @return false if no available language contains every word
+ */
+bool bip39_filter_use_mnemonic_language(const char *mnemonic);
+
+/**
+ * Check words and checksum in any loaded language. Words may be separated
+ * by ASCII or ideographic spaces and be in any normalization form.
+ * Only reads loaded indices, so it is safe on a worker thread.
+ * @return true if valid in some loaded language
+ */
+bool bip39_filter_validate_mnemonic(const char *mnemonic);
+
+/**
+ * Entropy of a checksum-valid mnemonic in any loaded language.
+ * Safe on a worker thread, like bip39_filter_validate_mnemonic().
+ * @param out Receives up to 32 bytes
+ * @return Entropy length in bytes, 0 if the mnemonic is not valid
+ */
+size_t bip39_filter_mnemonic_entropy(const char *mnemonic, uint8_t *out);
+
 /**
  * Get a bitmask of valid next letters for a given prefix.
  * Bit N is set if appending letter ('a' + N) would match at least one word.
@@ -46,12 +109,27 @@ int bip39_filter_by_prefix(const char *prefix, int prefix_len,
 int bip39_filter_count_matches(const char *prefix, int prefix_len);
 
 /**
- * Get the index (0-2047) of a BIP39 word.
- * @param word The word to look up
+ * Get the index (0-2047) of a word in the primary language.
+ * @param word The word to look up, in any normalization form or as a key
  * @return Word index (0-2047), or -1 if not found
  */
 int bip39_filter_get_word_index(const char *word);
 
+/**
+ * Get the display form of the BIP39 word at an index (its key).
+ * @param index Word index (0-2047)
+ * @return Word (points to wordlist), or NULL if out of range or not loaded
+ */
+const char *bip39_filter_get_word(int index);
+
+/**
+ * Get the BIP39 word at an index as written in the wordlist, for building
+ * a mnemonic (accents included).
+ * @param index Word index (0-2047)
+ * @return Word, or NULL if out of range or not loaded
+ */
+const char *bip39_filter_get_mnemonic_word(int index);
+
 /**
  * Clear the cached valid last words. Call this when moving to the last word
  * position to ensure fresh calculation based on the first N-1 words.